@@ -0,0 +1,348 @@
+/**
+ * @file fsdecodebenchmark.cpp
+ * @brief J2C decode benchmark for llimage_libtest.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsdecodebenchmark.h"
+
+#include "llatomic.h"
+#include "lldir.h"
+#include "llimageworker.h"
+#include "llmemory.h"
+#include "llsdjson.h"
+#include "llsdserialize.h"
+#include "lltimer.h"
+
+#include "json/writer.h" // JSON
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    const S32 BENCH_MAX_DISCARD = 5;   // same clamp as --discard_level
+
+    // One decode, filled in by the responder on a decode thread
+    struct DecodeSample
+    {
+        U64     mSubmitted;
+        U64     mCompleted;
+        S32     mPixels;
+        bool    mSuccess;
+    };
+
+    class BenchResponder : public LLImageDecodeThread::Responder
+    {
+    public:
+        BenchResponder(DecodeSample* sample, LLAtomicS32* done)
+        :   mSample(sample),
+            mDone(done)
+        {
+        }
+
+        /*virtual*/ void completed(bool success, LLImageRaw* raw, LLImageRaw* aux)
+        {
+            mSample->mCompleted = LLTimer::getTotalTime();
+            mSample->mSuccess = success && raw;
+            mSample->mPixels = mSample->mSuccess ? raw->getWidth() * raw->getHeight() : 0;
+            ++(*mDone);
+        }
+
+    private:
+        DecodeSample*   mSample;
+        LLAtomicS32*    mDone;
+    };
+
+    // Nearest rank percentile of sorted values
+    F64 percentile(const std::vector<F64>& sorted, F64 pct)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        size_t rank = (size_t)ceil(pct / 100.0 * sorted.size());
+        return sorted[llclamp(rank, (size_t)1, sorted.size()) - 1];
+    }
+
+    // A stream holding the first bytes of source, as the fetcher would have it
+    LLPointer<LLImageJ2C> make_stream(LLImageJ2C* source, S32 bytes)
+    {
+        LLPointer<LLImageJ2C> image = new LLImageJ2C;
+        if (!image->allocateData(bytes))
+        {
+            return NULL;
+        }
+        memcpy(image->getData(), source->getData(), bytes);
+        image->updateData();
+        return image;
+    }
+
+    bool ends_with(const std::string& str, const std::string& suffix)
+    {
+        return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+FSDecodeBenchmark::FSDecodeBenchmark(S32 max_threads, S32 repeats)
+:   mMaxThreads(llmax(max_threads, 1)),
+    mRepeats(llmax(repeats, 1)),
+    mMaxDiscard(0)
+{
+}
+
+S32 FSDecodeBenchmark::loadFiles(const std::list<std::string>& filenames)
+{
+    for (const std::string& filename : filenames)
+    {
+        LLPointer<LLImageJ2C> image = new LLImageJ2C;
+        if (gDirUtilp->getExtension(filename) != image->getExtension())
+        {
+            std::cout << "Benchmark: skipping " << filename << ", only j2c is decoded" << std::endl;
+            continue;
+        }
+        if (!image->load(filename) || !image->getWidth() || !image->getHeight())
+        {
+            std::cout << "Benchmark: " << filename << " could not be loaded" << std::endl;
+            continue;
+        }
+
+        Source source;
+        source.mName = gDirUtilp->getBaseFileName(filename);
+        source.mImage = image;
+        mSources.push_back(source);
+        mMaxDiscard = llmax(mMaxDiscard, llmin((S32)image->getLevels(), BENCH_MAX_DISCARD));
+    }
+    return (S32)mSources.size();
+}
+
+void FSDecodeBenchmark::run()
+{
+    mReport = LLSD::emptyMap();
+    mReport["engine"] = LLImageJ2C::getEngineInfo();
+    mReport["repeats"] = mRepeats;
+
+    LLSD& files = mReport["files"];
+    files = LLSD::emptyArray();
+    for (const Source& source : mSources)
+    {
+        LLSD file;
+        file["name"] = source.mName;
+        file["width"] = source.mImage->getWidth();
+        file["height"] = source.mImage->getHeight();
+        file["components"] = source.mImage->getComponents();
+        file["bytes"] = source.mImage->getDataSize();
+        files.append(file);
+    }
+
+    LLSD& runs = mReport["runs"];
+    runs = LLSD::emptyArray();
+    for (S32 threads = 1; threads <= mMaxThreads; ++threads)
+    {
+        for (S32 discard = 0; discard <= mMaxDiscard; ++discard)
+        {
+            runs.append(runOnce(threads, discard));
+        }
+    }
+
+    // Single threaded encode of each file back to j2c, from its full resolution decode
+    LLSD& encodes = mReport["encodes"];
+    encodes = LLSD::emptyArray();
+    for (Source& source : mSources)
+    {
+        LLPointer<LLImageRaw> raw = new LLImageRaw;
+        LLPointer<LLImageJ2C> input = make_stream(source.mImage, source.mImage->getDataSize());
+        if (input.isNull() || !input->decode(raw, 0.f))
+        {
+            continue;
+        }
+
+        LLPointer<LLImageJ2C> output = new LLImageJ2C;
+        LLTimer timer;
+        bool success = output->encode(raw, 0.f);
+        F64 ms = timer.getElapsedTimeF64() * 1000.0;
+
+        LLSD encode;
+        encode["name"] = source.mName;
+        encode["success"] = success;
+        encode["ms"] = ms;
+        encode["mpix_per_sec"] = ms > 0.0 ? (F64)raw->getWidth() * raw->getHeight() / 1000.0 / ms : 0.0;
+        encode["bytes"] = success ? output->getDataSize() : 0;
+        encodes.append(encode);
+    }
+}
+
+LLSD FSDecodeBenchmark::runOnce(S32 threads, S32 discard)
+{
+    // Every request gets its own copy of the bytes the fetcher would have
+    // for this discard level, as decoding trims and owns the stream
+    std::vector<LLPointer<LLImageJ2C> > images;
+    for (S32 repeat = 0; repeat < mRepeats; ++repeat)
+    {
+        for (Source& source : mSources)
+        {
+            S32 level = llmin(discard, (S32)source.mImage->getLevels());
+            S32 bytes = level ? llmin(source.mImage->calcDataSize(level), source.mImage->getDataSize())
+                              : source.mImage->getDataSize();
+            LLPointer<LLImageJ2C> image = make_stream(source.mImage, bytes);
+            if (image.notNull())
+            {
+                image->setDiscardLevel(level);
+                images.push_back(image);
+            }
+        }
+    }
+
+    const S32 count = (S32)images.size();
+    std::vector<DecodeSample> samples(count);
+    LLAtomicS32 done(0);
+    const S32 raw_memory_before = LLImageRaw::sGlobalRawMemory;
+    U64 peak_rss = LLMemory::getCurrentRSS();
+    S32 peak_raw = 0;
+
+    // 1 thread is the queued thread alone, more starts the decode pool
+    LLImageDecodeThread* decode_thread = new LLImageDecodeThread(true, threads);
+
+    const U64 start = LLTimer::getTotalTime();
+    for (S32 i = 0; i < count; ++i)
+    {
+        samples[i].mSubmitted = LLTimer::getTotalTime();
+        samples[i].mCompleted = 0;
+        samples[i].mSuccess = false;
+        decode_thread->decodeImage(images[i], LLQueuedThread::PRIORITY_NORMAL, images[i]->getDiscardLevel(), FALSE,
+                                   new BenchResponder(&samples[i], &done));
+    }
+    while (done.CurrentValue() < count)
+    {
+        decode_thread->update(1.f);
+        peak_rss = llmax(peak_rss, LLMemory::getCurrentRSS());
+        peak_raw = llmax(peak_raw, LLImageRaw::sGlobalRawMemory - raw_memory_before);
+        ms_sleep(1);
+    }
+    const U64 end = LLTimer::getTotalTime();
+
+    decode_thread->shutdown();
+    delete decode_thread;
+
+    std::vector<F64> latencies;
+    S32 failures = 0;
+    F64 pixels = 0.0;
+    F64 total_latency = 0.0;
+    for (const DecodeSample& sample : samples)
+    {
+        if (!sample.mSuccess)
+        {
+            ++failures;
+            continue;
+        }
+        F64 latency = (F64)(sample.mCompleted - sample.mSubmitted) / 1000.0;
+        latencies.push_back(latency);
+        total_latency += latency;
+        pixels += sample.mPixels;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    const F64 wall_ms = (F64)(end - start) / 1000.0;
+    LLSD run;
+    run["threads"] = threads;
+    run["discard"] = discard;
+    run["requests"] = count;
+    run["failures"] = failures;
+    run["wall_ms"] = wall_ms;
+    run["images_per_sec"] = wall_ms > 0.0 ? (count - failures) * 1000.0 / wall_ms : 0.0;
+    run["mpix_per_sec"] = wall_ms > 0.0 ? pixels / 1000.0 / wall_ms : 0.0;
+    LLSD& latency = run["latency_ms"];
+    latency["mean"] = latencies.empty() ? 0.0 : total_latency / latencies.size();
+    latency["p50"] = percentile(latencies, 50.0);
+    latency["p90"] = percentile(latencies, 90.0);
+    latency["p99"] = percentile(latencies, 99.0);
+    latency["max"] = latencies.empty() ? 0.0 : latencies.back();
+    run["peak_rss_kb"] = (S32)(peak_rss / 1024);
+    run["peak_raw_kb"] = peak_raw / 1024;
+    return run;
+}
+
+void FSDecodeBenchmark::printReport(std::ostream& os) const
+{
+    os << "Decode benchmark, " << mReport["engine"].asString() << ", " << mSources.size() << " files x "
+       << mRepeats << " repeats" << std::endl;
+    os << std::setw(8) << "threads" << std::setw(8) << "discard" << std::setw(8) << "fail"
+       << std::setw(11) << "wall ms" << std::setw(11) << "img/s" << std::setw(11) << "MPix/s"
+       << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms"
+       << std::setw(10) << "max ms" << std::setw(12) << "rss KB" << std::setw(12) << "raw KB" << std::endl;
+
+    const LLSD& runs = mReport["runs"];
+    for (LLSD::array_const_iterator it = runs.beginArray(); it != runs.endArray(); ++it)
+    {
+        const LLSD& run = *it;
+        const LLSD& latency = run["latency_ms"];
+        os << std::fixed << std::setprecision(2)
+           << std::setw(8) << run["threads"].asInteger() << std::setw(8) << run["discard"].asInteger()
+           << std::setw(8) << run["failures"].asInteger()
+           << std::setw(11) << run["wall_ms"].asReal() << std::setw(11) << run["images_per_sec"].asReal()
+           << std::setw(11) << run["mpix_per_sec"].asReal()
+           << std::setw(10) << latency["p50"].asReal() << std::setw(10) << latency["p90"].asReal()
+           << std::setw(10) << latency["p99"].asReal() << std::setw(10) << latency["max"].asReal()
+           << std::setw(12) << run["peak_rss_kb"].asInteger() << std::setw(12) << run["peak_raw_kb"].asInteger()
+           << std::endl;
+    }
+
+    const LLSD& encodes = mReport["encodes"];
+    if (encodes.size())
+    {
+        os << std::endl << std::setw(32) << "encode" << std::setw(11) << "ms" << std::setw(11) << "MPix/s"
+           << std::setw(12) << "bytes" << std::endl;
+        for (LLSD::array_const_iterator it = encodes.beginArray(); it != encodes.endArray(); ++it)
+        {
+            const LLSD& encode = *it;
+            os << std::setw(32) << encode["name"].asString() << std::setw(11) << encode["ms"].asReal()
+               << std::setw(11) << encode["mpix_per_sec"].asReal() << std::setw(12) << encode["bytes"].asInteger()
+               << std::endl;
+        }
+    }
+}
+
+bool FSDecodeBenchmark::saveReport(const std::string& filename) const
+{
+    llofstream out(filename.c_str());
+    if (!out.is_open())
+    {
+        return false;
+    }
+    if (ends_with(filename, ".json"))
+    {
+        Json::StyledStreamWriter writer;
+        writer.write(out, LlsdToJson(mReport));
+    }
+    else
+    {
+        LLSDSerialize::toPrettyXML(mReport, out);
+    }
+    return out.good();
+}
@@ -0,0 +1,87 @@
+/**
+ * @file fsdecodebenchmark.h
+ * @brief J2C decode benchmark for llimage_libtest.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_DECODEBENCHMARK_H
+#define FS_DECODEBENCHMARK_H
+
+#include "llimagej2c.h"
+#include "llpointer.h"
+#include "llsd.h"
+
+#include <iosfwd>
+#include <list>
+#include <string>
+#include <vector>
+
+/**
+ * Decodes a set of J2C files through LLImageDecodeThread the way the
+ * texture fetcher does: a burst of requests, each with the bytes the
+ * viewer would have fetched for the discard level. Every discard level is
+ * run with 1 to max_threads decode threads and each run reports latency
+ * percentiles from submission to completion, throughput and peak memory.
+ *
+ * The report is LLSD so it can be kept per build and compared:
+ * { engine, files: [ { name, width, height, components, bytes } ],
+ *   runs: [ { threads, discard, requests, failures, wall_ms, images_per_sec,
+ *             mpix_per_sec, latency_ms: { mean, p50, p90, p99, max },
+ *             peak_rss_kb, peak_raw_kb } ],
+ *   encodes: [ { name, success, ms, mpix_per_sec, bytes } ] }
+ *
+ * Encoding is timed once per file on the calling thread, since the viewer
+ * only encodes uploads and snapshots there.
+ */
+class FSDecodeBenchmark
+{
+public:
+    FSDecodeBenchmark(S32 max_threads, S32 repeats);
+
+    // Loads the j2c files among filenames; returns how many were usable
+    S32 loadFiles(const std::list<std::string>& filenames);
+    void run();
+
+    const LLSD& getReport() const { return mReport; }
+    void printReport(std::ostream& os) const;
+    // JSON when filename ends in .json, pretty LLSD XML otherwise
+    bool saveReport(const std::string& filename) const;
+
+private:
+    LLSD runOnce(S32 threads, S32 discard);
+
+    struct Source
+    {
+        std::string             mName;
+        LLPointer<LLImageJ2C>   mImage;     // whole file, header parsed
+    };
+
+    S32                 mMaxThreads;
+    S32                 mRepeats;
+    S32                 mMaxDiscard;
+    std::vector<Source> mSources;
+    LLSD                mReport;
+};
+
+#endif // FS_DECODEBENCHMARK_H
@@ -43,6 +43,11 @@
 #include "v4coloru.h"
 #include "llsdserialize.h"
 #include "llcleanup.h"
+// <FS> Decode benchmark, and what used to come in through the headers above
+#include "fsdecodebenchmark.h"
+#include "llfasttimer.h"
+#include "llmetricperformancetester.h"
+// </FS>
 
 // system libraries
 #include <iostream>
@@ -97,6 +102,16 @@ static const char USAGE[] = "\n"
 "        Results in <metric>_report.csv\n"
 " -s, --image-stats\n"
 "        Output stats for each input and output image.\n"
+// <FS> Decode benchmark
+" -bench, --benchmark <n>\n"
+"        Decode the j2c input files through the image decode thread at each discard level,\n"
+"        with 1 to <n> decode threads. Prints latency percentiles, throughput and peak memory.\n"
+"        Output files and filters are ignored.\n"
+" -rep, --repeat <n>\n"
+"        Number of times each input file is decoded per benchmark run. Default is 4.\n"
+" -report, --report <file>\n"
+"        Write the benchmark results to <file>, as JSON if it ends in .json, LLSD XML otherwise.\n"
+// </FS>
 "\n";
 
 // true when all image loading is done. Used by metric logging thread to know when to stop the thread.
@@ -357,6 +372,11 @@ int main(int argc, char** argv)
 	int levels = 0;
 	bool reversible = false;
     std::string filter_name = "";
+	// <FS> Decode benchmark
+	int benchmark_threads = 0;
+	int benchmark_repeats = 4;
+	std::string report_name;
+	// </FS>
 
 	// Init whatever is necessary
 	ll_init_apr();
@@ -557,6 +577,59 @@ int main(int argc, char** argv)
 		{
 			image_stats = true;
 		}
+		// <FS> Decode benchmark
+		else if (!strcmp(argv[arg], "--benchmark") || !strcmp(argv[arg], "-bench"))
+		{
+			std::string value_str;
+			if ((arg + 1) < argc)
+			{
+				value_str = argv[arg+1];
+			}
+			if (((arg + 1) >= argc) || (value_str[0] == '-'))
+			{
+				std::cout << "No valid --benchmark argument given, benchmark runs with 1 thread" << std::endl;
+				benchmark_threads = 1;
+			}
+			else
+			{
+				benchmark_threads = llclamp(atoi(value_str.c_str()), 1, 32);
+				arg += 1;
+			}
+		}
+		else if (!strcmp(argv[arg], "--repeat") || !strcmp(argv[arg], "-rep"))
+		{
+			std::string value_str;
+			if ((arg + 1) < argc)
+			{
+				value_str = argv[arg+1];
+			}
+			if (((arg + 1) >= argc) || (value_str[0] == '-'))
+			{
+				std::cout << "No valid --repeat argument given, default (4) will be used" << std::endl;
+			}
+			else
+			{
+				benchmark_repeats = llmax(atoi(value_str.c_str()), 1);
+				arg += 1;
+			}
+		}
+		else if (!strcmp(argv[arg], "--report") || !strcmp(argv[arg], "-report"))
+		{
+			if ((arg + 1) < argc)
+			{
+				report_name = argv[arg+1];
+			}
+			if (((arg + 1) >= argc) || (report_name[0] == '-'))
+			{
+				std::cout << "No --report argument given, results will only be printed" << std::endl;
+				report_name.clear();
+			}
+			else
+			{
+				arg += 1;
+			}
+		}
+		// </FS>
 	}
 		
 	// Check arguments consistency. Exit with proper message if inconsistent.
@@ -575,11 +648,48 @@ int main(int argc, char** argv)
 	// Create the logging thread if required
 	if (LLFastTimer::sMetricLog)
 	{
-		LLFastTimer::sLogLock = new LLMutex(NULL);
+		// <FS> sLogLock is private to llfasttimer.cpp
+		//LLFastTimer::sLogLock = new LLMutex(NULL);
+		LLFastTimer::setLogLock(new LLMutex());
+		// </FS>
 		fast_timer_log_thread = new LogThread(LLFastTimer::sLogName);
 		fast_timer_log_thread->start();
 	}
     
+	// <FS> Decode benchmark
+	if (benchmark_threads > 0)
+	{
+		FSDecodeBenchmark benchmark(benchmark_threads, benchmark_repeats);
+		if (benchmark.loadFiles(input_filenames))
+		{
+			benchmark.run();
+			benchmark.printReport(std::cout);
+			if (!report_name.empty())
+			{
+				if (benchmark.saveReport(report_name))
+				{
+					std::cout << "Benchmark report written to " << report_name << std::endl;
+				}
+				else
+				{
+					std::cout << "Error: benchmark report " << report_name << " could not be written" << std::endl;
+				}
+			}
+		}
+		else
+		{
+			std::cout << "No j2c input file, nothing to benchmark" << std::endl;
+		}
+		sAllDone = true;
+		SUBSYSTEM_CLEANUP(LLImage);
+		if (fast_timer_log_thread)
+		{
+			fast_timer_log_thread->shutdown();
+		}
+		return 0;
+	}
+	// </FS>
+
     // Load the filter once and for all
     LLImageFilter filter(filter_name);
 
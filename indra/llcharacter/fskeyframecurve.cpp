@@ -0,0 +1,243 @@
+/**
+ * @file fskeyframecurve.cpp
+ * @brief Flat keyframe curve lookups and batched joint interpolation.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fskeyframecurve.h"
+
+#include "lljointstate.h"
+
+#include <xmmintrin.h>
+
+namespace
+{
+    // Four floats of key, the w of a vector key is never used
+    inline __m128 load_vector(const LLVector3& key)
+    {
+        __m128 xy = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)key.mV);
+        return _mm_movelh_ps(xy, _mm_load_ss(key.mV + 2));
+    }
+
+    // nlerp() of a key pair, for what the SSE path leaves
+    inline LLQuaternion nlerp_keys(F32 u, const LLQuaternion* keys)
+    {
+        return nlerp(u, keys[0], keys[1]);
+    }
+}
+
+bool FSKeyframeCurve::findSegment(const F32* times, U32 count, F32 time, U32& cursor, U32& key, F32& u)
+{
+    llassert(count > 0);
+
+    // right is the first key at or after time, what std::map::lower_bound() gave
+    U32 right = cursor;
+    if (right < count && times[right] < time)
+    {
+        // played on, most likely into the next segment
+        ++right;
+        if (right < count && times[right] < time)
+        {
+            right = (U32)(std::lower_bound(times + right, times + count, time) - times);
+        }
+    }
+    else if (right > count || (right > 0 && times[right - 1] >= time))
+    {
+        // looped or jumped back
+        right = (U32)(std::lower_bound(times, times + llmin(right, count), time) - times);
+    }
+    cursor = right;
+
+    if (right == count)
+    {
+        // past the last key
+        key = count - 1;
+        return false;
+    }
+    if (right == 0 || times[right] == time)
+    {
+        // before the first key or exactly on one
+        key = right;
+        return false;
+    }
+
+    key = right - 1;
+    u = (time - times[key]) / (times[right] - times[key]);
+    return true;
+}
+
+void FSKeyframeBatch::clear()
+{
+    mVectorStates.clear();
+    mVectorUsage.clear();
+    mVectorKeys.clear();
+    mVectorU.clear();
+    mRotationStates.clear();
+    mRotationKeys.clear();
+    mRotationU.clear();
+}
+
+void FSKeyframeBatch::addPosition(LLJointState* joint_state, const LLVector3* keys, F32 u)
+{
+    mVectorStates.push_back(joint_state);
+    mVectorUsage.push_back(LLJointState::POS);
+    mVectorKeys.push_back(keys);
+    mVectorU.push_back(u);
+}
+
+void FSKeyframeBatch::addScale(LLJointState* joint_state, const LLVector3* keys, F32 u)
+{
+    mVectorStates.push_back(joint_state);
+    mVectorUsage.push_back(LLJointState::SCALE);
+    mVectorKeys.push_back(keys);
+    mVectorU.push_back(u);
+}
+
+void FSKeyframeBatch::addRotation(LLJointState* joint_state, const LLQuaternion* keys, F32 u)
+{
+    mRotationStates.push_back(joint_state);
+    mRotationKeys.push_back(keys);
+    mRotationU.push_back(u);
+}
+
+void FSKeyframeBatch::apply()
+{
+    const U32 vectors = (U32)mVectorStates.size();
+    if (vectors)
+    {
+        mVectorOut.resize(vectors);
+        lerp(&mVectorKeys[0], &mVectorU[0], &mVectorOut[0], vectors);
+        for (U32 i = 0; i < vectors; ++i)
+        {
+            if (mVectorUsage[i] == LLJointState::POS)
+            {
+                mVectorStates[i]->setPosition(mVectorOut[i]);
+            }
+            else
+            {
+                mVectorStates[i]->setScale(mVectorOut[i]);
+            }
+        }
+    }
+
+    const U32 rotations = (U32)mRotationStates.size();
+    if (rotations)
+    {
+        mRotationOut.resize(rotations);
+        nlerp(&mRotationKeys[0], &mRotationU[0], &mRotationOut[0], rotations);
+        for (U32 i = 0; i < rotations; ++i)
+        {
+            mRotationStates[i]->setRotation(mRotationOut[i]);
+        }
+    }
+
+    clear();
+}
+
+// static
+void FSKeyframeBatch::lerp(const LLVector3* const* keys, const F32* u, LLVector3* out, U32 count)
+{
+    // a + (b - a) * u, as lerp(LLVector3, LLVector3, F32)
+    for (U32 i = 0; i < count; ++i)
+    {
+        __m128 a = load_vector(keys[i][0]);
+        __m128 b = load_vector(keys[i][1]);
+        __m128 value = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(u[i])));
+        _mm_storel_pi((__m64*)out[i].mV, value);
+        _mm_store_ss(out[i].mV + 2, _mm_movehl_ps(value, value));
+    }
+}
+
+// static
+void FSKeyframeBatch::nlerp(const LLQuaternion* const* keys, const F32* u, LLQuaternion* out, U32 count)
+{
+    // Four joints per pass, one per lane, with the operations in the order
+    // lerp(F32, LLQuaternion, LLQuaternion) and LLQuaternion::normalize()
+    // do them. Joints on opposite hemispheres take nlerp()'s slerp() path.
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 sign = _mm_set1_ps(-0.f);
+    const __m128 threshold = _mm_set1_ps(FP_MAG_THRESHOLD);
+    const __m128 tolerance = _mm_set1_ps(ONE_PART_IN_A_MILLION);
+
+    U32 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 ax = _mm_loadu_ps(keys[i][0].mQ);
+        __m128 ay = _mm_loadu_ps(keys[i + 1][0].mQ);
+        __m128 az = _mm_loadu_ps(keys[i + 2][0].mQ);
+        __m128 aw = _mm_loadu_ps(keys[i + 3][0].mQ);
+        _MM_TRANSPOSE4_PS(ax, ay, az, aw);
+        __m128 bx = _mm_loadu_ps(keys[i][1].mQ);
+        __m128 by = _mm_loadu_ps(keys[i + 1][1].mQ);
+        __m128 bz = _mm_loadu_ps(keys[i + 2][1].mQ);
+        __m128 bw = _mm_loadu_ps(keys[i + 3][1].mQ);
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz)), _mm_mul_ps(aw, bw));
+
+        __m128 t = _mm_loadu_ps(u + i);
+        __m128 inv_t = _mm_sub_ps(one, t);
+        __m128 x = _mm_add_ps(_mm_mul_ps(t, bx), _mm_mul_ps(inv_t, ax));
+        __m128 y = _mm_add_ps(_mm_mul_ps(t, by), _mm_mul_ps(inv_t, ay));
+        __m128 z = _mm_add_ps(_mm_mul_ps(t, bz), _mm_mul_ps(inv_t, az));
+        __m128 w = _mm_add_ps(_mm_mul_ps(t, bw), _mm_mul_ps(inv_t, aw));
+
+        __m128 mag = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)), _mm_mul_ps(w, w)));
+        __m128 oomag = _mm_div_ps(one, mag);
+        __m128 valid = _mm_cmpgt_ps(mag, threshold);
+        // only renormalized when far enough from unit length
+        __m128 scale = _mm_and_ps(valid, _mm_cmpgt_ps(_mm_andnot_ps(sign, _mm_sub_ps(one, mag)), tolerance));
+        x = _mm_or_ps(_mm_and_ps(scale, _mm_mul_ps(x, oomag)), _mm_andnot_ps(scale, x));
+        y = _mm_or_ps(_mm_and_ps(scale, _mm_mul_ps(y, oomag)), _mm_andnot_ps(scale, y));
+        z = _mm_or_ps(_mm_and_ps(scale, _mm_mul_ps(z, oomag)), _mm_andnot_ps(scale, z));
+        w = _mm_or_ps(_mm_and_ps(scale, _mm_mul_ps(w, oomag)), _mm_andnot_ps(scale, w));
+        // a bad quaternion becomes the identity
+        x = _mm_and_ps(valid, x);
+        y = _mm_and_ps(valid, y);
+        z = _mm_and_ps(valid, z);
+        w = _mm_or_ps(_mm_and_ps(valid, w), _mm_andnot_ps(valid, one));
+
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(out[i].mQ, x);
+        _mm_storeu_ps(out[i + 1].mQ, y);
+        _mm_storeu_ps(out[i + 2].mQ, z);
+        _mm_storeu_ps(out[i + 3].mQ, w);
+
+        S32 flipped = _mm_movemask_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()));
+        for (U32 lane = 0; flipped; ++lane, flipped >>= 1)
+        {
+            if (flipped & 1)
+            {
+                out[i + lane] = nlerp_keys(u[i + lane], keys[i + lane]);
+            }
+        }
+    }
+
+    for (; i < count; ++i)
+    {
+        out[i] = nlerp_keys(u[i], keys[i]);
+    }
+}
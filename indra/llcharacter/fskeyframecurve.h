@@ -0,0 +1,113 @@
+/**
+ * @file fskeyframecurve.h
+ * @brief Flat keyframe curve lookups and batched joint interpolation.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_KEYFRAMECURVE_H
+#define FS_KEYFRAMECURVE_H
+
+#include "llmath.h"
+#include "llquaternion.h"
+#include "v3math.h"
+
+#include <algorithm>
+#include <vector>
+
+class LLJointState;
+
+namespace FSKeyframeCurve
+{
+    // Where time falls among count ascending key times, the way the
+    // std::map based curves of LLKeyframeMotion looked it up. Returns false
+    // with key set when time is on a key or outside them, true with key the
+    // one before time and u the fraction of the way to the next.
+    // cursor is per playing curve; playback moves forward, so the segment
+    // of the last lookup and the one after it are tried before searching.
+    bool findSegment(const F32* times, U32 count, F32 time, U32& cursor, U32& key, F32& u);
+
+    // Adds a key to sorted parallel arrays. A key at the same time is
+    // replaced, as std::map::operator[] did.
+    template<class T>
+    void insertKey(std::vector<F32>& times, std::vector<T>& values, F32 time, const T& value)
+    {
+        if (times.empty() || times.back() < time)
+        {
+            times.push_back(time);
+            values.push_back(value);
+            return;
+        }
+
+        std::vector<F32>::iterator it = std::lower_bound(times.begin(), times.end(), time);
+        const size_t index = it - times.begin();
+        if (*it == time)
+        {
+            values[index] = value;
+        }
+        else
+        {
+            times.insert(it, time);
+            values.insert(values.begin() + index, value);
+        }
+    }
+}
+
+/**
+ * The key interpolations of one frame of a keyframe motion, gathered over
+ * its joints so they run as SSE: rotations four joints at a time, positions
+ * and scales a joint per instruction. Results are bit for bit those of the
+ * lerp() and nlerp() LLKeyframeMotion's curves called joint by joint.
+ *
+ * Keys are not copied; each entry points at the key before time in the
+ * curve's flat value array, the key after it follows.
+ */
+class FSKeyframeBatch
+{
+public:
+    void clear();
+
+    void addPosition(LLJointState* joint_state, const LLVector3* keys, F32 u);
+    void addScale(LLJointState* joint_state, const LLVector3* keys, F32 u);
+    void addRotation(LLJointState* joint_state, const LLQuaternion* keys, F32 u);
+
+    // Interpolates everything added, sets it on the joint states and clears
+    void apply();
+
+    // The kernels over count key pairs
+    static void lerp(const LLVector3* const* keys, const F32* u, LLVector3* out, U32 count);
+    static void nlerp(const LLQuaternion* const* keys, const F32* u, LLQuaternion* out, U32 count);
+
+private:
+    std::vector<LLJointState*>          mVectorStates;
+    std::vector<U32>                    mVectorUsage;       // LLJointState::POS or SCALE
+    std::vector<const LLVector3*>       mVectorKeys;
+    std::vector<F32>                    mVectorU;
+    std::vector<LLVector3>              mVectorOut;
+    std::vector<LLJointState*>          mRotationStates;
+    std::vector<const LLQuaternion*>    mRotationKeys;
+    std::vector<F32>                    mRotationU;
+    std::vector<LLQuaternion>           mRotationOut;
+};
+
+#endif // FS_KEYFRAMECURVE_H
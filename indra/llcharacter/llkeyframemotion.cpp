@@ -144,7 +144,11 @@ LLKeyframeMotion::ScaleCurve::ScaleCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::ScaleCurve::~ScaleCurve() 
 {
-	mKeys.clear();
+	// <FS> Flat keyframe curves
+	//mKeys.clear();
+	mKeyTimes.clear();
+	mKeyScales.clear();
+	// </FS>
 	mNumKeys = 0;
 }
 
@@ -155,41 +159,61 @@ LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration)
 {
 	LLVector3 value;
 
-	if (mKeys.empty())
+	// <FS> Flat keyframe curves
+	//if (mKeys.empty())
+	if (mKeyTimes.empty())
+	// </FS>
 	{
 		value.clearVec();
 		return value;
 	}
 	
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	// <FS> Flat keyframe curves
+	//key_map_t::iterator right = mKeys.lower_bound(time);
+	//if (right == mKeys.end())
+	//{
+	//	// Past last key
+	//	--right;
+	//	value = right->second.mScale;
+	//}
+	//else if (right == mKeys.begin() || right->first == time)
+	//{
+	//	// Before first key or exactly on a key
+	//	value = right->second.mScale;
+	//}
+	//else
+	//{
+	//	// Between two keys
+	//	key_map_t::iterator left = right; --left;
+	//	F32 index_before = left->first;
+	//	F32 index_after = right->first;
+	//	ScaleKey& scale_before = left->second;
+	//	ScaleKey& scale_after = right->second;
+	//	if (right == mKeys.end())
+	//	{
+	//		scale_after = mLoopInKey;
+	//		index_after = duration;
+	//	}
+	//
+	//	F32 u = (time - index_before) / (index_after - index_before);
+	//	value = interp(u, scale_before, scale_after);
+	//}
+	U32 cursor = 0;
+	U32 key;
+	F32 u;
+	if (FSKeyframeCurve::findSegment(&mKeyTimes[0], (U32)mKeyTimes.size(), time, cursor, key, u))
 	{
-		// Past last key
-		--right;
-		value = right->second.mScale;
-	}
-	else if (right == mKeys.begin() || right->first == time)
-	{
-		// Before first key or exactly on a key
-		value = right->second.mScale;
+		// Between two keys
+		ScaleKey scale_before(mKeyTimes[key], mKeyScales[key]);
+		ScaleKey scale_after(mKeyTimes[key + 1], mKeyScales[key + 1]);
+		value = interp(u, scale_before, scale_after);
 	}
 	else
 	{
-		// Between two keys
-		key_map_t::iterator left = right; --left;
-		F32 index_before = left->first;
-		F32 index_after = right->first;
-		ScaleKey& scale_before = left->second;
-		ScaleKey& scale_after = right->second;
-		if (right == mKeys.end())
-		{
-			scale_after = mLoopInKey;
-			index_after = duration;
-		}
-
-		F32 u = (time - index_before) / (index_after - index_before);
-		value = interp(u, scale_before, scale_after);
+		// Before the first key, exactly on a key or past the last
+		value = mKeyScales[key];
 	}
+	// </FS>
 	return value;
 }
 
@@ -210,6 +234,31 @@ LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, ScaleKey& before, ScaleKey
 	}
 }
 
+//-----------------------------------------------------------------------------
+// <FS> Flat keyframe curves
+// ScaleCurve::update()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::ScaleCurve::update(LLJointState* joint_state, F32 time, U32& cursor, FSKeyframeBatch& batch) const
+{
+	if (mKeyTimes.empty())
+	{
+		joint_state->setScale(LLVector3::zero);
+		return;
+	}
+
+	U32 key;
+	F32 u;
+	if (!FSKeyframeCurve::findSegment(&mKeyTimes[0], (U32)mKeyTimes.size(), time, cursor, key, u) || mInterpolationType == IT_STEP)
+	{
+		joint_state->setScale(mKeyScales[key]);
+	}
+	else
+	{
+		batch.addScale(joint_state, &mKeyScales[key], u);
+	}
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 // RotationCurve::RotationCurve()
 //-----------------------------------------------------------------------------
@@ -224,7 +273,11 @@ LLKeyframeMotion::RotationCurve::RotationCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::RotationCurve::~RotationCurve()
 {
-	mKeys.clear();
+	// <FS> Flat keyframe curves
+	//mKeys.clear();
+	mKeyTimes.clear();
+	mKeyRotations.clear();
+	// </FS>
 	mNumKeys = 0;
 }
 
@@ -235,41 +288,61 @@ LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
 {
 	LLQuaternion value;
 
-	if (mKeys.empty())
+	// <FS> Flat keyframe curves
+	//if (mKeys.empty())
+	if (mKeyTimes.empty())
+	// </FS>
 	{
 		value = LLQuaternion::DEFAULT;
 		return value;
 	}
 	
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	// <FS> Flat keyframe curves
+	//key_map_t::iterator right = mKeys.lower_bound(time);
+	//if (right == mKeys.end())
+	//{
+	//	// Past last key
+	//	--right;
+	//	value = right->second.mRotation;
+	//}
+	//else if (right == mKeys.begin() || right->first == time)
+	//{
+	//	// Before first key or exactly on a key
+	//	value = right->second.mRotation;
+	//}
+	//else
+	//{
+	//	// Between two keys
+	//	key_map_t::iterator left = right; --left;
+	//	F32 index_before = left->first;
+	//	F32 index_after = right->first;
+	//	RotationKey& rot_before = left->second;
+	//	RotationKey& rot_after = right->second;
+	//	if (right == mKeys.end())
+	//	{
+	//		rot_after = mLoopInKey;
+	//		index_after = duration;
+	//	}
+	//
+	//	F32 u = (time - index_before) / (index_after - index_before);
+	//	value = interp(u, rot_before, rot_after);
+	//}
+	U32 cursor = 0;
+	U32 key;
+	F32 u;
+	if (FSKeyframeCurve::findSegment(&mKeyTimes[0], (U32)mKeyTimes.size(), time, cursor, key, u))
 	{
-		// Past last key
-		--right;
-		value = right->second.mRotation;
-	}
-	else if (right == mKeys.begin() || right->first == time)
-	{
-		// Before first key or exactly on a key
-		value = right->second.mRotation;
+		// Between two keys
+		RotationKey rot_before(mKeyTimes[key], mKeyRotations[key]);
+		RotationKey rot_after(mKeyTimes[key + 1], mKeyRotations[key + 1]);
+		value = interp(u, rot_before, rot_after);
 	}
 	else
 	{
-		// Between two keys
-		key_map_t::iterator left = right; --left;
-		F32 index_before = left->first;
-		F32 index_after = right->first;
-		RotationKey& rot_before = left->second;
-		RotationKey& rot_after = right->second;
-		if (right == mKeys.end())
-		{
-			rot_after = mLoopInKey;
-			index_after = duration;
-		}
-
-		F32 u = (time - index_before) / (index_after - index_before);
-		value = interp(u, rot_before, rot_after);
+		// Before the first key, exactly on a key or past the last
+		value = mKeyRotations[key];
 	}
+	// </FS>
 	return value;
 }
 
@@ -290,6 +363,31 @@ LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, RotationKey& before,
 	}
 }
 
+//-----------------------------------------------------------------------------
+// <FS> Flat keyframe curves
+// RotationCurve::update()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::RotationCurve::update(LLJointState* joint_state, F32 time, U32& cursor, FSKeyframeBatch& batch) const
+{
+	if (mKeyTimes.empty())
+	{
+		joint_state->setRotation(LLQuaternion::DEFAULT);
+		return;
+	}
+
+	U32 key;
+	F32 u;
+	if (!FSKeyframeCurve::findSegment(&mKeyTimes[0], (U32)mKeyTimes.size(), time, cursor, key, u) || mInterpolationType == IT_STEP)
+	{
+		joint_state->setRotation(mKeyRotations[key]);
+	}
+	else
+	{
+		batch.addRotation(joint_state, &mKeyRotations[key], u);
+	}
+}
+// </FS>
+
 
 //-----------------------------------------------------------------------------
 // PositionCurve::PositionCurve()
@@ -305,7 +403,11 @@ LLKeyframeMotion::PositionCurve::PositionCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::PositionCurve::~PositionCurve()
 {
-	mKeys.clear();
+	// <FS> Flat keyframe curves
+	//mKeys.clear();
+	mKeyTimes.clear();
+	mKeyPositions.clear();
+	// </FS>
 	mNumKeys = 0;
 }
 
@@ -316,41 +418,61 @@ LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
 {
 	LLVector3 value;
 
-	if (mKeys.empty())
+	// <FS> Flat keyframe curves
+	//if (mKeys.empty())
+	if (mKeyTimes.empty())
+	// </FS>
 	{
 		value.clearVec();
 		return value;
 	}
 	
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
-	{
-		// Past last key
-		--right;
-		value = right->second.mPosition;
-	}
-	else if (right == mKeys.begin() || right->first == time)
+	// <FS> Flat keyframe curves
+	//key_map_t::iterator right = mKeys.lower_bound(time);
+	//if (right == mKeys.end())
+	//{
+	//	// Past last key
+	//	--right;
+	//	value = right->second.mPosition;
+	//}
+	//else if (right == mKeys.begin() || right->first == time)
+	//{
+	//	// Before first key or exactly on a key
+	//	value = right->second.mPosition;
+	//}
+	//else
+	//{
+	//	// Between two keys
+	//	key_map_t::iterator left = right; --left;
+	//	F32 index_before = left->first;
+	//	F32 index_after = right->first;
+	//	PositionKey& pos_before = left->second;
+	//	PositionKey& pos_after = right->second;
+	//	if (right == mKeys.end())
+	//	{
+	//		pos_after = mLoopInKey;
+	//		index_after = duration;
+	//	}
+	//
+	//	F32 u = (time - index_before) / (index_after - index_before);
+	//	value = interp(u, pos_before, pos_after);
+	//}
+	U32 cursor = 0;
+	U32 key;
+	F32 u;
+	if (FSKeyframeCurve::findSegment(&mKeyTimes[0], (U32)mKeyTimes.size(), time, cursor, key, u))
 	{
-		// Before first key or exactly on a key
-		value = right->second.mPosition;
+		// Between two keys
+		PositionKey pos_before(mKeyTimes[key], mKeyPositions[key]);
+		PositionKey pos_after(mKeyTimes[key + 1], mKeyPositions[key + 1]);
+		value = interp(u, pos_before, pos_after);
 	}
 	else
 	{
-		// Between two keys
-		key_map_t::iterator left = right; --left;
-		F32 index_before = left->first;
-		F32 index_after = right->first;
-		PositionKey& pos_before = left->second;
-		PositionKey& pos_after = right->second;
-		if (right == mKeys.end())
-		{
-			pos_after = mLoopInKey;
-			index_after = duration;
-		}
-
-		F32 u = (time - index_before) / (index_after - index_before);
-		value = interp(u, pos_before, pos_after);
+		// Before the first key, exactly on a key or past the last
+		value = mKeyPositions[key];
 	}
+	// </FS>
 
 	llassert(value.isFinite());
 	
@@ -373,6 +495,31 @@ LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, Po
 	}
 }
 
+//-----------------------------------------------------------------------------
+// <FS> Flat keyframe curves
+// PositionCurve::update()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::PositionCurve::update(LLJointState* joint_state, F32 time, U32& cursor, FSKeyframeBatch& batch) const
+{
+	if (mKeyTimes.empty())
+	{
+		joint_state->setPosition(LLVector3::zero);
+		return;
+	}
+
+	U32 key;
+	F32 u;
+	if (!FSKeyframeCurve::findSegment(&mKeyTimes[0], (U32)mKeyTimes.size(), time, cursor, key, u) || mInterpolationType == IT_STEP)
+	{
+		joint_state->setPosition(mKeyPositions[key]);
+	}
+	else
+	{
+		batch.addPosition(joint_state, &mKeyPositions[key], u);
+	}
+}
+// </FS>
+
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -383,7 +530,10 @@ LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, Po
 //-----------------------------------------------------------------------------
 // JointMotion::update()
 //-----------------------------------------------------------------------------
-void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration)
+// <FS> Flat keyframe curves
+//void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration)
+void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, U32* cursors, FSKeyframeBatch& batch)
+// </FS>
 {
 	// this value being 0 is the cause of https://jira.lindenlab.com/browse/SL-22678 but I haven't 
 	// managed to get a stack to see how it got here. Testing for 0 here will stop the crash.
@@ -399,7 +549,10 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	//-------------------------------------------------------------------------
 	if ((usage & LLJointState::SCALE) && mScaleCurve.mNumKeys)
 	{
-		joint_state->setScale( mScaleCurve.getValue( time, duration ) );
+		// <FS> Flat keyframe curves
+		//joint_state->setScale( mScaleCurve.getValue( time, duration ) );
+		mScaleCurve.update(joint_state, time, cursors[0], batch);
+		// </FS>
 	}
 
 	//-------------------------------------------------------------------------
@@ -407,7 +560,10 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	//-------------------------------------------------------------------------
 	if ((usage & LLJointState::ROT) && mRotationCurve.mNumKeys)
 	{
-		joint_state->setRotation( mRotationCurve.getValue( time, duration ) );
+		// <FS> Flat keyframe curves
+		//joint_state->setRotation( mRotationCurve.getValue( time, duration ) );
+		mRotationCurve.update(joint_state, time, cursors[1], batch);
+		// </FS>
 	}
 
 	//-------------------------------------------------------------------------
@@ -415,7 +571,10 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	//-------------------------------------------------------------------------
 	if ((usage & LLJointState::POS) && mPositionCurve.mNumKeys)
 	{
-		joint_state->setPosition( mPositionCurve.getValue( time, duration ) );
+		// <FS> Flat keyframe curves
+		//joint_state->setPosition( mPositionCurve.getValue( time, duration ) );
+		mPositionCurve.update(joint_state, time, cursors[2], batch);
+		// </FS>
 	}
 }
 
@@ -732,12 +891,24 @@ BOOL LLKeyframeMotion::onUpdate(F32 time, U8* joint_mask)
 void LLKeyframeMotion::applyKeyframes(F32 time)
 {
 	llassert_always (mJointMotionList->getNumJointMotions() <= mJointStates.size());
-	for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
+	// <FS> Flat keyframe curves
+	//for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
+	//{
+	//	mJointMotionList->getJointMotion(i)->update(mJointStates[i],
+	//												  time, 
+	//												  mJointMotionList->mDuration );
+	//}
+	const U32 num_joint_motions = mJointMotionList->getNumJointMotions();
+	if (mKeyCursors.size() != num_joint_motions * 3)
+	{
+		mKeyCursors.assign(num_joint_motions * 3, 0);
+	}
+	for (U32 i=0; i<num_joint_motions; i++)
 	{
-		mJointMotionList->getJointMotion(i)->update(mJointStates[i],
-													  time, 
-													  mJointMotionList->mDuration );
+		mJointMotionList->getJointMotion(i)->update(mJointStates[i], time, &mKeyCursors[i * 3], mKeyframeBatch);
 	}
+	mKeyframeBatch.apply();
+	// </FS>
 
 	LLJoint::JointPriority* pose_priority = (LLJoint::JointPriority* )mCharacter->getAnimationData("Hand Pose Priority");
 	if (pose_priority)
@@ -1621,7 +1792,10 @@ BOOL LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id)
 				return FALSE;
 			}
 
-			rCurve->mKeys[time] = rot_key;
+			// <FS> Flat keyframe curves
+			//rCurve->mKeys[time] = rot_key;
+			FSKeyframeCurve::insertKey(rCurve->mKeyTimes, rCurve->mKeyRotations, time, rot_key.mRotation);
+			// </FS>
 		}
 
 		//---------------------------------------------------------------------
@@ -1715,7 +1889,10 @@ BOOL LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id)
 				return FALSE;
 			}
 			
-			pCurve->mKeys[pos_key.mTime] = pos_key;
+			// <FS> Flat keyframe curves
+			//pCurve->mKeys[pos_key.mTime] = pos_key;
+			FSKeyframeCurve::insertKey(pCurve->mKeyTimes, pCurve->mKeyPositions, pos_key.mTime, pos_key.mPosition);
+			// </FS>
 
 			if (is_pelvis)
 			{
@@ -2050,10 +2227,17 @@ BOOL LLKeyframeMotion::serialize(LLDataPacker& dp) const
 		success &= dp.packS32(joint_motionp->mRotationCurve.mNumKeys, "num_rot_keys");
 
 		LL_DEBUGS("BVH") << "Joint " << joint_motionp->mJointName << LL_ENDL;
-		for (RotationCurve::key_map_t::iterator iter = joint_motionp->mRotationCurve.mKeys.begin();
-			 iter != joint_motionp->mRotationCurve.mKeys.end(); ++iter)
+		// <FS> Flat keyframe curves
+		//for (RotationCurve::key_map_t::iterator iter = joint_motionp->mRotationCurve.mKeys.begin();
+		//	 iter != joint_motionp->mRotationCurve.mKeys.end(); ++iter)
+		const RotationCurve& rot_curve = joint_motionp->mRotationCurve;
+		for (U32 k = 0; k < rot_curve.mKeyTimes.size(); ++k)
+		// </FS>
 		{
-			RotationKey& rot_key = iter->second;
+			// <FS> Flat keyframe curves
+			//RotationKey& rot_key = iter->second;
+			RotationKey rot_key(rot_curve.mKeyTimes[k], rot_curve.mKeyRotations[k]);
+			// </FS>
 			U16 time_short = F32_to_U16(rot_key.mTime, 0.f, mJointMotionList->mDuration);
 			success &= dp.packU16(time_short, "time");
 
@@ -2072,15 +2256,23 @@ BOOL LLKeyframeMotion::serialize(LLDataPacker& dp) const
 		}
 
 		success &= dp.packS32(joint_motionp->mPositionCurve.mNumKeys, "num_pos_keys");
-		for (PositionCurve::key_map_t::iterator iter = joint_motionp->mPositionCurve.mKeys.begin();
-			 iter != joint_motionp->mPositionCurve.mKeys.end(); ++iter)
+		// <FS> Flat keyframe curves
+		//for (PositionCurve::key_map_t::iterator iter = joint_motionp->mPositionCurve.mKeys.begin();
+		//	 iter != joint_motionp->mPositionCurve.mKeys.end(); ++iter)
+		PositionCurve& pos_curve = joint_motionp->mPositionCurve;
+		for (U32 k = 0; k < pos_curve.mKeyTimes.size(); ++k)
+		// </FS>
 		{
-			PositionKey& pos_key = iter->second;
+			// <FS> Flat keyframe curves
+			//PositionKey& pos_key = iter->second;
+			PositionKey pos_key(pos_curve.mKeyTimes[k], pos_curve.mKeyPositions[k]);
+			// </FS>
 			U16 time_short = F32_to_U16(pos_key.mTime, 0.f, mJointMotionList->mDuration);
 			success &= dp.packU16(time_short, "time");
 
 			U16 x, y, z;
 			pos_key.mPosition.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			pos_curve.mKeyPositions[k] = pos_key.mPosition; // <FS/> Flat keyframe curves, the key was quantized in place
 			x = F32_to_U16(pos_key.mPosition.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
 			y = F32_to_U16(pos_key.mPosition.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
 			z = F32_to_U16(pos_key.mPosition.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
@@ -42,6 +42,7 @@
 #include "v3dmath.h"
 #include "v3math.h"
 #include "llbvhconsts.h"
+#include "fskeyframecurve.h" // <FS/> Flat keyframe curves
 
 class LLKeyframeDataCache;
 class LLDataPacker;
@@ -327,11 +328,20 @@ public:
 		~ScaleCurve();
 		LLVector3 getValue(F32 time, F32 duration);
 		LLVector3 interp(F32 u, ScaleKey& before, ScaleKey& after);
+		// <FS> Flat keyframe curves
+		// Sets joint_state at time, or adds the interpolation to batch; cursor
+		// is this joint's, see FSKeyframeCurve::findSegment()
+		void update(LLJointState* joint_state, F32 time, U32& cursor, FSKeyframeBatch& batch) const;
+		// </FS>
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, ScaleKey> key_map_t;
-		key_map_t 			mKeys;
+		// <FS> Flat keyframe curves: keys sorted by time, as parallel arrays
+		//typedef std::map<F32, ScaleKey> key_map_t;
+		//key_map_t 			mKeys;
+		std::vector<F32>	mKeyTimes;
+		std::vector<LLVector3>	mKeyScales;
+		// </FS>
 		ScaleKey			mLoopInKey;
 		ScaleKey			mLoopOutKey;
 	};
@@ -346,11 +356,18 @@ public:
 		~RotationCurve();
 		LLQuaternion getValue(F32 time, F32 duration);
 		LLQuaternion interp(F32 u, RotationKey& before, RotationKey& after);
+		// <FS> Flat keyframe curves
+		void update(LLJointState* joint_state, F32 time, U32& cursor, FSKeyframeBatch& batch) const;
+		// </FS>
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, RotationKey> key_map_t;
-		key_map_t		mKeys;
+		// <FS> Flat keyframe curves
+		//typedef std::map<F32, RotationKey> key_map_t;
+		//key_map_t		mKeys;
+		std::vector<F32>	mKeyTimes;
+		std::vector<LLQuaternion>	mKeyRotations;
+		// </FS>
 		RotationKey		mLoopInKey;
 		RotationKey		mLoopOutKey;
 	};
@@ -365,11 +382,18 @@ public:
 		~PositionCurve();
 		LLVector3 getValue(F32 time, F32 duration);
 		LLVector3 interp(F32 u, PositionKey& before, PositionKey& after);
+		// <FS> Flat keyframe curves
+		void update(LLJointState* joint_state, F32 time, U32& cursor, FSKeyframeBatch& batch) const;
+		// </FS>
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, PositionKey> key_map_t;
-		key_map_t		mKeys;
+		// <FS> Flat keyframe curves
+		//typedef std::map<F32, PositionKey> key_map_t;
+		//key_map_t		mKeys;
+		std::vector<F32>	mKeyTimes;
+		std::vector<LLVector3>	mKeyPositions;
+		// </FS>
 		PositionKey		mLoopInKey;
 		PositionKey		mLoopOutKey;
 	};
@@ -387,7 +411,11 @@ public:
 		U32				mUsage;
 		LLJoint::JointPriority	mPriority;
 
-		void update(LLJointState* joint_state, F32 time, F32 duration);
+		// <FS> Flat keyframe curves
+		//void update(LLJointState* joint_state, F32 time, F32 duration);
+		// cursors holds the three curve cursors of this joint, scale, rotation and position
+		void update(LLJointState* joint_state, F32 time, U32* cursors, FSKeyframeBatch& batch);
+		// </FS>
 	};
 	
 	//-------------------------------------------------------------------------
@@ -432,6 +460,10 @@ protected:
 	F32								mLastUpdateTime;
 	F32								mLastLoopedTime;
 	AssetStatus						mAssetStatus;
+	// <FS> Flat keyframe curves
+	std::vector<U32>				mKeyCursors;	// three per joint motion, see JointMotion::update()
+	FSKeyframeBatch					mKeyframeBatch;
+	// </FS>
 };
 
 class LLKeyframeDataCache
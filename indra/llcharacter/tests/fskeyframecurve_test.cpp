@@ -0,0 +1,431 @@
+/**
+ * @file fskeyframecurve_test.cpp
+ * @brief Tests and animation benchmark for the flat keyframe curves.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../fskeyframecurve.h"
+
+#include "../lljointstate.h"
+#include "llpointer.h"
+#include "lltimer.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    F32 unit(std::mt19937& random)
+    {
+        return (F32)(random() & 0xffff) / 65535.f;
+    }
+
+    LLQuaternion random_rotation(std::mt19937& random)
+    {
+        LLQuaternion rot(unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f);
+        rot.normalize();
+        return rot;
+    }
+
+    LLVector3 random_position(std::mt19937& random)
+    {
+        return LLVector3(unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f);
+    }
+
+    bool same(const F32* a, const F32* b, S32 count)
+    {
+        return memcmp(a, b, count * sizeof(F32)) == 0;
+    }
+
+    // A joint curve the way LLKeyframeMotion kept it before, and its lookup
+    struct MapCurve
+    {
+        std::map<F32, LLQuaternion> mRotations;
+        std::map<F32, LLVector3>    mPositions;
+    };
+
+    LLQuaternion interp(const LLQuaternion& before, const LLQuaternion& after, F32 u)
+    {
+        return nlerp(u, before, after);
+    }
+
+    LLVector3 interp(const LLVector3& before, const LLVector3& after, F32 u)
+    {
+        return lerp(before, after, u);
+    }
+
+    template<class T>
+    T map_value(const std::map<F32, T>& keys, F32 time)
+    {
+        typename std::map<F32, T>::const_iterator right = keys.lower_bound(time);
+        if (right == keys.end())
+        {
+            --right;
+            return right->second;
+        }
+        if (right == keys.begin() || right->first == time)
+        {
+            return right->second;
+        }
+        typename std::map<F32, T>::const_iterator left = right;
+        --left;
+        F32 u = (time - left->first) / (right->first - left->first);
+        return interp(left->second, right->second, u);
+    }
+
+    // The same curve as flat arrays
+    struct FlatCurve
+    {
+        std::vector<F32>            mRotationTimes;
+        std::vector<LLQuaternion>   mRotations;
+        std::vector<F32>            mPositionTimes;
+        std::vector<LLVector3>      mPositions;
+    };
+
+    struct Motion
+    {
+        std::vector<MapCurve>   mMapCurves;
+        std::vector<FlatCurve>  mFlatCurves;
+        F32                     mDuration;
+    };
+
+    Motion make_motion(std::mt19937& random, S32 joints, S32 keys, F32 duration)
+    {
+        Motion motion;
+        motion.mDuration = duration;
+        motion.mMapCurves.resize(joints);
+        motion.mFlatCurves.resize(joints);
+        for (S32 joint = 0; joint < joints; ++joint)
+        {
+            MapCurve& map_curve = motion.mMapCurves[joint];
+            FlatCurve& flat_curve = motion.mFlatCurves[joint];
+            // every joint rotates, a few move
+            bool moves = joint % 8 == 0;
+            LLQuaternion rot = random_rotation(random);
+            for (S32 key = 0; key < keys; ++key)
+            {
+                F32 time = duration * key / (keys - 1);
+                // a joint turns a little from key to key
+                LLVector3 axis = random_position(random);
+                axis.normVec();
+                rot = rot * LLQuaternion(0.2f * unit(random), axis);
+                map_curve.mRotations[time] = rot;
+                FSKeyframeCurve::insertKey(flat_curve.mRotationTimes, flat_curve.mRotations, time, rot);
+                if (moves)
+                {
+                    LLVector3 pos = random_position(random);
+                    map_curve.mPositions[time] = pos;
+                    FSKeyframeCurve::insertKey(flat_curve.mPositionTimes, flat_curve.mPositions, time, pos);
+                }
+            }
+        }
+        return motion;
+    }
+
+    // Joint states of one playing motion and its curve cursors
+    struct Playing
+    {
+        const Motion*                       mMotion;
+        F32                                 mPhase;
+        std::vector<LLPointer<LLJointState> > mStates;
+        std::vector<U32>                    mCursors;
+    };
+
+    void update_map(Playing& playing, F32 time)
+    {
+        const Motion& motion = *playing.mMotion;
+        for (size_t joint = 0; joint < motion.mMapCurves.size(); ++joint)
+        {
+            const MapCurve& curve = motion.mMapCurves[joint];
+            playing.mStates[joint]->setRotation(map_value(curve.mRotations, time));
+            if (!curve.mPositions.empty())
+            {
+                playing.mStates[joint]->setPosition(map_value(curve.mPositions, time));
+            }
+        }
+    }
+
+    void update_flat(Playing& playing, F32 time, FSKeyframeBatch& batch)
+    {
+        const Motion& motion = *playing.mMotion;
+        for (size_t joint = 0; joint < motion.mFlatCurves.size(); ++joint)
+        {
+            const FlatCurve& curve = motion.mFlatCurves[joint];
+            LLJointState* state = playing.mStates[joint];
+            U32 key;
+            F32 u;
+            if (FSKeyframeCurve::findSegment(&curve.mRotationTimes[0], (U32)curve.mRotationTimes.size(), time,
+                                             playing.mCursors[joint * 2], key, u))
+            {
+                batch.addRotation(state, &curve.mRotations[key], u);
+            }
+            else
+            {
+                state->setRotation(curve.mRotations[key]);
+            }
+
+            if (!curve.mPositions.empty())
+            {
+                if (FSKeyframeCurve::findSegment(&curve.mPositionTimes[0], (U32)curve.mPositionTimes.size(), time,
+                                                 playing.mCursors[joint * 2 + 1], key, u))
+                {
+                    batch.addPosition(state, &curve.mPositions[key], u);
+                }
+                else
+                {
+                    state->setPosition(curve.mPositions[key]);
+                }
+            }
+        }
+        batch.apply();
+    }
+}
+
+namespace tut
+{
+    struct FSKeyframeCurveFixture
+    {
+        std::mt19937 mRandom;
+    };
+    typedef test_group<FSKeyframeCurveFixture> FSKeyframeCurveTest_factory;
+    typedef FSKeyframeCurveTest_factory::object FSKeyframeCurveTest_t;
+    FSKeyframeCurveTest_factory tf("FSKeyframeCurve");
+
+    // Lookups agree with std::map::lower_bound() however time moves
+    template<> template<>
+    void FSKeyframeCurveTest_t::test<1>()
+    {
+        // unsorted times with repeats, as an old format animation may have them
+        std::map<F32, S32> map_keys;
+        std::vector<F32> times;
+        std::vector<S32> values;
+        for (S32 i = 0; i < 200; ++i)
+        {
+            F32 time = (F32)(mRandom() % 100) * 0.05f;
+            map_keys[time] = i;
+            FSKeyframeCurve::insertKey(times, values, time, i);
+        }
+        ensure_equals("keys", times.size(), map_keys.size());
+        size_t index = 0;
+        for (std::map<F32, S32>::iterator it = map_keys.begin(); it != map_keys.end(); ++it, ++index)
+        {
+            ensure("time", times[index] == it->first);
+            ensure_equals("last value wins", values[index], it->second);
+        }
+
+        const U32 count = (U32)times.size();
+        U32 cursor = 0;
+        for (S32 pass = 0; pass < 3; ++pass)
+        {
+            for (S32 step = 0; step < 2000; ++step)
+            {
+                // forward playback, loops, jumps and exact key times
+                F32 time;
+                switch (pass)
+                {
+                case 0:     time = fmodf(step * 0.013f, 5.5f) - 0.2f; break;
+                case 1:     time = unit(mRandom) * 6.f - 0.5f; break;
+                default:    time = times[mRandom() % count]; break;
+                }
+
+                U32 key;
+                F32 u;
+                bool between = FSKeyframeCurve::findSegment(&times[0], count, time, cursor, key, u);
+
+                std::map<F32, S32>::iterator right = map_keys.lower_bound(time);
+                if (right == map_keys.end())
+                {
+                    ensure("past the end", !between && key == count - 1);
+                }
+                else if (right == map_keys.begin() || right->first == time)
+                {
+                    ensure("on a key", !between && times[key] == right->first);
+                }
+                else
+                {
+                    std::map<F32, S32>::iterator left = right;
+                    --left;
+                    ensure("between", between && times[key] == left->first && times[key + 1] == right->first);
+                    ensure("u", u == (time - left->first) / (right->first - left->first));
+                }
+            }
+        }
+
+        // a stale cursor from a longer curve is only a hint
+        cursor = count + 10;
+        U32 key;
+        F32 u;
+        ensure("stale cursor", FSKeyframeCurve::findSegment(&times[0], count, times[1] + 0.01f, cursor, key, u) && key == 1);
+    }
+
+    // The kernels match lerp() and nlerp() bit for bit
+    template<> template<>
+    void FSKeyframeCurveTest_t::test<2>()
+    {
+        const U32 COUNT = 1003;
+        std::vector<LLQuaternion> rotations(COUNT * 2);
+        std::vector<LLVector3> vectors(COUNT * 2);
+        std::vector<const LLQuaternion*> rotation_keys(COUNT);
+        std::vector<const LLVector3*> vector_keys(COUNT);
+        std::vector<F32> u(COUNT);
+        for (U32 i = 0; i < COUNT; ++i)
+        {
+            LLQuaternion a = random_rotation(mRandom);
+            LLQuaternion b = random_rotation(mRandom);
+            switch (i % 5)
+            {
+            case 0:     b = a; break;                       // no renormalizing
+            case 1:     b = -b; break;                      // opposite hemispheres
+            case 2:     b = -a; break;
+            default:    break;
+            }
+            rotations[i * 2] = a;
+            rotations[i * 2 + 1] = b;
+            rotation_keys[i] = &rotations[i * 2];
+            vectors[i * 2] = random_position(mRandom);
+            vectors[i * 2 + 1] = random_position(mRandom);
+            vector_keys[i] = &vectors[i * 2];
+            u[i] = i % 7 ? unit(mRandom) : (i % 2 ? 0.f : 1.f);
+        }
+
+        std::vector<LLQuaternion> rotation_out(COUNT);
+        FSKeyframeBatch::nlerp(&rotation_keys[0], &u[0], &rotation_out[0], COUNT);
+        for (U32 i = 0; i < COUNT; ++i)
+        {
+            LLQuaternion expected = nlerp(u[i], rotations[i * 2], rotations[i * 2 + 1]);
+            ensure("nlerp", same(expected.mQ, rotation_out[i].mQ, 4));
+        }
+
+        std::vector<LLVector3> vector_out(COUNT);
+        FSKeyframeBatch::lerp(&vector_keys[0], &u[0], &vector_out[0], COUNT);
+        for (U32 i = 0; i < COUNT; ++i)
+        {
+            LLVector3 expected = lerp(vectors[i * 2], vectors[i * 2 + 1], u[i]);
+            ensure("lerp", same(expected.mV, vector_out[i].mV, 3));
+        }
+
+        // apply() hands each result to its joint state
+        FSKeyframeBatch batch;
+        LLPointer<LLJointState> state = new LLJointState();
+        state->setUsage(LLJointState::POS | LLJointState::ROT | LLJointState::SCALE);
+        batch.addRotation(state, &rotations[6], 0.25f);
+        batch.addPosition(state, &vectors[6], 0.5f);
+        batch.addScale(state, &vectors[8], 0.75f);
+        batch.apply();
+        ensure("rotation", same(state->getRotation().mQ, nlerp(0.25f, rotations[6], rotations[7]).mQ, 4));
+        ensure("position", same(state->getPosition().mV, lerp(vectors[6], vectors[7], 0.5f).mV, 3));
+        ensure("scale", same(state->getScale().mV, lerp(vectors[8], vectors[9], 0.75f).mV, 3));
+    }
+
+    // Per frame cost of posing avatars from their keyframe motions, the
+    // curve work LLMotionController::updateMotions() does through
+    // LLKeyframeMotion::applyKeyframes().
+    template<> template<>
+    void FSKeyframeCurveTest_t::test<3>()
+    {
+        skip_unless_benchmarks();
+
+        const S32 AVATARS = 100;
+        const S32 MOTIONS = 10;
+        const S32 JOINTS = 24;
+        const S32 FRAMES = 120;
+        const F32 FRAME_TIME = 1.f / 45.f;
+
+        std::cout << std::endl << "FSKeyframeCurve, " << AVATARS << " avatars x " << MOTIONS << " motions x "
+                  << JOINTS << " joints, per frame" << std::endl;
+        std::cout << std::setw(8) << "keys" << std::setw(12) << "map ms" << std::setw(12) << "flat ms"
+                  << std::setw(10) << "speedup" << std::endl;
+
+        const S32 key_counts[] = { 8, 30, 120, 480 };
+        for (S32 keys : key_counts)
+        {
+            std::vector<Motion> motions;
+            for (S32 i = 0; i < MOTIONS; ++i)
+            {
+                motions.push_back(make_motion(mRandom, JOINTS, keys, 2.f + i * 0.5f));
+            }
+
+            std::vector<Playing> map_playing(AVATARS * MOTIONS);
+            std::vector<Playing> flat_playing(AVATARS * MOTIONS);
+            for (size_t i = 0; i < map_playing.size(); ++i)
+            {
+                map_playing[i].mMotion = &motions[i % MOTIONS];
+                map_playing[i].mPhase = unit(mRandom) * map_playing[i].mMotion->mDuration;
+                flat_playing[i].mMotion = map_playing[i].mMotion;
+                flat_playing[i].mPhase = map_playing[i].mPhase;
+                flat_playing[i].mCursors.assign(JOINTS * 2, 0);
+                for (S32 joint = 0; joint < JOINTS; ++joint)
+                {
+                    map_playing[i].mStates.push_back(new LLJointState());
+                    map_playing[i].mStates.back()->setUsage(LLJointState::POS | LLJointState::ROT);
+                    flat_playing[i].mStates.push_back(new LLJointState());
+                    flat_playing[i].mStates.back()->setUsage(LLJointState::POS | LLJointState::ROT);
+                }
+            }
+
+            LLTimer timer;
+            for (S32 frame = 0; frame < FRAMES; ++frame)
+            {
+                for (Playing& playing : map_playing)
+                {
+                    update_map(playing, fmodf(playing.mPhase + frame * FRAME_TIME, playing.mMotion->mDuration));
+                }
+            }
+            F64 map_ms = timer.getElapsedTimeF64() * 1000.0 / FRAMES;
+
+            FSKeyframeBatch batch;
+            timer.reset();
+            for (S32 frame = 0; frame < FRAMES; ++frame)
+            {
+                for (Playing& playing : flat_playing)
+                {
+                    update_flat(playing, fmodf(playing.mPhase + frame * FRAME_TIME, playing.mMotion->mDuration), batch);
+                }
+            }
+            F64 flat_ms = timer.getElapsedTimeF64() * 1000.0 / FRAMES;
+
+            // both end on the same pose
+            for (size_t i = 0; i < map_playing.size(); ++i)
+            {
+                for (S32 joint = 0; joint < JOINTS; ++joint)
+                {
+                    const LLJointState* map_state = map_playing[i].mStates[joint];
+                    const LLJointState* flat_state = flat_playing[i].mStates[joint];
+                    ensure("same rotation", same(map_state->getRotation().mQ, flat_state->getRotation().mQ, 4));
+                    ensure("same position", same(map_state->getPosition().mV, flat_state->getPosition().mV, 3));
+                }
+            }
+
+            std::cout << std::setw(8) << keys << std::fixed << std::setprecision(3)
+                      << std::setw(12) << map_ms << std::setw(12) << flat_ms
+                      << std::setw(10) << std::setprecision(2) << map_ms / llmax(flat_ms, 0.001) << std::endl;
+        }
+    }
+}
@@ -0,0 +1,268 @@
+/**
+ * @file fsindexedheap.h
+ * @brief Addressable d-ary heap with in-place reprioritization.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_INDEXEDHEAP_H
+#define FS_INDEXEDHEAP_H
+
+#include "llerror.h"
+#include <vector>
+
+/**
+ * Priority queue of pointers or handles that can find, reprioritize and
+ * remove any of its elements without searching for them.
+ *
+ * Every element stores its own position in the heap; IndexOf is a functor
+ * returning a reference to that S32 slot for a given element (-1 means "not
+ * queued"). Compare(a, b) returns true when a must be popped before b, the
+ * same convention std::set uses for its front element.
+ *
+ * The heap is 4-ary: it is shallower than a binary heap and the children of
+ * a node share a cache line, which is what dominates when the queue holds a
+ * few thousand texture requests that are reprioritized every frame.
+ *
+ * Iteration visits the elements in heap order, not in priority order.
+ */
+template <typename T, typename Compare, typename IndexOf>
+class FSIndexedHeap
+{
+public:
+    typedef std::vector<T> container_t;
+    typedef typename container_t::const_iterator iterator;
+    typedef typename container_t::const_iterator const_iterator;
+    typedef typename container_t::size_type size_type;
+
+    enum { ARITY = 4 };
+
+    FSIndexedHeap(const Compare& compare = Compare(), const IndexOf& index_of = IndexOf())
+    :   mCompare(compare),
+        mIndexOf(index_of)
+    {
+    }
+
+    bool empty() const { return mHeap.empty(); }
+    size_type size() const { return mHeap.size(); }
+    void reserve(size_type count) { mHeap.reserve(count); }
+
+    const_iterator begin() const { return mHeap.begin(); }
+    const_iterator end() const { return mHeap.end(); }
+
+    const T& top() const
+    {
+        llassert(!mHeap.empty());
+        return mHeap.front();
+    }
+
+    bool contains(const T& item) const
+    {
+        S32 pos = mIndexOf(item);
+        return pos >= 0 && (size_type)pos < mHeap.size() && mHeap[pos] == item;
+    }
+
+    // Returns false if the element was already queued.
+    bool push(const T& item)
+    {
+        if (contains(item))
+        {
+            return false;
+        }
+        mHeap.push_back(item);
+        mIndexOf(item) = (S32)mHeap.size() - 1;
+        siftUp(mHeap.size() - 1);
+        return true;
+    }
+
+    void pop()
+    {
+        llassert(!mHeap.empty());
+        removeAt(0);
+    }
+
+    // Same return convention as std::set::erase(key)
+    size_type erase(const T& item)
+    {
+        if (!contains(item))
+        {
+            return 0;
+        }
+        removeAt(mIndexOf(item));
+        return 1;
+    }
+
+    /**
+     * Restores the heap order after the priority of a queued element has
+     * been changed in place. Costs nothing when the element is still in
+     * order with its parent and children.
+     */
+    void update(const T& item)
+    {
+        if (!contains(item))
+        {
+            return;
+        }
+        size_type pos = mIndexOf(item);
+        if (pos > 0 && mCompare(mHeap[pos], mHeap[parent(pos)]))
+        {
+            siftUp(pos);
+        }
+        else
+        {
+            siftDown(pos);
+        }
+    }
+
+    /**
+     * Reorders the whole heap in O(n). Call this instead of update() after
+     * changing the priority of a large fraction of the queued elements.
+     */
+    void rebuild()
+    {
+        size_type count = mHeap.size();
+        for (size_type pos = 0; pos < count; ++pos)
+        {
+            mIndexOf(mHeap[pos]) = (S32)pos;
+        }
+        if (count > 1)
+        {
+            for (size_type pos = parent(count - 1) + 1; pos-- > 0; )
+            {
+                siftDown(pos);
+            }
+        }
+    }
+
+    void clear()
+    {
+        for (typename container_t::iterator iter = mHeap.begin(); iter != mHeap.end(); ++iter)
+        {
+            mIndexOf(*iter) = -1;
+        }
+        mHeap.clear();
+    }
+
+    // debug: verifies the heap order and the stored positions
+    bool check() const
+    {
+        for (size_type pos = 0; pos < mHeap.size(); ++pos)
+        {
+            if (mIndexOf(mHeap[pos]) != (S32)pos)
+            {
+                return false;
+            }
+            if (pos > 0 && mCompare(mHeap[pos], mHeap[parent(pos)]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static size_type parent(size_type pos) { return (pos - 1) / ARITY; }
+    static size_type firstChild(size_type pos) { return pos * ARITY + 1; }
+
+    void place(size_type pos, const T& item)
+    {
+        mHeap[pos] = item;
+        mIndexOf(item) = (S32)pos;
+    }
+
+    void removeAt(size_type pos)
+    {
+        mIndexOf(mHeap[pos]) = -1;
+        size_type last = mHeap.size() - 1;
+        if (pos != last)
+        {
+            T moved = mHeap[last];
+            mHeap.pop_back();
+            place(pos, moved);
+            if (pos > 0 && mCompare(moved, mHeap[parent(pos)]))
+            {
+                siftUp(pos);
+            }
+            else
+            {
+                siftDown(pos);
+            }
+        }
+        else
+        {
+            mHeap.pop_back();
+        }
+    }
+
+    void siftUp(size_type pos)
+    {
+        T item = mHeap[pos];
+        while (pos > 0)
+        {
+            size_type up = parent(pos);
+            if (!mCompare(item, mHeap[up]))
+            {
+                break;
+            }
+            place(pos, mHeap[up]);
+            pos = up;
+        }
+        place(pos, item);
+    }
+
+    void siftDown(size_type pos)
+    {
+        T item = mHeap[pos];
+        size_type count = mHeap.size();
+        while (true)
+        {
+            size_type child = firstChild(pos);
+            if (child >= count)
+            {
+                break;
+            }
+            size_type last_child = child + ARITY < count ? child + ARITY : count;
+            size_type best = child;
+            for (++child; child < last_child; ++child)
+            {
+                if (mCompare(mHeap[child], mHeap[best]))
+                {
+                    best = child;
+                }
+            }
+            if (!mCompare(mHeap[best], item))
+            {
+                break;
+            }
+            place(pos, mHeap[best]);
+            pos = best;
+        }
+        place(pos, item);
+    }
+
+    container_t mHeap;
+    Compare     mCompare;
+    IndexOf     mIndexOf;
+};
+
+#endif // FS_INDEXEDHEAP_H
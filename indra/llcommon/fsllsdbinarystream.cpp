@@ -0,0 +1,485 @@
+/**
+ * @file fsllsdbinarystream.cpp
+ * @brief Pull parser for zlib compressed binary LLSD.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsllsdbinarystream.h"
+
+#include "lldate.h"
+#include "lluri.h"
+#include "lluuid.h"
+
+#include <cstring>
+#include <zlib.h>
+
+// Inflate chunk for the small tokens between binaries. Binaries at least
+// this large are inflated directly into the caller's memory.
+static const size_t INFLATE_CHUNK = 16 * 1024;
+// Sanity limit for keys and the small strings read through readValue()
+static const U32 MAX_STRING_SIZE = 64 * 1024;
+
+FSLLSDBinaryStream::FSLLSDBinaryStream()
+:   mPos(nullptr),
+    mEnd(nullptr),
+    mOpen(false),
+    mStreamEnd(false)
+{
+}
+
+FSLLSDBinaryStream::~FSLLSDBinaryStream()
+{
+    close();
+}
+
+bool FSLLSDBinaryStream::open(const U8* in, S32 size)
+{
+    close();
+    if (!in || size <= 0)
+    {
+        return false;
+    }
+
+    try
+    {
+        if (!mBuffer)
+        {
+            mBuffer.reset(new U8[INFLATE_CHUNK]);
+        }
+        mStream.reset(new z_stream);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return false;
+    }
+
+    memset(mStream.get(), 0, sizeof(z_stream));
+    mStream->next_in = const_cast<U8*>(in);
+    mStream->avail_in = size;
+    if (inflateInit(mStream.get()) != Z_OK)
+    {
+        mStream.reset();
+        return false;
+    }
+    mOpen = true;
+    mStreamEnd = false;
+    mPos = mEnd = mBuffer.get();
+
+    // Same leniency as strip_deprecated_header()
+    static const char deprecated_header[] = "<? LLSD/Binary ?>";
+    const size_t header_size = sizeof(deprecated_header) - 1;
+    while (mEnd - mPos < (ptrdiff_t)header_size && fill())
+    {
+    }
+    if (mEnd - mPos >= (ptrdiff_t)header_size && !memcmp(mPos, deprecated_header, header_size))
+    {
+        mPos += header_size;
+        while ((mPos < mEnd || fill()) && (*mPos == '\n' || *mPos == '\r'))
+        {
+            ++mPos;
+        }
+    }
+    return true;
+}
+
+void FSLLSDBinaryStream::close()
+{
+    if (mOpen)
+    {
+        inflateEnd(mStream.get());
+        mOpen = false;
+    }
+    mStream.reset();
+    mPos = mEnd = nullptr;
+    mStreamEnd = false;
+}
+
+bool FSLLSDBinaryStream::fill()
+{
+    if (!mOpen || mStreamEnd)
+    {
+        return false;
+    }
+
+    // Keep any unread bytes, callers may be waiting for a few more
+    size_t left = mEnd - mPos;
+    if (left && mPos != mBuffer.get())
+    {
+        memmove(mBuffer.get(), mPos, left);
+    }
+    mPos = mBuffer.get();
+    mEnd = mPos + left;
+
+    mStream->next_out = mBuffer.get() + left;
+    mStream->avail_out = (uInt)(INFLATE_CHUNK - left);
+    S32 ret = inflate(mStream.get(), Z_NO_FLUSH);
+    mEnd = mStream->next_out;
+    if (ret == Z_STREAM_END)
+    {
+        mStreamEnd = true;
+    }
+    else if (ret != Z_OK)
+    {
+        LL_DEBUGS("MeshStreaming") << "Inflate failed with " << ret << LL_ENDL;
+        close();
+        return false;
+    }
+    return mEnd - mPos > (ptrdiff_t)left;
+}
+
+bool FSLLSDBinaryStream::readRaw(void* dst, size_t size)
+{
+    U8* out = (U8*)dst;
+
+    size_t buffered = llmin((size_t)(mEnd - mPos), size);
+    if (buffered)
+    {
+        memcpy(out, mPos, buffered);
+        mPos += buffered;
+        out += buffered;
+        size -= buffered;
+    }
+
+    if (size >= INFLATE_CHUNK && mOpen && !mStreamEnd)
+    {
+        // Large payload: let zlib write it in place
+        mStream->next_out = out;
+        while (size)
+        {
+            mStream->avail_out = (uInt)llmin(size, (size_t)0x40000000);
+            U8* start = mStream->next_out;
+            S32 ret = inflate(mStream.get(), Z_NO_FLUSH);
+            size -= mStream->next_out - start;
+            if (ret == Z_STREAM_END)
+            {
+                mStreamEnd = true;
+                break;
+            }
+            if (ret != Z_OK)
+            {
+                LL_DEBUGS("MeshStreaming") << "Inflate failed with " << ret << LL_ENDL;
+                close();
+                return false;
+            }
+        }
+        return size == 0;
+    }
+
+    while (size)
+    {
+        if (mPos == mEnd && !fill())
+        {
+            return false;
+        }
+        size_t count = llmin((size_t)(mEnd - mPos), size);
+        memcpy(out, mPos, count);
+        mPos += count;
+        out += count;
+        size -= count;
+    }
+    return true;
+}
+
+bool FSLLSDBinaryStream::skipRaw(size_t size)
+{
+    while (size)
+    {
+        if (mPos == mEnd && !fill())
+        {
+            return false;
+        }
+        size_t count = llmin((size_t)(mEnd - mPos), size);
+        mPos += count;
+        size -= count;
+    }
+    return true;
+}
+
+bool FSLLSDBinaryStream::finish()
+{
+    while (mOpen && !mStreamEnd)
+    {
+        mPos = mEnd;
+        if (!fill() && !mStreamEnd)
+        {
+            return false;
+        }
+    }
+    return mStreamEnd;
+}
+
+bool FSLLSDBinaryStream::readType(char& type)
+{
+    if (mPos == mEnd && !fill())
+    {
+        return false;
+    }
+    type = (char)*mPos++;
+    return true;
+}
+
+bool FSLLSDBinaryStream::expect(char type)
+{
+    char actual;
+    return readType(actual) && actual == type;
+}
+
+bool FSLLSDBinaryStream::readSize(U32& size)
+{
+    U8 bytes[4];
+    if (!readRaw(bytes, sizeof(bytes)))
+    {
+        return false;
+    }
+    // network byte order
+    size = ((U32)bytes[0] << 24) | ((U32)bytes[1] << 16) | ((U32)bytes[2] << 8) | (U32)bytes[3];
+    return true;
+}
+
+bool FSLLSDBinaryStream::readString(std::string& value)
+{
+    U32 size;
+    if (!readSize(size) || size > MAX_STRING_SIZE)
+    {
+        return false;
+    }
+    value.resize(size);
+    return !size || readRaw(&value[0], size);
+}
+
+bool FSLLSDBinaryStream::readKey(std::string& key)
+{
+    return expect('k') && readString(key);
+}
+
+bool FSLLSDBinaryStream::readValue(char type, LLSD& value, S32 max_depth)
+{
+    if (max_depth <= 0)
+    {
+        return false;
+    }
+
+    switch (type)
+    {
+    case '!':
+        value.clear();
+        return true;
+    case '0':
+        value = false;
+        return true;
+    case '1':
+        value = true;
+        return true;
+    case 'i':
+    {
+        U32 raw;
+        if (!readSize(raw))
+        {
+            return false;
+        }
+        value = (S32)raw;
+        return true;
+    }
+    case 'r':
+    case 'd':
+    {
+        U8 bytes[8];
+        if (!readRaw(bytes, sizeof(bytes)))
+        {
+            return false;
+        }
+        F64 real;
+        if (type == 'r')
+        {
+            // network byte order, see ll_ntohd()
+            U64 bits = 0;
+            for (S32 i = 0; i < 8; ++i)
+            {
+                bits = (bits << 8) | bytes[i];
+            }
+            memcpy(&real, &bits, sizeof(real));
+            value = real;
+        }
+        else
+        {
+            // dates are written in host order
+            memcpy(&real, bytes, sizeof(real));
+            value = LLDate(real);
+        }
+        return true;
+    }
+    case 'u':
+    {
+        LLUUID id;
+        if (!readRaw(id.mData, UUID_BYTES))
+        {
+            return false;
+        }
+        value = id;
+        return true;
+    }
+    case 's':
+    case 'l':
+    {
+        std::string str;
+        if (!readString(str))
+        {
+            return false;
+        }
+        if (type == 's')
+        {
+            value = str;
+        }
+        else
+        {
+            value = LLURI(str);
+        }
+        return true;
+    }
+    case 'b':
+    {
+        U32 size;
+        if (!readSize(size) || size > MAX_STRING_SIZE)
+        {
+            return false;
+        }
+        LLSD::Binary binary(size);
+        if (size && !readRaw(&binary[0], size))
+        {
+            return false;
+        }
+        value = binary;
+        return true;
+    }
+    case '[':
+    {
+        U32 count;
+        if (!readSize(count))
+        {
+            return false;
+        }
+        value = LLSD::emptyArray();
+        for (U32 i = 0; i < count; ++i)
+        {
+            char child_type;
+            LLSD child;
+            if (!readType(child_type) || !readValue(child_type, child, max_depth - 1))
+            {
+                return false;
+            }
+            value.append(child);
+        }
+        return expect(']');
+    }
+    case '{':
+    {
+        U32 count;
+        if (!readSize(count))
+        {
+            return false;
+        }
+        value = LLSD::emptyMap();
+        for (U32 i = 0; i < count; ++i)
+        {
+            std::string key;
+            char child_type;
+            LLSD child;
+            if (!readKey(key) || !readType(child_type) || !readValue(child_type, child, max_depth - 1))
+            {
+                return false;
+            }
+            value[key] = child;
+        }
+        return expect('}');
+    }
+    default:
+        // notation style strings and garbage
+        return false;
+    }
+}
+
+bool FSLLSDBinaryStream::skipValue(char type, S32 max_depth)
+{
+    if (max_depth <= 0)
+    {
+        return false;
+    }
+
+    U32 size;
+    switch (type)
+    {
+    case '!':
+    case '0':
+    case '1':
+        return true;
+    case 'i':
+        return skipRaw(4);
+    case 'r':
+    case 'd':
+        return skipRaw(8);
+    case 'u':
+        return skipRaw(UUID_BYTES);
+    case 's':
+    case 'l':
+    case 'b':
+        return readSize(size) && skipRaw(size);
+    case '[':
+    {
+        if (!readSize(size))
+        {
+            return false;
+        }
+        for (U32 i = 0; i < size; ++i)
+        {
+            char child_type;
+            if (!readType(child_type) || !skipValue(child_type, max_depth - 1))
+            {
+                return false;
+            }
+        }
+        return expect(']');
+    }
+    case '{':
+    {
+        if (!readSize(size))
+        {
+            return false;
+        }
+        for (U32 i = 0; i < size; ++i)
+        {
+            std::string key;
+            char child_type;
+            if (!readKey(key) || !readType(child_type) || !skipValue(child_type, max_depth - 1))
+            {
+                return false;
+            }
+        }
+        return expect('}');
+    }
+    default:
+        return false;
+    }
+}
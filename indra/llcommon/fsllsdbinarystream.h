@@ -0,0 +1,97 @@
+/**
+ * @file fsllsdbinarystream.h
+ * @brief Pull parser for zlib compressed binary LLSD.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_LLSDBINARYSTREAM_H
+#define FS_LLSDBINARYSTREAM_H
+
+#include "llsd.h"
+
+#include <memory>
+#include <string>
+
+struct z_stream_s;
+
+/**
+ * Walks a zlib compressed binary LLSD document while it is being inflated,
+ * without building an LLSD tree for it. Binary values can be inflated
+ * straight into caller owned memory, so large blobs such as mesh vertex
+ * streams never exist in an intermediate buffer.
+ *
+ * Every value starts with a type byte (see LLSDBinaryParser::doParse()):
+ * maps and arrays are followed by readSize() and their children, binaries
+ * and strings by readSize() and their payload. Only 'k' keys are
+ * supported; documents using notation style keys make readKey() fail so
+ * the caller can fall back to LLUZipHelper::unzip_llsd().
+ */
+class LL_COMMON_API FSLLSDBinaryStream
+{
+public:
+    FSLLSDBinaryStream();
+    ~FSLLSDBinaryStream();
+
+    // Starts inflating size bytes at in, which must outlive the stream.
+    // Skips the deprecated "<? LLSD/Binary ?>" header if present.
+    bool open(const U8* in, S32 size);
+    void close();
+
+    bool readType(char& type);
+    bool expect(char type);
+
+    // Element count of a map or array, byte count of a binary or string
+    bool readSize(U32& size);
+    bool readKey(std::string& key);
+
+    // Inflates the next size bytes into dst
+    bool readRaw(void* dst, size_t size);
+    bool skipRaw(size_t size);
+
+    // Reads or skips the value whose type byte was just read. Meant for
+    // small values; use readSize()/readRaw() for binaries.
+    bool readValue(char type, LLSD& value, S32 max_depth = 8);
+    bool skipValue(char type, S32 max_depth = 8);
+
+    // Inflates whatever follows the document so zlib checks its trailer.
+    // False if the compressed data is truncated or damaged, which
+    // LLUZipHelper::unzip_llsd() rejects as well.
+    bool finish();
+
+private:
+    FSLLSDBinaryStream(const FSLLSDBinaryStream&);
+    FSLLSDBinaryStream& operator=(const FSLLSDBinaryStream&);
+
+    bool fill();
+    bool readString(std::string& value);
+
+    std::unique_ptr<z_stream_s> mStream;
+    std::unique_ptr<U8[]>       mBuffer;
+    const U8*   mPos;
+    const U8*   mEnd;
+    bool        mOpen;
+    bool        mStreamEnd;
+};
+
+#endif // FS_LLSDBINARYSTREAM_H
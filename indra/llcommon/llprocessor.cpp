@@ -132,7 +132,8 @@ namespace
 		eMONTIOR_MWAIT=33,
 		eCPLDebugStore=34,
 		eThermalMonitor2=35,
-		eAltivec=36
+		eAltivec=36,
+		eAVX_Ext=37 // <FS/> AVX query
 	};
 
 	const char* cpu_feature_names[] =
@@ -175,7 +176,8 @@ namespace
 		"CPL Qualified Debug Store",
 		"Thermal Monitor 2",
 
-		"Altivec"
+		"Altivec",
+		"AVX Extensions" // <FS/> AVX query, CPU and OS support for the ymm registers
 	};
 
 	std::string intel_CPUFamilyName(int composed_family) 
@@ -269,6 +271,13 @@ public:
 		return hasExtension("Altivec"); 
 	}
 
+	// <FS> AVX query
+	bool hasAVX() const
+	{
+		return hasExtension(cpu_feature_names[eAVX_Ext]);
+	}
+	// </FS>
+
 	std::string getCPUFamilyName() const { return getInfo(eFamilyName, "Unset family").asString(); }
 	std::string getCPUBrandName() const { return getInfo(eBrandName, "Unset brand").asString(); }
 
@@ -530,6 +539,13 @@ private:
 				{
 					setExtension(cpu_feature_names[eThermalMonitor2]);
 				}
+
+				// <FS> AVX query: needs OSXSAVE and the OS saving the ymm registers too
+				if((cpu_info[2] & 0x18000000) == 0x18000000 && (_xgetbv(0) & 0x6) == 0x6)
+				{
+					setExtension(cpu_feature_names[eAVX_Ext]);
+				}
+				// </FS>
 						
 				unsigned int feature_info = (unsigned int) cpu_info[3];
 				for(unsigned int index = 0, bit = 1; index < eSSE3_Features; ++index, bit <<= 1)
@@ -704,6 +720,19 @@ private:
 		uint64_t ext_feature_info = getSysctlInt64("machdep.cpu.extfeature_bits");
 		S32 *ext_feature_infos = (S32*)(&ext_feature_info);
 		setConfig(eExtFeatureBits, ext_feature_infos[0]);
+
+		// <FS> AVX query, only listed when the OS supports it
+		char cpu_features[0x400];
+		len = sizeof(cpu_features);
+		memset(cpu_features, 0, len);
+		sysctlbyname("machdep.cpu.features", (void*)cpu_features, &len, NULL, 0);
+		cpu_features[0x3ff] = 0;
+		std::string features = std::string(" ") + cpu_features + " ";
+		if (features.find(" AVX1.0 ") != std::string::npos)
+		{
+			setExtension(cpu_feature_names[eAVX_Ext]);
+		}
+		// </FS>
 	}
 };
 
@@ -727,9 +756,15 @@ private:
 		LLFILE* cpuinfo_fp = LLFile::fopen(CPUINFO_FILE, "rb");
 		if(cpuinfo_fp)
 		{
-			char line[MAX_STRING];
-			memset(line, 0, MAX_STRING);
-			while(fgets(line, MAX_STRING, cpuinfo_fp))
+			// <FS> AVX query: the flags line of a current CPU is far longer than MAX_STRING
+			//char line[MAX_STRING];
+			//memset(line, 0, MAX_STRING);
+			//while(fgets(line, MAX_STRING, cpuinfo_fp))
+			const S32 CPUINFO_LINE_SIZE = 4096;
+			char line[CPUINFO_LINE_SIZE];
+			memset(line, 0, CPUINFO_LINE_SIZE);
+			while(fgets(line, CPUINFO_LINE_SIZE, cpuinfo_fp))
+			// </FS>
 			{
 				// /proc/cpuinfo on Linux looks like:
 				// name\t*: value\n
@@ -812,6 +847,13 @@ private:
 		{
 			setExtension(cpu_feature_names[eSSE2_Ext]);
 		}
+
+		// <FS> AVX query, the kernel drops the flag when it does not save the ymm registers
+		if( flags.find( " avx " ) != std::string::npos )
+		{
+			setExtension(cpu_feature_names[eAVX_Ext]);
+		}
+		// </FS>
 	}
 
 	std::string getCPUFeatureDescription() const 
@@ -871,6 +913,7 @@ F64MegahertzImplicit LLProcessorInfo::getCPUFrequency() const { return mImpl->ge
 bool LLProcessorInfo::hasSSE() const { return mImpl->hasSSE(); }
 bool LLProcessorInfo::hasSSE2() const { return mImpl->hasSSE2(); }
 bool LLProcessorInfo::hasAltivec() const { return mImpl->hasAltivec(); }
+bool LLProcessorInfo::hasAVX() const { return mImpl->hasAVX(); } // <FS/> AVX query
 std::string LLProcessorInfo::getCPUFamilyName() const { return mImpl->getCPUFamilyName(); }
 std::string LLProcessorInfo::getCPUBrandName() const { return mImpl->getCPUBrandName(); }
 std::string LLProcessorInfo::getCPUFeatureDescription() const { return mImpl->getCPUFeatureDescription(); }
@@ -41,6 +41,7 @@ public:
 	bool hasSSE() const;
 	bool hasSSE2() const;
 	bool hasAltivec() const;
+	bool hasAVX() const; // <FS/> AVX query
 	std::string getCPUFamilyName() const;
 	std::string getCPUBrandName() const;
 	std::string getCPUFeatureDescription() const;
@@ -198,7 +198,10 @@ void LLQueuedThread::printQueueStats()
 	lockData();
 	if (!mRequestQueue.empty())
 	{
-		QueuedRequest *req = *mRequestQueue.begin();
+		// <FS> Indexed request queue
+		//QueuedRequest *req = *mRequestQueue.begin();
+		QueuedRequest *req = mRequestQueue.top();
+		// </FS>
 		LL_INFOS() << llformat("Pending Requests:%d Current status:%d", mRequestQueue.size(), req->getStatus()) << LL_ENDL;
 	}
 	else
@@ -231,7 +234,10 @@ bool LLQueuedThread::addRequest(QueuedRequest* req)
 	
 	lockData();
 	req->setStatus(STATUS_QUEUED);
-	mRequestQueue.insert(req);
+	// <FS> Indexed request queue
+	//mRequestQueue.insert(req);
+	mRequestQueue.push(req);
+	// </FS>
 	mRequestHash.insert(req);
 #if _DEBUG
 // 	LL_INFOS() << llformat("LLQueuedThread::Added req [%08d]",handle) << LL_ENDL;
@@ -346,15 +352,62 @@ void LLQueuedThread::setPriority(handle_t handle, U32 priority)
 		}
 		else if(req->getStatus() == STATUS_QUEUED)
 		{
+			// <FS> Indexed request queue
 			// remove from list then re-insert
-			llverify(mRequestQueue.erase(req) == 1);
-			req->setPriority(priority);
-			mRequestQueue.insert(req);
+			//llverify(mRequestQueue.erase(req) == 1);
+			//req->setPriority(priority);
+			//mRequestQueue.insert(req);
+			if (req->getPriority() != priority)
+			{
+				req->setPriority(priority);
+				mRequestQueue.update(req);
+			}
+			// </FS>
 		}
 	}
 	unlockData();
 }
 
+// <FS> Indexed request queue
+void LLQueuedThread::setPriorities(const priority_list_t& priorities)
+{
+	lockData();
+	// Past a quarter of the queue, one O(n) rebuild is cheaper than
+	// sifting every changed request into place
+	bool rebuild = priorities.size() * 4 > mRequestQueue.size();
+	bool changed = false;
+	for (priority_list_t::const_iterator iter = priorities.begin(); iter != priorities.end(); ++iter)
+	{
+		QueuedRequest* req = (QueuedRequest*)mRequestHash.find(iter->first);
+		if (!req || req->getPriority() == iter->second)
+		{
+			continue;
+		}
+		if (req->getStatus() == STATUS_INPROGRESS)
+		{
+			req->setPriority(iter->second);
+		}
+		else if (req->getStatus() == STATUS_QUEUED)
+		{
+			req->setPriority(iter->second);
+			if (rebuild)
+			{
+				changed = true;
+			}
+			else
+			{
+				mRequestQueue.update(req);
+			}
+		}
+	}
+	if (changed)
+	{
+		mRequestQueue.rebuild();
+	}
+	unlockData();
+}
+// </FS>
+
 bool LLQueuedThread::completeRequest(handle_t handle)
 {
 	bool res = false;
@@ -412,8 +465,12 @@ S32 LLQueuedThread::processNextRequest()
 		{
 			break;
 		}
-		req = *mRequestQueue.begin();
-		mRequestQueue.erase(mRequestQueue.begin());
+		// <FS> Indexed request queue
+		//req = *mRequestQueue.begin();
+		//mRequestQueue.erase(mRequestQueue.begin());
+		req = mRequestQueue.top();
+		mRequestQueue.pop();
+		// </FS>
 		if ((req->getFlags() & FLAG_ABORT) || (mStatus == QUITTING))
 		{
 			req->setStatus(STATUS_ABORTED);
@@ -470,7 +527,10 @@ S32 LLQueuedThread::processNextRequest()
 		{
 			lockData();
 			req->setStatus(STATUS_QUEUED);
-			mRequestQueue.insert(req);
+			// <FS> Indexed request queue
+			//mRequestQueue.insert(req);
+			mRequestQueue.push(req);
+			// </FS>
 			unlockData();
 			if (mThreaded && start_priority < PRIORITY_NORMAL)
 			{
@@ -552,7 +612,8 @@ LLQueuedThread::QueuedRequest::QueuedRequest(LLQueuedThread::handle_t handle, U3
 	LLSimpleHashEntry<LLQueuedThread::handle_t>(handle),
 	mStatus(STATUS_UNKNOWN),
 	mPriority(priority),
-	mFlags(flags)
+	mFlags(flags),
+	mQueueIndex(-1) // <FS/> Indexed request queue
 {
 }
 
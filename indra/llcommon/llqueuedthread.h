@@ -36,6 +36,7 @@
 
 #include "llthread.h"
 #include "llsimplehash.h"
+#include "fsindexedheap.h" // <FS> Indexed request queue
 
 //============================================================================
 // Note: ~LLQueuedThread is O(N) N=# of queued threads, assumed to be small
@@ -132,6 +133,7 @@ public:
 		LLAtomicBase<status_t> mStatus;
 		U32 mPriority;
 		U32 mFlags;
+		S32 mQueueIndex; // <FS/> Position in mRequestQueue, -1 when not queued
 	};
 
 protected:
@@ -142,6 +144,15 @@ protected:
 			return lhs->higherPriority(*rhs); // higher priority in front of queue (set)
 		}
 	};
+	// <FS> Indexed request queue
+	struct queued_request_index
+	{
+		S32& operator()(QueuedRequest* req) const
+		{
+			return req->mQueueIndex;
+		}
+	};
+	// </FS>
 
 
 	//------------------------------------------------------------------------
@@ -188,6 +199,11 @@ public:
 	void abortRequest(handle_t handle, bool autocomplete);
 	void setFlags(handle_t handle, U32 flags);
 	void setPriority(handle_t handle, U32 priority);
+	// <FS> Indexed request queue
+	// Applies many priority changes under a single lock of the queue
+	typedef std::vector<std::pair<handle_t, U32> > priority_list_t;
+	void setPriorities(const priority_list_t& priorities);
+	// </FS>
 	bool completeRequest(handle_t handle);
 	// This is public for support classes like LLWorkerThread,
 	// but generally the methods above should be used.
@@ -201,7 +217,10 @@ protected:
 	BOOL mStarted;  // required when mThreaded is false to call startThread() from update()
 	LLAtomicBool mIdleThread; // request queue is empty (or we are quitting) and the thread is idle
 	
-	typedef std::set<QueuedRequest*, queued_request_less> request_queue_t;
+	// <FS> Indexed request queue
+	//typedef std::set<QueuedRequest*, queued_request_less> request_queue_t;
+	typedef FSIndexedHeap<QueuedRequest*, queued_request_less, queued_request_index> request_queue_t;
+	// </FS>
 	request_queue_t mRequestQueue;
 
 	enum { REQUEST_HASH_SIZE = 512 }; // must be power of 2
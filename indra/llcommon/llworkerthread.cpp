@@ -406,5 +406,18 @@ void LLWorkerClass::setPriority(U32 priority)
 	mMutex.unlock();
 }
 
+// <FS> Batched priority updates
+LLWorkerClass::handle_t LLWorkerClass::updatePriority(U32 priority)
+{
+	LLMutexLock lock(&mMutex);
+	if (mRequestHandle != LLWorkerThread::nullHandle() && mRequestPriority != priority)
+	{
+		mRequestPriority = priority;
+		return mRequestHandle;
+	}
+	return LLWorkerThread::nullHandle();
+}
+// </FS>
+
 //============================================================================
 
@@ -154,6 +154,11 @@ public:
 	// setPriority(): changes the priority of a request
 	void setPriority(U32 priority);
 	U32  getPriority() { return mRequestPriority; }
+	// <FS> Batched priority updates
+	// updatePriority(): records the priority like setPriority() but leaves the queue alone;
+	// returns the handle to pass to LLQueuedThread::setPriorities(), or nullHandle() if unchanged
+	handle_t updatePriority(U32 priority);
+	// </FS>
 		
 	const std::string& getName() const { return mWorkerClassName; }
 
@@ -0,0 +1,280 @@
+/**
+ * @file fsindexedheap_test.cpp
+ * @brief Tests and churn benchmark for FSIndexedHeap.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../fsindexedheap.h"
+
+#include "lltimer.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    // Mirrors the ordering of LLQueuedThread::QueuedRequest
+    struct Request
+    {
+        U32 mPriority;
+        U32 mKey;
+        S32 mQueueIndex;
+    };
+
+    struct request_less
+    {
+        bool operator()(const Request* lhs, const Request* rhs) const
+        {
+            if (lhs->mPriority == rhs->mPriority)
+                return lhs->mKey < rhs->mKey;
+            return lhs->mPriority > rhs->mPriority;
+        }
+    };
+
+    struct request_index
+    {
+        S32& operator()(Request* req) const
+        {
+            return req->mQueueIndex;
+        }
+    };
+
+    typedef FSIndexedHeap<Request*, request_less, request_index> heap_t;
+    typedef std::set<Request*, request_less> set_t;
+
+    const U32 PRIORITY_NORMAL = 0x20000000;
+    const U32 PRIORITY_LOWBITS = 0x0FFFFFFF;
+}
+
+namespace tut
+{
+    struct FSIndexedHeapFixture
+    {
+        FSIndexedHeapFixture()
+        :   mRandom(1234)
+        {
+        }
+
+        void makeRequests(size_t count)
+        {
+            mRequests.resize(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                mRequests[i].mPriority = randomPriority();
+                mRequests[i].mKey = (U32)i + 1;
+                mRequests[i].mQueueIndex = -1;
+            }
+        }
+
+        U32 randomPriority()
+        {
+            // Few distinct values, like texture priorities quantized by LLViewerFetchedTexture
+            return PRIORITY_NORMAL | (mRandom() % 1024) * (PRIORITY_LOWBITS / 1024);
+        }
+
+        std::mt19937 mRandom;
+        std::vector<Request> mRequests;
+    };
+    typedef test_group<FSIndexedHeapFixture> FSIndexedHeapTest_factory;
+    typedef FSIndexedHeapTest_factory::object FSIndexedHeapTest_t;
+    FSIndexedHeapTest_factory tf("FSIndexedHeap");
+
+    // Pops in the same order as the std::set it replaces
+    template<> template<>
+    void FSIndexedHeapTest_t::test<1>()
+    {
+        makeRequests(5000);
+        heap_t heap;
+        set_t reference;
+        for (size_t i = 0; i < mRequests.size(); ++i)
+        {
+            ensure("push", heap.push(&mRequests[i]));
+            reference.insert(&mRequests[i]);
+        }
+        ensure("duplicate push", !heap.push(&mRequests[0]));
+        ensure_equals("size", heap.size(), reference.size());
+        ensure("heap order", heap.check());
+
+        while (!reference.empty())
+        {
+            ensure("same front", heap.top() == *reference.begin());
+            heap.pop();
+            reference.erase(reference.begin());
+        }
+        ensure("empty", heap.empty());
+        ensure_equals("popped index", mRequests[0].mQueueIndex, -1);
+    }
+
+    // Reprioritize, erase and rebuild keep the heap consistent
+    template<> template<>
+    void FSIndexedHeapTest_t::test<2>()
+    {
+        makeRequests(3000);
+        heap_t heap;
+        set_t reference;
+        for (size_t i = 0; i < mRequests.size(); ++i)
+        {
+            heap.push(&mRequests[i]);
+            reference.insert(&mRequests[i]);
+        }
+
+        for (S32 round = 0; round < 20; ++round)
+        {
+            for (S32 i = 0; i < 200; ++i)
+            {
+                Request* req = &mRequests[mRandom() % mRequests.size()];
+                if (reference.erase(req))
+                {
+                    req->mPriority = randomPriority();
+                    heap.update(req);
+                    reference.insert(req);
+                }
+            }
+            for (S32 i = 0; i < 50; ++i)
+            {
+                Request* req = &mRequests[mRandom() % mRequests.size()];
+                ensure_equals("erase", heap.erase(req), reference.erase(req));
+            }
+            ensure("heap order after updates", heap.check());
+            ensure("same front after updates", heap.empty() || heap.top() == *reference.begin());
+        }
+
+        // Bulk change behind the heap's back, then rebuild
+        reference.clear();
+        for (heap_t::const_iterator iter = heap.begin(); iter != heap.end(); ++iter)
+        {
+            (*iter)->mPriority = randomPriority();
+            reference.insert(*iter);
+        }
+        heap.rebuild();
+        ensure("heap order after rebuild", heap.check());
+        while (!reference.empty())
+        {
+            ensure("same front after rebuild", heap.top() == *reference.begin());
+            heap.pop();
+            reference.erase(reference.begin());
+        }
+
+        heap.push(&mRequests[0]);
+        heap.clear();
+        ensure("cleared", heap.empty() && mRequests[0].mQueueIndex == -1);
+    }
+
+    // Texture fetch like churn: a large queue that is mostly reprioritized
+    // every frame while a few requests are serviced and added.
+    template<> template<>
+    void FSIndexedHeapTest_t::test<3>()
+    {
+        skip_unless_benchmarks();
+
+        const size_t QUEUED = 4000;
+        const S32 FRAMES = 300;
+        const S32 SERVICED = 32;
+
+        std::cout << std::endl << "FSIndexedHeap churn (" << QUEUED << " queued, " << FRAMES << " frames)" << std::endl;
+        std::cout << std::setw(12) << "updated" << std::setw(14) << "std::set ms" << std::setw(14) << "heap ms"
+                  << std::setw(14) << "rebuild ms" << std::endl;
+
+        const size_t update_counts[] = { 100, 1000, 4000 };
+        for (size_t update_count : update_counts)
+        {
+            F64 times[3];
+            U32 checksums[3];
+            for (S32 mode = 0; mode < 3; ++mode)
+            {
+                mRandom.seed(5678);
+                makeRequests(QUEUED + FRAMES * SERVICED);
+                set_t set;
+                heap_t heap;
+                heap.reserve(mRequests.size());
+                for (size_t i = 0; i < QUEUED; ++i)
+                {
+                    if (mode == 0)
+                        set.insert(&mRequests[i]);
+                    else
+                        heap.push(&mRequests[i]);
+                }
+
+                size_t next_request = QUEUED;
+                U32 checksum = 0;
+                LLTimer timer;
+                for (S32 frame = 0; frame < FRAMES; ++frame)
+                {
+                    for (size_t i = 0; i < update_count; ++i)
+                    {
+                        Request* req = &mRequests[mRandom() % next_request];
+                        U32 priority = randomPriority();
+                        if (mode == 0)
+                        {
+                            if (set.erase(req))
+                            {
+                                req->mPriority = priority;
+                                set.insert(req);
+                            }
+                        }
+                        else
+                        {
+                            req->mPriority = priority;
+                            if (mode == 1)
+                                heap.update(req);
+                        }
+                    }
+                    if (mode == 2)
+                    {
+                        heap.rebuild();
+                    }
+                    for (S32 i = 0; i < SERVICED; ++i)
+                    {
+                        Request* req;
+                        if (mode == 0)
+                        {
+                            req = *set.begin();
+                            set.erase(set.begin());
+                            set.insert(&mRequests[next_request++]);
+                        }
+                        else
+                        {
+                            req = heap.top();
+                            heap.pop();
+                            heap.push(&mRequests[next_request++]);
+                        }
+                        checksum = checksum * 31 + req->mKey;
+                    }
+                }
+                times[mode] = timer.getElapsedTimeF64() * 1000.0;
+                checksums[mode] = checksum;
+            }
+            ensure_equals("heap services the same requests", checksums[1], checksums[0]);
+            ensure_equals("rebuilt heap services the same requests", checksums[2], checksums[0]);
+
+            std::cout << std::setw(12) << update_count << std::fixed << std::setprecision(2)
+                      << std::setw(14) << times[0] << std::setw(14) << times[1] << std::setw(14) << times[2] << std::endl;
+        }
+    }
+}
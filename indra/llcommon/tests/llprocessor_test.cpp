@@ -57,5 +57,6 @@ namespace tut
 		ensure_not_equals("Unknown Brand name", brand, "Unknown"); 
 		ensure_not_equals("Unknown Family name", family, "Unknown"); 
 		ensure("Reasonable CPU Frequency > 100 && < 10000", freq > 100 && freq < 10000);
+		ensure("AVX implies SSE2", !pi.hasAVX() || pi.hasSSE2());
 	}
 }
@@ -96,8 +96,13 @@
 // requests by priority, instead it's first-come-first-served.
 // Reprioritization requests have the side-effect of then
 // putting the modified request at the back of the ready queue.
+// <FS> Addressable ready queue
+// If '0', higher priority values are serviced first and requests
+// of equal priority stay first-come-first-served.
 
-#define	LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY		1
+//#define	LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY		1
+#define	LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY		0
+// </FS>
 
 
 namespace LLCore
@@ -153,6 +158,12 @@ const int HTTP_CONNECTION_LIMIT_MAX = 256;
 const long HTTP_PIPELINING_DEFAULT = 0L;
 const long HTTP_PIPELINING_MAX = 20L;
 
+// <FS> HTTP/2 multiplexing
+// Limit on concurrent streams per policy class
+const long HTTP_HTTP2_STREAM_LIMIT_DEFAULT = 0L;
+const long HTTP_HTTP2_STREAM_LIMIT_MAX = 256L;
+// </FS>
+
 // Miscellaneous defaults
 const bool HTTP_USE_RETRY_AFTER_DEFAULT = true;
 const long HTTP_THROTTLE_RATE_DEFAULT = 0L;
@@ -166,6 +177,13 @@ const int HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS = 2;
 // Block allocation size (a tuning parameter) is found
 // in bufferarray.h.
 
+// <FS> Zero-copy replies
+// Largest body plus headroom (bytes) received into a reserved
+// buffer with HttpOptions::setReserveReplyBody().  Keeps a bogus
+// Content-Length or Content-Range from asking for anything huge.
+const size_t HTTP_REPLY_RESERVE_MAX = 32 * 1024 * 1024;
+// </FS>
+
 }  // end namespace LLCore
 
 #endif	// _LLCORE_HTTP_INTERNAL_H_
@@ -530,7 +530,39 @@ void HttpLibcurl::policyUpdated(int policy_class)
 		policy.stallPolicy(policy_class, false);
 		mDirtyPolicy[policy_class] = false;
 
-		if (options.mPipelining > 1)
+		// <FS> HTTP/2 multiplexing
+		// if (options.mPipelining > 1)
+		if (options.mHttp2StreamLimit > 0)
+		{
+			// Requests become streams multiplexed over few connections.
+			// HTTP/1.1 pipelining stays on as well when the class asked
+			// for it so hosts without HTTP/2 behave as before.
+			check_curl_multi_setopt(multi_handle,
+									 CURLMOPT_PIPELINING,
+									 long(options.mPipelining > 1
+										  ? (CURLPIPE_HTTP1 | CURLPIPE_MULTIPLEX)
+										  : CURLPIPE_MULTIPLEX));
+			if (options.mPipelining > 1)
+			{
+				check_curl_multi_setopt(multi_handle,
+										 CURLMOPT_MAX_PIPELINE_LENGTH,
+										 long(options.mPipelining));
+			}
+			check_curl_multi_setopt(multi_handle,
+									 CURLMOPT_MAX_HOST_CONNECTIONS,
+									 long(options.mPerHostConnectionLimit));
+			check_curl_multi_setopt(multi_handle,
+									 CURLMOPT_MAX_TOTAL_CONNECTIONS,
+									 long(options.mConnectionLimit));
+#if LIBCURL_VERSION_NUM >= 0x074300
+			// Otherwise the server's SETTINGS decide (100 by default)
+			check_curl_multi_setopt(multi_handle,
+									 CURLMOPT_MAX_CONCURRENT_STREAMS,
+									 long(options.mHttp2StreamLimit));
+#endif
+		}
+		else if (options.mPipelining > 1)
+		// </FS>
 		{
 			// We'll try to do pipelining on this multihandle
 			check_curl_multi_setopt(multi_handle,
@@ -42,10 +42,17 @@ namespace LLCore
 // ==================================
 
 
-HttpOpCancel::HttpOpCancel(HttpHandle handle)
+// <FS> Cancel only before the request goes out
+//HttpOpCancel::HttpOpCancel(HttpHandle handle)
+//	: HttpOperation(),
+//	  mHandle(handle)
+//{}
+HttpOpCancel::HttpOpCancel(HttpHandle handle, bool queued_only)
 	: HttpOperation(),
-	  mHandle(handle)
+	  mHandle(handle),
+	  mQueuedOnly(queued_only)
 {}
+// </FS>
 
 
 HttpOpCancel::~HttpOpCancel()
@@ -59,7 +66,7 @@ HttpOpCancel::~HttpOpCancel()
 // its handler.
 void HttpOpCancel::stageFromRequest(HttpService * service)
 {
-	if (! service->cancel(mHandle))
+	if (! service->cancel(mHandle, mQueuedOnly)) // <FS/> Cancel only before the request goes out
 	{
 		mStatus = HttpStatus(HttpStatus::LLCORE, HE_HANDLE_NOT_FOUND);
 	}
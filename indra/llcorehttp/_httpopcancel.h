@@ -54,7 +54,12 @@ class HttpOpCancel : public HttpOperation
 public:
 	/// @param	handle	Handle of previously-issued request to
 	///					be canceled.
-	HttpOpCancel(HttpHandle handle);
+	// <FS> Cancel only before the request goes out
+	//HttpOpCancel(HttpHandle handle);
+	/// @param	queued_only	Leave requests already handed to the
+	///					transport alone.
+	HttpOpCancel(HttpHandle handle, bool queued_only = false);
+	// </FS>
 
 	virtual ~HttpOpCancel();							// Use release()
 	
@@ -64,6 +69,7 @@ public:
 public:
 	// Request data
 	HttpHandle			mHandle;
+	bool				mQueuedOnly; // <FS/>
 };  // end class HttpOpCancel
 
 
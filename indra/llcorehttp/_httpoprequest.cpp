@@ -153,7 +153,11 @@ HttpOpRequest::HttpOpRequest()
 	  mPolicyRetryLimit(HTTP_RETRY_COUNT_DEFAULT),
 	  mPolicyMinRetryBackoff(HttpTime(HTTP_RETRY_BACKOFF_MIN_DEFAULT)),
 	  mPolicyMaxRetryBackoff(HttpTime(HTTP_RETRY_BACKOFF_MAX_DEFAULT)),
-	  mCallbackSSLVerify(NULL)
+	  mCallbackSSLVerify(NULL),
+	  // <FS> Addressable ready queue
+	  mReadyIndex(-1),
+	  mReadySequence(0)
+	  // </FS>
 {
 	// *NOTE:  As members are added, retry initialization/cleanup
 	// may need to be extended in @see prepareRequest().
@@ -750,6 +754,22 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
 /******************************/
 		check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_0);
 	}
+	// <FS> HTTP/2 multiplexing
+	if (cpolicy.mHttp2StreamLimit > 0L)
+	{
+		// HTTP/2 where TLS negotiates it, HTTP/1.1 otherwise.  PIPEWAIT
+		// has a new request wait for a connection it can multiplex on
+		// instead of opening one of its own.  Streams on a connection
+		// finish behind each other much like pipelined requests, so
+		// they get the same transfer timeout headroom.
+		check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+		check_curl_easy_setopt(mCurlHandle, CURLOPT_PIPEWAIT, 1L);
+		if (cpolicy.mPipelining <= 1L)
+		{
+			xfer_timeout *= 2L;
+		}
+	}
+	// </FS>
 	// *DEBUG:  Enable following override for timeout handling and "[curl:bugs] #1420" tests
     //if (cpolicy.mPipelining)
     //{
@@ -788,6 +808,29 @@ size_t HttpOpRequest::writeCallback(void * data, size_t size, size_t nmemb, void
 	if (! op->mReplyBody)
 	{
 		op->mReplyBody = new BufferArray();
+
+		// <FS> Zero-copy replies
+		// Headers are all in by the first write.  A partial response
+		// says where its range goes, anything else starts at zero.
+		if (op->mReqOptions && op->mReqOptions->getReserveReplyBody())
+		{
+			size_t length(op->mReplyLength);
+			if (! length)
+			{
+				double content_length(-1.0);
+				if (CURLE_OK == curl_easy_getinfo(op->mCurlHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &content_length)
+					&& content_length > 0.0 && content_length <= HTTP_REPLY_RESERVE_MAX)
+				{
+					length = size_t(content_length);
+				}
+			}
+			const size_t headroom((op->mReplyLength && op->mReqOptions->getReplyBodyHeadroom()) ? op->mReplyOffset : 0);
+			if (length && length + headroom <= HTTP_REPLY_RESERVE_MAX)
+			{
+				op->mReplyBody->reserve(length, headroom);
+			}
+		}
+		// </FS>
 	}
 	const size_t req_size(size * nmemb);
 	const size_t write_size(op->mReplyBody->append(static_cast<char *>(data), req_size));
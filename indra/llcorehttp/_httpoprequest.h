@@ -38,6 +38,7 @@
 
 #include "httpcommon.h"
 #include "httprequest.h"
+#include "_httpinternal.h"		// <FS/> LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
 #include "_httpoperation.h"
 #include "_refcounted.h"
 
@@ -235,6 +236,10 @@ public:
 	int					mPolicyRetryLimit;
 	HttpTime			mPolicyMinRetryBackoff; // initial delay between retries (mcs)
 	HttpTime			mPolicyMaxRetryBackoff;
+	// <FS> Addressable ready queue
+	S32					mReadyIndex;			// Position in the ready queue heap, -1 when not queued
+	U64					mReadySequence;			// Arrival order in the ready queue
+	// </FS>
 };  // end class HttpOpRequest
 
 
@@ -242,14 +247,31 @@ public:
 /// HttpOpRequestCompare isn't an operation but a uniform comparison
 /// functor for STL containers that order by priority.  Mainly
 /// used for the ready queue container but defined here.
+// <FS> Addressable ready queue
+//
+// Returns true when lhs must be serviced before rhs:  higher priority
+// first, then earlier arrival.  (The old 'greater' test was written
+// for std::priority_queue and put the lowest priority on top.)
 class HttpOpRequestCompare
 {
 public:
-	bool operator()(const HttpOpRequest * lhs, const HttpOpRequest * rhs)
+	bool operator()(const HttpOpRequest * lhs, const HttpOpRequest * rhs) const
 		{
-			return lhs->mReqPriority > rhs->mReqPriority;
+#if ! LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
+			if (lhs->mReqPriority != rhs->mReqPriority)
+			{
+				return lhs->mReqPriority > rhs->mReqPriority;
+			}
+#endif // LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
+			return lhs->mReadySequence < rhs->mReadySequence;
+		}
+
+	bool operator()(const HttpOpRequest::ptr_t & lhs, const HttpOpRequest::ptr_t & rhs) const
+		{
+			return (*this)(lhs.get(), rhs.get());
 		}
 };  // end class HttpOpRequestCompare
+// </FS>
 
 
 // ---------------------------------------
@@ -123,14 +123,22 @@ void HttpPolicy::shutdown()
 			op->cancel();
 		}
 
-		HttpReadyQueue & readyq(state.mReadyQueue);
-		while (! readyq.empty())
+		// <FS> Addressable ready queue
+		//HttpReadyQueue & readyq(state.mReadyQueue);
+		//while (! readyq.empty())
+		//{
+		//	HttpOpRequest::ptr_t op(readyq.top());
+		//	readyq.pop();
+		//
+		//	op->cancel();
+		//}
+		std::vector<HttpOpRequest::ptr_t> ops;
+		state.mReadyQueue.removeAll(ops);
+		for (std::vector<HttpOpRequest::ptr_t>::iterator iter(ops.begin()); ops.end() != iter; ++iter)
 		{
-			HttpOpRequest::ptr_t op(readyq.top());
-			readyq.pop();
-		
-			op->cancel();
+			(*iter)->cancel();
 		}
+		// </FS>
 	}
 }
 
@@ -252,6 +260,13 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 						 ? (state.mOptions.mPerHostConnectionLimit
 							* state.mOptions.mPipelining)
 						 : state.mOptions.mConnectionLimit);
+		// <FS> HTTP/2 multiplexing
+		// Multiplexed classes are throttled on streams, not connections
+		if (state.mOptions.mHttp2StreamLimit > 0L)
+		{
+			active_limit = state.mOptions.mHttp2StreamLimit;
+		}
+		// </FS>
 		int needed(active_limit - active);		// Expect negatives here
 
 		if (needed > 0)
@@ -331,75 +346,124 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 }
 
 
+// <FS> Addressable ready queue
+//bool HttpPolicy::changePriority(HttpHandle handle, HttpRequest::priority_t priority)
+//{
+//	for (int policy_class(0); policy_class < mClasses.size(); ++policy_class)
+//	{
+//		ClassState & state(*mClasses[policy_class]);
+//		// We don't scan retry queue because a priority change there
+//		// is meaningless.  The request will be issued based on retry
+//		// intervals not priority value, which is now moot.
+//		
+//		// Scan ready queue for requests that match policy
+//		HttpReadyQueue::container_type & c(state.mReadyQueue.get_container());
+//		for (HttpReadyQueue::container_type::iterator iter(c.begin()); c.end() != iter;)
+//		{
+//			HttpReadyQueue::container_type::iterator cur(iter++);
+//
+//			if ((*cur)->getHandle() == handle)
+//			{
+//				HttpOpRequest::ptr_t op(*cur);
+//				c.erase(cur);									// All iterators are now invalidated
+//				op->mReqPriority = priority;
+//				state.mReadyQueue.push(op);						// Re-insert using adapter class
+//				return true;
+//			}
+//		}
+//	}
+//	
+//	return false;
+//}
+//
+//
+//bool HttpPolicy::cancel(HttpHandle handle)
+//{
+//	for (int policy_class(0); policy_class < mClasses.size(); ++policy_class)
+//	{
+//		ClassState & state(*mClasses[policy_class]);
+//
+//		// Scan retry queue
+//		HttpRetryQueue::container_type & c1(state.mRetryQueue.get_container());
+//		for (HttpRetryQueue::container_type::iterator iter(c1.begin()); c1.end() != iter;)
+//		{
+//			HttpRetryQueue::container_type::iterator cur(iter++);
+//
+//			if ((*cur)->getHandle() == handle)
+//			{
+//				HttpOpRequest::ptr_t op(*cur);
+//				c1.erase(cur);									// All iterators are now invalidated
+//				op->cancel();
+//				return true;
+//			}
+//		}
+//		
+//		// Scan ready queue
+//		HttpReadyQueue::container_type & c2(state.mReadyQueue.get_container());
+//		for (HttpReadyQueue::container_type::iterator iter(c2.begin()); c2.end() != iter;)
+//		{
+//			HttpReadyQueue::container_type::iterator cur(iter++);
+//
+//			if ((*cur)->getHandle() == handle)
+//			{
+//				HttpOpRequest::ptr_t op(*cur);
+//				c2.erase(cur);									// All iterators are now invalidated
+//				op->cancel();
+//				return true;
+//			}
+//		}
+//	}
+//	
+//	return false;
+//}
+// Both used to scan every ready queue for the handle and erase from the
+// middle of the container.  The operation now knows its policy class and
+// its position in that class's ready queue.
 bool HttpPolicy::changePriority(HttpHandle handle, HttpRequest::priority_t priority)
 {
-	for (int policy_class(0); policy_class < mClasses.size(); ++policy_class)
+	HttpOpRequest::ptr_t op(HttpOpRequest::fromHandle<HttpOpRequest>(handle));
+	if (! op || op->mReqPolicy >= mClasses.size())
 	{
-		ClassState & state(*mClasses[policy_class]);
-		// We don't scan retry queue because a priority change there
-		// is meaningless.  The request will be issued based on retry
-		// intervals not priority value, which is now moot.
-		
-		// Scan ready queue for requests that match policy
-		HttpReadyQueue::container_type & c(state.mReadyQueue.get_container());
-		for (HttpReadyQueue::container_type::iterator iter(c.begin()); c.end() != iter;)
-		{
-			HttpReadyQueue::container_type::iterator cur(iter++);
-
-			if ((*cur)->getHandle() == handle)
-			{
-				HttpOpRequest::ptr_t op(*cur);
-				c.erase(cur);									// All iterators are now invalidated
-				op->mReqPriority = priority;
-				state.mReadyQueue.push(op);						// Re-insert using adapter class
-				return true;
-			}
-		}
+		return false;
 	}
-	
-	return false;
+
+	// We don't look at the retry queue because a priority change there
+	// is meaningless.  The request will be issued based on retry
+	// intervals not priority value, which is now moot.
+	return mClasses[op->mReqPolicy]->mReadyQueue.changePriority(op, priority);
 }
 
 
 bool HttpPolicy::cancel(HttpHandle handle)
 {
-	for (int policy_class(0); policy_class < mClasses.size(); ++policy_class)
+	HttpOpRequest::ptr_t op(HttpOpRequest::fromHandle<HttpOpRequest>(handle));
+	if (! op || op->mReqPolicy >= mClasses.size())
 	{
-		ClassState & state(*mClasses[policy_class]);
+		return false;
+	}
+	ClassState & state(*mClasses[op->mReqPolicy]);
 
-		// Scan retry queue
-		HttpRetryQueue::container_type & c1(state.mRetryQueue.get_container());
-		for (HttpRetryQueue::container_type::iterator iter(c1.begin()); c1.end() != iter;)
-		{
-			HttpRetryQueue::container_type::iterator cur(iter++);
+	if (state.mReadyQueue.remove(op))
+	{
+		op->cancel();
+		return true;
+	}
 
-			if ((*cur)->getHandle() == handle)
-			{
-				HttpOpRequest::ptr_t op(*cur);
-				c1.erase(cur);									// All iterators are now invalidated
-				op->cancel();
-				return true;
-			}
-		}
-		
-		// Scan ready queue
-		HttpReadyQueue::container_type & c2(state.mReadyQueue.get_container());
-		for (HttpReadyQueue::container_type::iterator iter(c2.begin()); c2.end() != iter;)
+	// Scan retry queue, it only holds requests sitting out a backoff
+	HttpRetryQueue::container_type & c(state.mRetryQueue.get_container());
+	for (HttpRetryQueue::container_type::iterator iter(c.begin()); c.end() != iter; ++iter)
+	{
+		if (*iter == op)
 		{
-			HttpReadyQueue::container_type::iterator cur(iter++);
-
-			if ((*cur)->getHandle() == handle)
-			{
-				HttpOpRequest::ptr_t op(*cur);
-				c2.erase(cur);									// All iterators are now invalidated
-				op->cancel();
-				return true;
-			}
+			c.erase(iter);										// All iterators are now invalidated
+			op->cancel();
+			return true;
 		}
 	}
 	
 	return false;
 }
+// </FS>
 
 
 bool HttpPolicy::stageAfterCompletion(const HttpOpRequest::ptr_t &op)
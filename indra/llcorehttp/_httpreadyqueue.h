@@ -28,7 +28,12 @@
 #define	_LLCORE_HTTP_READY_QUEUE_H_
 
 
-#include <queue>
+// <FS> Addressable ready queue
+//#include <queue>
+#include <vector>
+
+#include "fsindexedheap.h"
+// </FS>
 
 #include "_httpinternal.h"
 #include "_httpoprequest.h"
@@ -37,40 +42,32 @@
 namespace LLCore
 {
 
-/// HttpReadyQueue provides a simple priority queue for HttpOpRequest objects.
+// <FS> Addressable ready queue
+/// HttpReadyQueue provides the priority queue of HttpOpRequest objects
+/// waiting for a transport slot in one policy class.
 ///
-/// This uses the priority_queue adaptor class to provide the queue
-/// as well as the ordering scheme while allowing us access to the
-/// raw container if we follow a few simple rules.  One of the more
-/// important of those rules is that any iterator becomes invalid
-/// on element erasure.  So pay attention.
+/// Requests are serviced highest priority first and first-come,
+/// first-served among equal priorities, so a class whose callers all
+/// use a single priority value still behaves as a plain FIFO.  Every
+/// queued request records its own heap position (mReadyIndex), so
+/// one can be reprioritized or taken out in O(log n) instead of
+/// scanning the container and rebuilding it.
 ///
-/// If LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY tests true, the class
-/// implements a std::priority_queue interface but on std::deque
-/// behavior to eliminate sensitivity to priority.  In the future,
-/// this will likely become the only behavior or it may become
-/// a run-time election.
+/// If LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY tests true, priority
+/// values are ignored and the queue is strictly first-come,
+/// first-served.  Reprioritization then moves the request to the
+/// back of the queue.
 ///
 /// Threading:  not thread-safe.  Expected to be used entirely by
 /// a single thread, typically a worker thread of some sort.
 
-#if LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
-
-typedef std::deque<HttpOpRequest::ptr_t> HttpReadyQueueBase;
-
-#else
-
-typedef std::priority_queue<HttpOpRequest::ptr_t,
-							std::deque<HttpOpRequest::ptr_t>,
-							LLCore::HttpOpRequestCompare> HttpReadyQueueBase;
-
-#endif // LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
-
-class HttpReadyQueue : public HttpReadyQueueBase
+class HttpReadyQueue
 {
 public:
+	typedef HttpOpRequest::ptr_t value_type;
+
 	HttpReadyQueue()
-		: HttpReadyQueueBase()
+		: mSequence(0)
 		{}
 	
 	~HttpReadyQueue()
@@ -81,41 +78,87 @@ protected:
 	void operator=(const HttpReadyQueue &);		// Not defined
 
 public:
+	bool empty() const
+		{
+			return mHeap.empty();
+		}
 
-#if LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
-	// Types and methods needed to make a std::deque look
-	// more like a std::priority_queue, at least for our
-	// purposes.
-	typedef HttpReadyQueueBase container_type;
-	
-	const_reference top() const
+	size_t size() const
 		{
-			return front();
+			return mHeap.size();
+		}
+
+	/// Next request to service.  Queue must not be empty.
+	const value_type & top() const
+		{
+			return mHeap.top();
 		}
 
 	void pop()
 		{
-			pop_front();
+			mHeap.pop();
 		}
 
-	void push(const value_type & v)
+	void push(const value_type & op)
 		{
-			push_back(v);
+			op->mReadySequence = ++mSequence;
+			mHeap.push(op);
 		}
-	
+
+	/// Gives a queued request a new priority and moves it to its
+	/// new place in the queue.
+	///
+	/// @return			False if the request is not in this queue,
+	///					in which case it is left untouched.
+	bool changePriority(const value_type & op, HttpRequest::priority_t priority)
+		{
+			if (! mHeap.contains(op))
+			{
+				return false;
+			}
+			op->mReqPriority = priority;
+#if LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
+			op->mReadySequence = ++mSequence;
 #endif // LLCORE_HTTP_READY_QUEUE_IGNORES_PRIORITY
-	
-	const container_type & get_container() const
+			mHeap.update(op);
+			return true;
+		}
+
+	/// Takes a request out of the queue.
+	///
+	/// @return			False if the request is not in this queue.
+	bool remove(const value_type & op)
 		{
-			return *this;
+			return mHeap.erase(op) != 0;
 		}
 
-	container_type & get_container()
+	/// Empties the queue, appending the requests to ops in the order
+	/// they would have been serviced.  Used for bulk cancellation.
+	void removeAll(std::vector<value_type> & ops)
 		{
-			return *this;
+			ops.reserve(ops.size() + mHeap.size());
+			while (! mHeap.empty())
+			{
+				ops.push_back(mHeap.top());
+				mHeap.pop();
+			}
 		}
-	
+
+private:
+	struct ReadyIndex
+	{
+		S32 & operator()(const value_type & op) const
+			{
+				return op->mReadyIndex;
+			}
+	};
+
+	typedef FSIndexedHeap<value_type, HttpOpRequestCompare, ReadyIndex> heap_t;
+
+	heap_t				mHeap;
+	U64					mSequence;			// Arrival counter, breaks priority ties
 }; // end class HttpReadyQueue
+// </FS>
 
 
 }  // end namespace LLCore
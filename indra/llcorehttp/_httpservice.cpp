@@ -63,7 +63,8 @@ const HttpService::OptionDescriptor HttpService::sOptionDesc[] =
 	{	true,		true,		true,		false,		false	},		// PO_TRACE
 	{	true,		true,		false,		true,		false	},		// PO_ENABLE_PIPELINING
 	{	true,		true,		false,		true,		false	},		// PO_THROTTLE_RATE
-	{   false,		false,		true,		false,		true	}		// PO_SSL_VERIFY_CALLBACK
+	{   false,		false,		true,		false,		true	},		// PO_SSL_VERIFY_CALLBACK
+	{	true,		true,		false,		true,		false	}		// PO_HTTP2_STREAM_LIMIT // <FS/>
 };
 HttpService * HttpService::sInstance(NULL);
 volatile HttpService::EState HttpService::sState(NOT_INITIALIZED);
@@ -242,7 +243,10 @@ bool HttpService::changePriority(HttpHandle handle, HttpRequest::priority_t prio
 /// @return			True if the request was canceled.
 ///
 /// Threading:  callable by worker thread.
-bool HttpService::cancel(HttpHandle handle)
+// <FS> Cancel only before the request goes out
+//bool HttpService::cancel(HttpHandle handle)
+bool HttpService::cancel(HttpHandle handle, bool queued_only)
+// </FS>
 {
 	bool canceled(false);
 
@@ -251,7 +255,7 @@ bool HttpService::cancel(HttpHandle handle)
 	// Check the policy component's queues first
 	canceled = mPolicy->cancel(handle);
 
-	if (! canceled)
+	if (! canceled && ! queued_only) // <FS/> Cancel only before the request goes out
 	{
 		// If that didn't work, check transport's.
 		canceled = mTransport->cancel(handle);
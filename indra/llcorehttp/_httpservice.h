@@ -161,7 +161,10 @@ public:
 	/// @return			True if the request was found and canceled.
 	///
 	/// Threading:  callable by worker thread.
-	bool cancel(HttpHandle handle);
+	// <FS> Cancel only before the request goes out
+	//bool cancel(HttpHandle handle);
+	bool cancel(HttpHandle handle, bool queued_only = false);
+	// </FS>
 	
 	/// Threading:  callable by worker thread.
 	HttpPolicy & getPolicy()
@@ -71,14 +71,28 @@ public:
 	// Only public entry to get a block.
 	static Block * alloc(size_t len);
 
+	// <FS> Zero-copy replies
+	// A block over a separate 16-byte aligned allocation with
+	// 'headroom' bytes in front of the data.  NULL on failure.
+	static Block * allocAligned(size_t len, size_t headroom);
+	// </FS>
+
 public:
 	size_t mUsed;
 	size_t mAlloced;
 
+	// <FS> Zero-copy replies
+	char * mBuffer;		// Aligned allocation holding mData, NULL when inline
+	char * mData;		// mStorage or inside mBuffer
+	// </FS>
+
 	// *NOTE:  Must be last member of the object.  We'll
 	// overallocate as requested via operator new and index
 	// into the array at will.
-	char mData[1];		
+	// <FS> Zero-copy replies
+	//char mData[1];		
+	char mStorage[1];
+	// </FS>
 };
 
 
@@ -184,6 +198,59 @@ void * BufferArray::appendBufferAlloc(size_t len)
 }
 
 
+// <FS> Zero-copy replies
+bool BufferArray::reserve(size_t len, size_t headroom)
+{
+	if (! mBlocks.empty() || ! len)
+	{
+		return false;
+	}
+	Block * block = Block::allocAligned(len, headroom);
+	if (! block)
+	{
+		return false;
+	}
+	mBlocks.push_back(block);
+	return true;
+}
+
+
+void * BufferArray::detachBuffer(size_t * headroom)
+{
+	if (1 != mBlocks.size() || ! mBlocks[0]->mBuffer)
+	{
+		return NULL;
+	}
+
+	Block * block(mBlocks[0]);
+	void * buffer(block->mBuffer);
+	*headroom = block->mData - block->mBuffer;
+	block->mBuffer = NULL;
+	delete block;
+	mBlocks.clear();
+	mLen = 0;
+	return buffer;
+}
+
+
+void * BufferArray::getContiguous(size_t pos, size_t len)
+{
+	if (! len || len > mLen || pos > mLen - len)
+	{
+		return NULL;
+	}
+
+	size_t offset(0);
+	const int block(findBlock(pos, &offset));
+	if (block < 0 || offset + len > mBlocks[block]->mUsed)
+	{
+		return NULL;
+	}
+	return &mBlocks[block]->mData[offset];
+}
+// </FS>
+
+
 size_t BufferArray::read(size_t pos, void * dst, size_t len)
 {
 	char * c_dst(static_cast<char *>(dst));
@@ -325,7 +392,9 @@ bool BufferArray::getBlockStartEnd(int block, const char ** start, const char **
 
 BufferArray::Block::Block(size_t len)
 	: mUsed(0),
-	  mAlloced(len)
+	  mAlloced(len),
+	  mBuffer(NULL), // <FS> Zero-copy replies
+	  mData(mStorage) // <FS> Zero-copy replies
 {
 	memset(mData, 0, len);
 }
@@ -333,6 +402,13 @@ BufferArray::Block::Block(size_t len)
 
 BufferArray::Block::~Block()
 {
+	// <FS> Zero-copy replies
+	if (mBuffer)
+	{
+		ll_aligned_free_16(mBuffer);
+		mBuffer = NULL;
+	}
+	// </FS>
 	mUsed = 0;
 	mAlloced = 0;
 }
@@ -363,6 +439,25 @@ BufferArray::Block * BufferArray::Block::alloc(size_t len)
 	Block * block = new (len) Block(len);
 	return block;
 }
+
+
+// <FS> Zero-copy replies
+BufferArray::Block * BufferArray::Block::allocAligned(size_t len, size_t headroom)
+{
+	char * buffer = static_cast<char *>(ll_aligned_malloc_16(headroom + len));
+	if (! buffer)
+	{
+		return NULL;
+	}
+	// Data is only valid once written, so unlike alloc() there is
+	// nothing to clear.
+	Block * block = new (0) Block(0);
+	block->mBuffer = buffer;
+	block->mData = buffer + headroom;
+	block->mAlloced = len;
+	return block;
+}
+// </FS>
 	
 
 }  // end namespace LLCore
@@ -104,6 +104,34 @@ public:
 	///					of BufferArray of 'len' size.
 	void * appendBufferAlloc(size_t len);
 
+	// <FS> Zero-copy replies
+	/// Prepares an empty BufferArray to receive 'len' bytes into a
+	/// single contiguous, 16-byte aligned buffer which keeps
+	/// 'headroom' unused bytes in front of the data.  Data appended
+	/// beyond 'len' goes to ordinary blocks.
+	/// @return			False if the instance isn't empty or the
+	///					buffer couldn't be allocated.
+	bool reserve(size_t len, size_t headroom = 0);
+
+	/// Hands the buffer set up by @see reserve() over to the caller
+	/// when it holds all of the data.  The data starts '*headroom'
+	/// bytes into the returned buffer which must be released with
+	/// ll_aligned_free_16(), so it can become LLImageBase data as
+	/// is.  The instance is left empty.
+	/// @return			Buffer or NULL, with no change to the
+	///					instance, if the data isn't all in a
+	///					reserved buffer.
+	void * detachBuffer(size_t * headroom);
+
+	/// Pointer to 'len' bytes of data starting at 'pos' when they
+	/// are contiguous, which they are when they lie in the first
+	/// BLOCK_ALLOC_SIZE bytes or in a reserved buffer.  Remains
+	/// valid until the instance is modified.
+	/// @return			NULL if the range crosses blocks or
+	///					extends beyond the data.
+	void * getContiguous(size_t pos, size_t len);
+	// </FS>
+
 	/// Current count of bytes in BufferArray instance.
 	size_t size() const
 		{
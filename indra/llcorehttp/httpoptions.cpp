@@ -48,7 +48,11 @@ HttpOptions::HttpOptions() :
     mVerifyHost(false),
     mDNSCacheTimeout(-1L),
     mNoBody(false),
-	mLastModified(0) // <FS:Ansariel> GetIfModified request
+	mLastModified(0), // <FS:Ansariel> GetIfModified request
+	// <FS> Zero-copy replies
+	mReserveReplyBody(false),
+	mReplyBodyHeadroom(false)
+	// </FS>
 {}
 
 
@@ -142,4 +146,12 @@ void HttpOptions::setLastModified(long last_modified)
 }
 // </FS:Ansariel>
 
+// <FS> Zero-copy replies
+void HttpOptions::setReserveReplyBody(bool reserve, bool headroom)
+{
+	mReserveReplyBody = reserve;
+	mReplyBodyHeadroom = reserve && headroom;
+}
+// </FS>
+
 }   // end namespace LLCore
@@ -192,6 +192,27 @@ public:
 		return mLastModified;
 	}
 	// </FS:Ansariel>
+
+	// <FS> Zero-copy replies
+	/// When the length of a response body is known from its headers,
+	/// receive it into a single contiguous, 16-byte aligned buffer that
+	/// BufferArray::getContiguous() can read in place and
+	/// BufferArray::detachBuffer() can hand over without a copy.  With
+	/// 'headroom' the buffer of a partial (206) response also leaves
+	/// room for the bytes in front of the returned range, so the caller
+	/// can complete a larger resource in place.  Meant for the modest
+	/// bodies of texture and mesh fetches.
+	/// Default: false, false
+	void				setReserveReplyBody(bool reserve, bool headroom = false);
+	bool				getReserveReplyBody() const
+	{
+		return mReserveReplyBody;
+	}
+	bool				getReplyBodyHeadroom() const
+	{
+		return mReplyBodyHeadroom;
+	}
+	// </FS>
 	
 protected:
 	bool				mWantHeaders;
@@ -211,6 +232,10 @@ protected:
     static bool         sDefaultVerifyPeer;
 
 	long				mLastModified; // <FS:Ansariel> GetIfModified request
+	// <FS> Zero-copy replies
+	bool				mReserveReplyBody;
+	bool				mReplyBodyHeadroom;
+	// </FS>
 }; // end class HttpOptions
 
 
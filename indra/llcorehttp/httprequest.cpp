@@ -483,6 +483,25 @@ HttpHandle HttpRequest::requestCancel(HttpHandle request, HttpHandler::ptr_t use
 }
 
 
+// <FS> Cancel only before the request goes out
+HttpHandle HttpRequest::requestCancelQueued(HttpHandle request, HttpHandler::ptr_t user_handler)
+{
+	HttpStatus status;
+
+	HttpOperation::ptr_t op(new HttpOpCancel(request, true));
+	op->setReplyPath(mReplyQueue, user_handler);
+	if (! (status = mRequestQueue->addOp(op)))			// transfers refcount
+	{
+		mLastReqStatus = status;
+		return LLCORE_HTTP_HANDLE_INVALID;
+	}
+
+	mLastReqStatus = status;
+	return op->getHandle();
+}
+// </FS>
+
+
 HttpHandle HttpRequest::requestSetPriority(HttpHandle request, priority_t priority,
 										   HttpHandler::ptr_t handler)
 {
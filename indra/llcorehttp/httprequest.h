@@ -233,6 +233,22 @@ public:
 		/// Global only
 		PO_SSL_VERIFY_CALLBACK,
 
+		// <FS> HTTP/2 multiplexing
+		/// Opts the policy class into HTTP/2.  Positive values
+		/// ask libcurl to negotiate HTTP/2 (over TLS, via ALPN)
+		/// and multiplex requests as streams over as few
+		/// connections as it can, and give the number of requests
+		/// the class keeps in flight.  That stream count replaces
+		/// the PO_CONNECTION_LIMIT/PO_PIPELINING_DEPTH in-flight
+		/// limit; the connection limits still cap the sockets
+		/// libcurl may open, which matters for hosts that only
+		/// speak HTTP/1.1 or for plain http: URLs.  Zero, the
+		/// default, leaves the class on HTTP/1.1.
+		///
+		/// Per-class only
+		PO_HTTP2_STREAM_LIMIT,
+		// </FS>
+
 		PO_LAST  // Always at end
 	};
 
@@ -593,6 +609,14 @@ public:
 	
 	HttpHandle requestCancel(HttpHandle request, HttpHandler::ptr_t);
 
+	// <FS> Cancel only before the request goes out
+	/// Like requestCancel() but only cancels a request that is still
+	/// waiting in a policy class queue.  A request that is already on a
+	/// connection is left to complete and this request then completes
+	/// with an HE_HANDLE_NOT_FOUND status.
+	HttpHandle requestCancelQueued(HttpHandle request, HttpHandler::ptr_t);
+	// </FS>
+
 	/// Request that a previously-issued request be reprioritized.
 	/// The status of whether the change itself succeeded arrives
 	/// via notification.  
@@ -29,6 +29,9 @@
 #include "bufferarray.h"
 
 #include <iostream>
+#include <vector> // <FS/> Zero-copy replies
+
+#include "llmemory.h" // <FS/> Zero-copy replies
 
 
 using namespace LLCore;
@@ -374,6 +377,92 @@ void BufferArrayTestObjectType::test<8>()
 	ba->release();
 }
 
+// <FS> Zero-copy replies
+template <> template <>
+void BufferArrayTestObjectType::test<9>()
+{
+	set_test_name("BufferArray reserved buffer with headroom");
+
+	// create a new ref counted object with an implicit reference
+	BufferArray * ba = new BufferArray();
+
+	// Reserve for two appends that together cross a block size
+	const size_t headroom(100);
+	const size_t body_len(BufferArray::BLOCK_ALLOC_SIZE + 1000);
+	ensure("Reserved", ba->reserve(body_len, headroom));
+	ensure("Reserve only when empty", ! ba->reserve(body_len));
+	ensure("Nothing in BA", 0 == ba->size());
+
+	std::vector<char> body(body_len);
+	for (size_t i(0); i < body_len; ++i)
+	{
+		body[i] = char(i * 7);
+	}
+	ba->append(&body[0], 1000);
+	ba->append(&body[1000], body_len - 1000);
+	ensure("All appended", body_len == ba->size());
+
+	const char * whole(static_cast<const char *>(ba->getContiguous(0, body_len)));
+	ensure("Contiguous across the block size", NULL != whole);
+	ensure("Contiguous tail", whole + 500 == ba->getContiguous(500, body_len - 500));
+	ensure("Range beyond data", NULL == ba->getContiguous(1, body_len));
+
+	size_t out_headroom(0);
+	char * buffer(static_cast<char *>(ba->detachBuffer(&out_headroom)));
+	ensure("Detached", NULL != buffer);
+	ensure("Headroom kept", headroom == out_headroom);
+	ensure("Data in place", buffer + headroom == whole);
+	ensure("Content correct", 0 == memcmp(buffer + headroom, &body[0], body_len));
+	ensure("BA left empty", 0 == ba->size());
+	ensure("Nothing left to detach", NULL == ba->detachBuffer(&out_headroom));
+	ll_aligned_free_16(buffer);
+
+	// Usable again
+	ba->append(&body[0], 10);
+	ensure("Appended after detach", 10 == ba->size());
+	
+	// release the implicit reference, causing the object to be released
+	ba->release();
+}
+
+template <> template <>
+void BufferArrayTestObjectType::test<10>()
+{
+	set_test_name("BufferArray reserved buffer overflow");
+
+	// create a new ref counted object with an implicit reference
+	BufferArray * ba = new BufferArray();
+
+	// More data than reserved spills into ordinary blocks
+	char str1[] = "abcdefghij";
+	size_t str1_len(strlen(str1));
+	ensure("Reserved", ba->reserve(str1_len - 2));
+	ba->append(str1, str1_len);
+	ensure("All appended", str1_len == ba->size());
+	ensure("Reserved part contiguous", NULL != ba->getContiguous(0, str1_len - 2));
+	ensure("Not contiguous across the spill", NULL == ba->getContiguous(0, str1_len));
+
+	size_t headroom(0);
+	ensure("Split data not detached", NULL == ba->detachBuffer(&headroom));
+
+	char buffer[256];
+	memset(buffer, 'X', sizeof(buffer));
+	size_t len(ba->read(0, buffer, sizeof(buffer)));
+	ensure("Read length correct", str1_len == len);
+	ensure("Read content correct", 0 == strncmp(buffer, str1, str1_len));
+
+	// Without a reservation, data is not in a buffer that can be handed over
+	BufferArray * ba2 = new BufferArray();
+	ba2->append(str1, str1_len);
+	ensure("Small body contiguous", NULL != ba2->getContiguous(2, str1_len - 2));
+	ensure("Plain block not detached", NULL == ba2->detachBuffer(&headroom));
+	
+	// release the implicit references, causing the objects to be released
+	ba2->release();
+	ba->release();
+}
+// </FS>
+
 }  // end namespace tut
 
 
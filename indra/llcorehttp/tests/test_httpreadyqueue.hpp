@@ -0,0 +1,171 @@
+/**
+ * @file test_httpreadyqueue.hpp
+ * @brief unit tests for the LLCore::HttpReadyQueue class
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+#ifndef TEST_LLCORE_HTTP_READYQUEUE_H_
+#define TEST_LLCORE_HTTP_READYQUEUE_H_
+
+#include "httpcommon.h"
+#include "_httpreadyqueue.h"
+
+#include <iostream>
+#include <vector>
+
+
+using namespace LLCore;
+
+
+
+namespace tut
+{
+
+struct HttpReadyqueueTestData
+{
+	// the test objects inherit from this so the member functions and variables
+	// can be referenced directly inside of the test functions.
+
+	HttpOpRequest::ptr_t makeOp(HttpRequest::priority_t priority)
+		{
+			HttpOpRequest::ptr_t op(new HttpOpRequest());
+			op->mReqPriority = priority;
+			return op;
+		}
+};
+
+typedef test_group<HttpReadyqueueTestData> HttpReadyqueueTestGroupType;
+typedef HttpReadyqueueTestGroupType::object HttpReadyqueueTestObjectType;
+HttpReadyqueueTestGroupType HttpReadyqueueTestGroup("HttpReadyqueue Tests");
+
+template <> template <>
+void HttpReadyqueueTestObjectType::test<1>()
+{
+	set_test_name("HttpReadyQueue priority then arrival order");
+
+	HttpReadyQueue readyq;
+	const HttpRequest::priority_t priorities[] = { 5, 1, 9, 5, 1, 9, 0, 5 };
+	std::vector<HttpOpRequest::ptr_t> ops;
+	for (int i(0); i < 8; ++i)
+	{
+		ops.push_back(makeOp(priorities[i]));
+		readyq.push(ops.back());
+	}
+	ensure_equals("All queued", readyq.size(), size_t(8));
+
+	// Highest priority first, first-come first-served among equals
+	const int expected[] = { 2, 5, 0, 3, 7, 1, 4, 6 };
+	for (int i(0); i < 8; ++i)
+	{
+		ensure("Service order", readyq.top() == ops[expected[i]]);
+		readyq.pop();
+		ensure_equals("Popped request is unindexed", ops[expected[i]]->mReadyIndex, -1);
+	}
+	ensure("Empty", readyq.empty());
+}
+
+template <> template <>
+void HttpReadyqueueTestObjectType::test<2>()
+{
+	set_test_name("HttpReadyQueue reprioritization");
+
+	HttpReadyQueue readyq;
+	std::vector<HttpOpRequest::ptr_t> ops;
+	for (int i(0); i < 100; ++i)
+	{
+		ops.push_back(makeOp(10));
+		readyq.push(ops.back());
+	}
+
+	// Equal priorities are a plain FIFO
+	ensure("FIFO head", readyq.top() == ops[0]);
+
+	ensure("Raised", readyq.changePriority(ops[60], 20));
+	ensure_equals("Priority stored", ops[60]->mReqPriority, HttpRequest::priority_t(20));
+	ensure("Raised request is next", readyq.top() == ops[60]);
+
+	ensure("Lowered", readyq.changePriority(ops[60], 5));
+	ensure("Lowered request gave up its place", readyq.top() == ops[0]);
+
+	ensure("Raised tie", readyq.changePriority(ops[99], 10));
+	for (int i(0); i < 100; ++i)
+	{
+		if (i == 60)
+		{
+			continue;
+		}
+		ensure("Arrival order kept", readyq.top() == ops[i]);
+		readyq.pop();
+	}
+	ensure("Lowest last", readyq.top() == ops[60]);
+	readyq.pop();
+
+	// Requests no longer queued are left alone
+	ensure("Not queued", ! readyq.changePriority(ops[0], 50));
+	ensure_equals("Priority untouched", ops[0]->mReqPriority, HttpRequest::priority_t(10));
+}
+
+template <> template <>
+void HttpReadyqueueTestObjectType::test<3>()
+{
+	set_test_name("HttpReadyQueue removal");
+
+	HttpReadyQueue readyq, otherq;
+	std::vector<HttpOpRequest::ptr_t> ops;
+	for (int i(0); i < 50; ++i)
+	{
+		ops.push_back(makeOp(i % 7));
+		readyq.push(ops.back());
+	}
+	HttpOpRequest::ptr_t stranger(makeOp(3));
+	otherq.push(stranger);
+
+	ensure("Removed", readyq.remove(ops[17]));
+	ensure("Removed once", ! readyq.remove(ops[17]));
+	ensure("Other queue's request", ! readyq.remove(stranger));
+	ensure_equals("Other queue untouched", otherq.size(), size_t(1));
+	ensure("Removed top", readyq.remove(readyq.top()));
+	ensure_equals("Remaining", readyq.size(), size_t(48));
+
+	// Bulk removal hands back the requests in service order
+	std::vector<HttpOpRequest::ptr_t> removed;
+	readyq.removeAll(removed);
+	ensure("Emptied", readyq.empty());
+	ensure_equals("All handed back", removed.size(), size_t(48));
+	HttpOpRequestCompare before;
+	for (size_t i(1); i < removed.size(); ++i)
+	{
+		ensure("Service order", before(removed[i - 1], removed[i]));
+		ensure_equals("Unindexed", removed[i]->mReadyIndex, -1);
+	}
+
+	// And they can be queued again
+	readyq.push(removed[0]);
+	ensure("Requeued", readyq.top() == removed[0]);
+	readyq.pop();
+	otherq.pop();
+}
+
+}  // end namespace tut
+
+#endif  // TEST_LLCORE_HTTP_READYQUEUE_H_
@@ -34,10 +34,13 @@
 #include "httpoptions.h"
 #include "_httpservice.h"
 #include "_httprequestqueue.h"
+#include "lltimer.h"				// <FS/> HTTP/2 multiplexing
 
 #include <curl/curl.h>
 #include <boost/regex.hpp>
 #include <sstream>
+#include <iomanip>		// <FS/> HTTP/2 multiplexing
+#include <algorithm>	// <FS/> HTTP/2 multiplexing
 
 #include "llcorehttp_test.h"
 
@@ -3018,6 +3021,180 @@ void HttpRequestTestObjectType::test<23>()
 	}
 }
 
+// <FS> HTTP/2 multiplexing
+template <> template <>
+void HttpRequestTestObjectType::test<24>()
+{
+	ScopedCurlInit ready;
+
+	set_test_name("HttpRequest many small GETs, HTTP/1.1 vs. HTTP/2");
+
+	// Needs an https: server that speaks HTTP/2, e.g. a local nginx
+	// with 'listen 8443 ssl http2' and a self-signed certificate.
+	// The peer script's server is HTTP/1.0 only.
+	const char * env(getenv("LL_TEST_HTTP2_URL"));
+	if (! env)
+	{
+		skip("LL_TEST_HTTP2_URL not set, no HTTP/2 server to compare against");
+	}
+	const std::string url(env);
+
+	// Completions with the libcurl time each request took
+	class TimingHandler : public LLCore::HttpHandler
+	{
+	public:
+		TimingHandler()
+			: mCalls(0),
+			  mFailures(0),
+			  mTotalTime(0.0),
+			  mMaxTime(0.0)
+			{}
+
+		virtual void onCompleted(HttpHandle, HttpResponse * response)
+			{
+				++mCalls;
+				if (! response || ! response->getStatus())
+				{
+					++mFailures;
+					return;
+				}
+				HttpResponse::TransferStats::ptr_t stats(response->getTransferStats());
+				if (stats)
+				{
+					mTotalTime += stats->mTotalTime;
+					mMaxTime = (std::max)(mMaxTime, stats->mTotalTime);
+				}
+			}
+
+		int mCalls;
+		int mFailures;
+		F64 mTotalTime;
+		F64 mMaxTime;
+	};
+
+	const int request_count(400);
+	const long connections(8L);
+	const long streams(64L);
+	
+	HttpRequest * req = NULL;
+	HttpOptions::ptr_t opts;
+	
+	try
+	{
+		HttpRequest::createService();
+
+		// Same connection limits in both classes; only the second
+		// multiplexes.  Options have to be in place before the
+		// thread starts.
+		HttpRequest::policy_t http1_class(HttpRequest::createPolicyClass());
+		HttpRequest::policy_t http2_class(HttpRequest::createPolicyClass());
+		ensure("Policy classes created", http1_class && http2_class && http1_class != http2_class);
+		const HttpRequest::policy_t classes[] = { http1_class, http2_class };
+		for (int i(0); i < 2; ++i)
+		{
+			ensure("Connection limit set",
+				   HttpRequest::setStaticPolicyOption(HttpRequest::PO_CONNECTION_LIMIT, classes[i], connections, NULL));
+			ensure("Per-host connection limit set",
+				   HttpRequest::setStaticPolicyOption(HttpRequest::PO_PER_HOST_CONNECTION_LIMIT, classes[i], connections, NULL));
+		}
+		ensure("HTTP/2 stream limit set",
+			   HttpRequest::setStaticPolicyOption(HttpRequest::PO_HTTP2_STREAM_LIMIT, http2_class, streams, NULL));
+
+		HttpRequest::startThread();
+
+		req = new HttpRequest();
+
+		opts = HttpOptions::ptr_t(new HttpOptions());
+		opts->setSSLVerifyPeer(false);			// Local test servers are self-signed
+		opts->setSSLVerifyHost(false);
+
+		std::cout << std::endl << "HttpRequest, " << request_count << " GETs of " << url << std::endl;
+		std::cout << std::setw(10) << "protocol" << std::setw(10) << "failed" << std::setw(12) << "wall ms"
+				  << std::setw(12) << "req/s" << std::setw(14) << "avg lat ms" << std::setw(14) << "max lat ms"
+				  << std::endl;
+
+		const char * names[] = { "HTTP/1.1", "HTTP/2" };
+		for (int i(0); i < 2; ++i)
+		{
+			TimingHandler handler;
+			LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+
+			LLTimer timer;
+			for (int n(0); n < request_count; ++n)
+			{
+				HttpHandle handle = req->requestGet(classes[i],
+													0U,
+													url,
+													opts,
+													HttpHeaders::ptr_t(),
+													handlerp);
+				ensure("Valid handle returned for get request", handle != LLCORE_HTTP_HANDLE_INVALID);
+			}
+
+			int count(0);
+			int limit(LOOP_COUNT_LONG);
+			while (count++ < limit && handler.mCalls < request_count)
+			{
+				req->update(1000);
+				usleep(LOOP_SLEEP_INTERVAL);
+			}
+			const F64 wall(timer.getElapsedTimeF64());
+			ensure("Requests executed in reasonable time", count < limit);
+			ensure_equals("One handler invocation per request", handler.mCalls, request_count);
+
+			const int succeeded(request_count - handler.mFailures);
+			std::cout << std::setw(10) << names[i] << std::setw(10) << handler.mFailures
+					  << std::fixed << std::setprecision(1)
+					  << std::setw(12) << wall * 1000.0
+					  << std::setw(12) << request_count / wall
+					  << std::setw(14) << (succeeded ? handler.mTotalTime * 1000.0 / succeeded : 0.0)
+					  << std::setw(14) << handler.mMaxTime * 1000.0
+					  << std::endl;
+			ensure_equals("All requests succeeded", handler.mFailures, 0);
+		}
+
+		// Shut down the servicing thread
+		TestHandler2 handler(this, "handler");
+		LLCore::HttpHandler::ptr_t handlerp(&handler, NoOpDeletor);
+		mStatus = HttpStatus();
+		mHandlerCalls = 0;
+		HttpHandle handle = req->requestStopThread(handlerp);
+		ensure("Valid handle returned for stop request", handle != LLCORE_HTTP_HANDLE_INVALID);
+	
+		int count(0);
+		int limit(LOOP_COUNT_LONG);
+		while (count++ < limit && mHandlerCalls < 1)
+		{
+			req->update(1000000);
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Stop request executed in reasonable time", count < limit);
+
+		count = 0;
+		limit = LOOP_COUNT_SHORT;
+		while (count++ < limit && ! HttpService::isStopped())
+		{
+			usleep(LOOP_SLEEP_INTERVAL);
+		}
+		ensure("Thread actually stopped running", HttpService::isStopped());
+
+		opts.reset();
+		
+		delete req;
+		req = NULL;
+
+		HttpRequest::destroyService();
+	}
+	catch (...)
+	{
+		stop_thread(req);
+		opts.reset();
+		delete req;
+		HttpRequest::destroyService();
+		throw;
+	}
+}
+// </FS>
 
 }  // end namespace tut
 
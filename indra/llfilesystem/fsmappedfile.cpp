@@ -0,0 +1,225 @@
+/**
+ * @file fsmappedfile.cpp
+ * @brief Read/write memory mapping of a fixed size file.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsmappedfile.h"
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#include "llstring.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FSMappedFile::FSMappedFile()
+:   mData(nullptr),
+    mSize(0),
+    mReadOnly(true),
+#if LL_WINDOWS
+    mFileHandle(INVALID_HANDLE_VALUE),
+    mMappingHandle(nullptr)
+#else
+    mFileDescriptor(-1)
+#endif
+{
+}
+
+FSMappedFile::~FSMappedFile()
+{
+    close();
+}
+
+#if LL_WINDOWS
+
+bool FSMappedFile::open(const std::string& filename, size_t min_size, bool read_only)
+{
+    close();
+
+    llutf16string utf16filename = utf8str_to_utf16str(filename);
+    DWORD access = read_only ? GENERIC_READ : (GENERIC_READ | GENERIC_WRITE);
+    DWORD disposition = read_only ? OPEN_EXISTING : OPEN_ALWAYS;
+    HANDLE file = CreateFileW(utf16filename.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                              disposition, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    size_t size = (size_t)file_size.QuadPart;
+    if (!read_only && size < min_size)
+    {
+        size = min_size;
+    }
+    if (!size)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    // Creating a read/write mapping larger than the file grows the file
+    DWORD protect = read_only ? PAGE_READONLY : PAGE_READWRITE;
+    HANDLE mapping = CreateFileMappingW(file, NULL, protect, (DWORD)((U64)size >> 32), (DWORD)(size & 0xffffffff), NULL);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, read_only ? FILE_MAP_READ : FILE_MAP_WRITE, 0, 0, size);
+    if (!data)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mFileHandle = file;
+    mMappingHandle = mapping;
+    mData = (U8*)data;
+    mSize = size;
+    mReadOnly = read_only;
+    return true;
+}
+
+void FSMappedFile::close()
+{
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+        mData = nullptr;
+    }
+    if (mMappingHandle)
+    {
+        CloseHandle((HANDLE)mMappingHandle);
+        mMappingHandle = nullptr;
+    }
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle((HANDLE)mFileHandle);
+        mFileHandle = INVALID_HANDLE_VALUE;
+    }
+    mSize = 0;
+}
+
+void FSMappedFile::flush(bool sync)
+{
+    if (mData && !mReadOnly)
+    {
+        // FlushViewOfFile only starts the write back of the dirty pages
+        FlushViewOfFile(mData, 0);
+        if (sync)
+        {
+            FlushFileBuffers((HANDLE)mFileHandle);
+        }
+    }
+}
+
+#else // LL_WINDOWS
+
+bool FSMappedFile::open(const std::string& filename, size_t min_size, bool read_only)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), read_only ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)file_stat.st_size;
+    if (!read_only && size < min_size)
+    {
+        if (ftruncate(fd, (off_t)min_size) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        size = min_size;
+    }
+    if (!size)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    int prot = read_only ? PROT_READ : (PROT_READ | PROT_WRITE);
+    void* data = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    mFileDescriptor = fd;
+    mData = (U8*)data;
+    mSize = size;
+    mReadOnly = read_only;
+    return true;
+}
+
+void FSMappedFile::close()
+{
+    if (mData)
+    {
+        munmap(mData, mSize);
+        mData = nullptr;
+    }
+    if (mFileDescriptor >= 0)
+    {
+        ::close(mFileDescriptor);
+        mFileDescriptor = -1;
+    }
+    mSize = 0;
+}
+
+void FSMappedFile::flush(bool sync)
+{
+    if (mData && !mReadOnly)
+    {
+        msync(mData, mSize, sync ? MS_SYNC : MS_ASYNC);
+    }
+}
+
+#endif // LL_WINDOWS
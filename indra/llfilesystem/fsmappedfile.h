@@ -0,0 +1,74 @@
+/**
+ * @file fsmappedfile.h
+ * @brief Read/write memory mapping of a fixed size file.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_MAPPEDFILE_H
+#define FS_MAPPEDFILE_H
+
+#include "stdtypes.h"
+#include <string>
+
+class FSMappedFile
+{
+public:
+    FSMappedFile();
+    ~FSMappedFile();
+
+    /**
+     * Maps filename into memory. In read/write mode the file is created if
+     * needed and grown to at least min_size bytes; in read only mode the
+     * existing file is mapped as is. Returns false on failure.
+     */
+    bool open(const std::string& filename, size_t min_size, bool read_only);
+    void close();
+
+    /**
+     * Schedules the dirty pages to be written back. Does not wait for the
+     * I/O to complete unless sync is set.
+     */
+    void flush(bool sync = false);
+
+    bool isOpen() const { return mData != nullptr; }
+    bool isReadOnly() const { return mReadOnly; }
+    U8* getData() const { return mData; }
+    size_t getSize() const { return mSize; }
+
+private:
+    FSMappedFile(const FSMappedFile&);
+    FSMappedFile& operator=(const FSMappedFile&);
+
+    U8*     mData;
+    size_t  mSize;
+    bool    mReadOnly;
+#if LL_WINDOWS
+    void*   mFileHandle;
+    void*   mMappingHandle;
+#else
+    int     mFileDescriptor;
+#endif
+};
+
+#endif // FS_MAPPEDFILE_H
@@ -0,0 +1,1157 @@
+/**
+ * @file fspackeddiskcache.cpp
+ * @brief Pack file backend for the asset disk cache.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fspackeddiskcache.h"
+#include "lldir.h"
+#include "lltimer.h"
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <chrono>
+
+static const U32 JOURNAL_MAGIC = 0x4b505346; // "FSPK"
+static const U32 JOURNAL_VERSION = 1;
+
+// Extents are allocated in multiples of this to leave a little room for appends
+static const U32 EXTENT_GRANULARITY = 256;
+
+// Segment size is derived from the cache size so small caches still get
+// a reasonable number of segments to compact. Kept well below 2GB so plain
+// fseek() offsets work on every platform.
+static const U32 MIN_SEGMENT_BYTES = 64 * 1024 * 1024;
+static const U32 MAX_SEGMENT_BYTES = 1024 * 1024 * 1024;
+static const U32 SEGMENTS_PER_CACHE = 16;
+
+// Only journal an access if the asset wasn't touched for this long
+static const U32 TOUCH_THRESHOLD_SECONDS = 60;
+
+// Pending records are flushed to the journal once this many have queued up
+static const size_t MAX_PENDING_RECORDS = 256;
+
+// Segments with less live data than this can be compacted
+static const F64 COMPACT_LIVE_RATIO = 0.75;
+
+// Compaction starts once the dead space in all inactive segments exceeds
+// this share of the cache size and goes on until it drops below the stop
+// ratio, so normal churn doesn't keep it running all the time.
+static const F64 COMPACT_START_DEAD_RATIO = 0.25;
+static const F64 COMPACT_STOP_DEAD_RATIO = 0.10;
+
+static U32 round_up_extent(U32 bytes)
+{
+    return llmax(EXTENT_GRANULARITY, (bytes + EXTENT_GRANULARITY - 1) / EXTENT_GRANULARITY * EXTENT_GRANULARITY);
+}
+
+static U32 now_seconds()
+{
+    return (U32)std::time(nullptr);
+}
+
+// Segment I/O goes straight to the file descriptor with positioned reads and
+// writes, so readers don't share a file position (or a stdio buffer) with
+// each other or with the writer and can run without holding the cache mutex.
+static bool read_at(LLFILE* file, U32 offset, U8* buffer, U32 bytes)
+{
+#if LL_WINDOWS
+    HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+    while (bytes > 0)
+    {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = offset;
+        DWORD bytes_read = 0;
+        if (!ReadFile(handle, buffer, bytes, &bytes_read, &overlapped) || bytes_read == 0)
+        {
+            return false;
+        }
+        offset += bytes_read;
+        buffer += bytes_read;
+        bytes -= bytes_read;
+    }
+#else
+    const int fd = fileno(file);
+    while (bytes > 0)
+    {
+        ssize_t bytes_read = pread(fd, buffer, bytes, (off_t)offset);
+        if (bytes_read < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes_read <= 0)
+        {
+            return false;
+        }
+        offset += (U32)bytes_read;
+        buffer += bytes_read;
+        bytes -= (U32)bytes_read;
+    }
+#endif
+    return true;
+}
+
+static bool write_at(LLFILE* file, U32 offset, const U8* buffer, U32 bytes)
+{
+#if LL_WINDOWS
+    HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+    while (bytes > 0)
+    {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = offset;
+        DWORD bytes_written = 0;
+        if (!WriteFile(handle, buffer, bytes, &bytes_written, &overlapped) || bytes_written == 0)
+        {
+            return false;
+        }
+        offset += bytes_written;
+        buffer += bytes_written;
+        bytes -= bytes_written;
+    }
+#else
+    const int fd = fileno(file);
+    while (bytes > 0)
+    {
+        ssize_t bytes_written = pwrite(fd, buffer, bytes, (off_t)offset);
+        if (bytes_written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes_written <= 0)
+        {
+            return false;
+        }
+        offset += (U32)bytes_written;
+        buffer += bytes_written;
+        bytes -= (U32)bytes_written;
+    }
+#endif
+    return true;
+}
+
+// Makes sure everything written so far is on disk
+static bool sync_file(LLFILE* file)
+{
+#if LL_WINDOWS
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+FSPackedDiskCache::FSPackedDiskCache(const std::string& pack_dir, uintmax_t max_size_bytes, bool enable_cache_debug_info) :
+    mPackDir(pack_dir),
+    mEnableCacheDebugInfo(enable_cache_debug_info),
+    mActiveSegment(0),
+    mNextSegment(1),
+    mLiveBytes(0),
+    mMaxBytes(max_size_bytes),
+    mCompacting(false),
+    mJournal(pack_dir + gDirUtilp->getDirDelimiter() + "sl_cache_pack.journal", JOURNAL_MAGIC, JOURNAL_VERSION, sizeof(JournalRecord))
+{
+    LLFile::mkdir(mPackDir);
+}
+
+FSPackedDiskCache::~FSPackedDiskCache()
+{
+    LLMutexLock lock(&mMutex);
+
+    flushJournal();
+
+    for (segment_map_t::value_type& segment : mSegments)
+    {
+        if (segment.second.mFile)
+        {
+            LLFile::close(segment.second.mFile);
+            segment.second.mFile = nullptr;
+        }
+    }
+
+    // Nobody can be reading anymore at this point
+    for (segment_map_t::value_type& segment : mRetiredSegments)
+    {
+        if (segment.second.mFile)
+        {
+            LLFile::close(segment.second.mFile);
+        }
+        LLFile::remove(getSegmentFilename(segment.first), ENOENT);
+    }
+}
+
+bool FSPackedDiskCache::open()
+{
+    LLMutexLock lock(&mMutex);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    bool had_journal = readJournal();
+
+    // Pick up segment files the journal doesn't know about (e.g. after a crash
+    // before the journal was flushed) so they get cleaned up below.
+    std::vector<std::string> files = gDirUtilp->getFilesInDir(mPackDir);
+    for (const std::string& file : files)
+    {
+        unsigned int segment = 0;
+        if (sscanf(file.c_str(), "sl_cache_pack_%08x.seg", &segment) == 1 && segment > 0)
+        {
+            mSegments[segment];
+            mNextSegment = llmax(mNextSegment, (U32)segment + 1);
+        }
+    }
+
+    // Validate all extents against the actual segment sizes
+    for (segment_map_t::value_type& segment : mSegments)
+    {
+        llstat file_stat;
+        if (LLFile::stat(getSegmentFilename(segment.first), &file_stat) == 0)
+        {
+            segment.second.mTail = (U32)file_stat.st_size;
+        }
+    }
+
+    std::vector<std::pair<U32, LLUUID>> by_time;
+    by_time.reserve(mEntries.size());
+    for (entry_map_t::iterator iter = mEntries.begin(); iter != mEntries.end(); )
+    {
+        Entry& entry = iter->second;
+        segment_map_t::iterator seg_iter = mSegments.find(entry.mSegment);
+        if (seg_iter == mSegments.end() || (U64)entry.mOffset + entry.mSize > seg_iter->second.mTail)
+        {
+            LL_WARNS("LLDiskCache") << "Dropping invalid pack cache entry " << iter->first << LL_ENDL;
+            iter = mEntries.erase(iter);
+            continue;
+        }
+
+        seg_iter->second.mLiveBytes += entry.mCapacity;
+        mLiveBytes += entry.mCapacity;
+        by_time.emplace_back(entry.mAccessTime, iter->first);
+        ++iter;
+    }
+
+    // The capacity of the last extent of a segment may not have been written
+    // to the file yet, so the segment tail must cover it.
+    for (const entry_map_t::value_type& entry : mEntries)
+    {
+        Segment& segment = mSegments[entry.second.mSegment];
+        segment.mTail = llmax(segment.mTail, entry.second.mOffset + entry.second.mCapacity);
+    }
+
+    std::sort(by_time.begin(), by_time.end(), [](const std::pair<U32, LLUUID>& a, const std::pair<U32, LLUUID>& b)
+    {
+        return a.first > b.first;
+    });
+    for (const std::pair<U32, LLUUID>& item : by_time)
+    {
+        mEntries[item.second].mLRUIter = mLRU.insert(mLRU.end(), item.second);
+    }
+
+    // Drop segments that don't hold any live data anymore and continue
+    // writing at the end of the newest one.
+    std::vector<U32> empty_segments;
+    for (const segment_map_t::value_type& segment : mSegments)
+    {
+        if (segment.second.mLiveBytes == 0)
+        {
+            empty_segments.push_back(segment.first);
+        }
+    }
+    for (U32 segment : empty_segments)
+    {
+        deleteSegment(segment);
+    }
+
+    if (!mSegments.empty() && mSegments.rbegin()->second.mTail < getSegmentMaxBytes())
+    {
+        mActiveSegment = mSegments.rbegin()->first;
+    }
+
+    // Rewrite the journal if it's missing or mostly outdated records
+    if (!had_journal || mJournal.needsSnapshot(mEntries.size()))
+    {
+        writeJournalSnapshot();
+    }
+
+    if (mEnableCacheDebugInfo)
+    {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        LL_INFOS("LLDiskCache") << "Opened pack cache with " << mEntries.size() << " entries in " << mSegments.size()
+                                << " segments (" << mLiveBytes << " bytes) in " << execute_time << " ms" << LL_ENDL;
+    }
+
+    return had_journal;
+}
+
+bool FSPackedDiskCache::readJournal()
+{
+    FSRecordJournal::EReadResult result = mJournal.read([this](const void* data)
+    {
+        const JournalRecord& record = *(const JournalRecord*)data;
+
+        LLUUID id;
+        memcpy(id.mData, record.mID, UUID_BYTES);
+
+        switch (record.mOp)
+        {
+            case JOURNAL_PUT:
+            {
+                Entry& entry = mEntries[id];
+                entry.mSegment = record.mSegment;
+                entry.mOffset = record.mOffset;
+                entry.mSize = record.mSize;
+                entry.mCapacity = record.mCapacity;
+                entry.mAccessTime = record.mAccessTime;
+                mNextSegment = llmax(mNextSegment, record.mSegment + 1);
+                mSegments[record.mSegment];
+                return true;
+            }
+            case JOURNAL_DELETE:
+                mEntries.erase(id);
+                return true;
+            case JOURNAL_TOUCH:
+            {
+                entry_map_t::iterator iter = mEntries.find(id);
+                if (iter != mEntries.end())
+                {
+                    iter->second.mAccessTime = record.mAccessTime;
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    });
+
+    // Everything up to a corrupt record is still good
+    return result == FSRecordJournal::READ_OK || result == FSRecordJournal::READ_CORRUPT;
+}
+
+bool FSPackedDiskCache::writeJournalSnapshot()
+{
+    if (!syncSegments() || !mJournal.beginSnapshot())
+    {
+        return false;
+    }
+
+    // Write in LRU order, oldest first, so replay order matches access order
+    for (lru_list_t::reverse_iterator iter = mLRU.rbegin(); iter != mLRU.rend(); ++iter)
+    {
+        const Entry& entry = mEntries[*iter];
+
+        JournalRecord record;
+        record.mOp = JOURNAL_PUT;
+        record.mSegment = entry.mSegment;
+        record.mOffset = entry.mOffset;
+        record.mSize = entry.mSize;
+        record.mCapacity = entry.mCapacity;
+        record.mAccessTime = entry.mAccessTime;
+        memcpy(record.mID, iter->mData, UUID_BYTES);
+        mJournal.addSnapshotRecord(&record);
+    }
+
+    return mJournal.endSnapshot();
+}
+
+void FSPackedDiskCache::queueRecord(EJournalOp op, const LLUUID& id, const Entry* entry)
+{
+    JournalRecord record;
+    memset(&record, 0, sizeof(JournalRecord));
+    record.mOp = op;
+    memcpy(record.mID, id.mData, UUID_BYTES);
+    if (entry)
+    {
+        record.mSegment = entry->mSegment;
+        record.mOffset = entry->mOffset;
+        record.mSize = entry->mSize;
+        record.mCapacity = entry->mCapacity;
+        record.mAccessTime = entry->mAccessTime;
+    }
+    mJournal.queue(&record);
+
+    if (mJournal.getPendingCount() >= MAX_PENDING_RECORDS)
+    {
+        flushJournal();
+    }
+}
+
+bool FSPackedDiskCache::syncSegments()
+{
+    // Journal records point at data in the segments. That data has to be on
+    // the disk before the records are, otherwise a crash could leave records
+    // for extents that were never written and open() would hand out garbage
+    // as valid assets.
+    for (segment_map_t::value_type& segment : mSegments)
+    {
+        if (segment.second.mDirty && segment.second.mFile)
+        {
+            if (!sync_file(segment.second.mFile))
+            {
+                LL_WARNS("LLDiskCache") << "Failed to sync pack cache segment " << getSegmentFilename(segment.first) << LL_ENDL;
+                return false;
+            }
+            segment.second.mDirty = false;
+        }
+    }
+    return true;
+}
+
+void FSPackedDiskCache::flushJournal()
+{
+    LLMutexLock lock(&mMutex);
+
+    if (mJournal.getPendingCount() && syncSegments())
+    {
+        mJournal.flush();
+    }
+}
+
+std::string FSPackedDiskCache::getSegmentFilename(U32 segment) const
+{
+    return llformat("%s%ssl_cache_pack_%08x.seg", mPackDir.c_str(), gDirUtilp->getDirDelimiter().c_str(), segment);
+}
+
+U32 FSPackedDiskCache::getSegmentMaxBytes() const
+{
+    return (U32)llclamp(mMaxBytes / SEGMENTS_PER_CACHE, (uintmax_t)MIN_SEGMENT_BYTES, (uintmax_t)MAX_SEGMENT_BYTES);
+}
+
+LLFILE* FSPackedDiskCache::getSegmentFile(U32 segment)
+{
+    Segment& seg = mSegments[segment];
+    if (!seg.mFile)
+    {
+        const std::string filename = getSegmentFilename(segment);
+        seg.mFile = LLFile::fopen(filename, "r+b");
+        if (!seg.mFile)
+        {
+            seg.mFile = LLFile::fopen(filename, "w+b");
+        }
+        if (!seg.mFile)
+        {
+            LL_WARNS("LLDiskCache") << "Unable to open pack cache segment " << filename << LL_ENDL;
+        }
+    }
+    return seg.mFile;
+}
+
+bool FSPackedDiskCache::allocateExtent(U32 capacity, U32& segment, U32& offset)
+{
+    segment_map_t::iterator iter = mSegments.find(mActiveSegment);
+    if (mActiveSegment == 0 || iter == mSegments.end() || (U64)iter->second.mTail + capacity > getSegmentMaxBytes())
+    {
+        // Start a new segment. An extent bigger than a whole segment
+        // simply gets an oversized segment of its own.
+        mActiveSegment = mNextSegment++;
+        iter = mSegments.insert(std::make_pair(mActiveSegment, Segment())).first;
+        if (!getSegmentFile(mActiveSegment))
+        {
+            mSegments.erase(iter);
+            mActiveSegment = 0;
+            return false;
+        }
+    }
+
+    segment = mActiveSegment;
+    offset = iter->second.mTail;
+    iter->second.mTail += capacity;
+    iter->second.mLiveBytes += capacity;
+    mLiveBytes += capacity;
+    return true;
+}
+
+bool FSPackedDiskCache::readExtent(U32 segment, U32 offset, U8* buffer, U32 bytes)
+{
+    LLFILE* file = getSegmentFile(segment);
+    return file && read_at(file, offset, buffer, bytes);
+}
+
+bool FSPackedDiskCache::writeExtent(U32 segment, U32 offset, const U8* buffer, U32 bytes)
+{
+    LLFILE* file = getSegmentFile(segment);
+    if (!file)
+    {
+        return false;
+    }
+    mSegments[segment].mDirty = true;
+    return write_at(file, offset, buffer, bytes);
+}
+
+bool FSPackedDiskCache::relocateEntry(const LLUUID& id, Entry& entry, U32 new_capacity)
+{
+    std::vector<U8> data(entry.mSize);
+    if (entry.mSize && !readExtent(entry.mSegment, entry.mOffset, &data[0], entry.mSize))
+    {
+        return false;
+    }
+
+    U32 segment = 0;
+    U32 offset = 0;
+    if (!allocateExtent(new_capacity, segment, offset))
+    {
+        return false;
+    }
+
+    if (entry.mSize && !writeExtent(segment, offset, &data[0], entry.mSize))
+    {
+        // Leave the entry where it was, the new extent is dead space now
+        mSegments[segment].mLiveBytes -= new_capacity;
+        mLiveBytes -= new_capacity;
+        return false;
+    }
+
+    releaseEntry(entry);
+    entry.mSegment = segment;
+    entry.mOffset = offset;
+    entry.mCapacity = new_capacity;
+    queueRecord(JOURNAL_PUT, id, &entry);
+    return true;
+}
+
+bool FSPackedDiskCache::rewriteEntry(const LLUUID& id, Entry& entry, U32 start, const U8* buffer, U32 bytes, bool truncate)
+{
+    const U32 end = start + bytes;
+    const U32 new_size = truncate ? end : llmax(entry.mSize, end);
+
+    // Old content around the written range
+    std::vector<U8> data;
+    if (!truncate)
+    {
+        data.resize(new_size);
+        if (!readExtent(entry.mSegment, entry.mOffset, &data[0], entry.mSize))
+        {
+            return false;
+        }
+        memcpy(&data[start], buffer, bytes);
+        buffer = &data[0];
+    }
+
+    const U32 new_capacity = round_up_extent(new_size);
+    U32 segment = 0;
+    U32 offset = 0;
+    if (!allocateExtent(new_capacity, segment, offset))
+    {
+        return false;
+    }
+
+    if (new_size && !writeExtent(segment, offset, buffer, new_size))
+    {
+        mSegments[segment].mLiveBytes -= new_capacity;
+        mLiveBytes -= new_capacity;
+        return false;
+    }
+
+    // The old extent becomes dead space. Its bytes stay as they are until
+    // the whole segment is deleted, which flushes the journal first, so
+    // until the record below is on disk the old record is still good. The
+    // record itself is only written after syncSegments(), see flushJournal().
+    releaseEntry(entry);
+    entry.mSegment = segment;
+    entry.mOffset = offset;
+    entry.mCapacity = new_capacity;
+    entry.mSize = new_size;
+    entry.mAccessTime = now_seconds();
+    mLRU.splice(mLRU.begin(), mLRU, entry.mLRUIter);
+    queueRecord(JOURNAL_PUT, id, &entry);
+    return true;
+}
+
+void FSPackedDiskCache::touchEntry(const LLUUID& id, Entry& entry)
+{
+    mLRU.splice(mLRU.begin(), mLRU, entry.mLRUIter);
+
+    const U32 now = now_seconds();
+    if (now - entry.mAccessTime > TOUCH_THRESHOLD_SECONDS)
+    {
+        entry.mAccessTime = now;
+        queueRecord(JOURNAL_TOUCH, id, &entry);
+    }
+}
+
+void FSPackedDiskCache::releaseEntry(Entry& entry)
+{
+    segment_map_t::iterator iter = mSegments.find(entry.mSegment);
+    if (iter != mSegments.end())
+    {
+        iter->second.mLiveBytes -= entry.mCapacity;
+    }
+    mLiveBytes -= entry.mCapacity;
+}
+
+void FSPackedDiskCache::removeEntry(entry_map_t::iterator iter)
+{
+    releaseEntry(iter->second);
+    queueRecord(JOURNAL_DELETE, iter->first, nullptr);
+    mLRU.erase(iter->second.mLRUIter);
+    mEntries.erase(iter);
+}
+
+void FSPackedDiskCache::deleteSegment(U32 segment)
+{
+    segment_map_t::iterator iter = mSegments.find(segment);
+    if (iter == mSegments.end())
+    {
+        return;
+    }
+
+    // Make sure no journal record can refer to this segment anymore before
+    // the file goes away.
+    flushJournal();
+
+    if (iter->second.mReaders > 0)
+    {
+        // A read is still in flight outside the mutex, the last reader
+        // closes and removes the file in releaseSegmentReader().
+        mRetiredSegments.insert(*iter);
+    }
+    else
+    {
+        if (iter->second.mFile)
+        {
+            LLFile::close(iter->second.mFile);
+        }
+        LLFile::remove(getSegmentFilename(segment), ENOENT);
+    }
+    mSegments.erase(iter);
+
+    if (mActiveSegment == segment)
+    {
+        mActiveSegment = 0;
+    }
+}
+
+S32 FSPackedDiskCache::getSize(const LLUUID& id)
+{
+    LLMutexLock lock(&mMutex);
+
+    entry_map_t::iterator iter = mEntries.find(id);
+    return iter != mEntries.end() ? (S32)iter->second.mSize : 0;
+}
+
+void FSPackedDiskCache::releaseSegmentReader(U32 segment)
+{
+    segment_map_t::iterator iter = mSegments.find(segment);
+    if (iter != mSegments.end())
+    {
+        --iter->second.mReaders;
+        return;
+    }
+
+    iter = mRetiredSegments.find(segment);
+    if (iter != mRetiredSegments.end() && --iter->second.mReaders == 0)
+    {
+        if (iter->second.mFile)
+        {
+            LLFile::close(iter->second.mFile);
+        }
+        LLFile::remove(getSegmentFilename(segment), ENOENT);
+        mRetiredSegments.erase(iter);
+    }
+}
+
+S32 FSPackedDiskCache::read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes)
+{
+    U32 segment = 0;
+    U32 extent_offset = 0;
+    U32 to_read = 0;
+    LLFILE* file = nullptr;
+    {
+        LLMutexLock lock(&mMutex);
+
+        entry_map_t::iterator iter = mEntries.find(id);
+        if (iter == mEntries.end() || offset < 0 || bytes <= 0 || (U32)offset >= iter->second.mSize)
+        {
+            return 0;
+        }
+
+        Entry& entry = iter->second;
+        segment = entry.mSegment;
+        extent_offset = entry.mOffset;
+        to_read = llmin((U32)bytes, entry.mSize - (U32)offset);
+        file = getSegmentFile(segment);
+        if (!file)
+        {
+            removeEntry(iter);
+            return 0;
+        }
+
+        // Keeps the segment file open until the read below is done
+        ++mSegments[segment].mReaders;
+        touchEntry(id, entry);
+    }
+
+    // Bytes below the size of an entry are never written again: rewrites go
+    // to a fresh extent (see rewriteEntry()), appends only write past the
+    // size read above, and dead extents are only reclaimed by deleting their
+    // segment, which waits for readers. So the data can be read without
+    // holding the mutex.
+    const bool success = read_at(file, extent_offset + (U32)offset, buffer, to_read);
+
+    LLMutexLock lock(&mMutex);
+    releaseSegmentReader(segment);
+    if (!success)
+    {
+        LL_WARNS("LLDiskCache") << "Failed to read " << id << " from pack cache segment " << segment << LL_ENDL;
+        entry_map_t::iterator iter = mEntries.find(id);
+        if (iter != mEntries.end() && iter->second.mSegment == segment && iter->second.mOffset == extent_offset)
+        {
+            removeEntry(iter);
+        }
+        return 0;
+    }
+    return (S32)to_read;
+}
+
+bool FSPackedDiskCache::write(const LLUUID& id, S32 offset, const U8* buffer, S32 bytes, bool truncate, S32& new_position)
+{
+    LLMutexLock lock(&mMutex);
+
+    if (bytes < 0)
+    {
+        return false;
+    }
+
+    entry_map_t::iterator iter = mEntries.find(id);
+    if (iter == mEntries.end())
+    {
+        Entry entry;
+        entry.mSegment = 0;
+        entry.mOffset = 0;
+        entry.mSize = 0;
+        entry.mCapacity = 0;
+        entry.mAccessTime = now_seconds();
+        if (!allocateExtent(round_up_extent(bytes), entry.mSegment, entry.mOffset))
+        {
+            return false;
+        }
+        entry.mCapacity = round_up_extent(bytes);
+        entry.mLRUIter = mLRU.insert(mLRU.begin(), id);
+        iter = mEntries.insert(std::make_pair(id, entry)).first;
+        truncate = true;
+    }
+
+    Entry& entry = iter->second;
+    U32 start = 0;
+    if (!truncate)
+    {
+        start = (offset < 0) ? entry.mSize : (U32)offset;
+        if (start > entry.mSize)
+        {
+            LL_WARNS("LLDiskCache") << "Attempt to write " << id << " past the end of the cached asset" << LL_ENDL;
+            return false;
+        }
+    }
+
+    const U32 end = start + (U32)bytes;
+
+    // Anything that replaces existing bytes goes to a fresh extent. Readers
+    // outside the mutex and the journal record on disk still point at the
+    // old one.
+    if (entry.mSize > 0 && (truncate || start < entry.mSize))
+    {
+        if (!rewriteEntry(id, entry, start, buffer, (U32)bytes, truncate))
+        {
+            LL_WARNS("LLDiskCache") << "Failed to rewrite " << id << " in pack cache" << LL_ENDL;
+            return false;
+        }
+        new_position = (S32)end;
+        return true;
+    }
+
+    if (end > entry.mCapacity)
+    {
+        Segment& segment = mSegments[entry.mSegment];
+        const U32 grown_capacity = round_up_extent(end + end / 4);
+        if (entry.mSegment == mActiveSegment && entry.mOffset + entry.mCapacity == segment.mTail &&
+            (U64)entry.mOffset + grown_capacity <= getSegmentMaxBytes())
+        {
+            // Last extent in the active segment, just grow it
+            const U32 delta = grown_capacity - entry.mCapacity;
+            segment.mTail += delta;
+            segment.mLiveBytes += delta;
+            mLiveBytes += delta;
+            entry.mCapacity = grown_capacity;
+        }
+        else
+        {
+            if (truncate)
+            {
+                entry.mSize = 0;
+            }
+            if (!relocateEntry(id, entry, grown_capacity))
+            {
+                LL_WARNS("LLDiskCache") << "Failed to relocate " << id << " in pack cache" << LL_ENDL;
+                removeEntry(iter);
+                return false;
+            }
+        }
+    }
+
+    if (bytes > 0 && !writeExtent(entry.mSegment, entry.mOffset + start, buffer, (U32)bytes))
+    {
+        LL_WARNS("LLDiskCache") << "Failed to write " << id << " to pack cache segment " << entry.mSegment << LL_ENDL;
+        removeEntry(iter);
+        return false;
+    }
+
+    entry.mSize = truncate ? end : llmax(entry.mSize, end);
+    entry.mAccessTime = now_seconds();
+    mLRU.splice(mLRU.begin(), mLRU, entry.mLRUIter);
+    queueRecord(JOURNAL_PUT, id, &entry);
+
+    new_position = (S32)end;
+    return true;
+}
+
+bool FSPackedDiskCache::remove(const LLUUID& id)
+{
+    LLMutexLock lock(&mMutex);
+
+    entry_map_t::iterator iter = mEntries.find(id);
+    if (iter == mEntries.end())
+    {
+        return false;
+    }
+
+    removeEntry(iter);
+    return true;
+}
+
+bool FSPackedDiskCache::rename(const LLUUID& old_id, const LLUUID& new_id)
+{
+    LLMutexLock lock(&mMutex);
+
+    entry_map_t::iterator iter = mEntries.find(old_id);
+    if (iter == mEntries.end())
+    {
+        return false;
+    }
+
+    if (old_id == new_id)
+    {
+        return true;
+    }
+
+    entry_map_t::iterator new_iter = mEntries.find(new_id);
+    if (new_iter != mEntries.end())
+    {
+        removeEntry(new_iter);
+        iter = mEntries.find(old_id);
+        if (iter == mEntries.end())
+        {
+            return false;
+        }
+    }
+
+    Entry entry = iter->second;
+    mLRU.erase(entry.mLRUIter);
+    mEntries.erase(iter);
+    queueRecord(JOURNAL_DELETE, old_id, nullptr);
+
+    entry.mLRUIter = mLRU.insert(mLRU.begin(), new_id);
+    mEntries[new_id] = entry;
+    queueRecord(JOURNAL_PUT, new_id, &entry);
+    return true;
+}
+
+void FSPackedDiskCache::purge(uintmax_t max_bytes, const std::set<LLUUID>& skip_list)
+{
+    LLMutexLock lock(&mMutex);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    mMaxBytes = max_bytes;
+
+    const size_t entry_count = mEntries.size();
+    while (purgeSlice(max_bytes, skip_list, 0.0, 0))
+    {
+    }
+
+    if (mEnableCacheDebugInfo)
+    {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        LL_INFOS("LLDiskCache") << "Pack cache purge took " << execute_time << " ms for " << entry_count << " entries" << LL_ENDL;
+        LL_INFOS("LLDiskCache") << "Deleted: " << (entry_count - mEntries.size()) << " Kept: " << mEntries.size()
+                                << " Live bytes: " << mLiveBytes << " Disk bytes: " << getDiskBytes() << LL_ENDL;
+    }
+}
+
+bool FSPackedDiskCache::needsPurge(uintmax_t max_bytes)
+{
+    LLMutexLock lock(&mMutex);
+
+    if (mLiveBytes > max_bytes || !mCompactQueue.empty())
+    {
+        return true;
+    }
+
+    uintmax_t dead_bytes = 0;
+    bool has_empty_segment = false;
+    const U32 worst_segment = findCompactionCandidate(dead_bytes, has_empty_segment);
+    return has_empty_segment || (worst_segment && dead_bytes > (uintmax_t)(mMaxBytes * COMPACT_START_DEAD_RATIO));
+}
+
+U32 FSPackedDiskCache::findCompactionCandidate(uintmax_t& dead_bytes, bool& has_empty_segment) const
+{
+    U32 worst_segment = 0;
+    F64 worst_ratio = COMPACT_LIVE_RATIO;
+    dead_bytes = 0;
+    has_empty_segment = false;
+
+    for (const segment_map_t::value_type& segment : mSegments)
+    {
+        if (segment.first == mActiveSegment || segment.second.mTail == 0)
+        {
+            continue;
+        }
+
+        if (segment.second.mLiveBytes == 0)
+        {
+            has_empty_segment = true;
+            continue;
+        }
+
+        dead_bytes += segment.second.mTail - llmin((uintmax_t)segment.second.mTail, segment.second.mLiveBytes);
+        const F64 ratio = (F64)segment.second.mLiveBytes / (F64)segment.second.mTail;
+        if (ratio < worst_ratio)
+        {
+            worst_ratio = ratio;
+            worst_segment = segment.first;
+        }
+    }
+    return worst_segment;
+}
+
+bool FSPackedDiskCache::purgeSlice(uintmax_t target_bytes, const std::set<LLUUID>& skip_list, F64 max_seconds, U32 max_io_ops)
+{
+    LLMutexLock lock(&mMutex);
+
+    LLTimer timer;
+    U32 io_ops = 0;
+    auto out_of_time = [&]() { return max_seconds > 0.0 && timer.getElapsedTimeF64() > max_seconds; };
+    auto out_of_budget = [&]() { return (max_io_ops > 0 && io_ops >= max_io_ops) || out_of_time(); };
+
+    // Evicting only drops index entries, the space is reclaimed by the compaction below
+    size_t skipped = 0;
+    size_t evicted = 0;
+    while (mLiveBytes > target_bytes && !mLRU.empty() && skipped <= skip_list.size())
+    {
+        if ((++evicted & 63) == 0 && out_of_time())
+        {
+            flushJournal();
+            return true;
+        }
+
+        const LLUUID id = mLRU.back();
+        entry_map_t::iterator iter = mEntries.find(id);
+        if (skip_list.find(id) != skip_list.end())
+        {
+            // Static assets are never purged, move them out of the way
+            mLRU.splice(mLRU.begin(), mLRU, iter->second.mLRUIter);
+            ++skipped;
+            continue;
+        }
+        skipped = 0;
+
+        if (mEnableCacheDebugInfo)
+        {
+            LL_INFOS("LLDiskCache") << "DELETE: " << iter->second.mAccessTime << "  " << iter->second.mSize << "  " << id
+                                    << " (" << mLiveBytes << "/" << target_bytes << ")" << LL_ENDL;
+        }
+        removeEntry(iter);
+    }
+
+    if (mCompactQueue.empty())
+    {
+        io_ops += queueCompaction();
+    }
+
+    while (!mCompactQueue.empty() && !out_of_budget())
+    {
+        const LLUUID id = mCompactQueue.back();
+        mCompactQueue.pop_back();
+
+        // The entry might have been removed or rewritten since it was queued
+        entry_map_t::iterator iter = mEntries.find(id);
+        if (iter == mEntries.end() || mCompactSegments.find(iter->second.mSegment) == mCompactSegments.end())
+        {
+            continue;
+        }
+
+        const U32 old_segment = iter->second.mSegment;
+        if (!relocateEntry(id, iter->second, iter->second.mCapacity))
+        {
+            LL_WARNS("LLDiskCache") << "Failed to compact " << id << ", dropping it from the pack cache" << LL_ENDL;
+            removeEntry(iter);
+        }
+        ++io_ops;
+
+        if (mSegments[old_segment].mLiveBytes == 0)
+        {
+            if (mEnableCacheDebugInfo)
+            {
+                LL_INFOS("LLDiskCache") << "Removing compacted pack cache segment " << getSegmentFilename(old_segment) << LL_ENDL;
+            }
+            deleteSegment(old_segment);
+            mCompactSegments.erase(old_segment);
+            ++io_ops;
+        }
+    }
+
+    if (mCompactQueue.empty())
+    {
+        mCompactSegments.clear();
+    }
+
+    flushJournal();
+    if (mJournal.needsSnapshot(mEntries.size()))
+    {
+        writeJournalSnapshot();
+    }
+
+    const bool eviction_pending = mLiveBytes > target_bytes && !mLRU.empty() && skipped <= skip_list.size();
+    return eviction_pending || !mCompactQueue.empty() || mCompacting;
+}
+
+U32 FSPackedDiskCache::queueCompaction()
+{
+    U32 io_ops = 0;
+
+    // Segments without live data are simply deleted
+    std::vector<U32> empty_segments;
+    for (const segment_map_t::value_type& segment : mSegments)
+    {
+        if (segment.first != mActiveSegment && segment.second.mLiveBytes == 0)
+        {
+            empty_segments.push_back(segment.first);
+        }
+    }
+    for (U32 segment : empty_segments)
+    {
+        if (mEnableCacheDebugInfo)
+        {
+            LL_INFOS("LLDiskCache") << "Removing pack cache segment " << getSegmentFilename(segment) << LL_ENDL;
+        }
+        deleteSegment(segment);
+        ++io_ops;
+    }
+
+    uintmax_t dead_bytes = 0;
+    bool has_empty_segment = false;
+    const U32 worst_segment = findCompactionCandidate(dead_bytes, has_empty_segment);
+    if (!mCompacting && dead_bytes > (uintmax_t)(mMaxBytes * COMPACT_START_DEAD_RATIO))
+    {
+        mCompacting = true;
+    }
+    else if (mCompacting && dead_bytes <= (uintmax_t)(mMaxBytes * COMPACT_STOP_DEAD_RATIO))
+    {
+        mCompacting = false;
+    }
+
+    if (!worst_segment)
+    {
+        mCompacting = false;
+    }
+
+    // Only the segment with the least live data is compacted per pass, it
+    // frees the most space for the data moved.
+    mCompactSegments.clear();
+    if (mCompacting)
+    {
+        if (mEnableCacheDebugInfo)
+        {
+            LL_INFOS("LLDiskCache") << "Compacting pack cache segment " << getSegmentFilename(worst_segment) << ", "
+                                    << dead_bytes << " dead bytes in all segments" << LL_ENDL;
+        }
+
+        mCompactSegments.insert(worst_segment);
+        for (const entry_map_t::value_type& entry : mEntries)
+        {
+            if (entry.second.mSegment == worst_segment)
+            {
+                mCompactQueue.push_back(entry.first);
+            }
+        }
+    }
+
+    return io_ops;
+}
+
+void FSPackedDiskCache::clear()
+{
+    LLMutexLock lock(&mMutex);
+
+    mJournal.clearPending();
+
+    while (!mSegments.empty())
+    {
+        deleteSegment(mSegments.begin()->first);
+    }
+
+    mEntries.clear();
+    mLRU.clear();
+    mCompactQueue.clear();
+    mCompactSegments.clear();
+    mCompacting = false;
+    mLiveBytes = 0;
+    mActiveSegment = 0;
+
+    writeJournalSnapshot();
+}
+
+void FSPackedDiskCache::setMaxSizeBytes(uintmax_t size)
+{
+    LLMutexLock lock(&mMutex);
+    mMaxBytes = size;
+}
+
+uintmax_t FSPackedDiskCache::getLiveBytes()
+{
+    LLMutexLock lock(&mMutex);
+    return mLiveBytes;
+}
+
+uintmax_t FSPackedDiskCache::getDiskBytes()
+{
+    LLMutexLock lock(&mMutex);
+
+    uintmax_t total = 0;
+    for (const segment_map_t::value_type& segment : mSegments)
+    {
+        total += segment.second.mTail;
+    }
+    return total;
+}
+
+size_t FSPackedDiskCache::getEntryCount()
+{
+    LLMutexLock lock(&mMutex);
+    return mEntries.size();
+}
@@ -0,0 +1,228 @@
+/**
+ * @file fspackeddiskcache.h
+ * @brief Pack file backend for the asset disk cache.
+ *
+ * @Description:
+ * Instead of storing every asset in its own file, assets are stored
+ * as extents inside a small number of large segment files:
+ * 1/ Segment files ("sl_cache_pack_<n>.seg") are only ever appended
+ *    to. New assets and assets that outgrow their extent are written
+ *    at the tail of the active segment. Segment numbers are never
+ *    reused so a stale index record can never point at new data.
+ * 2/ The UUID -> (segment, offset, size) index lives in memory and is
+ *    persisted as an append-only journal of fixed size records that
+ *    is replayed on startup and rewritten when it grows too large.
+ * 3/ Eviction is driven by an in-memory LRU list. Evicting an asset
+ *    only marks its extent dead; segments without live extents are
+ *    deleted and mostly dead segments are compacted by moving the
+ *    remaining live extents into the active segment.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_PACKEDDISKCACHE_H
+#define FS_PACKEDDISKCACHE_H
+
+#include "fsrecordjournal.h"
+#include "llfile.h"
+#include "llmutex.h"
+#include "lluuid.h"
+
+#include <boost/unordered_map.hpp>
+#include <list>
+#include <map>
+#include <set>
+
+class FSPackedDiskCache
+{
+public:
+    FSPackedDiskCache(const std::string& pack_dir, uintmax_t max_size_bytes, bool enable_cache_debug_info);
+    ~FSPackedDiskCache();
+
+    /**
+     * Replays the index journal and validates the recorded extents
+     * against the segment files on disk. Returns false if there was
+     * no journal yet, i.e. this is a brand new pack cache.
+     */
+    bool open();
+
+    S32 getSize(const LLUUID& id);
+    bool exists(const LLUUID& id) { return getSize(id) > 0; }
+
+    /**
+     * Reads up to bytes from offset of the asset into buffer and marks the
+     * asset as most recently used. Returns the number of bytes read.
+     */
+    S32 read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes);
+
+    /**
+     * Writes bytes to the asset. If truncate is set the asset content is
+     * replaced by buffer, otherwise buffer is written at offset, or appended
+     * to the end of the asset if offset is negative. On success new_position
+     * receives the position after the written data.
+     */
+    bool write(const LLUUID& id, S32 offset, const U8* buffer, S32 bytes, bool truncate, S32& new_position);
+
+    bool remove(const LLUUID& id);
+    bool rename(const LLUUID& old_id, const LLUUID& new_id);
+
+    /**
+     * Evicts the least recently used assets until the live data fits into
+     * max_bytes, deletes empty segments and compacts mostly dead ones.
+     * Assets in skip_list are never evicted.
+     */
+    void purge(uintmax_t max_bytes, const std::set<LLUUID>& skip_list);
+
+    /**
+     * Returns true if the live data exceeds max_bytes, there are empty
+     * segments or the dead space in the segments grew past the point
+     * where compaction starts.
+     */
+    bool needsPurge(uintmax_t max_bytes);
+
+    /**
+     * Does a bounded amount of purge work: evicts LRU assets down to
+     * target_bytes and compacts sparse segments until max_seconds have
+     * passed or max_io_ops extents were moved or segments deleted. A limit
+     * of 0 means no limit. Returns true if there is work left to do.
+     */
+    bool purgeSlice(uintmax_t target_bytes, const std::set<LLUUID>& skip_list, F64 max_seconds, U32 max_io_ops);
+
+    /**
+     * Removes all segment files and the journal.
+     */
+    void clear();
+
+    /**
+     * Appends all pending index records to the journal file.
+     */
+    void flushJournal();
+
+    void setMaxSizeBytes(uintmax_t size);
+
+    uintmax_t getLiveBytes();
+    uintmax_t getDiskBytes();
+    size_t getEntryCount();
+
+private:
+    typedef std::list<LLUUID> lru_list_t;
+
+    struct Entry
+    {
+        U32 mSegment;
+        U32 mOffset;
+        U32 mSize;
+        U32 mCapacity;
+        U32 mAccessTime;
+        lru_list_t::iterator mLRUIter;
+    };
+    typedef boost::unordered_map<LLUUID, Entry, FSUUIDHash> entry_map_t;
+
+    struct Segment
+    {
+        Segment() : mFile(nullptr), mTail(0), mLiveBytes(0), mReaders(0), mDirty(false) {}
+
+        LLFILE*     mFile;
+        U32         mTail;      // End of the last extent == size of the segment file
+        uintmax_t   mLiveBytes; // Sum of the capacities of all live extents
+        U32         mReaders;   // Reads in progress outside of mMutex
+        bool        mDirty;     // Written to since the last sync
+    };
+    typedef std::map<U32, Segment> segment_map_t;
+
+    enum EJournalOp
+    {
+        JOURNAL_PUT = 1,
+        JOURNAL_DELETE = 2,
+        JOURNAL_TOUCH = 3
+    };
+
+    // On-disk journal record. Fixed size so the journal can be replayed
+    // with plain reads and a torn record at the end is easy to detect.
+    struct JournalRecord
+    {
+        U32 mOp;
+        U32 mSegment;
+        U32 mOffset;
+        U32 mSize;
+        U32 mCapacity;
+        U32 mAccessTime;
+        U8  mID[UUID_BYTES];
+    };
+
+    // All private methods expect mMutex to be held
+    bool readJournal();
+    bool writeJournalSnapshot();
+    bool syncSegments();
+    void queueRecord(EJournalOp op, const LLUUID& id, const Entry* entry);
+
+    LLFILE* getSegmentFile(U32 segment);
+    std::string getSegmentFilename(U32 segment) const;
+    U32 getSegmentMaxBytes() const;
+
+    // Reserves capacity bytes at the tail of the active segment
+    bool allocateExtent(U32 capacity, U32& segment, U32& offset);
+    bool readExtent(U32 segment, U32 offset, U8* buffer, U32 bytes);
+    bool writeExtent(U32 segment, U32 offset, const U8* buffer, U32 bytes);
+    bool relocateEntry(const LLUUID& id, Entry& entry, U32 new_capacity);
+    // Writes the entry with bytes at start replaced by buffer to a fresh
+    // extent and releases the old one, which stays intact on disk
+    bool rewriteEntry(const LLUUID& id, Entry& entry, U32 start, const U8* buffer, U32 bytes, bool truncate);
+
+    void touchEntry(const LLUUID& id, Entry& entry);
+    void releaseEntry(Entry& entry);
+    void removeEntry(entry_map_t::iterator iter);
+    void deleteSegment(U32 segment);
+    void releaseSegmentReader(U32 segment);
+    // Returns the inactive segment with the smallest share of live data if
+    // it is sparse enough to be worth compacting, 0 otherwise. dead_bytes
+    // receives the dead space in all inactive segments.
+    U32 findCompactionCandidate(uintmax_t& dead_bytes, bool& has_empty_segment) const;
+
+    // Deletes empty segments and, while there is enough dead space, queues
+    // the entries of the sparsest segment for relocation. Returns the
+    // number of deleted segments.
+    U32 queueCompaction();
+
+private:
+    LLMutex         mMutex;
+    std::string     mPackDir;
+    bool            mEnableCacheDebugInfo;
+
+    entry_map_t     mEntries;
+    lru_list_t      mLRU; // Front is the most recently used asset
+    segment_map_t   mSegments;
+    segment_map_t   mRetiredSegments; // Deleted segments that still have readers
+    U32             mActiveSegment;
+    U32             mNextSegment;
+    uintmax_t       mLiveBytes;
+    uintmax_t       mMaxBytes; // Cache size limit, used to size new segments
+
+    std::vector<LLUUID> mCompactQueue;    // Entries still to be moved out of mCompactSegments
+    std::set<U32>       mCompactSegments; // Segments currently being compacted
+    bool                mCompacting;      // Between the start and stop dead space marks
+
+    FSRecordJournal mJournal;
+};
+
+#endif // FS_PACKEDDISKCACHE_H
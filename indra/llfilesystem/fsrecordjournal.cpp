@@ -0,0 +1,200 @@
+/**
+ * @file fsrecordjournal.cpp
+ * @brief Append-only journal of fixed size records.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsrecordjournal.h"
+
+FSRecordJournal::FSRecordJournal(const std::string& filename, U32 magic, U32 version, size_t record_size) :
+    mFilename(filename),
+    mMagic(magic),
+    mVersion(version),
+    mRecordSize(record_size),
+    mFile(nullptr),
+    mRecordCount(0),
+    mDamaged(false),
+    mSnapshotFile(nullptr),
+    mSnapshotCount(0),
+    mSnapshotFailed(false)
+{
+}
+
+FSRecordJournal::~FSRecordJournal()
+{
+    if (mFile)
+    {
+        LLFile::close(mFile);
+    }
+    if (mSnapshotFile)
+    {
+        LLFile::close(mSnapshotFile);
+        LLFile::remove(mFilename + ".tmp", ENOENT);
+    }
+}
+
+FSRecordJournal::EReadResult FSRecordJournal::read(const replay_callback_t& replay)
+{
+    mRecordCount = 0;
+    mDamaged = false;
+
+    LLFILE* file = LLFile::fopen(mFilename, "rb");
+    if (!file)
+    {
+        return READ_MISSING;
+    }
+
+    U32 header[2] = { 0, 0 };
+    if (fread(header, sizeof(U32), 2, file) != 2 || header[0] != mMagic || header[1] != mVersion)
+    {
+        LL_WARNS("LLDiskCache") << "Journal " << mFilename << " has an unknown format" << LL_ENDL;
+        LLFile::close(file);
+        return READ_BAD_FORMAT;
+    }
+
+    // A torn record at the end of the file is simply not read
+    EReadResult result = READ_OK;
+    std::vector<U8> record(mRecordSize);
+    size_t bytes_read = 0;
+    while ((bytes_read = fread(&record[0], 1, mRecordSize, file)) == mRecordSize)
+    {
+        ++mRecordCount;
+        if (!replay(&record[0]))
+        {
+            LL_WARNS("LLDiskCache") << "Corrupt record in journal " << mFilename << LL_ENDL;
+            result = READ_CORRUPT;
+            mDamaged = true;
+            break;
+        }
+    }
+    if (bytes_read > 0 && bytes_read < mRecordSize)
+    {
+        LL_WARNS("LLDiskCache") << "Torn record at the end of journal " << mFilename << LL_ENDL;
+        mDamaged = true;
+    }
+
+    LLFile::close(file);
+    return result;
+}
+
+void FSRecordJournal::queue(const void* record)
+{
+    const U8* bytes = (const U8*)record;
+    mPending.insert(mPending.end(), bytes, bytes + mRecordSize);
+}
+
+bool FSRecordJournal::flush()
+{
+    if (mPending.empty())
+    {
+        return true;
+    }
+
+    if (!mFile)
+    {
+        mFile = LLFile::fopen(mFilename, "ab");
+        if (!mFile)
+        {
+            LL_WARNS("LLDiskCache") << "Unable to open journal " << mFilename << LL_ENDL;
+            return false;
+        }
+    }
+
+    const size_t count = getPendingCount();
+    const size_t written = fwrite(&mPending[0], mRecordSize, count, mFile);
+    fflush(mFile);
+    mRecordCount += (U32)written;
+    mPending.clear();
+
+    if (written != count)
+    {
+        LL_WARNS("LLDiskCache") << "Failed to append to journal " << mFilename << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+
+bool FSRecordJournal::needsSnapshot(size_t live_records) const
+{
+    return mDamaged || mRecordCount + getPendingCount() > 2 * live_records + 1024;
+}
+
+bool FSRecordJournal::beginSnapshot()
+{
+    llassert(!mSnapshotFile);
+
+    mSnapshotCount = 0;
+    mSnapshotFailed = false;
+    mSnapshotFile = LLFile::fopen(mFilename + ".tmp", "wb");
+    if (!mSnapshotFile)
+    {
+        LL_WARNS("LLDiskCache") << "Unable to write journal " << mFilename << ".tmp" << LL_ENDL;
+        return false;
+    }
+
+    const U32 header[2] = { mMagic, mVersion };
+    mSnapshotFailed = fwrite(header, sizeof(U32), 2, mSnapshotFile) != 2;
+    return true;
+}
+
+void FSRecordJournal::addSnapshotRecord(const void* record)
+{
+    if (mSnapshotFile && !mSnapshotFailed)
+    {
+        mSnapshotFailed = fwrite(record, mRecordSize, 1, mSnapshotFile) != 1;
+        ++mSnapshotCount;
+    }
+}
+
+bool FSRecordJournal::endSnapshot()
+{
+    if (!mSnapshotFile)
+    {
+        return false;
+    }
+
+    LLFile::close(mSnapshotFile);
+    mSnapshotFile = nullptr;
+
+    const std::string tmp_filename = mFilename + ".tmp";
+    if (mFile)
+    {
+        // Windows can't rename over an open file
+        LLFile::close(mFile);
+        mFile = nullptr;
+    }
+    if (mSnapshotFailed || LLFile::rename(tmp_filename, mFilename) != 0)
+    {
+        LL_WARNS("LLDiskCache") << "Failed to write journal " << mFilename << LL_ENDL;
+        LLFile::remove(tmp_filename, ENOENT);
+        return false;
+    }
+
+    mRecordCount = mSnapshotCount;
+    mDamaged = false;
+    mPending.clear();
+    return true;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file fsrecordjournal.h
+ * @brief Append-only journal of fixed size records.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_RECORDJOURNAL_H
+#define FS_RECORDJOURNAL_H
+
+#include "llfile.h"
+
+#include <functional>
+#include <vector>
+
+/**
+ * On-disk journal of fixed size records behind a magic/version header,
+ * used to persist in-memory cache indexes. Changes are queued and appended
+ * in batches, the whole journal is replaced by a snapshot of the live
+ * records once it is mostly outdated records. Replaying the journal from
+ * the start rebuilds the index.
+ *
+ * Not thread safe, the owner serializes access.
+ */
+class FSRecordJournal
+{
+public:
+    enum EReadResult
+    {
+        READ_MISSING,       // No journal file
+        READ_BAD_FORMAT,    // Unknown magic or version
+        READ_CORRUPT,       // Replay stopped at a record the callback rejected
+        READ_OK
+    };
+
+    // Returns false if the record is corrupt, which ends the replay
+    typedef std::function<bool(const void* record)> replay_callback_t;
+
+    FSRecordJournal(const std::string& filename, U32 magic, U32 version, size_t record_size);
+    ~FSRecordJournal();
+
+    const std::string& getFilename() const { return mFilename; }
+
+    EReadResult read(const replay_callback_t& replay);
+
+    // Adds a record to the batch for the next flush()
+    void queue(const void* record);
+    size_t getPendingCount() const { return mPending.size() / mRecordSize; }
+
+    // Appends the queued records to the journal file
+    bool flush();
+
+    // True if the journal holds a lot more records than live_records, so
+    // it is worth replacing with a snapshot, or if read() stopped before the
+    // end of the file and appending would leave the new records unreadable
+    bool needsSnapshot(size_t live_records) const;
+
+    /**
+     * Replaces the journal with a snapshot. Queued records are dropped, the
+     * snapshot is expected to cover them. Usage:
+     *  beginSnapshot(); for each live entry: addSnapshotRecord(); endSnapshot();
+     * endSnapshot() returns false and leaves the old journal in place if
+     * anything failed.
+     */
+    bool beginSnapshot();
+    void addSnapshotRecord(const void* record);
+    bool endSnapshot();
+
+    void clearPending() { mPending.clear(); }
+
+private:
+    std::string     mFilename;
+    U32             mMagic;
+    U32             mVersion;
+    size_t          mRecordSize;
+
+    LLFILE*         mFile;          // Open for appending between flushes
+    U32             mRecordCount;   // Records in the journal file
+    bool            mDamaged;       // Torn or corrupt records after the last good one
+    std::vector<U8> mPending;
+
+    LLFILE*         mSnapshotFile;
+    U32             mSnapshotCount;
+    bool            mSnapshotFailed;
+};
+
+#endif // FS_RECORDJOURNAL_H
@@ -0,0 +1,91 @@
+/**
+ * @file fsstripeduuidindex.cpp
+ * @brief UUID to index lookup table partitioned into lock stripes.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsstripeduuidindex.h"
+
+FSStripedUUIDIndex::FSStripedUUIDIndex()
+{
+}
+
+S32 FSStripedUUIDIndex::find(const LLUUID& id) const
+{
+    const Stripe& stripe = getStripe(id);
+    LLMutexLock lock(&stripe.mMutex);
+    return stripe.mIndex.find(id);
+}
+
+void FSStripedUUIDIndex::insert(const LLUUID& id, S32 value)
+{
+    Stripe& stripe = getStripe(id);
+    LLMutexLock lock(&stripe.mMutex);
+    stripe.mIndex.insert(id, value);
+}
+
+bool FSStripedUUIDIndex::erase(const LLUUID& id)
+{
+    Stripe& stripe = getStripe(id);
+    LLMutexLock lock(&stripe.mMutex);
+    return stripe.mIndex.erase(id);
+}
+
+void FSStripedUUIDIndex::clear()
+{
+    for (U32 i = 0; i < STRIPE_COUNT; ++i)
+    {
+        LLMutexLock lock(&mStripes[i].mMutex);
+        mStripes[i].mIndex.clear();
+    }
+}
+
+size_t FSStripedUUIDIndex::size() const
+{
+    size_t count = 0;
+    for (U32 i = 0; i < STRIPE_COUNT; ++i)
+    {
+        LLMutexLock lock(&mStripes[i].mMutex);
+        count += mStripes[i].mIndex.size();
+    }
+    return count;
+}
+
+void FSStripedUUIDIndex::lockAll() const
+{
+    for (U32 i = 0; i < STRIPE_COUNT; ++i)
+    {
+        mStripes[i].mMutex.lock();
+    }
+}
+
+void FSStripedUUIDIndex::unlockAll() const
+{
+    for (U32 i = STRIPE_COUNT; i > 0; --i)
+    {
+        mStripes[i - 1].mMutex.unlock();
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * @file fsstripeduuidindex.h
+ * @brief UUID to index lookup table partitioned into lock stripes.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_STRIPEDUUIDINDEX_H
+#define FS_STRIPEDUUIDINDEX_H
+
+#include "fsuuidindex.h"
+#include "llmutex.h"
+
+/**
+ * Maps UUIDs to non-negative S32 values. The table is split into
+ * STRIPE_COUNT FSUUIDIndex tables, each guarded by its own mutex and
+ * selected by the UUID hash, so lookups of different UUIDs rarely
+ * contend for the same lock.
+ *
+ * All methods are thread safe. Callers that need to keep other data
+ * consistent with an entry can hold getMutex(id) around the call, the
+ * stripe mutexes are recursive. When several stripe mutexes are held by
+ * one thread they have to be taken in stripe order, lockAll() does so.
+ */
+class FSStripedUUIDIndex
+{
+public:
+    static const U32 STRIPE_COUNT = 16;
+
+    FSStripedUUIDIndex();
+
+    // Returns the value for id or -1 if id is not in the index
+    S32 find(const LLUUID& id) const;
+
+    // Adds id or replaces its value
+    void insert(const LLUUID& id, S32 value);
+
+    // Returns false if id was not in the index
+    bool erase(const LLUUID& id);
+
+    void clear();
+    size_t size() const;
+
+    LLMutex& getMutex(const LLUUID& id) const { return getStripe(id).mMutex; }
+    void lockAll() const;
+    void unlockAll() const;
+
+private:
+    struct Stripe
+    {
+        mutable LLMutex mMutex;
+        FSUUIDIndex     mIndex;
+    };
+
+    // The top bits of the hash pick the stripe, FSUUIDIndex uses the low bits
+    Stripe& getStripe(const LLUUID& id) const { return mStripes[FSUUIDIndex::hash(id) >> 28]; } // STRIPE_COUNT == 16
+
+    mutable Stripe mStripes[STRIPE_COUNT];
+};
+
+#endif // FS_STRIPEDUUIDINDEX_H
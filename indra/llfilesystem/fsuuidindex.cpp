@@ -0,0 +1,158 @@
+/**
+ * @file fsuuidindex.cpp
+ * @brief Open addressing UUID to index lookup table.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsuuidindex.h"
+
+static const U32 MIN_INDEX_SLOTS = 64;
+
+FSUUIDIndex::FSUUIDIndex() :
+    mCount(0)
+{
+}
+
+// static
+U32 FSUUIDIndex::hash(const LLUUID& id)
+{
+    U64 lo, hi;
+    memcpy(&lo, id.mData, sizeof(U64));
+    memcpy(&hi, id.mData + sizeof(U64), sizeof(U64));
+    U64 h = (lo ^ (hi * 0x9E3779B97F4A7C15ULL)) * 0xC2B2AE3D27D4EB4FULL;
+    return (U32)(h >> 32);
+}
+
+S32 FSUUIDIndex::findSlot(const LLUUID& id, U32 hash) const
+{
+    if (!mCount)
+    {
+        return -1;
+    }
+
+    const U32 mask = (U32)mSlots.size() - 1;
+    for (U32 pos = hash & mask; mSlots[pos].mValue >= 0; pos = (pos + 1) & mask)
+    {
+        if (mSlots[pos].mHash == hash && mSlots[pos].mID == id)
+        {
+            return (S32)pos;
+        }
+    }
+    return -1;
+}
+
+void FSUUIDIndex::grow()
+{
+    const size_t new_size = llmax((size_t)MIN_INDEX_SLOTS, mSlots.size() * 2);
+    std::vector<Slot> old_slots(new_size);
+    old_slots.swap(mSlots);
+    for (Slot& slot : mSlots)
+    {
+        slot.mValue = -1;
+    }
+
+    const U32 mask = (U32)new_size - 1;
+    for (const Slot& slot : old_slots)
+    {
+        if (slot.mValue >= 0)
+        {
+            U32 pos = slot.mHash & mask;
+            while (mSlots[pos].mValue >= 0)
+            {
+                pos = (pos + 1) & mask;
+            }
+            mSlots[pos] = slot;
+        }
+    }
+}
+
+S32 FSUUIDIndex::find(const LLUUID& id) const
+{
+    S32 pos = findSlot(id, hash(id));
+    return pos >= 0 ? mSlots[pos].mValue : -1;
+}
+
+void FSUUIDIndex::insert(const LLUUID& id, S32 value)
+{
+    llassert(value >= 0);
+
+    const U32 h = hash(id);
+    S32 pos = findSlot(id, h);
+    if (pos >= 0)
+    {
+        mSlots[pos].mValue = value;
+        return;
+    }
+
+    // Keep the load factor at or below 1/2
+    if ((mCount + 1) * 2 > mSlots.size())
+    {
+        grow();
+    }
+
+    const U32 mask = (U32)mSlots.size() - 1;
+    U32 free_pos = h & mask;
+    while (mSlots[free_pos].mValue >= 0)
+    {
+        free_pos = (free_pos + 1) & mask;
+    }
+    mSlots[free_pos].mID = id;
+    mSlots[free_pos].mHash = h;
+    mSlots[free_pos].mValue = value;
+    ++mCount;
+}
+
+bool FSUUIDIndex::erase(const LLUUID& id)
+{
+    S32 pos = findSlot(id, hash(id));
+    if (pos < 0)
+    {
+        return false;
+    }
+
+    // Backward shift deletion: move following entries of the probe
+    // sequence into the hole so lookups never need tombstones.
+    const U32 mask = (U32)mSlots.size() - 1;
+    U32 hole = (U32)pos;
+    for (U32 next = (hole + 1) & mask; mSlots[next].mValue >= 0; next = (next + 1) & mask)
+    {
+        U32 home = mSlots[next].mHash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            mSlots[hole] = mSlots[next];
+            hole = next;
+        }
+    }
+    mSlots[hole].mValue = -1;
+    --mCount;
+    return true;
+}
+
+void FSUUIDIndex::clear()
+{
+    mSlots.clear();
+    mCount = 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file fsuuidindex.h
+ * @brief Open addressing UUID to index lookup table.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_UUIDINDEX_H
+#define FS_UUIDINDEX_H
+
+#include "lluuid.h"
+
+#include <vector>
+
+/**
+ * Maps UUIDs to non-negative S32 values in a single open addressing table
+ * with linear probing and backward shift deletion, so lookups never have
+ * to skip tombstones. The load factor is kept at or below 1/2. Slots cache
+ * the hash of their UUID so growing and erasing never rehash.
+ *
+ * Not thread safe, see FSStripedUUIDIndex for a lock striped version.
+ */
+class FSUUIDIndex
+{
+public:
+    FSUUIDIndex();
+
+    static U32 hash(const LLUUID& id);
+
+    // Returns the value for id or -1 if id is not in the index
+    S32 find(const LLUUID& id) const;
+
+    // Adds id or replaces its value
+    void insert(const LLUUID& id, S32 value);
+
+    // Returns false if id was not in the index
+    bool erase(const LLUUID& id);
+
+    void clear();
+    size_t size() const { return mCount; }
+
+private:
+    struct Slot
+    {
+        LLUUID  mID;
+        U32     mHash;
+        S32     mValue; // -1 if the slot is empty
+    };
+
+    S32 findSlot(const LLUUID& id, U32 hash) const;
+    void grow();
+
+    std::vector<Slot>   mSlots; // Size is zero or a power of two
+    U32                 mCount;
+};
+
+#endif // FS_UUIDINDEX_H
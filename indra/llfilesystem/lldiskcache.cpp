@@ -35,26 +35,93 @@
 #include "lldir.h"
 #include <boost/filesystem.hpp>
 #include <boost/range/iterator_range.hpp>
+#include <boost/unordered_set.hpp> // <FS> Incremental LRU bookkeeping
 #include <chrono>
 
 #include "lldiskcache.h"
+#include "fspackeddiskcache.h" // <FS> Packed asset disk cache
+#include "fsrecordjournal.h" // <FS> Incremental LRU bookkeeping
 
 // <FS:Ansariel> Optimize asset simple disk cache
 static const char* subdirs = "0123456789abcdef";
 
+// <FS> Incremental LRU bookkeeping
+static const U32 ACCESS_JOURNAL_MAGIC = 0x4a415346; // "FSAJ"
+static const U32 ACCESS_JOURNAL_VERSION = 1;
+
+// Reads only get journaled if the file wasn't accessed for this long. Same
+// idea as the time_threshold in updateFileAccessTime() but much shorter since
+// the journal records are batched and cheap.
+static const U32 ACCESS_TIME_THRESHOLD = 60;
+// </FS>
+
 LLDiskCache::LLDiskCache(const std::string cache_dir,
                          // <FS:Ansariel> Fix integer overflow
                          //const int max_size_bytes,
                          const uintmax_t max_size_bytes,
-                         const bool enable_cache_debug_info) :
+                         const bool enable_cache_debug_info,
+                         const bool use_pack_files, // <FS> Packed asset disk cache
+                         const bool read_only) : // <FS> Incremental LRU bookkeeping
     mCacheDir(cache_dir),
     mMaxSizeBytes(max_size_bytes),
-    mEnableCacheDebugInfo(enable_cache_debug_info)
+    mEnableCacheDebugInfo(enable_cache_debug_info),
+    // <FS> Incremental LRU bookkeeping
+    mReadOnly(read_only),
+    mRescanSubdir(16),
+    // </FS>
+    // <FS> Background, rate-limited purge
+    mTotalBytes(0),
+    mPurgeCandidatePos(0),
+    mPurgeTargetBytes(0)
+    // </FS>
 {
     mCacheFilenamePrefix = "sl_cache";
 
     LLFile::mkdir(cache_dir);
 
+    // <FS> Packed asset disk cache
+    if (use_pack_files)
+    {
+        mPackedCache = std::make_unique<FSPackedDiskCache>(cache_dir + gDirUtilp->getDirDelimiter() + "pack", max_size_bytes, enable_cache_debug_info);
+        // Files of the one-file-per-asset cache are left alone here, they
+        // are moved into the pack files one by one when they are asked for
+        // (see migrateLooseFile()) and removed by the next cache clear.
+        mPackedCache->open();
+    }
+    // </FS>
+    // <FS> Incremental LRU bookkeeping
+    else
+    {
+        mAccessJournal = std::make_unique<FSRecordJournal>(cache_dir + gDirUtilp->getDirDelimiter() + "disk_cache_access.journal",
+                                                           ACCESS_JOURNAL_MAGIC, ACCESS_JOURNAL_VERSION, sizeof(AccessRecord));
+        mAccessDirtyFilename = cache_dir + gDirUtilp->getDirDelimiter() + "disk_cache_access.dirty";
+
+        LLMutexLock lock(&mIndexMutex);
+        // The marker of a read-only instance belongs to the instance that owns the cache
+        const bool unclean_shutdown = !mReadOnly && LLFile::isfile(mAccessDirtyFilename);
+        if (unclean_shutdown)
+        {
+            LL_INFOS("LLDiskCache") << "Previous session didn't shut down cleanly, the cache index will be rescanned" << LL_ENDL;
+        }
+        if (!loadAccessJournal() || unclean_shutdown)
+        {
+            // FSPurgeDiskCacheThread fills in what the journal is missing
+            mRescanSubdir = 0;
+        }
+
+        if (!mReadOnly)
+        {
+            // Removed again on clean shutdown. If it is still around on the next
+            // start the journal might be missing the last few records.
+            LLFILE* marker = LLFile::fopen(mAccessDirtyFilename, "wb");
+            if (marker)
+            {
+                LLFile::close(marker);
+            }
+        }
+    }
+    // </FS>
+
     // <FS:Ansariel> Optimize asset simple disk cache
     for (S32 i = 0; i < 16; i++)
     {
@@ -69,127 +136,604 @@ LLDiskCache::LLDiskCache(const std::string cache_dir,
     // </FS:Beq>
 }
 
-void LLDiskCache::purge()
+// <FS> Packed asset disk cache
+LLDiskCache::~LLDiskCache()
 {
-    if (mEnableCacheDebugInfo)
+    // <FS> Incremental LRU bookkeeping
+    // Only the instance owning the cache writes the journal. An unfinished
+    // rescan keeps the dirty marker so the next start picks it up again.
+    if (mAccessJournal && !mReadOnly)
     {
-        LL_INFOS() << "Total dir size before purge is " << dirFileSize(mCacheDir) << LL_ENDL;
+        LLMutexLock lock(&mIndexMutex);
+        if (writeAccessJournalSnapshot() && mRescanSubdir >= 16)
+        {
+            LLFile::remove(mAccessDirtyFilename, ENOENT);
+        }
     }
+    // </FS>
+}
 
-    boost::system::error_code ec;
-    auto start_time = std::chrono::high_resolution_clock::now();
+void LLDiskCache::setMaxSizeBytes(uintmax_t size)
+{
+    mMaxSizeBytes = size;
+    if (mPackedCache)
+    {
+        mPackedCache->setMaxSizeBytes(size);
+    }
+}
+
+void LLDiskCache::flushJournal()
+{
+    if (mPackedCache)
+    {
+        mPackedCache->flushJournal();
+    }
+    // <FS> Incremental LRU bookkeeping
+    else if (mAccessJournal)
+    {
+        LLMutexLock lock(&mIndexMutex);
+        flushAccessJournal();
+    }
+    // </FS>
+}
 
-    typedef std::pair<std::time_t, std::pair<uintmax_t, std::string>> file_info_t;
-    std::vector<file_info_t> file_info;
+void LLDiskCache::removeLooseFiles()
+{
+    LL_INFOS("LLDiskCache") << "Removing loose cache files from " << mCacheDir << LL_ENDL;
 
+    boost::system::error_code ec;
 #if LL_WINDOWS
     std::wstring cache_path(utf8str_to_utf16str(mCacheDir));
 #else
     std::string cache_path(mCacheDir);
 #endif
-    if (boost::filesystem::is_directory(cache_path, ec) && !ec.failed())
+    // Only the 0-f subdirectories hold loose files, the pack files live next to them
+    for (S32 i = 0; i < 16; i++)
     {
-        // <FS:Ansariel> Optimize asset simple disk cache
-        //for (auto& entry : boost::make_iterator_range(boost::filesystem::directory_iterator(cache_path, ec), {}))
-        for (auto& entry : boost::make_iterator_range(boost::filesystem::recursive_directory_iterator(cache_path, ec), {}))
+        boost::filesystem::path sub_path = boost::filesystem::path(cache_path) / std::string(1, subdirs[i]);
+        if (!boost::filesystem::is_directory(sub_path, ec) || ec.failed())
         {
-            if (!ec.failed() && (boost::filesystem::is_regular_file(entry, ec) && !ec.failed()))
+            continue;
+        }
+
+        for (auto& entry : boost::make_iterator_range(boost::filesystem::directory_iterator(sub_path, ec), {}))
+        {
+            if (!ec.failed() && boost::filesystem::is_regular_file(entry, ec) && !ec.failed() &&
+                entry.path().filename().string().find(mCacheFilenamePrefix) != std::string::npos)
             {
-                if (entry.path().string().find(mCacheFilenamePrefix) != std::string::npos)
+                boost::filesystem::remove(entry.path(), ec);
+                if (ec.failed())
                 {
-                    uintmax_t file_size = boost::filesystem::file_size(entry, ec);
-                    if (ec.failed())
-                    {
-                        continue;
-                    }
-                    const std::string file_path = entry.path().string();
-                    const std::time_t file_time = boost::filesystem::last_write_time(entry, ec);
+                    LL_WARNS() << "Failed to delete cache file " << entry.path().string() << ": " << ec.message() << LL_ENDL;
+                }
+            }
+        }
+    }
+}
+// </FS>
+
+void LLDiskCache::purge()
+{
+    // <FS> Packed asset disk cache
+    if (mPackedCache)
+    {
+        LL_INFOS() << "Purging pack cache to a maximum of " << mMaxSizeBytes << " bytes" << LL_ENDL;
+        mPackedCache->purge(mMaxSizeBytes, mSkipIDs);
+        return;
+    }
+    // </FS>
+
+    // <FS> Background, rate-limited purge
+    //if (mEnableCacheDebugInfo)
+    //{
+    //    LL_INFOS() << "Total dir size before purge is " << dirFileSize(mCacheDir) << LL_ENDL;
+    //}
+    LLMutexLock purge_lock(&mPurgeMutex);
+
+    if (mEnableCacheDebugInfo)
+    {
+        LL_INFOS() << "Total cache size before purge is " << getTotalBytes() << LL_ENDL;
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    LL_INFOS() << "Purging cache to a maximum of " << mMaxSizeBytes << " bytes" << LL_ENDL;
+
+    // The whole purge is just a slice without limits
+    startPurge(mMaxSizeBytes);
+    const size_t file_count = mPurgeCandidates.size();
+    while (purgeSlice(0.0, 0))
+    {
+    }
+
+    if (mEnableCacheDebugInfo)
+    {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+        LL_INFOS() << "Total cache size after purge is " << getTotalBytes() << LL_ENDL;
+        LL_INFOS() << "Cache purge took " << execute_time << " ms to execute for " << file_count << " files" << LL_ENDL;
+    }
+    // </FS>
+}
+
+// <FS> Background, rate-limited purge
+bool LLDiskCache::needsPurge()
+{
+    if (mPackedCache)
+    {
+        return mPackedCache->needsPurge(mMaxSizeBytes);
+    }
+
+    return getTotalBytes() > mMaxSizeBytes;
+}
+
+uintmax_t LLDiskCache::getTotalBytes()
+{
+    if (mPackedCache)
+    {
+        return mPackedCache->getDiskBytes();
+    }
+
+    LLMutexLock lock(&mIndexMutex);
+    return mTotalBytes;
+}
+
+uintmax_t LLDiskCache::getLowWaterBytes() const
+{
+    return mMaxSizeBytes / 10 * 9;
+}
+
+void LLDiskCache::startPurge(uintmax_t target_bytes)
+{
+    mPurgeCandidates.clear();
+    mPurgeCandidatePos = 0;
+    mPurgeTargetBytes = target_bytes;
+
+    {
+        LLMutexLock lock(&mIndexMutex);
+        mPurgeCandidates.reserve(mFileIndex.size());
+        for (const file_index_t::value_type& entry : mFileIndex)
+        {
+            PurgeCandidate candidate;
+            candidate.mAccessTime = entry.second.mAccessTime;
+            candidate.mSize = entry.second.mSize;
+            candidate.mID = entry.first;
+            mPurgeCandidates.push_back(candidate);
+        }
+    }
+
+    // Oldest first
+    std::sort(mPurgeCandidates.begin(), mPurgeCandidates.end(), [](const PurgeCandidate& x, const PurgeCandidate& y)
+    {
+        return x.mAccessTime < y.mAccessTime;
+    });
+}
+
+bool LLDiskCache::purgeSlice(F64 max_seconds, U32 max_io_ops)
+{
+    LLMutexLock purge_lock(&mPurgeMutex);
+
+    if (mPackedCache)
+    {
+        return mPackedCache->purgeSlice(getLowWaterBytes(), mSkipIDs, max_seconds, max_io_ops);
+    }
+
+    // Evict down to the low water mark so we don't start over right away
+    if (mPurgeCandidatePos >= mPurgeCandidates.size())
+    {
+        startPurge(getLowWaterBytes());
+    }
+
+    boost::system::error_code ec;
+    LLTimer timer;
+    U32 io_ops = 0;
+
+    while (mPurgeCandidatePos < mPurgeCandidates.size())
+    {
+        if ((max_io_ops > 0 && io_ops >= max_io_ops) || (max_seconds > 0.0 && timer.getElapsedTimeF64() > max_seconds))
+        {
+            flushJournal();
+            return true;
+        }
+
+        uintmax_t total_bytes = 0;
+        {
+            LLMutexLock lock(&mIndexMutex);
+            total_bytes = mTotalBytes;
+        }
+        if (total_bytes <= mPurgeTargetBytes)
+        {
+            break;
+        }
+
+        const PurgeCandidate& candidate = mPurgeCandidates[mPurgeCandidatePos++];
+
+        std::string action = "DELETE:";
+        // <FS:Beq> Make sure static assets are not eliminated
+        if (mSkipIDs.find(candidate.mID) != mSkipIDs.end())
+        {
+            // this is one of our protected items so no purging
+            action = "STATIC:";
+        }
+        // </FS:Beq>
+        else
+        {
+            // Delete the file unless it was used since the purge started. The
+            // index lock is held until the file is gone, so a write recorded
+            // after the check can't lose its file.
+            bool still_unused = false;
+            {
+                LLMutexLock lock(&mIndexMutex);
+                file_index_t::iterator iter = mFileIndex.find(candidate.mID);
+                if (iter != mFileIndex.end() && iter->second.mAccessTime == candidate.mAccessTime)
+                {
+                    // <FS:Ansariel> Do not crash if we cannot delete the file for some reason
+                    const std::string file_path = metaDataToFilepath(candidate.mID.asString(), LLAssetType::AT_UNKNOWN, std::string());
+                    boost::filesystem::remove(file_path, ec);
                     if (ec.failed())
                     {
-                        continue;
+                        LL_WARNS() << "Failed to delete cache file " << file_path << ": " << ec.message() << LL_ENDL;
                     }
+                    // </FS:Ansariel>
 
-                    file_info.push_back(file_info_t(file_time, { file_size, file_path }));
+                    mTotalBytes -= llmin(mTotalBytes, iter->second.mSize);
+                    mFileIndex.erase(iter);
+                    queueAccessRecord(ACCESS_REMOVE, candidate.mID, nullptr);
+                    still_unused = true;
                 }
             }
+
+            if (still_unused)
+            {
+                ++io_ops;
+            }
+            else
+            {
+                action = "  USED:";
+            }
         }
+
+        if (mEnableCacheDebugInfo)
+        {
+            // have to do this because of LL_INFO/LL_END weirdness
+            std::ostringstream line;
+
+            line << action << "  ";
+            line << candidate.mAccessTime << "  ";
+            line << candidate.mSize << "  ";
+            line << candidate.mID;
+            line << " (" << total_bytes << "/" << mPurgeTargetBytes << ")";
+            LL_INFOS() << line.str() << LL_ENDL;
+        }
+    }
+
+    mPurgeCandidates.clear();
+    mPurgeCandidatePos = 0;
+    flushJournal();
+    return false;
+}
+// </FS>
+
+// <FS> Incremental LRU bookkeeping
+void LLDiskCache::recordFileAccess(const LLUUID& id)
+{
+    if (mPackedCache)
+    {
+        return;
     }
 
-    std::sort(file_info.begin(), file_info.end(), [](file_info_t& x, file_info_t& y)
+    const U32 now = (U32)std::time(nullptr);
+
+    LLMutexLock lock(&mIndexMutex);
+    file_index_t::iterator iter = mFileIndex.find(id);
+    if (iter != mFileIndex.end() && now - iter->second.mAccessTime > ACCESS_TIME_THRESHOLD)
     {
-        return x.first > y.first;
-    });
+        iter->second.mAccessTime = now;
+        queueAccessRecord(ACCESS_READ, id, &iter->second);
+    }
+}
 
-    LL_INFOS() << "Purging cache to a maximum of " << mMaxSizeBytes << " bytes" << LL_ENDL;
+void LLDiskCache::recordFileWrite(const LLUUID& id, uintmax_t size, bool grow_only)
+{
+    if (mPackedCache)
+    {
+        return;
+    }
 
-    // <FS:Beq> Extra accounting to track the retention of static assets
-    int keep{0};
-    int del{0};
-    int skip{0};
-    // </FS:Beq>
-    uintmax_t file_size_total = 0;
-    for (file_info_t& entry : file_info)
+    LLMutexLock lock(&mIndexMutex);
+    file_index_t::iterator iter = mFileIndex.find(id);
+    if (iter == mFileIndex.end())
     {
-        file_size_total += entry.second.first;
+        iter = mFileIndex.insert(std::make_pair(id, FileInfo())).first;
+        iter->second.mSize = 0;
+    }
 
-        std::string action = "";
-        if (file_size_total > mMaxSizeBytes)
+    iter->second.mAccessTime = (U32)std::time(nullptr);
+    const uintmax_t new_size = grow_only ? llmax(iter->second.mSize, size) : size;
+    mTotalBytes = mTotalBytes - llmin(mTotalBytes, iter->second.mSize) + new_size; // <FS/> Background, rate-limited purge
+    iter->second.mSize = new_size;
+    queueAccessRecord(ACCESS_WRITE, id, &iter->second);
+}
+
+void LLDiskCache::recordFileRemove(const LLUUID& id)
+{
+    if (mPackedCache)
+    {
+        return;
+    }
+
+    LLMutexLock lock(&mIndexMutex);
+    file_index_t::iterator iter = mFileIndex.find(id);
+    if (iter != mFileIndex.end())
+    {
+        mTotalBytes -= llmin(mTotalBytes, iter->second.mSize); // <FS/> Background, rate-limited purge
+        mFileIndex.erase(iter);
+        queueAccessRecord(ACCESS_REMOVE, id, nullptr);
+    }
+}
+
+void LLDiskCache::recordFileRename(const LLUUID& old_id, const LLUUID& new_id)
+{
+    if (mPackedCache)
+    {
+        return;
+    }
+
+    LLMutexLock lock(&mIndexMutex);
+    file_index_t::iterator iter = mFileIndex.find(old_id);
+    if (iter == mFileIndex.end())
+    {
+        return;
+    }
+
+    FileInfo info = iter->second;
+    mFileIndex.erase(iter);
+    queueAccessRecord(ACCESS_REMOVE, old_id, nullptr);
+
+    // <FS> Background, rate-limited purge
+    file_index_t::iterator new_iter = mFileIndex.find(new_id);
+    if (new_iter != mFileIndex.end())
+    {
+        mTotalBytes -= llmin(mTotalBytes, new_iter->second.mSize);
+    }
+    // </FS>
+    mFileIndex[new_id] = info;
+    queueAccessRecord(ACCESS_WRITE, new_id, &info);
+}
+
+bool LLDiskCache::loadAccessJournal()
+{
+    FSRecordJournal::EReadResult result = mAccessJournal->read([this](const void* data)
+    {
+        const AccessRecord& record = *(const AccessRecord*)data;
+
+        LLUUID id;
+        memcpy(id.mData, record.mID, UUID_BYTES);
+
+        switch (record.mOp)
         {
-            action = "DELETE:";
-            // <FS:Beq> Make sure static assets are not eliminated
-            auto uuid_as_string = gDirUtilp->getBaseFileName(entry.second.second,true);
-            uuid_as_string = uuid_as_string.substr(mCacheFilenamePrefix.size() + 1, 36);// skip "sl_cache_" and trailing "_N"        
-            // LL_INFOS() << "checking UUID=" <<uuid_as_string<< LL_ENDL;
-            if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) != mSkipList.end())
+            case ACCESS_WRITE:
             {
-                // this is one of our protected items so no purging
-                action = "STATIC:";
-                skip++;
-                updateFileAccessTime(entry.second.second); // force these to the front of the list next time so that purge size works 
+                FileInfo& info = mFileIndex[id];
+                info.mAccessTime = record.mAccessTime;
+                info.mSize = record.mSize;
+                return true;
             }
-            else 
+            case ACCESS_READ:
             {
-                del++;    // Extra accounting to track the retention of static assets
-            // </FS:Beq>
-            // <FS:Ansariel> Do not crash if we cannot delete the file for some reason
-                //boost::filesystem::remove(entry.second.second);
-                boost::filesystem::remove(entry.second.second, ec);
-                if (ec.failed())
+                file_index_t::iterator iter = mFileIndex.find(id);
+                if (iter != mFileIndex.end())
                 {
-                    LL_WARNS() << "Failed to delete cache file " << entry.second.second << ": " << ec.message() << LL_ENDL;
+                    iter->second.mAccessTime = record.mAccessTime;
                 }
+                return true;
             }
-            // </FS:Ansariel>
+            case ACCESS_REMOVE:
+                mFileIndex.erase(id);
+                return true;
+            default:
+                return false;
         }
-        else
+    });
+
+    if (result != FSRecordJournal::READ_OK)
+    {
+        mFileIndex.clear();
+        return false;
+    }
+
+    // <FS> Background, rate-limited purge
+    mTotalBytes = 0;
+    for (const file_index_t::value_type& entry : mFileIndex)
+    {
+        mTotalBytes += entry.second.mSize;
+    }
+    // </FS>
+
+    if (mEnableCacheDebugInfo)
+    {
+        LL_INFOS("LLDiskCache") << "Loaded " << mFileIndex.size() << " cache entries (" << mTotalBytes << " bytes) from " << mAccessJournal->getFilename() << LL_ENDL;
+    }
+    return true;
+}
+
+bool LLDiskCache::rescanSlice()
+{
+    if (!mAccessJournal)
+    {
+        return false;
+    }
+
+    S32 subdir_index = 0;
+    {
+        LLMutexLock lock(&mIndexMutex);
+        subdir_index = mRescanSubdir;
+    }
+    if (subdir_index >= 16)
+    {
+        return false;
+    }
+
+    const char subdir = subdirs[subdir_index];
+    const U32 scan_time = (U32)std::time(nullptr);
+
+    // Enumerate the directory without holding the index lock
+    std::vector<std::pair<LLUUID, FileInfo>> found;
+    boost::system::error_code ec;
+#if LL_WINDOWS
+    std::wstring cache_path(utf8str_to_utf16str(mCacheDir));
+#else
+    std::string cache_path(mCacheDir);
+#endif
+    boost::filesystem::path sub_path = boost::filesystem::path(cache_path) / std::string(1, subdir);
+    if (boost::filesystem::is_directory(sub_path, ec) && !ec.failed())
+    {
+        for (auto& entry : boost::make_iterator_range(boost::filesystem::directory_iterator(sub_path, ec), {}))
         {
-            keep++;    // <FS:Beq/> Extra accounting to track the retention of static assets
-            action = "  KEEP:";
+            if (ec.failed() || !boost::filesystem::is_regular_file(entry, ec) || ec.failed())
+            {
+                continue;
+            }
+
+            // File names are "sl_cache_<uuid>_<extra info>.asset"
+            const std::string filename = entry.path().filename().string();
+            if (filename.compare(0, mCacheFilenamePrefix.size(), mCacheFilenamePrefix) != 0 ||
+                filename.size() < mCacheFilenamePrefix.size() + 1 + UUID_STR_LENGTH - 1)
+            {
+                continue;
+            }
+
+            LLUUID id;
+            if (!id.set(filename.substr(mCacheFilenamePrefix.size() + 1, UUID_STR_LENGTH - 1), FALSE))
+            {
+                continue;
+            }
+
+            FileInfo info;
+            info.mSize = boost::filesystem::file_size(entry, ec);
+            if (ec.failed())
+            {
+                continue;
+            }
+            const std::time_t file_time = boost::filesystem::last_write_time(entry, ec);
+            if (ec.failed())
+            {
+                continue;
+            }
+            info.mAccessTime = (U32)file_time;
+            found.emplace_back(id, info);
         }
+    }
 
-        if (mEnableCacheDebugInfo)
+    LLMutexLock lock(&mIndexMutex);
+    if (mRescanSubdir != subdir_index)
+    {
+        // The cache was cleared in the meantime
+        return mRescanSubdir < 16;
+    }
+
+    boost::unordered_set<LLUUID, FSUUIDHash> found_ids;
+    for (const std::pair<LLUUID, FileInfo>& item : found)
+    {
+        found_ids.insert(item.first);
+
+        file_index_t::iterator iter = mFileIndex.find(item.first);
+        if (iter == mFileIndex.end())
         {
-            // have to do this because of LL_INFO/LL_END weirdness
-            std::ostringstream line;
+            mFileIndex[item.first] = item.second;
+            mTotalBytes += item.second.mSize; // <FS/> Background, rate-limited purge
+            queueAccessRecord(ACCESS_WRITE, item.first, &item.second);
+        }
+        else if (iter->second.mSize != item.second.mSize)
+        {
+            mTotalBytes = mTotalBytes - llmin(mTotalBytes, iter->second.mSize) + item.second.mSize; // <FS/> Background, rate-limited purge
+            iter->second.mSize = item.second.mSize;
+            iter->second.mAccessTime = llmax(iter->second.mAccessTime, item.second.mAccessTime);
+            queueAccessRecord(ACCESS_WRITE, item.first, &iter->second);
+        }
+    }
 
-            line << action << "  ";
-            line << entry.first << "  ";
-            line << entry.second.first << "  ";
-            line << entry.second.second;
-            line << " (" << file_size_total << "/" << mMaxSizeBytes << ")";
-            LL_INFOS() << line.str() << LL_ENDL;
+    // Drop entries of this subdirectory whose file is gone. Entries touched
+    // since the scan started may belong to files written in the meantime.
+    for (file_index_t::iterator iter = mFileIndex.begin(); iter != mFileIndex.end(); )
+    {
+        if (subdirs[iter->first.mData[0] >> 4] == subdir && iter->second.mAccessTime < scan_time &&
+            found_ids.find(iter->first) == found_ids.end())
+        {
+            mTotalBytes -= llmin(mTotalBytes, iter->second.mSize); // <FS/> Background, rate-limited purge
+            queueAccessRecord(ACCESS_REMOVE, iter->first, nullptr);
+            iter = mFileIndex.erase(iter);
+        }
+        else
+        {
+            ++iter;
         }
     }
 
-    if (mEnableCacheDebugInfo)
+    if (++mRescanSubdir >= 16)
     {
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-        LL_INFOS() << "Total dir size after purge is " << dirFileSize(mCacheDir) << LL_ENDL;
-        LL_INFOS() << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
-        LL_INFOS() << "Deleted: " << del << " Skipped: " << skip << " Kept: " << keep << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
+        LL_INFOS("LLDiskCache") << "Indexed " << mFileIndex.size() << " cache files (" << mTotalBytes << " bytes)" << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+
+bool LLDiskCache::writeAccessJournalSnapshot()
+{
+    if (mReadOnly || !mAccessJournal->beginSnapshot())
+    {
+        return false;
+    }
+
+    for (const file_index_t::value_type& entry : mFileIndex)
+    {
+        AccessRecord record;
+        record.mOp = ACCESS_WRITE;
+        record.mAccessTime = entry.second.mAccessTime;
+        record.mSize = entry.second.mSize;
+        memcpy(record.mID, entry.first.mData, UUID_BYTES);
+        mAccessJournal->addSnapshotRecord(&record);
+    }
+
+    return mAccessJournal->endSnapshot();
+}
+
+void LLDiskCache::queueAccessRecord(EAccessOp op, const LLUUID& id, const FileInfo* info)
+{
+    if (mReadOnly)
+    {
+        return;
+    }
+
+    AccessRecord record;
+    memset(&record, 0, sizeof(AccessRecord));
+    record.mOp = op;
+    memcpy(record.mID, id.mData, UUID_BYTES);
+    if (info)
+    {
+        record.mAccessTime = info->mAccessTime;
+        record.mSize = info->mSize;
+    }
+    mAccessJournal->queue(&record);
+}
+
+void LLDiskCache::flushAccessJournal()
+{
+    if (mReadOnly)
+    {
+        return;
     }
+
+    // Compact the journal instead of appending if it is mostly outdated records
+    if (mAccessJournal->needsSnapshot(mFileIndex.size()))
+    {
+        writeAccessJournalSnapshot();
+        return;
+    }
+
+    mAccessJournal->flush();
 }
+// </FS>
 
 const std::string LLDiskCache::assetTypeToString(LLAssetType::EType at)
 {
@@ -339,7 +883,10 @@ const std::string LLDiskCache::getCacheInfo()
     std::ostringstream cache_info;
 
     F32 max_in_mb = (F32)mMaxSizeBytes / (1024.0 * 1024.0);
-    F32 percent_used = ((F32)dirFileSize(mCacheDir) / (F32)mMaxSizeBytes) * 100.0;
+    // <FS> Background, rate-limited purge
+    //F32 percent_used = ((F32)dirFileSize(mCacheDir) / (F32)mMaxSizeBytes) * 100.0;
+    F32 percent_used = ((F32)getTotalBytes() / (F32)mMaxSizeBytes) * 100.0;
+    // </FS>
 
     cache_info << std::fixed;
     cache_info << std::setprecision(1);
@@ -354,6 +901,7 @@ const std::string LLDiskCache::getCacheInfo()
 void LLDiskCache::prepopulateCacheWithStatic()
 {
     mSkipList.clear();
+    mSkipIDs.clear(); // <FS> Packed asset disk cache
 
     std::vector<std::string> from_folders;
     from_folders.emplace_back(gDirUtilp->getExpandedFilename(LL_PATH_APP_SETTINGS, "fs_static_assets"));
@@ -371,6 +919,26 @@ void LLDiskCache::prepopulateCacheWithStatic()
                 from_asset_file = from_folder + gDirUtilp->getDirDelimiter() + from_asset_file;
                 // we store static assets as UUID.asset_type the asset_type is not used in the current simple cache format
                 auto uuid_as_string{ gDirUtilp->getBaseFileName(from_asset_file, true) };
+                // <FS> Packed asset disk cache
+                if (mPackedCache)
+                {
+                    LLUUID asset_id;
+                    if (!asset_id.set(uuid_as_string, FALSE))
+                    {
+                        continue;
+                    }
+                    if (!mPackedCache->exists(asset_id))
+                    {
+                        if (mEnableCacheDebugInfo)
+                        {
+                            LL_INFOS("LLDiskCache") << "Copying static asset " << from_asset_file << " to pack cache from " << from_folder << LL_ENDL;
+                        }
+                        copyFileToPackedCache(from_asset_file, asset_id);
+                    }
+                    mSkipIDs.insert(asset_id);
+                    continue;
+                }
+                // </FS>
                 auto to_asset_file = metaDataToFilepath(uuid_as_string, LLAssetType::AT_UNKNOWN, std::string());
                 if (!gDirUtilp->fileExists(to_asset_file))
                 {
@@ -382,6 +950,17 @@ void LLDiskCache::prepopulateCacheWithStatic()
                     {
                         LL_WARNS("LLDiskCache") << "Failed to copy " << from_asset_file << " to " << to_asset_file << LL_ENDL;
                     }
+                    // <FS> Incremental LRU bookkeeping
+                    else
+                    {
+                        llstat file_stat;
+                        LLUUID asset_id;
+                        if (asset_id.set(uuid_as_string, FALSE) && LLFile::stat(to_asset_file, &file_stat) == 0)
+                        {
+                            recordFileWrite(asset_id, file_stat.st_size, false);
+                        }
+                    }
+                    // </FS>
                 }
                 if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) == mSkipList.end())
                 {
@@ -390,6 +969,13 @@ void LLDiskCache::prepopulateCacheWithStatic()
                         LL_INFOS("LLDiskCache") << "Adding " << uuid_as_string << " to skip list" << LL_ENDL;
                     }
                     mSkipList.emplace_back(uuid_as_string);
+                    // <FS> Incremental LRU bookkeeping
+                    LLUUID asset_id;
+                    if (asset_id.set(uuid_as_string, FALSE))
+                    {
+                        mSkipIDs.insert(asset_id);
+                    }
+                    // </FS>
                 }
             }
         }
@@ -397,9 +983,80 @@ void LLDiskCache::prepopulateCacheWithStatic()
 }
 // </FS:Beq>
 
+// <FS> Packed asset disk cache
+bool LLDiskCache::copyFileToPackedCache(const std::string& filename, const LLUUID& asset_id)
+{
+    LLFILE* file = LLFile::fopen(filename, "rb");
+    if (!file)
+    {
+        LL_WARNS("LLDiskCache") << "Failed to open " << filename << LL_ENDL;
+        return false;
+    }
+
+    std::vector<U8> buffer;
+    U8 chunk[16384];
+    size_t bytes_read = 0;
+    while ((bytes_read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        buffer.insert(buffer.end(), chunk, chunk + bytes_read);
+    }
+    LLFile::close(file);
+
+    S32 position = 0;
+    if (buffer.empty() || !mPackedCache->write(asset_id, 0, &buffer[0], (S32)buffer.size(), true, position))
+    {
+        LL_WARNS("LLDiskCache") << "Failed to copy " << filename << " to the pack cache" << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+
+bool LLDiskCache::migrateLooseFile(const LLUUID& asset_id, LLAssetType::EType asset_type)
+{
+    if (!mPackedCache)
+    {
+        return false;
+    }
+
+    std::string id_str;
+    asset_id.toString(id_str);
+    const std::string filename = metaDataToFilepath(id_str, asset_type, std::string());
+
+    llstat file_stat;
+    if (LLFile::stat(filename, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size <= 0)
+    {
+        return false;
+    }
+
+    if (!copyFileToPackedCache(filename, asset_id))
+    {
+        return false;
+    }
+
+    if (mEnableCacheDebugInfo)
+    {
+        LL_INFOS("LLDiskCache") << "Moved " << filename << " into the pack cache" << LL_ENDL;
+    }
+    LLFile::remove(filename, ENOENT);
+    return true;
+}
+// </FS>
+
 void LLDiskCache::clearCache()
 {
     LL_INFOS() << "clearing cache " << mCacheDir << LL_ENDL;
+
+    // <FS> Packed asset disk cache
+    if (mPackedCache)
+    {
+        mPackedCache->clear();
+        removeLooseFiles();
+        prepopulateCacheWithStatic();
+        LL_INFOS() << "Cleared cache " << mCacheDir << LL_ENDL;
+        return;
+    }
+    // </FS>
+
     /**
      * See notes on performance in dirFileSize(..) - there may be
      * a quicker way to do this by operating on the parent dir vs
@@ -453,6 +1110,15 @@ void LLDiskCache::clearCache()
             }
             // </FS:TS> FIRE-31070
         }
+        // <FS> Incremental LRU bookkeeping
+        {
+            LLMutexLock lock(&mIndexMutex);
+            mFileIndex.clear();
+            mTotalBytes = 0; // <FS/> Background, rate-limited purge
+            mRescanSubdir = 16;
+            writeAccessJournalSnapshot();
+        }
+        // </FS>
         // <FS:Beq> add static assets into the new cache after clear
     LL_INFOS() << "prepopulating new cache " << LL_ENDL;
         prepopulateCacheWithStatic();
@@ -504,24 +1170,75 @@ uintmax_t LLDiskCache::dirFileSize(const std::string dir)
 
 // <FS:Ansariel> Regular disk cache cleanup
 FSPurgeDiskCacheThread::FSPurgeDiskCacheThread() :
-    LLThread("PurgeDiskCacheThread", nullptr)
+    LLThread("PurgeDiskCacheThread", nullptr),
+    mPurging(false) // <FS/> Background, rate-limited purge
 {
 }
 
 void FSPurgeDiskCacheThread::run()
 {
-    constexpr F64 CHECK_INTERVAL = 60;
+    // <FS> Background, rate-limited purge
+    //constexpr F64 CHECK_INTERVAL = 60;
+    // Checking is cheap now that the cache keeps a running total of its size.
+    // Once the cache is over its limit the purge runs in small slices that are
+    // limited in time and number of file operations so it never causes an
+    // I/O burst, e.g. while we are busy loading a region.
+    constexpr F64 CHECK_INTERVAL = 5;
+    constexpr F64 SLICE_SECONDS = 0.01;
+    constexpr U32 SLICE_IO_OPS = 16;
+    constexpr U32 SLICE_INTERVAL_MS = 50;
+    // </FS>
     mTimer.setTimerExpirySec(CHECK_INTERVAL);
     mTimer.start();
 
+    // <FS> Incremental LRU bookkeeping
+    bool rescanning = true;
+    // </FS>
+
+    // <FS> Packed asset disk cache
+    constexpr F64 FLUSH_INTERVAL = 5;
+    mFlushTimer.setTimerExpirySec(FLUSH_INTERVAL);
+    mFlushTimer.start();
+    // </FS>
+
     do
     {
-        if (mTimer.checkExpirationAndReset(CHECK_INTERVAL))
+        // <FS> Incremental LRU bookkeeping
+        // Finish reconciling the cache index before purging based on it
+        if (rescanning)
+        {
+            rescanning = LLDiskCache::instance().rescanSlice();
+            ms_sleep(SLICE_INTERVAL_MS);
+            continue;
+        }
+        // </FS>
+
+        // <FS> Background, rate-limited purge
+        //if (mTimer.checkExpirationAndReset(CHECK_INTERVAL))
+        //{
+        //    LLDiskCache::instance().purge();
+        //}
+        if (!mPurging && mTimer.checkExpirationAndReset(CHECK_INTERVAL))
+        {
+            mPurging = LLDiskCache::instance().needsPurge();
+        }
+
+        if (mPurging)
+        {
+            mPurging = LLDiskCache::instance().purgeSlice(SLICE_SECONDS, SLICE_IO_OPS);
+        }
+        // </FS>
+        // <FS> Packed asset disk cache
+        else if (mFlushTimer.checkExpirationAndReset(FLUSH_INTERVAL))
         {
-            LLDiskCache::instance().purge();
+            LLDiskCache::instance().flushJournal();
         }
+        // </FS>
 
-        ms_sleep(100);
+        // <FS> Background, rate-limited purge
+        //ms_sleep(100);
+        ms_sleep(mPurging ? SLICE_INTERVAL_MS : 100);
+        // </FS>
     } while (!isQuitting());
 }
 // </FS:Ansariel>
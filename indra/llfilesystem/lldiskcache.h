@@ -30,6 +30,13 @@
  *    the files is less than the maximum size specified.
  * 4/ An LLSingleton idiom is used since there will only ever be
  *    a single cache and we want to access it from numerous places.
+ * <FS> 2/ and 3/ now use an in-memory index of the access time and size
+ *    of every cache file instead of the file modification times. Reads
+ *    only update the index, changes are appended in batches to a small
+ *    access journal that is replayed on startup. The purge sorts the
+ *    index and never enumerates the cache directory. The directory is
+ *    only scanned to rebuild the index if the journal is missing or the
+ *    previous session didn't shut down cleanly. </FS>
  * 5/ Performance on my modest system seems very acceptable. For
  *    example, in testing, I was able to purge a directory of
  *    10,000 files, deleting about half of them in ~ 1700ms. For
@@ -63,6 +70,17 @@
 #define _LLDISKCACHE
 
 #include "llsingleton.h"
+// <FS> Packed asset disk cache
+#include "llfile.h"
+#include "llmutex.h"
+#include "lluuid.h"
+#include <boost/unordered_map.hpp>
+#include <memory>
+#include <set>
+// </FS>
+
+class FSPackedDiskCache; // <FS> Packed asset disk cache
+class FSRecordJournal; // <FS> Incremental LRU bookkeeping
 
 class LLDiskCache :
     public LLParamSingleton<LLDiskCache>
@@ -94,9 +112,22 @@ class LLDiskCache :
                      * if there are bugs, we can ask uses to enable this
                      * setting and send us their logs
                      */
-                    const bool enable_cache_debug_info);
+                    const bool enable_cache_debug_info,
+                    // <FS> Packed asset disk cache
+                    /**
+                     * Store the assets in a few large pack files instead
+                     * of one file per asset. Defined by the setting at
+                     * 'FSDiskCachePackFiles'
+                     */
+                    const bool use_pack_files,
+                    /**
+                     * Another viewer instance owns this cache. Its index
+                     * journal is only read, never written.
+                     */
+                    const bool read_only);
+                    // </FS>
 
-        virtual ~LLDiskCache() = default;
+        virtual ~LLDiskCache();
 
     public:
         /**
@@ -125,12 +156,55 @@ class LLDiskCache :
         void updateFileAccessTime(const std::string& file_path);
         // </FS:Ansariel>
 
+        // <FS> Incremental LRU bookkeeping
+        /**
+         * Record reads, writes, removals and renames of cache files in the
+         * in-memory access index. Reads are the hot path and only update the
+         * index, nothing is written to the file system until the next journal
+         * flush. Only used for the one-file-per-asset cache.
+         */
+        void recordFileAccess(const LLUUID& id);
+        void recordFileWrite(const LLUUID& id, uintmax_t size, bool grow_only);
+        void recordFileRemove(const LLUUID& id);
+        void recordFileRename(const LLUUID& old_id, const LLUUID& new_id);
+
+        /**
+         * After an unclean shutdown the access journal may be missing the
+         * last records. The index then starts out with what the journal has
+         * and is reconciled with the cache directory one subdirectory per
+         * call, off the main thread. Returns true while there are
+         * subdirectories left.
+         */
+        bool rescanSlice();
+        // </FS>
+
         /**
          * Purge the oldest items in the cache so that the combined size of all files
          * is no bigger than mMaxSizeBytes.
          */
         void purge();
 
+        // <FS> Background, rate-limited purge
+        /**
+         * Returns true if the cache grew beyond mMaxSizeBytes (the high water
+         * mark). Cheap, the cache keeps a running total of its size.
+         */
+        bool needsPurge();
+
+        /**
+         * Do a bounded amount of purge work, evicting the oldest items until
+         * the cache is below the low water mark. Stops after max_seconds or
+         * max_io_ops file operations, a limit of 0 means no limit. Returns
+         * true if there is work left to do.
+         */
+        bool purgeSlice(F64 max_seconds, U32 max_io_ops);
+
+        /**
+         * Running total of the bytes stored in the cache
+         */
+        uintmax_t getTotalBytes();
+        // </FS>
+
         // <FS:Beq>
         // copy from distribution into cache to replace static content
         void prepopulateCacheWithStatic();
@@ -149,7 +223,29 @@ class LLDiskCache :
         const std::string getCacheInfo();
 
         // <FS:Ansariel> Better asset cache size control
-        void setMaxSizeBytes(uintmax_t size) { mMaxSizeBytes = size; }
+        // <FS> Packed asset disk cache
+        //void setMaxSizeBytes(uintmax_t size) { mMaxSizeBytes = size; }
+        void setMaxSizeBytes(uintmax_t size);
+
+        /**
+         * The pack file backend if 'FSDiskCachePackFiles' is enabled,
+         * nullptr if every asset is stored in its own file.
+         */
+        FSPackedDiskCache* getPackedCache() const { return mPackedCache.get(); }
+
+        /**
+         * Moves the file of the one-file-per-asset cache for the asset into
+         * the pack file backend, if there is one. Returns true if the asset
+         * was found and is in the pack cache now.
+         */
+        bool migrateLooseFile(const LLUUID& asset_id, LLAssetType::EType asset_type);
+
+        /**
+         * Write pending index updates of the pack file backend or the
+         * access journal to disk. Called regularly from FSPurgeDiskCacheThread.
+         */
+        void flushJournal();
+        // </FS>
 
     private:
         /**
@@ -165,6 +261,72 @@ class LLDiskCache :
          */
         const std::string assetTypeToString(LLAssetType::EType at);
 
+        // <FS> Packed asset disk cache
+        /**
+         * Remove the files of the one-file-per-asset cache that were not
+         * migrated to the pack file backend when the cache is cleared.
+         */
+        void removeLooseFiles();
+
+        /**
+         * Import a file, e.g. a static asset, into the pack file backend
+         */
+        bool copyFileToPackedCache(const std::string& filename, const LLUUID& asset_id);
+        // </FS>
+
+        // <FS> Incremental LRU bookkeeping
+        enum EAccessOp
+        {
+            ACCESS_WRITE = 1,
+            ACCESS_READ = 2,
+            ACCESS_REMOVE = 3
+        };
+
+        // Fixed size record of the on-disk access journal
+        struct AccessRecord
+        {
+            U32 mOp;
+            U32 mAccessTime;
+            U64 mSize;
+            U8  mID[UUID_BYTES];
+        };
+
+        struct FileInfo
+        {
+            U32         mAccessTime;
+            uintmax_t   mSize;
+        };
+        typedef boost::unordered_map<LLUUID, FileInfo, FSUUIDHash> file_index_t;
+
+        /**
+         * Load the access index from the journal. Returns false if the journal
+         * is missing or unreadable.
+         */
+        bool loadAccessJournal();
+
+        // <FS> Background, rate-limited purge
+        struct PurgeCandidate
+        {
+            U32         mAccessTime;
+            uintmax_t   mSize;
+            LLUUID      mID;
+        };
+
+        uintmax_t getLowWaterBytes() const;
+
+        /**
+         * Snapshot the access index sorted by age for the following
+         * purge slices. Expects mPurgeMutex to be held.
+         */
+        void startPurge(uintmax_t target_bytes);
+        // </FS>
+
+        // The following expect mIndexMutex to be held
+        bool writeAccessJournalSnapshot();
+        void queueAccessRecord(EAccessOp op, const LLUUID& id, const FileInfo* info);
+        void flushAccessJournal();
+        // </FS>
+
     private:
         /**
          * The maximum size of the cache in bytes. After purge is called, the
@@ -198,6 +360,28 @@ class LLDiskCache :
         bool mEnableCacheDebugInfo;
         
         std::vector<std::string> mSkipList;  // <FS:Beq/> Vector of "static" untouchable assets that should never be purged
+
+        // <FS> Packed asset disk cache
+        std::set<LLUUID> mSkipIDs; // mSkipList as UUIDs
+        std::unique_ptr<FSPackedDiskCache> mPackedCache;
+        // </FS>
+
+        // <FS> Incremental LRU bookkeeping
+        LLMutex                     mIndexMutex;
+        file_index_t                mFileIndex;
+        std::unique_ptr<FSRecordJournal> mAccessJournal; // nullptr with the pack file backend
+        std::string                 mAccessDirtyFilename;
+        bool                        mReadOnly;
+        S32                         mRescanSubdir; // Next subdirectory for rescanSlice(), 16 when done
+        // </FS>
+
+        // <FS> Background, rate-limited purge
+        uintmax_t                   mTotalBytes; // Running total of mFileIndex sizes, guarded by mIndexMutex
+        LLMutex                     mPurgeMutex;
+        std::vector<PurgeCandidate> mPurgeCandidates;
+        size_t                      mPurgeCandidatePos;
+        uintmax_t                   mPurgeTargetBytes;
+        // </FS>
 };
 
 // <FS:Ansariel> Regular disk cache cleanup
@@ -211,6 +395,8 @@ protected:
 
 private:
     LLTimer mTimer;
+    LLTimer mFlushTimer; // <FS> Packed asset disk cache
+    bool mPurging; // <FS> Background, rate-limited purge
 };
 // </FS:Ansariel>
 #endif // _LLDISKCACHE
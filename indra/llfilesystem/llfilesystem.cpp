@@ -33,6 +33,7 @@
 #include "llfilesystem.h"
 #include "llfasttimer.h"
 #include "lldiskcache.h"
+#include "fspackeddiskcache.h" // <FS> Packed asset disk cache
 
 const S32 LLFileSystem::READ        = 0x00000001;
 const S32 LLFileSystem::WRITE       = 0x00000002;
@@ -58,6 +59,12 @@ LLFileSystem::~LLFileSystem()
 bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     FSZoneC(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS> Packed asset disk cache
+    if (FSPackedDiskCache* packed_cache = LLDiskCache::getInstance()->getPackedCache())
+    {
+        return packed_cache->exists(file_id) || LLDiskCache::getInstance()->migrateLooseFile(file_id, file_type);
+    }
+    // </FS>
     std::string id_str;
     file_id.toString(id_str);
     const std::string extra_info = "";
@@ -84,12 +91,20 @@ bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType fil
 bool LLFileSystem::removeFile(const LLUUID& file_id, const LLAssetType::EType file_type, int suppress_error /*= 0*/)
 {
     FSZoneC(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS> Packed asset disk cache
+    if (FSPackedDiskCache* packed_cache = LLDiskCache::getInstance()->getPackedCache())
+    {
+        packed_cache->remove(file_id);
+        return true;
+    }
+    // </FS>
     std::string id_str;
     file_id.toString(id_str);
     const std::string extra_info = "";
     const std::string filename =  LLDiskCache::getInstance()->metaDataToFilepath(id_str, file_type, extra_info);
 
     LLFile::remove(filename.c_str(), suppress_error);
+    LLDiskCache::getInstance()->recordFileRemove(file_id); // <FS> Incremental LRU bookkeeping
 
     return true;
 }
@@ -99,6 +114,17 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
                               const LLUUID& new_file_id, const LLAssetType::EType new_file_type)
 {
     FSZoneC(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS> Packed asset disk cache
+    if (FSPackedDiskCache* packed_cache = LLDiskCache::getInstance()->getPackedCache())
+    {
+        if (!packed_cache->rename(old_file_id, new_file_id))
+        {
+            LL_WARNS() << "Failed to rename " << old_file_id << " to " << new_file_id << " in pack cache" << LL_ENDL;
+            return false;
+        }
+        return true;
+    }
+    // </FS>
     std::string old_id_str;
     old_file_id.toString(old_id_str);
     const std::string extra_info = "";
@@ -119,6 +145,12 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
         //return FALSE;
         LL_WARNS() << "Failed to rename " << old_file_id << " to " << new_id_str << " reason: "  << strerror(errno) << LL_ENDL;
     }
+    // <FS> Incremental LRU bookkeeping
+    else
+    {
+        LLDiskCache::getInstance()->recordFileRename(old_file_id, new_file_id);
+    }
+    // </FS>
 
     return TRUE;
 }
@@ -127,6 +159,17 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
 S32 LLFileSystem::getFileSize(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     FSZoneC(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS> Packed asset disk cache
+    if (FSPackedDiskCache* packed_cache = LLDiskCache::getInstance()->getPackedCache())
+    {
+        S32 file_size = packed_cache->getSize(file_id);
+        if (!file_size && LLDiskCache::getInstance()->migrateLooseFile(file_id, file_type))
+        {
+            file_size = packed_cache->getSize(file_id);
+        }
+        return file_size;
+    }
+    // </FS>
     std::string id_str;
     file_id.toString(id_str);
     const std::string extra_info = "";
@@ -157,6 +200,19 @@ BOOL LLFileSystem::read(U8* buffer, S32 bytes)
     //BOOL success = TRUE;
     BOOL success = FALSE;
 
+    // <FS> Packed asset disk cache
+    if (FSPackedDiskCache* packed_cache = LLDiskCache::getInstance()->getPackedCache())
+    {
+        mBytesRead = packed_cache->read(mFileID, mPosition, buffer, bytes);
+        if (!mBytesRead && !mPosition && LLDiskCache::getInstance()->migrateLooseFile(mFileID, mFileType))
+        {
+            mBytesRead = packed_cache->read(mFileID, mPosition, buffer, bytes);
+        }
+        mPosition += mBytesRead;
+        return mBytesRead > 0;
+    }
+    // </FS>
+
     std::string id;
     mFileID.toString(id);
     const std::string extra_info = "";
@@ -210,7 +266,14 @@ BOOL LLFileSystem::read(U8* buffer, S32 bytes)
     // even though we are reading and not writing because this is the
     // way the cache works - it relies on a valid "last accessed time" for
     // each file so it knows how to remove the oldest, unused files
-    LLDiskCache::getInstance()->updateFileAccessTime(filename);
+    // <FS> Incremental LRU bookkeeping
+    // Only update the in-memory access index instead of touching the file
+    //LLDiskCache::getInstance()->updateFileAccessTime(filename);
+    if (success)
+    {
+        LLDiskCache::getInstance()->recordFileAccess(mFileID);
+    }
+    // </FS>
 
     return success;
 }
@@ -230,6 +293,27 @@ BOOL LLFileSystem::eof()
 BOOL LLFileSystem::write(const U8* buffer, S32 bytes)
 {
     FSZoneC(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    // <FS> Packed asset disk cache
+    if (FSPackedDiskCache* packed_cache = LLDiskCache::getInstance()->getPackedCache())
+    {
+        // Same semantics as the file based code below: APPEND adds to the end,
+        // READ_WRITE writes at the current position and WRITE replaces the content
+        bool success = false;
+        if (mMode == APPEND)
+        {
+            success = packed_cache->write(mFileID, -1, buffer, bytes, false, mPosition);
+        }
+        else if (mMode == READ_WRITE && packed_cache->exists(mFileID))
+        {
+            success = packed_cache->write(mFileID, mPosition, buffer, bytes, false, mPosition);
+        }
+        else
+        {
+            success = packed_cache->write(mFileID, 0, buffer, bytes, true, mPosition);
+        }
+        return success;
+    }
+    // </FS>
     std::string id_str;
     mFileID.toString(id_str);
     const std::string extra_info = "";
@@ -336,6 +420,14 @@ BOOL LLFileSystem::write(const U8* buffer, S32 bytes)
     }
     // </FS:Ansariel>
 
+    // <FS> Incremental LRU bookkeeping
+    if (success)
+    {
+        // Only WRITE truncates the file, the other modes can only make it grow
+        LLDiskCache::getInstance()->recordFileWrite(mFileID, mPosition, mMode != WRITE);
+    }
+    // </FS>
+
     return success;
 }
 
@@ -0,0 +1,334 @@
+/**
+ * @file fspackeddiskcache_test.cpp
+ * @brief FSPackedDiskCache test cases.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltut.h"
+#include "../fspackeddiskcache.h"
+#include "../lldir.h"
+
+#include <memory>
+
+namespace
+{
+    const uintmax_t CACHE_BYTES = 128 * 1024 * 1024;
+
+    std::vector<U8> makeData(size_t size, U8 seed)
+    {
+        std::vector<U8> data(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            data[i] = (U8)(seed + i * 7 + (i >> 8));
+        }
+        return data;
+    }
+
+    std::string toString(const std::vector<U8>& data)
+    {
+        return std::string(data.begin(), data.end());
+    }
+}
+
+namespace tut
+{
+    struct FSPackedDiskCacheFixture
+    {
+        std::string mPackDir;
+
+        FSPackedDiskCacheFixture()
+        {
+            const std::string base = std::string(LLFile::tmpdir()) + "fspackeddiskcache";
+            for (S32 counter = 0; ; ++counter)
+            {
+                mPackDir = base + llformat("%02d", counter);
+                if (!LLFile::isdir(mPackDir) && !LLFile::isfile(mPackDir))
+                {
+                    break;
+                }
+            }
+        }
+
+        ~FSPackedDiskCacheFixture()
+        {
+            if (!LLFile::isdir(mPackDir))
+            {
+                return;
+            }
+            std::vector<std::string> files = gDirUtilp->getFilesInDir(mPackDir);
+            for (const std::string& file : files)
+            {
+                LLFile::remove(mPackDir + gDirUtilp->getDirDelimiter() + file, ENOENT);
+            }
+            LLFile::rmdir(mPackDir);
+        }
+
+        std::unique_ptr<FSPackedDiskCache> openCache()
+        {
+            std::unique_ptr<FSPackedDiskCache> cache(new FSPackedDiskCache(mPackDir, CACHE_BYTES, false));
+            cache->open();
+            return cache;
+        }
+
+        bool put(FSPackedDiskCache& cache, const LLUUID& id, const std::vector<U8>& data)
+        {
+            S32 position = 0;
+            return cache.write(id, 0, data.empty() ? NULL : &data[0], (S32)data.size(), true, position) &&
+                   position == (S32)data.size();
+        }
+
+        std::vector<U8> get(FSPackedDiskCache& cache, const LLUUID& id)
+        {
+            std::vector<U8> data(cache.getSize(id));
+            if (!data.empty())
+            {
+                data.resize(cache.read(id, 0, &data[0], (S32)data.size()));
+            }
+            return data;
+        }
+
+        std::string getJournalFilename() const
+        {
+            return mPackDir + gDirUtilp->getDirDelimiter() + "sl_cache_pack.journal";
+        }
+    };
+    typedef test_group<FSPackedDiskCacheFixture> FSPackedDiskCacheTest_factory;
+    typedef FSPackedDiskCacheTest_factory::object FSPackedDiskCacheTest_t;
+    FSPackedDiskCacheTest_factory tf("FSPackedDiskCache");
+
+    // Write, append, overwrite and read round trips
+    template<> template<>
+    void FSPackedDiskCacheTest_t::test<1>()
+    {
+        std::unique_ptr<FSPackedDiskCache> cache = openCache();
+        LLUUID id;
+        id.generate();
+
+        const std::string hello = "hello";
+        S32 position = 0;
+        ensure("write", cache->write(id, 0, (const U8*)hello.data(), (S32)hello.size(), true, position));
+        ensure_equals("write position", position, 5);
+
+        const std::string world = " world";
+        ensure("append", cache->write(id, -1, (const U8*)world.data(), (S32)world.size(), false, position));
+        ensure_equals("append position", position, 11);
+        ensure_equals("appended", toString(get(*cache, id)), "hello world");
+
+        const std::string upper = "HELLO";
+        ensure("overwrite", cache->write(id, 0, (const U8*)upper.data(), (S32)upper.size(), false, position));
+        ensure_equals("overwrite position", position, 5);
+        ensure_equals("overwritten", toString(get(*cache, id)), "HELLO world");
+
+        const std::string tail = "d!!";
+        ensure("overlapping write", cache->write(id, 10, (const U8*)tail.data(), (S32)tail.size(), false, position));
+        ensure_equals("overlapped", toString(get(*cache, id)), "HELLO world!!");
+
+        ensure("write past the end", !cache->write(id, 20, (const U8*)tail.data(), (S32)tail.size(), false, position));
+
+        U8 buffer[4];
+        ensure_equals("partial read", cache->read(id, 6, buffer, 4), 4);
+        ensure_equals("partial data", std::string((const char*)buffer, 4), "worl");
+        ensure_equals("read past the end", cache->read(id, 13, buffer, 4), 0);
+        ensure_equals("short read", cache->read(id, 11, buffer, 4), 2);
+
+        // Growing past the extent capacity, and truncating to less
+        std::vector<U8> big = makeData(100000, 3);
+        ensure("grow", put(*cache, id, big));
+        ensure("grown", get(*cache, id) == big);
+        ensure("truncate", put(*cache, id, std::vector<U8>(big.begin(), big.begin() + 100)));
+        ensure_equals("truncated size", cache->getSize(id), 100);
+        ensure("truncated", get(*cache, id) == std::vector<U8>(big.begin(), big.begin() + 100));
+
+        ensure("remove", cache->remove(id));
+        ensure("removed", !cache->exists(id));
+        ensure("remove twice", !cache->remove(id));
+    }
+
+    // Rename, onto itself and over an existing asset
+    template<> template<>
+    void FSPackedDiskCacheTest_t::test<2>()
+    {
+        std::unique_ptr<FSPackedDiskCache> cache = openCache();
+        LLUUID a, b, c;
+        a.generate();
+        b.generate();
+        c.generate();
+        const std::vector<U8> data_a = makeData(1000, 1);
+        const std::vector<U8> data_c = makeData(3000, 2);
+        ensure("put a", put(*cache, a, data_a));
+        ensure("put c", put(*cache, c, data_c));
+
+        ensure("rename onto itself", cache->rename(a, a));
+        ensure("still there", get(*cache, a) == data_a);
+
+        ensure("rename", cache->rename(a, b));
+        ensure("old id gone", !cache->exists(a));
+        ensure("new id", get(*cache, b) == data_a);
+
+        ensure("rename over existing", cache->rename(b, c));
+        ensure("replaced", get(*cache, c) == data_a);
+        ensure_equals("entries", cache->getEntryCount(), (size_t)1);
+        ensure_equals("live bytes", cache->getLiveBytes(), (uintmax_t)1024);
+
+        ensure("rename missing", !cache->rename(a, b));
+    }
+
+    // Reopening replays the journal
+    template<> template<>
+    void FSPackedDiskCacheTest_t::test<3>()
+    {
+        std::vector<LLUUID> ids(20);
+        {
+            std::unique_ptr<FSPackedDiskCache> cache = openCache();
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                ids[i].generate();
+                ensure("put", put(*cache, ids[i], makeData(500 + i * 100, (U8)i)));
+            }
+            ensure("remove", cache->remove(ids[3]));
+            const std::vector<U8> rewritten = makeData(50, 99);
+            ensure("rewrite", put(*cache, ids[5], rewritten));
+            ensure("rename", cache->rename(ids[7], ids[3]));
+        }
+
+        FSPackedDiskCache cache(mPackDir, CACHE_BYTES, false);
+        ensure("journal found", cache.open());
+        ensure_equals("entries", cache.getEntryCount(), ids.size() - 1);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            if (i == 7)
+            {
+                ensure("renamed away", !cache.exists(ids[i]));
+            }
+            else if (i == 3)
+            {
+                ensure("renamed", get(cache, ids[i]) == makeData(500 + 7 * 100, 7));
+            }
+            else if (i == 5)
+            {
+                ensure("rewritten", get(cache, ids[i]) == makeData(50, 99));
+            }
+            else
+            {
+                ensure("replayed", get(cache, ids[i]) == makeData(500 + i * 100, (U8)i));
+            }
+        }
+    }
+
+    // A torn record at the end of the journal loses only that record
+    template<> template<>
+    void FSPackedDiskCacheTest_t::test<4>()
+    {
+        LLUUID a, b, c;
+        a.generate();
+        b.generate();
+        c.generate();
+        {
+            std::unique_ptr<FSPackedDiskCache> cache = openCache();
+            ensure("put a", put(*cache, a, makeData(2000, 1)));
+            ensure("put b", put(*cache, b, makeData(2000, 2)));
+            cache->flushJournal();
+            ensure("put c", put(*cache, c, makeData(2000, 3)));
+        }
+
+        // Cut the journal in the middle of the last record
+        std::vector<char> journal;
+        {
+            llifstream in(getJournalFilename().c_str(), std::ios::binary);
+            journal.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        ensure("journal written", journal.size() > 16);
+        {
+            llofstream out(getJournalFilename().c_str(), std::ios::binary | std::ios::trunc);
+            out.write(&journal[0], journal.size() - 16);
+        }
+
+        FSPackedDiskCache cache(mPackDir, CACHE_BYTES, false);
+        ensure("journal found", cache.open());
+        ensure("a replayed", get(cache, a) == makeData(2000, 1));
+        ensure("b replayed", get(cache, b) == makeData(2000, 2));
+        ensure("torn c dropped", !cache.exists(c));
+
+        // The journal is usable after the torn record
+        ensure("put c again", put(cache, c, makeData(2000, 4)));
+        cache.flushJournal();
+        FSPackedDiskCache reopened(mPackDir, CACHE_BYTES, false);
+        reopened.open();
+        ensure("c replayed", get(reopened, c) == makeData(2000, 4));
+    }
+
+    // Compaction moves live data out of a sparse segment, eviction follows the LRU order
+    template<> template<>
+    void FSPackedDiskCacheTest_t::test<5>()
+    {
+        std::unique_ptr<FSPackedDiskCache> cache = openCache();
+
+        // Fills most of the first segment, the smallest segments are 64MB
+        LLUUID big;
+        big.generate();
+        ensure("put big", put(*cache, big, makeData(40 * 1024 * 1024, 5)));
+
+        std::vector<LLUUID> small(4);
+        for (size_t i = 0; i < small.size(); ++i)
+        {
+            small[i].generate();
+            ensure("put small", put(*cache, small[i], makeData(1000, (U8)(10 + i))));
+        }
+
+        // Does not fit, starts the second segment
+        LLUUID other;
+        other.generate();
+        ensure("put other", put(*cache, other, makeData(30 * 1024 * 1024, 6)));
+
+        // Most recently used first: small[0], other, small[3], small[2], small[1]
+        U8 byte;
+        ensure_equals("touch other", cache->read(other, 0, &byte, 1), 1);
+        ensure_equals("touch small", cache->read(small[0], 0, &byte, 1), 1);
+
+        // The first segment is now almost all dead space
+        ensure("remove big", cache->remove(big));
+        const uintmax_t disk_before = cache->getDiskBytes();
+        ensure("needs compaction", cache->needsPurge(CACHE_BYTES));
+        cache->purge(CACHE_BYTES, std::set<LLUUID>());
+        ensure("segment compacted", cache->getDiskBytes() < disk_before - 39 * 1024 * 1024);
+        ensure("no more work", !cache->needsPurge(CACHE_BYTES));
+
+        // Moving the data kept the access order
+        std::set<LLUUID> skip;
+        skip.insert(small[3]);
+        cache->purge(cache->getLiveBytes() - 2 * 1024, skip);
+        ensure("oldest evicted", !cache->exists(small[1]));
+        ensure("next oldest evicted", !cache->exists(small[2]));
+        ensure("skipped kept", cache->exists(small[3]));
+        ensure("other kept", cache->exists(other));
+        ensure_equals("entries", cache->getEntryCount(), (size_t)3);
+        ensure("moved intact", get(*cache, small[0]) == makeData(1000, 10));
+        ensure("skipped intact", get(*cache, small[3]) == makeData(1000, 13));
+
+        cache->clear();
+        ensure_equals("cleared", cache->getEntryCount(), (size_t)0);
+        ensure_equals("no segments", cache->getDiskBytes(), (uintmax_t)0);
+    }
+}
@@ -0,0 +1,234 @@
+/**
+ * @file fsstripeduuidindex_test.cpp
+ * @brief FSStripedUUIDIndex test cases and read scaling benchmark.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltut.h"
+#include "../fsstripeduuidindex.h"
+
+#include "lltimer.h"
+
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+
+namespace tut
+{
+    struct FSStripedUUIDIndexFixture
+    {
+        FSStripedUUIDIndexFixture()
+        {
+        }
+
+        static std::vector<LLUUID> makeIDs(size_t count)
+        {
+            std::vector<LLUUID> ids(count);
+            for (LLUUID& id : ids)
+            {
+                id.generate();
+            }
+            return ids;
+        }
+    };
+    typedef test_group<FSStripedUUIDIndexFixture> FSStripedUUIDIndexTest_factory;
+    typedef FSStripedUUIDIndexTest_factory::object FSStripedUUIDIndexTest_t;
+    FSStripedUUIDIndexTest_factory tf("FSStripedUUIDIndex");
+
+    // Insert, replace, find and erase against a std::map reference
+    template<> template<>
+    void FSStripedUUIDIndexTest_t::test<1>()
+    {
+        FSStripedUUIDIndex index;
+        std::map<LLUUID, S32> reference;
+        std::vector<LLUUID> ids = makeIDs(20000);
+
+        ensure_equals("empty index", index.find(ids[0]), -1);
+        ensure("erase from empty index", !index.erase(ids[0]));
+
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            index.insert(ids[i], (S32)i);
+            reference[ids[i]] = (S32)i;
+        }
+        // Replace every third value, erase every fifth id
+        for (size_t i = 0; i < ids.size(); i += 3)
+        {
+            index.insert(ids[i], (S32)(i + 1000000));
+            reference[ids[i]] = (S32)(i + 1000000);
+        }
+        for (size_t i = 0; i < ids.size(); i += 5)
+        {
+            ensure("erase existing id", index.erase(ids[i]));
+            reference.erase(ids[i]);
+        }
+
+        ensure_equals("size", index.size(), reference.size());
+        for (const LLUUID& id : ids)
+        {
+            std::map<LLUUID, S32>::const_iterator iter = reference.find(id);
+            S32 expected = iter != reference.end() ? iter->second : -1;
+            ensure_equals("find after erase", index.find(id), expected);
+        }
+
+        index.clear();
+        ensure_equals("size after clear", index.size(), (size_t)0);
+        ensure_equals("find after clear", index.find(ids[1]), -1);
+    }
+
+    // Ids sharing a probe sequence stay reachable when one of them is erased
+    template<> template<>
+    void FSStripedUUIDIndexTest_t::test<2>()
+    {
+        FSStripedUUIDIndex index;
+        std::vector<LLUUID> ids = makeIDs(2000);
+        for (int round = 0; round < 4; ++round)
+        {
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                index.insert(ids[i], (S32)i);
+            }
+            for (size_t i = round; i < ids.size(); i += 4)
+            {
+                index.erase(ids[i]);
+            }
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                S32 expected = (i % 4 == (size_t)round) ? -1 : (S32)i;
+                ensure_equals("find after interleaved erase", index.find(ids[i]), expected);
+            }
+        }
+    }
+
+    // Concurrent writers on disjoint ids
+    template<> template<>
+    void FSStripedUUIDIndexTest_t::test<3>()
+    {
+        const U32 THREADS = 8;
+        const U32 IDS_PER_THREAD = 5000;
+        FSStripedUUIDIndex index;
+        std::vector<LLUUID> ids = makeIDs(THREADS * IDS_PER_THREAD);
+
+        std::vector<std::thread> threads;
+        for (U32 t = 0; t < THREADS; ++t)
+        {
+            threads.emplace_back([&index, &ids, t, IDS_PER_THREAD]()
+            {
+                for (U32 i = t * IDS_PER_THREAD; i < (t + 1) * IDS_PER_THREAD; ++i)
+                {
+                    index.insert(ids[i], (S32)i);
+                }
+                for (U32 i = t * IDS_PER_THREAD; i < (t + 1) * IDS_PER_THREAD; i += 2)
+                {
+                    index.erase(ids[i]);
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        ensure_equals("size", index.size(), (size_t)(THREADS * IDS_PER_THREAD / 2));
+        for (U32 i = 0; i < ids.size(); ++i)
+        {
+            ensure_equals("find", index.find(ids[i]), (i & 1) ? (S32)i : -1);
+        }
+    }
+
+    // Benchmark: lookups per second at 1 to 32 reader threads, compared to
+    // a std::map behind a single mutex like the texture cache used before.
+    template<> template<>
+    void FSStripedUUIDIndexTest_t::test<4>()
+    {
+        skip_unless_benchmarks();
+
+        const size_t ENTRIES = 100000;
+        const U32 READS_PER_THREAD = 200000;
+        std::vector<LLUUID> ids = makeIDs(ENTRIES);
+
+        FSStripedUUIDIndex index;
+        std::map<LLUUID, S32> locked_map;
+        LLMutex map_mutex;
+        for (size_t i = 0; i < ENTRIES; ++i)
+        {
+            index.insert(ids[i], (S32)i);
+            locked_map[ids[i]] = (S32)i;
+        }
+
+        std::cout << std::endl << "FSStripedUUIDIndex reads/s (" << ENTRIES << " entries, "
+                  << std::thread::hardware_concurrency() << " cores)" << std::endl;
+        std::cout << std::setw(8) << "threads" << std::setw(16) << "striped" << std::setw(16) << "single mutex" << std::endl;
+
+        for (U32 thread_count = 1; thread_count <= 32; thread_count *= 2)
+        {
+            F64 reads_per_sec[2];
+            for (U32 variant = 0; variant < 2; ++variant)
+            {
+                std::vector<std::thread> threads;
+                std::vector<S32> found(thread_count, 0);
+                LLTimer timer;
+                for (U32 t = 0; t < thread_count; ++t)
+                {
+                    threads.emplace_back([&, t]()
+                    {
+                        size_t pos = (t * 7919) % ENTRIES;
+                        S32 hits = 0;
+                        for (U32 i = 0; i < READS_PER_THREAD; ++i)
+                        {
+                            const LLUUID& id = ids[pos];
+                            if (variant == 0)
+                            {
+                                hits += index.find(id) >= 0;
+                            }
+                            else
+                            {
+                                LLMutexLock lock(&map_mutex);
+                                hits += locked_map.find(id) != locked_map.end();
+                            }
+                            pos = (pos + 104729) % ENTRIES;
+                        }
+                        found[t] = hits;
+                    });
+                }
+                for (std::thread& thread : threads)
+                {
+                    thread.join();
+                }
+                F64 elapsed = llmax((F64)timer.getElapsedTimeF64(), 1e-6);
+                reads_per_sec[variant] = (F64)thread_count * READS_PER_THREAD / elapsed;
+
+                for (U32 t = 0; t < thread_count; ++t)
+                {
+                    ensure_equals("all lookups hit", found[t], (S32)READS_PER_THREAD);
+                }
+            }
+            std::cout << std::setw(8) << thread_count
+                      << std::setw(16) << (U64)reads_per_sec[0]
+                      << std::setw(16) << (U64)reads_per_sec[1] << std::endl;
+        }
+    }
+}
@@ -0,0 +1,570 @@
+/**
+ * @file fsimagekernels.cpp
+ * @brief SIMD pixel loops for LLImage with runtime instruction set dispatch.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsimagekernels.h"
+
+#include "llatomic.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || ((defined(__i386__) || defined(_M_IX86)) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define FS_IMAGE_KERNELS_X86 1
+#endif
+
+#ifdef FS_IMAGE_KERNELS_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC emits any intrinsic without per function opt in
+#define FS_TARGET_AVX2
+#else
+#define FS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    LLAtomicS32 sActiveISA(-1);
+
+    FSImageKernels::EISA detect_isa()
+    {
+#ifdef FS_IMAGE_KERNELS_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7)
+        {
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            // the OS has to save the ymm registers too
+            if (osxsave && avx && (_xgetbv(0) & 6) == 6)
+            {
+                __cpuidex(info, 7, 0);
+                if (info[1] & (1 << 5))
+                {
+                    return FSImageKernels::ISA_AVX2;
+                }
+            }
+        }
+#else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return FSImageKernels::ISA_AVX2;
+        }
+#endif
+        return FSImageKernels::ISA_SSE2;
+#else
+        return FSImageKernels::ISA_SCALAR;
+#endif
+    }
+
+    // generateMip() for output pixels [x, width) of one row
+    void mip_row_scalar(const U8* row0, const U8* row1, U8* out, S32 x, S32 width, S32 nchannels)
+    {
+        for (; x < width; ++x)
+        {
+            const S32 in = x * 2 * nchannels;
+            for (S32 c = 0; c < nchannels; ++c)
+            {
+                out[x * nchannels + c] = (U8)(((U32)row0[in + c] + row0[in + nchannels + c] + row1[in + c] + row1[in + nchannels + c]) >> 2);
+            }
+        }
+    }
+
+#ifdef FS_IMAGE_KERNELS_X86
+    // Row kernels return how many output pixels they wrote; the rest goes
+    // through mip_row_scalar(). None of them reads past the input pixels it uses.
+    typedef S32 (*mip_row_t)(const U8* row0, const U8* row1, U8* out, S32 width);
+
+    // Sum of both rows as 16 bit lanes
+    inline void sum_rows(__m128i a, __m128i b, __m128i& lo, __m128i& hi)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+    }
+
+    // 8 input pixels per row to 4 output pixels
+    S32 mip_row4_sse2(const U8* row0, const U8* row1, U8* out, S32 width)
+    {
+        S32 x = 0;
+        for (; x + 4 <= width; x += 4, row0 += 32, row1 += 32, out += 16)
+        {
+            __m128i q[2];
+            for (S32 half = 0; half < 2; ++half)
+            {
+                __m128i lo, hi;
+                sum_rows(_mm_loadu_si128((const __m128i*)(row0 + half * 16)), _mm_loadu_si128((const __m128i*)(row1 + half * 16)), lo, hi);
+                q[half] = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi)), 2);
+            }
+            _mm_storeu_si128((__m128i*)out, _mm_packus_epi16(q[0], q[1]));
+        }
+        return x;
+    }
+
+    // 16 input pixels per row to 8 output pixels
+    S32 mip_row2_sse2(const U8* row0, const U8* row1, U8* out, S32 width)
+    {
+        S32 x = 0;
+        for (; x + 8 <= width; x += 8, row0 += 32, row1 += 32, out += 16)
+        {
+            __m128i q[2];
+            for (S32 half = 0; half < 2; ++half)
+            {
+                __m128i lo, hi;
+                sum_rows(_mm_loadu_si128((const __m128i*)(row0 + half * 16)), _mm_loadu_si128((const __m128i*)(row1 + half * 16)), lo, hi);
+                // a pixel is one 32 bit lane, add even lanes to odd ones
+                const __m128 flo = _mm_castsi128_ps(lo);
+                const __m128 fhi = _mm_castsi128_ps(hi);
+                const __m128i even = _mm_castps_si128(_mm_shuffle_ps(flo, fhi, _MM_SHUFFLE(2, 0, 2, 0)));
+                const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(flo, fhi, _MM_SHUFFLE(3, 1, 3, 1)));
+                q[half] = _mm_srli_epi16(_mm_add_epi16(even, odd), 2);
+            }
+            _mm_storeu_si128((__m128i*)out, _mm_packus_epi16(q[0], q[1]));
+        }
+        return x;
+    }
+
+    // 16 input pixels per row to 8 output pixels
+    S32 mip_row1_sse2(const U8* row0, const U8* row1, U8* out, S32 width)
+    {
+        const __m128i ones = _mm_set1_epi16(1);
+        S32 x = 0;
+        for (; x + 8 <= width; x += 8, row0 += 16, row1 += 16, out += 8)
+        {
+            __m128i lo, hi;
+            sum_rows(_mm_loadu_si128((const __m128i*)row0), _mm_loadu_si128((const __m128i*)row1), lo, hi);
+            __m128i q = _mm_packs_epi32(_mm_madd_epi16(lo, ones), _mm_madd_epi16(hi, ones));
+            q = _mm_srli_epi16(q, 2);
+            _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(q, q));
+        }
+        return x;
+    }
+
+    FS_TARGET_AVX2 inline void sum_rows_avx2(__m256i a, __m256i b, __m256i& lo, __m256i& hi)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+        hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+    }
+
+    // The 256 bit unpacks and packs work per 128 bit lane, so each kernel
+    // puts its 64 bit output groups back in order with one permute.
+
+    // 16 input pixels per row to 8 output pixels
+    FS_TARGET_AVX2 S32 mip_row4_avx2(const U8* row0, const U8* row1, U8* out, S32 width)
+    {
+        S32 x = 0;
+        for (; x + 8 <= width; x += 8, row0 += 64, row1 += 64, out += 32)
+        {
+            __m256i q[2];
+            for (S32 half = 0; half < 2; ++half)
+            {
+                __m256i lo, hi;
+                sum_rows_avx2(_mm256_loadu_si256((const __m256i*)(row0 + half * 32)), _mm256_loadu_si256((const __m256i*)(row1 + half * 32)), lo, hi);
+                q[half] = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_unpackhi_epi64(lo, hi)), 2);
+            }
+            _mm256_storeu_si256((__m256i*)out, _mm256_permute4x64_epi64(_mm256_packus_epi16(q[0], q[1]), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+        return x;
+    }
+
+    // 8 input pixels per row to 4 output pixels, gathering even and odd
+    // pixels with byte shuffles
+    FS_TARGET_AVX2 S32 mip_row3_avx2(const U8* row0, const U8* row1, U8* out, S32 width)
+    {
+        // a covers bytes 0-15 of the 24, b bytes 8-23
+        const __m128i even_a = _mm_setr_epi8(0, 1, 2, 6, 7, 8, 12, 13, 14, -1, -1, -1, -1, -1, -1, -1);
+        const __m128i even_b = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, 10, 11, 12, -1, -1, -1, -1);
+        const __m128i odd_a = _mm_setr_epi8(3, 4, 5, 9, 10, 11, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m128i odd_b = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, 8, 9, 13, 14, 15, -1, -1, -1, -1);
+        const __m128i zero = _mm_setzero_si128();
+        S32 x = 0;
+        for (; x + 4 <= width; x += 4, row0 += 24, row1 += 24, out += 12)
+        {
+            __m128i lo = zero;
+            __m128i hi = zero;
+            const U8* rows[2] = { row0, row1 };
+            for (S32 r = 0; r < 2; ++r)
+            {
+                const __m128i a = _mm_loadu_si128((const __m128i*)rows[r]);
+                const __m128i b = _mm_loadu_si128((const __m128i*)(rows[r] + 8));
+                const __m128i even = _mm_or_si128(_mm_shuffle_epi8(a, even_a), _mm_shuffle_epi8(b, even_b));
+                const __m128i odd = _mm_or_si128(_mm_shuffle_epi8(a, odd_a), _mm_shuffle_epi8(b, odd_b));
+                lo = _mm_add_epi16(lo, _mm_add_epi16(_mm_unpacklo_epi8(even, zero), _mm_unpacklo_epi8(odd, zero)));
+                hi = _mm_add_epi16(hi, _mm_add_epi16(_mm_unpackhi_epi8(even, zero), _mm_unpackhi_epi8(odd, zero)));
+            }
+            const __m128i q = _mm_packus_epi16(_mm_srli_epi16(lo, 2), _mm_srli_epi16(hi, 2));
+            _mm_storel_epi64((__m128i*)out, q);
+            const S32 tail = _mm_cvtsi128_si32(_mm_srli_si128(q, 8));
+            memcpy(out + 8, &tail, 4);
+        }
+        return x;
+    }
+
+    // 32 input pixels per row to 16 output pixels
+    FS_TARGET_AVX2 S32 mip_row2_avx2(const U8* row0, const U8* row1, U8* out, S32 width)
+    {
+        S32 x = 0;
+        for (; x + 16 <= width; x += 16, row0 += 64, row1 += 64, out += 32)
+        {
+            __m256i q[2];
+            for (S32 half = 0; half < 2; ++half)
+            {
+                __m256i lo, hi;
+                sum_rows_avx2(_mm256_loadu_si256((const __m256i*)(row0 + half * 32)), _mm256_loadu_si256((const __m256i*)(row1 + half * 32)), lo, hi);
+                const __m256 flo = _mm256_castsi256_ps(lo);
+                const __m256 fhi = _mm256_castsi256_ps(hi);
+                const __m256i even = _mm256_castps_si256(_mm256_shuffle_ps(flo, fhi, _MM_SHUFFLE(2, 0, 2, 0)));
+                const __m256i odd = _mm256_castps_si256(_mm256_shuffle_ps(flo, fhi, _MM_SHUFFLE(3, 1, 3, 1)));
+                q[half] = _mm256_srli_epi16(_mm256_add_epi16(even, odd), 2);
+            }
+            _mm256_storeu_si256((__m256i*)out, _mm256_permute4x64_epi64(_mm256_packus_epi16(q[0], q[1]), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+        return x;
+    }
+
+    // 32 input pixels per row to 16 output pixels
+    FS_TARGET_AVX2 S32 mip_row1_avx2(const U8* row0, const U8* row1, U8* out, S32 width)
+    {
+        const __m256i ones = _mm256_set1_epi16(1);
+        S32 x = 0;
+        for (; x + 16 <= width; x += 16, row0 += 32, row1 += 32, out += 16)
+        {
+            __m256i lo, hi;
+            sum_rows_avx2(_mm256_loadu_si256((const __m256i*)row0), _mm256_loadu_si256((const __m256i*)row1), lo, hi);
+            __m256i q = _mm256_packs_epi32(_mm256_madd_epi16(lo, ones), _mm256_madd_epi16(hi, ones));
+            q = _mm256_srli_epi16(q, 2);
+            q = _mm256_permute4x64_epi64(_mm256_packus_epi16(q, q), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(q));
+        }
+        return x;
+    }
+
+    // bilinear_scale() works on one pixel at a time; these keep its channels
+    // in the four 32 bit lanes and repeat its integer math exactly.
+    template<S32 CH>
+    inline __m128i load_pixel(const U8* pix)
+    {
+        U32 bits;
+        if (CH == 4)
+        {
+            memcpy(&bits, pix, 4);
+        }
+        else
+        {
+            bits = pix[0] | (pix[1] << 8) | (pix[2] << 16);
+        }
+        const __m128i zero = _mm_setzero_si128();
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero), zero);
+    }
+
+    template<S32 CH>
+    inline void store_pixel(U8* dptr, __m128i comp)
+    {
+        // (comp & 0xff) per channel
+        __m128i v = _mm_and_si128(comp, _mm_set1_epi32(0xff));
+        v = _mm_packs_epi32(v, v);
+        const U32 bits = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+        memcpy(dptr, &bits, CH);
+    }
+
+    // pixel * weight for weights below 1 << 15, all the scaler's pixel weights are
+    inline __m128i mul_weight(__m128i pix, S32 weight)
+    {
+        return _mm_madd_epi16(pix, _mm_set1_epi32(weight));
+    }
+
+    // Low 32 bits of a * b, there is no pmulld before SSE4.1
+    inline __m128i mullo_epi32(__m128i a, __m128i b)
+    {
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    inline __m128i mullo_epi32(__m128i a, S32 b)
+    {
+        return mullo_epi32(a, _mm_set1_epi32(b));
+    }
+
+    // Weighted sum along a shrinking axis: ap for the first pixel, C for
+    // the ones fully covered and whatever is left of 1 << 14 for the last
+    template<S32 CH>
+    inline __m128i box_sum(const U8* pix, S32 step, S32 ap, S32 C)
+    {
+        __m128i sum = mul_weight(load_pixel<CH>(pix), ap);
+        pix += step;
+        S32 j = (1 << 14) - ap;
+        for (; j > C; j -= C, pix += step)
+        {
+            sum = _mm_add_epi32(sum, mul_weight(load_pixel<CH>(pix), C));
+        }
+        if (j > 0)
+        {
+            sum = _mm_add_epi32(sum, mul_weight(load_pixel<CH>(pix), j));
+        }
+        return sum;
+    }
+
+    template<S32 CH>
+    void bilinear_scale_sse2(const FSImageScaleTables& tables, U32 srcStride, U8* dst, U32 dstW, U32 dstH, U32 dstStride)
+    {
+        if (tables.mXUpYUp == 3)
+        {
+            // up in both directions
+            for (U32 y = 0; y < dstH; ++y)
+            {
+                U8* dptr = dst + y * dstStride;
+                const U8* sptr = tables.mYStrides[y];
+                const S32 yap = tables.mYAPoints[y];
+                if (yap > 0)
+                {
+                    for (U32 x = 0; x < dstW; ++x, dptr += CH)
+                    {
+                        const S32 xap = tables.mXAPoints[x];
+                        const U8* pix = sptr + tables.mXPoints[x] * CH;
+                        __m128i comp;
+                        if (xap > 0)
+                        {
+                            comp = _mm_add_epi32(mul_weight(load_pixel<CH>(pix), 256 - xap), mul_weight(load_pixel<CH>(pix + CH), xap));
+                            pix += srcStride;
+                            const __m128i cx = _mm_add_epi32(mul_weight(load_pixel<CH>(pix + CH), xap), mul_weight(load_pixel<CH>(pix), 256 - xap));
+                            comp = _mm_srai_epi32(_mm_add_epi32(mullo_epi32(cx, yap), mullo_epi32(comp, 256 - yap)), 16);
+                        }
+                        else
+                        {
+                            comp = _mm_add_epi32(mul_weight(load_pixel<CH>(pix), 256 - yap), mul_weight(load_pixel<CH>(pix + srcStride), yap));
+                            comp = _mm_srai_epi32(comp, 8);
+                        }
+                        store_pixel<CH>(dptr, comp);
+                    }
+                }
+                else
+                {
+                    for (U32 x = 0; x < dstW; ++x, dptr += CH)
+                    {
+                        const S32 xap = tables.mXAPoints[x];
+                        const U8* pix = sptr + tables.mXPoints[x] * CH;
+                        if (xap > 0)
+                        {
+                            // the scalar loop blends the pixel with itself here
+                            const __m128i p = load_pixel<CH>(pix);
+                            store_pixel<CH>(dptr, _mm_srai_epi32(_mm_add_epi32(mul_weight(p, 256 - xap), mul_weight(p, xap)), 8));
+                        }
+                        else
+                        {
+                            memcpy(dptr, pix, CH);
+                        }
+                    }
+                }
+            }
+        }
+        else if (tables.mXUpYUp == 1)
+        {
+            // down vertically
+            for (U32 y = 0; y < dstH; ++y)
+            {
+                const S32 Cy = tables.mYAPoints[y] >> 16;
+                const S32 yap = tables.mYAPoints[y] & 0xffff;
+                U8* dptr = dst + y * dstStride;
+                for (U32 x = 0; x < dstW; ++x, dptr += CH)
+                {
+                    const U8* pix = tables.mYStrides[y] + tables.mXPoints[x] * CH;
+                    __m128i comp = box_sum<CH>(pix, srcStride, yap, Cy);
+                    const S32 xap = tables.mXAPoints[x];
+                    if (xap > 0)
+                    {
+                        const __m128i cx = box_sum<CH>(pix + CH, srcStride, yap, Cy);
+                        comp = _mm_srai_epi32(_mm_add_epi32(mullo_epi32(comp, 256 - xap), mullo_epi32(cx, xap)), 12);
+                    }
+                    else
+                    {
+                        comp = _mm_srai_epi32(comp, 4);
+                    }
+                    store_pixel<CH>(dptr, _mm_srai_epi32(comp, 10));
+                }
+            }
+        }
+        else if (tables.mXUpYUp == 2)
+        {
+            // down horizontally
+            for (U32 y = 0; y < dstH; ++y)
+            {
+                const S32 yap = tables.mYAPoints[y];
+                U8* dptr = dst + y * dstStride;
+                for (U32 x = 0; x < dstW; ++x, dptr += CH)
+                {
+                    const S32 Cx = tables.mXAPoints[x] >> 16;
+                    const S32 xap = tables.mXAPoints[x] & 0xffff;
+                    const U8* pix = tables.mYStrides[y] + tables.mXPoints[x] * CH;
+                    __m128i comp = box_sum<CH>(pix, CH, xap, Cx);
+                    if (yap > 0)
+                    {
+                        const __m128i cx = box_sum<CH>(pix + srcStride, CH, xap, Cx);
+                        comp = _mm_srai_epi32(_mm_add_epi32(mullo_epi32(comp, 256 - yap), mullo_epi32(cx, yap)), 12);
+                    }
+                    else
+                    {
+                        comp = _mm_srai_epi32(comp, 4);
+                    }
+                    store_pixel<CH>(dptr, _mm_srai_epi32(comp, 10));
+                }
+            }
+        }
+        else
+        {
+            // down in both directions
+            for (U32 y = 0; y < dstH; ++y)
+            {
+                const S32 Cy = tables.mYAPoints[y] >> 16;
+                const S32 yap = tables.mYAPoints[y] & 0xffff;
+                U8* dptr = dst + y * dstStride;
+                for (U32 x = 0; x < dstW; ++x, dptr += CH)
+                {
+                    const S32 Cx = tables.mXAPoints[x] >> 16;
+                    const S32 xap = tables.mXAPoints[x] & 0xffff;
+                    const U8* sptr = tables.mYStrides[y] + tables.mXPoints[x] * CH;
+
+                    __m128i comp = mullo_epi32(_mm_srai_epi32(box_sum<CH>(sptr, CH, xap, Cx), 5), yap);
+                    sptr += srcStride;
+                    S32 j = (1 << 14) - yap;
+                    for (; j > Cy; j -= Cy, sptr += srcStride)
+                    {
+                        comp = _mm_add_epi32(comp, mullo_epi32(_mm_srai_epi32(box_sum<CH>(sptr, CH, xap, Cx), 5), Cy));
+                    }
+                    if (j > 0)
+                    {
+                        comp = _mm_add_epi32(comp, mullo_epi32(_mm_srai_epi32(box_sum<CH>(sptr, CH, xap, Cx), 5), j));
+                    }
+                    store_pixel<CH>(dptr, _mm_srai_epi32(comp, 23));
+                }
+            }
+        }
+    }
+#endif // FS_IMAGE_KERNELS_X86
+}
+
+//static
+FSImageKernels::EISA FSImageKernels::getSupportedISA()
+{
+    static const EISA supported = detect_isa();
+    return supported;
+}
+
+//static
+FSImageKernels::EISA FSImageKernels::getISA()
+{
+    S32 isa = sActiveISA;
+    if (isa < 0)
+    {
+        isa = getSupportedISA();
+        sActiveISA = isa;
+        LL_INFOS("ImageKernels") << "Using " << getISAName((EISA)isa) << " image kernels" << LL_ENDL;
+    }
+    return (EISA)isa;
+}
+
+//static
+void FSImageKernels::setISA(EISA isa)
+{
+    sActiveISA = llmin(isa, getSupportedISA());
+}
+
+//static
+const char* FSImageKernels::getISAName(EISA isa)
+{
+    switch (isa)
+    {
+    case ISA_SSE2:
+        return "SSE2";
+    case ISA_AVX2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+
+//static
+bool FSImageKernels::generateMip(const U8* indata, U8* mipdata, S32 width, S32 height, S32 nchannels)
+{
+#ifdef FS_IMAGE_KERNELS_X86
+    const EISA isa = getISA();
+    mip_row_t row_kernel = NULL;
+    if (isa == ISA_AVX2)
+    {
+        const mip_row_t kernels[] = { mip_row1_avx2, mip_row2_avx2, mip_row3_avx2, mip_row4_avx2 };
+        row_kernel = nchannels >= 1 && nchannels <= 4 ? kernels[nchannels - 1] : NULL;
+    }
+    else if (isa == ISA_SSE2)
+    {
+        // 3 channel pixels straddle the lanes, not worth it without pshufb
+        const mip_row_t kernels[] = { mip_row1_sse2, mip_row2_sse2, NULL, mip_row4_sse2 };
+        row_kernel = nchannels >= 1 && nchannels <= 4 ? kernels[nchannels - 1] : NULL;
+    }
+    if (!row_kernel)
+    {
+        return false;
+    }
+
+    const S32 in_row = width * 2 * nchannels;
+    const S32 out_row = width * nchannels;
+    for (S32 y = 0; y < height; ++y, indata += in_row * 2, mipdata += out_row)
+    {
+        const S32 done = row_kernel(indata, indata + in_row, mipdata, width);
+        mip_row_scalar(indata, indata + in_row, mipdata, done, width, nchannels);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+//static
+bool FSImageKernels::bilinearScale(const FSImageScaleTables& tables, S32 nchannels, U32 srcStride,
+                                   U8* dst, U32 dstW, U32 dstH, U32 dstStride)
+{
+#ifdef FS_IMAGE_KERNELS_X86
+    // One pixel per vector, so the AVX2 level has nothing wider to offer
+    // and runs the same loops. Only RGBA pays off: assembling 3 byte pixels
+    // costs more than the unrolled scalar loop, and 1 channel has no lanes
+    // to fill.
+    if (getISA() == ISA_SCALAR || nchannels != 4)
+    {
+        return false;
+    }
+    bilinear_scale_sse2<4>(tables, srcStride, dst, dstW, dstH, dstStride);
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,81 @@
+/**
+ * @file fsimagekernels.h
+ * @brief SIMD pixel loops for LLImage with runtime instruction set dispatch.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_IMAGEKERNELS_H
+#define FS_IMAGEKERNELS_H
+
+#include "stdtypes.h"
+
+/**
+ * The lookup tables bilinear_scale() in llimage.cpp builds for one resize:
+ * source column and row per destination pixel plus the fixed point weights,
+ * packed as ap | (Cp << 16) along an axis that shrinks.
+ */
+struct FSImageScaleTables
+{
+    const S32*          mXPoints;
+    const U8* const*    mYStrides;  // start of the source row for each destination row
+    const S32*          mXAPoints;
+    const S32*          mYAPoints;
+    S32                 mXUpYUp;    // bit 0 x grows, bit 1 y grows
+};
+
+/**
+ * Vector versions of LLImageBase::generateMip() and the bilinear_scale()
+ * loops behind LLImageRaw::scale(). Every kernel produces exactly the bytes
+ * the scalar code does, so callers can switch freely.
+ *
+ * SSE2 is the build baseline on all x86 targets; AVX2 kernels are compiled
+ * per function and only run when the CPU and OS support them. Anything a
+ * kernel does not cover returns false and the caller runs its own loop.
+ */
+class FSImageKernels
+{
+public:
+    enum EISA
+    {
+        ISA_SCALAR = 0,
+        ISA_SSE2,
+        ISA_AVX2
+    };
+
+    // Best instruction set this CPU can run
+    static EISA getSupportedISA();
+    // Instruction set the kernels use, the supported one unless overridden
+    static EISA getISA();
+    // For tests and benchmarks; clamped to getSupportedISA()
+    static void setISA(EISA isa);
+    static const char* getISAName(EISA isa);
+
+    // Same contract as LLImageBase::generateMip()
+    static bool generateMip(const U8* indata, U8* mipdata, S32 width, S32 height, S32 nchannels);
+    // One bilinear_scale<ch>() pass over tables, RGBA only
+    static bool bilinearScale(const FSImageScaleTables& tables, S32 nchannels, U32 srcStride,
+                              U8* dst, U32 dstW, U32 dstH, U32 dstStride);
+};
+
+#endif // FS_IMAGEKERNELS_H
@@ -39,6 +39,7 @@
 #include "llimagepng.h"
 #include "llimagedxt.h"
 #include "llmemory.h"
+#include "fsimagekernels.h" // <FS> SIMD image kernels
 
 #include <boost/preprocessor.hpp>
 
@@ -229,6 +230,14 @@ inline void bilinear_scale(
 
 	scale_info_t info(src, srcW, srcH, dstW, dstH, srcStride);
 
+	// <FS> SIMD image kernels, bit exact with the loops below
+	const FSImageScaleTables tables = { &info.xpoints[0], &info.ystrides[0], &info.xapoints[0], &info.yapoints[0], info.xup_yup };
+	if (FSImageKernels::bilinearScale(tables, ch, srcStride, dst, dstW, dstH, dstStride))
+	{
+		return;
+	}
+	// </FS>
+
 	const U8 *sptr;
 	U8 *dptr;
 	U32 x, y;
@@ -2308,6 +2317,12 @@ void LLImageBase::setDataAndSize(U8 *data, S32 size)
 void LLImageBase::generateMip(const U8* indata, U8* mipdata, S32 width, S32 height, S32 nchannels)
 {
 	llassert(width > 0 && height > 0);
+	// <FS> SIMD image kernels, bit exact with the loop below
+	if (FSImageKernels::generateMip(indata, mipdata, width, height, nchannels))
+	{
+		return;
+	}
+	// </FS>
 	U8* data = mipdata;
 	S32 in_width = width*2;
 	for (S32 h=0; h<height; h++)
@@ -57,6 +57,7 @@ LLImageJ2C::LLImageJ2C() : 	LLImageFormatted(IMG_CODEC_J2C),
 							mRawDiscardLevel(-1),
 							mRate(DEFAULT_COMPRESSION_RATE),
 							mReversible(false),
+							mKeepDecodeState(false), // <FS>
 							mAreaUsedForDataSizeCalcs(0)
 {
 	mImpl.reset(fallbackCreateLLImageJ2CImpl());
@@ -145,6 +146,17 @@ bool LLImageJ2C::initEncode(LLImageRaw &raw_image, int blocks_size, int precinct
 	return mImpl->initEncode(*this,raw_image,blocks_size,precincts_size,levels);
 }
 
+// <FS>
+void LLImageJ2C::setKeepDecodeState(bool keep)
+{
+	mKeepDecodeState = keep;
+	if (!keep)
+	{
+		mImpl->releaseDecodeState();
+	}
+}
+// </FS>
+
 bool LLImageJ2C::decode(LLImageRaw *raw_imagep, F32 decode_time)
 {
 	return decodeChannels(raw_imagep, decode_time, 0, 4);
@@ -440,6 +452,7 @@ bool LLImageJ2C::validate(U8 *data, U32 file_size)
 void LLImageJ2C::decodeFailed()
 {
 	mDecoding = false;
+	mImpl->releaseDecodeState(); // <FS/> Nothing worth keeping from a failed decode
 }
 
 void LLImageJ2C::updateRawDiscardLevel()
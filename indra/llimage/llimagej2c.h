@@ -79,6 +79,13 @@ public:
 
 	static std::string getEngineInfo();
 
+	// <FS> Lets the decoder keep what it decoded for another pass over the
+	// same bytes, e.g. the aux channel after the color channels. Clearing
+	// it frees that state.
+	void setKeepDecodeState(bool keep);
+	bool getKeepDecodeState() const { return mKeepDecodeState; }
+	// </FS>
+
 protected:
 	friend class LLImageJ2CImpl;
 	friend class LLImageJ2COJ;
@@ -95,6 +102,7 @@ protected:
 	S8  mRawDiscardLevel;
 	F32 mRate;
 	bool mReversible;
+	bool mKeepDecodeState; // <FS>
 	boost::scoped_ptr<LLImageJ2CImpl> mImpl;
 	std::string mLastError;
 
@@ -124,6 +132,8 @@ protected:
 							bool reversible=false) = 0;
 	virtual bool initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int discard_level = -1, int* region = NULL) = 0;
 	virtual bool initEncode(LLImageJ2C &base, LLImageRaw &raw_image, int blocks_size = -1, int precincts_size = -1, int levels = 0) = 0;
+	// <FS> Free whatever decodeImpl() kept while LLImageJ2C::getKeepDecodeState() was set
+	virtual void releaseDecodeState() {}
 
 	virtual std::string getEngineInfo() const = 0;
 
@@ -28,64 +28,210 @@
 #include "fstelemetry.h" // <FS:Beq> add telemetry support.
 #include "llimageworker.h"
 #include "llimagedxt.h"
+#include "llimagej2c.h" // <FS>
 
  // <FS:ND> Image thread pool from CoolVL
 #include "boost/thread.hpp"
 std::atomic< U32 > s_ChildThreads;
 
+// <FS> Work stealing decode pool
+// Workers above the initial ones exit after being idle this long
+static const std::chrono::seconds POOL_IDLE_TIMEOUT(30);
+static const U32 POOL_MIN_WORKERS = 2;
+// </FS>
+
+// <FS> Work stealing decode pool
+//class PoolWorkerThread : public LLThread
+//{
+//public:
+//	PoolWorkerThread(std::string name) : LLThread(name),
+//		mCurrentRequest(NULL)
+//	{
+//	}
+//	virtual void run()
+//	{
+//		while (!isQuitting())
+//		{
+//			auto *pReq = mCurrentRequest.exchange(nullptr);
+//
+//			if (pReq)
+//				pReq->processRequestIntern();
+//			checkPause();
+//		}
+//	}
+//	bool isBusy()
+//	{
+//		auto *pReq = mCurrentRequest.load();
+//		if (!pReq)
+//			return false;
+//
+//		auto status = pReq->getStatus();
+//
+//		return status  == LLQueuedThread::STATUS_QUEUED || status == LLQueuedThread::STATUS_INPROGRESS;
+//	}
+//
+//	bool runCondition()
+//	{
+//		return mCurrentRequest != NULL;
+//	}
+//
+//	bool setRequest(LLImageDecodeThread::ImageRequest* req)
+//	{
+//		LLImageDecodeThread::ImageRequest* pOld{ nullptr };
+//		bool bSuccess = mCurrentRequest.compare_exchange_strong(pOld, req);
+//		wake();
+//
+//		return bSuccess;
+//	}
+//
+//private:
+//	std::atomic< LLImageDecodeThread::ImageRequest * > mCurrentRequest;
+//};
 class PoolWorkerThread : public LLThread
 {
 public:
-	PoolWorkerThread(std::string name) : LLThread(name),
-		mCurrentRequest(NULL)
+	PoolWorkerThread(std::string name, LLImageDecodeThread* pool, U32 index) : LLThread(name),
+		mPool(pool),
+		mIndex(index),
+		mTopKey(0),
+		mQueueSize(0),
+		mSequence(0)
 	{
 	}
+
 	virtual void run()
 	{
-		while (!isQuitting())
+		std::chrono::steady_clock::time_point idle_since = std::chrono::steady_clock::now();
+		while (!isQuitting() && !mPool->mPoolQuitting)
 		{
-			auto *pReq = mCurrentRequest.exchange(nullptr);
-
-			if (pReq)
-				pReq->processRequestIntern();
-			checkPause();
+			LLImageDecodeThread::ImageRequest* req = mPool->takeRequest(mIndex);
+			if (req)
+			{
+				++mPool->mPoolBusy;
+				req->processRequestIntern();
+				--mPool->mPoolBusy;
+				idle_since = std::chrono::steady_clock::now();
+			}
+			else if (std::chrono::steady_clock::now() - idle_since > POOL_IDLE_TIMEOUT && mPool->retirePoolWorker(mIndex))
+			{
+				break;
+			}
+			else
+			{
+				mPool->waitForRequest();
+			}
 		}
 	}
-	bool isBusy()
+
+	// Starts a worker that was started before and retired since
+	void restart()
 	{
-		auto *pReq = mCurrentRequest.load();
-		if (!pReq)
-			return false;
+		if (mThreadp)
+		{
+			mThreadp->join();
+			delete mThreadp;
+			mThreadp = NULL;
+		}
+		start();
+	}
 
-		auto status = pReq->getStatus();
+	// Called from any thread
+	void pushRequest(LLImageDecodeThread::ImageRequest* req)
+	{
+		LLMutexLock lock(&mQueueMutex);
+		mQueue.push_back(QueuedDecode(req->getPriority(), mSequence++, req));
+		std::push_heap(mQueue.begin(), mQueue.end());
+		updateQueueState();
+	}
 
-		return status  == LLQueuedThread::STATUS_QUEUED || status == LLQueuedThread::STATUS_INPROGRESS;
+	// Called from the owning worker and from workers stealing a request
+	LLImageDecodeThread::ImageRequest* popRequest()
+	{
+		LLMutexLock lock(&mQueueMutex);
+		if (mQueue.empty())
+		{
+			return nullptr;
+		}
+		std::pop_heap(mQueue.begin(), mQueue.end());
+		LLImageDecodeThread::ImageRequest* req = mQueue.back().mRequest;
+		mQueue.pop_back();
+		updateQueueState();
+		return req;
 	}
 
-	bool runCondition()
+	// Re-keys req if it is queued here, returns false if it is not
+	bool updatePriority(LLImageDecodeThread::ImageRequest* req, U32 priority)
 	{
-		return mCurrentRequest != NULL;
+		LLMutexLock lock(&mQueueMutex);
+		for (QueuedDecode& decode : mQueue)
+		{
+			if (decode.mRequest == req)
+			{
+				decode.mPriority = priority;
+				std::make_heap(mQueue.begin(), mQueue.end());
+				updateQueueState();
+				return true;
+			}
+		}
+		return false;
 	}
 
-	bool setRequest(LLImageDecodeThread::ImageRequest* req)
+	// Priority + 1 of the best queued request, 0 if the queue is empty
+	U32 getTopKey() const { return mTopKey; }
+	U32 getQueueSize() const { return mQueueSize; }
+
+private:
+	struct QueuedDecode
 	{
-		LLImageDecodeThread::ImageRequest* pOld{ nullptr };
-		bool bSuccess = mCurrentRequest.compare_exchange_strong(pOld, req);
-		wake();
+		QueuedDecode(U32 priority, U32 sequence, LLImageDecodeThread::ImageRequest* req)
+			: mPriority(priority), mSequence(sequence), mRequest(req)
+		{}
 
-		return bSuccess;
+		// Heap order: highest priority first, FIFO for equal priorities
+		bool operator<(const QueuedDecode& rhs) const
+		{
+			if (mPriority != rhs.mPriority)
+			{
+				return mPriority < rhs.mPriority;
+			}
+			return (S32)(mSequence - rhs.mSequence) > 0;
+		}
+
+		U32 mPriority;
+		U32 mSequence;
+		LLImageDecodeThread::ImageRequest* mRequest;
+	};
+
+	// mQueueMutex is locked before calling this
+	void updateQueueState()
+	{
+		mTopKey = mQueue.empty() ? 0 : llmin(mQueue.front().mPriority, (U32)LLQueuedThread::PRIORITY_IMMEDIATE) + 1;
+		mQueueSize = (U32)mQueue.size();
 	}
 
-private:
-	std::atomic< LLImageDecodeThread::ImageRequest * > mCurrentRequest;
+	LLImageDecodeThread* mPool;
+	U32 mIndex;
+	LLMutex mQueueMutex;
+	std::vector<QueuedDecode> mQueue; // Binary heap
+	std::atomic<U32> mTopKey;
+	std::atomic<U32> mQueueSize;
+	U32 mSequence;
 };
+// </FS>
 // </FS:ND>
 
 //----------------------------------------------------------------------------
 
 // MAIN THREAD
 LLImageDecodeThread::LLImageDecodeThread(bool threaded, U32 aSubThreads)
-	: LLQueuedThread("imagedecode", threaded)
+	: LLQueuedThread("imagedecode", threaded),
+	  // <FS> Work stealing decode pool
+	  mPoolStarted(0),
+	  mPoolBusy(0),
+	  mPoolPending(0),
+	  mPoolNextWorker(0),
+	  mPoolQuitting(false)
+	  // </FS>
 {
 	mCreationMutex = new LLMutex();
 
@@ -119,15 +265,34 @@ LLImageDecodeThread::LLImageDecodeThread(bool threaded, U32 aSubThreads)
 		std::stringstream strm;
 		strm << "imagedecodethread" << (i + 1);
 
-		mThreadPool.push_back(std::make_shared< PoolWorkerThread>(strm.str()));
-		mThreadPool[i]->start();
+		// <FS> Work stealing decode pool, workers are started on demand
+		//mThreadPool.push_back(std::make_shared< PoolWorkerThread>(strm.str()));
+		//mThreadPool[i]->start();
+		mThreadPool.push_back(std::make_shared< PoolWorkerThread>(strm.str(), this, i));
+		// </FS>
 	}
 	// </FS:ND>
+
+	// <FS> Work stealing decode pool
+	const U32 initial_workers = llmin(aSubThreads, POOL_MIN_WORKERS);
+	for (U32 i = 0; i < initial_workers; ++i)
+	{
+		startPoolWorker();
+	}
+	// </FS>
 }
 
 //virtual 
 LLImageDecodeThread::~LLImageDecodeThread()
 {
+	// <FS> Work stealing decode pool, stop the workers before the queues go away
+	{
+		std::lock_guard<std::mutex> lock(mPoolWaitMutex);
+		mPoolQuitting = true;
+	}
+	mPoolWaitCond.notify_all();
+	mThreadPool.clear();
+	// </FS>
 	delete mCreationMutex ;
 }
 
@@ -297,6 +462,12 @@ bool LLImageDecodeThread::ImageRequest::processRequestIntern()
 			{
 				mFormattedImage->setDiscardLevel(mDiscardLevel);
 			}
+			// <FS> The aux pass can take its channel from the color pass's decode
+			if (mNeedsAux && mFormattedImage->getCodec() == IMG_CODEC_J2C)
+			{
+				((LLImageJ2C*)mFormattedImage.get())->setKeepDecodeState(true);
+			}
+			// </FS>
 			mDecodedImageRaw = new LLImageRaw(mFormattedImage->getWidth(),
 											  mFormattedImage->getHeight(),
 											  mFormattedImage->getComponents());
@@ -330,6 +501,13 @@ bool LLImageDecodeThread::ImageRequest::processRequestIntern()
 		done = mFormattedImage->decodeChannels(mDecodedImageAux, decode_time_slice, 4, 4); // 1ms
 		mDecodedAux = done && mDecodedImageAux->getData();
 	}
+	// <FS> Free anything the color pass kept for the aux pass, also when a
+	// pass failed or ran out of time
+	if (mFormattedImage.notNull() && mFormattedImage->getCodec() == IMG_CODEC_J2C)
+	{
+		((LLImageJ2C*)mFormattedImage.get())->setKeepDecodeState(false);
+	}
+	// </FS>
 	// <FS:Beq> report timeout on async thread (which leads to worker abort errors)
 	if(!done)
 	{
@@ -367,13 +545,154 @@ bool LLImageDecodeThread::ImageRequest::tut_isOK()
 
 bool LLImageDecodeThread::enqueRequest(ImageRequest * req)
 {
-	for (auto &pThread : mThreadPool)
+	// <FS> Work stealing decode pool
+	//for (auto &pThread : mThreadPool)
+	//{
+	//	if (!pThread->isBusy())
+	//	{
+	//		if( pThread->setRequest(req) )
+	//			return true;
+	//	}
+	//}
+	//return false;
+	// Holding mPoolStartMutex keeps the chosen worker from retiring
+	LLMutexLock lock(&mPoolStartMutex);
+	U32 started = mPoolStarted;
+	if (!started || mPoolQuitting)
+	{
+		return false;
+	}
+
+	// Grow the pool when every running worker is busy and work is backing up
+	if (started < mThreadPool.size() && mPoolBusy >= started && mPoolPending > 0)
+	{
+		startPoolWorker();
+		started = mPoolStarted;
+	}
+
+	// Queue on the less loaded of two workers, idle workers steal the rest
+	U32 first = mPoolNextWorker++ % started;
+	U32 second = (first + 1) % started;
+	U32 target = mThreadPool[first]->getQueueSize() <= mThreadPool[second]->getQueueSize() ? first : second;
+	mThreadPool[target]->pushRequest(req);
+
+	{
+		std::lock_guard<std::mutex> lock(mPoolWaitMutex);
+		++mPoolPending;
+	}
+	mPoolWaitCond.notify_one();
+	return true;
+	// </FS>
+}
+
+// <FS> Work stealing decode pool
+// Called from the pool workers. Takes the highest priority request of all
+// worker queues, preferring the worker's own queue for equal priorities.
+LLImageDecodeThread::ImageRequest* LLImageDecodeThread::takeRequest(U32 worker_index)
+{
+	const U32 started = mPoolStarted;
+	for (U32 attempt = 0; attempt < 4; ++attempt)
 	{
-		if (!pThread->isBusy())
+		U32 best = worker_index;
+		U32 best_key = mThreadPool[worker_index]->getTopKey();
+		for (U32 i = 0; i < started; ++i)
 		{
-			if( pThread->setRequest(req) )
-				return true;
+			U32 key = mThreadPool[i]->getTopKey();
+			if (key > best_key)
+			{
+				best = i;
+				best_key = key;
+			}
+		}
+		if (!best_key)
+		{
+			return nullptr;
+		}
+
+		// Another worker may have taken it in the meantime
+		ImageRequest* req = mThreadPool[best]->popRequest();
+		if (req)
+		{
+			// Under the lock of the waitForRequest() predicate
+			std::lock_guard<std::mutex> lock(mPoolWaitMutex);
+			--mPoolPending;
+			return req;
+		}
+	}
+	return nullptr;
+}
+
+// Called from the pool workers when there is nothing to take
+void LLImageDecodeThread::waitForRequest()
+{
+	std::unique_lock<std::mutex> lock(mPoolWaitMutex);
+	mPoolWaitCond.wait_for(lock, std::chrono::milliseconds(100), [this]() { return mPoolPending > 0 || mPoolQuitting; });
+}
+
+bool LLImageDecodeThread::startPoolWorker()
+{
+	LLMutexLock lock(&mPoolStartMutex);
+	U32 started = mPoolStarted;
+	if (started >= mThreadPool.size())
+	{
+		return false;
+	}
+	// A retired worker may still be on its way out
+	if (!mThreadPool[started]->isStopped())
+	{
+		return false;
+	}
+	mThreadPool[started]->restart();
+	mPoolStarted = started + 1;
+	LL_DEBUGS("ImageDecode") << "Started image decode worker " << (started + 1) << " of " << mThreadPool.size() << LL_ENDL;
+	return true;
+}
+
+// Called from an idle pool worker. Only the last started worker retires, so
+// the started workers stay the first ones of mThreadPool.
+bool LLImageDecodeThread::retirePoolWorker(U32 worker_index)
+{
+	LLMutexLock lock(&mPoolStartMutex);
+	U32 started = mPoolStarted;
+	if (worker_index + 1 != started || started <= POOL_MIN_WORKERS || mThreadPool[worker_index]->getQueueSize())
+	{
+		return false;
+	}
+	mPoolStarted = started - 1;
+	LL_DEBUGS("ImageDecode") << "Retired idle image decode worker " << started << " of " << mThreadPool.size() << LL_ENDL;
+	return true;
+}
+
+void LLImageDecodeThread::setPriority(handle_t handle, U32 priority)
+{
+	{
+		LLMutexLock lock(mCreationMutex);
+		for (creation_info& info : mCreationList)
+		{
+			if (info.handle == handle)
+			{
+				info.priority = priority;
+				return;
+			}
+		}
+	}
+
+	lockData();
+	LLQueuedThread::setPriority(handle, priority);
+	ImageRequest* req = (ImageRequest*)mRequestHash.find(handle);
+	if (req && req->getStatus() == STATUS_INPROGRESS && (req->getFlags() & FLAG_ASYNC))
+	{
+		// Dispatched requests wait in a pool worker queue, which
+		// LLQueuedThread knows nothing about
+		const U32 started = mPoolStarted;
+		for (U32 i = 0; i < started; ++i)
+		{
+			if (mThreadPool[i]->updatePriority(req, priority))
+			{
+				break;
+			}
 		}
 	}
-	return false;
+	unlockData();
 }
+// </FS>
@@ -31,6 +31,12 @@
 #include "llpointer.h"
 #include "llworkerthread.h"
 
+// <FS> Work stealing decode pool
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+// </FS>
+
  // <FS:ND/> Image thread pool
 class PoolWorkerThread;
 
@@ -88,6 +94,7 @@ public:
 						 U32 priority, S32 discard, BOOL needs_aux,
 						 Responder* responder);
 	S32 update(F32 max_time_ms);
+	void setPriority(handle_t handle, U32 priority); // <FS/> Also re-keys requests queued in the decode pool
 
 	// Used by unit tests to check the consistency of the thread instance
 	S32 tut_size();
@@ -113,6 +120,29 @@ private:
 	std::vector< std::shared_ptr< PoolWorkerThread > > mThreadPool;
 	bool enqueRequest(ImageRequest*);
 	// <FS:ND>
+
+	// <FS> Work stealing decode pool
+	// Every pool worker owns a priority ordered queue. Requests are pushed
+	// to the least loaded worker and idle workers always take the highest
+	// priority request of all queues, stealing it from another worker if
+	// needed. mThreadPool holds the maximum number of workers, they are
+	// started on demand when all running workers are busy and retire again
+	// after being idle for a while.
+	friend class PoolWorkerThread;
+	ImageRequest* takeRequest(U32 worker_index);
+	void waitForRequest();
+	bool startPoolWorker();
+	bool retirePoolWorker(U32 worker_index);
+
+	std::atomic<U32> mPoolStarted;		// Number of started workers, always the first ones of mThreadPool
+	std::atomic<U32> mPoolBusy;			// Number of workers currently decoding
+	std::atomic<S32> mPoolPending;		// Number of requests queued on the workers
+	std::atomic<U32> mPoolNextWorker;
+	std::atomic<bool> mPoolQuitting;
+	std::mutex mPoolWaitMutex;
+	std::condition_variable mPoolWaitCond;
+	LLMutex mPoolStartMutex;
+	// </FS>
 };
 
 #endif
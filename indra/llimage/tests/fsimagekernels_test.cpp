@@ -0,0 +1,215 @@
+/**
+ * @file fsimagekernels_test.cpp
+ * @brief Tests and benchmark for the FSImageKernels SIMD image loops.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../fsimagekernels.h"
+
+#include "../llimage.h"
+#include "lltimer.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+    struct FSImageKernelsFixture
+    {
+        std::mt19937 mRandom;
+
+        ~FSImageKernelsFixture()
+        {
+            FSImageKernels::setISA(FSImageKernels::getSupportedISA());
+        }
+
+        void fill(U8* data, S32 size)
+        {
+            for (S32 i = 0; i < size; ++i)
+            {
+                data[i] = (U8)mRandom();
+            }
+        }
+
+        LLPointer<LLImageRaw> makeImage(S32 width, S32 height, S32 components)
+        {
+            LLPointer<LLImageRaw> raw = new LLImageRaw(width, height, components);
+            fill(raw->getData(), raw->getDataSize());
+            return raw;
+        }
+
+        std::vector<U8> mip(FSImageKernels::EISA isa, const std::vector<U8>& in, S32 width, S32 height, S32 components)
+        {
+            FSImageKernels::setISA(isa);
+            // a guard byte catches kernels writing past the level
+            std::vector<U8> out(width * height * components + 1, 0xa5);
+            LLImageBase::generateMip(&in[0], &out[0], width, height, components);
+            return out;
+        }
+
+        std::vector<U8> scaled(FSImageKernels::EISA isa, LLImageRaw* raw, S32 width, S32 height)
+        {
+            FSImageKernels::setISA(isa);
+            LLPointer<LLImageRaw> result = raw->scaled(width, height);
+            return std::vector<U8>(result->getData(), result->getData() + result->getDataSize());
+        }
+    };
+    typedef test_group<FSImageKernelsFixture> FSImageKernelsTest_factory;
+    typedef FSImageKernelsTest_factory::object FSImageKernelsTest_t;
+    FSImageKernelsTest_factory tf("FSImageKernels");
+
+    // Every instruction set builds the same mips as the scalar loop,
+    // including the pixels left over after the last full vector
+    template<> template<>
+    void FSImageKernelsTest_t::test<1>()
+    {
+        FSImageKernels::setISA(FSImageKernels::ISA_AVX2);
+        ensure_equals("setISA clamps", FSImageKernels::getISA(), FSImageKernels::getSupportedISA());
+
+        const S32 widths[] = { 1, 3, 4, 5, 8, 15, 16, 17, 31, 33, 64, 100 };
+        for (S32 components = 1; components <= 4; ++components)
+        {
+            for (S32 width : widths)
+            {
+                const S32 height = 3;
+                std::vector<U8> in(width * 2 * height * 2 * components);
+                fill(&in[0], (S32)in.size());
+                const std::vector<U8> expected = mip(FSImageKernels::ISA_SCALAR, in, width, height, components);
+                for (S32 isa = FSImageKernels::ISA_SSE2; isa <= FSImageKernels::getSupportedISA(); ++isa)
+                {
+                    std::string name = llformat("%s, %d channels, width %d", FSImageKernels::getISAName((FSImageKernels::EISA)isa), components, width);
+                    ensure(name, mip((FSImageKernels::EISA)isa, in, width, height, components) == expected);
+                }
+            }
+        }
+
+        // saturated input must not wrap the 16 bit sums
+        std::vector<U8> in(64 * 2 * 4, 255);
+        for (S32 isa = FSImageKernels::ISA_SCALAR; isa <= FSImageKernels::getSupportedISA(); ++isa)
+        {
+            std::vector<U8> out = mip((FSImageKernels::EISA)isa, in, 32, 1, 4);
+            ensure("white stays white", out[0] == 255 && out[127] == 255);
+        }
+    }
+
+    // LLImageRaw::scaled() matches the scalar scaler in all four up/down
+    // combinations; RGB and single channel images take the scalar path
+    template<> template<>
+    void FSImageKernelsTest_t::test<2>()
+    {
+        struct Resize { S32 mSrcW, mSrcH, mDstW, mDstH; };
+        const Resize resizes[] = {
+            { 64, 48, 100, 90 },    // up, up
+            { 100, 90, 37, 23 },    // down, down
+            { 64, 48, 30, 100 },    // down, up
+            { 64, 48, 120, 20 },    // up, down
+            { 37, 11, 256, 3 },
+            { 1024, 1024, 1000, 1000 },
+            { 7, 5, 1, 1 }
+        };
+        const S32 channels[] = { 1, 3, 4 };
+        for (S32 components : channels)
+        {
+            for (const Resize& resize : resizes)
+            {
+                LLPointer<LLImageRaw> raw = makeImage(resize.mSrcW, resize.mSrcH, components);
+                const std::vector<U8> expected = scaled(FSImageKernels::ISA_SCALAR, raw, resize.mDstW, resize.mDstH);
+                for (S32 isa = FSImageKernels::ISA_SSE2; isa <= FSImageKernels::getSupportedISA(); ++isa)
+                {
+                    std::string name = llformat("%s, %d channels, %dx%d to %dx%d", FSImageKernels::getISAName((FSImageKernels::EISA)isa),
+                                                components, resize.mSrcW, resize.mSrcH, resize.mDstW, resize.mDstH);
+                    ensure(name, scaled((FSImageKernels::EISA)isa, raw, resize.mDstW, resize.mDstH) == expected);
+                }
+            }
+        }
+    }
+
+    // MPix/s of source pixels per instruction set.
+    template<> template<>
+    void FSImageKernelsTest_t::test<3>()
+    {
+        skip_unless_benchmarks();
+
+        const S32 SIZE = 1024;
+        const S32 RUNS = 8;
+
+        std::cout << std::endl << "FSImageKernels, " << SIZE << "x" << SIZE << " source, MPix/s" << std::endl;
+        std::cout << std::setw(24) << "kernel";
+        for (S32 isa = FSImageKernels::ISA_SCALAR; isa <= FSImageKernels::getSupportedISA(); ++isa)
+        {
+            std::cout << std::setw(10) << FSImageKernels::getISAName((FSImageKernels::EISA)isa);
+        }
+        std::cout << std::endl;
+
+        const F64 mpix = (F64)SIZE * SIZE * RUNS / 1000000.0;
+        for (S32 components = 1; components <= 4; ++components)
+        {
+            std::vector<U8> in(SIZE * SIZE * components);
+            fill(&in[0], (S32)in.size());
+            std::vector<U8> out(in.size() / 4);
+
+            std::cout << std::setw(24) << llformat("generateMip %d ch", components);
+            for (S32 isa = FSImageKernels::ISA_SCALAR; isa <= FSImageKernels::getSupportedISA(); ++isa)
+            {
+                FSImageKernels::setISA((FSImageKernels::EISA)isa);
+                LLTimer timer;
+                for (S32 run = 0; run < RUNS; ++run)
+                {
+                    LLImageBase::generateMip(&in[0], &out[0], SIZE / 2, SIZE / 2, components);
+                }
+                std::cout << std::setw(10) << std::fixed << std::setprecision(1) << mpix / timer.getElapsedTimeF64();
+            }
+            std::cout << std::endl;
+        }
+
+        struct Resize { const char* mName; S32 mDstW, mDstH; };
+        const Resize resizes[] = { { "up", 1500, 1500 }, { "down", 700, 700 }, { "half", 512, 512 } };
+        for (S32 components = 3; components <= 4; ++components)
+        {
+            // RGB is the scalar loop in every column, for reference
+            LLPointer<LLImageRaw> raw = makeImage(SIZE, SIZE, components);
+            for (const Resize& resize : resizes)
+            {
+                std::cout << std::setw(24) << llformat("scaled %s %d ch", resize.mName, components);
+                for (S32 isa = FSImageKernels::ISA_SCALAR; isa <= FSImageKernels::getSupportedISA(); ++isa)
+                {
+                    FSImageKernels::setISA((FSImageKernels::EISA)isa);
+                    LLTimer timer;
+                    for (S32 run = 0; run < RUNS; ++run)
+                    {
+                        raw->scaled(resize.mDstW, resize.mDstH);
+                    }
+                    std::cout << std::setw(10) << std::fixed << std::setprecision(1) << mpix / timer.getElapsedTimeF64();
+                }
+                std::cout << std::endl;
+            }
+        }
+    }
+}
@@ -236,14 +236,52 @@ int ceildivpow2(int a, int b)
 
 LLImageJ2COJ::LLImageJ2COJ()
 	: LLImageJ2CImpl()
+	// <FS>
+	, mDecodedImage(NULL)
+	, mDecodedData(NULL)
+	, mDecodedSize(0)
+	, mDecodedReduce(0)
+	// </FS>
 {
 }
 
 
 LLImageJ2COJ::~LLImageJ2COJ()
 {
+	releaseDecodeState(); // <FS>
 }
 
+// <FS>
+void LLImageJ2COJ::releaseDecodeState()
+{
+	if (mDecodedImage)
+	{
+		opj_image_destroy(mDecodedImage);
+		mDecodedImage = NULL;
+	}
+}
+
+// OpenJPEG decodes every component whatever was asked for, so the aux
+// channel pass after the color channels only needs to copy it out. The
+// kept image is handed over only for the exact bytes and reduce factor it
+// came from; OpenJPEG has no way to continue a decode on a longer stream.
+bool LLImageJ2COJ::takeDecodeState(const LLImageJ2C &base, S32 reduce, opj_image*& image)
+{
+	if (!mDecodedImage)
+	{
+		return false;
+	}
+	if (mDecodedData != base.getData() || mDecodedSize != base.getDataSize() || mDecodedReduce != reduce)
+	{
+		releaseDecodeState();
+		return false;
+	}
+	image = mDecodedImage;
+	mDecodedImage = NULL;
+	return true;
+}
+// </FS>
+
 bool LLImageJ2COJ::initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int discard_level, int* region)
 {
 	// No specific implementation for this method in the OpenJpeg case
@@ -328,42 +366,48 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 
 #ifdef OPENJPEG2
 // [SL:KB] - Patch: Viewer-OpenJPEG2 | Checked: Catznip-5.3
-	/* get a decoder handle */
-	opj_codec_t* opj_decoder_p = opj_create_decompress(OPJ_CODEC_J2K);
-
-	/* catch events using our callbacks and give a local context */
-	opj_set_error_handler(opj_decoder_p, error_callback, 0);
-	opj_set_warning_handler(opj_decoder_p, warning_callback, 0);
-	opj_set_info_handler(opj_decoder_p, info_callback, 0);
-
-	/* setup the decoder decoding parameters using user parameters */
-	opj_setup_decoder(opj_decoder_p, &parameters);
-
-	/* allow multi-threading */
-	if (opj_has_thread_support())
+	// <FS> Components a previous pass over the same bytes already decoded
+	bool fSuccess = takeDecodeState(base, parameters.cp_reduce, image);
+	if (!fSuccess)
 	{
-		opj_codec_set_threads(opj_decoder_p, opj_get_num_cpus());
-	}
+	// </FS>
+		/* get a decoder handle */
+		opj_codec_t* opj_decoder_p = opj_create_decompress(OPJ_CODEC_J2K);
 
-	/* open a byte stream */
-	LLJp2StreamReader streamReader(&base);
-	opj_stream_t* opj_stream_p = opj_stream_default_create(OPJ_STREAM_READ);
-	opj_stream_set_read_function(opj_stream_p, LLJp2StreamReader::readStream);
-	opj_stream_set_skip_function(opj_stream_p, LLJp2StreamReader::skipStream);
-	opj_stream_set_seek_function(opj_stream_p, LLJp2StreamReader::seekStream);
-	opj_stream_set_user_data(opj_stream_p, &streamReader, nullptr);
-	opj_stream_set_user_data_length(opj_stream_p, base.getDataSize());
+		/* catch events using our callbacks and give a local context */
+		opj_set_error_handler(opj_decoder_p, error_callback, 0);
+		opj_set_warning_handler(opj_decoder_p, warning_callback, 0);
+		opj_set_info_handler(opj_decoder_p, info_callback, 0);
 
-	/* decode the stream and fill the image structure */
-	bool fSuccess = opj_read_header(opj_stream_p, opj_decoder_p, &image) &&
-	                opj_decode(opj_decoder_p, opj_stream_p, image) &&
-					opj_end_decompress(opj_decoder_p, opj_stream_p);
+		/* setup the decoder decoding parameters using user parameters */
+		opj_setup_decoder(opj_decoder_p, &parameters);
 
-	/* close the byte stream */
-	opj_stream_destroy(opj_stream_p);
+		/* allow multi-threading */
+		if (opj_has_thread_support())
+		{
+			opj_codec_set_threads(opj_decoder_p, opj_get_num_cpus());
+		}
 
-	/* free remaining structures */
-	opj_destroy_codec(opj_decoder_p);
+		/* open a byte stream */
+		LLJp2StreamReader streamReader(&base);
+		opj_stream_t* opj_stream_p = opj_stream_default_create(OPJ_STREAM_READ);
+		opj_stream_set_read_function(opj_stream_p, LLJp2StreamReader::readStream);
+		opj_stream_set_skip_function(opj_stream_p, LLJp2StreamReader::skipStream);
+		opj_stream_set_seek_function(opj_stream_p, LLJp2StreamReader::seekStream);
+		opj_stream_set_user_data(opj_stream_p, &streamReader, nullptr);
+		opj_stream_set_user_data_length(opj_stream_p, base.getDataSize());
+
+		/* decode the stream and fill the image structure */
+		fSuccess = opj_read_header(opj_stream_p, opj_decoder_p, &image) &&
+		           opj_decode(opj_decoder_p, opj_stream_p, image) &&
+		           opj_end_decompress(opj_decoder_p, opj_stream_p);
+
+		/* close the byte stream */
+		opj_stream_destroy(opj_stream_p);
+
+		/* free remaining structures */
+		opj_destroy_codec(opj_decoder_p);
+	} // <FS/>
 #else
 	/* get a decoder handle */
 	dinfo = opj_create_decompress(CODEC_J2K);
@@ -506,6 +550,17 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 		}
 	}
 
+	// <FS> Keep the components this pass skipped if another one will want them
+	if (base.getKeepDecodeState() && img_components > first_channel + channels)
+	{
+		mDecodedImage = image;
+		mDecodedData = base.getData();
+		mDecodedSize = base.getDataSize();
+		mDecodedReduce = parameters.cp_reduce;
+		return true; // done
+	}
+	// </FS>
+
 	/* free image data structure */
 	opj_image_destroy(image);
 
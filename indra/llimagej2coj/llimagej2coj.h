@@ -29,12 +29,18 @@
 
 #include "llimagej2c.h"
 
+struct opj_image; // <FS>
+
 class LLImageJ2COJ : public LLImageJ2CImpl
 {	
 public:
 	LLImageJ2COJ();
 	virtual ~LLImageJ2COJ();
 protected:
+	// <FS> Decoded components kept for another pass over the same bytes
+	/*virtual*/ void releaseDecodeState();
+	bool takeDecodeState(const LLImageJ2C &base, S32 reduce, opj_image*& image);
+	// </FS>
 	virtual bool getMetadata(LLImageJ2C &base);
 	virtual bool decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decode_time, S32 first_channel, S32 max_channel_count);
 	virtual bool encodeImpl(LLImageJ2C &base, const LLImageRaw &raw_image, const char* comment_text, F32 encode_time=0.0,
@@ -42,6 +48,14 @@ protected:
 	virtual bool initDecode(LLImageJ2C &base, LLImageRaw &raw_image, int discard_level = -1, int* region = NULL);
 	virtual bool initEncode(LLImageJ2C &base, LLImageRaw &raw_image, int blocks_size = -1, int precincts_size = -1, int levels = 0);
     virtual std::string getEngineInfo() const;
+
+// <FS>
+private:
+	opj_image*	mDecodedImage;	// all components, as OpenJPEG returned them
+	const U8*	mDecodedData;	// the bytes and reduce factor they came from
+	S32			mDecodedSize;
+	S32			mDecodedReduce;
+// </FS>
 };
 
 #endif
@@ -0,0 +1,293 @@
+/**
+ * @file fsvertexcache.cpp
+ * @brief Post-transform vertex cache optimization of triangle lists.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsvertexcache.h"
+
+#include <cmath>
+#include <new>
+#include <vector>
+
+// Scoring constants from http://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html,
+// the same values LLVolumeFace::cacheOptimize() used before
+static const F32 CACHE_DECAY_POWER = 1.5f;
+static const F32 LAST_TRI_SCORE = 0.75f;
+static const F32 VALENCE_BOOST_SCALE = 2.0f;
+static const F32 VALENCE_BOOST_POWER = 0.5f;
+static const U32 VALENCE_TABLE_SIZE = 64;
+
+namespace
+{
+    struct ScoreTables
+    {
+        F32 mCache[FSVertexCache::LRU_CACHE_SIZE];
+        F32 mValence[VALENCE_TABLE_SIZE];
+
+        ScoreTables()
+        {
+            const F32 scaler = 1.f / (FSVertexCache::LRU_CACHE_SIZE - 3);
+            for (U32 i = 0; i < FSVertexCache::LRU_CACHE_SIZE; ++i)
+            {
+                // the three vertices of the last triangle get a fixed score
+                // so the next triangle does not simply reuse the same edge
+                mCache[i] = i < 3 ? LAST_TRI_SCORE : powf(1.f - (i - 3) * scaler, CACHE_DECAY_POWER);
+            }
+            mValence[0] = 0.f;
+            for (U32 i = 1; i < VALENCE_TABLE_SIZE; ++i)
+            {
+                mValence[i] = VALENCE_BOOST_SCALE * powf((F32)i, -VALENCE_BOOST_POWER);
+            }
+        }
+
+        // cache_pos is -1 when the vertex is not in the cache
+        F32 score(S32 cache_pos, U32 active_triangles) const
+        {
+            if (!active_triangles)
+            {
+                // no triangle left to draw, never contributes
+                return -1.f;
+            }
+            F32 score = cache_pos < 0 ? 0.f : mCache[cache_pos];
+            if (active_triangles < VALENCE_TABLE_SIZE)
+            {
+                return score + mValence[active_triangles];
+            }
+            return score + VALENCE_BOOST_SCALE * powf((F32)active_triangles, -VALENCE_BOOST_POWER);
+        }
+    };
+
+    const ScoreTables& getScoreTables()
+    {
+        static const ScoreTables tables;
+        return tables;
+    }
+}
+
+bool FSVertexCache::optimize(U16* indices, U32 num_indices, U32 num_vertices)
+{
+    const U32 num_triangles = num_indices / 3;
+    if (num_triangles < 2 || num_vertices < 3)
+    {
+        return true;
+    }
+
+    for (U32 i = 0; i < num_triangles * 3; ++i)
+    {
+        if (indices[i] >= num_vertices)
+        {
+            LL_WARNS("LLVOLUME") << "Index " << indices[i] << " out of range, " << num_vertices << " vertices" << LL_ENDL;
+            return false;
+        }
+    }
+
+    const ScoreTables& tables = getScoreTables();
+
+    // Per vertex state. The triangles using a vertex are stored in one flat
+    // array: vertex_triangles[first_triangle[v] .. first_triangle[v] + active_triangles[v])
+    // holds the triangles of v that have not been emitted yet.
+    std::vector<U32> first_triangle;
+    std::vector<U32> active_triangles;
+    std::vector<S32> cache_pos;
+    std::vector<F32> vertex_score;
+    std::vector<U32> vertex_triangles;
+    // Per triangle state
+    std::vector<U8> emitted;
+    std::vector<U16> new_indices;
+
+    try
+    {
+        first_triangle.resize(num_vertices + 1, 0);
+        active_triangles.resize(num_vertices, 0);
+        cache_pos.resize(num_vertices, -1);
+        vertex_score.resize(num_vertices, 0.f);
+        vertex_triangles.resize(num_triangles * 3);
+        emitted.resize(num_triangles, 0);
+        new_indices.reserve(num_triangles * 3);
+    }
+    catch (std::bad_alloc&)
+    {
+        LL_WARNS("LLVOLUME") << "Allocation failed for " << num_triangles << " triangles" << LL_ENDL;
+        return false;
+    }
+
+    for (U32 i = 0; i < num_triangles * 3; ++i)
+    {
+        active_triangles[indices[i]]++;
+    }
+    for (U32 v = 0; v < num_vertices; ++v)
+    {
+        first_triangle[v + 1] = first_triangle[v] + active_triangles[v];
+        active_triangles[v] = 0;
+    }
+    for (U32 i = 0; i < num_triangles * 3; ++i)
+    {
+        U16 v = indices[i];
+        vertex_triangles[first_triangle[v] + active_triangles[v]++] = i / 3;
+    }
+
+    for (U32 v = 0; v < num_vertices; ++v)
+    {
+        vertex_score[v] = tables.score(-1, active_triangles[v]);
+    }
+    S32 best_triangle = -1;
+    F32 best_score = -1.f;
+    for (U32 t = 0; t < num_triangles; ++t)
+    {
+        F32 score = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+        if (score > best_score)
+        {
+            best_score = score;
+            best_triangle = (S32)t;
+        }
+    }
+
+    // LRU cache of vertex indices, with room for the three vertices the
+    // newest triangle can push out
+    S32 cache[LRU_CACHE_SIZE + 3];
+    S32 cache_used = 0;
+    S32 new_cache[LRU_CACHE_SIZE + 3];
+
+    // scan position for the next unemitted triangle when the cache runs dry
+    U32 next_unemitted = 0;
+
+    for (U32 emitted_count = 0; emitted_count < num_triangles; ++emitted_count)
+    {
+        if (best_triangle < 0)
+        {
+            while (emitted[next_unemitted])
+            {
+                ++next_unemitted;
+            }
+            best_triangle = (S32)next_unemitted;
+        }
+
+        const U16* tri = indices + best_triangle * 3;
+        new_indices.push_back(tri[0]);
+        new_indices.push_back(tri[1]);
+        new_indices.push_back(tri[2]);
+        emitted[best_triangle] = 1;
+
+        // Remove the triangle from the active lists of its vertices and
+        // move them to the front of the cache
+        S32 new_cache_used = 0;
+        for (S32 i = 0; i < 3; ++i)
+        {
+            U16 v = tri[i];
+            U32* first = &vertex_triangles[first_triangle[v]];
+            U32 count = active_triangles[v];
+            for (U32 j = 0; j < count; ++j)
+            {
+                if (first[j] == (U32)best_triangle)
+                {
+                    first[j] = first[count - 1];
+                    break;
+                }
+            }
+            active_triangles[v] = count - 1;
+            // degenerate triangles repeat a vertex
+            if (!new_cache_used || (new_cache[0] != v && (new_cache_used < 2 || new_cache[1] != v)))
+            {
+                new_cache[new_cache_used++] = v;
+            }
+        }
+        for (S32 i = 0; i < cache_used; ++i)
+        {
+            S32 v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+            {
+                new_cache[new_cache_used++] = v;
+            }
+        }
+
+        // Rescore the cached vertices; the ones pushed out of the cache
+        // are rescored as uncached
+        for (S32 i = 0; i < new_cache_used; ++i)
+        {
+            S32 v = new_cache[i];
+            cache_pos[v] = i < (S32)LRU_CACHE_SIZE ? i : -1;
+            vertex_score[v] = tables.score(cache_pos[v], active_triangles[v]);
+        }
+
+        // Only triangles touching a vertex whose score changed can become
+        // the best one
+        best_triangle = -1;
+        best_score = -1.f;
+        for (S32 i = 0; i < new_cache_used; ++i)
+        {
+            S32 v = new_cache[i];
+            const U32* first = &vertex_triangles[first_triangle[v]];
+            for (U32 j = 0, count = active_triangles[v]; j < count; ++j)
+            {
+                U32 t = first[j];
+                F32 score = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_triangle = (S32)t;
+                }
+            }
+        }
+
+        cache_used = llmin(new_cache_used, (S32)LRU_CACHE_SIZE);
+        for (S32 i = 0; i < cache_used; ++i)
+        {
+            cache[i] = new_cache[i];
+        }
+    }
+
+    llassert(new_indices.size() == num_triangles * 3);
+    std::copy(new_indices.begin(), new_indices.end(), indices);
+    return true;
+}
+
+F32 FSVertexCache::getACMR(const U16* indices, U32 num_indices, U32 num_vertices, U32 cache_size)
+{
+    const U32 num_triangles = num_indices / 3;
+    if (!num_triangles || !cache_size)
+    {
+        return 0.f;
+    }
+
+    // A vertex is in the FIFO when it was transformed less than cache_size
+    // misses ago
+    std::vector<S64> stamp(num_vertices, -(S64)cache_size - 1);
+    S64 misses = 0;
+    for (U32 i = 0; i < num_triangles * 3; ++i)
+    {
+        U16 v = indices[i];
+        if (v >= num_vertices)
+        {
+            continue;
+        }
+        if (misses - stamp[v] > (S64)cache_size)
+        {
+            stamp[v] = misses++;
+        }
+    }
+    return (F32)misses / num_triangles;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file fsvertexcache.h
+ * @brief Post-transform vertex cache optimization of triangle lists.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_VERTEXCACHE_H
+#define FS_VERTEXCACHE_H
+
+#include "stdtypes.h"
+
+namespace FSVertexCache
+{
+    // Size of the simulated LRU cache the triangles are scored against
+    const U32 LRU_CACHE_SIZE = 32;
+    // Size of the FIFO cache getACMR() simulates by default
+    const U32 FIFO_CACHE_SIZE = 16;
+
+    /**
+     * Reorders the triangles of an indexed triangle list for the
+     * post-transform vertex cache using Tom Forsyth's linear speed
+     * algorithm. Every triangle keeps its winding; only the order of the
+     * triangles changes. All bookkeeping is done with indices, so the
+     * input may be of any size and order. Trailing indices that do not
+     * form a whole triangle are left in place.
+     *
+     * Returns false if an index is out of range or memory runs out, in
+     * which case indices is left untouched.
+     */
+    bool optimize(U16* indices, U32 num_indices, U32 num_vertices);
+
+    /**
+     * Average cache miss ratio: transformed vertices per triangle for a
+     * FIFO cache of cache_size entries. 0.5 is the ideal for large regular
+     * meshes and 3.0 the worst case.
+     */
+    F32 getACMR(const U16* indices, U32 num_indices, U32 num_vertices, U32 cache_size = FIFO_CACHE_SIZE);
+}
+
+#endif // FS_VERTEXCACHE_H
@@ -50,6 +50,8 @@
 #include "llvector4a.h"
 #include "llmatrix4a.h"
 #include "lltimer.h"
+#include "fsvertexcache.h" // <FS> Index based vertex cache optimization
+#include "fsllsdbinarystream.h" // <FS> Streaming mesh LOD decoder
 
 #define DEBUG_SILHOUETTE_BINORMALS 0
 #define DEBUG_SILHOUETTE_NORMALS 0 // TomY: Use this to display normals using the silhouette
@@ -2392,6 +2394,481 @@ bool LLVolumeFace::VertexData::compareNormal(const LLVolumeFace::VertexData& rhs
 	return retval;
 }
 
+// <FS> Streaming mesh LOD decoder
+// Weights: per vertex up to 4 (joint byte, U16 weight) pairs, 0xFF terminated
+// unless all 4 are present
+static void unpack_volume_face_weights(LLVolumeFace& face, const U8* weights, U32 size, U32 num_verts)
+{
+	face.allocateWeights(num_verts);
+
+	U32 idx = 0;
+
+	U32 cur_vertex = 0;
+	while (idx < size && cur_vertex < num_verts)
+	{
+		const U8 END_INFLUENCES = 0xFF;
+		U8 joint = weights[idx++];
+
+		U32 cur_influence = 0;
+		LLVector4 wght(0,0,0,0);
+		U32 joints[4] = {0,0,0,0};
+		LLVector4 joints_with_weights(0,0,0,0);
+
+		while (joint != END_INFLUENCES && idx < size)
+		{
+			U16 influence = weights[idx++];
+			influence |= ((U16) weights[idx++] << 8);
+
+			F32 w = llclamp((F32) influence / 65535.f, 0.001f, 0.999f);
+			wght.mV[cur_influence] = w;
+			joints[cur_influence] = joint;
+			cur_influence++;
+
+			if (cur_influence >= 4)
+			{
+				joint = END_INFLUENCES;
+			}
+			else
+			{
+				joint = weights[idx++];
+			}
+		}
+		F32 wsum = wght.mV[VX] + wght.mV[VY] + wght.mV[VZ] + wght.mV[VW];
+		if (wsum <= 0.f)
+		{
+			wght = LLVector4(0.999f,0.f,0.f,0.f);
+		}
+		for (U32 k=0; k<4; k++)
+		{
+			F32 f_combined = (F32) joints[k] + wght[k];
+			joints_with_weights[k] = f_combined;
+			// Any weights we added above should wind up non-zero and applied to a specific bone.
+			// A failure here would indicate a floating point precision error in the math.
+			llassert((k >= cur_influence) || (f_combined - S32(f_combined) > 0.0f));
+		}
+		face.mWeights[cur_vertex].loadua(joints_with_weights.mV);
+
+		cur_vertex++;
+	}
+
+	if (cur_vertex != num_verts || idx != size)
+	{
+		LL_WARNS() << "Vertex weight count does not match vertex count!" << LL_ENDL;
+	}
+}
+
+// Quantized vertex streams are inflated into the tail of the face's own
+// vertex arrays and then expanded in place, front to back: the packed data
+// of vertex j+1 always starts past the 16 bytes written for vertex j. The
+// arithmetic matches unpackVolumeFacesInternal() exactly.
+static inline LLVector4a load_quantized_u16x4(const U8* packed, const LLQuad& mask)
+{
+	__m128i quantized = _mm_loadl_epi64((const __m128i*)packed);
+	quantized = _mm_and_si128(_mm_unpacklo_epi16(quantized, _mm_setzero_si128()), _mm_castps_si128(mask));
+	return LLVector4a(_mm_cvtepi32_ps(quantized));
+}
+
+static void dequantize_positions(LLVector4a* out, U32 num_verts, const LLVector4a& min_pos, const LLVector4a& pos_range)
+{
+	const U8* packed = (const U8*)(out + num_verts) - num_verts * 6;
+	const LLQuad xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const LLVector4a max_quantized(65535.f);
+	for (U32 j = 0; j < num_verts; ++j)
+	{
+		LLVector4a pos = load_quantized_u16x4(packed + j * 6, xyz_mask);
+		pos.div(max_quantized);
+		pos.mul(pos_range);
+		pos.add(min_pos);
+		out[j] = pos;
+	}
+}
+
+static void dequantize_normals(LLVector4a* out, U32 num_verts)
+{
+	const U8* packed = (const U8*)(out + num_verts) - num_verts * 6;
+	const LLQuad xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const LLVector4a max_quantized(65535.f);
+	for (U32 j = 0; j < num_verts; ++j)
+	{
+		LLVector4a norm = load_quantized_u16x4(packed + j * 6, xyz_mask);
+		norm.div(max_quantized);
+		norm.mul(2.f);
+		norm.sub(1.f);
+		out[j] = norm;
+	}
+}
+
+// Two texture coordinates per LLVector4a
+static void dequantize_texcoords(LLVector4a* out, U32 num_verts, const LLVector4a& min_tc4, const LLVector4a& tc_range)
+{
+	const U8* packed = (const U8*)out + num_verts * 4;
+	const LLQuad all_mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	const LLQuad first_mask = _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1));
+	const LLVector4a max_quantized(65535.f);
+	for (U32 j = 0; j < num_verts; j += 2)
+	{
+		// an odd last coordinate has no partner
+		LLVector4a tc = load_quantized_u16x4(packed + j * 4, j < num_verts - 1 ? all_mask : first_mask);
+		tc.div(max_quantized);
+		tc.mul(tc_range);
+		tc.add(min_tc4);
+		out[j / 2] = tc;
+	}
+}
+
+bool LLVolume::unpackVolumeFacesStreaming(const U8* in_data, S32 size)
+{
+	FSLLSDBinaryStream stream;
+	U32 face_count = 0;
+	if (!stream.open(in_data, size) || !stream.expect('[') || !stream.readSize(face_count))
+	{
+		return false;
+	}
+	if (face_count == 0 || face_count > (U32)LL_SCULPT_MESH_MAX_FACES)
+	{
+		return false;
+	}
+
+	// zlib cannot expand data more than about 1032:1, bounds every size
+	// read from the stream before anything is allocated for it
+	const U64 max_inflated_size = (U64)size * 1032;
+
+	// Weights are variable length and decoded separately, keep the scratch
+	// buffer around; padded so a truncated last influence reads zeros
+	static thread_local std::vector<U8> weight_buffer;
+
+	mVolumeFaces.resize(face_count);
+
+	for (U32 i = 0; i < face_count; ++i)
+	{
+		LLVolumeFace& face = mVolumeFaces[i];
+
+		U32 key_count = 0;
+		if (!stream.expect('{') || !stream.readSize(key_count))
+		{
+			return false;
+		}
+
+		bool no_geometry = false;
+		bool has_pos = false;
+		bool has_norm = false;
+		bool has_tc = false;
+		bool has_weights = false;
+		U32 weight_size = 0;
+		U32 num_verts = 0;
+		LLSD pos_domain;
+		LLSD tc_domain;
+
+		for (U32 k = 0; k < key_count; ++k)
+		{
+			std::string key;
+			char type;
+			if (!stream.readKey(key) || !stream.readType(type))
+			{
+				return false;
+			}
+
+			if (type == 'b' && (key == "Position" || key == "Normal" || key == "TexCoord0"))
+			{
+				U32 bytes = 0;
+				if (!stream.readSize(bytes) || bytes > max_inflated_size)
+				{
+					return false;
+				}
+				bool is_tc = (key == "TexCoord0");
+				U32 stride = is_tc ? 2 * sizeof(U16) : 3 * sizeof(U16);
+				U32 count = bytes / stride;
+				if (!count)
+				{
+					// same as a missing stream
+					if (!stream.skipRaw(bytes))
+					{
+						return false;
+					}
+					continue;
+				}
+				if (!num_verts)
+				{
+					num_verts = count;
+					face.resizeVertices(count);
+					if (!face.mPositions)
+					{
+						return false;
+					}
+				}
+				else if (count != num_verts)
+				{
+					return false;
+				}
+
+				U8* region;
+				if (is_tc)
+				{
+					region = (U8*)face.mTexCoords + num_verts * sizeof(LLVector2);
+					has_tc = true;
+				}
+				else if (key == "Position")
+				{
+					region = (U8*)(face.mPositions + num_verts);
+					has_pos = true;
+				}
+				else
+				{
+					region = (U8*)(face.mNormals + num_verts);
+					has_norm = true;
+				}
+				if (!stream.readRaw(region - count * stride, count * stride) || !stream.skipRaw(bytes - count * stride))
+				{
+					return false;
+				}
+			}
+			else if (type == 'b' && key == "TriangleList")
+			{
+				U32 bytes = 0;
+				if (!stream.readSize(bytes) || bytes > max_inflated_size)
+				{
+					return false;
+				}
+				U32 count = bytes / sizeof(U16);
+				face.resizeIndices(count);
+				if (count && !face.mIndices)
+				{
+					return false;
+				}
+				if ((count && !stream.readRaw(face.mIndices, count * sizeof(U16))) || !stream.skipRaw(bytes & 1))
+				{
+					return false;
+				}
+			}
+			else if (type == 'b' && key == "Weights")
+			{
+				if (!stream.readSize(weight_size) || weight_size > max_inflated_size)
+				{
+					return false;
+				}
+				weight_buffer.resize(weight_size + 4);
+				memset(&weight_buffer[weight_size], 0, 4);
+				if (!stream.readRaw(&weight_buffer[0], weight_size))
+				{
+					return false;
+				}
+				has_weights = true;
+			}
+			else if (key == "PositionDomain")
+			{
+				if (!stream.readValue(type, pos_domain))
+				{
+					return false;
+				}
+			}
+			else if (key == "TexCoord0Domain")
+			{
+				if (!stream.readValue(type, tc_domain))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				if (key == "NoGeometry")
+				{
+					no_geometry = true;
+				}
+				if (!stream.skipValue(type))
+				{
+					return false;
+				}
+			}
+		}
+		if (!stream.expect('}'))
+		{
+			return false;
+		}
+
+		if (no_geometry)
+		{ //face has no geometry, continue
+			face.resizeIndices(3);
+			face.resizeVertices(1);
+			face.mPositions->clear();
+			face.mNormals->clear();
+			face.mTexCoords->setZero();
+			memset(face.mIndices, 0, sizeof(U16)*3);
+			continue;
+		}
+
+		if (face.mNumIndices < 3)
+		{ //why is there an empty index list?
+			LL_WARNS() << "Empty face present! Face index: " << i << " Total: " << face_count << LL_ENDL;
+			face.resizeVertices(0);
+			continue;
+		}
+
+		if (!has_pos)
+		{
+			return false;
+		}
+
+		const LLSD& pos_domain_ref = pos_domain;
+		const LLSD& tc_domain_ref = tc_domain;
+		LLVector3 minp;
+		LLVector3 maxp;
+		LLVector2 min_tc;
+		LLVector2 max_tc;
+		minp.setValue(pos_domain_ref["Min"]);
+		maxp.setValue(pos_domain_ref["Max"]);
+		min_tc.setValue(tc_domain_ref["Min"]);
+		max_tc.setValue(tc_domain_ref["Max"]);
+
+		LLVector4a min_pos, max_pos;
+		min_pos.load3(minp.mV);
+		max_pos.load3(maxp.mV);
+		LLVector4a pos_range;
+		pos_range.setSub(max_pos, min_pos);
+
+		LLVector2 tc_range2 = max_tc - min_tc;
+		LLVector4a tc_range;
+		tc_range.set(tc_range2[0], tc_range2[1], tc_range2[0], tc_range2[1]);
+		LLVector4a min_tc4(min_tc[0], min_tc[1], min_tc[0], min_tc[1]);
+
+		dequantize_positions(face.mPositions, num_verts, min_pos, pos_range);
+
+		if (has_norm)
+		{
+			dequantize_normals(face.mNormals, num_verts);
+		}
+		else
+		{
+			for (U32 j = 0; j < num_verts; ++j)
+			{
+				face.mNormals[j].clear();
+			}
+		}
+
+		LLVector4a* tc_out = (LLVector4a*)face.mTexCoords;
+		if (has_tc)
+		{
+			dequantize_texcoords(tc_out, num_verts, min_tc4, tc_range);
+		}
+		else
+		{
+			for (U32 j = 0; j < num_verts; j += 2)
+			{
+				tc_out[j / 2].clear();
+			}
+		}
+
+		if (has_weights)
+		{
+			unpack_volume_face_weights(face, weight_size ? &weight_buffer[0] : NULL, weight_size, num_verts);
+		}
+
+		finishUnpackedVolumeFace(face);
+	}
+
+	return stream.expect(']') && stream.finish();
+}
+
+void LLVolume::finishUnpackedVolumeFace(LLVolumeFace& face)
+{
+	// modifier flags?
+	bool do_mirror = (mParams.getSculptType() & LL_SCULPT_FLAG_MIRROR);
+	bool do_invert = (mParams.getSculptType() &LL_SCULPT_FLAG_INVERT);
+	
+	
+	// translate to actions:
+	bool do_reflect_x = false;
+	bool do_reverse_triangles = false;
+	bool do_invert_normals = false;
+	
+	if (do_mirror)
+	{
+		do_reflect_x = true;
+		do_reverse_triangles = !do_reverse_triangles;
+	}
+	
+	if (do_invert)
+	{
+		do_invert_normals = true;
+		do_reverse_triangles = !do_reverse_triangles;
+	}
+	
+	// now do the work
+
+	if (do_reflect_x)
+	{
+		LLVector4a* p = (LLVector4a*) face.mPositions;
+		LLVector4a* n = (LLVector4a*) face.mNormals;
+		
+		for (S32 i = 0; i < face.mNumVertices; i++)
+		{
+			p[i].mul(-1.0f);
+			n[i].mul(-1.0f);
+		}
+	}
+
+	if (do_invert_normals)
+	{
+		LLVector4a* n = (LLVector4a*) face.mNormals;
+		
+		for (S32 i = 0; i < face.mNumVertices; i++)
+		{
+			n[i].mul(-1.0f);
+		}
+	}
+
+	if (do_reverse_triangles)
+	{
+		for (U32 j = 0; j < face.mNumIndices; j += 3)
+		{
+			// swap the 2nd and 3rd index
+			S32 swap = face.mIndices[j+1];
+			face.mIndices[j+1] = face.mIndices[j+2];
+			face.mIndices[j+2] = swap;
+		}
+	}
+
+	//calculate bounding box
+	// VFExtents change
+	LLVector4a& min = face.mExtents[0];
+	LLVector4a& max = face.mExtents[1];
+
+	if (face.mNumVertices < 3)
+	{ //empty face, use a dummy 1cm (at 1m scale) bounding box
+		min.splat(-0.005f);
+		max.splat(0.005f);
+	}
+	else
+	{
+		min = max = face.mPositions[0];
+
+		for (S32 i = 1; i < face.mNumVertices; ++i)
+		{
+			min.setMin(min, face.mPositions[i]);
+			max.setMax(max, face.mPositions[i]);
+		}
+
+		if (face.mTexCoords)
+		{
+			LLVector2& min_tc = face.mTexCoordExtents[0];
+			LLVector2& max_tc = face.mTexCoordExtents[1];
+
+			min_tc = face.mTexCoords[0];
+			max_tc = face.mTexCoords[0];
+
+			for (U32 j = 1; j < face.mNumVertices; ++j)
+			{
+				update_min_max(min_tc, max_tc, face.mTexCoords[j]);
+			}
+		}
+		else
+		{
+			face.mTexCoordExtents[0].set(0,0);
+			face.mTexCoordExtents[1].set(1,1);
+		}
+	}
+}
+// </FS>
+
 bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 {
 	//input stream is now pointing at a zlib compressed block of LLSD
@@ -2409,6 +2886,23 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
 
 bool LLVolume::unpackVolumeFaces(U8* in_data, S32 size)
 {
+	// <FS> Streaming mesh LOD decoder
+	if (unpackVolumeFacesStreaming(in_data, size))
+	{
+		if (!cacheOptimize())
+		{
+			// Out of memory?
+			LL_WARNS() << "Failed to optimize!" << LL_ENDL;
+			mVolumeFaces.clear();
+			return false;
+		}
+		mSculptLevel = 0;  // success!
+		return true;
+	}
+	// Unexpected layout or damaged data, let the LLSD parser have a go
+	mVolumeFaces.clear();
+	// </FS>
+
 	//input stream is now pointing at a zlib compressed block of LLSD
 	//decompress block
 	LLSD mdl;
@@ -2577,163 +3071,15 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
 
 			if (mdl[i].has("Weights"))
 			{
-				face.allocateWeights(num_verts);
-
+				// <FS> Streaming mesh LOD decoder, shared with unpackVolumeFacesStreaming()
 				LLSD::Binary weights = mdl[i]["Weights"];
-
-				U32 idx = 0;
-
-				U32 cur_vertex = 0;
-				while (idx < weights.size() && cur_vertex < num_verts)
-				{
-					const U8 END_INFLUENCES = 0xFF;
-					U8 joint = weights[idx++];
-
-					U32 cur_influence = 0;
-					LLVector4 wght(0,0,0,0);
-                    U32 joints[4] = {0,0,0,0};
-					LLVector4 joints_with_weights(0,0,0,0);
-
-					while (joint != END_INFLUENCES && idx < weights.size())
-					{
-						U16 influence = weights[idx++];
-						influence |= ((U16) weights[idx++] << 8);
-
-						F32 w = llclamp((F32) influence / 65535.f, 0.001f, 0.999f);
-						wght.mV[cur_influence] = w;
-						joints[cur_influence] = joint;
-						cur_influence++;
-
-						if (cur_influence >= 4)
-						{
-							joint = END_INFLUENCES;
-						}
-						else
-						{
-							joint = weights[idx++];
-						}
-					}
-                    F32 wsum = wght.mV[VX] + wght.mV[VY] + wght.mV[VZ] + wght.mV[VW];
-                    if (wsum <= 0.f)
-                    {
-                        wght = LLVector4(0.999f,0.f,0.f,0.f);
-                    }
-                    for (U32 k=0; k<4; k++)
-                    {
-                        F32 f_combined = (F32) joints[k] + wght[k];
-                        joints_with_weights[k] = f_combined;
-                        // Any weights we added above should wind up non-zero and applied to a specific bone.
-                        // A failure here would indicate a floating point precision error in the math.
-                        llassert((k >= cur_influence) || (f_combined - S32(f_combined) > 0.0f));
-                    }
-					face.mWeights[cur_vertex].loadua(joints_with_weights.mV);
-
-					cur_vertex++;
-				}
-
-				if (cur_vertex != num_verts || idx != weights.size())
-				{
-					LL_WARNS() << "Vertex weight count does not match vertex count!" << LL_ENDL;
-				}
-					
-			}
-
-			// modifier flags?
-			bool do_mirror = (mParams.getSculptType() & LL_SCULPT_FLAG_MIRROR);
-			bool do_invert = (mParams.getSculptType() &LL_SCULPT_FLAG_INVERT);
-			
-			
-			// translate to actions:
-			bool do_reflect_x = false;
-			bool do_reverse_triangles = false;
-			bool do_invert_normals = false;
-			
-			if (do_mirror)
-			{
-				do_reflect_x = true;
-				do_reverse_triangles = !do_reverse_triangles;
-			}
-			
-			if (do_invert)
-			{
-				do_invert_normals = true;
-				do_reverse_triangles = !do_reverse_triangles;
-			}
-			
-			// now do the work
-
-			if (do_reflect_x)
-			{
-				LLVector4a* p = (LLVector4a*) face.mPositions;
-				LLVector4a* n = (LLVector4a*) face.mNormals;
-				
-				for (S32 i = 0; i < face.mNumVertices; i++)
-				{
-					p[i].mul(-1.0f);
-					n[i].mul(-1.0f);
-				}
-			}
-
-			if (do_invert_normals)
-			{
-				LLVector4a* n = (LLVector4a*) face.mNormals;
-				
-				for (S32 i = 0; i < face.mNumVertices; i++)
-				{
-					n[i].mul(-1.0f);
-				}
+				unpack_volume_face_weights(face, weights.empty() ? NULL : &weights[0], weights.size(), num_verts);
+				// </FS>
 			}
 
-			if (do_reverse_triangles)
-			{
-				for (U32 j = 0; j < face.mNumIndices; j += 3)
-				{
-					// swap the 2nd and 3rd index
-					S32 swap = face.mIndices[j+1];
-					face.mIndices[j+1] = face.mIndices[j+2];
-					face.mIndices[j+2] = swap;
-				}
-			}
-
-			//calculate bounding box
-			// VFExtents change
-			LLVector4a& min = face.mExtents[0];
-			LLVector4a& max = face.mExtents[1];
-
-			if (face.mNumVertices < 3)
-			{ //empty face, use a dummy 1cm (at 1m scale) bounding box
-				min.splat(-0.005f);
-				max.splat(0.005f);
-			}
-			else
-			{
-				min = max = face.mPositions[0];
-
-				for (S32 i = 1; i < face.mNumVertices; ++i)
-				{
-					min.setMin(min, face.mPositions[i]);
-					max.setMax(max, face.mPositions[i]);
-				}
-
-				if (face.mTexCoords)
-				{
-					LLVector2& min_tc = face.mTexCoordExtents[0];
-					LLVector2& max_tc = face.mTexCoordExtents[1];
-
-					min_tc = face.mTexCoords[0];
-					max_tc = face.mTexCoords[0];
-
-					for (U32 j = 1; j < face.mNumVertices; ++j)
-					{
-						update_min_max(min_tc, max_tc, face.mTexCoords[j]);
-					}
-				}
-				else
-				{
-					face.mTexCoordExtents[0].set(0,0);
-					face.mTexCoordExtents[1].set(1,1);
-				}
-			}
+			// <FS> Streaming mesh LOD decoder, shared with unpackVolumeFacesStreaming()
+			finishUnpackedVolumeFace(face);
+			// </FS>
 		}
 	}
 
@@ -5080,6 +5426,8 @@ void LLVolumeFace::optimize(F32 angle_cutoff)
 
 }
 
+// <FS> Index based vertex cache optimization, see fsvertexcache.cpp
+#if 0
 class LLVCacheTriangleData;
 
 class LLVCacheVertexData
@@ -5342,7 +5690,8 @@ public:
 		}
 	}
 };
-
+#endif
+// </FS>
 
 bool LLVolumeFace::cacheOptimize()
 { //optimize for vertex cache according to Forsyth method: 
@@ -5358,7 +5707,8 @@ bool LLVolumeFace::cacheOptimize()
 	// windows version.
 	//
 	
-#ifndef LL_LINUX
+// <FS> Index based vertex cache optimization, works on all platforms
+#if 0
 	LLVCacheLRU cache;
 	
 	if (mNumVertices < 3 || mNumIndices < 3)
@@ -5486,6 +5836,19 @@ bool LLVolumeFace::cacheOptimize()
 		post_acmr = (F32) test_cache.mMisses/(mNumIndices/3);
 	}*/
 
+#endif
+
+	if (mNumVertices < 3 || mNumIndices < 3)
+	{ //nothing to do
+		return true;
+	}
+
+	if (!FSVertexCache::optimize(mIndices, mNumIndices, mNumVertices))
+	{
+		return false;
+	}
+// </FS>
+
 	//optimize for pre-TnL cache
 	
 	//allocate space for new buffer
@@ -5590,7 +5953,9 @@ bool LLVolumeFace::cacheOptimize()
 
 	//std::string result = llformat("ACMR pre/post: %.3f/%.3f  --  %d triangles %d breaks", pre_acmr, post_acmr, mNumIndices/3, breaks);
 	//LL_INFOS() << result << LL_ENDL;
-#endif
+// <FS> Index based vertex cache optimization
+//#endif
+// </FS>
 	
 	return true;
 }
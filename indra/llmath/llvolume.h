@@ -985,6 +985,7 @@ private:
 class LLVolume : public LLRefCount
 {
 	friend class LLVolumeLODGroup;
+	friend class FSVolumeUnpackTester; // <FS/> Streaming mesh LOD decoder unit test
 
 protected:
 	~LLVolume(); // use unref
@@ -1103,6 +1104,10 @@ public:
 	bool unpackVolumeFaces(U8* in_data, S32 size);
 private:
 	bool unpackVolumeFacesInternal(const LLSD& mdl);
+	// <FS> Streaming mesh LOD decoder
+	bool unpackVolumeFacesStreaming(const U8* in_data, S32 size);
+	void finishUnpackedVolumeFace(LLVolumeFace& face);
+	// </FS>
 
 public:
 // </FS:Beq pp Rye>
@@ -0,0 +1,182 @@
+/**
+ * @file fsvertexcache_test.cpp
+ * @brief Tests for the index based vertex cache optimizer.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../fsvertexcache.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    struct Mesh
+    {
+        std::string mName;
+        U32 mNumVertices;
+        std::vector<U16> mIndices;
+    };
+
+    // Quad grid, triangles in row order like a prim side face
+    Mesh makeGrid(U32 width, U32 height)
+    {
+        Mesh mesh;
+        mesh.mName = "grid";
+        mesh.mNumVertices = (width + 1) * (height + 1);
+        for (U32 y = 0; y < height; ++y)
+        {
+            for (U32 x = 0; x < width; ++x)
+            {
+                U16 v0 = (U16)(y * (width + 1) + x);
+                U16 v1 = v0 + 1;
+                U16 v2 = (U16)(v0 + width + 1);
+                U16 v3 = v2 + 1;
+                U16 quad[] = { v0, v1, v2, v2, v1, v3 };
+                mesh.mIndices.insert(mesh.mIndices.end(), quad, quad + 6);
+            }
+        }
+        return mesh;
+    }
+
+    // Triangle order scrambled, as exported by some modelling tools
+    Mesh shuffleTriangles(const Mesh& source, const std::string& name)
+    {
+        Mesh mesh = source;
+        mesh.mName = name;
+        U32 num_triangles = (U32)mesh.mIndices.size() / 3;
+        std::vector<U32> order(num_triangles);
+        for (U32 i = 0; i < num_triangles; ++i)
+        {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+        for (U32 i = 0; i < num_triangles; ++i)
+        {
+            std::copy(source.mIndices.begin() + order[i] * 3, source.mIndices.begin() + order[i] * 3 + 3,
+                      mesh.mIndices.begin() + i * 3);
+        }
+        return mesh;
+    }
+
+    std::vector<Mesh> makeTestMeshes()
+    {
+        std::vector<Mesh> meshes;
+        meshes.push_back(makeGrid(64, 64));
+        meshes.push_back(shuffleTriangles(meshes[0], "shuffled grid"));
+        meshes.push_back(makeGrid(255, 40));
+        meshes.back().mName = "wide grid";
+        return meshes;
+    }
+
+    // Triangles as a set, each rotated to start at its lowest index so the
+    // winding is part of the comparison
+    std::vector<U64> triangleSet(const std::vector<U16>& indices)
+    {
+        std::vector<U64> triangles;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            U16 v[3] = { indices[i], indices[i + 1], indices[i + 2] };
+            while (v[0] > v[1] || v[0] > v[2])
+            {
+                std::rotate(v, v + 1, v + 3);
+            }
+            triangles.push_back(((U64)v[0] << 32) | ((U64)v[1] << 16) | v[2]);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+}
+
+namespace tut
+{
+    struct FSVertexCacheFixture
+    {
+    };
+    typedef test_group<FSVertexCacheFixture> FSVertexCacheTest_factory;
+    typedef FSVertexCacheTest_factory::object FSVertexCacheTest_t;
+    FSVertexCacheTest_factory tf("FSVertexCache");
+
+    // Triangles and windings survive, cache efficiency improves
+    template<> template<>
+    void FSVertexCacheTest_t::test<1>()
+    {
+        for (const Mesh& mesh : makeTestMeshes())
+        {
+            std::vector<U16> indices = mesh.mIndices;
+            F32 before = FSVertexCache::getACMR(&indices[0], (U32)indices.size(), mesh.mNumVertices);
+            ensure(mesh.mName + " optimize", FSVertexCache::optimize(&indices[0], (U32)indices.size(), mesh.mNumVertices));
+            F32 after = FSVertexCache::getACMR(&indices[0], (U32)indices.size(), mesh.mNumVertices);
+
+            const std::string acmr = llformat(" (ACMR %.3f before, %.3f after)", before, after);
+            ensure(mesh.mName + " triangles preserved", triangleSet(indices) == triangleSet(mesh.mIndices));
+            ensure(mesh.mName + " ACMR not worse" + acmr, after <= before);
+            ensure(mesh.mName + " ACMR near optimal" + acmr, after < 0.8f);
+        }
+    }
+
+    // Degenerate triangles, unused vertices, a partial trailing triangle
+    // and out of range indices
+    template<> template<>
+    void FSVertexCacheTest_t::test<2>()
+    {
+        U16 indices[] = { 0, 1, 2,  2, 2, 3,  5, 5, 5,  3, 1, 0,  1, 3, 5,  7, 8 };
+        std::vector<U16> optimized(indices, indices + LL_ARRAY_SIZE(indices));
+        ensure("optimize", FSVertexCache::optimize(&optimized[0], (U32)optimized.size(), 10));
+        ensure("triangles preserved", triangleSet(optimized) == triangleSet(std::vector<U16>(indices, indices + LL_ARRAY_SIZE(indices))));
+        ensure("partial triangle kept", optimized[15] == 7 && optimized[16] == 8);
+
+        std::vector<U16> bad(indices, indices + 15);
+        bad[4] = 10;
+        std::vector<U16> unchanged = bad;
+        ensure("out of range index rejected", !FSVertexCache::optimize(&bad[0], (U32)bad.size(), 10));
+        ensure("rejected input untouched", bad == unchanged);
+    }
+
+    // ACMR before and after optimizing each test mesh
+    template<> template<>
+    void FSVertexCacheTest_t::test<3>()
+    {
+        skip_unless_benchmarks();
+
+        std::cout << std::endl << std::setw(16) << "mesh" << std::setw(12) << "triangles"
+                  << std::setw(14) << "ACMR before" << std::setw(14) << "ACMR after" << std::endl;
+        for (const Mesh& mesh : makeTestMeshes())
+        {
+            std::vector<U16> indices = mesh.mIndices;
+            F32 before = FSVertexCache::getACMR(&indices[0], (U32)indices.size(), mesh.mNumVertices);
+            FSVertexCache::optimize(&indices[0], (U32)indices.size(), mesh.mNumVertices);
+            F32 after = FSVertexCache::getACMR(&indices[0], (U32)indices.size(), mesh.mNumVertices);
+
+            std::cout << std::setw(16) << mesh.mName << std::setw(12) << indices.size() / 3 << std::fixed
+                      << std::setprecision(3) << std::setw(14) << before << std::setw(14) << after << std::endl;
+        }
+    }
+}
@@ -0,0 +1,340 @@
+/**
+ * @file fsvolumeunpack_test.cpp
+ * @brief Tests for the streaming mesh LOD decoder against the LLSD path.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../llvolume.h"
+
+#include "llpointer.h"
+#include "llsdserialize.h"
+
+#include <random>
+#include <sstream>
+#include <vector>
+#include <zlib.h>
+
+#include "../test/lltut.h"
+
+// Runs the two mesh LOD decoders separately, LLVolume::unpackVolumeFaces()
+// would hide a streaming failure behind its fallback
+class FSVolumeUnpackTester
+{
+public:
+    // The streaming decoder, finished like unpackVolumeFaces() does
+    static bool unpackStreaming(LLVolume* volume, const U8* data, S32 size)
+    {
+        volume->mVolumeFaces.clear();
+        return volume->unpackVolumeFacesStreaming(data, size) && volume->cacheOptimize();
+    }
+
+    // The unzip_llsd() fallback
+    static bool unpackLLSD(LLVolume* volume, const U8* data, S32 size)
+    {
+        volume->mVolumeFaces.clear();
+        LLSD mdl;
+        return LLUZipHelper::unzip_llsd(mdl, data, size) == LLUZipHelper::ZR_OK && volume->unpackVolumeFacesInternal(mdl);
+    }
+};
+
+namespace
+{
+    LLSD::Binary toBinary(const std::vector<U16>& values)
+    {
+        LLSD::Binary binary(values.size() * sizeof(U16));
+        if (!values.empty())
+        {
+            memcpy(&binary[0], &values[0], binary.size());
+        }
+        return binary;
+    }
+
+    LLSD makeDomain(const F32* min, const F32* max, S32 components)
+    {
+        LLSD domain;
+        for (S32 i = 0; i < components; ++i)
+        {
+            domain["Min"].append(min[i]);
+            domain["Max"].append(max[i]);
+        }
+        return domain;
+    }
+
+    // Random quantized vertices the way LLModel::writeModel() stores them
+    LLSD makeFace(std::mt19937& rng, U32 num_verts, U32 num_triangles, bool texcoords, bool weights)
+    {
+        std::uniform_int_distribution<U32> quantized(0, 65535);
+        std::uniform_int_distribution<U32> vertex(0, num_verts - 1);
+        std::uniform_int_distribution<U32> joint(0, 40);
+        std::uniform_int_distribution<U32> influences(1, 4);
+
+        std::vector<U16> positions;
+        std::vector<U16> normals;
+        std::vector<U16> tcs;
+        for (U32 i = 0; i < num_verts; ++i)
+        {
+            for (U32 k = 0; k < 3; ++k)
+            {
+                positions.push_back((U16)quantized(rng));
+                normals.push_back((U16)quantized(rng));
+            }
+            tcs.push_back((U16)quantized(rng));
+            tcs.push_back((U16)quantized(rng));
+        }
+        // Every vertex is referenced, cacheOptimize() drops the others and
+        // leaves the end of the vertex arrays uninitialized
+        std::vector<U16> indices;
+        for (U32 i = 0; i < num_triangles * 3; ++i)
+        {
+            indices.push_back((U16)(i < num_verts ? i : vertex(rng)));
+        }
+
+        const F32 min_pos[] = { -1.5f, -0.25f, -3.f };
+        const F32 max_pos[] = { 0.75f, 2.f, 0.125f };
+        const F32 min_tc[] = { -0.5f, 0.f };
+        const F32 max_tc[] = { 1.f, 2.5f };
+
+        LLSD face;
+        face["PositionDomain"] = makeDomain(min_pos, max_pos, 3);
+        face["Position"] = toBinary(positions);
+        face["Normal"] = toBinary(normals);
+        if (texcoords)
+        {
+            face["TexCoord0Domain"] = makeDomain(min_tc, max_tc, 2);
+            face["TexCoord0"] = toBinary(tcs);
+        }
+        face["TriangleList"] = toBinary(indices);
+
+        if (weights)
+        {
+            // Joint, 16 bit little endian weight, 0xFF after fewer than 4
+            LLSD::Binary data;
+            for (U32 i = 0; i < num_verts; ++i)
+            {
+                U32 count = influences(rng);
+                for (U32 k = 0; k < count; ++k)
+                {
+                    U32 weight = quantized(rng);
+                    data.push_back((U8)joint(rng));
+                    data.push_back((U8)(weight & 0xFF));
+                    data.push_back((U8)(weight >> 8));
+                }
+                if (count < 4)
+                {
+                    data.push_back(0xFF);
+                }
+            }
+            face["Weights"] = data;
+        }
+        return face;
+    }
+
+    LLSD makeLOD()
+    {
+        std::mt19937 rng(1234);
+        LLSD lod;
+        // Odd vertex count, the last texture coordinate has no partner
+        lod.append(makeFace(rng, 51, 80, true, true));
+        lod.append(makeFace(rng, 40, 60, false, false));
+        // Empty index list
+        lod.append(makeFace(rng, 12, 0, true, false));
+        LLSD no_geometry;
+        no_geometry["NoGeometry"] = true;
+        lod.append(no_geometry);
+        // Large enough for the direct to caller memory inflate path
+        lod.append(makeFace(rng, 4000, 6000, true, true));
+        return lod;
+    }
+
+    std::string serialize(const LLSD& lod, bool deprecated_header)
+    {
+        std::ostringstream str;
+        if (deprecated_header)
+        {
+            // No line break, strip_deprecated_header() doesn't skip one
+            str << "<? LLSD/Binary ?>";
+        }
+        LLSDSerialize::toBinary(lod, str);
+        return str.str();
+    }
+
+    std::vector<U8> compress(const std::string& raw)
+    {
+        uLongf size = compressBound((uLong)raw.size());
+        std::vector<U8> out(size);
+        compress2(&out[0], &size, (const Bytef*)raw.data(), (uLong)raw.size(), Z_BEST_COMPRESSION);
+        out.resize(size);
+        return out;
+    }
+
+    // Offset of the big endian size after the type byte of key's first value
+    size_t findValueSize(const std::string& raw, const std::string& key)
+    {
+        std::string token("k");
+        for (S32 shift = 24; shift >= 0; shift -= 8)
+        {
+            token.push_back((char)((key.size() >> shift) & 0xFF));
+        }
+        token += key;
+        size_t pos = raw.find(token);
+        return pos == std::string::npos ? pos : pos + token.size() + 1;
+    }
+
+    void setSize(std::string& raw, size_t pos, U32 size)
+    {
+        raw[pos] = (char)(size >> 24);
+        raw[pos + 1] = (char)(size >> 16);
+        raw[pos + 2] = (char)(size >> 8);
+        raw[pos + 3] = (char)size;
+    }
+
+    U32 getSize(const std::string& raw, size_t pos)
+    {
+        return ((U32)(U8)raw[pos] << 24) | ((U32)(U8)raw[pos + 1] << 16) | ((U32)(U8)raw[pos + 2] << 8) | (U32)(U8)raw[pos + 3];
+    }
+
+    LLPointer<LLVolume> makeVolume(U8 sculpt_flags)
+    {
+        LLVolumeParams params;
+        params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+        params.setSculptID(LLUUID("5748decc-f629-461c-9a36-a35a221fe21f"), LL_SCULPT_TYPE_MESH | sculpt_flags);
+        return new LLVolume(params, 0.f);
+    }
+}
+
+namespace tut
+{
+    struct FSVolumeUnpackFixture
+    {
+        void ensureSameFaces(const std::string& msg, const LLVolume* streamed, const LLVolume* parsed)
+        {
+            ensure_equals(msg + " face count", streamed->getNumVolumeFaces(), parsed->getNumVolumeFaces());
+            for (S32 i = 0; i < streamed->getNumVolumeFaces(); ++i)
+            {
+                const LLVolumeFace& a = streamed->getVolumeFace(i);
+                const LLVolumeFace& b = parsed->getVolumeFace(i);
+                const std::string face = msg + llformat(" face %d", i);
+
+                ensure_equals(face + " vertices", a.mNumVertices, b.mNumVertices);
+                ensure_equals(face + " indices", a.mNumIndices, b.mNumIndices);
+                const U32 num_verts = (U32)a.mNumVertices;
+                if (num_verts)
+                {
+                    ensure_memory_matches((face + " positions").c_str(), a.mPositions, num_verts * sizeof(LLVector4a), b.mPositions, num_verts * sizeof(LLVector4a));
+                    ensure_memory_matches((face + " normals").c_str(), a.mNormals, num_verts * sizeof(LLVector4a), b.mNormals, num_verts * sizeof(LLVector4a));
+                    ensure_memory_matches((face + " texcoords").c_str(), a.mTexCoords, num_verts * sizeof(LLVector2), b.mTexCoords, num_verts * sizeof(LLVector2));
+                }
+                ensure_equals(face + " has weights", a.mWeights != NULL, b.mWeights != NULL);
+                if (a.mWeights && num_verts)
+                {
+                    ensure_memory_matches((face + " weights").c_str(), a.mWeights, num_verts * sizeof(LLVector4a), b.mWeights, num_verts * sizeof(LLVector4a));
+                }
+                if (a.mNumIndices)
+                {
+                    ensure_memory_matches((face + " index data").c_str(), a.mIndices, a.mNumIndices * sizeof(U16), b.mIndices, b.mNumIndices * sizeof(U16));
+                }
+                ensure_memory_matches((face + " extents").c_str(), a.mExtents, 2 * sizeof(LLVector4a), b.mExtents, 2 * sizeof(LLVector4a));
+                ensure_memory_matches((face + " texcoord extents").c_str(), a.mTexCoordExtents, sizeof(a.mTexCoordExtents), b.mTexCoordExtents, sizeof(b.mTexCoordExtents));
+            }
+        }
+    };
+    typedef test_group<FSVolumeUnpackFixture> FSVolumeUnpackTest_factory;
+    typedef FSVolumeUnpackTest_factory::object FSVolumeUnpackTest_t;
+    FSVolumeUnpackTest_factory tf("FSVolumeUnpack");
+
+    // Both decoders produce the same faces, with and without the deprecated
+    // header and for mirrored and inverted meshes
+    template<> template<>
+    void FSVolumeUnpackTest_t::test<1>()
+    {
+        const LLSD lod = makeLOD();
+        const U8 sculpt_flags[] = { 0, LL_SCULPT_FLAG_MIRROR, LL_SCULPT_FLAG_INVERT, LL_SCULPT_FLAG_MIRROR | LL_SCULPT_FLAG_INVERT };
+        for (S32 header = 0; header < 2; ++header)
+        {
+            const std::vector<U8> data = compress(serialize(lod, header != 0));
+            for (U8 flags : sculpt_flags)
+            {
+                const std::string msg = llformat("header %d flags %d", header, flags);
+                LLPointer<LLVolume> streamed = makeVolume(flags);
+                LLPointer<LLVolume> parsed = makeVolume(flags);
+                ensure(msg + " streaming decode", FSVolumeUnpackTester::unpackStreaming(streamed, &data[0], (S32)data.size()));
+                ensure(msg + " LLSD decode", FSVolumeUnpackTester::unpackLLSD(parsed, &data[0], (S32)data.size()));
+                ensureSameFaces(msg, streamed, parsed);
+            }
+        }
+    }
+
+    // Truncated streams fail. The bytes past the given size are the rest of
+    // the valid stream, so reading beyond it would make the decode succeed.
+    template<> template<>
+    void FSVolumeUnpackTest_t::test<2>()
+    {
+        const std::vector<U8> data = compress(serialize(makeLOD(), false));
+        const S32 size = (S32)data.size();
+        const S32 cuts[] = { 1, 2, 16, size / 3, size / 2, size - 64, size - 5, size - 4, size - 1 };
+        for (S32 cut : cuts)
+        {
+            LLPointer<LLVolume> volume = makeVolume(0);
+            ensure(llformat("streaming decode of %d/%d bytes", cut, size), !FSVolumeUnpackTester::unpackStreaming(volume, &data[0], cut));
+            ensure(llformat("decode of %d/%d bytes", cut, size), !volume->unpackVolumeFaces(const_cast<U8*>(&data[0]), cut));
+        }
+    }
+
+    // Sizes that don't match the data fail before anything is allocated or
+    // inflated for them
+    template<> template<>
+    void FSVolumeUnpackTest_t::test<3>()
+    {
+        const std::string raw = serialize(makeLOD(), false);
+
+        struct Corruption
+        {
+            const char* mName;
+            size_t mPos;
+            U32 mSize;
+        };
+        const size_t tri_pos = findValueSize(raw, "TriangleList");
+        ensure("TriangleList found", tri_pos != std::string::npos);
+        const Corruption corruptions[] =
+        {
+            { "face count", 1, 0x7FFFFFFF },
+            { "Position size", findValueSize(raw, "Position"), 0xFFFFFFF0 },
+            { "Normal size", findValueSize(raw, "Normal"), 0x80000000 },
+            { "TexCoord0 size", findValueSize(raw, "TexCoord0"), 0xFFFFFFFF },
+            { "TriangleList past the end", tri_pos, getSize(raw, tri_pos) + 1000000 },
+            { "Weights size", findValueSize(raw, "Weights"), 0x7FFFFFF0 },
+        };
+        for (const Corruption& corruption : corruptions)
+        {
+            ensure(std::string(corruption.mName) + " found", corruption.mPos != std::string::npos);
+            std::string corrupt = raw;
+            setSize(corrupt, corruption.mPos, corruption.mSize);
+            const std::vector<U8> data = compress(corrupt);
+
+            LLPointer<LLVolume> volume = makeVolume(0);
+            ensure(corruption.mName, !FSVolumeUnpackTester::unpackStreaming(volume, &data[0], (S32)data.size()));
+        }
+    }
+}
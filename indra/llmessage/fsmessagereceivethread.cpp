@@ -0,0 +1,274 @@
+/**
+ * @file fsmessagereceivethread.cpp
+ * @brief Receives and decodes template messages off the main thread.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsmessagereceivethread.h"
+
+#if LL_WINDOWS
+    #include <winsock2.h>
+#else
+    #include <sys/select.h>
+#endif
+
+#include "llpacketring.h"
+#include "lltemplatemessagereader.h"
+#include "lltimer.h"
+#include "message.h"
+
+namespace
+{
+    // Packets decoded ahead of the main thread, each one is two full size
+    // buffers. Past this the socket receive buffer holds the rest, as it
+    // does for the unthreaded receive.
+    const U32 MAX_PACKETS_IN_FLIGHT = 128;
+    // How long the thread waits on an idle socket before checking whether
+    // it should quit
+    const S32 IDLE_WAIT_MS = 10;
+}
+
+FSReceivedPacket::FSReceivedPacket()
+:   mTrueSize(0),
+    mBuffer(mTrueBuffer),
+    mSize(0),
+    mCompressedSize(0),
+    mExpandOverflows(0),
+    mTemplate(NULL),
+    mData(NULL)
+{
+}
+
+FSReceivedPacket::~FSReceivedPacket()
+{
+    clear();
+}
+
+void FSReceivedPacket::clear()
+{
+    mBuffer = mTrueBuffer;
+    mSize = 0;
+    mCompressedSize = 0;
+    mExpandOverflows = 0;
+    mTemplate = NULL;
+    delete mData;
+    mData = NULL;
+    mRanOffEnd.clear();
+}
+
+FSMessageReceiveThread::FSMessageReceiveThread(S32 socket, const std::map<U32, LLMessageTemplate*>& message_numbers)
+:   LLThread("Message receive"),
+    mSocket(socket),
+    mMessageNumbers(message_numbers),
+    mReady(MAX_PACKETS_IN_FLIGHT),
+    mFree(MAX_PACKETS_IN_FLIGHT),
+    mAllocated(0)
+{
+}
+
+FSMessageReceiveThread::~FSMessageReceiveThread()
+{
+    shutdown();
+
+    FSReceivedPacket* packet;
+    while ((packet = mReady.pop()))
+    {
+        delete packet;
+    }
+    while ((packet = mFree.pop()))
+    {
+        delete packet;
+    }
+}
+
+FSReceivedPacket* FSMessageReceiveThread::popPacket()
+{
+    return mReady.pop();
+}
+
+void FSMessageReceiveThread::recyclePacket(FSReceivedPacket* packet)
+{
+    // Never full, there are no more packets than slots
+    mFree.push(packet);
+}
+
+void FSMessageReceiveThread::run()
+{
+    FSReceivedPacket* packet = NULL;
+    while (!isQuitting())
+    {
+        if (!packet)
+        {
+            packet = mFree.pop();
+        }
+        if (!packet)
+        {
+            if (mAllocated >= (S32)mReady.capacity())
+            {
+                // The main thread is behind, let the socket buffer fill
+                ms_sleep(1);
+                continue;
+            }
+            packet = new FSReceivedPacket();
+            ++mAllocated;
+        }
+
+        packet->mTrueSize = LLPacketRing::receiveFromSocket(mSocket, (char*)packet->mTrueBuffer, packet->mSender, packet->mReceivingIF);
+        if (packet->mTrueSize <= 0)
+        {
+            waitForPacket(IDLE_WAIT_MS);
+            continue;
+        }
+
+        decode(packet);
+        mReady.push(packet);
+        packet = NULL;
+    }
+    delete packet;
+}
+
+// The same steps checkMessages() takes before it needs a circuit. Packets
+// it is going to reject are passed on undecoded so it can still count and
+// report them.
+void FSMessageReceiveThread::decode(FSReceivedPacket* packet)
+{
+    packet->clear();
+
+    U8* buffer = packet->mTrueBuffer;
+    S32 size = packet->mTrueSize;
+    packet->mSize = size;
+    if (size < (S32)LL_MINIMUM_VALID_PACKET_SIZE)
+    {
+        return;
+    }
+
+    if (buffer[0] & LL_ACK_FLAG)
+    {
+        S32 acks = buffer[--size];
+        if (size < (S32)(acks * sizeof(TPACKETID) + LL_MINIMUM_VALID_PACKET_SIZE))
+        {
+            return;
+        }
+        size -= acks * sizeof(TPACKETID);
+    }
+    packet->mSize = size;
+
+    if (buffer[0] & LL_ZERO_CODE_FLAG)
+    {
+        packet->mCompressedSize = size;
+        packet->mSize = zeroCodeExpand(buffer, size, packet->mExpandedBuffer, &packet->mExpandOverflows);
+        packet->mBuffer = packet->mExpandedBuffer;
+    }
+
+    LLTemplateMessageReader::predecodeMessage(mMessageNumbers, *packet);
+}
+
+bool FSMessageReceiveThread::waitForPacket(S32 timeout_ms)
+{
+    fd_set readable;
+    FD_ZERO(&readable);
+#if LL_WINDOWS
+    FD_SET((SOCKET)mSocket, &readable);
+#else
+    FD_SET(mSocket, &readable);
+#endif
+    timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = timeout_ms * 1000;
+    if (select(mSocket + 1, &readable, NULL, NULL, &timeout) < 0)
+    {
+        // Closed under us or interrupted; don't spin
+        ms_sleep(timeout_ms);
+        return false;
+    }
+    return FD_ISSET(mSocket, &readable) != 0;
+}
+
+// static
+S32 FSMessageReceiveThread::zeroCodeExpand(U8* data, S32 data_size, U8* out, S32* overflows)
+{
+    data[0] &= (~LL_ZERO_CODE_FLAG);
+
+    S32 count = data_size;
+    U8* inptr = data;
+    U8* outptr = out;
+
+    // skip the packet id field
+    for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
+    {
+        count--;
+        *outptr++ = *inptr++;
+    }
+
+    // sequential zero bytes are encoded as 0 [U8 count]
+    // with 0 0 [count] representing wrap (>256 zeroes)
+    while (count--)
+    {
+        if (outptr > (&out[MAX_BUFFER_SIZE - 1]))
+        {
+            LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 1" << LL_ENDL;
+            ++*overflows;
+            outptr = out;
+            break;
+        }
+        if (!((*outptr++ = *inptr++)))
+        {
+            while (((count--)) && (!(*inptr)))
+            {
+                *outptr++ = *inptr++;
+                if (outptr > (&out[MAX_BUFFER_SIZE - 256]))
+                {
+                    LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 2" << LL_ENDL;
+                    ++*overflows;
+                    outptr = out;
+                    count = -1;
+                    break;
+                }
+                memset(outptr, 0, 255);
+                outptr += 255;
+            }
+
+            if (count < 0)
+            {
+                break;
+            }
+            else
+            {
+                if (outptr > (&out[MAX_BUFFER_SIZE - (*inptr)]))
+                {
+                    LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 3" << LL_ENDL;
+                    ++*overflows;
+                    outptr = out;
+                }
+                memset(outptr, 0, (*inptr) - 1);
+                outptr += ((*inptr) - 1);
+                inptr++;
+            }
+        }
+    }
+
+    return (S32)(outptr - out);
+}
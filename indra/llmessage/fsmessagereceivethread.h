@@ -0,0 +1,170 @@
+/**
+ * @file fsmessagereceivethread.h
+ * @brief Receives and decodes template messages off the main thread.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_MESSAGERECEIVETHREAD_H
+#define FS_MESSAGERECEIVETHREAD_H
+
+#include "llatomic.h"
+#include "llhost.h"
+#include "llthread.h"
+#include "net.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+class LLMessageTemplate;
+class LLMsgData;
+
+/**
+ * Single producer, single consumer ring of pointers. One thread pushes,
+ * one other thread pops, neither blocks nor locks. Capacity is rounded
+ * up to a power of two.
+ */
+template <typename T>
+class FSSPSCRing
+{
+public:
+    FSSPSCRing(U32 capacity)
+    :   mHead(0),
+        mTail(0)
+    {
+        U32 size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        mSlots.resize(size, NULL);
+        mMask = size - 1;
+    }
+
+    // Producer only; false when full
+    bool push(T* item)
+    {
+        U32 tail = mTail.CurrentValue();
+        if (tail - mHead.CurrentValue() > mMask)
+        {
+            return false;
+        }
+        mSlots[tail & mMask] = item;
+        mTail = tail + 1;
+        return true;
+    }
+
+    // Consumer only; NULL when empty
+    T* pop()
+    {
+        U32 head = mHead.CurrentValue();
+        if (head == mTail.CurrentValue())
+        {
+            return NULL;
+        }
+        T* item = mSlots[head & mMask];
+        mHead = head + 1;
+        return item;
+    }
+
+    U32 size() const { return mTail.CurrentValue() - mHead.CurrentValue(); }
+    U32 capacity() const { return mMask + 1; }
+
+private:
+    std::vector<T*> mSlots;
+    U32             mMask;
+    LLAtomicU32     mHead;      // next slot to pop, written by the consumer
+    LLAtomicU32     mTail;      // next slot to push, written by the producer
+};
+
+/**
+ * A datagram as LLMessageSystem::checkMessages() would have read it, with
+ * the work that does not need circuits already done: appended acks are
+ * split off, zero coding is expanded and the message is decoded against
+ * its template. Nothing here changes once the receive thread hands it over.
+ */
+struct FSReceivedPacket
+{
+    FSReceivedPacket();
+    ~FSReceivedPacket();
+
+    // Drops the decoded message so the packet can be filled again
+    void clear();
+
+    U8                  mTrueBuffer[NET_BUFFER_SIZE];       // as received, acks and all
+    U8                  mExpandedBuffer[NET_BUFFER_SIZE];
+    S32                 mTrueSize;
+    LLHost              mSender;
+    LLHost              mReceivingIF;
+
+    U8*                 mBuffer;            // the message: mTrueBuffer or mExpandedBuffer
+    S32                 mSize;
+    S32                 mCompressedSize;    // size before expansion, 0 if not zero coded
+    S32                 mExpandOverflows;   // MX_WROTE_PAST_BUFFER_SIZE to raise
+
+    LLMessageTemplate*  mTemplate;          // NULL when not decoded
+    LLMsgData*          mData;              // owned until LLTemplateMessageReader takes it
+    std::vector<std::pair<S32, S32> > mRanOffEnd;   // decode position and bytes wanted
+};
+
+/**
+ * Reads the message socket for LLMessageSystem, so the main thread no
+ * longer expands and decodes packets inside the frame. Packets come back
+ * from popPacket() in the order they arrived; acks, circuits, trust checks
+ * and handlers all still run in checkMessages() on the main thread. So do
+ * the inbound throttle, its statistics and simulated packet loss of
+ * LLPacketRing, the thread only reads the socket.
+ */
+class FSMessageReceiveThread : public LLThread
+{
+public:
+    FSMessageReceiveThread(S32 socket, const std::map<U32, LLMessageTemplate*>& message_numbers);
+    ~FSMessageReceiveThread();
+
+    // Main thread. NULL when nothing is waiting.
+    FSReceivedPacket* popPacket();
+    // Main thread. Hands a popped packet back for reuse.
+    void recyclePacket(FSReceivedPacket* packet);
+
+    // Zero code expansion of LLMessageSystem::zeroCodeExpand(), without
+    // the statistics. Clears LL_ZERO_CODE_FLAG in data, writes the packet
+    // to out (NET_BUFFER_SIZE bytes) and returns its size. Overflowing out
+    // truncates and counts into overflows as the original did.
+    static S32 zeroCodeExpand(U8* data, S32 data_size, U8* out, S32* overflows);
+
+protected:
+    /*virtual*/ void run();
+
+private:
+    void decode(FSReceivedPacket* packet);
+    bool waitForPacket(S32 timeout_ms);
+
+    S32                         mSocket;
+    const std::map<U32, LLMessageTemplate*>& mMessageNumbers;  // LLMessageSystem's, read only once built
+    FSSPSCRing<FSReceivedPacket> mReady;            // thread to main
+    FSSPSCRing<FSReceivedPacket> mFree;             // main to thread
+    S32                         mAllocated;         // packets in circulation, touched by the thread only
+};
+
+#endif // FS_MESSAGERECEIVETHREAD_H
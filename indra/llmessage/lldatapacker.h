@@ -174,6 +174,7 @@ public:
 				void		reset()				{ mCurBufferp = mBufferp; mWriteEnabled = (mCurBufferp != NULL); }
 				void        shift(S32 offset)   { reset(); mCurBufferp += offset;}
 				void		freeBuffer()		{ delete [] mBufferp; mBufferp = mCurBufferp = NULL; mBufferSize = 0; mWriteEnabled = FALSE; }
+				void		releaseBuffer()		{ mBufferp = mCurBufferp = NULL; mBufferSize = 0; mWriteEnabled = FALSE; } // <FS/> Forget a buffer owned elsewhere
 				void		assignBuffer(U8 *bufferp, S32 size)
 				{
 					if(mBufferp && mBufferp != bufferp)
@@ -224,52 +224,98 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 	else
 	{
 		// no delay, pull straight from net
-		if (LLProxy::isSOCKSProxyEnabled())
-		{
-			U8 buffer[NET_BUFFER_SIZE + SOCKS_HEADER_SIZE];
-			packet_size = receive_packet(socket, static_cast<char*>(static_cast<void*>(buffer)));
-			
-			if (packet_size > SOCKS_HEADER_SIZE)
-			{
-				// *FIX We are assuming ATYP is 0x01 (IPv4), not 0x03 (hostname) or 0x04 (IPv6)
-				memcpy(datap, buffer + SOCKS_HEADER_SIZE, packet_size - SOCKS_HEADER_SIZE);
-				proxywrap_t * header = static_cast<proxywrap_t*>(static_cast<void*>(buffer));
-				mLastSender.setAddress(header->addr);
-				mLastSender.setPort(ntohs(header->port));
+		// <FS> Threaded message receive, the socket read moved to receiveFromSocket()
+		packet_size = receiveFromSocket(socket, datap, mLastSender, mLastReceivingIF);
 
-				packet_size -= SOCKS_HEADER_SIZE; // The unwrapped packet size
-			}
-			else
+		if (packet_size)  // did we actually get a packet?
+		{
+			//if (mDropPercentage && (ll_frand(100.f) < mDropPercentage))
+			//{
+			//	mPacketsToDrop++;
+			//}
+			//
+			//if (mPacketsToDrop)
+			//{
+			//	packet_size = 0;
+			//	mPacketsToDrop--;
+			//}
+			if (dropReceivedPacket(packet_size))
 			{
 				packet_size = 0;
 			}
 		}
-		else
-		{
-			packet_size = receive_packet(socket, datap);
-			mLastSender = ::get_sender();
-		}
+		// </FS>
+	}
 
-		mLastReceivingIF = ::get_receiving_interface();
+	return packet_size;
+}
 
-		if (packet_size)  // did we actually get a packet?
+// <FS> Threaded message receive
+// static
+S32 LLPacketRing::receiveFromSocket(S32 socket, char *datap, LLHost& sender, LLHost& receiving_if)
+{
+	S32 packet_size = 0;
+	if (LLProxy::isSOCKSProxyEnabled())
+	{
+		U8 buffer[NET_BUFFER_SIZE + SOCKS_HEADER_SIZE];
+		packet_size = receive_packet(socket, static_cast<char*>(static_cast<void*>(buffer)));
+		
+		if (packet_size > SOCKS_HEADER_SIZE)
 		{
-			if (mDropPercentage && (ll_frand(100.f) < mDropPercentage))
-			{
-				mPacketsToDrop++;
-			}
+			// *FIX We are assuming ATYP is 0x01 (IPv4), not 0x03 (hostname) or 0x04 (IPv6)
+			memcpy(datap, buffer + SOCKS_HEADER_SIZE, packet_size - SOCKS_HEADER_SIZE);
+			proxywrap_t * header = static_cast<proxywrap_t*>(static_cast<void*>(buffer));
+			sender.setAddress(header->addr);
+			sender.setPort(ntohs(header->port));
 
-			if (mPacketsToDrop)
-			{
-				packet_size = 0;
-				mPacketsToDrop--;
-			}
+			packet_size -= SOCKS_HEADER_SIZE; // The unwrapped packet size
+		}
+		else
+		{
+			packet_size = 0;
 		}
 	}
+	else
+	{
+		packet_size = receive_packet(socket, datap);
+		sender = ::get_sender();
+	}
 
+	receiving_if = ::get_receiving_interface();
 	return packet_size;
 }
 
+BOOL LLPacketRing::canReceivePacket()
+{
+	return !mUseInThrottle || !mInThrottle.checkOverflow(0);
+}
+
+BOOL LLPacketRing::dropReceivedPacket(S32 packet_size)
+{
+	if (mUseInThrottle)
+	{
+		mActualBitsIn += packet_size * 8;
+	}
+
+	if (mDropPercentage && (ll_frand(100.f) < mDropPercentage))
+	{
+		mPacketsToDrop++;
+	}
+
+	if (mPacketsToDrop)
+	{
+		mPacketsToDrop--;
+		return TRUE;
+	}
+
+	if (mUseInThrottle)
+	{
+		mInThrottle.throttleOverflow(packet_size * 8.f);
+	}
+	return FALSE;
+}
+// </FS>
+
 BOOL LLPacketRing::sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host)
 {
 	BOOL status = TRUE;
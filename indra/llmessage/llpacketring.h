@@ -53,6 +53,18 @@ public:
 	S32  receivePacket (S32 socket, char *datap);
 	S32  receiveFromRing (S32 socket, char *datap);
 
+	// <FS> Threaded message receive
+	// Reads one datagram from the socket, SOCKS wrapped or not, without
+	// touching any ring state. Safe to call from the receive thread.
+	static S32 receiveFromSocket(S32 socket, char *datap, LLHost& sender, LLHost& receiving_if);
+	// Main thread, for packets the receive thread read: the inbound
+	// throttle, bit count and simulated packet loss still apply here.
+	// FALSE while the throttle holds packets back.
+	BOOL canReceivePacket();
+	// TRUE when simulated packet loss drops the packet
+	BOOL dropReceivedPacket(S32 packet_size);
+	// </FS>
+
 	BOOL sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host);
 
 	inline LLHost getLastSender();
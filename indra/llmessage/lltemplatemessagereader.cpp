@@ -39,6 +39,7 @@
 #include "v4math.h"
 
 #include "nd/ndexceptions.h" // <FS:ND/> For ndxran
+#include "fsmessagereceivethread.h" // <FS/> Threaded message receive
 
 LLTemplateMessageReader::LLTemplateMessageReader(message_template_number_map_t&
 												 number_template_map) :
@@ -449,13 +450,28 @@ BOOL LLTemplateMessageReader::decodeTemplate(
 		const U8* buffer, S32 buffer_size,  // inputs
 		LLMessageTemplate** msg_template ) // outputs
 {
+	// <FS> Threaded message receive
+	LLMessageTemplate* temp = findTemplate(mMessageNumbers, buffer, buffer_size);
+	if (!temp)
+	{
+		return(FALSE);
+	}
+	*msg_template = temp;
+	return(TRUE);
+}
+
+// static
+LLMessageTemplate* LLTemplateMessageReader::findTemplate(const message_template_number_map_t& message_numbers,
+														 const U8* buffer, S32 buffer_size)
+{
+	// </FS>
 	const U8* header = buffer + LL_PACKET_ID_SIZE;
 
 	// is there a message ready to go?
 	if (buffer_size <= 0)
 	{
 		LL_WARNS() << "No message waiting for decode!" << LL_ENDL;
-		return(FALSE);
+		return NULL;	// <FS/> Threaded message receive
 	}
 
 	U32 num = 0;
@@ -491,24 +507,27 @@ BOOL LLTemplateMessageReader::decodeTemplate(
 	{
 		LL_WARNS() << "Packet with unusable length received (too short): "
 				<< buffer_size << LL_ENDL;
-		return(FALSE);
+		return NULL;	// <FS/> Threaded message receive
 	}
 
-	LLMessageTemplate* temp = get_ptr_in_map(mMessageNumbers,num);
-	if (temp)
-	{
-		*msg_template = temp;
-	}
-	else
+	//LLMessageTemplate* temp = get_ptr_in_map(mMessageNumbers,num);
+	LLMessageTemplate* temp = get_ptr_in_map(message_numbers,num);	// <FS/> Threaded message receive
+	//if (temp)
+	//{
+	//	*msg_template = temp;
+	//}
+	//else
+	if (!temp)	// <FS/> Threaded message receive
 	{
         // MAINT-7482 - make viewer more tolerant of unknown messages.
 		LL_WARNS_ONCE() << "Message #" << std::hex << num << std::dec
                         << " received but not registered!" << LL_ENDL;
 		//gMessageSystem->callExceptionFunc(MX_UNREGISTERED_MESSAGE);
-		return(FALSE);
+		//return(FALSE);
 	}
 
-	return(TRUE);
+	//return(TRUE);
+	return temp;	// <FS/> Threaded message receive
 }
 
 void LLTemplateMessageReader::logRanOffEndOfPacket( const LLHost& host, const S32 where, const S32 wanted )
@@ -540,18 +559,29 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 	llassert( !mCurrentRMessageData );
 	delete mCurrentRMessageData; // just to make sure
 
+	// <FS> Threaded message receive
+	ran_off_end_t ran_off_end;
+	mCurrentRMessageData = decodeMessageData(mCurrentRMessageTemplate, buffer, mReceiveSize, ran_off_end);
+	return dispatchMessage(sender, ran_off_end);
+}
+
+// static
+LLMsgData* LLTemplateMessageReader::decodeMessageData(const LLMessageTemplate* msg_template, const U8* buffer, S32 receive_size,
+													  ran_off_end_t& ran_off_end)
+{
+	// </FS>
 	// The offset tells us how may bytes to skip after the end of the
 	// message name.
 	U8 offset = buffer[PHL_OFFSET];
-	S32 decode_pos = LL_PACKET_ID_SIZE + (S32)(mCurrentRMessageTemplate->mFrequency) + offset;
+	S32 decode_pos = LL_PACKET_ID_SIZE + (S32)(msg_template->mFrequency) + offset;
 
 	// create base working data set
-	mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
+	LLMsgData* msg_data = new LLMsgData(msg_template->mName);
 	
 	// loop through the template building the data structure as we go
 	LLMessageTemplate::message_block_map_t::const_iterator iter;
-	for(iter = mCurrentRMessageTemplate->mMemberBlocks.begin();
-		iter != mCurrentRMessageTemplate->mMemberBlocks.end();
+	for(iter = msg_template->mMemberBlocks.begin();
+		iter != msg_template->mMemberBlocks.end();
 		++iter)
 	{
 		LLMessageBlock* mbci = *iter;
@@ -574,7 +604,7 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 		{
 			// need to read the number from the message
 			// repeat number is a single byte
-			if (decode_pos >= mReceiveSize)
+			if (decode_pos >= receive_size)
 			{
 				// commented out - hetgrid says that missing variable blocks
 				// at end of message are legal
@@ -592,7 +622,7 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 		else
 		{
 			LL_ERRS() << "Unknown block type" << LL_ENDL;
-			return FALSE;
+			return msg_data;
 		}
 
 		LLMsgBlkData* cur_data_block = NULL;
@@ -613,7 +643,7 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 			}
 
 			// add the block to the message
-			mCurrentRMessageData->addBlock(cur_data_block);
+			msg_data->addBlock(cur_data_block);
 
 			// now read the variables
 			for (LLMessageBlock::message_variable_map_t::const_iterator iter = 
@@ -635,9 +665,9 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 					U16 tsizeh = 0;
 					U32 tsize = 0;
 
-					if ((decode_pos + data_size) > mReceiveSize)
+					if ((decode_pos + data_size) > receive_size)
 					{
-						logRanOffEndOfPacket(sender, decode_pos, data_size);
+						ran_off_end.push_back(std::make_pair(decode_pos, data_size));
 
 						// default to 0 length variable blocks
 						tsize = 0;
@@ -671,9 +701,9 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 				{
 					// fixed!
 					// so, copy data pointer and set data size to fixed size
-					if ((decode_pos + mvci.getSize()) > mReceiveSize)
+					if ((decode_pos + mvci.getSize()) > receive_size)
 					{
-						logRanOffEndOfPacket(sender, decode_pos, mvci.getSize());
+						ran_off_end.push_back(std::make_pair(decode_pos, mvci.getSize()));
 
 						// default to 0s.
 						U32 size = mvci.getSize();
@@ -694,6 +724,18 @@ BOOL LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
 		}
 	}
 
+	return msg_data;	// <FS/> Threaded message receive
+}
+
+// <FS> Threaded message receive
+BOOL LLTemplateMessageReader::dispatchMessage(const LLHost& sender, const ran_off_end_t& ran_off_end)
+{
+	for (ran_off_end_t::const_iterator iter = ran_off_end.begin(); iter != ran_off_end.end(); ++iter)
+	{
+		logRanOffEndOfPacket(sender, iter->first, iter->second);
+	}
+	// </FS>
+
 	if (mCurrentRMessageData->mMemberBlocks.empty()
 		&& !mCurrentRMessageTemplate->mMemberBlocks.empty())
 	{
@@ -760,6 +802,14 @@ BOOL LLTemplateMessageReader::validateMessage(const U8* buffer,
 {
 	mReceiveSize = buffer_size;
 	BOOL valid = decodeTemplate(buffer, buffer_size, &mCurrentRMessageTemplate );
+	// <FS> Threaded message receive
+	return valid && validateTemplate(sender, trusted);
+}
+
+BOOL LLTemplateMessageReader::validateTemplate(const LLHost& sender, bool trusted)
+{
+	BOOL valid = TRUE;
+	// </FS>
 	if(valid)
 	{
 		mCurrentRMessageTemplate->mReceiveCount++;
@@ -795,6 +845,43 @@ BOOL LLTemplateMessageReader::readMessage(const U8* buffer,
 	return decodeData(buffer, sender);
 }
 
+// <FS> Threaded message receive
+// static
+void LLTemplateMessageReader::predecodeMessage(const message_template_number_map_t& message_numbers, FSReceivedPacket& packet)
+{
+	packet.mTemplate = findTemplate(message_numbers, packet.mBuffer, packet.mSize);
+	if (packet.mTemplate)
+	{
+		packet.mData = decodeMessageData(packet.mTemplate, packet.mBuffer, packet.mSize, packet.mRanOffEnd);
+	}
+}
+
+BOOL LLTemplateMessageReader::validateMessage(const FSReceivedPacket& packet,
+											  const LLHost& sender,
+											  bool trusted)
+{
+	mReceiveSize = packet.mSize;
+	mCurrentRMessageTemplate = packet.mTemplate;
+	return mCurrentRMessageTemplate && validateTemplate(sender, trusted);
+}
+
+BOOL LLTemplateMessageReader::readMessage(FSReceivedPacket& packet,
+										  const LLHost& sender)
+{
+	llassert( mCurrentRMessageTemplate == packet.mTemplate );
+	llassert( !mCurrentRMessageData );
+	delete mCurrentRMessageData;
+
+	mCurrentRMessageData = packet.mData;
+	packet.mData = NULL;
+	if (!mCurrentRMessageData)
+	{
+		return FALSE;
+	}
+	return dispatchMessage(sender, packet.mRanOffEnd);
+}
+// </FS>
+
 //virtual 
 const char* LLTemplateMessageReader::getMessageName() const
 {
@@ -30,9 +30,11 @@
 #include "llmessagereader.h"
 
 #include <map>
+#include <vector>	// <FS/> Threaded message receive
 
 class LLMessageTemplate;
 class LLMsgData;
+struct FSReceivedPacket;	// <FS/> Threaded message receive
 
 class LLTemplateMessageReader : public LLMessageReader
 {
@@ -102,6 +104,15 @@ public:
 						 const LLHost& sender, bool trusted = false);
 	BOOL readMessage(const U8* buffer, const LLHost& sender);
 
+	// <FS> Threaded message receive
+	// Receive thread: finds the template and decodes the message into packet
+	static void predecodeMessage(const message_template_number_map_t& message_numbers, FSReceivedPacket& packet);
+	// Main thread: validateMessage() and readMessage() for a predecoded
+	// packet. readMessage() takes the decoded message from the packet.
+	BOOL validateMessage(const FSReceivedPacket& packet, const LLHost& sender, bool trusted = false);
+	BOOL readMessage(FSReceivedPacket& packet, const LLHost& sender);
+	// </FS>
+
 	bool isTrusted() const;
 	bool isBanned(bool trusted_source) const;
 	bool isUdpBanned() const;
@@ -113,11 +124,25 @@ private:
 
 	BOOL decodeTemplate(const U8* buffer, S32 buffer_size,  // inputs
 						LLMessageTemplate** msg_template ); // outputs
+	// <FS> Threaded message receive
+	static LLMessageTemplate* findTemplate(const message_template_number_map_t& message_numbers,
+										   const U8* buffer, S32 buffer_size);
+	// </FS>
 
 	void logRanOffEndOfPacket( const LLHost& host, const S32 where, const S32 wanted );
 
 	BOOL decodeData(const U8* buffer, const LLHost& sender );
 
+	// <FS> Threaded message receive
+	// decodeData() in two halves: building the message data touches
+	// nothing but the template, so it can run on any thread
+	typedef std::vector<std::pair<S32, S32> > ran_off_end_t;	// decode position, bytes wanted
+	static LLMsgData* decodeMessageData(const LLMessageTemplate* msg_template, const U8* buffer, S32 receive_size,
+										ran_off_end_t& ran_off_end);
+	BOOL dispatchMessage(const LLHost& sender, const ran_off_end_t& ran_off_end);
+	BOOL validateTemplate(const LLHost& sender, bool trusted);
+	// </FS>
+
 	S32	mReceiveSize;
 	LLMessageTemplate* mCurrentRMessageTemplate;
 	LLMsgData* mCurrentRMessageData;
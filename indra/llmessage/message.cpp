@@ -79,6 +79,7 @@
 #include "llpounceable.h"
 
 #include "nd/ndexceptions.h" // <FS:ND/> For ndxran
+#include "fsmessagereceivethread.h" // <FS/> Threaded message receive
 
 // Constants
 //const char* MESSAGE_LOG_FILENAME = "message.log";
@@ -184,6 +185,7 @@ void LLMessageSystem::init()
 
 	mIncomingCompressedSize = 0;
 	mCurrentRecvPacketID = 0;
+	mReceiveThread = NULL;	// <FS/> Threaded message receive
 
 	mMessageFileVersionNumber = 0.f;
 
@@ -320,6 +322,8 @@ void LLMessageSystem::loadTemplateFile(const std::string& filename, bool failure
 
 LLMessageSystem::~LLMessageSystem()
 {
+	stopReceiveThread();	// <FS/> Threaded message receive, before its templates go
+
 	mMessageTemplates.clear(); // don't delete templates.
 	for_each(mMessageNumbers.begin(), mMessageNumbers.end(), DeletePairedPointer());
 	mMessageNumbers.clear();
@@ -501,6 +505,7 @@ BOOL LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 	// loop until either no packets or a valid packet
 	// i.e., burn through packets from unregistered circuits
 	S32 receive_size = 0;
+	FSReceivedPacket* packet = NULL;	// <FS/> Threaded message receive
 	do
 	{
 		clearReceiveState();
@@ -511,7 +516,38 @@ BOOL LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 		S32 true_rcv_size = 0;
 
 		U8* buffer = mTrueReceiveBuffer;
+		U8* true_buffer = mTrueReceiveBuffer;	// <FS/> Threaded message receive
 		
+		// <FS> Threaded message receive
+		if (mReceiveThread)
+		{
+			// The thread already read, expanded and decoded it. The inbound
+			// throttle and simulated packet loss apply here, as they would
+			// in receivePacket().
+			if (packet)
+			{
+				mReceiveThread->recyclePacket(packet);
+			}
+			packet = mPacketRing.canReceivePacket() ? mReceiveThread->popPacket() : NULL;
+			if (packet && mPacketRing.dropReceivedPacket(packet->mTrueSize))
+			{
+				mReceiveThread->recyclePacket(packet);
+				packet = NULL;
+			}
+			mTrueReceiveSize = packet ? packet->mTrueSize : 0;
+			receive_size = mTrueReceiveSize;
+			if (packet)
+			{
+				// Kept for dumpPacketToLog()
+				memcpy(mTrueReceiveBuffer, packet->mTrueBuffer, packet->mTrueSize);	/* Flawfinder: ignore */
+				buffer = true_buffer = packet->mTrueBuffer;
+				mLastSender = packet->mSender;
+				mLastReceivingIF = packet->mReceivingIF;
+			}
+		}
+		else
+		{
+		// </FS>
 		mTrueReceiveSize = mPacketRing.receivePacket(mSocket, (char *)mTrueReceiveBuffer);
 		// If you want to dump all received packets into SecondLife.log, uncomment this
 		//dumpPacketToLog();
@@ -519,6 +555,7 @@ BOOL LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 		receive_size = mTrueReceiveSize;
 		mLastSender = mPacketRing.getLastSender();
 		mLastReceivingIF = mPacketRing.getLastReceivingInterface();
+		} // <FS/> Threaded message receive
 		
 		if (receive_size < (S32) LL_MINIMUM_VALID_PACKET_SIZE)
 		{
@@ -559,7 +596,17 @@ BOOL LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 			}
 
 			// process the message as normal
-			mIncomingCompressedSize = zeroCodeExpand(&buffer, &receive_size);
+			// <FS> Threaded message receive
+			//mIncomingCompressedSize = zeroCodeExpand(&buffer, &receive_size);
+			if (packet)
+			{
+				mIncomingCompressedSize = zeroCodeExpanded(*packet, &buffer, &receive_size);
+			}
+			else
+			{
+				mIncomingCompressedSize = zeroCodeExpand(&buffer, &receive_size);
+			}
+			// </FS>
 			mCurrentRecvPacketID = ntohl(*((U32*)(&buffer[1])));
 			host = getSender();
 
@@ -577,8 +624,10 @@ BOOL LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 				for(S32 i = 0; i < acks; ++i)
 				{
 					true_rcv_size -= sizeof(TPACKETID);
-					memcpy(&mem_id, &mTrueReceiveBuffer[true_rcv_size], /* Flawfinder: ignore*/
-					     sizeof(TPACKETID));
+					//memcpy(&mem_id, &mTrueReceiveBuffer[true_rcv_size], /* Flawfinder: ignore*/
+					//     sizeof(TPACKETID));
+					memcpy(&mem_id, &true_buffer[true_rcv_size], /* Flawfinder: ignore*/
+					     sizeof(TPACKETID));	// <FS/> Threaded message receive
 					packet_id = ntohl(mem_id);
 					//LL_INFOS("Messaging") << "got ack: " << packet_id << LL_ENDL;
 					cdp->ackReliablePacket(packet_id);
@@ -643,11 +692,25 @@ BOOL LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 			// But we don't want to acknowledge UseCircuitCode until the circuit is
 			// available, which is why the acknowledgement test is done above.  JC
 			bool trusted = cdp && cdp->getTrusted();
-			valid_packet = mTemplateMessageReader->validateMessage(
-				buffer,
-				receive_size,
-				host,
-				trusted);
+			// <FS> Threaded message receive
+			//valid_packet = mTemplateMessageReader->validateMessage(
+			//	buffer,
+			//	receive_size,
+			//	host,
+			//	trusted);
+			if (packet)
+			{
+				valid_packet = mTemplateMessageReader->validateMessage(*packet, host, trusted);
+			}
+			else
+			{
+				valid_packet = mTemplateMessageReader->validateMessage(
+					buffer,
+					receive_size,
+					host,
+					trusted);
+			}
+			// </FS>
 			if (!valid_packet)
 			{
 				clearReceiveState();
@@ -687,7 +750,14 @@ BOOL LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 				
 				// valid_packet = mTemplateMessageReader->readMessage(buffer, host);
 				
-				try { valid_packet = mTemplateMessageReader->readMessage(buffer, host); }
+				//try { valid_packet = mTemplateMessageReader->readMessage(buffer, host); }
+				// <FS> Threaded message receive
+				try
+				{
+					valid_packet = packet ? mTemplateMessageReader->readMessage(*packet, host)
+										  : mTemplateMessageReader->readMessage(buffer, host);
+				}
+				// </FS>
 				catch( nd::exceptions::xran &ex ) { LL_WARNS() << ex.what() << LL_ENDL; }
 
 				// </FS:ND>
@@ -729,6 +799,13 @@ BOOL LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 		}
 	} while (!valid_packet && receive_size > 0);
 
+	// <FS> Threaded message receive
+	if (packet)
+	{
+		mReceiveThread->recyclePacket(packet);
+	}
+	// </FS>
+
 	F64Seconds mt_sec = getMessageTimeSeconds();
 	// Check to see if we need to print debug info
 	if ((mt_sec - mCircuitPrintTime) > mCircuitPrintFreq)
@@ -2846,78 +2923,70 @@ S32 LLMessageSystem::zeroCodeExpand(U8** data, S32* data_size)
 	mCompressedPacketsIn++;
 	mCompressedBytesIn += *data_size;
 	
-	*data[0] &= (~LL_ZERO_CODE_FLAG);
+	// <FS> Threaded message receive
+	// The expansion moved to FSMessageReceiveThread::zeroCodeExpand() so
+	// the receive thread runs the same code
+	S32 overflows = 0;
+	*data_size = FSMessageReceiveThread::zeroCodeExpand(*data, in_size, mEncodedRecvBuffer, &overflows);
+	*data = mEncodedRecvBuffer;
+	for (S32 i = 0; i < overflows; ++i)
+	{
+		callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
+	}
+	// </FS>
+	mUncompressedBytesIn += *data_size;
 
-	S32 count = (*data_size);  
-	
-	U8 *inptr = (U8 *)*data;
-	U8 *outptr = (U8 *)mEncodedRecvBuffer;
+	return(in_size);
+}
 
-// skip the packet id field
+// <FS> Threaded message receive
+// zeroCodeExpand() for a packet the receive thread already expanded
+S32 LLMessageSystem::zeroCodeExpanded(const FSReceivedPacket& packet, U8** data, S32* data_size)
+{
+	mTotalBytesIn += *data_size;
 
-	for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
+	if (!packet.mCompressedSize)
 	{
-		count--;
-		*outptr++ = *inptr++;
+		return 0;
 	}
 
-// reconstruct encoded packet, keeping track of net size gain
-
-// sequential zero bytes are encoded as 0 [U8 count] 
-// with 0 0 [count] representing wrap (>256 zeroes)
+	mCompressedPacketsIn++;
+	mCompressedBytesIn += *data_size;
 
-	while (count--)
+	for (S32 i = 0; i < packet.mExpandOverflows; ++i)
 	{
-		if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-1]))
-		{
-			LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 1" << LL_ENDL;
-			callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-			outptr = mEncodedRecvBuffer;					
-			break;
-		}
-		if (!((*outptr++ = *inptr++)))
-		{
-			while (((count--)) && (!(*inptr)))
-			{
-				*outptr++ = *inptr++;
-  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-256]))
-  				{
-  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 2" << LL_ENDL;
-					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-					outptr = mEncodedRecvBuffer;
-					count = -1;
-					break;
-  				}
-				memset(outptr,0,255);
-				outptr += 255;
-			}
-			
-			if (count < 0)
-			{
-				break;
-			}
-
-			else
-			{
-  				if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-(*inptr)]))
-				{
-  					LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 3" << LL_ENDL;
-					callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-					outptr = mEncodedRecvBuffer;					
-				}
-				memset(outptr,0,(*inptr) - 1);
-				outptr += ((*inptr) - 1);
-				inptr++;
-			}
-		}		
+		callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
 	}
-	
-	*data = mEncodedRecvBuffer;
-	*data_size = (S32)(outptr - mEncodedRecvBuffer);
+
+	*data = packet.mBuffer;
+	*data_size = packet.mSize;
 	mUncompressedBytesIn += *data_size;
 
-	return(in_size);
+	return packet.mCompressedSize;
+}
+
+void LLMessageSystem::startReceiveThread()
+{
+	if (mReceiveThread || mbError)
+	{
+		return;
+	}
+	LL_INFOS("Messaging") << "Receiving messages on a thread" << LL_ENDL;
+	mReceiveThread = new FSMessageReceiveThread(mSocket, mMessageNumbers);
+	mReceiveThread->start();
+}
+
+void LLMessageSystem::stopReceiveThread()
+{
+	if (!mReceiveThread)
+	{
+		return;
+	}
+	// Packets still queued are dropped like ones left in the socket
+	delete mReceiveThread;
+	mReceiveThread = NULL;
 }
+// </FS>
 
 
 void LLMessageSystem::addTemplate(LLMessageTemplate *templatep)
@@ -3336,7 +3405,10 @@ void LLMessageSystem::establishBidirectionalTrust(const LLHost &host, S64 frame_
 
 void LLMessageSystem::dumpPacketToLog()
 {
-	LL_WARNS("Messaging") << "Packet Dump from:" << mPacketRing.getLastSender() << LL_ENDL;
+	// <FS> Threaded message receive, the ring's sender is not updated then
+	//LL_WARNS("Messaging") << "Packet Dump from:" << mPacketRing.getLastSender() << LL_ENDL;
+	LL_WARNS("Messaging") << "Packet Dump from:" << mLastSender << LL_ENDL;
+	// </FS>
 	LL_WARNS("Messaging") << "Packet Size:" << mTrueReceiveSize << LL_ENDL;
 	char line_buffer[256];		/* Flawfinder: ignore */
 	S32 i;
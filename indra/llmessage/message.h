@@ -185,6 +185,8 @@ class LLSDMessageBuilder;
 class LLMessageReader;
 class LLTemplateMessageReader;
 class LLSDMessageReader;
+class FSMessageReceiveThread;	// <FS/> Threaded message receive
+struct FSReceivedPacket;		// <FS/> Threaded message receive
 
 
 
@@ -415,6 +417,14 @@ public:
 
 	BOOL	poll(F32 seconds); // Number of seconds that we want to block waiting for data, returns if data was received
 	BOOL	checkMessages(LockMessageChecker&, S64 frame_count = 0 );
+
+	// <FS> Threaded message receive
+	// Moves socket reads, zero code expansion and message decoding to a
+	// thread, leaving checkMessages() with circuits, acks and handlers.
+	void	startReceiveThread();
+	void	stopReceiveThread();
+	bool	isReceiveThreaded() const { return mReceiveThread != NULL; }
+	// </FS>
 	void	processAcks(LockMessageChecker&, F32 collect_time = 0.f);
 
 	BOOL	isMessageFast(const char *msg);
@@ -537,6 +547,7 @@ public:
 
 	S32     zeroCode(U8 **data, S32 *data_size);
 	S32		zeroCodeExpand(U8 **data, S32 *data_size);
+	S32		zeroCodeExpanded(const FSReceivedPacket& packet, U8 **data, S32 *data_size);	// <FS/> Threaded message receive
 	S32		zeroCodeAdjustCurrentSendTotal();
 
 	// Uses ping-based retry
@@ -863,6 +874,8 @@ private:
 	U8	mTrueReceiveBuffer[MAX_BUFFER_SIZE];
 	S32	mTrueReceiveSize;
 
+	FSMessageReceiveThread* mReceiveThread;		// <FS/> Threaded message receive
+
 	// Must be valid during decode
 	
 	BOOL	mbError;
@@ -0,0 +1,282 @@
+/**
+ * @file fsmessagereceivethread_test.cpp
+ * @brief Tests for FSMessageReceiveThread and its packet rings.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../fsmessagereceivethread.h"
+
+#include "llpacketring.h"
+#include "lltemplatemessagereader.h"
+#include "lltimer.h"
+#include "message.h"
+
+#include <deque>
+
+#if !LL_WINDOWS
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <unistd.h>
+#endif
+
+#include "../test/lltut.h"
+
+#include "llhost.cpp" // Needed for copy operator
+#include "net.cpp" // Needed by LLHost.
+
+// test doubles: the thread reads these datagrams instead of the socket
+namespace
+{
+    LLMutex* gPacketsMutex = NULL;
+    std::deque<std::vector<U8> > gPackets;
+    LLAtomicU32 gPredecoded;
+}
+
+// static
+S32 LLPacketRing::receiveFromSocket(S32 socket, char* datap, LLHost& sender, LLHost& receiving_if)
+{
+    LLMutexLock lock(gPacketsMutex);
+    if (gPackets.empty())
+    {
+        return 0;
+    }
+    std::vector<U8>& packet = gPackets.front();
+    memcpy(datap, &packet[0], packet.size());
+    S32 size = (S32)packet.size();
+    gPackets.pop_front();
+    return size;
+}
+
+// static
+void LLTemplateMessageReader::predecodeMessage(const message_template_number_map_t&, FSReceivedPacket& packet)
+{
+    gPredecoded = gPredecoded.CurrentValue() + 1;
+}
+
+namespace
+{
+    class RingProducer : public LLThread
+    {
+    public:
+        RingProducer(FSSPSCRing<U32>& ring, std::vector<U32>& items)
+        :   LLThread("Ring producer"),
+            mRing(ring),
+            mItems(items)
+        {
+        }
+
+        /*virtual*/ void run()
+        {
+            for (size_t i = 0; i < mItems.size(); ++i)
+            {
+                while (!mRing.push(&mItems[i]))
+                {
+                    ms_sleep(0);
+                }
+            }
+        }
+
+    private:
+        FSSPSCRing<U32>&    mRing;
+        std::vector<U32>&   mItems;
+    };
+}
+
+namespace tut
+{
+    struct FSMessageReceiveThreadFixture
+    {
+        FSMessageReceiveThreadFixture()
+        {
+            gPacketsMutex = new LLMutex();
+            gPackets.clear();
+            gPredecoded = 0;
+        }
+
+        ~FSMessageReceiveThreadFixture()
+        {
+            delete gPacketsMutex;
+            gPacketsMutex = NULL;
+        }
+    };
+    typedef test_group<FSMessageReceiveThreadFixture> FSMessageReceiveThreadTest_factory;
+    typedef FSMessageReceiveThreadTest_factory::object FSMessageReceiveThreadTest_t;
+    FSMessageReceiveThreadTest_factory tf("FSMessageReceiveThread");
+
+    // The ring keeps order and refuses to overfill
+    template<> template<>
+    void FSMessageReceiveThreadTest_t::test<1>()
+    {
+        FSSPSCRing<U32> small(5);
+        ensure_equals("rounded up", small.capacity(), 8U);
+        U32 values[9];
+        for (U32 i = 0; i < 8; ++i)
+        {
+            ensure("push", small.push(&values[i]));
+        }
+        ensure("full", !small.push(&values[8]));
+        ensure_equals("size", small.size(), 8U);
+        for (U32 i = 0; i < 8; ++i)
+        {
+            ensure("in order", small.pop() == &values[i]);
+        }
+        ensure("empty", small.pop() == NULL);
+
+        // across threads
+        std::vector<U32> items(100000);
+        for (U32 i = 0; i < items.size(); ++i)
+        {
+            items[i] = i;
+        }
+        FSSPSCRing<U32> ring(64);
+        RingProducer producer(ring, items);
+        producer.start();
+        for (U32 i = 0; i < items.size(); ++i)
+        {
+            U32* item;
+            while (!(item = ring.pop()))
+            {
+                ms_sleep(0);
+            }
+            ensure_equals("order across threads", *item, i);
+        }
+        ensure("drained", ring.pop() == NULL);
+    }
+
+    // Zero code expansion matches what the sender encoded
+    template<> template<>
+    void FSMessageReceiveThreadTest_t::test<2>()
+    {
+        // header, then 1 2 <3 zeroes> 7 <300 zeroes> 9
+        U8 data[] = { LL_ZERO_CODE_FLAG | LL_RELIABLE_FLAG, 0, 0, 0, 1, 0,
+                      1, 2, 0, 3, 7, 0, 0, 44, 9 };
+        U8 out[NET_BUFFER_SIZE];
+        S32 overflows = 0;
+        S32 size = FSMessageReceiveThread::zeroCodeExpand(data, sizeof(data), out, &overflows);
+
+        ensure_equals("size", size, (S32)LL_PACKET_ID_SIZE + 2 + 3 + 1 + 300 + 1);
+        ensure_equals("no overflow", overflows, 0);
+        ensure_equals("flag cleared", out[0], LL_RELIABLE_FLAG);
+        ensure_equals("packet id", out[4], (U8)1);
+        ensure("literals", out[6] == 1 && out[7] == 2 && out[11] == 7 && out[size - 1] == 9);
+        for (S32 i = 8; i < 11; ++i)
+        {
+            ensure_equals("short run", out[i], (U8)0);
+        }
+        for (S32 i = 12; i < size - 1; ++i)
+        {
+            ensure_equals("wrapped run", out[i], (U8)0);
+        }
+
+        // more zeroes than any packet can hold
+        std::vector<U8> bomb(LL_PACKET_ID_SIZE, 0);
+        bomb[0] = LL_ZERO_CODE_FLAG;
+        for (S32 i = 0; i < 64; ++i)
+        {
+            bomb.push_back(0);
+            bomb.push_back(255);
+        }
+        size = FSMessageReceiveThread::zeroCodeExpand(&bomb[0], (S32)bomb.size(), out, &overflows);
+        ensure("overflow counted", overflows > 0);
+        ensure("stays in the buffer", size <= MAX_BUFFER_SIZE);
+    }
+
+#if !LL_WINDOWS
+    // Packets come out in order with acks split off and zero coding expanded
+    template<> template<>
+    void FSMessageReceiveThreadTest_t::test<3>()
+    {
+        const U32 PACKETS = 2000;
+        for (U32 i = 0; i < PACKETS; ++i)
+        {
+            std::vector<U8> packet(LL_PACKET_ID_SIZE, 0);
+            packet[4] = (U8)(i >> 8);
+            packet[5] = (U8)i;
+            packet.push_back(1);
+            packet.push_back(2);
+            if (i % 3 == 1)
+            {
+                // 1 2 <10 zeroes> 3
+                packet[0] |= LL_ZERO_CODE_FLAG;
+                packet.push_back(0);
+                packet.push_back(10);
+                packet.push_back(3);
+            }
+            else if (i % 3 == 2)
+            {
+                // two acks appended
+                packet[0] |= LL_ACK_FLAG;
+                packet.resize(packet.size() + 2 * sizeof(TPACKETID), 0xee);
+                packet.push_back(2);
+            }
+            LLMutexLock lock(gPacketsMutex);
+            gPackets.push_back(packet);
+        }
+
+        S32 socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+        ensure("socket", socket >= 0);
+        std::map<U32, LLMessageTemplate*> message_numbers;
+        {
+            FSMessageReceiveThread thread(socket, message_numbers);
+            thread.start();
+
+            LLTimer timeout;
+            U32 received = 0;
+            while (received < PACKETS && timeout.getElapsedTimeF32() < 10.f)
+            {
+                FSReceivedPacket* packet = thread.popPacket();
+                if (!packet)
+                {
+                    ms_sleep(1);
+                    continue;
+                }
+                ensure_equals("in order", (packet->mTrueBuffer[4] << 8) | packet->mTrueBuffer[5], (S32)received);
+                switch (received % 3)
+                {
+                case 0:
+                    ensure_equals("plain", packet->mSize, (S32)LL_PACKET_ID_SIZE + 2);
+                    ensure("plain buffer", packet->mBuffer == packet->mTrueBuffer);
+                    break;
+                case 1:
+                    ensure_equals("expanded", packet->mSize, (S32)LL_PACKET_ID_SIZE + 2 + 10 + 1);
+                    ensure_equals("compressed", packet->mCompressedSize, (S32)LL_PACKET_ID_SIZE + 5);
+                    ensure("expanded buffer", packet->mBuffer == packet->mExpandedBuffer);
+                    ensure_equals("last byte", packet->mBuffer[packet->mSize - 1], (U8)3);
+                    break;
+                default:
+                    ensure_equals("acks trimmed", packet->mSize, (S32)LL_PACKET_ID_SIZE + 2);
+                    ensure_equals("true size", packet->mTrueSize, (S32)(LL_PACKET_ID_SIZE + 3 + 2 * sizeof(TPACKETID)));
+                    break;
+                }
+                thread.recyclePacket(packet);
+                ++received;
+            }
+            ensure_equals("all received", received, PACKETS);
+            ensure_equals("all predecoded", gPredecoded.CurrentValue(), PACKETS);
+        }
+        ::close(socket);
+    }
+#endif
+}
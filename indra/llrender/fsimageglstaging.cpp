@@ -0,0 +1,395 @@
+/**
+ * @file fsimageglstaging.cpp
+ * @brief CPU side of LLImageGL texture uploads, prepared off the main thread.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fsimageglstaging.h"
+
+#include <cstring>
+#include <new>
+
+// Stagings kept for reuse; each holds the level buffers of one texture
+static const size_t MAX_POOLED_STAGINGS = 16;
+
+FSImageGLStaging::Params::Params()
+:   mWidth(0),
+    mHeight(0),
+    mComponents(0),
+    mLevels(0),
+    mExpand(EXPAND_NONE),
+    mAnalyzeAlpha(false),
+    mPickMask(false),
+    mAlphaOffset(0),
+    mAlphaStride(0)
+{
+}
+
+bool FSImageGLStaging::Params::operator==(const Params& other) const
+{
+    return mWidth == other.mWidth
+        && mHeight == other.mHeight
+        && mComponents == other.mComponents
+        && mLevels == other.mLevels
+        && mExpand == other.mExpand
+        && mAnalyzeAlpha == other.mAnalyzeAlpha
+        && mPickMask == other.mPickMask
+        && mAlphaOffset == other.mAlphaOffset
+        && mAlphaStride == other.mAlphaStride;
+}
+
+FSImageGLStaging::FSImageGLStaging()
+:   mIsMask(false),
+    mState(STATE_IDLE)
+{
+}
+
+bool FSImageGLStaging::stage(LLImageRaw* raw, const Params& params)
+{
+    mSource = raw;
+    mParams = params;
+    mIsMask = false;
+    mPickMask.clear();
+    mMipOffsets.clear();
+    mExpandedOffsets.clear();
+
+    if (!raw || raw->isBufferInvalid()
+        || raw->getWidth() != params.mWidth || raw->getHeight() != params.mHeight
+        || raw->getComponents() != params.mComponents
+        || params.mLevels < 1
+        || (params.mWidth >> (params.mLevels - 1)) < 1 || (params.mHeight >> (params.mLevels - 1)) < 1
+        || (params.mExpand != EXPAND_NONE && params.mComponents != (params.mExpand == EXPAND_LUMINANCE_ALPHA ? 2 : 1)))
+    {
+        // not something setImage() would upload either, leave it to the regular path
+        return false;
+    }
+
+    const S32 components = params.mComponents;
+    const U8* source = raw->getData();
+
+    try
+    {
+        // Same box filter and level layout as the manual mip loop in LLImageGL::setImage()
+        size_t mip_bytes = 0;
+        for (S32 level = 1; level < params.mLevels; ++level)
+        {
+            mMipOffsets.push_back(mip_bytes);
+            mip_bytes += (size_t)getLevelWidth(level) * getLevelHeight(level) * components;
+        }
+        mMips.resize(mip_bytes);
+        const U8* prev = source;
+        for (S32 level = 1; level < params.mLevels; ++level)
+        {
+            U8* mip = &mMips[mMipOffsets[level - 1]];
+            LLImageBase::generateMip(prev, mip, getLevelWidth(level), getLevelHeight(level), components);
+            prev = mip;
+        }
+
+        if (params.mExpand != EXPAND_NONE)
+        {
+            size_t expanded_bytes = 0;
+            for (S32 level = 0; level < params.mLevels; ++level)
+            {
+                mExpandedOffsets.push_back(expanded_bytes);
+                expanded_bytes += (size_t)getLevelWidth(level) * getLevelHeight(level) * 4;
+            }
+            mExpanded.resize(expanded_bytes);
+            for (S32 level = 0; level < params.mLevels; ++level)
+            {
+                const U8* src = level ? &mMips[mMipOffsets[level - 1]] : source;
+                expand(src, &mExpanded[mExpandedOffsets[level]], getLevelWidth(level) * getLevelHeight(level), params.mExpand);
+            }
+        }
+
+        // Both look at the first level in its original format, like setImage()
+        if (params.mAnalyzeAlpha)
+        {
+            mIsMask = isAlphaMask(source, params.mWidth, params.mHeight, params.mAlphaOffset, params.mAlphaStride);
+        }
+        if (params.mPickMask && components == 4)
+        {
+            mPickMask.assign(getPickMaskSize(params.mWidth, params.mHeight), 0);
+            fillPickMask(source, params.mWidth, params.mHeight, &mPickMask[0]);
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        LL_WARNS() << "Out of memory staging a " << params.mWidth << "x" << params.mHeight << " texture" << LL_ENDL;
+        reset();
+        return false;
+    }
+    return true;
+}
+
+void FSImageGLStaging::reset()
+{
+    mSource = NULL;
+    mState = STATE_IDLE;
+}
+
+const U8* FSImageGLStaging::getLevelData(S32 level) const
+{
+    if (level < 0 || level >= mParams.mLevels || mSource.isNull())
+    {
+        return NULL;
+    }
+    if (mParams.mExpand != EXPAND_NONE)
+    {
+        return &mExpanded[mExpandedOffsets[level]];
+    }
+    if (level == 0)
+    {
+        return mSource->getData();
+    }
+    return &mMips[mMipOffsets[level - 1]];
+}
+
+//static
+bool FSImageGLStaging::isAlphaMask(const U8* data, U32 w, U32 h, S32 alpha_offset, S32 alpha_stride)
+{
+    U32 length = w * h;
+    U32 alphatotal = 0;
+
+    U32 sample[16];
+    memset(sample, 0, sizeof(U32)*16);
+
+    // generate histogram of quantized alpha.
+    // also add-in the histogram of a 2x2 box-sampled version.  The idea is
+    // this will mid-skew the data (and thus increase the chances of not
+    // being used as a mask) from high-frequency alpha maps which
+    // suffer the worst from aliasing when used as alpha masks.
+    if (w >= 2 && h >= 2)
+    {
+        llassert(w%2 == 0);
+        llassert(h%2 == 0);
+        const U8* rowstart = data + alpha_offset;
+        for (U32 y = 0; y < h; y+=2)
+        {
+            const U8* current = rowstart;
+            for (U32 x = 0; x < w; x+=2)
+            {
+                const U32 s1 = current[0];
+                alphatotal += s1;
+                const U32 s2 = current[w * alpha_stride];
+                alphatotal += s2;
+                current += alpha_stride;
+                const U32 s3 = current[0];
+                alphatotal += s3;
+                const U32 s4 = current[w * alpha_stride];
+                alphatotal += s4;
+                current += alpha_stride;
+
+                ++sample[s1/16];
+                ++sample[s2/16];
+                ++sample[s3/16];
+                ++sample[s4/16];
+
+                const U32 asum = (s1+s2+s3+s4);
+                alphatotal += asum;
+                sample[asum/(16*4)] += 4;
+            }
+
+            rowstart += 2 * w * alpha_stride;
+        }
+        length *= 2; // we sampled everything twice, essentially
+    }
+    else
+    {
+        const U8* current = data + alpha_offset;
+        for (U32 i = 0; i < length; i++)
+        {
+            const U32 s1 = *current;
+            alphatotal += s1;
+            ++sample[s1/16];
+            current += alpha_stride;
+        }
+    }
+
+    // if more than 1/16th of alpha samples are mid-range, this
+    // shouldn't be treated as a 1-bit mask
+
+    // also, if all of the alpha samples are clumped on one half
+    // of the range (but not at an absolute extreme), then consider
+    // this to be an intentional effect and don't treat as a mask.
+
+    U32 midrangetotal = 0;
+    for (U32 i = 2; i < 13; i++)
+    {
+        midrangetotal += sample[i];
+    }
+    U32 lowerhalftotal = 0;
+    for (U32 i = 0; i < 8; i++)
+    {
+        lowerhalftotal += sample[i];
+    }
+    U32 upperhalftotal = 0;
+    for (U32 i = 8; i < 16; i++)
+    {
+        upperhalftotal += sample[i];
+    }
+
+    return !(midrangetotal > length/48 || // lots of midrange, or
+             (lowerhalftotal == length && alphatotal != 0) || // all close to transparent but not all totally transparent, or
+             (upperhalftotal == length && alphatotal != 255*length)); // all close to opaque but not all totally opaque
+}
+
+//static
+U32 FSImageGLStaging::getPickMaskSize(S32 width, S32 height)
+{
+    U32 pick_width = width/2 + 1;
+    U32 pick_height = height/2 + 1;
+    return (pick_width * pick_height + 7) / 8; // pixelcount-to-bits
+}
+
+//static
+void FSImageGLStaging::fillPickMask(const U8* data, S32 width, S32 height, U8* mask)
+{
+    U32 pick_bit = 0;
+    for (S32 y = 0; y < height; y += 2)
+    {
+        for (S32 x = 0; x < width; x += 2)
+        {
+            U8 alpha = data[(y*width+x)*4+3];
+            if (alpha > 32)
+            {
+                mask[pick_bit/8] |= 1 << (pick_bit%8);
+            }
+            ++pick_bit;
+        }
+    }
+}
+
+//static
+void FSImageGLStaging::expand(const U8* src, U8* dst, S32 pixels, EExpand expand)
+{
+    // Same conversions as LLImageGL::setManualImage() does for a core profile
+    switch (expand)
+    {
+    case EXPAND_ALPHA:
+        for (S32 i = 0; i < pixels; ++i, dst += 4)
+        {
+            dst[0] = dst[1] = dst[2] = 0;
+            dst[3] = src[i];
+        }
+        break;
+    case EXPAND_LUMINANCE:
+        for (S32 i = 0; i < pixels; ++i, dst += 4)
+        {
+            dst[0] = dst[1] = dst[2] = src[i];
+            dst[3] = 255;
+        }
+        break;
+    case EXPAND_LUMINANCE_ALPHA:
+        for (S32 i = 0; i < pixels; ++i, dst += 4)
+        {
+            dst[0] = dst[1] = dst[2] = src[i*2];
+            dst[3] = src[i*2+1];
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+//============================================================================
+
+FSImageGLStagingThread::FSImageGLStagingThread(bool threaded)
+:   LLQueuedThread("imageglstaging", threaded)
+{
+}
+
+LLPointer<FSImageGLStaging> FSImageGLStagingThread::stage(LLImageRaw* raw, const FSImageGLStaging::Params& params, U32 priority)
+{
+    LLPointer<FSImageGLStaging> staging;
+    if (!mPool.empty())
+    {
+        staging = mPool.back();
+        mPool.pop_back();
+    }
+    else
+    {
+        staging = new FSImageGLStaging();
+    }
+    staging->setState(FSImageGLStaging::STATE_PENDING);
+
+    StagingRequest* req = new StagingRequest(generateHandle(), priority, staging, raw, params);
+    if (!addRequest(req))
+    {
+        LL_WARNS() << "Staging request not added because we are exiting." << LL_ENDL;
+        staging->setState(FSImageGLStaging::STATE_FAILED);
+    }
+    return staging;
+}
+
+void FSImageGLStagingThread::release(LLPointer<FSImageGLStaging>& staging)
+{
+    if (staging.isNull())
+    {
+        return;
+    }
+    // Still referenced by a queued request if it was abandoned early; that
+    // one then just goes away with the request
+    if (staging->isDone() && staging->getNumRefs() == 1 && mPool.size() < MAX_POOLED_STAGINGS)
+    {
+        staging->reset();
+        mPool.push_back(staging);
+    }
+    staging = NULL;
+}
+
+FSImageGLStagingThread::StagingRequest::StagingRequest(handle_t handle, U32 priority, FSImageGLStaging* staging,
+                                                       LLImageRaw* raw, const FSImageGLStaging::Params& params)
+:   LLQueuedThread::QueuedRequest(handle, priority, FLAG_AUTO_COMPLETE),
+    mStaging(staging),
+    mRaw(raw),
+    mParams(params)
+{
+}
+
+FSImageGLStagingThread::StagingRequest::~StagingRequest()
+{
+}
+
+bool FSImageGLStagingThread::StagingRequest::processRequest()
+{
+    // Nobody is waiting for it anymore
+    if (mStaging->getNumRefs() == 1)
+    {
+        mStaging->setState(FSImageGLStaging::STATE_FAILED);
+        return true;
+    }
+    bool staged = mStaging->stage(mRaw, mParams);
+    mStaging->setState(staged ? FSImageGLStaging::STATE_READY : FSImageGLStaging::STATE_FAILED);
+    return true;
+}
+
+void FSImageGLStagingThread::StagingRequest::finishRequest(bool completed)
+{
+    if (!completed)
+    {
+        mStaging->setState(FSImageGLStaging::STATE_FAILED);
+    }
+}
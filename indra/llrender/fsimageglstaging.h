@@ -0,0 +1,169 @@
+/**
+ * @file fsimageglstaging.h
+ * @brief CPU side of LLImageGL texture uploads, prepared off the main thread.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_IMAGEGLSTAGING_H
+#define FS_IMAGEGLSTAGING_H
+
+#include "llatomic.h"
+#include "llimage.h"
+#include "llpointer.h"
+#include "llqueuedthread.h"
+#include "llrefcount.h"
+
+#include <vector>
+
+/**
+ * Everything LLImageGL::setImage() computes from the pixels before it can
+ * call glTexImage2D(): the mip chain when the driver does not generate it,
+ * the RGBA expansion of formats a core profile no longer accepts, the alpha
+ * mask analysis and the pick mask. None of it touches GL, so it can run on
+ * FSImageGLStagingThread while the main thread keeps rendering; the main
+ * thread then only uploads the finished levels.
+ *
+ * The source image rows are tightly packed and GL_UNPACK_ALIGNMENT is 1
+ * (see LLViewerWindow), so levels need no row padding.
+ */
+class FSImageGLStaging : public LLThreadSafeRefCount
+{
+public:
+    enum EExpand
+    {
+        EXPAND_NONE = 0,
+        EXPAND_ALPHA,               // A   -> 0 0 0 A
+        EXPAND_LUMINANCE,           // L   -> L L L 255
+        EXPAND_LUMINANCE_ALPHA      // L A -> L L L A
+    };
+
+    enum EState
+    {
+        STATE_IDLE = 0,
+        STATE_PENDING,
+        STATE_READY,
+        STATE_FAILED
+    };
+
+    struct Params
+    {
+        Params();
+        bool operator==(const Params& other) const;
+        bool operator!=(const Params& other) const { return !(*this == other); }
+
+        S32     mWidth;             // of the first level
+        S32     mHeight;
+        S32     mComponents;
+        S32     mLevels;            // levels to build, 1 when there are no mips or the GL makes them
+        EExpand mExpand;
+        bool    mAnalyzeAlpha;      // LLImageGL::analyzeAlpha()
+        bool    mPickMask;          // LLImageGL::updatePickMask(), RGBA only
+        S32     mAlphaOffset;
+        S32     mAlphaStride;
+    };
+
+    FSImageGLStaging();
+
+    // Builds everything params asks for from raw, which is kept until
+    // reset(). Safe to call on any thread.
+    bool stage(LLImageRaw* raw, const Params& params);
+    // Drops the source image; the level buffers keep their memory for reuse
+    void reset();
+
+    EState getState() const { return (EState)mState.CurrentValue(); }
+    void setState(EState state) { mState = state; }
+    bool isReady() const { return getState() == STATE_READY; }
+    bool isDone() const { return getState() == STATE_READY || getState() == STATE_FAILED; }
+
+    // The image stage() was called with, until reset()
+    const LLImageRaw* getSource() const { return mSource.get(); }
+    const Params& getParams() const { return mParams; }
+    S32 getLevelCount() const { return mParams.mLevels; }
+    S32 getLevelWidth(S32 level) const { return mParams.mWidth >> level; }
+    S32 getLevelHeight(S32 level) const { return mParams.mHeight >> level; }
+    // Components of the uploaded data, 4 once expanded
+    S32 getLevelComponents() const { return mParams.mExpand != EXPAND_NONE ? 4 : mParams.mComponents; }
+    const U8* getLevelData(S32 level) const;
+
+    bool isMask() const { return mIsMask; }
+    bool hasPickMask() const { return !mPickMask.empty(); }
+    const U8* getPickMask() const { return mPickMask.empty() ? NULL : &mPickMask[0]; }
+    size_t getPickMaskSize() const { return mPickMask.size(); }
+
+    // Pixel loops shared with LLImageGL
+    static bool isAlphaMask(const U8* data, U32 width, U32 height, S32 alpha_offset, S32 alpha_stride);
+    // Bytes needed for the pick mask of a width x height RGBA image, see LLImageGL::createPickMask()
+    static U32 getPickMaskSize(S32 width, S32 height);
+    // mask must be getPickMaskSize() zeroed bytes
+    static void fillPickMask(const U8* data, S32 width, S32 height, U8* mask);
+    static void expand(const U8* src, U8* dst, S32 pixels, EExpand expand);
+
+private:
+    LLPointer<LLImageRaw>   mSource;
+    Params                  mParams;
+    std::vector<U8>         mMips;          // levels 1 and up in the source format
+    std::vector<U8>         mExpanded;      // every level as RGBA, when expanding
+    std::vector<size_t>     mMipOffsets;
+    std::vector<size_t>     mExpandedOffsets;
+    std::vector<U8>         mPickMask;
+    bool                    mIsMask;
+    LLAtomicS32             mState;
+};
+
+/**
+ * Runs FSImageGLStaging::stage() for LLViewerTextureList and recycles the
+ * staging buffers, so a steady stream of uploads stops allocating.
+ */
+class FSImageGLStagingThread : public LLQueuedThread
+{
+public:
+    FSImageGLStagingThread(bool threaded = true);
+
+    // Main thread. The returned staging is pending until the thread is done with it.
+    LLPointer<FSImageGLStaging> stage(LLImageRaw* raw, const FSImageGLStaging::Params& params, U32 priority = PRIORITY_NORMAL);
+    // Main thread. Hands a staging back once it is uploaded or abandoned; clears staging.
+    void release(LLPointer<FSImageGLStaging>& staging);
+
+private:
+    class StagingRequest : public LLQueuedThread::QueuedRequest
+    {
+    public:
+        StagingRequest(handle_t handle, U32 priority, FSImageGLStaging* staging, LLImageRaw* raw, const FSImageGLStaging::Params& params);
+
+        /*virtual*/ bool processRequest();
+        /*virtual*/ void finishRequest(bool completed);
+
+    protected:
+        /*virtual*/ ~StagingRequest();
+
+    private:
+        LLPointer<FSImageGLStaging>     mStaging;
+        LLPointer<LLImageRaw>           mRaw;
+        FSImageGLStaging::Params        mParams;
+    };
+
+    std::vector<LLPointer<FSImageGLStaging> > mPool;
+};
+
+#endif // FS_IMAGEGLSTAGING_H
@@ -39,6 +39,7 @@
 #include "llgl.h"
 #include "llglslshader.h"
 #include "llrender.h"
+#include "fsimageglstaging.h" // <FS> Staged texture uploads
 
 //----------------------------------------------------------------------------
 const F32 MIN_TEXTURE_LIFETIME = 10.f;
@@ -963,6 +964,83 @@ BOOL LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
 	return TRUE;
 }
 
+// <FS> Staged texture uploads
+// setImage() for pixels FSImageGLStaging already prepared; only the GL calls are left
+BOOL LLImageGL::setImage(const FSImageGLStaging& staged)
+{
+	LL_RECORD_BLOCK_TIME(FTM_SET_IMAGE);
+	const FSImageGLStaging::Params& params = staged.getParams();
+
+	if (mUseMipMaps)
+	{
+		//set has mip maps to true before binding image so tex parameters get set properly
+		gGL.getTexUnit(0)->unbind(mBindTarget);
+		mHasMipMaps = true;
+		mTexOptionsDirty = true;
+		setFilteringOption(LLTexUnit::TFO_ANISOTROPIC);
+	}
+	else
+	{
+		mHasMipMaps = false;
+	}
+
+	llverify(gGL.getTexUnit(0)->bind(this));
+
+	// Expanded levels are what setManualImage() would have converted them to
+	U32 pixformat = mFormatPrimary;
+	S32 intformat = mFormatInternal;
+	if (params.mExpand != FSImageGLStaging::EXPAND_NONE)
+	{
+		pixformat = GL_RGBA;
+		intformat = params.mExpand == FSImageGLStaging::EXPAND_LUMINANCE ? GL_RGB8 : GL_RGBA8;
+	}
+
+	bool autogen = mUseMipMaps && mAutoGenMips;
+	if (autogen)
+	{
+		mMipLevels = wpo2(llmax(params.mWidth, params.mHeight));
+		if (!LLRender::sGLCoreProfile)
+		{
+			glTexParameteri(mTarget, GL_GENERATE_MIPMAP, GL_TRUE);
+		}
+	}
+	else
+	{
+		mMipLevels = mUseMipMaps ? staged.getLevelCount() : 0;
+	}
+
+	for (S32 level = 0; level < staged.getLevelCount(); ++level)
+	{
+		LLImageGL::setManualImage(mTarget, level, intformat, staged.getLevelWidth(level), staged.getLevelHeight(level),
+								  pixformat, mFormatType, staged.getLevelData(level), mAllowCompression);
+	}
+	stop_glerror();
+
+	if (autogen && LLRender::sGLCoreProfile)
+	{
+		glGenerateMipmap(mTarget);
+		stop_glerror();
+	}
+
+	if (params.mAnalyzeAlpha)
+	{
+		mIsMask = staged.isMask();
+	}
+	if (mNeedsAlphaAndPickMask)
+	{
+		freePickMask();
+		if (staged.hasPickMask())
+		{
+			createPickMask(params.mWidth, params.mHeight);
+			memcpy(mPickMask, staged.getPickMask(), staged.getPickMaskSize());
+		}
+	}
+
+	mGLTextureCreated = true;
+	return TRUE;
+}
+// </FS>
+
 BOOL LLImageGL::preAddToAtlas(S32 discard_level, const LLImageRaw* raw_image)
 {
 	//not compatible with core GL profile
@@ -1355,20 +1433,10 @@ BOOL LLImageGL::createGLTexture()
 	return TRUE ;
 }
 
-static LLTrace::BlockTimerStatHandle FTM_CREATE_GL_TEXTURE2("createGLTexture(raw)");
-BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename/*=0*/, BOOL to_create, S32 category)
+// <FS> Staged texture uploads
+// Size and format setup shared by both createGLTexture(raw) overloads and getStagingParams()
+BOOL LLImageGL::preCreateGLTexture(S32& discard_level, const LLImageRaw* imageraw)
 {
-	LL_RECORD_BLOCK_TIME(FTM_CREATE_GL_TEXTURE2);
-	if (gGLManager.mIsDisabled)
-	{
-		LL_WARNS() << "Trying to create a texture while GL is disabled!" << LL_ENDL;
-		return FALSE;
-	}
-
-	mGLTextureCreated = false ;
-	llassert(gGLManager.mInited);
-	stop_glerror();
-
 	if (!imageraw || imageraw->isBufferInvalid())
 	{
 		LL_WARNS() << "Trying to create a texture from invalid image data" << LL_ENDL;
@@ -1454,6 +1522,31 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
 		calcAlphaChannelOffsetAndStride() ;
 	}
 
+	return TRUE;
+}
+// </FS>
+
+static LLTrace::BlockTimerStatHandle FTM_CREATE_GL_TEXTURE2("createGLTexture(raw)");
+BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename/*=0*/, BOOL to_create, S32 category)
+{
+	LL_RECORD_BLOCK_TIME(FTM_CREATE_GL_TEXTURE2);
+	if (gGLManager.mIsDisabled)
+	{
+		LL_WARNS() << "Trying to create a texture while GL is disabled!" << LL_ENDL;
+		return FALSE;
+	}
+
+	mGLTextureCreated = false ;
+	llassert(gGLManager.mInited);
+	stop_glerror();
+
+	// <FS> Staged texture uploads; moved to preCreateGLTexture()
+	if (!preCreateGLTexture(discard_level, imageraw))
+	{
+		return FALSE;
+	}
+	// </FS>
+
 	if(!to_create) //not create a gl texture
 	{
 		destroyGLTexture();
@@ -1467,8 +1560,109 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
 	return createGLTexture(discard_level, rawdata, FALSE, usename);
 }
 
+// <FS> Staged texture uploads
+bool LLImageGL::getStagingParams(S32 discard_level, const LLImageRaw* imageraw, FSImageGLStaging::Params& params)
+{
+	if (gGLManager.mIsDisabled || !imageraw || imageraw->isBufferInvalid())
+	{
+		return false;
+	}
+
+	// Leave a live texture alone until it is actually replaced
+	S32 level = discard_level < 0 ? mCurrentDiscardLevel : discard_level;
+	if (mTexName && level >= 0 &&
+		((imageraw->getWidth() << level) != mWidth || (imageraw->getHeight() << level) != mHeight
+		 || imageraw->getComponents() != mComponents))
+	{
+		return false;
+	}
+
+	if (!preCreateGLTexture(discard_level, imageraw))
+	{
+		return false;
+	}
+	getStagingParams(discard_level, params);
+	return params.mLevels > 0;
+}
+
+void LLImageGL::getStagingParams(S32 discard_level, FSImageGLStaging::Params& params) const
+{
+	params = FSImageGLStaging::Params();
+	if (mFormatType != GL_UNSIGNED_BYTE || mFormatSwapBytes)
+	{
+		return;
+	}
+
+	FSImageGLStaging::EExpand expand = FSImageGLStaging::EXPAND_NONE;
+	switch (mFormatPrimary)
+	{
+	case GL_ALPHA:
+		expand = FSImageGLStaging::EXPAND_ALPHA;
+		break;
+	case GL_LUMINANCE:
+		expand = FSImageGLStaging::EXPAND_LUMINANCE;
+		break;
+	case GL_LUMINANCE_ALPHA:
+		expand = FSImageGLStaging::EXPAND_LUMINANCE_ALPHA;
+		break;
+	case GL_RGB:
+	case GL_RGBA:
+		break;
+	default:
+		// compressed or swizzled formats go the regular way
+		return;
+	}
+	if (!LLRender::sGLCoreProfile)
+	{
+		expand = FSImageGLStaging::EXPAND_NONE;
+	}
+
+	discard_level = llclamp(discard_level, 0, (S32)mMaxDiscardLevel);
+	params.mWidth = getWidth(discard_level);
+	params.mHeight = getHeight(discard_level);
+	params.mComponents = mComponents;
+	params.mLevels = (mUseMipMaps && !canAutoGenMips()) ? mMaxDiscardLevel - discard_level + 1 : 1;
+	params.mExpand = expand;
+	params.mAnalyzeAlpha = !sSkipAnalyzeAlpha && mNeedsAlphaAndPickMask;
+	params.mPickMask = mNeedsAlphaAndPickMask && mFormatPrimary == GL_RGBA;
+	params.mAlphaOffset = mAlphaOffset;
+	params.mAlphaStride = mAlphaStride;
+}
+
+BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, const FSImageGLStaging& staged, S32 usename, S32 category)
+{
+	FSImageGLStaging::Params params;
+	if (!staged.isReady() || staged.getSource() != imageraw || !getStagingParams(discard_level, imageraw, params)
+		|| params != staged.getParams())
+	{
+		// the texture changed since it was staged
+		return createGLTexture(discard_level, imageraw, usename, TRUE, category);
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_CREATE_GL_TEXTURE2);
+	mGLTextureCreated = false;
+	setCategory(category);
+	return createGLTexture(discard_level, imageraw->getData(), FALSE, usename, &staged);
+}
+
+BOOL LLImageGL::canAutoGenMips() const
+{
+#if LL_DARWIN
+	// On the Mac GF2 and GF4MX drivers, auto mipmap generation doesn't work right with alpha-only textures.
+	if(gGLManager.mIsGF2or4MX && (mFormatInternal == GL_ALPHA8) && (mFormatPrimary == GL_ALPHA))
+	{
+		return FALSE;
+	}
+#endif
+	return gGLManager.mHasMipMapGeneration;
+}
+// </FS>
+
 static LLTrace::BlockTimerStatHandle FTM_CREATE_GL_TEXTURE3("createGLTexture3(data)");
-BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_hasmips, S32 usename)
+// <FS> Staged texture uploads
+//BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_hasmips, S32 usename)
+BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_hasmips, S32 usename, const FSImageGLStaging* staged)
+// </FS>
 {
 	LL_RECORD_BLOCK_TIME(FTM_CREATE_GL_TEXTURE3);
 	llassert(data_in);
@@ -1484,7 +1678,10 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_
 	if (mTexName != 0 && discard_level == mCurrentDiscardLevel)
 	{
 		// This will only be true if the size has not changed
-		return setImage(data_in, data_hasmips);
+		// <FS> Staged texture uploads
+		//return setImage(data_in, data_hasmips);
+		return staged ? setImage(*staged) : setImage(data_in, data_hasmips);
+		// </FS>
 	}
 	
 	U32 old_name = mTexName;
@@ -1523,19 +1720,25 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, BOOL data_
 
 	if (mUseMipMaps)
 	{
-		mAutoGenMips = gGLManager.mHasMipMapGeneration;
-#if LL_DARWIN
-		// On the Mac GF2 and GF4MX drivers, auto mipmap generation doesn't work right with alpha-only textures.
-		if(gGLManager.mIsGF2or4MX && (mFormatInternal == GL_ALPHA8) && (mFormatPrimary == GL_ALPHA))
-		{
-			mAutoGenMips = FALSE;
-		}
-#endif
+		// <FS> Staged texture uploads; getStagingParams() needs the same answer
+//		mAutoGenMips = gGLManager.mHasMipMapGeneration;
+//#if LL_DARWIN
+//		// On the Mac GF2 and GF4MX drivers, auto mipmap generation doesn't work right with alpha-only textures.
+//		if(gGLManager.mIsGF2or4MX && (mFormatInternal == GL_ALPHA8) && (mFormatPrimary == GL_ALPHA))
+//		{
+//			mAutoGenMips = FALSE;
+//		}
+//#endif
+		mAutoGenMips = canAutoGenMips();
+		// </FS>
 	}
 
 	mCurrentDiscardLevel = discard_level;	
 
-	if (!setImage(data_in, data_hasmips))
+	// <FS> Staged texture uploads
+	//if (!setImage(data_in, data_hasmips))
+	if (!(staged ? setImage(*staged) : setImage(data_in, data_hasmips)))
+	// </FS>
 	{
 		stop_glerror();
 		return FALSE;
@@ -1948,98 +2151,9 @@ void LLImageGL::analyzeAlpha(const void* data_in, U32 w, U32 h)
 		return ;
 	}
 
-	U32 length = w * h;
-	U32 alphatotal = 0;
-	
-	U32 sample[16];
-	memset(sample, 0, sizeof(U32)*16);
-
-	// generate histogram of quantized alpha.
-	// also add-in the histogram of a 2x2 box-sampled version.  The idea is
-	// this will mid-skew the data (and thus increase the chances of not
-	// being used as a mask) from high-frequency alpha maps which
-	// suffer the worst from aliasing when used as alpha masks.
-	if (w >= 2 && h >= 2)
-	{
-		llassert(w%2 == 0);
-		llassert(h%2 == 0);
-		const GLubyte* rowstart = ((const GLubyte*) data_in) + mAlphaOffset;
-		for (U32 y = 0; y < h; y+=2)
-		{
-			const GLubyte* current = rowstart;
-			for (U32 x = 0; x < w; x+=2)
-			{
-				const U32 s1 = current[0];
-				alphatotal += s1;
-				const U32 s2 = current[w * mAlphaStride];
-				alphatotal += s2;
-				current += mAlphaStride;
-				const U32 s3 = current[0];
-				alphatotal += s3;
-				const U32 s4 = current[w * mAlphaStride];
-				alphatotal += s4;
-				current += mAlphaStride;
-
-				++sample[s1/16];
-				++sample[s2/16];
-				++sample[s3/16];
-				++sample[s4/16];
-
-				const U32 asum = (s1+s2+s3+s4);
-				alphatotal += asum;
-				sample[asum/(16*4)] += 4;
-			}
-			
-			
-			rowstart += 2 * w * mAlphaStride;
-		}
-		length *= 2; // we sampled everything twice, essentially
-	}
-	else
-	{
-		const GLubyte* current = ((const GLubyte*) data_in) + mAlphaOffset;
-		for (U32 i = 0; i < length; i++)
-		{
-			const U32 s1 = *current;
-			alphatotal += s1;
-			++sample[s1/16];
-			current += mAlphaStride;
-		}
-	}
-	
-	// if more than 1/16th of alpha samples are mid-range, this
-	// shouldn't be treated as a 1-bit mask
-
-	// also, if all of the alpha samples are clumped on one half
-	// of the range (but not at an absolute extreme), then consider
-	// this to be an intentional effect and don't treat as a mask.
-
-	U32 midrangetotal = 0;
-	for (U32 i = 2; i < 13; i++)
-	{
-		midrangetotal += sample[i];
-	}
-	U32 lowerhalftotal = 0;
-	for (U32 i = 0; i < 8; i++)
-	{
-		lowerhalftotal += sample[i];
-	}
-	U32 upperhalftotal = 0;
-	for (U32 i = 8; i < 16; i++)
-	{
-		upperhalftotal += sample[i];
-	}
-
-	if (midrangetotal > length/48 || // lots of midrange, or
-	    (lowerhalftotal == length && alphatotal != 0) || // all close to transparent but not all totally transparent, or
-	    (upperhalftotal == length && alphatotal != 255*length)) // all close to opaque but not all totally opaque
-	{
-		mIsMask = FALSE; // not suitable for masking
-	}
-	else
-	{
-		mIsMask = TRUE;
-	}
+	// <FS> Staged texture uploads; the loop moved to FSImageGLStaging::isAlphaMask()
+	mIsMask = FSImageGLStaging::isAlphaMask((const U8*)data_in, w, h, mAlphaOffset, mAlphaStride) ? TRUE : FALSE;
+	// </FS>
 }
 
 //----------------------------------------------------------------------------
@@ -2091,32 +2205,10 @@ void LLImageGL::updatePickMask(S32 width, S32 height, const U8* data_in)
         return;
     }
 
-#ifdef SHOW_ASSERT
-	const U32 pickSize = createPickMask(width, height);
-#else // SHOW_ASSERT
+	// <FS> Staged texture uploads; the loop moved to FSImageGLStaging::fillPickMask()
 	createPickMask(width, height);
-#endif // SHOW_ASSERT
-
-	U32 pick_bit = 0;
-	
-	for (S32 y = 0; y < height; y += 2)
-	{
-		for (S32 x = 0; x < width; x += 2)
-		{
-			U8 alpha = data_in[(y*width+x)*4+3];
-
-			if (alpha > 32)
-			{
-				U32 pick_idx = pick_bit/8;
-				U32 pick_offset = pick_bit%8;
-				llassert(pick_idx < pickSize);
-
-				mPickMask[pick_idx] |= 1 << pick_offset;
-			}
-			
-			++pick_bit;
-		}
-	}
+	FSImageGLStaging::fillPickMask(data_in, width, height, mPickMask);
+	// </FS>
 }
 
 //BOOL LLImageGL::getMask(const LLVector2 &tc)
@@ -37,6 +37,7 @@
 #include "llunits.h"
 
 #include "llrender.h"
+#include "fsimageglstaging.h" // <FS> Staged texture uploads
 class LLTextureAtlas ;
 #define BYTES_TO_MEGA_BYTES(x) ((x) >> 20)
 #define MEGA_BYTES_TO_BYTES(x) ((x) << 20)
@@ -109,7 +110,17 @@ public:
 	BOOL createGLTexture() ;
 	BOOL createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename = 0, BOOL to_create = TRUE,
 		S32 category = sMaxCategories-1);
-	BOOL createGLTexture(S32 discard_level, const U8* data, BOOL data_hasmips = FALSE, S32 usename = 0);
+	// <FS> Staged texture uploads
+	//BOOL createGLTexture(S32 discard_level, const U8* data, BOOL data_hasmips = FALSE, S32 usename = 0);
+	BOOL createGLTexture(S32 discard_level, const U8* data, BOOL data_hasmips = FALSE, S32 usename = 0, const FSImageGLStaging* staged = NULL);
+	// Sets up size and format for imageraw like createGLTexture() does and
+	// describes the staging its upload needs. False if it can't be staged.
+	bool getStagingParams(S32 discard_level, const LLImageRaw* imageraw, FSImageGLStaging::Params& params);
+	// createGLTexture() from a ready staging of imageraw; falls back to the
+	// regular upload if the texture changed since it was staged
+	BOOL createGLTexture(S32 discard_level, const LLImageRaw* imageraw, const FSImageGLStaging& staged, S32 usename = 0,
+		S32 category = sMaxCategories-1);
+	// </FS>
 	void setImage(const LLImageRaw* imageraw);
 	BOOL setImage(const U8* data_in, BOOL data_hasmips = FALSE);
 	BOOL setSubImage(const LLImageRaw* imageraw, S32 x_pos, S32 y_pos, S32 width, S32 height, BOOL force_fast_update = FALSE);
@@ -198,6 +209,12 @@ public:
 private:
 	U32 createPickMask(S32 pWidth, S32 pHeight);
 	void freePickMask();
+	// <FS> Staged texture uploads
+	BOOL preCreateGLTexture(S32& discard_level, const LLImageRaw* imageraw);
+	void getStagingParams(S32 discard_level, FSImageGLStaging::Params& params) const;
+	BOOL setImage(const FSImageGLStaging& staged);
+	BOOL canAutoGenMips() const;
+	// </FS>
 
 	LLPointer<LLImageRaw> mSaveData; // used for destroyGL/restoreGL
 	U8* mPickMask;  //downsampled bitmap approximation of alpha channel.  NULL if no alpha channel
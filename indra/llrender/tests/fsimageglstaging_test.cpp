@@ -0,0 +1,306 @@
+/**
+ * @file fsimageglstaging_test.cpp
+ * @brief Tests and CPU benchmark for FSImageGLStaging.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../fsimageglstaging.h"
+
+#include "lltimer.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    // Levels for a full chain down to 1 pixel on the short side, like LLImageGL::setSize()
+    S32 full_levels(S32 width, S32 height)
+    {
+        S32 levels = 1;
+        while (width > 1 && height > 1)
+        {
+            width >>= 1;
+            height >>= 1;
+            ++levels;
+        }
+        return levels;
+    }
+
+    FSImageGLStaging::Params make_params(const LLImageRaw* raw, S32 levels)
+    {
+        FSImageGLStaging::Params params;
+        params.mWidth = raw->getWidth();
+        params.mHeight = raw->getHeight();
+        params.mComponents = raw->getComponents();
+        params.mLevels = levels;
+        params.mAnalyzeAlpha = raw->getComponents() != 3;
+        params.mPickMask = raw->getComponents() == 4;
+        params.mAlphaStride = raw->getComponents();
+        params.mAlphaOffset = raw->getComponents() - 1;
+        return params;
+    }
+}
+
+namespace tut
+{
+    struct FSImageGLStagingFixture
+    {
+        std::mt19937 mRandom;
+
+        LLPointer<LLImageRaw> makeImage(S32 width, S32 height, S32 components, bool binary_alpha = false)
+        {
+            LLPointer<LLImageRaw> raw = new LLImageRaw(width, height, components);
+            U8* data = raw->getData();
+            for (S32 i = 0; i < width * height * components; ++i)
+            {
+                data[i] = (U8)mRandom();
+            }
+            if (binary_alpha && components != 3)
+            {
+                // a cutout: opaque right half
+                for (S32 i = 0; i < width * height; ++i)
+                {
+                    data[i * components + components - 1] = (i % width) < width / 2 ? 0 : 255;
+                }
+            }
+            return raw;
+        }
+    };
+    typedef test_group<FSImageGLStagingFixture> FSImageGLStagingTest_factory;
+    typedef FSImageGLStagingTest_factory::object FSImageGLStagingTest_t;
+    FSImageGLStagingTest_factory tf("FSImageGLStaging");
+
+    // Levels are the same box filtered chain LLImageGL::setImage() builds
+    template<> template<>
+    void FSImageGLStagingTest_t::test<1>()
+    {
+        LLPointer<LLImageRaw> raw = makeImage(64, 32, 4, true);
+        FSImageGLStaging::Params params = make_params(raw, full_levels(64, 32));
+        ensure_equals("levels", params.mLevels, 6);
+
+        LLPointer<FSImageGLStaging> staging = new FSImageGLStaging();
+        ensure("staged", staging->stage(raw, params));
+        ensure("level 0 is the source", staging->getLevelData(0) == raw->getData());
+        ensure("past the last level", staging->getLevelData(params.mLevels) == NULL);
+
+        std::vector<U8> prev(raw->getData(), raw->getData() + raw->getDataSize());
+        for (S32 level = 1; level < params.mLevels; ++level)
+        {
+            S32 w = staging->getLevelWidth(level);
+            S32 h = staging->getLevelHeight(level);
+            ensure_equals("width", w, 64 >> level);
+            ensure_equals("height", h, 32 >> level);
+            std::vector<U8> mip(w * h * 4);
+            LLImageBase::generateMip(&prev[0], &mip[0], w, h, 4);
+            ensure("mip", memcmp(&mip[0], staging->getLevelData(level), mip.size()) == 0);
+            prev.swap(mip);
+        }
+
+        // a cutout is a mask, the pick mask has a bit per 2x2 block
+        ensure("mask", staging->isMask());
+        ensure_equals("pick mask size", staging->getPickMaskSize(), (size_t)FSImageGLStaging::getPickMaskSize(64, 32));
+        const U8* data = raw->getData();
+        U32 bit = 0;
+        for (S32 y = 0; y < 32; y += 2)
+        {
+            for (S32 x = 0; x < 64; x += 2, ++bit)
+            {
+                bool set = (staging->getPickMask()[bit / 8] >> (bit % 8)) & 1;
+                ensure_equals("pick bit", set, data[(y * 64 + x) * 4 + 3] > 32);
+            }
+        }
+
+        // noisy alpha is not
+        raw = makeImage(64, 32, 4);
+        ensure("restaged", staging->stage(raw, make_params(raw, 1)));
+        ensure("not a mask", !staging->isMask());
+        ensure_equals("one level", staging->getLevelCount(), 1);
+    }
+
+    // Core profile expansion matches LLImageGL::setManualImage()
+    template<> template<>
+    void FSImageGLStagingTest_t::test<2>()
+    {
+        const FSImageGLStaging::EExpand modes[] = { FSImageGLStaging::EXPAND_ALPHA, FSImageGLStaging::EXPAND_LUMINANCE,
+                                                    FSImageGLStaging::EXPAND_LUMINANCE_ALPHA };
+        for (FSImageGLStaging::EExpand mode : modes)
+        {
+            S32 components = mode == FSImageGLStaging::EXPAND_LUMINANCE_ALPHA ? 2 : 1;
+            LLPointer<LLImageRaw> raw = makeImage(16, 16, components);
+            FSImageGLStaging::Params params = make_params(raw, 5);
+            params.mExpand = mode;
+
+            LLPointer<FSImageGLStaging> staging = new FSImageGLStaging();
+            ensure("staged", staging->stage(raw, params));
+            ensure_equals("components", staging->getLevelComponents(), 4);
+
+            std::vector<U8> prev(raw->getData(), raw->getData() + raw->getDataSize());
+            for (S32 level = 0; level < params.mLevels; ++level)
+            {
+                S32 pixels = staging->getLevelWidth(level) * staging->getLevelHeight(level);
+                if (level)
+                {
+                    std::vector<U8> mip(pixels * components);
+                    LLImageBase::generateMip(&prev[0], &mip[0], staging->getLevelWidth(level), staging->getLevelHeight(level), components);
+                    prev.swap(mip);
+                }
+                const U8* out = staging->getLevelData(level);
+                for (S32 i = 0; i < pixels; ++i, out += 4)
+                {
+                    U8 first = prev[i * components];
+                    U8 rgb = mode == FSImageGLStaging::EXPAND_ALPHA ? 0 : first;
+                    U8 alpha = mode == FSImageGLStaging::EXPAND_ALPHA ? first
+                             : mode == FSImageGLStaging::EXPAND_LUMINANCE ? 255 : prev[i * 2 + 1];
+                    ensure("rgb", out[0] == rgb && out[1] == rgb && out[2] == rgb);
+                    ensure_equals("alpha", out[3], alpha);
+                }
+            }
+        }
+    }
+
+    // Anything setImage() could not upload is refused
+    template<> template<>
+    void FSImageGLStagingTest_t::test<3>()
+    {
+        LLPointer<FSImageGLStaging> staging = new FSImageGLStaging();
+        LLPointer<LLImageRaw> raw = makeImage(32, 32, 3);
+
+        FSImageGLStaging::Params params = make_params(raw, 6);
+        ensure("full chain", staging->stage(raw, params));
+        params.mLevels = 7;
+        ensure("too many levels", !staging->stage(raw, params));
+        params = make_params(raw, 1);
+        params.mComponents = 4;
+        ensure("wrong components", !staging->stage(raw, params));
+        params = make_params(raw, 1);
+        params.mExpand = FSImageGLStaging::EXPAND_LUMINANCE;
+        ensure("expanding rgb", !staging->stage(raw, params));
+        ensure("no image", !staging->stage(NULL, make_params(raw, 1)));
+    }
+
+    // The thread stages and recycles; an abandoned staging just fails
+    template<> template<>
+    void FSImageGLStagingTest_t::test<4>()
+    {
+        FSImageGLStagingThread thread(false);
+        LLPointer<LLImageRaw> raw = makeImage(32, 32, 4);
+
+        LLPointer<FSImageGLStaging> staging = thread.stage(raw, make_params(raw, 6));
+        ensure_equals("pending", staging->getState(), FSImageGLStaging::STATE_PENDING);
+        while (thread.update(0.f))
+        {
+        }
+        ensure("ready", staging->isReady());
+        ensure("source", staging->getSource() == raw.get());
+
+        FSImageGLStaging* pooled = staging;
+        thread.release(staging);
+        ensure("released", staging.isNull());
+        staging = thread.stage(raw, make_params(raw, 6));
+        ensure("reused", staging.get() == pooled);
+
+        // dropped before the thread got to it
+        staging = NULL;
+        while (thread.update(0.f))
+        {
+        }
+
+        staging = thread.stage(raw, make_params(raw, 7));
+        while (thread.update(0.f))
+        {
+        }
+        ensure_equals("bad params fail", staging->getState(), FSImageGLStaging::STATE_FAILED);
+        thread.shutdown();
+    }
+
+    // Headless benchmark of the CPU half of an upload: what the main thread
+    // spent per frame before, and what it spends now that it only queues.
+    template<> template<>
+    void FSImageGLStagingTest_t::test<5>()
+    {
+        skip_unless_benchmarks();
+
+        const S32 TEXTURES = 32;
+
+        std::cout << std::endl << "FSImageGLStaging, " << TEXTURES << " RGBA textures with mips, mask and pick mask" << std::endl;
+        std::cout << std::setw(8) << "size" << std::setw(14) << "inline ms" << std::setw(14) << "MPix/s"
+                  << std::setw(14) << "queue ms" << std::setw(14) << "thread ms" << std::setw(14) << "MPix/s" << std::endl;
+
+        const S32 sizes[] = { 128, 256, 512, 1024 };
+        for (S32 size : sizes)
+        {
+            std::vector<LLPointer<LLImageRaw> > images;
+            for (S32 i = 0; i < TEXTURES; ++i)
+            {
+                images.push_back(makeImage(size, size, 4));
+            }
+            const F64 mpix = (F64)size * size * TEXTURES / 1000000.0;
+
+            // inline, as setImage() did it
+            LLPointer<FSImageGLStaging> staging = new FSImageGLStaging();
+            LLTimer timer;
+            for (S32 i = 0; i < TEXTURES; ++i)
+            {
+                ensure("staged", staging->stage(images[i], make_params(images[i], full_levels(size, size))));
+            }
+            F64 inline_ms = timer.getElapsedTimeF64() * 1000.0;
+            staging = NULL;
+
+            // queued on the staging thread
+            FSImageGLStagingThread thread;
+            std::vector<LLPointer<FSImageGLStaging> > stagings;
+            timer.reset();
+            for (S32 i = 0; i < TEXTURES; ++i)
+            {
+                stagings.push_back(thread.stage(images[i], make_params(images[i], full_levels(size, size))));
+            }
+            F64 queue_ms = timer.getElapsedTimeF64() * 1000.0;
+            for (S32 i = 0; i < TEXTURES; ++i)
+            {
+                while (!stagings[i]->isDone())
+                {
+                    thread.update(0.f);
+                    ms_sleep(0);
+                }
+                ensure("thread staged", stagings[i]->isReady());
+            }
+            F64 thread_ms = timer.getElapsedTimeF64() * 1000.0;
+            for (S32 i = 0; i < TEXTURES; ++i)
+            {
+                thread.release(stagings[i]);
+            }
+            thread.shutdown();
+
+            std::cout << std::setw(8) << size << std::fixed << std::setprecision(2)
+                      << std::setw(14) << inline_ms << std::setw(14) << mpix / (inline_ms / 1000.0)
+                      << std::setw(14) << queue_ms << std::setw(14) << thread_ms << std::setw(14) << mpix / (thread_ms / 1000.0)
+                      << std::endl;
+        }
+    }
+}
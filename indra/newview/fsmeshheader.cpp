@@ -0,0 +1,438 @@
+/**
+ * @file fsmeshheader.cpp
+ * @brief Compact mesh asset header and the table LLMeshRepoThread keeps them in.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsmeshheader.h"
+
+#include "llsd.h"
+
+#include <cstring>
+
+// Same names and order as header_lod[] in llmeshrepository.cpp
+static const char* const BLOCK_NAMES[FSMeshHeader::BLOCK_COUNT] =
+{
+    "lowest_lod",
+    "low_lod",
+    "medium_lod",
+    "high_lod",
+    "skin",
+    "physics_convex",
+    "physics_mesh"
+};
+
+// Mesh headers are two levels deep; anything past this is not a mesh header
+static const S32 MAX_SKIP_DEPTH = 16;
+
+static const size_t INITIAL_CAPACITY = 256;
+
+namespace
+{
+    // Bounds checked reader for uncompressed binary LLSD, see LLSDBinaryParser
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const U8* data, S32 size)
+        :   mPos(data),
+            mEnd(data + size)
+        {
+        }
+
+        size_t left() const { return mEnd - mPos; }
+        const U8* pos() const { return mPos; }
+
+        bool readType(char& type)
+        {
+            if (mPos == mEnd)
+            {
+                return false;
+            }
+            type = (char)*mPos++;
+            return true;
+        }
+
+        bool readU32(U32& value)
+        {
+            if (left() < 4)
+            {
+                return false;
+            }
+            // network byte order
+            value = ((U32)mPos[0] << 24) | ((U32)mPos[1] << 16) | ((U32)mPos[2] << 8) | (U32)mPos[3];
+            mPos += 4;
+            return true;
+        }
+
+        bool skip(size_t size)
+        {
+            if (left() < size)
+            {
+                return false;
+            }
+            mPos += size;
+            return true;
+        }
+
+        // Only 'k' keys, notation style keys make the caller fall back to LLSDSerialize
+        bool readKey(const char*& key, U32& size)
+        {
+            char type;
+            if (!readType(type) || type != 'k' || !readU32(size) || left() < size)
+            {
+                return false;
+            }
+            key = (const char*)mPos;
+            mPos += size;
+            return true;
+        }
+
+        bool readInteger(char type, S32& value)
+        {
+            U32 raw;
+            if (type != 'i' || !readU32(raw))
+            {
+                return false;
+            }
+            value = (S32)raw;
+            return true;
+        }
+
+        bool skipValue(char type, S32 depth);
+
+    private:
+        const U8* mPos;
+        const U8* mEnd;
+    };
+
+    bool BinaryReader::skipValue(char type, S32 depth)
+    {
+        if (depth <= 0)
+        {
+            return false;
+        }
+
+        U32 size;
+        switch (type)
+        {
+        case '!':
+        case '0':
+        case '1':
+            return true;
+        case 'i':
+            return skip(4);
+        case 'r':
+        case 'd':
+            return skip(8);
+        case 'u':
+            return skip(UUID_BYTES);
+        case 's':
+        case 'l':
+        case 'b':
+            return readU32(size) && skip(size);
+        case '[':
+        case '{':
+        {
+            if (!readU32(size))
+            {
+                return false;
+            }
+            for (U32 i = 0; i < size; ++i)
+            {
+                const char* key;
+                U32 key_size;
+                char child_type;
+                if ((type == '{' && !readKey(key, key_size))
+                    || !readType(child_type)
+                    || !skipValue(child_type, depth - 1))
+                {
+                    return false;
+                }
+            }
+            char close;
+            return readType(close) && close == (type == '{' ? '}' : ']');
+        }
+        default:
+            return false;
+        }
+    }
+
+    bool key_equals(const char* key, U32 key_size, const char* name)
+    {
+        return strlen(name) == key_size && !memcmp(key, name, key_size);
+    }
+
+    bool parse_block(BinaryReader& reader, FSMeshHeader::Block& block)
+    {
+        block.mOffset = 0;
+        block.mSize = 0;
+
+        U32 count;
+        if (!reader.readU32(count))
+        {
+            return false;
+        }
+        for (U32 i = 0; i < count; ++i)
+        {
+            const char* key;
+            U32 key_size;
+            char type;
+            if (!reader.readKey(key, key_size) || !reader.readType(type))
+            {
+                return false;
+            }
+            if (key_equals(key, key_size, "offset"))
+            {
+                if (!reader.readInteger(type, block.mOffset))
+                {
+                    return false;
+                }
+            }
+            else if (key_equals(key, key_size, "size"))
+            {
+                if (!reader.readInteger(type, block.mSize))
+                {
+                    return false;
+                }
+            }
+            else if (!reader.skipValue(type, MAX_SKIP_DEPTH))
+            {
+                return false;
+            }
+        }
+        char close;
+        return reader.readType(close) && close == '}';
+    }
+}
+
+FSMeshHeader::FSMeshHeader()
+:   mVersion(0),
+    mHeaderSize(0),
+    mBlockMask(0),
+    mHasVersion(false),
+    m404(false)
+{
+    memset(mBlocks, 0, sizeof(mBlocks));
+}
+
+bool FSMeshHeader::parse(const U8* data, S32 size, S32& used)
+{
+    *this = FSMeshHeader();
+    used = 0;
+    if (!data || size <= 0)
+    {
+        return false;
+    }
+
+    BinaryReader reader(data, size);
+    char type;
+    U32 count;
+    if (!reader.readType(type) || type != '{' || !reader.readU32(count))
+    {
+        return false;
+    }
+
+    for (U32 i = 0; i < count; ++i)
+    {
+        const char* key;
+        U32 key_size;
+        if (!reader.readKey(key, key_size) || !reader.readType(type))
+        {
+            return false;
+        }
+
+        S32 block = 0;
+        while (block < BLOCK_COUNT && !key_equals(key, key_size, BLOCK_NAMES[block]))
+        {
+            ++block;
+        }
+
+        if (block < BLOCK_COUNT)
+        {
+            if (type != '{' || !parse_block(reader, mBlocks[block]))
+            {
+                return false;
+            }
+            mBlockMask |= 1 << block;
+        }
+        else if (key_equals(key, key_size, "version"))
+        {
+            if (!reader.readInteger(type, mVersion))
+            {
+                return false;
+            }
+            mHasVersion = true;
+        }
+        else if (key_equals(key, key_size, "creator") && type == 'u')
+        {
+            const U8* uuid = reader.pos();
+            if (!reader.skip(UUID_BYTES))
+            {
+                return false;
+            }
+            memcpy(mCreator.mData, uuid, UUID_BYTES);
+        }
+        else
+        {
+            if (key_equals(key, key_size, "404"))
+            {
+                m404 = true;
+            }
+            if (!reader.skipValue(type, MAX_SKIP_DEPTH))
+            {
+                return false;
+            }
+        }
+    }
+
+    if (!reader.readType(type) || type != '}')
+    {
+        return false;
+    }
+    used = (S32)(reader.pos() - data);
+    return true;
+}
+
+void FSMeshHeader::fromLLSD(const LLSD& header)
+{
+    *this = FSMeshHeader();
+
+    m404 = header.has("404");
+    mHasVersion = header.has("version");
+    mVersion = header["version"].asInteger();
+    if (header["creator"].isUUID())
+    {
+        mCreator = header["creator"].asUUID();
+    }
+
+    for (S32 block = 0; block < BLOCK_COUNT; ++block)
+    {
+        if (header.has(BLOCK_NAMES[block]))
+        {
+            const LLSD& data = header[BLOCK_NAMES[block]];
+            mBlocks[block].mOffset = data["offset"].asInteger();
+            mBlocks[block].mSize = data["size"].asInteger();
+            mBlockMask |= 1 << block;
+        }
+    }
+}
+
+FSMeshHeaderMap::FSMeshHeaderMap()
+:   mSize(0),
+    mHasNullHeader(false)
+{
+}
+
+size_t FSMeshHeaderMap::findSlot(const LLUUID& id) const
+{
+    // Mesh ids are random, but mix anyway in case some grid hands out
+    // sequential ones
+    U64 hash;
+    memcpy(&hash, id.mData, sizeof(hash));
+    hash = (hash ^ (hash >> 29)) * 0x9E3779B97F4A7C15ULL;
+
+    const size_t mask = mSlots.size() - 1;
+    size_t slot = (size_t)(hash >> 32) & mask;
+    while (mSlots[slot].mID != id && mSlots[slot].mID.notNull())
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+const FSMeshHeader* FSMeshHeaderMap::find(const LLUUID& id) const
+{
+    if (id.isNull())
+    {
+        return mHasNullHeader ? &mNullHeader : NULL;
+    }
+    if (!mSize)
+    {
+        return NULL;
+    }
+    const Slot& slot = mSlots[findSlot(id)];
+    return slot.mID.notNull() ? &slot.mHeader : NULL;
+}
+
+FSMeshHeader* FSMeshHeaderMap::find(const LLUUID& id)
+{
+    return const_cast<FSMeshHeader*>(static_cast<const FSMeshHeaderMap*>(this)->find(id));
+}
+
+bool FSMeshHeaderMap::get(const LLUUID& id, FSMeshHeader& header) const
+{
+    const FSMeshHeader* found = find(id);
+    if (found)
+    {
+        header = *found;
+        return true;
+    }
+    return false;
+}
+
+void FSMeshHeaderMap::set(const LLUUID& id, const FSMeshHeader& header)
+{
+    if (id.isNull())
+    {
+        mNullHeader = header;
+        mHasNullHeader = true;
+        return;
+    }
+
+    // keep the load below 70%, linear probing degrades quickly past that
+    if ((mSize + 1) * 10 > mSlots.size() * 7)
+    {
+        grow();
+    }
+
+    Slot& slot = mSlots[findSlot(id)];
+    if (slot.mID.isNull())
+    {
+        slot.mID = id;
+        ++mSize;
+    }
+    slot.mHeader = header;
+}
+
+void FSMeshHeaderMap::grow()
+{
+    std::vector<Slot> old_slots(mSlots.empty() ? INITIAL_CAPACITY : mSlots.size() * 2);
+    old_slots.swap(mSlots);
+    for (const Slot& slot : old_slots)
+    {
+        if (slot.mID.notNull())
+        {
+            mSlots[findSlot(slot.mID)] = slot;
+        }
+    }
+}
+
+void FSMeshHeaderMap::clear()
+{
+    std::vector<Slot>().swap(mSlots);
+    mSize = 0;
+    mHasNullHeader = false;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file fsmeshheader.h
+ * @brief Compact mesh asset header and the table LLMeshRepoThread keeps them in.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_MESHHEADER_H
+#define FS_MESHHEADER_H
+
+#include "lluuid.h"
+
+#include <vector>
+
+class LLSD;
+
+/**
+ * The parts of a mesh asset header the viewer uses
+ * (see http://wiki.secondlife.com/wiki/Mesh/Mesh_Asset_Format),
+ * flattened into a fixed size record instead of an LLSD map.
+ */
+class FSMeshHeader
+{
+public:
+    enum EBlock
+    {
+        BLOCK_LOWEST_LOD = 0,   // the four LODs match the LLModel LOD order
+        BLOCK_LOW_LOD,
+        BLOCK_MEDIUM_LOD,
+        BLOCK_HIGH_LOD,
+        BLOCK_SKIN,
+        BLOCK_PHYSICS_CONVEX,
+        BLOCK_PHYSICS_MESH,
+        BLOCK_COUNT
+    };
+
+    struct Block
+    {
+        S32 mOffset;
+        S32 mSize;
+    };
+
+    FSMeshHeader();
+
+    // Parses the binary LLSD header map at data, with any deprecated
+    // "<? LLSD/Binary ?>" line already stripped. used receives the length
+    // of the map. Returns false if the data is not a binary LLSD map or a
+    // field the viewer reads has an unexpected type; callers then fall back
+    // to LLSDSerialize and fromLLSD().
+    bool parse(const U8* data, S32 size, S32& used);
+    void fromLLSD(const LLSD& header);
+
+    bool hasBlock(EBlock block) const { return (mBlockMask & (1 << block)) != 0; }
+    const Block& getBlock(EBlock block) const { return mBlocks[block]; }
+    const Block& getLOD(S32 lod) const { return mBlocks[BLOCK_LOWEST_LOD + lod]; }
+
+    Block   mBlocks[BLOCK_COUNT];
+    LLUUID  mCreator;
+    S32     mVersion;
+    // Bytes before the first block, 0 until the header has been received
+    // and validated by LLMeshRepoThread::headerReceived()
+    U32     mHeaderSize;
+    U16     mBlockMask;     // blocks present in the header, even if empty
+    bool    mHasVersion;
+    bool    m404;           // asset missing or unusable, stands in for the old "404" key
+};
+
+/**
+ * Open addressing (linear probing) hash table from mesh id to header.
+ * Headers are stored inline, so a lookup touches one or two cache lines
+ * and copying a header out is a plain memcpy. Entries are never removed,
+ * like the std::map it replaces. Not thread safe; LLMeshRepoThread guards
+ * it with mHeaderMutex. Pointers returned by find() are invalidated by
+ * set() and clear().
+ */
+class FSMeshHeaderMap
+{
+public:
+    FSMeshHeaderMap();
+
+    const FSMeshHeader* find(const LLUUID& id) const;
+    FSMeshHeader* find(const LLUUID& id);
+    // Copies the header out, returns false if id is unknown
+    bool get(const LLUUID& id, FSMeshHeader& header) const;
+    // Adds or replaces the header of id
+    void set(const LLUUID& id, const FSMeshHeader& header);
+    void clear();
+
+    size_t size() const { return mSize + (mHasNullHeader ? 1 : 0); }
+    size_t capacity() const { return mSlots.size(); }
+
+private:
+    struct Slot
+    {
+        LLUUID          mID;
+        FSMeshHeader    mHeader;
+    };
+
+    size_t findSlot(const LLUUID& id) const;
+    void grow();
+
+    // A null id marks a free slot, so a header stored for the null id
+    // lives on its own
+    std::vector<Slot>   mSlots;
+    size_t              mSize;
+    FSMeshHeader        mNullHeader;
+    bool                mHasNullHeader;
+};
+
+#endif // FS_MESHHEADER_H
@@ -0,0 +1,120 @@
+/**
+ * @file fsobjectlookup.cpp
+ * @brief Open addressing hash tables for LLViewerObjectList lookups.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsobjectlookup.h"
+
+static const size_t MIN_SLOTS = 64;
+
+FSFlatHashIndex::FSFlatHashIndex()
+:   mCount(0)
+{
+}
+
+void FSFlatHashIndex::insert(U32 hash, U32 handle)
+{
+    llassert(handle != NO_HANDLE);
+
+    // Keep the load factor at or below 1/2
+    if ((mCount + 1) * 2 > mSlots.size())
+    {
+        rehash(llmax(MIN_SLOTS, mSlots.size() * 2));
+    }
+
+    const U32 mask = (U32)mSlots.size() - 1;
+    U32 pos = hash & mask;
+    while (mSlots[pos].mHandle != NO_HANDLE)
+    {
+        pos = (pos + 1) & mask;
+    }
+    mSlots[pos].mHash = hash;
+    mSlots[pos].mHandle = handle;
+    ++mCount;
+}
+
+void FSFlatHashIndex::erase(S32 pos)
+{
+    // Backward shift deletion: move following entries of the probe
+    // sequence into the hole so lookups never need tombstones.
+    const U32 mask = (U32)mSlots.size() - 1;
+    U32 hole = (U32)pos;
+    for (U32 next = (hole + 1) & mask; mSlots[next].mHandle != NO_HANDLE; next = (next + 1) & mask)
+    {
+        U32 home = mSlots[next].mHash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            mSlots[hole] = mSlots[next];
+            hole = next;
+        }
+    }
+    mSlots[hole].mHandle = NO_HANDLE;
+    --mCount;
+}
+
+void FSFlatHashIndex::clear()
+{
+    mSlots.clear();
+    mCount = 0;
+}
+
+void FSFlatHashIndex::reserve(U32 count)
+{
+    size_t slot_count = MIN_SLOTS;
+    while (slot_count < (size_t)count * 2)
+    {
+        slot_count *= 2;
+    }
+    if (slot_count > mSlots.size())
+    {
+        rehash(slot_count);
+    }
+}
+
+void FSFlatHashIndex::rehash(size_t slot_count)
+{
+    std::vector<Slot> old_slots(slot_count);
+    old_slots.swap(mSlots);
+    for (Slot& slot : mSlots)
+    {
+        slot.mHandle = NO_HANDLE;
+    }
+
+    const U32 mask = (U32)slot_count - 1;
+    for (const Slot& slot : old_slots)
+    {
+        if (slot.mHandle != NO_HANDLE)
+        {
+            U32 pos = slot.mHash & mask;
+            while (mSlots[pos].mHandle != NO_HANDLE)
+            {
+                pos = (pos + 1) & mask;
+            }
+            mSlots[pos] = slot;
+        }
+    }
+}
@@ -0,0 +1,245 @@
+/**
+ * @file fsobjectlookup.h
+ * @brief Open addressing hash tables for LLViewerObjectList lookups.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_OBJECTLOOKUP_H
+#define FS_OBJECTLOOKUP_H
+
+#include "lluuid.h"
+
+#include <vector>
+
+/**
+ * The probing part of FSFlatHashMap: open addressing (linear probing,
+ * backward shift deletion) over slots that hold only a 32 bit hash and a
+ * handle. A probe compares hashes and reads an entry only when they match,
+ * and growing or erasing never needs the keys.
+ */
+class FSFlatHashIndex
+{
+public:
+    static const U32 NO_HANDLE = 0xffffffff;
+
+    FSFlatHashIndex();
+
+    // Position of the slot holding a handle for which match(handle) is
+    // true among those stored under hash, or -1
+    template <typename MATCH>
+    S32 find(U32 hash, const MATCH& match) const
+    {
+        if (!mCount)
+        {
+            return -1;
+        }
+        const U32 mask = (U32)mSlots.size() - 1;
+        for (U32 pos = hash & mask; mSlots[pos].mHandle != NO_HANDLE; pos = (pos + 1) & mask)
+        {
+            if (mSlots[pos].mHash == hash && match(mSlots[pos].mHandle))
+            {
+                return (S32)pos;
+            }
+        }
+        return -1;
+    }
+
+    U32 getHandle(S32 pos) const { return mSlots[pos].mHandle; }
+
+    // The caller makes sure the key is not in the index yet
+    void insert(U32 hash, U32 handle);
+    void erase(S32 pos);
+    void clear();
+    void reserve(U32 count);
+
+    U32 size() const { return mCount; }
+    size_t capacity() const { return mSlots.size(); }
+
+private:
+    struct Slot
+    {
+        U32 mHash;
+        U32 mHandle;    // NO_HANDLE if the slot is empty
+    };
+
+    void rehash(size_t slot_count);
+
+    std::vector<Slot>   mSlots;     // Size is zero or a power of two
+    U32                 mCount;
+};
+
+/**
+ * Hash map for the lookups on every object update. Values live in a dense
+ * array and are addressed by handles that stay valid until their key is
+ * erased, whatever else is added or removed; the index only moves the
+ * small slots around. Not thread safe, LLViewerObjectList uses it from the
+ * main thread only.
+ */
+template <typename KEY, typename VALUE, typename HASH>
+class FSFlatHashMap
+{
+public:
+    typedef U32 handle_t;
+    static const handle_t INVALID_HANDLE = FSFlatHashIndex::NO_HANDLE;
+
+    handle_t find(const KEY& key) const
+    {
+        S32 pos = findSlot(key, HASH()(key));
+        return pos >= 0 ? mIndex.getHandle(pos) : INVALID_HANDLE;
+    }
+
+    // NULL if key is not in the map
+    VALUE* findValue(const KEY& key)
+    {
+        handle_t handle = find(key);
+        return handle != INVALID_HANDLE ? &mEntries[handle].mValue : NULL;
+    }
+
+    const VALUE* findValue(const KEY& key) const
+    {
+        handle_t handle = find(key);
+        return handle != INVALID_HANDLE ? &mEntries[handle].mValue : NULL;
+    }
+
+    const KEY& getKey(handle_t handle) const { return mEntries[handle].mKey; }
+    VALUE& getValue(handle_t handle) { return mEntries[handle].mValue; }
+    const VALUE& getValue(handle_t handle) const { return mEntries[handle].mValue; }
+
+    // Adds key or replaces its value, returns its handle
+    handle_t insert(const KEY& key, const VALUE& value)
+    {
+        const U32 hash = HASH()(key);
+        S32 pos = findSlot(key, hash);
+        if (pos >= 0)
+        {
+            handle_t handle = mIndex.getHandle(pos);
+            // The old value goes once the map is consistent again, its
+            // destructor may well come back here
+            VALUE replaced = mEntries[handle].mValue;
+            mEntries[handle].mValue = value;
+            return handle;
+        }
+
+        handle_t handle;
+        if (!mFreeHandles.empty())
+        {
+            handle = mFreeHandles.back();
+            mFreeHandles.pop_back();
+            mEntries[handle].mKey = key;
+            mEntries[handle].mValue = value;
+        }
+        else
+        {
+            handle = (handle_t)mEntries.size();
+            mEntries.push_back(Entry(key, value));
+        }
+        mIndex.insert(hash, handle);
+        return handle;
+    }
+
+    // Returns false if key was not in the map
+    bool erase(const KEY& key)
+    {
+        S32 pos = findSlot(key, HASH()(key));
+        if (pos < 0)
+        {
+            return false;
+        }
+        handle_t handle = mIndex.getHandle(pos);
+        mIndex.erase(pos);
+        // Release what the value holds now, not when the handle is reused,
+        // but only after the map is consistent again
+        VALUE erased = mEntries[handle].mValue;
+        mEntries[handle].mValue = VALUE();
+        mFreeHandles.push_back(handle);
+        return true;
+    }
+
+    void clear()
+    {
+        std::vector<Entry> entries;
+        entries.swap(mEntries);
+        mIndex.clear();
+        mFreeHandles.clear();
+    }
+
+    void reserve(U32 count)
+    {
+        mIndex.reserve(count);
+        mEntries.reserve(count);
+    }
+
+    size_t size() const { return mIndex.size(); }
+    bool empty() const { return !mIndex.size(); }
+
+private:
+    struct Entry
+    {
+        Entry(const KEY& key, const VALUE& value) : mKey(key), mValue(value) {}
+
+        KEY     mKey;
+        VALUE   mValue;
+    };
+
+    struct KeyMatch
+    {
+        KeyMatch(const std::vector<Entry>& entries, const KEY& key) : mEntries(entries), mKey(key) {}
+        bool operator()(U32 handle) const { return mEntries[handle].mKey == mKey; }
+
+        const std::vector<Entry>&   mEntries;
+        const KEY&                  mKey;
+    };
+
+    S32 findSlot(const KEY& key, U32 hash) const
+    {
+        return mIndex.find(hash, KeyMatch(mEntries, key));
+    }
+
+    FSFlatHashIndex         mIndex;
+    std::vector<Entry>      mEntries;
+    std::vector<handle_t>   mFreeHandles;
+};
+
+// Object ids are random, fold both halves so any bits do
+struct FSObjectUUIDHash
+{
+    U32 operator()(const LLUUID& id) const
+    {
+        U64 lo, hi;
+        memcpy(&lo, id.mData, sizeof(U64));
+        memcpy(&hi, id.mData + sizeof(U64), sizeof(U64));
+        return (U32)(((lo ^ (hi * 0x9E3779B97F4A7C15ULL)) * 0xC2B2AE3D27D4EB4FULL) >> 32);
+    }
+};
+
+// Simulator index and local id keys are mostly sequential, spread them
+struct FSObjectIndexHash
+{
+    U32 operator()(U64 key) const
+    {
+        return (U32)(((key ^ (key >> 29)) * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+};
+
+#endif // FS_OBJECTLOOKUP_H
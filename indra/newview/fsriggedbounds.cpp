@@ -0,0 +1,321 @@
+/**
+ * @file fsriggedbounds.cpp
+ * @brief Per joint bounds of rigged mesh faces for picking without a full re-skin.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsriggedbounds.h"
+
+#include "llmodel.h"
+#include "llvolume.h"
+
+namespace
+{
+    // Box of min and max moved by mat, as min and max again
+    inline void transform_box(const LLMatrix4a& mat, const LLVector4a& min, const LLVector4a& max,
+                              LLVector4a& out_min, LLVector4a& out_max)
+    {
+        LLVector4a center;
+        center.setAdd(min, max);
+        center.mul(0.5f);
+        LLVector4a half;
+        half.setSub(max, min);
+        half.mul(0.5f);
+
+        LLVector4a moved_center;
+        mat.affineTransform(center, moved_center);
+
+        // each axis of the box spans |row| * half along it
+        LLVector4a moved_half;
+        LLVector4a axis;
+        LLVector4a row;
+        axis.splat<0>(half);
+        row.setAbs(mat.mMatrix[0]);
+        moved_half.setMul(row, axis);
+        axis.splat<1>(half);
+        row.setAbs(mat.mMatrix[1]);
+        row.mul(axis);
+        moved_half.add(row);
+        axis.splat<2>(half);
+        row.setAbs(mat.mMatrix[2]);
+        row.mul(axis);
+        moved_half.add(row);
+
+        out_min.setSub(moved_center, moved_half);
+        out_max.setAdd(moved_center, moved_half);
+    }
+}
+
+FSRiggedBounds::FSRiggedBounds()
+{
+    clear();
+}
+
+FSRiggedBounds::~FSRiggedBounds()
+{
+}
+
+void FSRiggedBounds::clear()
+{
+    mBoxExtents.resize(0);
+    mBoxJoints.clear();
+    mGroupFirstBox.assign(1, 0);
+    mGroupBounds.resize(0);
+    mFaceFirstGroup.assign(1, 0);
+    mFaceExtents.resize(0);
+    mFaceVertices.clear();
+    mFaceIndices.clear();
+    mVolume = NULL;
+    mSkinMeshID.setNull();
+}
+
+void FSRiggedBounds::setSource(LLVolume* volume, const LLMeshSkinInfo* skin)
+{
+    mVolume = volume;
+    mSkinMeshID = skin ? skin->mMeshID : LLUUID::null;
+}
+
+bool FSRiggedBounds::isSource(const LLVolume* volume, const LLMeshSkinInfo* skin) const
+{
+    return mVolume.notNull() && mVolume.get() == volume && skin && mSkinMeshID == skin->mMeshID;
+}
+
+void FSRiggedBounds::addFace(const LLMatrix4& bind_shape, const LLVector4a* positions, const LLVector4a* weights, S32 vertices,
+                             const U16* indices, S32 index_count, U32 joint_count)
+{
+    mFaceVertices.push_back(vertices);
+    mFaceIndices.push_back(index_count);
+    LLVector4a zero;
+    zero.clear();
+    mFaceExtents.push_back(zero);
+    mFaceExtents.push_back(zero);
+
+    if (vertices > 0 && positions && weights && indices && joint_count > 0)
+    {
+        LLMatrix4a bind_shape_matrix;
+        bind_shape_matrix.loadu(bind_shape);
+
+        // Per vertex: position in bind shape space, joints with a weight
+        // (split the way FSSkinningUtil::getPerVertexSkinMatrixSSE() does)
+        // and the strongest of them. A vertex without any weight is taken
+        // as fully bound to its first joint, as
+        // LLSkinningUtil::getPerVertexSkinMatrix() renders it.
+        vector4a_array_t bound;
+        bound.resize(vertices);
+        std::vector<U32> joints(vertices * 4);
+        std::vector<U8> joint_mask(vertices);
+        std::vector<U32> primary(vertices);
+        for (S32 i = 0; i < vertices; ++i)
+        {
+            bind_shape_matrix.affineTransform(positions[i], bound[i]);
+
+            const F32* w = weights[i].getF32ptr();
+            F32 strongest = 0.f;
+            U8 mask = 0;
+            for (U32 k = 0; k < 4; ++k)
+            {
+                S32 idx = (S32)w[k];
+                F32 weight = w[k] - (F32)idx;
+                if (weight > 0.f)
+                {
+                    U32 joint = (U32)llclamp(idx, 0, (S32)joint_count - 1);
+                    joints[i * 4 + k] = joint;
+                    mask |= 1 << k;
+                    if (weight > strongest)
+                    {
+                        strongest = weight;
+                        primary[i] = joint;
+                    }
+                }
+            }
+            if (!mask)
+            {
+                joints[i * 4] = (U32)llclamp((S32)w[0], 0, (S32)joint_count - 1);
+                primary[i] = joints[i * 4];
+                mask = 1;
+            }
+            joint_mask[i] = mask;
+        }
+
+        // (group, joint) -> box of this face
+        std::vector<S32> slots(joint_count * joint_count, -1);
+        vector4a_array_t extents;
+        for (S32 tri = 0; tri + 2 < index_count; tri += 3)
+        {
+            const U16* index = indices + tri;
+            if (index[0] >= vertices || index[1] >= vertices || index[2] >= vertices)
+            {
+                continue;
+            }
+
+            const U32 group = primary[index[0]];
+
+            for (S32 v = 0; v < 3; ++v)
+            {
+                const U16 i = index[v];
+                for (U32 k = 0; k < 4; ++k)
+                {
+                    if (!(joint_mask[i] & (1 << k)))
+                    {
+                        continue;
+                    }
+                    S32& slot = slots[group * joint_count + joints[i * 4 + k]];
+                    if (slot < 0)
+                    {
+                        slot = extents.size() / 2;
+                        extents.push_back(bound[i]);
+                        extents.push_back(bound[i]);
+                    }
+                    else
+                    {
+                        update_min_max(extents[slot * 2], extents[slot * 2 + 1], bound[i]);
+                    }
+                }
+            }
+        }
+
+        for (U32 group = 0; group < joint_count; ++group)
+        {
+            const size_t first_box = mBoxJoints.size();
+            for (U32 joint = 0; joint < joint_count; ++joint)
+            {
+                S32 slot = slots[group * joint_count + joint];
+                if (slot >= 0)
+                {
+                    mBoxJoints.push_back(joint);
+                    mBoxExtents.push_back(extents[slot * 2]);
+                    mBoxExtents.push_back(extents[slot * 2 + 1]);
+                }
+            }
+            if (mBoxJoints.size() != first_box)
+            {
+                mGroupFirstBox.push_back((U32)mBoxJoints.size());
+                mGroupBounds.push_back(zero);
+                mGroupBounds.push_back(zero);
+            }
+        }
+    }
+
+    mFaceFirstGroup.push_back((U32)mGroupFirstBox.size() - 1);
+}
+
+bool FSRiggedBounds::matchesFace(S32 face, S32 vertices, S32 index_count) const
+{
+    return face < getNumFaces() && mFaceVertices[face] == vertices && mFaceIndices[face] == index_count;
+}
+
+void FSRiggedBounds::update(const LLMatrix4a* palette)
+{
+    for (S32 face = 0; face < getNumFaces(); ++face)
+    {
+        LLVector4a face_min;
+        LLVector4a face_max;
+        face_min.clear();
+        face_max.clear();
+
+        for (U32 group = mFaceFirstGroup[face]; group < mFaceFirstGroup[face + 1]; ++group)
+        {
+            LLVector4a group_min;
+            LLVector4a group_max;
+            for (U32 box = mGroupFirstBox[group]; box < mGroupFirstBox[group + 1]; ++box)
+            {
+                LLVector4a min;
+                LLVector4a max;
+                transform_box(palette[mBoxJoints[box]], mBoxExtents[box * 2], mBoxExtents[box * 2 + 1], min, max);
+                if (box == mGroupFirstBox[group])
+                {
+                    group_min = min;
+                    group_max = max;
+                }
+                else
+                {
+                    group_min.setMin(group_min, min);
+                    group_max.setMax(group_max, max);
+                }
+            }
+
+            LLVector4a& center = mGroupBounds[group * 2];
+            LLVector4a& half = mGroupBounds[group * 2 + 1];
+            center.setAdd(group_min, group_max);
+            center.mul(0.5f);
+            half.setSub(group_max, group_min);
+            half.mul(0.5f);
+
+            if (group == mFaceFirstGroup[face])
+            {
+                face_min = group_min;
+                face_max = group_max;
+            }
+            else
+            {
+                face_min.setMin(face_min, group_min);
+                face_max.setMax(face_max, group_max);
+            }
+        }
+
+        mFaceExtents[face * 2] = face_min;
+        mFaceExtents[face * 2 + 1] = face_max;
+    }
+}
+
+bool FSRiggedBounds::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& end, S32 face) const
+{
+    if (face >= getNumFaces())
+    {
+        // not built for this face, nothing to rule out
+        return true;
+    }
+
+    const S32 first_face = face < 0 ? 0 : face;
+    const S32 last_face = face < 0 ? getNumFaces() : face + 1;
+    for (S32 f = first_face; f < last_face; ++f)
+    {
+        if (mFaceFirstGroup[f] == mFaceFirstGroup[f + 1])
+        {
+            continue;
+        }
+
+        LLVector4a center;
+        LLVector4a half;
+        center.setAdd(mFaceExtents[f * 2], mFaceExtents[f * 2 + 1]);
+        center.mul(0.5f);
+        half.setSub(mFaceExtents[f * 2 + 1], mFaceExtents[f * 2]);
+        half.mul(0.5f);
+        if (!LLLineSegmentBoxIntersect(start, end, center, half))
+        {
+            continue;
+        }
+
+        for (U32 group = mFaceFirstGroup[f]; group < mFaceFirstGroup[f + 1]; ++group)
+        {
+            if (LLLineSegmentBoxIntersect(start, end, mGroupBounds[group * 2], mGroupBounds[group * 2 + 1]))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
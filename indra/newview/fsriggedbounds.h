@@ -0,0 +1,109 @@
+/**
+ * @file fsriggedbounds.h
+ * @brief Per joint bounds of rigged mesh faces for picking without a full re-skin.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_RIGGEDBOUNDS_H
+#define FS_RIGGEDBOUNDS_H
+
+#include "llalignedarray.h"
+#include "llmath.h"
+#include "llmatrix4a.h"
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "lluuid.h"
+#include "llvector4a.h"
+
+#include <vector>
+
+class LLMeshSkinInfo;
+class LLVolume;
+
+/**
+ * Conservative bounds of the skinned faces of a rigged volume, cheap enough
+ * to keep current every frame. LLVOVolume::lineSegmentIntersect() tests
+ * them first and only re-skins the whole LLRiggedVolume when a segment
+ * gets close.
+ *
+ * A skinned vertex is a weighted average of the vertex moved by each of its
+ * joints, so it lies in the convex hull of those positions. The triangles
+ * of a face are grouped by the strongest joint of their first vertex; for
+ * every joint the group's vertices are weighted to, a box of those vertices
+ * in bind shape space is kept. Moving each box by its joint's skinning
+ * matrix and taking the union over the group bounds every vertex, and so
+ * every triangle, of the group in any pose.
+ */
+class FSRiggedBounds : public LLRefCount
+{
+public:
+    FSRiggedBounds();
+
+    void clear();
+
+    // What the faces were built from, to tell when to rebuild. The volume
+    // is held so its address cannot come back as another volume; the skin
+    // info is not reference counted and is compared by its mesh.
+    void setSource(LLVolume* volume, const LLMeshSkinInfo* skin);
+    bool isSource(const LLVolume* volume, const LLMeshSkinInfo* skin) const;
+
+    // Adds the next face from the source volume. joint_count is the size
+    // of the skinning palette, LLSkinningUtil::getMeshJointCount().
+    void addFace(const LLMatrix4& bind_shape, const LLVector4a* positions, const LLVector4a* weights, S32 vertices,
+                 const U16* indices, S32 index_count, U32 joint_count);
+
+    S32 getNumFaces() const { return (S32)mFaceVertices.size(); }
+    // Whether face was built from a face of this size
+    bool matchesFace(S32 face, S32 vertices, S32 index_count) const;
+
+    // Moves the boxes into the pose of palette, as filled by
+    // LLDrawPoolAvatar::getCacheSkinningMats()
+    void update(const LLMatrix4a* palette);
+
+    // Min and max of the skinned face after update()
+    const LLVector4a* getFaceExtents(S32 face) const { return &mFaceExtents[face * 2]; }
+
+    // False when the segment misses face, or every face for -1, in the
+    // pose of the last update()
+    bool lineSegmentIntersect(const LLVector4a& start, const LLVector4a& end, S32 face = -1) const;
+
+private:
+    typedef LLAlignedArray<LLVector4a, 16> vector4a_array_t;
+
+    vector4a_array_t    mBoxExtents;        // min and max per box, in bind shape space
+    std::vector<U32>    mBoxJoints;
+    std::vector<U32>    mGroupFirstBox;     // boxes of group g are [mGroupFirstBox[g], mGroupFirstBox[g + 1])
+    vector4a_array_t    mGroupBounds;       // center and half size per group, after update()
+    std::vector<U32>    mFaceFirstGroup;    // same for the groups of each face
+    vector4a_array_t    mFaceExtents;       // min and max per face, after update()
+    std::vector<S32>    mFaceVertices;
+    std::vector<S32>    mFaceIndices;
+    LLPointer<LLVolume> mVolume;
+    LLUUID              mSkinMeshID;
+
+protected:
+    /*virtual*/ ~FSRiggedBounds();
+};
+
+#endif // FS_RIGGEDBOUNDS_H
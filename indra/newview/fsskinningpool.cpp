@@ -0,0 +1,298 @@
+/**
+ * @file fsskinningpool.cpp
+ * @brief Software skinning of rigged mesh faces on a pool of worker threads.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsskinningpool.h"
+
+#include <boost/thread.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FS_SKINNING_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define FS_TARGET_AVX
+#else
+#define FS_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+namespace
+{
+    // Vertices per job; a face bigger than this is shared between threads
+    const U32 SKIN_CHUNK_VERTICES = 2048;
+    const U32 MAX_SKIN_THREADS = 8;
+
+    // Joint indices and normalized weights, exactly as
+    // FSSkinningUtil::getPerVertexSkinMatrixSSE() takes them apart
+    inline void split_weights(const LLVector4a& weights, __m128i max_idx, S32* idx, F32* wght)
+    {
+        __m128i _mIdx = _mm_cvttps_epi32((__m128)weights);
+        __m128 _mWeight = _mm_sub_ps((__m128)weights, _mm_cvtepi32_ps(_mIdx));
+
+        _mIdx = _mm_min_epi16(_mIdx, max_idx);
+        _mm_store_si128((__m128i*)idx, _mIdx);
+
+        __m128 _mScale = _mm_add_ps(_mWeight, _mm_movehl_ps(_mWeight, _mWeight));
+        _mScale = _mm_add_ss(_mScale, _mm_shuffle_ps(_mScale, _mScale, 1));
+        _mScale = _mm_shuffle_ps(_mScale, _mScale, 0);
+
+        _mWeight = _mm_div_ps(_mWeight, _mScale);
+        _mm_store_ps(wght, _mWeight);
+    }
+
+    // The rest of the per vertex work of updateRiggedFaceVertexBuffer()
+    inline void transform_vertex(const FSSkinningJob& job, LLMatrix4a& bind_shape_matrix, LLMatrix4a& final_mat, U32 j)
+    {
+        LLVector4a t;
+        LLVector4a dst;
+        bind_shape_matrix.affineTransform(job.mPositions[j], t);
+        final_mat.affineTransform(t, dst);
+        job.mOutPositions[j] = dst;
+
+        if (job.mOutNormals)
+        {
+            bind_shape_matrix.rotate(job.mNormals[j], t);
+            final_mat.rotate(t, dst);
+            job.mOutNormals[j] = dst;
+        }
+    }
+
+    void skin_sse2(const FSSkinningJob& job)
+    {
+        LLMatrix4a bind_shape_matrix;
+        bind_shape_matrix.loadu(*job.mBindShape);
+
+        const __m128i max_idx = _mm_set1_epi16((short)(job.mMaxJoints - 1));
+        LL_ALIGN_16(S32 idx[4]);
+        LL_ALIGN_16(F32 wght[4]);
+
+        for (U32 j = job.mBegin; j < job.mEnd; ++j)
+        {
+            split_weights(job.mWeights[j], max_idx, idx, wght);
+
+            LLMatrix4a final_mat;
+            final_mat.clear();
+            for (U32 k = 0; k < 4; ++k)
+            {
+                LLMatrix4a src;
+                src.setMul(job.mPalette[idx[k]], wght[k]);
+                final_mat.add(src);
+            }
+
+            transform_vertex(job, bind_shape_matrix, final_mat, j);
+        }
+    }
+
+#ifdef FS_SKINNING_X86
+    // Two rows per ymm register; the same multiplies and adds in the same
+    // order as LLMatrix4a::setMul() and add(), so the result is identical
+    FS_TARGET_AVX void skin_avx(const FSSkinningJob& job)
+    {
+        LLMatrix4a bind_shape_matrix;
+        bind_shape_matrix.loadu(*job.mBindShape);
+
+        const __m128i max_idx = _mm_set1_epi16((short)(job.mMaxJoints - 1));
+        LL_ALIGN_16(S32 idx[4]);
+        LL_ALIGN_16(F32 wght[4]);
+
+        for (U32 j = job.mBegin; j < job.mEnd; ++j)
+        {
+            split_weights(job.mWeights[j], max_idx, idx, wght);
+
+            __m256 lo = _mm256_setzero_ps();
+            __m256 hi = _mm256_setzero_ps();
+            for (U32 k = 0; k < 4; ++k)
+            {
+                const F32* mat = job.mPalette[idx[k]].mMatrix[0].getF32ptr();
+                const __m256 w = _mm256_set1_ps(wght[k]);
+                lo = _mm256_add_ps(lo, _mm256_mul_ps(_mm256_loadu_ps(mat), w));
+                hi = _mm256_add_ps(hi, _mm256_mul_ps(_mm256_loadu_ps(mat + 8), w));
+            }
+
+            LLMatrix4a final_mat;
+            _mm256_storeu_ps(final_mat.mMatrix[0].getF32ptr(), lo);
+            _mm256_storeu_ps(final_mat.mMatrix[2].getF32ptr(), hi);
+
+            transform_vertex(job, bind_shape_matrix, final_mat, j);
+        }
+    }
+#endif
+}
+
+FSSkinningPool::Worker::Worker(FSSkinningPool* pool, U32 index)
+:   LLThread(llformat("skinning%u", index + 1)),
+    mPool(pool)
+{
+}
+
+void FSSkinningPool::Worker::run()
+{
+    U32 generation = 0;
+    while (!isQuitting() && mPool->waitForBatch(generation))
+    {
+        while (mPool->runNext())
+        {
+        }
+    }
+}
+
+FSSkinningPool::FSSkinningPool(U32 threads, bool avx)
+:   mAVX(avx),
+    mNextJob(0),
+    mJobsDone(0),
+    mGeneration(0),
+    mQuitting(false)
+{
+#ifndef FS_SKINNING_X86
+    mAVX = false;
+#endif
+
+    if (threads == 0)
+    {
+        // Half the cores: the texture decode pool and the driver want the rest
+        threads = llclamp((U32)boost::thread::hardware_concurrency() / 2, 1U, MAX_SKIN_THREADS);
+    }
+    threads = llmin(threads, MAX_SKIN_THREADS);
+
+    // The thread calling run() is one of them
+    for (U32 i = 1; i < threads; ++i)
+    {
+        Worker* worker = new Worker(this, (U32)mThreads.size());
+        mThreads.push_back(worker);
+        worker->start();
+    }
+    LL_INFOS() << "Skinning on " << threads << " thread(s)" << (mAVX ? " with AVX" : "") << LL_ENDL;
+}
+
+FSSkinningPool::~FSSkinningPool()
+{
+    shutdown();
+}
+
+void FSSkinningPool::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mWaitMutex);
+        mQuitting = true;
+    }
+    mWaitCond.notify_all();
+
+    for (Worker* worker : mThreads)
+    {
+        worker->shutdown();
+        delete worker;
+    }
+    mThreads.clear();
+}
+
+void FSSkinningPool::add(const FSSkinningJob& job)
+{
+    std::lock_guard<std::mutex> lock(mJobMutex);
+    FSSkinningJob chunk = job;
+    while (chunk.mBegin < job.mEnd)
+    {
+        chunk.mEnd = llmin(chunk.mBegin + SKIN_CHUNK_VERTICES, job.mEnd);
+        mJobs.push_back(chunk);
+        chunk.mBegin = chunk.mEnd;
+    }
+}
+
+void FSSkinningPool::run()
+{
+    if (mJobs.empty())
+    {
+        return;
+    }
+
+    if (!mThreads.empty() && mJobs.size() > 1)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mWaitMutex);
+            ++mGeneration;
+        }
+        mWaitCond.notify_all();
+    }
+
+    while (runNext())
+    {
+    }
+    // the last jobs may still be running on the workers
+    {
+        std::unique_lock<std::mutex> lock(mDoneMutex);
+        mDoneCond.wait(lock, [this]() { return mJobsDone == mJobs.size(); });
+        mJobsDone = 0;
+    }
+
+    // Reset here rather than when a batch starts: a worker still looping
+    // may already claim the next batch's jobs as they are added
+    std::lock_guard<std::mutex> lock(mJobMutex);
+    mJobs.clear();
+    mNextJob = 0;
+}
+
+bool FSSkinningPool::runNext()
+{
+    FSSkinningJob job;
+    {
+        std::lock_guard<std::mutex> lock(mJobMutex);
+        if (mNextJob >= mJobs.size())
+        {
+            return false;
+        }
+        job = mJobs[mNextJob++];
+    }
+
+    skin(job, mAVX);
+    {
+        std::lock_guard<std::mutex> lock(mDoneMutex);
+        ++mJobsDone;
+    }
+    mDoneCond.notify_one();
+    return true;
+}
+
+bool FSSkinningPool::waitForBatch(U32& generation)
+{
+    std::unique_lock<std::mutex> lock(mWaitMutex);
+    mWaitCond.wait(lock, [&]() { return mGeneration != generation || mQuitting; });
+    generation = mGeneration;
+    return !mQuitting;
+}
+
+// static
+void FSSkinningPool::skin(const FSSkinningJob& job, bool avx)
+{
+#ifdef FS_SKINNING_X86
+    if (avx)
+    {
+        skin_avx(job);
+        return;
+    }
+#endif
+    skin_sse2(job);
+}
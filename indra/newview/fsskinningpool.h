@@ -0,0 +1,126 @@
+/**
+ * @file fsskinningpool.h
+ * @brief Software skinning of rigged mesh faces on a pool of worker threads.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_SKINNINGPOOL_H
+#define FS_SKINNINGPOOL_H
+
+#include "llmath.h"
+#include "llmatrix4a.h"
+#include "llthread.h"
+#include "llvector4a.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+/**
+ * A range of vertices of one rigged face to skin, everything
+ * LLDrawPoolAvatar::updateRiggedFaceVertexBuffer() reads and writes. The
+ * palette, volume face and mapped vertex buffer have to stay put until
+ * FSSkinningPool::run() returns.
+ */
+struct FSSkinningJob
+{
+    const LLMatrix4a*   mPalette;       // LLDrawPoolAvatar::getCacheSkinningMats()
+    const LLMatrix4*    mBindShape;
+    const LLVector4a*   mWeights;       // joint index + weight, as in LLVolumeFace::mWeights
+    const LLVector4a*   mPositions;
+    const LLVector4a*   mNormals;       // NULL when the buffer has no normals
+    LLVector4a*         mOutPositions;  // the mapped vertex buffer
+    LLVector4a*         mOutNormals;
+    U32                 mMaxJoints;     // LLSkinningUtil::getMaxJointCount()
+    U32                 mBegin;
+    U32                 mEnd;
+};
+
+/**
+ * Skins the rigged faces of all avatars in one go. LLDrawPoolAvatar adds a
+ * job per face while preparing its buffers on the render thread, then run()
+ * splits the work between the pool threads and the caller and returns once
+ * every vertex is written. Unmapping the buffers stays with the caller.
+ *
+ * The four weight blend has an AVX path that produces the same bits as the
+ * SSE2 one, see FSSkinningUtil::getPerVertexSkinMatrixSSE().
+ */
+class FSSkinningPool
+{
+public:
+    // threads as FSSkinningThreads: 0 autodetect, 1 only the calling thread
+    FSSkinningPool(U32 threads, bool avx);
+    ~FSSkinningPool();
+
+    void shutdown();
+
+    // Render thread. Large faces are split so the threads share them.
+    void add(const FSSkinningJob& job);
+    bool hasJobs() const { return !mJobs.empty(); }
+    // Render thread. Runs and clears every added job.
+    void run();
+
+    // Worker threads, not counting the caller of run()
+    U32 getThreadCount() const { return (U32)mThreads.size(); }
+    bool useAVX() const { return mAVX; }
+
+    static void skin(const FSSkinningJob& job, bool avx);
+
+private:
+    class Worker : public LLThread
+    {
+    public:
+        Worker(FSSkinningPool* pool, U32 index);
+
+    protected:
+        /*virtual*/ void run();
+
+    private:
+        FSSkinningPool* mPool;
+    };
+    friend class Worker;
+
+    // Skins one job of the current batch, false once there is none left
+    bool runNext();
+    // Worker threads. Blocks until a batch newer than generation starts, false when quitting.
+    bool waitForBatch(U32& generation);
+
+    std::vector<Worker*>        mThreads;
+    std::vector<FSSkinningJob>  mJobs;
+    bool                        mAVX;
+
+    std::mutex                  mJobMutex;      // guards claiming from mJobs
+    size_t                      mNextJob;
+
+    std::mutex                  mDoneMutex;
+    std::condition_variable     mDoneCond;      // run() waits on it for the workers' last jobs
+    size_t                      mJobsDone;
+
+    std::mutex                  mWaitMutex;
+    std::condition_variable     mWaitCond;
+    U32                         mGeneration;    // bumped per batch
+    bool                        mQuitting;
+};
+
+#endif // FS_SKINNINGPOOL_H
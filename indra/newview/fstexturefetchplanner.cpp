@@ -0,0 +1,236 @@
+/**
+ * @file fstexturefetchplanner.cpp
+ * @brief Per host HTTP request planning for LLTextureFetch.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fstexturefetchplanner.h"
+
+#include <cmath>
+
+const F64 FSTextureFetchPlanner::MIN_RTT_WINDOW = 10.0;
+
+namespace
+{
+    const F64 PIPE_GAIN = 2.0;          // slots per bandwidth-delay product, headroom to probe for more
+    const F64 RATE_INTERVAL = 0.5;      // shortest delivery rate sample, in seconds
+    const F64 RATE_WEIGHT = 0.25;       // of a new delivery rate sample
+    const F64 BYTES_WEIGHT = 0.125;     // of a new response size
+}
+
+FSTextureFetchPlanner::Host::Host(const std::string& name)
+:   mName(name),
+    mActive(0),
+    mLimit(-1),
+    mMinRTT(0.0),
+    mMinRTTTime(0.0),
+    mRate(0.0),
+    mAvgBytes(0.0),
+    mIntervalStart(-1.0),
+    mIntervalBytes(0),
+    mIntervalPeak(0),
+    mRequests(0),
+    mSuperseded(0),
+    mBytes(0)
+{
+}
+
+FSTextureFetchPlanner::FSTextureFetchPlanner()
+:   mMaxLimit(S32_MAX)
+{
+}
+
+S32 FSTextureFetchPlanner::getHost(const std::string& url)
+{
+    std::string::size_type start = url.find("://");
+    if (start == std::string::npos)
+    {
+        return -1;
+    }
+    std::string::size_type end = url.find_first_of("/?#", start + 3);
+    std::string name = url.substr(0, end);
+
+    LLMutexLock lock(&mMutex);
+    for (size_t i = 0; i < mHosts.size(); ++i)
+    {
+        if (mHosts[i].mName == name)
+        {
+            return (S32)i;
+        }
+    }
+    mHosts.push_back(Host(name));
+    return (S32)mHosts.size() - 1;
+}
+
+bool FSTextureFetchPlanner::acquire(S32 host)
+{
+    LLMutexLock lock(&mMutex);
+    if (host < 0 || host >= (S32)mHosts.size())
+    {
+        return true;
+    }
+    Host& entry = mHosts[host];
+    if (entry.mActive >= limitFor(entry))
+    {
+        return false;
+    }
+    ++entry.mActive;
+    ++entry.mRequests;
+    entry.mIntervalPeak = llmax(entry.mIntervalPeak, entry.mActive);
+    return true;
+}
+
+void FSTextureFetchPlanner::release(S32 host)
+{
+    LLMutexLock lock(&mMutex);
+    if (host >= 0 && host < (S32)mHosts.size())
+    {
+        Host& entry = mHosts[host];
+        entry.mActive = llmax(entry.mActive - 1, 0);
+    }
+}
+
+void FSTextureFetchPlanner::onResponse(S32 host, F64 now, F64 seconds, S32 bytes)
+{
+    LLMutexLock lock(&mMutex);
+    if (host < 0 || host >= (S32)mHosts.size() || seconds <= 0.0)
+    {
+        return;
+    }
+    Host& entry = mHosts[host];
+
+    // Windowed minimum, so a route change or a congested stretch ages out
+    if (entry.mMinRTT <= 0.0 || seconds < entry.mMinRTT || now - entry.mMinRTTTime > MIN_RTT_WINDOW)
+    {
+        entry.mMinRTT = seconds;
+        entry.mMinRTTTime = now;
+    }
+
+    if (bytes > 0)
+    {
+        entry.mBytes += bytes;
+        entry.mAvgBytes = entry.mAvgBytes > 0.0 ? entry.mAvgBytes + (bytes - entry.mAvgBytes) * BYTES_WEIGHT : bytes;
+        entry.mIntervalBytes += bytes;
+    }
+
+    if (entry.mIntervalStart < 0.0)
+    {
+        // The first response only opens the interval, it has no duration to divide by
+        entry.mIntervalStart = now;
+        entry.mIntervalBytes = 0;
+        entry.mIntervalPeak = entry.mActive;
+        return;
+    }
+    if (now - entry.mIntervalStart >= llmax(RATE_INTERVAL, entry.mMinRTT))
+    {
+        updateLimit(entry, now);
+    }
+}
+
+void FSTextureFetchPlanner::updateLimit(Host& host, F64 now)
+{
+    const F64 rate = host.mIntervalBytes / (now - host.mIntervalStart);
+    // A host that never filled its slots was not limited by the network,
+    // its rate says nothing about how many slots it could use
+    const bool app_limited = host.mLimit >= 0 && host.mIntervalPeak < host.mLimit;
+    if (!app_limited || rate > host.mRate)
+    {
+        host.mRate = host.mRate > 0.0 ? host.mRate + (rate - host.mRate) * RATE_WEIGHT : rate;
+    }
+
+    if (host.mRate > 0.0 && host.mMinRTT > 0.0 && host.mAvgBytes > 0.0)
+    {
+        F64 slots = ceil(PIPE_GAIN * host.mRate * host.mMinRTT / host.mAvgBytes);
+        S32 limit = (S32)llclamp(slots, (F64)MIN_LIMIT, (F64)llmax(mMaxLimit, MIN_LIMIT));
+        if (limit != host.mLimit)
+        {
+            LL_DEBUGS("Texture") << host.mName << " in-flight limit " << limit << ", rtt " << host.mMinRTT * 1000.0
+                                 << " ms, " << host.mRate / 1024.0 << " KB/s" << LL_ENDL;
+        }
+        host.mLimit = limit;
+    }
+
+    host.mIntervalStart = now;
+    host.mIntervalBytes = 0;
+    host.mIntervalPeak = host.mActive;
+}
+
+void FSTextureFetchPlanner::onSuperseded(S32 host)
+{
+    LLMutexLock lock(&mMutex);
+    if (host >= 0 && host < (S32)mHosts.size())
+    {
+        ++mHosts[host].mSuperseded;
+    }
+}
+
+void FSTextureFetchPlanner::setMaxLimit(S32 limit)
+{
+    LLMutexLock lock(&mMutex);
+    mMaxLimit = limit;
+}
+
+S32 FSTextureFetchPlanner::getLimit(S32 host) const
+{
+    LLMutexLock lock(&mMutex);
+    const Host* entry = findHost(host);
+    return entry ? limitFor(*entry) : mMaxLimit;
+}
+
+S32 FSTextureFetchPlanner::getActive(S32 host) const
+{
+    LLMutexLock lock(&mMutex);
+    const Host* entry = findHost(host);
+    return entry ? entry->mActive : 0;
+}
+
+F64 FSTextureFetchPlanner::getMinRTT(S32 host) const
+{
+    LLMutexLock lock(&mMutex);
+    const Host* entry = findHost(host);
+    return entry ? entry->mMinRTT : 0.0;
+}
+
+void FSTextureFetchPlanner::logStats() const
+{
+    LLMutexLock lock(&mMutex);
+    for (const Host& host : mHosts)
+    {
+        LL_INFOS("Texture") << host.mName << ": " << host.mRequests << " requests, " << host.mSuperseded
+                            << " merged into a later range, " << host.mBytes / 1024 << " KB, rtt "
+                            << host.mMinRTT * 1000.0 << " ms, in-flight limit " << limitFor(host) << LL_ENDL;
+    }
+}
+
+const FSTextureFetchPlanner::Host* FSTextureFetchPlanner::findHost(S32 host) const
+{
+    return host >= 0 && host < (S32)mHosts.size() ? &mHosts[host] : NULL;
+}
+
+S32 FSTextureFetchPlanner::limitFor(const Host& host) const
+{
+    return host.mLimit >= 0 ? llmin(host.mLimit, llmax(mMaxLimit, MIN_LIMIT)) : mMaxLimit;
+}
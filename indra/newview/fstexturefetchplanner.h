@@ -0,0 +1,114 @@
+/**
+ * @file fstexturefetchplanner.h
+ * @brief Per host HTTP request planning for LLTextureFetch.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_TEXTUREFETCHPLANNER_H
+#define FS_TEXTUREFETCHPLANNER_H
+
+#include "llmutex.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Decides how LLTextureFetch spends its HTTP requests on each texture host.
+ *
+ * In-flight limit: every host gets as many concurrent requests as it takes
+ * to keep its pipe full, twice the bandwidth-delay product measured from
+ * responses divided by the average response size, between MIN_LIMIT and
+ * the fetcher's high water mark. The round trip is the smallest request
+ * time seen in the last MIN_RTT_WINDOW seconds; the delivery rate is only
+ * allowed to lower the limit when the host had all its slots in use, so an
+ * idle host does not talk itself down.
+ *
+ * Refinement merging: a range that is still waiting in the llcorehttp
+ * ready queue when the texture asks for a better discard is cancelled and
+ * sent again as one larger range, instead of fetching both in turn. The
+ * fetcher does the cancelling, the planner only counts merges.
+ *
+ * Hosts are the scheme and authority of the texture URL. Safe to use from
+ * any thread.
+ */
+class FSTextureFetchPlanner
+{
+public:
+    static const S32 MIN_LIMIT = 4;
+    static const F64 MIN_RTT_WINDOW;
+
+    FSTextureFetchPlanner();
+
+    // Host id for url, -1 when it has no authority
+    S32 getHost(const std::string& url);
+
+    // Per host request slots, on top of LLTextureFetch's own semaphore
+    bool acquire(S32 host);
+    void release(S32 host);
+
+    // A response of bytes arrived seconds after its request was sent, now
+    // is LLTimer::getTotalSeconds() or any other steady clock
+    void onResponse(S32 host, F64 now, F64 seconds, S32 bytes);
+    // A queued request was cancelled for a larger range
+    void onSuperseded(S32 host);
+
+    // Ceiling for every host, the fetcher's high water mark
+    void setMaxLimit(S32 limit);
+
+    S32 getLimit(S32 host) const;
+    S32 getActive(S32 host) const;
+    F64 getMinRTT(S32 host) const;
+
+    void logStats() const;
+
+private:
+    struct Host
+    {
+        Host(const std::string& name);
+
+        std::string mName;
+        S32     mActive;
+        S32     mLimit;             // -1 until measured, then the fetcher's ceiling applies
+        F64     mMinRTT;
+        F64     mMinRTTTime;        // when mMinRTT was taken
+        F64     mRate;              // bytes per second
+        F64     mAvgBytes;          // per response
+        F64     mIntervalStart;
+        S64     mIntervalBytes;
+        S32     mIntervalPeak;      // most slots used since mIntervalStart
+        U32     mRequests;
+        U32     mSuperseded;
+        U64     mBytes;
+    };
+
+    const Host* findHost(S32 host) const;
+    S32 limitFor(const Host& host) const;
+    void updateLimit(Host& host, F64 now);
+
+    mutable LLMutex     mMutex;
+    std::vector<Host>   mHosts;
+    S32                 mMaxLimit;
+};
+
+#endif // FS_TEXTUREFETCHPLANNER_H
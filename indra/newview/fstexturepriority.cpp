@@ -0,0 +1,78 @@
+/**
+ * @file fstexturepriority.cpp
+ * @brief Per frame table for batched texture decode priority updates.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fstexturepriority.h"
+
+#include "llviewertexture.h"
+
+#include <xmmintrin.h>
+
+void FSTexturePriorityTable::clear()
+{
+    mTextures.clear();
+    mInputs.clear();
+    mPixelPriority.clear();
+    mAdditional.clear();
+    mPriority.clear();
+}
+
+void FSTexturePriorityTable::add(LLViewerFetchedTexture* texture, F32 virtual_size, F32 additional, const FSTexturePriorityInput& input)
+{
+    mTextures.push_back(texture);
+    mInputs.push_back(input);
+    mPixelPriority.push_back(llmax(virtual_size, 0.f));
+    mAdditional.push_back(additional);
+}
+
+void FSTexturePriorityTable::compute()
+{
+    const size_t count = mTextures.size();
+    mPriority.resize(count);
+    if (!count)
+    {
+        return;
+    }
+
+    // sqrtps is correctly rounded, so this matches (F32)sqrt(virtual_size)
+    F32* pixel = &mPixelPriority[0];
+    size_t row = 0;
+    for (; row + 4 <= count; row += 4)
+    {
+        _mm_storeu_ps(pixel + row, _mm_sqrt_ps(_mm_loadu_ps(pixel + row)));
+    }
+    for (; row < count; ++row)
+    {
+        pixel[row] = sqrtf(pixel[row]);
+    }
+
+    for (row = 0; row < count; ++row)
+    {
+        mPriority[row] = LLViewerFetchedTexture::calcDecodePriority(mInputs[row], pixel[row], mAdditional[row]);
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file fstexturepriority.h
+ * @brief Per frame table for batched texture decode priority updates.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_TEXTUREPRIORITY_H
+#define FS_TEXTUREPRIORITY_H
+
+#include <vector>
+
+class LLViewerFetchedTexture;
+
+/**
+ * Everything LLViewerFetchedTexture::calcDecodePriority() reads from a
+ * texture apart from its pixel area, captured once so the formula can run
+ * without touching the texture again.
+ */
+struct FSTexturePriorityInput
+{
+    enum
+    {
+        NEEDS_CREATE        = 1 << 0,   // waiting for createTexture(), keep mCurrentPriority
+        FULLY_LOADED        = 1 << 1,   // nothing left to fetch
+        MISSING_ASSET       = 1 << 2,
+        CACHED_RAW_READY    = 1 << 3,
+        JUST_BOUND          = 1 << 4,
+        LARGE_IMAGE         = 1 << 5    // more texels than LLViewerTexture::sMinLargeImageSize
+    };
+
+    F32 mCurrentPriority;
+    S32 mBoostLevel;
+    S8  mCurrentDiscard;    // getCurrentDiscardLevelForFetching()
+    S8  mDesiredDiscard;
+    S8  mCachedRawDiscard;
+    S8  mMaxDiscard;
+    S8  mMinDiscard;
+    U8  mFlags;
+};
+
+/**
+ * Decode priorities of all textures in one pass. LLViewerTextureList fills
+ * the table every frame, compute() evaluates the whole table and the caller
+ * then walks the results to apply what changed.
+ *
+ * The float columns live in separate arrays so the pixel area square roots
+ * run four at a time; the discrete state is kept per row since the formula
+ * branches on it anyway. Storage is kept between frames.
+ */
+class FSTexturePriorityTable
+{
+public:
+    void clear();
+    void add(LLViewerFetchedTexture* texture, F32 virtual_size, F32 additional, const FSTexturePriorityInput& input);
+    void compute();
+
+    size_t size() const { return mTextures.size(); }
+    LLViewerFetchedTexture* getTexture(size_t row) const { return mTextures[row]; }
+    F32 getPriority(size_t row) const { return mPriority[row]; }
+    F32 getAdditional(size_t row) const { return mAdditional[row]; }
+
+private:
+    std::vector<LLViewerFetchedTexture*>    mTextures;
+    std::vector<FSTexturePriorityInput>     mInputs;
+    std::vector<F32>    mPixelPriority;     // virtual size on add(), its square root after compute()
+    std::vector<F32>    mAdditional;
+    std::vector<F32>    mPriority;
+};
+
+#endif // FS_TEXTUREPRIORITY_H
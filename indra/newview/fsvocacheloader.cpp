@@ -0,0 +1,164 @@
+/**
+ * @file fsvocacheloader.cpp
+ * @brief Loads region object cache files off the main thread.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsvocacheloader.h"
+
+#include "llapr.h"
+
+FSVOCacheArena::FSVOCacheArena(S32 size)
+:   mData(new U8[size]),
+    mSize(size)
+{
+}
+
+FSVOCacheArena::~FSVOCacheArena()
+{
+    delete[] mData;
+}
+
+FSVOCacheLoad::FSVOCacheLoad(U64 handle, const std::string& filename, U32 generation)
+:   mHandle(handle),
+    mFilename(filename),
+    mGeneration(generation),
+    mRequestHandle(LLQueuedThread::nullHandle()),
+    mCorrupt(false),
+    mState(STATE_PENDING),
+    mCancelled(0)
+{
+}
+
+// Same layout LLVOCache::writeToCache() writes: the cache id, the entry
+// count, then the entries back to back
+bool FSVOCacheLoad::load(LLVolatileAPRPool* pool)
+{
+    S32 size = LLAPRFile::size(mFilename, pool);
+    if (size < (S32)(UUID_BYTES + sizeof(S32)))
+    {
+        return false;
+    }
+
+    LLPointer<FSVOCacheArena> arena = new FSVOCacheArena(size);
+    if (LLAPRFile::readEx(mFilename, arena->getData(), 0, size, pool) != size)
+    {
+        return false;
+    }
+
+    const U8* data = arena->getData();
+    memcpy(mCacheID.mData, data, UUID_BYTES);
+    S32 num_entries; // if removal was enabled during write num_entries might be wrong
+    memcpy(&num_entries, data + UUID_BYTES, sizeof(S32));
+
+    S32 offset = UUID_BYTES + sizeof(S32);
+    for (S32 i = 0; i < num_entries && offset < size; ++i)
+    {
+        LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry(arena, offset);
+        if (!entry->getLocalID())
+        {
+            mCorrupt = true;
+            break;
+        }
+        mEntries[entry->getLocalID()] = entry;
+    }
+    return true;
+}
+
+FSVOCacheLoader::FSVOCacheLoader(bool threaded)
+:   LLQueuedThread("vocacheloader", threaded),
+    mLocalAPRFilePoolp(new LLVolatileAPRPool())
+{
+}
+
+FSVOCacheLoader::~FSVOCacheLoader()
+{
+    // The thread must be done with the pool
+    shutdown();
+    delete mLocalAPRFilePoolp;
+}
+
+LLPointer<FSVOCacheLoad> FSVOCacheLoader::load(U64 handle, const std::string& filename, U32 generation, U32 priority)
+{
+    LLPointer<FSVOCacheLoad> load = new FSVOCacheLoad(handle, filename, generation);
+
+    LoadRequest* req = new LoadRequest(generateHandle(), priority, load, mLocalAPRFilePoolp);
+    load->setRequestHandle(req->getHashKey());
+    if (!addRequest(req))
+    {
+        LL_WARNS() << "Object cache load not added because we are exiting." << LL_ENDL;
+        load->setState(FSVOCacheLoad::STATE_FAILED);
+    }
+    return load;
+}
+
+void FSVOCacheLoader::setLoadPriority(FSVOCacheLoad* load, U32 priority)
+{
+    // No effect once the request is done and gone from the queue
+    if (!load->isDone())
+    {
+        setPriority(load->getRequestHandle(), priority);
+    }
+}
+
+FSVOCacheLoader::LoadRequest::LoadRequest(handle_t handle, U32 priority, FSVOCacheLoad* load, LLVolatileAPRPool* pool)
+:   LLQueuedThread::QueuedRequest(handle, priority, FLAG_AUTO_COMPLETE),
+    mLoad(load),
+    mPool(pool),
+    mResult(FSVOCacheLoad::STATE_FAILED)
+{
+}
+
+FSVOCacheLoader::LoadRequest::~LoadRequest()
+{
+    // Drop our reference before the load reads as done. The main thread
+    // holds its own until then, so the last reference, and with it the
+    // entries, is always released there.
+    FSVOCacheLoad* load = mLoad.get();
+    mLoad = NULL;
+    load->setState(mResult);
+}
+
+bool FSVOCacheLoader::LoadRequest::processRequest()
+{
+    // The region went away before we got to it
+    if (mLoad->isCancelled())
+    {
+        mResult = FSVOCacheLoad::STATE_FAILED;
+        return true;
+    }
+    bool loaded = mLoad->load(mPool);
+    mResult = loaded ? FSVOCacheLoad::STATE_LOADED : FSVOCacheLoad::STATE_FAILED;
+    return true;
+}
+
+void FSVOCacheLoader::LoadRequest::finishRequest(bool completed)
+{
+    if (!completed)
+    {
+        mResult = FSVOCacheLoad::STATE_FAILED;
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ * @file fsvocacheloader.h
+ * @brief Loads region object cache files off the main thread.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_VOCACHELOADER_H
+#define FS_VOCACHELOADER_H
+
+#include "llatomic.h"
+#include "llqueuedthread.h"
+#include "llrefcount.h"
+#include "lluuid.h"
+#include "llvocache.h"
+
+/**
+ * A whole region cache file in one allocation. LLVOCacheEntry bodies
+ * loaded from it point into it and keep it alive until the last of them
+ * is gone or updated.
+ */
+class FSVOCacheArena : public LLThreadSafeRefCount
+{
+public:
+    FSVOCacheArena(S32 size);
+
+    U8* getData() { return mData; }
+    S32 getSize() const { return mSize; }
+
+protected:
+    ~FSVOCacheArena();
+
+private:
+    U8* mData;
+    S32 mSize;
+};
+
+/**
+ * One region cache file read by FSVOCacheLoader. The main thread polls
+ * isDone() and then hands it to LLVOCache::finishReadFromCache(), which
+ * checks the cache id and takes the entries. Entries are only ever
+ * released on the main thread: a load whose region goes away is cancelled
+ * and kept by the main thread until it is done.
+ */
+class FSVOCacheLoad : public LLThreadSafeRefCount
+{
+public:
+    enum EState
+    {
+        STATE_PENDING = 0,
+        STATE_LOADED,       // read, entries parsed up to the first corrupt one
+        STATE_FAILED        // missing or too short for a cache id
+    };
+
+    FSVOCacheLoad(U64 handle, const std::string& filename, U32 generation);
+
+    // Worker thread. Reads the file in one go and builds the entries in place.
+    bool load(LLVolatileAPRPool* pool);
+
+    EState getState() const { return (EState)mState.CurrentValue(); }
+    void setState(EState state) { mState = state; }
+    bool isDone() const { return getState() != STATE_PENDING; }
+
+    // Main thread. The worker skips the file if it did not start on it yet.
+    void cancel() { mCancelled = 1; }
+    bool isCancelled() const { return mCancelled.CurrentValue() != 0; }
+
+    U64 getHandle() const { return mHandle; }
+    const std::string& getFilename() const { return mFilename; }
+    // LLVOCache::getFileGeneration() when the load was queued
+    U32 getGeneration() const { return mGeneration; }
+    LLQueuedThread::handle_t getRequestHandle() const { return mRequestHandle; }
+    void setRequestHandle(LLQueuedThread::handle_t handle) { mRequestHandle = handle; }
+    // Valid once done
+    const LLUUID& getCacheID() const { return mCacheID; }
+    bool isCorrupt() const { return mCorrupt; }
+    LLVOCacheEntry::vocache_entry_map_t& getEntries() { return mEntries; }
+
+private:
+    U64                                 mHandle;
+    std::string                         mFilename;
+    U32                                 mGeneration;
+    LLQueuedThread::handle_t            mRequestHandle;
+    LLUUID                              mCacheID;
+    bool                                mCorrupt;
+    LLVOCacheEntry::vocache_entry_map_t mEntries;
+    LLAtomicS32                         mState;
+    LLAtomicS32                         mCancelled;
+};
+
+/**
+ * Reads region object cache files for LLVOCache, so arriving in a region
+ * with thousands of cached objects no longer stalls the main thread.
+ */
+class FSVOCacheLoader : public LLQueuedThread
+{
+public:
+    FSVOCacheLoader(bool threaded = true);
+    ~FSVOCacheLoader();
+
+    // Main thread. The returned load is pending until the thread is done with it.
+    LLPointer<FSVOCacheLoad> load(U64 handle, const std::string& filename, U32 generation, U32 priority = PRIORITY_NORMAL);
+    // Main thread. Moves a load that is still queued ahead of or behind others.
+    void setLoadPriority(FSVOCacheLoad* load, U32 priority);
+
+private:
+    class LoadRequest : public LLQueuedThread::QueuedRequest
+    {
+    public:
+        LoadRequest(handle_t handle, U32 priority, FSVOCacheLoad* load, LLVolatileAPRPool* pool);
+
+        /*virtual*/ bool processRequest();
+        /*virtual*/ void finishRequest(bool completed);
+
+    protected:
+        /*virtual*/ ~LoadRequest();
+
+    private:
+        LLPointer<FSVOCacheLoad>    mLoad;
+        LLVolatileAPRPool*          mPool;
+        FSVOCacheLoad::EState       mResult;    // published by the destructor, see there
+    };
+
+    LLVolatileAPRPool*  mLocalAPRFilePoolp;     // used by the thread only
+};
+
+#endif // FS_VOCACHELOADER_H
@@ -133,7 +133,8 @@ static void ssl_verification_changed();
 LLAppCoreHttp::HttpClass::HttpClass()
 	: mPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
 	  mConnLimit(0U),
-	  mPipelined(false)
+	  mPipelined(false),
+	  mHttp2Streams(0L)		// <FS/> HTTP/2 multiplexing
 {}
 
 
@@ -142,7 +143,8 @@ LLAppCoreHttp::LLAppCoreHttp()
 	  mStopHandle(LLCORE_HTTP_HANDLE_INVALID),
 	  mStopRequested(0.0),
 	  mStopped(false),
-	  mPipelined(true)
+	  mPipelined(true),
+	  mHttp2(false)		// <FS/> HTTP/2 multiplexing
 {}
 
 
@@ -298,6 +300,23 @@ void LLAppCoreHttp::init()
 		}
 	}
 
+	// <FS> HTTP/2 multiplexing
+	static const std::string http2_multiplexing("FSHttp2Multiplexing");
+	if (gSavedSettings.controlExists(http2_multiplexing))
+	{
+		LLPointer<LLControlVariable> cntrl_ptr = gSavedSettings.getControl(http2_multiplexing);
+		if (cntrl_ptr.isNull())
+		{
+			LL_WARNS("Init") << "Unable to set signal on global setting '" << http2_multiplexing
+							 << "'" << LL_ENDL;
+		}
+		else
+		{
+			mHttp2Signal = cntrl_ptr->getCommitSignal()->connect(boost::bind(&setting_changed));
+		}
+	}
+	// </FS>
+
 	// Register signals for settings and state changes
 	for (int i(0); i < LL_ARRAY_SIZE(init_data); ++i)
 	{
@@ -391,6 +410,7 @@ void LLAppCoreHttp::cleanup()
 	}
     mSSLNoVerifySignal.disconnect();
 	mPipelinedSignal.disconnect();
+	mHttp2Signal.disconnect();		// <FS/> HTTP/2 multiplexing
 	
 	delete mRequest;
 	mRequest = NULL;
@@ -423,6 +443,15 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 		}
         LL_INFOS("Init") << "HTTP Pipelining " << (mPipelined ? "enabled" : "disabled") << "!" << LL_ENDL;
 	}
+
+	// <FS> HTTP/2 multiplexing
+	static const std::string http2_multiplexing("FSHttp2Multiplexing");
+	if (gSavedSettings.controlExists(http2_multiplexing))
+	{
+		mHttp2 = gSavedSettings.getBOOL(http2_multiplexing);
+		LL_INFOS("Init") << "HTTP/2 multiplexing " << (mHttp2 ? "enabled" : "disabled") << "!" << LL_ENDL;
+	}
+	// </FS>
 	
 	for (int i(0); i < LL_ARRAY_SIZE(init_data); ++i)
 	{
@@ -551,6 +580,36 @@ void LLAppCoreHttp::refreshSettings(bool initial)
 				}
 			}
 		}
+
+		// <FS> HTTP/2 multiplexing
+		// Classes that would pipeline may multiplex instead.  They keep
+		// as many requests in flight as pipelining would have allowed
+		// but over the same few connections, which the limits above
+		// still cap for hosts that answer with HTTP/1.1.
+		const long new_streams((mHttp2 && init_data[i].mPipelined) ? long(setting) * PIPELINING_DEPTH : 0L);
+		if (new_streams != mHttpClasses[app_policy].mHttp2Streams)
+		{
+			LLCore::HttpHandle handle;
+			handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_HTTP2_STREAM_LIMIT,
+											   mHttpClasses[app_policy].mPolicy,
+											   new_streams,
+											   LLCore::HttpHandler::ptr_t());
+			if (LLCORE_HTTP_HANDLE_INVALID == handle)
+			{
+				status = mRequest->getStatus();
+				LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
+								 << " HTTP/2 streams.  Reason:  " << status.toString()
+								 << LL_ENDL;
+			}
+			else
+			{
+				LL_DEBUGS("Init") << "Changed " << init_data[i].mUsage
+								  << " HTTP/2 streams.  New value:  " << new_streams
+								  << LL_ENDL;
+				mHttpClasses[app_policy].mHttp2Streams = new_streams;
+			}
+		}
+		// </FS>
 	}
 }
 
@@ -262,6 +262,7 @@ private:
 		policy_t					mPolicy;			// Policy class id for the class
 		U32							mConnLimit;
 		bool						mPipelined;
+		long						mHttp2Streams;		// <FS/> HTTP/2 stream limit, 0 when off
 		boost::signals2::connection mSettingsSignal;	// Signal to global setting that affect this class (if any)
 	};
 		
@@ -272,6 +273,10 @@ private:
 	HttpClass					mHttpClasses[AP_COUNT];
 	bool						mPipelined;				// Global setting
 	boost::signals2::connection	mPipelinedSignal;		// Signal for 'HttpPipelining' setting
+	// <FS> HTTP/2 multiplexing
+	bool						mHttp2;					// Global setting
+	boost::signals2::connection	mHttp2Signal;			// Signal for 'FSHttp2Multiplexing' setting
+	// </FS>
 	boost::signals2::connection	mSSLNoVerifySignal;		// Signal for 'NoVerifySSLCert' setting
 
 	static LLCore::HttpStatus	sslVerify(const std::string &uri, const LLCore::HttpHandler::ptr_t &handler, void *appdata);
@@ -286,6 +286,9 @@
 #include "fsassetblacklist.h"
 
 #include "fstelemetry.h" // <FS:Beq> Tracy profiler support
+#include "fsimageglstaging.h" // <FS> Staged texture uploads
+#include "llprocessor.h" // <FS> Parallel skinning
+#include "fsskinningpool.h" // <FS> Parallel skinning
 
 #if LL_LINUX && LL_GTK
 #include "glib.h"
@@ -738,6 +741,8 @@ LLTextureCache* LLAppViewer::sTextureCache = NULL;
 LLImageDecodeThread* LLAppViewer::sImageDecodeThread = NULL;
 LLTextureFetch* LLAppViewer::sTextureFetch = NULL;
 FSPurgeDiskCacheThread* LLAppViewer::sPurgeDiskCacheThread = NULL; // <FS:Ansariel> Regular disk cache cleanup
+FSImageGLStagingThread* LLAppViewer::sImageGLStagingThread = NULL; // <FS> Staged texture uploads
+FSSkinningPool* LLAppViewer::sSkinningPool = NULL; // <FS> Parallel skinning
 
 std::string getRuntime()
 {
@@ -1849,6 +1854,7 @@ bool LLAppViewer::doFrame()
 					// also pause worker threads during this wait period
 					LLAppViewer::getTextureCache()->pause();
 					LLAppViewer::getImageDecodeThread()->pause();
+					LLAppViewer::getImageGLStagingThread()->pause(); // <FS> Staged texture uploads
 				}
 			}
 
@@ -1898,6 +1904,7 @@ bool LLAppViewer::doFrame()
 			{
 				LLAppViewer::getTextureCache()->pause();
 				LLAppViewer::getImageDecodeThread()->pause();
+				LLAppViewer::getImageGLStagingThread()->pause(); // <FS> Staged texture uploads
 				LLAppViewer::getTextureFetch()->pause();
 			}
 			if(!total_io_pending) //pause file threads if nothing to process.
@@ -1980,6 +1987,12 @@ S32 LLAppViewer::updateTextureThreads(F32 max_time)
 		LL_RECORD_BLOCK_TIME(FTM_FETCH);
 	 	work_pending += LLAppViewer::getTextureFetch()->update(max_time); // unpauses the texture fetch thread
 	}
+	// <FS> Staged texture uploads
+	{
+		LL_RECORD_BLOCK_TIME(FTM_DECODE);
+		work_pending += LLAppViewer::getImageGLStagingThread()->update(max_time); // unpauses the staging thread
+	}
+	// </FS>
 	return work_pending;
 }
 
@@ -2410,6 +2423,7 @@ bool LLAppViewer::cleanup()
 		pending += LLAppViewer::getTextureCache()->update(1); // unpauses the worker thread
 		pending += LLAppViewer::getImageDecodeThread()->update(1); // unpauses the image thread
 		pending += LLAppViewer::getTextureFetch()->update(1); // unpauses the texture fetch thread
+		pending += LLAppViewer::getImageGLStagingThread()->update(1); // <FS> Staged texture uploads
 		pending += LLLFSThread::updateClass(0);
 		F64 idle_time = idleTimer.getElapsedTimeF64();
 		if(!pending)
@@ -2438,6 +2452,14 @@ bool LLAppViewer::cleanup()
 	sTextureCache->shutdown();
 	sImageDecodeThread->shutdown();
 	sPurgeDiskCacheThread->shutdown(); // <FS:Ansariel> Regular disk cache cleanup
+	sImageGLStagingThread->shutdown(); // <FS> Staged texture uploads
+	sSkinningPool->shutdown(); // <FS> Parallel skinning
+	// <FS> Packed asset disk cache
+	if (LLDiskCache::instanceExists())
+	{
+		LLDiskCache::getInstance()->flushJournal();
+	}
+	// </FS>
 
 	sTextureFetch->shutDownTextureCacheThread() ;
 	sTextureFetch->shutDownImageDecodeThread() ;
@@ -2464,6 +2486,14 @@ bool LLAppViewer::cleanup()
 	delete sPurgeDiskCacheThread;
 	sPurgeDiskCacheThread = NULL;
 	// </FS:Ansariel>
+	// <FS> Staged texture uploads
+	delete sImageGLStagingThread;
+	sImageGLStagingThread = NULL;
+	// </FS>
+	// <FS> Parallel skinning
+	delete sSkinningPool;
+	sSkinningPool = NULL;
+	// </FS>
 
 	if (LLFastTimerView::sAnalyzePerformance)
 	{
@@ -2567,6 +2597,11 @@ bool LLAppViewer::initThreads()
 													enable_threads && true,
 													app_metrics_qa_mode);
 	LLAppViewer::sPurgeDiskCacheThread = new FSPurgeDiskCacheThread(); // <FS:Ansariel> Regular disk cache cleanup
+	LLAppViewer::sImageGLStagingThread = new FSImageGLStagingThread(enable_threads && true); // <FS> Staged texture uploads
+	// <FS> Parallel skinning
+	LLAppViewer::sSkinningPool = new FSSkinningPool(enable_threads ? gSavedSettings.getU32("FSSkinningThreads") : 1,
+													LLProcessorInfo().hasAVX());
+	// </FS>
 
 	if (LLTrace::BlockTimer::sLog || LLTrace::BlockTimer::sMetricLog)
 	{
@@ -5038,7 +5073,11 @@ bool LLAppViewer::initCache()
 	// </FS:Ansariel>
 
     const std::string cache_dir = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, cache_dir_name);
-    LLDiskCache::initParamSingleton(cache_dir, disk_cache_bytes, enable_cache_debug_info);
+    // <FS> Packed asset disk cache
+    //LLDiskCache::initParamSingleton(cache_dir, disk_cache_bytes, enable_cache_debug_info);
+    // The pack files can't be shared between instances, so a second instance falls back to loose files
+    LLDiskCache::initParamSingleton(cache_dir, disk_cache_bytes, enable_cache_debug_info, gSavedSettings.getBOOL("FSDiskCachePackFiles") && !read_only, read_only);
+    // </FS>
 
 	if (!read_only)
 	{
@@ -5050,11 +5089,14 @@ bool LLAppViewer::initCache()
 			// clear the new C++ file system based cache
 			LLDiskCache::getInstance()->clearCache();
 		}
-		else
-		{
-			// purge excessive files from the new file system based cache
-			LLDiskCache::getInstance()->purge();
-		}
+		// <FS> Background, rate-limited purge
+		// FSPurgeDiskCacheThread purges excessive files in small slices right after startup
+		//else
+		//{
+		//	// purge excessive files from the new file system based cache
+		//	LLDiskCache::getInstance()->purge();
+		//}
+		// </FS>
 	}
 	// <FS:Ansariel> Regular disk cache cleanup
 	LLAppViewer::getPurgeDiskCacheThread()->start();
@@ -60,6 +60,8 @@ class LLWatchdogTimeout;
 class LLViewerJoystick;
 class LLViewerRegion;
 class FSPurgeDiskCacheThread; // <FS:Ansariel> Regular disk cache cleanup
+class FSImageGLStagingThread; // <FS> Staged texture uploads
+class FSSkinningPool; // <FS> Parallel skinning
 
 extern LLTrace::BlockTimerStatHandle FTM_FRAME;
 
@@ -120,6 +122,8 @@ public:
 	static LLImageDecodeThread* getImageDecodeThread() { return sImageDecodeThread; }
 	static LLTextureFetch* getTextureFetch() { return sTextureFetch; }
 	static FSPurgeDiskCacheThread* getPurgeDiskCacheThread() { return sPurgeDiskCacheThread; } // <FS:Ansariel> Regular disk cache cleanup
+	static FSImageGLStagingThread* getImageGLStagingThread() { return sImageGLStagingThread; } // <FS> Staged texture uploads
+	static FSSkinningPool* getSkinningPool() { return sSkinningPool; } // <FS> Parallel skinning
 
 	static U32 getTextureCacheVersion() ;
 	static U32 getObjectCacheVersion() ;
@@ -308,6 +312,8 @@ private:
 	static LLImageDecodeThread* sImageDecodeThread; 
 	static LLTextureFetch* sTextureFetch;
 	static FSPurgeDiskCacheThread* sPurgeDiskCacheThread; // <FS:Ansariel> Regular disk cache cleanup
+	static FSImageGLStagingThread* sImageGLStagingThread; // <FS> Staged texture uploads
+	static FSSkinningPool* sSkinningPool; // <FS> Parallel skinning
 
 	S32 mNumSessions;
 
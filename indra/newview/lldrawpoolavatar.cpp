@@ -59,10 +59,14 @@
 // void drawBoxOutline(const LLVector3& pos,const LLVector3& size);	// llspatialpartition.cpp
 // </FS:Zi>
 #include "llnetmap.h"
+#include "fsskinningpool.h" // <FS/> Parallel skinning
 
 static U32 sDataMask = LLDrawPoolAvatar::VERTEX_DATA_MASK;
 static U32 sBufferUsage = GL_STREAM_DRAW_ARB;
 static U32 sShaderLevel = 0;
+// <FS> Parallel skinning: buffers mapped for the jobs on the skinning pool
+static std::vector<LLPointer<LLVertexBuffer> > sSkinnedBuffers;
+// </FS>
 
 LLGLSLShader* LLDrawPoolAvatar::sVertexProgram = NULL;
 BOOL	LLDrawPoolAvatar::sSkipOpaque = FALSE;
@@ -169,7 +173,10 @@ void LLDrawPoolAvatar::prerender()
 		if (facep && facep->getDrawable())
 		{
 			LLVOAvatar* avatarp = (LLVOAvatar *)facep->getDrawable()->getVObj().get();
-			updateRiggedVertexBuffers(avatarp);
+			// <FS> Parallel skinning, skinned in LLPipeline after all prerender() calls
+			//updateRiggedVertexBuffers(avatarp);
+			updateRiggedVertexBuffers(avatarp, true);
+			// </FS>
 		}
 	}
 }
@@ -2153,33 +2160,62 @@ void LLDrawPoolAvatar::updateRiggedFaceVertexBuffer(
         else
 #endif
         {
-            for (U32 j = 0; j < buffer->getNumVerts(); ++j)
-		    {
-			    LLMatrix4a final_mat;
-                // <FS:ND> Use the SSE2 version
-                // LLSkinningUtil::getPerVertexSkinMatrix(weights[j].getF32ptr(), mat, false, final_mat, max_joints);
-                FSSkinningUtil::getPerVertexSkinMatrixSSE(weights[j], mat, false, final_mat, max_joints);
-                // </FS:ND>
+			// <FS> Parallel skinning: the per vertex loop moved to FSSkinningPool::skin()
+			// and runs for all avatars at once in finishRiggedSkinning()
+			FSSkinningJob job;
+			job.mPalette = mat;
+			job.mBindShape = &skin->mBindShapeMatrix;
+			job.mWeights = weights;
+			job.mPositions = vol_face.mPositions;
+			job.mNormals = norm ? vol_face.mNormals : NULL;
+			job.mOutPositions = pos;
+			job.mOutNormals = norm;
+			job.mMaxJoints = max_joints;
+			job.mBegin = 0;
+			job.mEnd = buffer->getNumVerts();
+
+			FSSkinningPool* pool = LLAppViewer::getSkinningPool();
+			if (pool)
+			{
+				pool->add(job);
+				sSkinnedBuffers.push_back(buffer);
+			}
+			else
+			{
+				FSSkinningPool::skin(job, false);
+			}
+			// </FS>
+        }
+	}
+}
 
-			    LLVector4a& v = vol_face.mPositions[j];
-			    LLVector4a t;
-			    LLVector4a dst;
-			    bind_shape_matrix.affineTransform(v, t);
-			    final_mat.affineTransform(t, dst);
-			    pos[j] = dst;
+// <FS> Parallel skinning
+static LLTrace::BlockTimerStatHandle FTM_RIGGED_SKINNING("Rigged Skinning");
 
-			    if (norm)
-			    {
-				    LLVector4a& n = vol_face.mNormals[j];
-				    bind_shape_matrix.rotate(n, t);
-				    final_mat.rotate(t, dst);
-				    //dst.normalize3fast();
-				    norm[j] = dst;
-			    }
-		    }
-        }
+//static
+void LLDrawPoolAvatar::finishRiggedSkinning()
+{
+	if (sSkinnedBuffers.empty())
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_RIGGED_SKINNING);
+
+	FSSkinningPool* pool = LLAppViewer::getSkinningPool();
+	if (pool)
+	{
+		pool->run();
+	}
+
+	// Unmapping has to happen on the render thread
+	for (LLPointer<LLVertexBuffer>& buffer : sSkinnedBuffers)
+	{
+		buffer->flush();
 	}
+	sSkinnedBuffers.clear();
 }
+// </FS>
 
 //<FS:Beq> cache per frame Skinning mats
 LLMatrix4a* LLDrawPoolAvatar::getCacheSkinningMats(LLDrawable* drawable, const LLMeshSkinInfo* skin,
@@ -2222,6 +2258,8 @@ void LLDrawPoolAvatar::renderRigged(LLVOAvatar* avatar, U32 type, bool glow)
 		return;
 	}
 
+	finishRiggedSkinning(); // <FS/> Parallel skinning, in case a prerender() was not followed by it
+
 	stop_glerror();
 
 	for (U32 i = 0; i < mRiggedFace[type].size(); ++i)
@@ -2538,7 +2576,10 @@ void LLDrawPoolAvatar::renderDeferredRiggedMaterial(LLVOAvatar* avatar, S32 pass
 
 static LLTrace::BlockTimerStatHandle FTM_RIGGED_VBO("Rigged VBO");
 
-void LLDrawPoolAvatar::updateRiggedVertexBuffers(LLVOAvatar* avatar)
+// <FS> Parallel skinning
+//void LLDrawPoolAvatar::updateRiggedVertexBuffers(LLVOAvatar* avatar)
+void LLDrawPoolAvatar::updateRiggedVertexBuffers(LLVOAvatar* avatar, bool defer_skinning)
+// </FS>
 {
 	LL_RECORD_BLOCK_TIME(FTM_RIGGED_VBO);
 
@@ -2581,6 +2622,15 @@ void LLDrawPoolAvatar::updateRiggedVertexBuffers(LLVOAvatar* avatar)
 			updateRiggedFaceVertexBuffer(avatar, face, skin, volume, vol_face);
 		}
 	}
+
+	// <FS> Parallel skinning
+	// The jobs point into volumes, skin info and mapped buffers that may
+	// change or go away once the caller moves on, e.g. rebuildGeom()
+	if (!defer_skinning)
+	{
+		finishRiggedSkinning();
+	}
+	// </FS>
 }
 
 void LLDrawPoolAvatar::renderRiggedSimple(LLVOAvatar* avatar)
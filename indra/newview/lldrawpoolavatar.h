@@ -187,6 +187,11 @@ typedef enum
 	                                        LLVOAvatar* avatar);
 	//</FS:Beq>
 
+	// <FS> Parallel skinning
+	// Skins every rigged face queued by the prerender() calls so far, see FSSkinningPool
+	static void finishRiggedSkinning();
+	// </FS>
+
 	/*virtual*/ S32  getNumPasses();
 	/*virtual*/ void beginRenderPass(S32 pass);
 	/*virtual*/ void endRenderPass(S32 pass);
@@ -264,7 +269,12 @@ typedef enum
 									  const LLMeshSkinInfo* skin, 
 									  LLVolume* volume,
 									  LLVolumeFace& vol_face);
-	void updateRiggedVertexBuffers(LLVOAvatar* avatar);
+	// <FS> Parallel skinning
+	//void updateRiggedVertexBuffers(LLVOAvatar* avatar);
+	// defer_skinning leaves the skinning to the next finishRiggedSkinning(),
+	// only for callers in the same render stage as it; otherwise it is done on return
+	void updateRiggedVertexBuffers(LLVOAvatar* avatar, bool defer_skinning = false);
+	// </FS>
 
 	void renderRigged(LLVOAvatar* avatar, U32 type, bool glow = false);
 	void renderRiggedSimple(LLVOAvatar* avatar);
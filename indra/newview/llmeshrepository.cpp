@@ -142,8 +142,8 @@
 //                             onCompleted() invoked for GET
 //                               data copied
 //                               headerReceived() invoked
-//                                 LLSD parsed
-//                                 mMeshHeader, mMeshHeaderSize updated
+//                                 header parsed into FSMeshHeader
+//                                 mMeshHeader updated
 //                                 scan mPendingLOD for LOD request
 //                                 push LODRequest to mLODReqQ
 //                             ...
@@ -250,8 +250,7 @@
 //     sActiveHeaderRequests    mMutex        rw.any.mMutex, ro.repo.none [1]
 //     sActiveLODRequests       mMutex        rw.any.mMutex, ro.repo.none [1]
 //     sMaxConcurrentRequests   mMutex        wo.main.none, ro.repo.none, ro.main.mMutex
-//     mMeshHeader              mHeaderMutex  rw.repo.mHeaderMutex, ro.main.mHeaderMutex, ro.main.none [0]
-//     mMeshHeaderSize          mHeaderMutex  rw.repo.mHeaderMutex
+//     mMeshHeader              mHeaderMutex  rw.repo.mHeaderMutex, ro.main.mHeaderMutex, rw.main.mHeaderMutex
 //     mSkinRequests            mMutex        rw.repo.mMutex, ro.repo.none [5]
 //     mSkinInfoQ               mMutex        rw.repo.mMutex, rw.main.mMutex [5] (was:  [0])
 //     mDecompositionRequests   mMutex        rw.repo.mMutex, ro.repo.none [5]
@@ -867,6 +866,10 @@ LLMeshRepoThread::LLMeshRepoThread()
 	mHttpLargeOptions = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
 	mHttpLargeOptions->setTransferTimeout(LARGE_MESH_XFER_TIMEOUT);
 	mHttpLargeOptions->setUseRetryAfter(gSavedSettings.getBOOL("MeshUseHttpRetryAfter"));
+	// <FS> Zero-copy replies
+	mHttpOptions->setReserveReplyBody(true);
+	mHttpLargeOptions->setReserveReplyBody(true);
+	// </FS>
 	mHttpHeaders = LLCore::HttpHeaders::ptr_t(new LLCore::HttpHeaders);
 	mHttpHeaders->append(HTTP_OUT_HEADER_ACCEPT, HTTP_CONTENT_VND_LL_MESH);
 	mHttpPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_MESH2);
@@ -1206,8 +1209,16 @@ void LLMeshRepoThread::lockAndLoadMeshLOD(const LLVolumeParams& mesh_params, S32
 void LLMeshRepoThread::loadMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 { //could be called from any thread
 	LLMutexLock lock(mMutex);
-	mesh_header_map::iterator iter = mMeshHeader.find(mesh_params.getSculptID());
-	if (iter != mMeshHeader.end())
+	// <FS> Compact mesh headers, the table may rehash while the repo thread adds to it
+	//mesh_header_map::iterator iter = mMeshHeader.find(mesh_params.getSculptID());
+	//if (iter != mMeshHeader.end())
+	bool has_header;
+	{
+		LLMutexLock header_lock(mHeaderMutex);
+		has_header = mMeshHeader.find(mesh_params.getSculptID()) != NULL;
+	}
+	if (has_header)
+	// </FS>
 	{ //if we have the header, request LOD byte range
 		LODRequest req(mesh_params, lod);
 		{
@@ -1384,7 +1395,11 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
 
 	mHeaderMutex->lock();
 
-	if (mMeshHeader.find(mesh_id) == mMeshHeader.end())
+	// <FS> Compact mesh headers
+	//if (mMeshHeader.find(mesh_id) == mMeshHeader.end())
+	const FSMeshHeader* header = mMeshHeader.find(mesh_id);
+	if (!header)
+	// </FS>
 	{ //we have no header info for this mesh, do nothing
 		mHeaderMutex->unlock();
 		return false;
@@ -1392,13 +1407,21 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
 
 	++LLMeshRepository::sMeshRequestCount;
 	bool ret = true;
-	U32 header_size = mMeshHeaderSize[mesh_id];
+	// <FS> Compact mesh headers
+	//U32 header_size = mMeshHeaderSize[mesh_id];
+	U32 header_size = header->mHeaderSize;
+	// </FS>
 	
 	if (header_size > 0)
 	{
-		S32 version = mMeshHeader[mesh_id]["version"].asInteger();
-		S32 offset = header_size + mMeshHeader[mesh_id]["skin"]["offset"].asInteger();
-		S32 size = mMeshHeader[mesh_id]["skin"]["size"].asInteger();
+		// <FS> Compact mesh headers
+		//S32 version = mMeshHeader[mesh_id]["version"].asInteger();
+		//S32 offset = header_size + mMeshHeader[mesh_id]["skin"]["offset"].asInteger();
+		//S32 size = mMeshHeader[mesh_id]["skin"]["size"].asInteger();
+		S32 version = header->mVersion;
+		S32 offset = header_size + header->getBlock(FSMeshHeader::BLOCK_SKIN).mOffset;
+		S32 size = header->getBlock(FSMeshHeader::BLOCK_SKIN).mSize;
+		// </FS>
 
 		mHeaderMutex->unlock();
 
@@ -1487,21 +1510,33 @@ bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id)
 
 	mHeaderMutex->lock();
 
-	if (mMeshHeader.find(mesh_id) == mMeshHeader.end())
+	// <FS> Compact mesh headers
+	//if (mMeshHeader.find(mesh_id) == mMeshHeader.end())
+	const FSMeshHeader* header = mMeshHeader.find(mesh_id);
+	if (!header)
+	// </FS>
 	{ //we have no header info for this mesh, do nothing
 		mHeaderMutex->unlock();
 		return false;
 	}
 
 	++LLMeshRepository::sMeshRequestCount;
-	U32 header_size = mMeshHeaderSize[mesh_id];
+	// <FS> Compact mesh headers
+	//U32 header_size = mMeshHeaderSize[mesh_id];
+	U32 header_size = header->mHeaderSize;
+	// </FS>
 	bool ret = true;
 	
 	if (header_size > 0)
 	{
-		S32 version = mMeshHeader[mesh_id]["version"].asInteger();
-		S32 offset = header_size + mMeshHeader[mesh_id]["physics_convex"]["offset"].asInteger();
-		S32 size = mMeshHeader[mesh_id]["physics_convex"]["size"].asInteger();
+		// <FS> Compact mesh headers
+		//S32 version = mMeshHeader[mesh_id]["version"].asInteger();
+		//S32 offset = header_size + mMeshHeader[mesh_id]["physics_convex"]["offset"].asInteger();
+		//S32 size = mMeshHeader[mesh_id]["physics_convex"]["size"].asInteger();
+		S32 version = header->mVersion;
+		S32 offset = header_size + header->getBlock(FSMeshHeader::BLOCK_PHYSICS_CONVEX).mOffset;
+		S32 size = header->getBlock(FSMeshHeader::BLOCK_PHYSICS_CONVEX).mSize;
+		// </FS>
 
 		mHeaderMutex->unlock();
 
@@ -1591,21 +1626,33 @@ bool LLMeshRepoThread::fetchMeshPhysicsShape(const LLUUID& mesh_id)
 
 	mHeaderMutex->lock();
 
-	if (mMeshHeader.find(mesh_id) == mMeshHeader.end())
+	// <FS> Compact mesh headers
+	//if (mMeshHeader.find(mesh_id) == mMeshHeader.end())
+	const FSMeshHeader* header = mMeshHeader.find(mesh_id);
+	if (!header)
+	// </FS>
 	{ //we have no header info for this mesh, do nothing
 		mHeaderMutex->unlock();
 		return false;
 	}
 
 	++LLMeshRepository::sMeshRequestCount;
-	U32 header_size = mMeshHeaderSize[mesh_id];
+	// <FS> Compact mesh headers
+	//U32 header_size = mMeshHeaderSize[mesh_id];
+	U32 header_size = header->mHeaderSize;
+	// </FS>
 	bool ret = true;
 
 	if (header_size > 0)
 	{
-		S32 version = mMeshHeader[mesh_id]["version"].asInteger();
-		S32 offset = header_size + mMeshHeader[mesh_id]["physics_mesh"]["offset"].asInteger();
-		S32 size = mMeshHeader[mesh_id]["physics_mesh"]["size"].asInteger();
+		// <FS> Compact mesh headers
+		//S32 version = mMeshHeader[mesh_id]["version"].asInteger();
+		//S32 offset = header_size + mMeshHeader[mesh_id]["physics_mesh"]["offset"].asInteger();
+		//S32 size = mMeshHeader[mesh_id]["physics_mesh"]["size"].asInteger();
+		S32 version = header->mVersion;
+		S32 offset = header_size + header->getBlock(FSMeshHeader::BLOCK_PHYSICS_MESH).mOffset;
+		S32 size = header->getBlock(FSMeshHeader::BLOCK_PHYSICS_MESH).mSize;
+		// </FS>
 
 		mHeaderMutex->unlock();
 
@@ -1797,13 +1844,22 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
 
 	LLUUID mesh_id = mesh_params.getSculptID();
 	
-	U32 header_size = mMeshHeaderSize[mesh_id];
+	// <FS> Compact mesh headers
+	//U32 header_size = mMeshHeaderSize[mesh_id];
+	const FSMeshHeader* header = mMeshHeader.find(mesh_id);
+	U32 header_size = header ? header->mHeaderSize : 0;
+	// </FS>
 
 	if (header_size > 0)
 	{
-		S32 version = mMeshHeader[mesh_id]["version"].asInteger();
-		S32 offset = header_size + mMeshHeader[mesh_id][header_lod[lod]]["offset"].asInteger();
-		S32 size = mMeshHeader[mesh_id][header_lod[lod]]["size"].asInteger();
+		// <FS> Compact mesh headers
+		//S32 version = mMeshHeader[mesh_id]["version"].asInteger();
+		//S32 offset = header_size + mMeshHeader[mesh_id][header_lod[lod]]["offset"].asInteger();
+		//S32 size = mMeshHeader[mesh_id][header_lod[lod]]["size"].asInteger();
+		S32 version = header->mVersion;
+		S32 offset = header_size + header->getLOD(lod).mOffset;
+		S32 size = header->getLOD(lod).mSize;
+		// </FS>
 		mHeaderMutex->unlock();
 				
 		if (version <= MAX_MESH_VERSION && offset >= 0 && size > 0)
@@ -1900,7 +1956,10 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
 EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size)
 {
 	const LLUUID mesh_id = mesh_params.getSculptID();
-	LLSD header;
+	// <FS> Compact mesh headers
+	//LLSD header;
+	FSMeshHeader header;
+	// </FS>
 	
 	U32 header_size = 0;
 	if (data_size > 0)
@@ -1932,46 +1991,90 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 
 		data_size = dsize;
 
-		boost::iostreams::stream<boost::iostreams::array_source> stream(result_ptr, data_size);
-		// </FS:Beq pp Rye> 
-
-		if (!LLSDSerialize::fromBinary(header, stream, data_size))
+		// <FS> Compact mesh headers: read the fields we need straight from
+		// the binary map, only unusual headers go through LLSD
+		//boost::iostreams::stream<boost::iostreams::array_source> stream(result_ptr, data_size);
+		//// </FS:Beq pp Rye> 
+		//
+		//if (!LLSDSerialize::fromBinary(header, stream, data_size))
+		//{
+		//	LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
+		//					   << LL_ENDL;
+		//	return MESH_PARSE_FAILURE;
+		//}
+		//
+		//if (!header.isMap())
+		//{
+		//	LL_WARNS(LOG_MESH) << "Mesh header is invalid for ID: " << mesh_id << LL_ENDL;
+		//	return MESH_INVALID;
+		//}
+		//
+		//if (header.has("version") && header["version"].asInteger() > MAX_MESH_VERSION)
+		//{
+		//	LL_INFOS(LOG_MESH) << "Wrong version in header for " << mesh_id << LL_ENDL;
+		//	header["404"] = 1;
+		//}
+		//// make sure there is at least one lod, function returns -1 and marks as 404 otherwise
+		//else if (LLMeshRepository::getActualMeshLOD(header, 0) >= 0)
+		//{
+		//	header_size += stream.tellg();
+		//}
+		S32 header_bytes = 0;
+		if (!header.parse((U8*)result_ptr, data_size, header_bytes))
 		{
-			LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
-							   << LL_ENDL;
-			return MESH_PARSE_FAILURE;
-		}
+			boost::iostreams::stream<boost::iostreams::array_source> stream(result_ptr, data_size);
+			// </FS:Beq pp Rye> 
 
-		if (!header.isMap())
-		{
-			LL_WARNS(LOG_MESH) << "Mesh header is invalid for ID: " << mesh_id << LL_ENDL;
-			return MESH_INVALID;
+			LLSD header_data;
+			if (!LLSDSerialize::fromBinary(header_data, stream, data_size))
+			{
+				LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
+								   << LL_ENDL;
+				return MESH_PARSE_FAILURE;
+			}
+
+			if (!header_data.isMap())
+			{
+				LL_WARNS(LOG_MESH) << "Mesh header is invalid for ID: " << mesh_id << LL_ENDL;
+				return MESH_INVALID;
+			}
+
+			header.fromLLSD(header_data);
+			header_bytes = (S32)stream.tellg();
 		}
 
-		if (header.has("version") && header["version"].asInteger() > MAX_MESH_VERSION)
+		if (header.mHasVersion && header.mVersion > MAX_MESH_VERSION)
 		{
 			LL_INFOS(LOG_MESH) << "Wrong version in header for " << mesh_id << LL_ENDL;
-			header["404"] = 1;
+			header.m404 = true;
 		}
 		// make sure there is at least one lod, function returns -1 and marks as 404 otherwise
 		else if (LLMeshRepository::getActualMeshLOD(header, 0) >= 0)
 		{
-			header_size += stream.tellg();
+			header_size += header_bytes;
 		}
+		// </FS>
 	}
 	else
 	{
 		LL_INFOS(LOG_MESH) << "Non-positive data size.  Marking header as non-existent, will not retry.  ID:  " << mesh_id
 						   << LL_ENDL;
-		header["404"] = 1;
+		// <FS> Compact mesh headers
+		//header["404"] = 1;
+		header.m404 = true;
+		// </FS>
 	}
 
 	{
 		
 		{
 			LLMutexLock lock(mHeaderMutex);
-			mMeshHeaderSize[mesh_id] = header_size;
-			mMeshHeader[mesh_id] = header;
+			// <FS> Compact mesh headers
+			//mMeshHeaderSize[mesh_id] = header_size;
+			//mMeshHeader[mesh_id] = header;
+			header.mHeaderSize = header_size;
+			mMeshHeader.set(mesh_id, header);
+			// </FS>
 		}
 
 		
@@ -3068,31 +3171,47 @@ void LLMeshRepoThread::notifyLoadedMeshes()
 S32 LLMeshRepoThread::getActualMeshLOD(const LLVolumeParams& mesh_params, S32 lod) 
 { //only ever called from main thread
 	LLMutexLock lock(mHeaderMutex);
-	mesh_header_map::iterator iter = mMeshHeader.find(mesh_params.getSculptID());
-
-	if (iter != mMeshHeader.end())
-	{
-		LLSD& header = iter->second;
-
-		return LLMeshRepository::getActualMeshLOD(header, lod);
-	}
+	// <FS> Compact mesh headers
+	//mesh_header_map::iterator iter = mMeshHeader.find(mesh_params.getSculptID());
+	//
+	//if (iter != mMeshHeader.end())
+	//{
+	//	LLSD& header = iter->second;
+	//
+	//	return LLMeshRepository::getActualMeshLOD(header, lod);
+	//}
+	FSMeshHeader* header = mMeshHeader.find(mesh_params.getSculptID());
+	if (header)
+	{
+		return LLMeshRepository::getActualMeshLOD(*header, lod);
+	}
+	// </FS>
 
 	return lod;
 }
 
 //static
-S32 LLMeshRepository::getActualMeshLOD(LLSD& header, S32 lod)
+// <FS> Compact mesh headers
+//S32 LLMeshRepository::getActualMeshLOD(LLSD& header, S32 lod)
+S32 LLMeshRepository::getActualMeshLOD(FSMeshHeader& header, S32 lod)
+// </FS>
 {
 	lod = llclamp(lod, 0, 3);
 
-	if (header.has("404"))
+	// <FS> Compact mesh headers
+	//if (header.has("404"))
+	if (header.m404)
+	// </FS>
 	{
 		return -1;
 	}
 
 	// <FS:Ansariel> OpenSim mesh fix
 	//S32 version = header["version"];
-	S32 version = header["version"].asInteger();
+	// <FS> Compact mesh headers
+	//S32 version = header["version"].asInteger();
+	S32 version = header.mVersion;
+	// </FS>
 	// </FS:Ansariel>
 
 	if (version > MAX_MESH_VERSION)
@@ -3100,7 +3219,10 @@ S32 LLMeshRepository::getActualMeshLOD(LLSD& header, S32 lod)
 		return -1;
 	}
 
-	if (header[header_lod[lod]]["size"].asInteger() > 0)
+	// <FS> Compact mesh headers
+	//if (header[header_lod[lod]]["size"].asInteger() > 0)
+	if (header.getLOD(lod).mSize > 0)
+	// </FS>
 	{
 		return lod;
 	}
@@ -3108,7 +3230,10 @@ S32 LLMeshRepository::getActualMeshLOD(LLSD& header, S32 lod)
 	//search down to find the next available lower lod
 	for (S32 i = lod-1; i >= 0; --i)
 	{
-		if (header[header_lod[i]]["size"].asInteger() > 0)
+		// <FS> Compact mesh headers
+		//if (header[header_lod[i]]["size"].asInteger() > 0)
+		if (header.getLOD(i).mSize > 0)
+		// </FS>
 		{
 			return i;
 		}
@@ -3117,20 +3242,41 @@ S32 LLMeshRepository::getActualMeshLOD(LLSD& header, S32 lod)
 	//search up to find then ext available higher lod
 	for (S32 i = lod+1; i < 4; ++i)
 	{
-		if (header[header_lod[i]]["size"].asInteger() > 0)
+		// <FS> Compact mesh headers
+		//if (header[header_lod[i]]["size"].asInteger() > 0)
+		if (header.getLOD(i).mSize > 0)
+		// </FS>
 		{
 			return i;
 		}
 	}
 
 	//header exists and no good lod found, treat as 404
-	header["404"] = 1;
+	// <FS> Compact mesh headers
+	//header["404"] = 1;
+	header.m404 = true;
+	// </FS>
 	return -1;
 }
 
 void LLMeshRepository::cacheOutgoingMesh(LLMeshUploadData& data, LLSD& header)
 {
-	mThread->mMeshHeader[data.mUUID] = header;
+	// <FS> Compact mesh headers
+	//mThread->mMeshHeader[data.mUUID] = header;
+	{
+		FSMeshHeader mesh_header;
+		mesh_header.fromLLSD(header);
+
+		LLMutexLock lock(mThread->mHeaderMutex);
+		// the header size is only known for received headers
+		const FSMeshHeader* existing = mThread->mMeshHeader.find(data.mUUID);
+		if (existing)
+		{
+			mesh_header.mHeaderSize = existing->mHeaderSize;
+		}
+		mThread->mMeshHeader.set(data.mUUID, mesh_header);
+	}
+	// </FS>
 
 	// we cache the mesh for default parameters
 	LLVolumeParams volume_params;
@@ -3192,6 +3338,7 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 		S32 body_offset(0);
 		U8 * data(NULL);
 		S32 data_size(body ? body->size() : 0);
+		bool data_copied(false); // <FS> Zero-copy replies
 
 		if (data_size > 0)
 		{
@@ -3248,9 +3395,20 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 			// handler, optional first that takes a body, fallback second
 			// that requires a temporary allocation and data copy.
 			body_offset = mOffset - offset;
-			data = new(std::nothrow) U8[data_size - body_offset];
+			// <FS> Zero-copy replies
+			// Bodies are received into a single reserved buffer when their
+			// length is known, and small ones fit in a block anyway. The
+			// handlers only read the data before the body is released.
+			//data = new(std::nothrow) U8[data_size - body_offset];
+			data = (U8 *) body->getContiguous(body_offset, data_size - body_offset);
 			if (data)
 			{
+				LLMeshRepository::sBytesReceived += data_size;
+			}
+			else if ((data = new(std::nothrow) U8[data_size - body_offset]))
+			// </FS>
+			{
+				data_copied = true; // <FS/> Zero-copy replies
 				body->read(body_offset, (char *) data, data_size - body_offset);
 				LLMeshRepository::sBytesReceived += data_size;
 			}
@@ -3263,7 +3421,13 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 
 		processData(body, body_offset, data, data_size - body_offset);
 
-		delete [] data;
+		// <FS> Zero-copy replies
+		//delete [] data;
+		if (data_copied)
+		{
+			delete [] data;
+		}
+		// </FS>
 	}
 
 	// Release handler
@@ -3335,19 +3499,33 @@ void LLMeshHeaderHandler::processData(LLCore::BufferArray * /* body */, S32 /* b
 	{
 		// header was successfully retrieved from sim and parsed and is in cache
 		S32 header_bytes = 0;
-		LLSD header;
-
-		gMeshRepo.mThread->mHeaderMutex->lock();
-		LLMeshRepoThread::mesh_header_map::iterator iter = gMeshRepo.mThread->mMeshHeader.find(mesh_id);
-		if (iter != gMeshRepo.mThread->mMeshHeader.end())
+		// <FS> Compact mesh headers, a copy is cheap so hold the lock for the lookup only
+		//LLSD header;
+		//
+		//gMeshRepo.mThread->mHeaderMutex->lock();
+		//LLMeshRepoThread::mesh_header_map::iterator iter = gMeshRepo.mThread->mMeshHeader.find(mesh_id);
+		//if (iter != gMeshRepo.mThread->mMeshHeader.end())
+		//{
+		//	header_bytes = (S32)gMeshRepo.mThread->mMeshHeaderSize[mesh_id];
+		//	header = iter->second;
+		//}
+		FSMeshHeader header;
 		{
-			header_bytes = (S32)gMeshRepo.mThread->mMeshHeaderSize[mesh_id];
-			header = iter->second;
+			LLMutexLock lock(gMeshRepo.mThread->mHeaderMutex);
+			if (gMeshRepo.mThread->mMeshHeader.get(mesh_id, header))
+			{
+				header_bytes = (S32)header.mHeaderSize;
+			}
 		}
+		// </FS>
 
 		if (header_bytes > 0
-			&& !header.has("404")
-			&& (!header.has("version") || header["version"].asInteger() <= MAX_MESH_VERSION))
+			// <FS> Compact mesh headers
+			//&& !header.has("404")
+			//&& (!header.has("version") || header["version"].asInteger() <= MAX_MESH_VERSION))
+			&& !header.m404
+			&& (!header.mHasVersion || header.mVersion <= MAX_MESH_VERSION))
+			// </FS>
 		{
 			std::stringstream str;
 
@@ -3356,17 +3534,26 @@ void LLMeshHeaderHandler::processData(LLCore::BufferArray * /* body */, S32 /* b
 			for (U32 i = 0; i < LLModel::LOD_PHYSICS; ++i)
 			{
 				// figure out how many bytes we'll need to reserve in the file
-				const std::string & lod_name = header_lod[i];
-				lod_bytes = llmax(lod_bytes, header[lod_name]["offset"].asInteger()+header[lod_name]["size"].asInteger());
+				// <FS> Compact mesh headers
+				//const std::string & lod_name = header_lod[i];
+				//lod_bytes = llmax(lod_bytes, header[lod_name]["offset"].asInteger()+header[lod_name]["size"].asInteger());
+				lod_bytes = llmax(lod_bytes, header.getLOD(i).mOffset + header.getLOD(i).mSize);
+				// </FS>
 			}
 		
 			// just in case skin info or decomposition is at the end of the file (which it shouldn't be)
-			lod_bytes = llmax(lod_bytes, header["skin"]["offset"].asInteger() + header["skin"]["size"].asInteger());
-			lod_bytes = llmax(lod_bytes, header["physics_convex"]["offset"].asInteger() + header["physics_convex"]["size"].asInteger());
-
-            // Do not unlock mutex untill we are done with LLSD.
-            // LLSD is smart and can work like smart pointer, is not thread safe.
-            gMeshRepo.mThread->mHeaderMutex->unlock();
+			// <FS> Compact mesh headers
+			//lod_bytes = llmax(lod_bytes, header["skin"]["offset"].asInteger() + header["skin"]["size"].asInteger());
+			//lod_bytes = llmax(lod_bytes, header["physics_convex"]["offset"].asInteger() + header["physics_convex"]["size"].asInteger());
+			//
+            //// Do not unlock mutex untill we are done with LLSD.
+            //// LLSD is smart and can work like smart pointer, is not thread safe.
+            //gMeshRepo.mThread->mHeaderMutex->unlock();
+			const FSMeshHeader::Block& skin = header.getBlock(FSMeshHeader::BLOCK_SKIN);
+			const FSMeshHeader::Block& physics_convex = header.getBlock(FSMeshHeader::BLOCK_PHYSICS_CONVEX);
+			lod_bytes = llmax(lod_bytes, skin.mOffset + skin.mSize);
+			lod_bytes = llmax(lod_bytes, physics_convex.mOffset + physics_convex.mSize);
+			// </FS>
 
 			S32 bytes = lod_bytes + header_bytes; 
 
@@ -3404,7 +3591,7 @@ void LLMeshHeaderHandler::processData(LLCore::BufferArray * /* body */, S32 /* b
 		{
 			LL_WARNS(LOG_MESH) << "Trying to cache nonexistent mesh, mesh id: " << mesh_id << LL_ENDL;
 
-			gMeshRepo.mThread->mHeaderMutex->unlock();
+			//gMeshRepo.mThread->mHeaderMutex->unlock(); // <FS> Compact mesh headers
 
 			// headerReceived() parsed header, but header's data is invalid so none of the LODs will be available
 			LLMutexLock lock(gMeshRepo.mThread->mMutex);
@@ -4376,18 +4563,25 @@ bool LLMeshRepository::hasPhysicsShape(const LLUUID& mesh_id)
 bool LLMeshRepoThread::hasPhysicsShapeInHeader(const LLUUID& mesh_id)
 {
     LLMutexLock lock(mHeaderMutex);
-    if (mMeshHeaderSize[mesh_id] > 0)
+    // <FS> Compact mesh headers
+    //if (mMeshHeaderSize[mesh_id] > 0)
+    //{
+    //    mesh_header_map::iterator iter = mMeshHeader.find(mesh_id);
+    //    if (iter != mMeshHeader.end())
+    //    {
+    //        LLSD &mesh = iter->second;
+    //        if (mesh.has("physics_mesh") && mesh["physics_mesh"].has("size") && (mesh["physics_mesh"]["size"].asInteger() > 0))
+    //        {
+    //            return true;
+    //        }
+    //    }
+    //}
+    const FSMeshHeader* header = mMeshHeader.find(mesh_id);
+    if (header && header->mHeaderSize > 0 && header->getBlock(FSMeshHeader::BLOCK_PHYSICS_MESH).mSize > 0)
     {
-        mesh_header_map::iterator iter = mMeshHeader.find(mesh_id);
-        if (iter != mMeshHeader.end())
-        {
-            LLSD &mesh = iter->second;
-            if (mesh.has("physics_mesh") && mesh["physics_mesh"].has("size") && (mesh["physics_mesh"]["size"].asInteger() > 0))
-            {
-                return true;
-            }
-        }
+        return true;
     }
+    // </FS>
 
     return false;
 }
@@ -4406,18 +4600,25 @@ LLUUID LLMeshRepository::getCreatorFromHeader(const LLUUID& mesh_id)
 LLUUID LLMeshRepoThread::getCreatorFromHeader(const LLUUID& mesh_id)
 {
 	LLMutexLock lock(mHeaderMutex);
-	if (mMeshHeaderSize[mesh_id] > 0)
-	{
-		mesh_header_map::iterator iter = mMeshHeader.find(mesh_id);
-		if (iter != mMeshHeader.end())
-		{
-			LLSD& mesh = iter->second;
-			if (mesh.has("creator") && mesh["creator"].isUUID())
-			{
-				return mesh["creator"].asUUID();
-			}
-		}
-	}
+	// <FS> Compact mesh headers
+	//if (mMeshHeaderSize[mesh_id] > 0)
+	//{
+	//	mesh_header_map::iterator iter = mMeshHeader.find(mesh_id);
+	//	if (iter != mMeshHeader.end())
+	//	{
+	//		LLSD& mesh = iter->second;
+	//		if (mesh.has("creator") && mesh["creator"].isUUID())
+	//		{
+	//			return mesh["creator"].asUUID();
+	//		}
+	//	}
+	//}
+	const FSMeshHeader* header = mMeshHeader.find(mesh_id);
+	if (header && header->mHeaderSize > 0)
+	{
+		return header->mCreator;
+	}
+	// </FS>
 
 	return LLUUID();
 }
@@ -4439,19 +4640,31 @@ S32 LLMeshRepository::getMeshSize(const LLUUID& mesh_id, S32 lod)
 	if (mThread && mesh_id.notNull() && LLPrimitive::NO_LOD != lod)
 	{
 		LLMutexLock lock(mThread->mHeaderMutex);
-		LLMeshRepoThread::mesh_header_map::iterator iter = mThread->mMeshHeader.find(mesh_id);
-		if (iter != mThread->mMeshHeader.end() && mThread->mMeshHeaderSize[mesh_id] > 0)
+		// <FS> Compact mesh headers
+		//LLMeshRepoThread::mesh_header_map::iterator iter = mThread->mMeshHeader.find(mesh_id);
+		//if (iter != mThread->mMeshHeader.end() && mThread->mMeshHeaderSize[mesh_id] > 0)
+		//{
+		//	LLSD& header = iter->second;
+		//
+		//	if (header.has("404"))
+		//	{
+		//		return -1;
+		//	}
+		//
+		//	S32 size = header[header_lod[lod]]["size"].asInteger();
+		//	return size;
+		//}
+		const FSMeshHeader* header = mThread->mMeshHeader.find(mesh_id);
+		if (header && header->mHeaderSize > 0)
 		{
-			LLSD& header = iter->second;
-
-			if (header.has("404"))
+			if (header->m404 || llclamp(lod, 0, 3) != lod)
 			{
 				return -1;
 			}
 
-			S32 size = header[header_lod[lod]]["size"].asInteger();
-			return size;
+			return header->getLOD(lod).mSize;
 		}
+		// </FS>
 
 	}
 
@@ -4545,11 +4758,18 @@ F32 LLMeshRepository::getStreamingCostLegacy(LLUUID mesh_id, F32 radius, S32* by
     if (mThread && mesh_id.notNull())
     {
         LLMutexLock lock(mThread->mHeaderMutex);
-        LLMeshRepoThread::mesh_header_map::iterator iter = mThread->mMeshHeader.find(mesh_id);
-        if (iter != mThread->mMeshHeader.end() && mThread->mMeshHeaderSize[mesh_id] > 0)
+        // <FS> Compact mesh headers
+        //LLMeshRepoThread::mesh_header_map::iterator iter = mThread->mMeshHeader.find(mesh_id);
+        //if (iter != mThread->mMeshHeader.end() && mThread->mMeshHeaderSize[mesh_id] > 0)
+        //{
+        //    result  = getStreamingCostLegacy(iter->second, radius, bytes, bytes_visible, lod, unscaled_value);
+        //}
+        FSMeshHeader* header = mThread->mMeshHeader.find(mesh_id);
+        if (header && header->mHeaderSize > 0)
         {
-            result  = getStreamingCostLegacy(iter->second, radius, bytes, bytes_visible, lod, unscaled_value);
+            result  = getStreamingCostLegacy(*header, radius, bytes, bytes_visible, lod, unscaled_value);
         }
+        // </FS>
     }
     if (result > 0.f)
     {
@@ -4585,14 +4805,23 @@ F32 LLMeshRepository::getStreamingCostLegacy(LLUUID mesh_id, F32 radius, S32* by
 
 // FIXME replace with calc based on LLMeshCostData
 //static
-F32 LLMeshRepository::getStreamingCostLegacy(LLSD& header, F32 radius, S32* bytes, S32* bytes_visible, S32 lod, F32 *unscaled_value)
-{
-	if (header.has("404")
-		|| !header.has("lowest_lod")
-		// <FS:Ansariel> OpenSim mesh fix
-		//|| (header.has("version") && header["version"].asInteger() > MAX_MESH_VERSION))
-		|| ((header.has("version") || !LLGridManager::instance().isInSecondLife()) && header["version"].asInteger() > MAX_MESH_VERSION))
-		// </FS:Ansariel>
+// <FS> Compact mesh headers
+//F32 LLMeshRepository::getStreamingCostLegacy(LLSD& header, F32 radius, S32* bytes, S32* bytes_visible, S32 lod, F32 *unscaled_value)
+F32 LLMeshRepository::getStreamingCostLegacy(FSMeshHeader& header, F32 radius, S32* bytes, S32* bytes_visible, S32 lod, F32 *unscaled_value)
+// </FS>
+{
+	// <FS> Compact mesh headers
+	//if (header.has("404")
+	//	|| !header.has("lowest_lod")
+	//	// <FS:Ansariel> OpenSim mesh fix
+	//	//|| (header.has("version") && header["version"].asInteger() > MAX_MESH_VERSION))
+	//	|| ((header.has("version") || !LLGridManager::instance().isInSecondLife()) && header["version"].asInteger() > MAX_MESH_VERSION))
+	//	// </FS:Ansariel>
+	if (header.m404
+		|| !header.hasBlock(FSMeshHeader::BLOCK_LOWEST_LOD)
+		// a missing version reads as 0, so the OpenSim case needs no extra check
+		|| header.mVersion > MAX_MESH_VERSION)
+	// </FS>
 	{
 		return 0.f;
 	}
@@ -4611,10 +4840,16 @@ F32 LLMeshRepository::getStreamingCostLegacy(LLSD& header, F32 radius, S32* byte
 	F32 minimum_size = (F32)minimum_size_ch;
 	F32 bytes_per_triangle = (F32)bytes_per_triangle_ch;
 
-	S32 bytes_lowest = header["lowest_lod"]["size"].asInteger();
-	S32 bytes_low = header["low_lod"]["size"].asInteger();
-	S32 bytes_mid = header["medium_lod"]["size"].asInteger();
-	S32 bytes_high = header["high_lod"]["size"].asInteger();
+	// <FS> Compact mesh headers
+	//S32 bytes_lowest = header["lowest_lod"]["size"].asInteger();
+	//S32 bytes_low = header["low_lod"]["size"].asInteger();
+	//S32 bytes_mid = header["medium_lod"]["size"].asInteger();
+	//S32 bytes_high = header["high_lod"]["size"].asInteger();
+	S32 bytes_lowest = header.getBlock(FSMeshHeader::BLOCK_LOWEST_LOD).mSize;
+	S32 bytes_low = header.getBlock(FSMeshHeader::BLOCK_LOW_LOD).mSize;
+	S32 bytes_mid = header.getBlock(FSMeshHeader::BLOCK_MEDIUM_LOD).mSize;
+	S32 bytes_high = header.getBlock(FSMeshHeader::BLOCK_HIGH_LOD).mSize;
+	// </FS>
 
 	if (bytes_high == 0)
 	{
@@ -4644,10 +4879,16 @@ F32 LLMeshRepository::getStreamingCostLegacy(LLSD& header, F32 radius, S32* byte
 	if (bytes)
 	{
 		*bytes = 0;
-		*bytes += header["lowest_lod"]["size"].asInteger();
-		*bytes += header["low_lod"]["size"].asInteger();
-		*bytes += header["medium_lod"]["size"].asInteger();
-		*bytes += header["high_lod"]["size"].asInteger();
+		// <FS> Compact mesh headers
+		//*bytes += header["lowest_lod"]["size"].asInteger();
+		//*bytes += header["low_lod"]["size"].asInteger();
+		//*bytes += header["medium_lod"]["size"].asInteger();
+		//*bytes += header["high_lod"]["size"].asInteger();
+		for (S32 i = 0; i < 4; ++i)
+		{
+			*bytes += header.getLOD(i).mSize;
+		}
+		// </FS>
 	}
 
 	if (bytes_visible)
@@ -4655,7 +4896,10 @@ F32 LLMeshRepository::getStreamingCostLegacy(LLSD& header, F32 radius, S32* byte
 		lod = LLMeshRepository::getActualMeshLOD(header, lod);
 		if (lod >= 0 && lod <= 3)
 		{
-			*bytes_visible = header[header_lod[lod]]["size"].asInteger();
+			// <FS> Compact mesh headers
+			//*bytes_visible = header[header_lod[lod]]["size"].asInteger();
+			*bytes_visible = header.getLOD(lod).mSize;
+			// </FS>
 		}
 	}
 
@@ -4711,24 +4955,39 @@ LLMeshCostData::LLMeshCostData()
 
 bool LLMeshCostData::init(const LLSD& header)
 {
+    // <FS> Compact mesh headers
+    FSMeshHeader mesh_header;
+    mesh_header.fromLLSD(header);
+    return init(mesh_header);
+}
+
+bool LLMeshCostData::init(const FSMeshHeader& header)
+{
+    // </FS>
     mSizeByLOD.resize(4);
     mEstTrisByLOD.resize(4);
 
     std::fill(mSizeByLOD.begin(), mSizeByLOD.end(), 0);
     std::fill(mEstTrisByLOD.begin(), mEstTrisByLOD.end(), 0.f);
 
-    S32 bytes_high = header["high_lod"]["size"].asInteger();
-    S32 bytes_med = header["medium_lod"]["size"].asInteger();
+    // <FS> Compact mesh headers
+    //S32 bytes_high = header["high_lod"]["size"].asInteger();
+    //S32 bytes_med = header["medium_lod"]["size"].asInteger();
+    S32 bytes_high = header.getBlock(FSMeshHeader::BLOCK_HIGH_LOD).mSize;
+    S32 bytes_med = header.getBlock(FSMeshHeader::BLOCK_MEDIUM_LOD).mSize;
+    // </FS>
     if (bytes_med == 0)
     {
         bytes_med = bytes_high;
     }
-    S32 bytes_low = header["low_lod"]["size"].asInteger();
+    //S32 bytes_low = header["low_lod"]["size"].asInteger();
+    S32 bytes_low = header.getBlock(FSMeshHeader::BLOCK_LOW_LOD).mSize; // <FS> Compact mesh headers
     if (bytes_low == 0)
     {
         bytes_low = bytes_med;
     }
-    S32 bytes_lowest = header["lowest_lod"]["size"].asInteger();
+    //S32 bytes_lowest = header["lowest_lod"]["size"].asInteger();
+    S32 bytes_lowest = header.getBlock(FSMeshHeader::BLOCK_LOWEST_LOD).mSize; // <FS> Compact mesh headers
     if (bytes_lowest == 0)
     {
         bytes_lowest = bytes_low;
@@ -4868,16 +5127,29 @@ bool LLMeshRepository::getCostData(LLUUID mesh_id, LLMeshCostData& data)
     
     if (mThread && mesh_id.notNull())
     {
-        LLMutexLock lock(mThread->mHeaderMutex);
-        LLMeshRepoThread::mesh_header_map::iterator iter = mThread->mMeshHeader.find(mesh_id);
-        if (iter != mThread->mMeshHeader.end() && mThread->mMeshHeaderSize[mesh_id] > 0)
+        // <FS> Compact mesh headers
+        //LLMutexLock lock(mThread->mHeaderMutex);
+        //LLMeshRepoThread::mesh_header_map::iterator iter = mThread->mMeshHeader.find(mesh_id);
+        //if (iter != mThread->mMeshHeader.end() && mThread->mMeshHeaderSize[mesh_id] > 0)
+        //{
+        //    // <FS:ND/> TODO - come to this back later. From all known so far it's not a simply race condition but LLSD being not multi thread safe at all. (which in fact it isn't).
+        //    LLSD& header = iter->second;
+        //
+        //    bool header_invalid = (header.has("404")
+        //                           || !header.has("lowest_lod")
+        //                           || (header.has("version") && header["version"].asInteger() > MAX_MESH_VERSION));
+        FSMeshHeader header;
+        bool found;
         {
-            // <FS:ND/> TODO - come to this back later. From all known so far it's not a simply race condition but LLSD being not multi thread safe at all. (which in fact it isn't).
-            LLSD& header = iter->second;
-
-            bool header_invalid = (header.has("404")
-                                   || !header.has("lowest_lod")
-                                   || (header.has("version") && header["version"].asInteger() > MAX_MESH_VERSION));
+            LLMutexLock lock(mThread->mHeaderMutex);
+            found = mThread->mMeshHeader.get(mesh_id, header);
+        }
+        if (found && header.mHeaderSize > 0)
+        {
+            bool header_invalid = (header.m404
+                                   || !header.hasBlock(FSMeshHeader::BLOCK_LOWEST_LOD)
+                                   || (header.mHasVersion && header.mVersion > MAX_MESH_VERSION));
+        // </FS>
             if (!header_invalid)
             {
                 return getCostData(header, data);
@@ -4904,6 +5176,15 @@ bool LLMeshRepository::getCostData(LLSD const& header, LLMeshCostData& data)
     return true;
 }
 
+// <FS> Compact mesh headers
+bool LLMeshRepository::getCostData(const FSMeshHeader& header, LLMeshCostData& data)
+{
+    data = LLMeshCostData();
+
+    return data.init(header);
+}
+// </FS>
+
 LLPhysicsDecomp::LLPhysicsDecomp()
 : LLThread("Physics Decomp")
 {
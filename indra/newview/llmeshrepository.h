@@ -39,6 +39,7 @@
 #include "httpheaders.h"
 #include "httphandler.h"
 #include "llthread.h"
+#include "fsmeshheader.h" // <FS> Compact mesh headers
 
 #include <boost/unordered_map.hpp>
 
@@ -210,11 +211,15 @@ public:
 	LLMutex*	mHeaderMutex;
 	LLCondition* mSignal;
 
-	//map of known mesh headers
-	typedef std::map<LLUUID, LLSD> mesh_header_map;
+	// <FS> Compact mesh headers, the header size is part of FSMeshHeader
+	////map of known mesh headers
+	//typedef std::map<LLUUID, LLSD> mesh_header_map;
+	//mesh_header_map mMeshHeader;
+	//
+	//std::map<LLUUID, U32> mMeshHeaderSize;
+	typedef FSMeshHeaderMap mesh_header_map;
 	mesh_header_map mMeshHeader;
-	
-	std::map<LLUUID, U32> mMeshHeaderSize;
+	// </FS>
 
 	class HeaderRequest : public RequestStats
 	{ 
@@ -518,6 +523,7 @@ public:
     LLMeshCostData();
 
     bool init(const LLSD& header);
+    bool init(const FSMeshHeader& header); // <FS> Compact mesh headers
     
     // Size for given LOD
     S32 getSizeByLOD(S32 lod);
@@ -583,13 +589,17 @@ public:
     F32 getEstTrianglesMax(LLUUID mesh_id);
     F32 getEstTrianglesStreamingCost(LLUUID mesh_id);
 	F32 getStreamingCostLegacy(LLUUID mesh_id, F32 radius, S32* bytes = NULL, S32* visible_bytes = NULL, S32 detail = -1, F32 *unscaled_value = NULL);
-	static F32 getStreamingCostLegacy(LLSD& header, F32 radius, S32* bytes = NULL, S32* visible_bytes = NULL, S32 detail = -1, F32 *unscaled_value = NULL);
+	// <FS> Compact mesh headers
+	//static F32 getStreamingCostLegacy(LLSD& header, F32 radius, S32* bytes = NULL, S32* visible_bytes = NULL, S32 detail = -1, F32 *unscaled_value = NULL);
+	static F32 getStreamingCostLegacy(FSMeshHeader& header, F32 radius, S32* bytes = NULL, S32* visible_bytes = NULL, S32 detail = -1, F32 *unscaled_value = NULL);
+	// </FS>
     bool getCostData(LLUUID mesh_id, LLMeshCostData& data);
 
     // <FS:ND> Use a const ref, just to make sure no one modifies header and we can pass a copy.
     // bool getCostData(LLSD& header, LLMeshCostData& data);
     bool getCostData(LLSD const& header, LLMeshCostData& data);
     // </FS:ND>
+    bool getCostData(const FSMeshHeader& header, LLMeshCostData& data); // <FS> Compact mesh headers
 
 	LLMeshRepository();
 
@@ -607,7 +617,10 @@ public:
 	void notifyDecompositionReceived(LLModel::Decomposition* info);
 
 	S32 getActualMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
-	static S32 getActualMeshLOD(LLSD& header, S32 lod);
+	// <FS> Compact mesh headers
+	//static S32 getActualMeshLOD(LLSD& header, S32 lod);
+	static S32 getActualMeshLOD(FSMeshHeader& header, S32 lod);
+	// </FS>
 	const LLMeshSkinInfo* getSkinInfo(const LLUUID& mesh_id, const LLVOVolume* requesting_obj);
 	LLModel::Decomposition* getDecomposition(const LLUUID& mesh_id);
 	void fetchPhysicsShape(const LLUUID& mesh_id);
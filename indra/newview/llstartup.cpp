@@ -888,6 +888,14 @@ bool idle_startup()
 				msg->mPacketRing.setUseOutThrottle(TRUE);
 				msg->mPacketRing.setOutBandwidth(outBandwidth);
 			}
+
+			// <FS> Expand and decode incoming messages off the main thread.
+			// The throttles above still apply, checkMessages() runs them on the main thread.
+			if (gSavedSettings.getBOOL("FSThreadedMessageReceive"))
+			{
+				msg->startReceiveThread();
+			}
+			// </FS>
 		}
 
 		LL_INFOS("AppInit") << "Message System Initialized." << LL_ENDL;
@@ -836,6 +836,8 @@ LLTextureCache::LLTextureCache(bool threaded)
 	  mListMutex(),
 	  mFastCacheMutex(),
 	  mHeaderAPRFile(NULL),
+	  mHeaderEntriesCapacity(0), // <FS> Memory mapped texture entries
+	  mLRUTime(0), // <FS> Lock striped texture entries
 	  mReadOnly(TRUE), //do not allow to change the texture cache until setReadOnly() is called.
 	  mTexturesSizeTotal(0),
 	  mDoPurge(FALSE),
@@ -930,10 +932,13 @@ std::string LLTextureCache::getTextureFileName(const LLUUID& id)
 //debug
 BOOL LLTextureCache::isInCache(const LLUUID& id) 
 {
-	LLMutexLock lock(&mHeaderMutex);
-	id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-	
-	return (iter != mHeaderIDMap.end()) ;
+	//LLMutexLock lock(&mHeaderMutex); // <FS> Lock striped texture entries, the index has its own locks
+	// <FS> Memory mapped texture entries
+	//id_map_t::const_iterator iter = mHeaderIDMap.find(id);
+	//
+	//return (iter != mHeaderIDMap.end()) ;
+	return mEntryIndex.find(id) >= 0;
+	// </FS>
 }
 
 //debug
@@ -1130,11 +1135,18 @@ void LLTextureCache::readEntriesHeader()
 {
 	// mHeaderEntriesInfo initializes to default values so safe not to read it
 	llassert_always(mHeaderAPRFile == NULL);
-	if (LLAPRFile::isExist(mHeaderEntriesFileName, mHeaderAPRFilePoolp))
-	{
-		LLAPRFile::readEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
-						  mHeaderAPRFilePoolp);
-	}
+	// <FS> Memory mapped texture entries
+	//if (LLAPRFile::isExist(mHeaderEntriesFileName, mHeaderAPRFilePoolp))
+	//{
+	//	LLAPRFile::readEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
+	//					  mHeaderAPRFilePoolp);
+	//}
+	unmapHeaderEntriesFile(); // remap, sCacheMaxEntries might have changed
+	if (LLFile::isfile(mHeaderEntriesFileName) && mapHeaderEntriesFile())
+	{
+		memcpy(&mHeaderEntriesInfo, mHeaderEntriesMap.getData(), sizeof(EntriesInfo));
+	}
+	// </FS>
 	else //create an empty entries header.
 	{
 		setEntriesHeader();
@@ -1164,6 +1176,13 @@ void LLTextureCache::writeEntriesHeader()
 	llassert_always(mHeaderAPRFile == NULL);
 	if (!mReadOnly)
 	{
+		// <FS> Memory mapped texture entries
+		if (mHeaderEntriesMap.isOpen())
+		{
+			memcpy(mHeaderEntriesMap.getData(), &mHeaderEntriesInfo, sizeof(EntriesInfo));
+			return;
+		}
+		// </FS>
 		LLAPRFile::writeEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
 						   mHeaderAPRFilePoolp);
 	}
@@ -1174,17 +1193,23 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 {
 	S32 idx = -1;
 	
-	id_map_t::iterator iter1 = mHeaderIDMap.find(id);
-	if (iter1 != mHeaderIDMap.end())
-	{
-		idx = iter1->second;
-	}
+	// <FS> Memory mapped texture entries
+	//id_map_t::iterator iter1 = mHeaderIDMap.find(id);
+	//if (iter1 != mHeaderIDMap.end())
+	//{
+	//	idx = iter1->second;
+	//}
+	idx = mEntryIndex.find(id);
+	// </FS>
 
 	if (idx < 0)
 	{
 		if (create && !mReadOnly)
 		{
-			if (mHeaderEntriesInfo.mEntries < sCacheMaxEntries)
+			// <FS> Memory mapped texture entries
+			//if (mHeaderEntriesInfo.mEntries < sCacheMaxEntries)
+			if (mHeaderEntriesInfo.mEntries < llmin(sCacheMaxEntries, mHeaderEntriesCapacity))
+			// </FS>
 			{
 				// Add an entry to the end of the list
 				idx = mHeaderEntriesInfo.mEntries++;
@@ -1205,10 +1230,25 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 					// Erase entry from LRU regardless
 					mLRU.erase(curiter2);
 					// Look up entry and use it if it is valid
-					id_map_t::iterator iter3 = mHeaderIDMap.find(oldid);
-					if (iter3 != mHeaderIDMap.end() && iter3->second >= 0)
+					// <FS> Memory mapped texture entries
+					//id_map_t::iterator iter3 = mHeaderIDMap.find(oldid);
+					//if (iter3 != mHeaderIDMap.end() && iter3->second >= 0)
+					//{
+					//	idx = iter3->second;
+					S32 oldidx = mEntryIndex.find(oldid);
+					// <FS> Lock striped texture entries
+					// Reads only stamp the entry time instead of removing the
+					// texture from the LRU, skip entries used since the LRU was built.
+					Entry* old_entry = getMappedEntry(oldidx);
+					if (old_entry && old_entry->mTime > mLRUTime)
 					{
-						idx = iter3->second;
+						continue;
+					}
+					// </FS>
+					if (oldidx >= 0)
+					{
+						idx = oldidx;
+					// </FS>
 						removeCachedTexture(oldid) ;//remove the existing cached texture to release the entry index.
 						break;
 					}
@@ -1230,23 +1270,32 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 		// Remove this entry from the LRU if it exists
 		mLRU.erase(id);
 		// Read the entry
-		idx_entry_map_t::iterator iter = mUpdatedEntryMap.find(idx) ;
-		if(iter != mUpdatedEntryMap.end())
-		{
-			entry = iter->second ;
-		}
-		else
-		{
+		// <FS> Memory mapped texture entries
+		//idx_entry_map_t::iterator iter = mUpdatedEntryMap.find(idx) ;
+		//if(iter != mUpdatedEntryMap.end())
+		//{
+		//	entry = iter->second ;
+		//}
+		//else
+		// </FS>
+		{
+			LLMutexLock stripe_lock(&mEntryIndex.getMutex(id)); // <FS> Lock striped texture entries
 			readEntryFromHeaderImmediately(idx, entry) ;
 		}
-		if(entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
+		// <FS> Memory mapped texture entries
+		//if(entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
+		if(idx >= 0 && entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
+		// </FS>
 		{
 			LL_WARNS() << "corrupted entry: " << id << " entry image size: " << entry.mImageSize << " entry body size: " << entry.mBodySize << LL_ENDL ;
 
 			//erase this entry and the cached texture from the cache.
 			std::string tex_filename = getTextureFileName(id);
 			removeEntry(idx, entry, tex_filename) ;
-			mUpdatedEntryMap.erase(idx) ;
+			// <FS> Memory mapped texture entries
+			//mUpdatedEntryMap.erase(idx) ;
+			writeEntryToHeaderImmediately(idx, entry);
+			// </FS>
 			idx = -1 ;
 		}
 	}
@@ -1256,48 +1305,79 @@ S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create
 //mHeaderMutex is locked before calling this.
 void LLTextureCache::writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header)
 {	
-	LLAPRFile* aprfile ;
-	S32 bytes_written ;
-	S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-	if(write_header)
-	{
-		aprfile = openHeaderEntriesFile(false, 0);		
-		bytes_written = aprfile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-		if(bytes_written != sizeof(EntriesInfo))
-		{
-			clearCorruptedCache() ; //clear the cache.
-			idx = -1 ;//mark the idx invalid.
-			return ;
-		}
-
-		mHeaderAPRFile->seek(APR_SET, offset);
-	}
-	else
+	// <FS> Memory mapped texture entries
+	//LLAPRFile* aprfile ;
+	//S32 bytes_written ;
+	//S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
+	//if(write_header)
+	//{
+	//	aprfile = openHeaderEntriesFile(false, 0);		
+	//	bytes_written = aprfile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
+	//	if(bytes_written != sizeof(EntriesInfo))
+	//	{
+	//		clearCorruptedCache() ; //clear the cache.
+	//		idx = -1 ;//mark the idx invalid.
+	//		return ;
+	//	}
+	//
+	//	mHeaderAPRFile->seek(APR_SET, offset);
+	//}
+	//else
+	//{
+	//	aprfile = openHeaderEntriesFile(false, offset);
+	//}
+	//bytes_written = aprfile->write((void*)&entry, (S32)sizeof(Entry));
+	//if(bytes_written != sizeof(Entry))
+	//{
+	//	clearCorruptedCache() ; //clear the cache.
+	//	idx = -1 ;//mark the idx invalid.
+	//
+	//	return ;
+	//}
+	//
+	//closeHeaderEntriesFile();
+	//mUpdatedEntryMap.erase(idx) ;
+	if (mReadOnly)
 	{
-		aprfile = openHeaderEntriesFile(false, offset);
+		return;
 	}
-	bytes_written = aprfile->write((void*)&entry, (S32)sizeof(Entry));
-	if(bytes_written != sizeof(Entry))
+
+	Entry* mapped_entry = getMappedEntry(idx);
+	if (!mapped_entry)
 	{
 		clearCorruptedCache() ; //clear the cache.
 		idx = -1 ;//mark the idx invalid.
-
 		return ;
 	}
 
-	closeHeaderEntriesFile();
-	mUpdatedEntryMap.erase(idx) ;
+	{
+		LLMutexLock stripe_lock(&mEntryIndex.getMutex(entry.mID)); // <FS> Lock striped texture entries
+		*mapped_entry = entry;
+	}
+	if (write_header)
+	{
+		writeEntriesHeader();
+	}
+	// </FS>
 }
 
 //mHeaderMutex is locked before calling this.
 void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
 {
-	S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-	LLAPRFile* aprfile = openHeaderEntriesFile(true, offset);
-	S32 bytes_read = aprfile->read((void*)&entry, (S32)sizeof(Entry));
-	closeHeaderEntriesFile();
-
-	if(bytes_read != sizeof(Entry))
+	// <FS> Memory mapped texture entries
+	//S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
+	//LLAPRFile* aprfile = openHeaderEntriesFile(true, offset);
+	//S32 bytes_read = aprfile->read((void*)&entry, (S32)sizeof(Entry));
+	//closeHeaderEntriesFile();
+	//
+	//if(bytes_read != sizeof(Entry))
+	Entry* mapped_entry = getMappedEntry(idx);
+	if (mapped_entry)
+	{
+		entry = *mapped_entry;
+	}
+	else
+	// </FS>
 	{
 		clearCorruptedCache() ; //clear the cache.
 		idx = -1 ;//mark the idx invalid.
@@ -1308,19 +1388,29 @@ void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
 //update an existing entry time stamp, delay writing.
 void LLTextureCache::updateEntryTimeStamp(S32 idx, Entry& entry)
 {
-	static const U32 MAX_ENTRIES_WITHOUT_TIME_STAMP = (U32)(LLTextureCache::sCacheMaxEntries * 0.75f) ;
-
-	if(mHeaderEntriesInfo.mEntries < MAX_ENTRIES_WITHOUT_TIME_STAMP)
-	{
-		return ; //there are enough empty entry index space, no need to stamp time.
-	}
+	// <FS> Memory mapped texture entries, stamping the time is a plain memory write now
+	//static const U32 MAX_ENTRIES_WITHOUT_TIME_STAMP = (U32)(LLTextureCache::sCacheMaxEntries * 0.75f) ;
+	//
+	//if(mHeaderEntriesInfo.mEntries < MAX_ENTRIES_WITHOUT_TIME_STAMP)
+	//{
+	//	return ; //there are enough empty entry index space, no need to stamp time.
+	//}
+	// </FS>
 
 	if (idx >= 0)
 	{
 		if (!mReadOnly)
 		{
 			entry.mTime = time(NULL);			
-			mUpdatedEntryMap[idx] = entry ;
+			// <FS> Memory mapped texture entries
+			//mUpdatedEntryMap[idx] = entry ;
+			Entry* mapped_entry = getMappedEntry(idx);
+			if (mapped_entry)
+			{
+				LLMutexLock stripe_lock(&mEntryIndex.getMutex(entry.mID)); // <FS> Lock striped texture entries
+				mapped_entry->mTime = entry.mTime;
+			}
+			// </FS>
 		}
 	}
 }
@@ -1343,8 +1433,11 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 		bool update_header = false ;
 		if(entry.mImageSize < 0) //is a brand-new entry
 		{
-			mHeaderIDMap[entry.mID] = idx;
-			mTexturesSizeMap[entry.mID] = new_body_size ;
+			// <FS> Memory mapped texture entries
+			//mHeaderIDMap[entry.mID] = idx;
+			//mTexturesSizeMap[entry.mID] = new_body_size ;
+			mEntryIndex.insert(entry.mID, idx);
+			// </FS>
 			mTexturesSizeTotal += new_body_size ;
 			
 			// Update Header
@@ -1353,7 +1446,7 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 		else if (entry.mBodySize != new_body_size)
 		{
 			//already in mHeaderIDMap.
-			mTexturesSizeMap[entry.mID] = new_body_size ;
+			//mTexturesSizeMap[entry.mID] = new_body_size ; // <FS> Memory mapped texture entries
 			mTexturesSizeTotal -= entry.mBodySize ;
 			mTexturesSizeTotal += new_body_size ;
 		}
@@ -1379,47 +1472,107 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
 	return false ;
 }
 
-U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
+// <FS> Memory mapped texture entries
+//mHeaderMutex is locked before calling this.
+bool LLTextureCache::mapHeaderEntriesFile()
 {
-	U32 num_entries = mHeaderEntriesInfo.mEntries;
+	if (mHeaderEntriesMap.isOpen())
+	{
+		return true;
+	}
 
-	mHeaderIDMap.clear();
-	mTexturesSizeMap.clear();
-	mFreeList.clear();
-	mTexturesSizeTotal = 0;
+	// <FS> Lock striped texture entries, lookups only hold a stripe mutex
+	mEntryIndex.lockAll();
+	size_t min_size = sizeof(EntriesInfo) + (size_t)sCacheMaxEntries * sizeof(Entry);
+	bool mapped = mHeaderEntriesMap.open(mHeaderEntriesFileName, min_size, mReadOnly);
+	if (!mapped)
+	{
+		LL_WARNS("TextureCache") << "Failed to map " << mHeaderEntriesFileName << LL_ENDL;
+	}
+	else if (mHeaderEntriesMap.getSize() < sizeof(EntriesInfo))
+	{
+		mHeaderEntriesMap.close();
+		mapped = false;
+	}
+
+	mHeaderEntriesCapacity = mapped ? (U32)((mHeaderEntriesMap.getSize() - sizeof(EntriesInfo)) / sizeof(Entry)) : 0;
+	mEntryIndex.unlockAll();
+	// </FS>
+	return mapped;
+}
+
+//mHeaderMutex is locked before calling this.
+void LLTextureCache::unmapHeaderEntriesFile()
+{
+	mEntryIndex.lockAll(); // <FS> Lock striped texture entries
+	mHeaderEntriesMap.close();
+	mHeaderEntriesCapacity = 0;
+	mEntryIndex.unlockAll(); // <FS> Lock striped texture entries
+}
 
-	LLAPRFile* aprfile = NULL; 
-	if(mUpdatedEntryMap.empty())
+//mHeaderMutex is locked before calling this.
+LLTextureCache::Entry* LLTextureCache::getMappedEntry(S32 idx)
+{
+	if (idx < 0 || !mapHeaderEntriesFile())
 	{
-		aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
+		return NULL;
 	}
-	else //update the header file first.
+	return peekMappedEntry(idx);
+}
+
+// <FS> Lock striped texture entries
+//the stripe mutex of the entry is locked before calling this.
+//unlike getMappedEntry() this never maps the file.
+LLTextureCache::Entry* LLTextureCache::peekMappedEntry(S32 idx)
+{
+	if (idx < 0 || !mHeaderEntriesMap.isOpen() || (U32)idx >= mHeaderEntriesCapacity)
 	{
-		aprfile = openHeaderEntriesFile(false, 0);
-		updatedHeaderEntriesFile() ;
-		if(!aprfile)
-		{
-			return 0;
-		}
-		aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo));
+		return NULL;
 	}
-	for (U32 idx=0; idx<num_entries; idx++)
+	return (Entry*)(mHeaderEntriesMap.getData() + sizeof(EntriesInfo)) + idx;
+}
+// </FS>
+
+//mHeaderMutex is locked before calling this.
+//returns the mapped entries table, entries are modified in place.
+LLTextureCache::Entry* LLTextureCache::getMappedEntries(U32& num_entries)
+{
+	num_entries = 0;
+	if (!mapHeaderEntriesFile())
 	{
-		Entry entry;
-		S32 bytes_read = aprfile->read((void*)(&entry), (S32)sizeof(Entry));
-		if (bytes_read < sizeof(Entry))
-		{
-			LL_WARNS() << "Corrupted header entries, failed at " << idx << " / " << num_entries << LL_ENDL;
-			closeHeaderEntriesFile();
-			purgeAllTextures(false);
-			return 0;
-		}
-		entries.push_back(entry);
-// 		LL_INFOS() << "ENTRY: " << entry.mTime << " TEX: " << entry.mID << " IDX: " << idx << " Size: " << entry.mImageSize << LL_ENDL;
-		if(entry.mImageSize > entry.mBodySize)
+		return NULL;
+	}
+	if (mHeaderEntriesInfo.mEntries > mHeaderEntriesCapacity)
+	{
+		LL_WARNS() << "Corrupted header entries, " << mHeaderEntriesInfo.mEntries << " entries in a table of " << mHeaderEntriesCapacity << LL_ENDL;
+		purgeAllTextures(false);
+		return NULL;
+	}
+	num_entries = mHeaderEntriesInfo.mEntries;
+	return getMappedEntry(0);
+}
+
+//mHeaderMutex is locked before calling this.
+//rebuilds the index, free list and body size total from the mapped entries.
+U32 LLTextureCache::rebuildEntryIndex()
+{
+	mEntryIndex.clear();
+	mFreeList.clear();
+	mTexturesSizeTotal = 0;
+
+	U32 num_entries = 0;
+	Entry* entries = getMappedEntries(num_entries);
+	if (!entries)
+	{
+		return 0;
+	}
+
+	for (U32 idx = 0; idx < num_entries; idx++)
+	{
+		const Entry& entry = entries[idx];
+		if (entry.mImageSize > entry.mBodySize)
 		{
-			mHeaderIDMap[entry.mID] = idx;
-			mTexturesSizeMap[entry.mID] = entry.mBodySize;
+			mEntryIndex.insert(entry.mID, idx);
 			mTexturesSizeTotal += entry.mBodySize;
 		}
 		else
@@ -1427,80 +1580,140 @@ U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
 			mFreeList.insert(idx);
 		}
 	}
-	closeHeaderEntriesFile();
 	return num_entries;
 }
 
-void LLTextureCache::writeEntriesAndClose(const std::vector<Entry>& entries)
-{
-	S32 num_entries = entries.size();
-	llassert_always(num_entries == mHeaderEntriesInfo.mEntries);
-	
-	if (!mReadOnly)
-	{
-		LLAPRFile* aprfile = openHeaderEntriesFile(false, (S32)sizeof(EntriesInfo));
-		for (S32 idx=0; idx<num_entries; idx++)
-		{
-			S32 bytes_written = aprfile->write((void*)(&entries[idx]), (S32)sizeof(Entry));
-			if(bytes_written != sizeof(Entry))
-			{
-				clearCorruptedCache() ; //clear the cache.
-				return ;
-			}
-		}
-		closeHeaderEntriesFile();
-	}
-}
+//U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
+//{
+//	U32 num_entries = mHeaderEntriesInfo.mEntries;
+//
+//	mHeaderIDMap.clear();
+//	mTexturesSizeMap.clear();
+//	mFreeList.clear();
+//	mTexturesSizeTotal = 0;
+//
+//	LLAPRFile* aprfile = NULL; 
+//	if(mUpdatedEntryMap.empty())
+//	{
+//		aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
+//	}
+//	else //update the header file first.
+//	{
+//		aprfile = openHeaderEntriesFile(false, 0);
+//		updatedHeaderEntriesFile() ;
+//		if(!aprfile)
+//		{
+//			return 0;
+//		}
+//		aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo));
+//	}
+//	for (U32 idx=0; idx<num_entries; idx++)
+//	{
+//		Entry entry;
+//		S32 bytes_read = aprfile->read((void*)(&entry), (S32)sizeof(Entry));
+//		if (bytes_read < sizeof(Entry))
+//		{
+//			LL_WARNS() << "Corrupted header entries, failed at " << idx << " / " << num_entries << LL_ENDL;
+//			closeHeaderEntriesFile();
+//			purgeAllTextures(false);
+//			return 0;
+//		}
+//		entries.push_back(entry);
+//// 		LL_INFOS() << "ENTRY: " << entry.mTime << " TEX: " << entry.mID << " IDX: " << idx << " Size: " << entry.mImageSize << LL_ENDL;
+//		if(entry.mImageSize > entry.mBodySize)
+//		{
+//			mHeaderIDMap[entry.mID] = idx;
+//			mTexturesSizeMap[entry.mID] = entry.mBodySize;
+//			mTexturesSizeTotal += entry.mBodySize;
+//		}
+//		else
+//		{
+//			mFreeList.insert(idx);
+//		}
+//	}
+//	closeHeaderEntriesFile();
+//	return num_entries;
+//}
+//
+//void LLTextureCache::writeEntriesAndClose(const std::vector<Entry>& entries)
+//{
+//	S32 num_entries = entries.size();
+//	llassert_always(num_entries == mHeaderEntriesInfo.mEntries);
+//	
+//	if (!mReadOnly)
+//	{
+//		LLAPRFile* aprfile = openHeaderEntriesFile(false, (S32)sizeof(EntriesInfo));
+//		for (S32 idx=0; idx<num_entries; idx++)
+//		{
+//			S32 bytes_written = aprfile->write((void*)(&entries[idx]), (S32)sizeof(Entry));
+//			if(bytes_written != sizeof(Entry))
+//			{
+//				clearCorruptedCache() ; //clear the cache.
+//				return ;
+//			}
+//		}
+//		closeHeaderEntriesFile();
+//	}
+//}
+// </FS>
 
 void LLTextureCache::writeUpdatedEntries()
 {
 	lockHeaders() ;
-	if (!mReadOnly && !mUpdatedEntryMap.empty())
+	// <FS> Memory mapped texture entries, schedule the write back of the dirty pages
+	//if (!mReadOnly && !mUpdatedEntryMap.empty())
+	//{
+	//	openHeaderEntriesFile(false, 0);
+	//	updatedHeaderEntriesFile() ;
+	//	closeHeaderEntriesFile();
+	//}
+	if (!mReadOnly)
 	{
-		openHeaderEntriesFile(false, 0);
-		updatedHeaderEntriesFile() ;
-		closeHeaderEntriesFile();
+		mHeaderEntriesMap.flush();
 	}
+	// </FS>
 	unlockHeaders() ;
 }
 
-//mHeaderMutex is locked and mHeaderAPRFile is created before calling this.
-void LLTextureCache::updatedHeaderEntriesFile()
-{
-	if (!mReadOnly && !mUpdatedEntryMap.empty() && mHeaderAPRFile)
-	{
-		//entriesInfo
-		mHeaderAPRFile->seek(APR_SET, 0);
-		S32 bytes_written = mHeaderAPRFile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-		if(bytes_written != sizeof(EntriesInfo))
-		{
-			clearCorruptedCache() ; //clear the cache.
-			return ;
-		}
-		
-		//write each updated entry
-		S32 entry_size = (S32)sizeof(Entry) ;
-		S32 prev_idx = -1 ;
-		S32 delta_idx ;
-		for (idx_entry_map_t::iterator iter = mUpdatedEntryMap.begin(); iter != mUpdatedEntryMap.end(); ++iter)
-		{
-			delta_idx = iter->first - prev_idx - 1;
-			prev_idx = iter->first ;
-			if(delta_idx)
-			{
-				mHeaderAPRFile->seek(APR_CUR, delta_idx * entry_size);
-			}
-			
-			bytes_written = mHeaderAPRFile->write((void*)(&iter->second), entry_size);
-			if(bytes_written != entry_size)
-			{
-				clearCorruptedCache() ; //clear the cache.
-				return ;
-			}
-		}
-		mUpdatedEntryMap.clear() ;
-	}
-}
+// <FS> Memory mapped texture entries
+////mHeaderMutex is locked and mHeaderAPRFile is created before calling this.
+//void LLTextureCache::updatedHeaderEntriesFile()
+//{
+//	if (!mReadOnly && !mUpdatedEntryMap.empty() && mHeaderAPRFile)
+//	{
+//		//entriesInfo
+//		mHeaderAPRFile->seek(APR_SET, 0);
+//		S32 bytes_written = mHeaderAPRFile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
+//		if(bytes_written != sizeof(EntriesInfo))
+//		{
+//			clearCorruptedCache() ; //clear the cache.
+//			return ;
+//		}
+//		
+//		//write each updated entry
+//		S32 entry_size = (S32)sizeof(Entry) ;
+//		S32 prev_idx = -1 ;
+//		S32 delta_idx ;
+//		for (idx_entry_map_t::iterator iter = mUpdatedEntryMap.begin(); iter != mUpdatedEntryMap.end(); ++iter)
+//		{
+//			delta_idx = iter->first - prev_idx - 1;
+//			prev_idx = iter->first ;
+//			if(delta_idx)
+//			{
+//				mHeaderAPRFile->seek(APR_CUR, delta_idx * entry_size);
+//			}
+//			
+//			bytes_written = mHeaderAPRFile->write((void*)(&iter->second), entry_size);
+//			if(bytes_written != entry_size)
+//			{
+//				clearCorruptedCache() ; //clear the cache.
+//				return ;
+//			}
+//		}
+//		mUpdatedEntryMap.clear() ;
+//	}
+//}
+// </FS>
 //----------------------------------------------------------------------------
 
 // Called from either the main thread or the worker thread
@@ -1524,9 +1737,14 @@ void LLTextureCache::readHeaderCache()
 	}
 	else
 	{
-		std::vector<Entry> entries;
-		U32 num_entries = openAndReadEntries(entries);
-		if (num_entries)
+		// <FS> Memory mapped texture entries
+		//std::vector<Entry> entries;
+		//U32 num_entries = openAndReadEntries(entries);
+		//if (num_entries)
+		U32 num_entries = rebuildEntryIndex();
+		Entry* entries = getMappedEntries(num_entries);
+		if (num_entries && entries)
+		// </FS>
 		{
 			U32 empty_entries = 0;
 			typedef std::pair<U32, S32> lru_data_t;
@@ -1571,6 +1789,7 @@ void LLTextureCache::readHeaderCache()
 			}
 
 			{
+				mLRUTime = time(NULL); // <FS> Lock striped texture entries
 				S32 lru_entries = (S32)((F32)sCacheMaxEntries * TEXTURE_CACHE_LRU_SIZE);
 				for (std::set<lru_data_t>::iterator iter = lru.begin(); iter != lru.end(); ++iter)
 				{
@@ -1581,7 +1800,10 @@ void LLTextureCache::readHeaderCache()
 				}
 			}
 			
-			if (purge_list.size() > 0)
+			// <FS> Memory mapped texture entries, a read only instance maps the entries read only
+			//if (purge_list.size() > 0)
+			if (purge_list.size() > 0 && !mReadOnly)
+			// </FS>
 			{
 				LLTimer timer;
 				for (std::set<U32>::iterator iter = purge_list.begin(); iter != purge_list.end(); ++iter)
@@ -1595,7 +1817,7 @@ void LLTextureCache::readHeaderCache()
 						break;
 					}
 				}
-				writeEntriesAndClose(entries);
+				//writeEntriesAndClose(entries); // <FS> Memory mapped texture entries, entries were modified in place
 			}
 			else
 			{
@@ -1633,6 +1855,8 @@ void LLTextureCache::clearCorruptedCache()
 
 void LLTextureCache::purgeAllTextures(bool purge_directories)
 {
+	unmapHeaderEntriesFile(); // <FS> Memory mapped texture entries, the file can't be deleted while mapped on Windows
+
 	if (!mReadOnly)
 	{
 // <FS:ND> Windows can be really slow deleting a huge texture cache.
@@ -1684,12 +1908,15 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
 		// </FS:Ansariel>
 		}
 	}
-	mHeaderIDMap.clear();
-	mTexturesSizeMap.clear();
+	// <FS> Memory mapped texture entries
+	//mHeaderIDMap.clear();
+	//mTexturesSizeMap.clear();
+	mEntryIndex.clear();
+	// </FS>
 	mTexturesSizeTotal = 0;
 	mFreeList.clear();
 	mTexturesSizeTotal = 0;
-	mUpdatedEntryMap.clear();
+	//mUpdatedEntryMap.clear(); // <FS> Memory mapped texture entries
 
 	// Info with 0 entries
 	setEntriesHeader();
@@ -1716,9 +1943,14 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
 	if (mPurgeEntryList.empty())
 	{
 		// Read the entries list and form list of textures to purge
-		std::vector<Entry> entries;
-		U32 num_entries = openAndReadEntries(entries);
-		if (!num_entries)
+		// <FS> Memory mapped texture entries
+		//std::vector<Entry> entries;
+		//U32 num_entries = openAndReadEntries(entries);
+		//if (!num_entries)
+		U32 num_entries = 0;
+		Entry* entries = getMappedEntries(num_entries);
+		if (!num_entries || !entries)
+		// </FS>
 		{
 			return; // nothing to purge
 		}
@@ -1726,23 +1958,32 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
 		// Use mTexturesSizeMap to collect UUIDs of textures with bodies
 		typedef std::set<std::pair<U32, S32> > time_idx_set_t;
 		std::set<std::pair<U32, S32> > time_idx_set;
-		for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
-			iter1 != mTexturesSizeMap.end(); ++iter1)
-		{
-			if (iter1->second > 0)
+		// <FS> Memory mapped texture entries
+		//for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
+		//	iter1 != mTexturesSizeMap.end(); ++iter1)
+		//{
+		//	if (iter1->second > 0)
+		//	{
+		//		id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
+		//		if (iter2 != mHeaderIDMap.end())
+		//		{
+		//			S32 idx = iter2->second;
+		//			time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
+		//		}
+		//		else
+		//		{
+		//			LL_ERRS("TextureCache") << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL;
+		//		}
+		//	}
+		//}
+		for (U32 idx = 0; idx < num_entries; idx++)
+		{
+			if (entries[idx].mBodySize > 0 && mEntryIndex.find(entries[idx].mID) == (S32)idx)
 			{
-				id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-				if (iter2 != mHeaderIDMap.end())
-				{
-					S32 idx = iter2->second;
-					time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
-				}
-				else
-				{
-					LL_ERRS("TextureCache") << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL;
-				}
+				time_idx_set.insert(std::make_pair(entries[idx].mTime, (S32)idx));
 			}
 		}
+		// </FS>
 
 		S64 cache_size = mTexturesSizeTotal;
 		S64 purged_cache_size = (llmax(cache_size, sCacheMaxTexturesSize) * (S64)((1.f - TEXTURE_CACHE_PURGE_AMOUNT) * 100)) / 100;
@@ -1772,8 +2013,11 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
 			Entry entry = mPurgeEntryList.back().second;
 			mPurgeEntryList.pop_back();
 			// make sure record is still valid
-			id_map_t::iterator iter_header = mHeaderIDMap.find(entry.mID);
-			if (iter_header != mHeaderIDMap.end() && iter_header->second == idx)
+			// <FS> Memory mapped texture entries
+			//id_map_t::iterator iter_header = mHeaderIDMap.find(entry.mID);
+			//if (iter_header != mHeaderIDMap.end() && iter_header->second == idx)
+			if (mEntryIndex.find(entry.mID) == idx)
+			// </FS>
 			{
 				std::string tex_filename = getTextureFileName(entry.mID);
 				removeEntry(idx, entry, tex_filename);
@@ -1801,9 +2045,14 @@ void LLTextureCache::purgeTextures(bool validate)
 	LL_INFOS() << "TEXTURE CACHE: Purging." << LL_ENDL;
 
 	// Read the entries list
-	std::vector<Entry> entries;
-	U32 num_entries = openAndReadEntries(entries);
-	if (!num_entries)
+	// <FS> Memory mapped texture entries
+	//std::vector<Entry> entries;
+	//U32 num_entries = openAndReadEntries(entries);
+	//if (!num_entries)
+	U32 num_entries = 0;
+	Entry* entries = getMappedEntries(num_entries);
+	if (!num_entries || !entries)
+	// </FS>
 	{
 		return; // nothing to purge
 	}
@@ -1811,24 +2060,32 @@ void LLTextureCache::purgeTextures(bool validate)
 	// Use mTexturesSizeMap to collect UUIDs of textures with bodies
 	typedef std::set<std::pair<U32,S32> > time_idx_set_t;
 	std::set<std::pair<U32,S32> > time_idx_set;
-	for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
-		 iter1 != mTexturesSizeMap.end(); ++iter1)
-	{
-		if (iter1->second > 0)
-		{
-			id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-			if (iter2 != mHeaderIDMap.end())
-			{
-				S32 idx = iter2->second;
-				time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
-// 				LL_INFOS() << "TIME: " << entries[idx].mTime << " TEX: " << entries[idx].mID << " IDX: " << idx << " Size: " << entries[idx].mImageSize << LL_ENDL;
-			}
-			else
-			{
-				LL_ERRS() << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL ;
-			}
-		}
-	}
+	// <FS> Memory mapped texture entries
+	//for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
+	//	 iter1 != mTexturesSizeMap.end(); ++iter1)
+	//{
+	//	if (iter1->second > 0)
+	//	{
+	//		id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
+	//		if (iter2 != mHeaderIDMap.end())
+	//		{
+	//			S32 idx = iter2->second;
+	//			time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
+	//		}
+	//		else
+	//		{
+	//			LL_ERRS() << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL ;
+	//		}
+	//	}
+	//}
+	for (U32 idx = 0; idx < num_entries; idx++)
+	{
+		if (entries[idx].mBodySize > 0 && mEntryIndex.find(entries[idx].mID) == (S32)idx)
+		{
+			time_idx_set.insert(std::make_pair(entries[idx].mTime, (S32)idx));
+		}
+	}
+	// </FS>
 	
 	// Validate 1/256th of the files on startup
 	U32 validate_idx = 0;
@@ -1885,9 +2142,11 @@ void LLTextureCache::purgeTextures(bool validate)
 		}
 	}
 
-	LL_DEBUGS("TextureCache") << "TEXTURE CACHE: Writing Entries: " << num_entries << LL_ENDL;
-
-	writeEntriesAndClose(entries);
+	// <FS> Memory mapped texture entries, entries were modified in place
+	//LL_DEBUGS("TextureCache") << "TEXTURE CACHE: Writing Entries: " << num_entries << LL_ENDL;
+	//
+	//writeEntriesAndClose(entries);
+	// </FS>
 	
 	// *FIX:Mani - watchdog back on.
 	LLAppViewer::instance()->resumeMainloopTimeout();
@@ -1930,6 +2189,32 @@ LLTextureCacheWorker* LLTextureCache::getWriter(handle_t handle)
 // Reads imagesize from the header, updates timestamp
 S32 LLTextureCache::getHeaderCacheEntry(const LLUUID& id, Entry& entry)
 {
+	// <FS> Lock striped texture entries
+	// Looking up and stamping an existing entry only needs its stripe mutex,
+	// so concurrent reads of different textures don't serialize on
+	// mHeaderMutex. Missing entries need no header update either, only
+	// corrupted entries take the slow path below to be removed.
+	{
+		LLMutexLock stripe_lock(&mEntryIndex.getMutex(id));
+		S32 idx = mEntryIndex.find(id);
+		if (idx < 0)
+		{
+			return -1;
+		}
+
+		Entry* mapped_entry = peekMappedEntry(idx);
+		if (mapped_entry && mapped_entry->mImageSize > mapped_entry->mBodySize)
+		{
+			if (!mReadOnly)
+			{
+				mapped_entry->mTime = time(NULL);
+			}
+			entry = *mapped_entry;
+			return idx;
+		}
+	}
+	// </FS>
+
 	LLMutexLock lock(&mHeaderMutex);	
 	S32 idx = openAndReadEntry(id, entry, false);
 	if (idx >= 0)
@@ -2073,14 +2358,23 @@ LLPointer<LLImageRaw> LLTextureCache::readFromFastCache(const LLUUID& id, S32& d
 {
 	U32 offset;
 	{
-		LLMutexLock lock(&mHeaderMutex);
-		id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-		if(iter == mHeaderIDMap.end())
+		//LLMutexLock lock(&mHeaderMutex); // <FS> Lock striped texture entries, the index has its own locks
+		// <FS> Memory mapped texture entries
+		//id_map_t::const_iterator iter = mHeaderIDMap.find(id);
+		//if(iter == mHeaderIDMap.end())
+		//{
+		//	return NULL; //not in the cache
+		//}
+		//
+		//offset = iter->second;
+		S32 idx = mEntryIndex.find(id);
+		if (idx < 0)
 		{
 			return NULL; //not in the cache
 		}
 
-		offset = iter->second;
+		offset = idx;
+		// </FS>
 	}
 	offset *= TEXTURE_FAST_CACHE_ENTRY_SIZE;
 
@@ -2289,12 +2583,20 @@ void LLTextureCache::addCompleted(Responder* responder, bool success)
 //called after mHeaderMutex is locked.
 void LLTextureCache::removeCachedTexture(const LLUUID& id)
 {
-	if(mTexturesSizeMap.find(id) != mTexturesSizeMap.end())
-	{
-		mTexturesSizeTotal -= mTexturesSizeMap[id] ;
-		mTexturesSizeMap.erase(id);
-	}
-	mHeaderIDMap.erase(id);
+	// <FS> Memory mapped texture entries
+	//if(mTexturesSizeMap.find(id) != mTexturesSizeMap.end())
+	//{
+	//	mTexturesSizeTotal -= mTexturesSizeMap[id] ;
+	//	mTexturesSizeMap.erase(id);
+	//}
+	//mHeaderIDMap.erase(id);
+	Entry* entry = getMappedEntry(mEntryIndex.find(id));
+	if (entry)
+	{
+		mTexturesSizeTotal -= entry->mBodySize;
+	}
+	mEntryIndex.erase(id);
+	// </FS>
 	// We are inside header's mutex so mHeaderAPRFilePoolp is safe to use,
 	// but getLocalAPRFilePool() is not safe, it might be in use by worker
 	LLAPRFile::remove(getTextureFileName(id), mHeaderAPRFilePoolp);
@@ -2323,10 +2625,16 @@ void LLTextureCache::removeEntry(S32 idx, Entry& entry, std::string& filename)
 		}
 		mTexturesSizeTotal -= entry.mBodySize;
 
+		// <FS> Lock striped texture entries, entry might be the mapped entry
+		LLMutexLock stripe_lock(&mEntryIndex.getMutex(entry.mID));
+		// </FS>
 		entry.mImageSize = -1;
 		entry.mBodySize = 0;
-		mHeaderIDMap.erase(entry.mID);
-		mTexturesSizeMap.erase(entry.mID);		
+		// <FS> Memory mapped texture entries
+		//mHeaderIDMap.erase(entry.mID);
+		//mTexturesSizeMap.erase(entry.mID);		
+		mEntryIndex.erase(entry.mID);
+		// </FS>
 		mFreeList.insert(idx);	
 	}
 
@@ -34,6 +34,9 @@
 
 #include "llworkerthread.h"
 
+#include "fsmappedfile.h" // <FS> Memory mapped texture entries
+#include "fsstripeduuidindex.h" // <FS> Lock striped texture entries
+
 class LLImageFormatted;
 class LLTextureCacheWorker;
 class LLImageRaw;
@@ -173,8 +176,16 @@ private:
 	S32 openAndReadEntry(const LLUUID& id, Entry& entry, bool create);
 	bool updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32 new_body_size);
 	void updateEntryTimeStamp(S32 idx, Entry& entry) ;
-	U32 openAndReadEntries(std::vector<Entry>& entries);
-	void writeEntriesAndClose(const std::vector<Entry>& entries);
+	// <FS> Memory mapped texture entries
+	//U32 openAndReadEntries(std::vector<Entry>& entries);
+	//void writeEntriesAndClose(const std::vector<Entry>& entries);
+	bool mapHeaderEntriesFile();
+	void unmapHeaderEntriesFile();
+	Entry* getMappedEntry(S32 idx);
+	Entry* getMappedEntries(U32& num_entries);
+	Entry* peekMappedEntry(S32 idx);
+	U32 rebuildEntryIndex();
+	// </FS>
 	void readEntryFromHeaderImmediately(S32& idx, Entry& entry) ;
 	void writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header = false) ;
 	void removeEntry(S32 idx, Entry& entry, std::string& filename);
@@ -182,7 +193,7 @@ private:
 	S32 getHeaderCacheEntry(const LLUUID& id, Entry& entry);
 	S32 setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize);
 	void writeUpdatedEntries() ;
-	void updatedHeaderEntriesFile() ;
+	//void updatedHeaderEntriesFile() ; // <FS> Memory mapped texture entries
 	void lockHeaders() { mHeaderMutex.lock(); }
 	void unlockHeaders() { mHeaderMutex.unlock(); }
 	
@@ -225,8 +236,22 @@ private:
 	EntriesInfo mHeaderEntriesInfo;
 	std::set<S32> mFreeList; // deleted entries
 	std::set<LLUUID> mLRU;
-	typedef std::map<LLUUID, S32> id_map_t;
-	id_map_t mHeaderIDMap;
+	// <FS> Memory mapped texture entries
+	//typedef std::map<LLUUID, S32> id_map_t;
+	//id_map_t mHeaderIDMap;
+
+	// texture.entries is mapped as EntriesInfo followed by a fixed size
+	// Entry table. mEntryIndex maps UUIDs to entry indices and is split
+	// into lock stripes: an entry may only be read or modified while
+	// holding the stripe mutex of its UUID, and the mapping may only be
+	// changed while holding all stripe mutexes (and mHeaderMutex).
+	// Lookups and timestamp updates of existing entries only need the
+	// stripe mutex, everything else still goes through mHeaderMutex.
+	FSMappedFile mHeaderEntriesMap;
+	U32 mHeaderEntriesCapacity;
+	FSStripedUUIDIndex mEntryIndex;
+	U32 mLRUTime; // time the LRU candidates were collected
+	// </FS>
 
 	LLAPRFile*   mFastCachep;
 	LLFrameTimer mFastCacheTimer;
@@ -234,13 +259,17 @@ private:
 
 	// BODIES (TEXTURES minus headers)
 	std::string mTexturesDirName;
-	typedef std::map<LLUUID,S32> size_map_t;
-	size_map_t mTexturesSizeMap;
+	// <FS> Memory mapped texture entries, body sizes are read from the entries table
+	//typedef std::map<LLUUID,S32> size_map_t;
+	//size_map_t mTexturesSizeMap;
+	// </FS>
 	S64 mTexturesSizeTotal;
 	LLAtomicBool mDoPurge;
 
-	typedef std::map<S32, Entry> idx_entry_map_t;
-	idx_entry_map_t mUpdatedEntryMap;
+	// <FS> Memory mapped texture entries, entries are updated in place
+	//typedef std::map<S32, Entry> idx_entry_map_t;
+	//idx_entry_map_t mUpdatedEntryMap;
+	// </FS>
 	typedef std::vector<std::pair<S32, Entry> > idx_entry_vector_t;
 	idx_entry_vector_t mPurgeEntryList;
 
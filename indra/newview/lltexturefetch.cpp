@@ -460,6 +460,13 @@ private:
 	// Locks:  Mw
 	void setImagePriority(F32 priority);
 
+	// <FS> Batched decode priorities
+	// Locks:  Mw
+	// setImagePriority() without touching the work queue, returns the
+	// request to reprioritize or nullHandle()
+	handle_t updateImagePriority(F32 priority);
+	// </FS>
+
 	// Locks:  Mw (ctor invokes without lock)
 	void setDesiredDiscard(S32 discard, S32 size);
 
@@ -504,6 +511,18 @@ private:
 			{
 				return false;
 			}
+			// <FS> Per host in-flight limit
+			static LLCachedControl<bool> use_planner(gSavedSettings, "FSTextureFetchPlanner", true);
+			if (use_planner)
+			{
+				S32 host = mFetcher->mFetchPlanner.getHost(mUrl);
+				if (!mFetcher->mFetchPlanner.acquire(host))
+				{
+					return false;
+				}
+				mPlannerHost = host;
+			}
+			// </FS>
 			mHttpHasResource = true;
 			mFetcher->mHttpSemaphore++;
 			return true;
@@ -516,6 +535,10 @@ private:
 			llassert(mHttpHasResource);
 			mHttpHasResource = false;
 			mFetcher->mHttpSemaphore--;
+			// <FS> Per host in-flight limit
+			mFetcher->mFetchPlanner.release(mPlannerHost);
+			mPlannerHost = -1;
+			// </FS>
 			llassert_always(mFetcher->mHttpSemaphore >= 0);
 		}
 	
@@ -639,6 +662,12 @@ private:
 	U32						mHttpReplySize,				// Actual received data size
 							mHttpReplyOffset;			// Actual received data offset
 	bool					mHttpHasResource;			// Counts against Fetcher's mHttpSemaphore
+	// <FS> FSTextureFetchPlanner
+	S32						mPlannerHost;				// Planner host holding a slot for mHttpHasResource, or -1
+	bool					mHttpSuperseded;			// Active request cancelled for a larger range
+	F64						mHttpSentTime;				// LLTimer::getTotalSeconds() when the active request was sent
+	// </FS>
+	U32						mHttpPriority;				// <FS> Priority the active request is queued at in llcorehttp
 
 	// State history
 	U32						mCacheReadCount,
@@ -953,6 +982,10 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
 	  mHttpReplySize(0U),
 	  mHttpReplyOffset(0U),
 	  mHttpHasResource(false),
+	  mPlannerHost(-1), // <FS>
+	  mHttpSuperseded(false), // <FS>
+	  mHttpSentTime(0.0), // <FS>
+	  mHttpPriority(0U), // <FS>
 	  mCacheReadCount(0U),
 	  mCacheWriteCount(0U),
 	  mResourceWaitCount(0U),
@@ -1116,6 +1149,22 @@ void LLTextureFetchWorker::setImagePriority(F32 priority)
 	}
 }
 
+// <FS> Batched decode priorities
+// Locks:  Mw
+LLTextureFetchWorker::handle_t LLTextureFetchWorker::updateImagePriority(F32 priority)
+{
+	F32 delta = fabs(priority - mImagePriority);
+	if (delta > (mImagePriority * .05f) || mState == DONE)
+	{
+		mImagePriority = priority;
+		calcWorkPriority();
+		U32 work_priority = mWorkPriority | (getPriority() & LLWorkerThread::PRIORITY_HIGHBITS);
+		return updatePriority(work_priority);
+	}
+	return LLWorkerThread::nullHandle();
+}
+// </FS>
+
 // Locks:  Mw
 void LLTextureFetchWorker::resetFormattedData()
 {
@@ -1607,6 +1656,8 @@ bool LLTextureFetchWorker::doWork(S32 param)
 		}
 		
 		mRequestedDeltaTimer.reset();
+		mHttpSentTime = LLTimer::getTotalSeconds(); // <FS/>
+		mHttpPriority = mWorkPriority; // <FS/>
 		mLoaded = FALSE;
 		mGetStatus = LLCore::HttpStatus();
 		mGetReason.clear();
@@ -1796,10 +1847,21 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				mRequestedOffset += src_offset;
 			}
 
-			U8 * buffer = (U8 *)ll_aligned_malloc_16(total_size);
+			// <FS> Zero-copy replies
+			// A body received into a reserved buffer sits at its offset in the
+			// file (see setReserveReplyBody()). When that is where it goes in the
+			// image, the buffer becomes the image data once the bytes in front of
+			// the range are put back; otherwise it is assembled as before.
+			//U8 * buffer = (U8 *)ll_aligned_malloc_16(total_size);
+			size_t reply_headroom(0);
+			U8 * reply = (U8 *)mHttpBufferArray->detachBuffer(&reply_headroom);
+			const bool adopt_reply(reply && reply_headroom == (size_t)(cur_size - src_offset));
+			U8 * buffer = adopt_reply ? reply : (U8 *)ll_aligned_malloc_16(total_size);
+			// </FS>
 			if (!buffer)
 			{
 				// abort. If we have no space for packet, we have not enough space to decode image
+				ll_aligned_free_16(reply); // <FS/> Zero-copy replies
 				setState(DONE);
 				LL_WARNS(LOG_TXT) << mID << " abort: out of memory" << LL_ENDL;
 				releaseHttpSemaphore();
@@ -1826,12 +1888,39 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				mFileSize = total_size + 1 ; //flag the file is not fully loaded.
 			}
 
-			if (cur_size > 0)
+			// <FS> Zero-copy replies
+			//if (cur_size > 0)
+			//{
+			//	// Copy previously collected data into buffer
+			//	memcpy(buffer, mFormattedImage->getData(), cur_size);
+			//}
+			//mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+			if (adopt_reply)
 			{
-				// Copy previously collected data into buffer
-				memcpy(buffer, mFormattedImage->getData(), cur_size);
+				// Only what precedes the range, any overlap is the same bytes
+				if (reply_headroom > 0)
+				{
+					memcpy(buffer, mFormattedImage->getData(), reply_headroom);
+				}
 			}
-			mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+			else
+			{
+				if (cur_size > 0)
+				{
+					// Copy previously collected data into buffer
+					memcpy(buffer, mFormattedImage->getData(), cur_size);
+				}
+				if (reply)
+				{
+					memcpy(buffer + cur_size, reply + reply_headroom + src_offset, append_size);
+					ll_aligned_free_16(reply);
+				}
+				else
+				{
+					mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+				}
+			}
+			// </FS>
 
 			// NOTE: setData releases current data and owns new data (buffer)
 			mFormattedImage->setData(buffer, total_size);
@@ -1866,6 +1955,32 @@ bool LLTextureFetchWorker::doWork(S32 param)
 			// various possible timeout components (total request time, connection
 			// time, I/O time, with and without retries, etc.) in the future.
 
+			// <FS> The texture wants a better discard than this range covers. While the
+			// request still waits in the llcorehttp ready queue, cancel it and send the
+			// merged range from onCompleted() rather than fetching the rest with a second
+			// request. A request already on a connection is left alone, cancelling it
+			// would close the connection.
+			static LLCachedControl<bool> use_planner(gSavedSettings, "FSTextureFetchPlanner", true);
+			static LLCachedControl<bool> disable_range_req(gSavedSettings, "HttpRangeRequestsDisable", false);
+			if (use_planner && !disable_range_req && mHttpActive && !mHttpSuperseded && mFTType == FTT_DEFAULT
+				&& mDesiredDiscard < mRequestedDiscard && mDesiredSize > mRequestedOffset + mRequestedSize)
+			{
+				LL_DEBUGS(LOG_TXT) << mID << " merging discard " << mDesiredDiscard << " into the range for discard "
+								   << mRequestedDiscard << " if still queued" << LL_ENDL;
+				mHttpSuperseded = true;
+				mFetcher->mHttpRequest->requestCancelQueued(mHttpHandle, LLCore::HttpHandler::ptr_t());
+			}
+			// While it waits for a connection in the llcorehttp ready queue, keep the
+			// request in step with the texture's priority. Small changes are not worth
+			// an operation on the request queue.
+			else if (mHttpActive && !mHttpSuperseded
+					 && (mWorkPriority > mHttpPriority + mHttpPriority / 4 || mWorkPriority < mHttpPriority - mHttpPriority / 4))
+			{
+				mHttpPriority = mWorkPriority;
+				mFetcher->mHttpRequest->requestSetPriority(mHttpHandle, mHttpPriority, LLCore::HttpHandler::ptr_t());
+			}
+			// </FS>
+
 			setPriority(LLWorkerThread::PRIORITY_LOW | mWorkPriority);
 			return false;
 		}
@@ -2063,6 +2178,32 @@ void LLTextureFetchWorker::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRe
 	LLMutexLock lock(&mWorkMutex);										// +Mw
 
 	mHttpActive = false;
+
+	// <FS> FSTextureFetchPlanner
+	static const LLCore::HttpStatus cancelled_status(LLCore::HttpStatus::LLCORE, LLCore::HE_OP_CANCELED);
+	LLCore::HttpStatus planner_status(response->getStatus());
+	if (mHttpSuperseded)
+	{
+		mHttpSuperseded = false;
+		if (planner_status == cancelled_status)
+		{
+			// Cancelled for a larger range: keep the HTTP resource and send that one now
+			mFetcher->mFetchPlanner.onSuperseded(mPlannerHost);
+			mFetcher->removeFromHTTPQueue(mID, S32Bytes(0));
+			LLViewerAssetStatsFF::record_dequeue(LLViewerAssetType::AT_TEXTURE, true, LLImageBase::TYPE_AVATAR_BAKE == mType);
+			setState(SEND_HTTP_REQ);
+			setPriority(LLWorkerThread::PRIORITY_HIGH | mWorkPriority);
+			return;
+		}
+		// Already on a connection or done when the cancel got to it, use what came back
+	}
+	if (planner_status)
+	{
+		LLCore::BufferArray* body = response->getBody();
+		F64 now = LLTimer::getTotalSeconds();
+		mFetcher->mFetchPlanner.onResponse(mPlannerHost, now, now - mHttpSentTime, body ? (S32)body->size() : 0);
+	}
+	// </FS>
 	
 	if (log_to_viewer_log || log_to_sim)
 	{
@@ -2622,6 +2763,10 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, LLImageDecodeThread* image
 	mHttpOptions = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
 	mHttpOptionsWithHeaders = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions);
 	mHttpOptionsWithHeaders->setWantHeaders(true);
+	// <FS> Zero-copy replies
+	mHttpOptions->setReserveReplyBody(true, true);
+	mHttpOptionsWithHeaders->setReserveReplyBody(true, true);
+	// </FS>
     mHttpHeaders = LLCore::HttpHeaders::ptr_t(new LLCore::HttpHeaders);
 	mHttpHeaders->append(HTTP_OUT_HEADER_ACCEPT, HTTP_CONTENT_IMAGE_X_J2C);
 	mHttpPolicyClass = app_core_http.getPolicy(LLAppCoreHttp::AP_TEXTURE);
@@ -2667,6 +2812,8 @@ LLTextureFetch::~LLTextureFetch()
 	delete mHttpRequest;
 	mHttpRequest = NULL;
 
+	mFetchPlanner.logStats(); // <FS>
+
 	delete mFetchDebugger;
 	mFetchDebugger = NULL;
 	
@@ -3042,6 +3189,33 @@ bool LLTextureFetch::updateRequestPriority(const LLUUID& id, F32 priority)
 	return res;
 }
 
+// <FS> Batched decode priorities
+// Threads:  T*
+void LLTextureFetch::updateRequestPriorities(const request_priority_list_t& priorities)
+{
+	LLQueuedThread::priority_list_t work_priorities;
+	work_priorities.reserve(priorities.size());
+	for (request_priority_list_t::const_iterator iter = priorities.begin(); iter != priorities.end(); ++iter)
+	{
+		LLTextureFetchWorker* worker = getWorker(iter->first);
+		if (worker)
+		{
+			worker->lockWorkMutex();									// +Mw
+			handle_t handle = worker->updateImagePriority(iter->second);
+			if (handle != nullHandle())
+			{
+				work_priorities.push_back(std::make_pair(handle, worker->getPriority()));
+			}
+			worker->unlockWorkMutex();									// -Mw
+		}
+	}
+	if (!work_priorities.empty())
+	{
+		setPriorities(work_priorities);
+	}
+}
+// </FS>
+
 // Replicates and expands upon the base class's
 // getPending() implementation.  getPending() and
 // runCondition() replicate one another's logic to
@@ -3110,6 +3284,7 @@ void LLTextureFetch::commonUpdate()
 		mHttpHighWater = HTTP_NONPIPE_REQUESTS_HIGH_WATER;
 		mHttpLowWater = HTTP_NONPIPE_REQUESTS_LOW_WATER;
 	}
+	mFetchPlanner.setMaxLimit(mHttpHighWater); // <FS>
 
 	// Release waiters
 	releaseHttpWaiters();
@@ -3865,7 +4040,14 @@ void LLTextureFetch::releaseHttpWaiters()
 		{
 			// Out of active slots, quit
 			worker->unlockWorkMutex();									// -Mw
-			break;
+			// <FS> Only its host is full, others may still have room
+			//break;
+			if (mHttpSemaphore >= mHttpHighWater)
+			{
+				break;
+			}
+			continue;
+			// </FS>
 		}
 		
 		worker->setState(LLTextureFetchWorker::SEND_HTTP_REQ);
@@ -42,6 +42,7 @@
 #include "httphandler.h"
 #include "lltrace.h"
 #include "llviewertexture.h"
+#include "fstexturefetchplanner.h" // <FS>
 
 class LLViewerTexture;
 class LLTextureFetchWorker;
@@ -100,6 +101,14 @@ public:
 	// Threads:  T*
 	bool updateRequestPriority(const LLUUID& id, F32 priority);
 
+	// <FS> Batched decode priorities
+	// Threads:  T*
+	// Applies updateRequestPriority() for many requests, reordering the
+	// work queue under a single lock
+	typedef std::vector<std::pair<LLUUID, F32> > request_priority_list_t;
+	void updateRequestPriorities(const request_priority_list_t& priorities);
+	// </FS>
+
     // Threads:  T*
 	bool receiveImageHeader(const LLHost& host, const LLUUID& id, U8 codec, U16 packets, U32 totalbytes, U16 data_size, U8* data);
 
@@ -379,6 +388,10 @@ private:
 	// zero), it now is an outstanding request count that is allowed to
 	// exceed the high water level (but not go below zero).
 	LLAtomicS32							mHttpSemaphore;					// Ttf
+
+	// <FS> Per host in-flight limits and refinement merging, see FSTextureFetchPlanner
+	FSTextureFetchPlanner				mFetchPlanner;					// T*
+	// </FS>
 	
 	typedef std::set<LLUUID> wait_http_res_queue_t;
 	wait_http_res_queue_t				mHttpWaitResource;				// Mfnq
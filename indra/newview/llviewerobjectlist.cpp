@@ -106,8 +106,12 @@ extern LLPipeline	gPipeline;
 
 // Statics for object lookup tables.
 U32						LLViewerObjectList::sSimulatorMachineIndex = 1; // Not zero deliberately, to speed up index check.
-std::map<U64, U32>		LLViewerObjectList::sIPAndPortToIndex;
-std::map<U64, LLUUID>	LLViewerObjectList::sIndexAndLocalIDToUUID;
+// <FS> Hash-indexed object lookup
+//std::map<U64, U32>		LLViewerObjectList::sIPAndPortToIndex;
+//std::map<U64, LLUUID>	LLViewerObjectList::sIndexAndLocalIDToUUID;
+FSFlatHashMap<U64, U32, FSObjectIndexHash>		LLViewerObjectList::sIPAndPortToIndex;
+FSFlatHashMap<U64, LLUUID, FSObjectIndexHash>	LLViewerObjectList::sIndexAndLocalIDToUUID;
+// </FS>
 
 LLViewerObjectList::LLViewerObjectList()
 	: mNewObjectSignal() // <FS:Ansariel> FIRE-16647: Default object properties randomly aren't applied
@@ -146,17 +150,31 @@ void LLViewerObjectList::getUUIDFromLocal(LLUUID &id,
 {
 	U64 ipport = (((U64)ip) << 32) | (U64)port;
 
-	U32 index = sIPAndPortToIndex[ipport];
+	// <FS> Hash-indexed object lookup
+	//U32 index = sIPAndPortToIndex[ipport];
+	//
+	//if (!index)
+	//{
+	//	index = sSimulatorMachineIndex++;
+	//	sIPAndPortToIndex[ipport] = index;
+	//}
+	U32* indexp = sIPAndPortToIndex.findValue(ipport);
+	U32 index = indexp ? *indexp : 0;
 
 	if (!index)
 	{
 		index = sSimulatorMachineIndex++;
-		sIPAndPortToIndex[ipport] = index;
+		sIPAndPortToIndex.insert(ipport, index);
 	}
+	// </FS>
 
 	U64	indexid = (((U64)index) << 32) | (U64)local_id;
 
-	id = get_if_there(sIndexAndLocalIDToUUID, indexid, LLUUID::null);
+	// <FS> Hash-indexed object lookup
+	//id = get_if_there(sIndexAndLocalIDToUUID, indexid, LLUUID::null);
+	const LLUUID* idp = sIndexAndLocalIDToUUID.findValue(indexid);
+	id = idp ? *idp : LLUUID::null;
+	// </FS>
 }
 
 U64 LLViewerObjectList::getIndex(const U32 local_id,
@@ -165,7 +183,11 @@ U64 LLViewerObjectList::getIndex(const U32 local_id,
 {
 	U64 ipport = (((U64)ip) << 32) | (U64)port;
 
-	U32 index = sIPAndPortToIndex[ipport];
+	// <FS> Hash-indexed object lookup
+	//U32 index = sIPAndPortToIndex[ipport];
+	const U32* indexp = sIPAndPortToIndex.findValue(ipport);
+	U32 index = indexp ? *indexp : 0;
+	// </FS>
 
 	if (!index)
 	{
@@ -183,24 +205,42 @@ BOOL LLViewerObjectList::removeFromLocalIDTable(const LLViewerObject* objectp)
 		U32 ip = objectp->getRegion()->getHost().getAddress();
 		U32 port = objectp->getRegion()->getHost().getPort();
 		U64 ipport = (((U64)ip) << 32) | (U64)port;
-		U32 index = sIPAndPortToIndex[ipport];
+		// <FS> Hash-indexed object lookup
+		//U32 index = sIPAndPortToIndex[ipport];
+		const U32* indexp = sIPAndPortToIndex.findValue(ipport);
+		U32 index = indexp ? *indexp : 0;
+		// </FS>
 		
 		// LL_INFOS() << "Removing object from table, local ID " << local_id << ", ip " << ip << ":" << port << LL_ENDL;
 		
 		U64	indexid = (((U64)index) << 32) | (U64)local_id;
 		
-		std::map<U64, LLUUID>::iterator iter = sIndexAndLocalIDToUUID.find(indexid);
-		if (iter == sIndexAndLocalIDToUUID.end())
+		// <FS> Hash-indexed object lookup
+		//std::map<U64, LLUUID>::iterator iter = sIndexAndLocalIDToUUID.find(indexid);
+		//if (iter == sIndexAndLocalIDToUUID.end())
+		//{
+		//	return FALSE;
+		//}
+		//
+		//// Found existing entry
+		//if (iter->second == objectp->getID())
+		//{   // Full UUIDs match, so remove the entry
+		//	sIndexAndLocalIDToUUID.erase(iter);
+		//	return TRUE;
+		//}
+		const LLUUID* idp = sIndexAndLocalIDToUUID.findValue(indexid);
+		if (!idp)
 		{
 			return FALSE;
 		}
 		
 		// Found existing entry
-		if (iter->second == objectp->getID())
+		if (*idp == objectp->getID())
 		{   // Full UUIDs match, so remove the entry
-			sIndexAndLocalIDToUUID.erase(iter);
+			sIndexAndLocalIDToUUID.erase(indexid);
 			return TRUE;
 		}
+		// </FS>
 		// UUIDs did not match - this would zap a valid entry, so don't erase it
 		//LL_INFOS() << "Tried to erase entry where id in table (" 
 		//		<< iter->second	<< ") did not match object " << object.getID() << LL_ENDL;
@@ -216,17 +256,28 @@ void LLViewerObjectList::setUUIDAndLocal(const LLUUID &id,
 {
 	U64 ipport = (((U64)ip) << 32) | (U64)port;
 
-	U32 index = sIPAndPortToIndex[ipport];
+	// <FS> Hash-indexed object lookup
+	//U32 index = sIPAndPortToIndex[ipport];
+	//
+	//if (!index)
+	//{
+	//	index = sSimulatorMachineIndex++;
+	//	sIPAndPortToIndex[ipport] = index;
+	//}
+	U32* indexp = sIPAndPortToIndex.findValue(ipport);
+	U32 index = indexp ? *indexp : 0;
 
 	if (!index)
 	{
 		index = sSimulatorMachineIndex++;
-		sIPAndPortToIndex[ipport] = index;
+		sIPAndPortToIndex.insert(ipport, index);
 	}
+	// </FS>
 
 	U64	indexid = (((U64)index) << 32) | (U64)local_id;
 
-	sIndexAndLocalIDToUUID[indexid] = id;
+	//sIndexAndLocalIDToUUID[indexid] = id;
+	sIndexAndLocalIDToUUID.insert(indexid, id); // <FS/> Hash-indexed object lookup
 	
 	//LL_INFOS() << "Adding object to table, full ID " << id
 	//	<< ", local ID " << local_id << ", ip " << ip << ":" << port << LL_ENDL;
@@ -2285,7 +2336,8 @@ LLViewerObject *LLViewerObjectList::createObjectViewer(const LLPCode pcode, LLVi
 		return NULL;
 	}
 
-	mUUIDObjectMap[fullid] = objectp;
+	//mUUIDObjectMap[fullid] = objectp;
+	mUUIDObjectMap.insert(fullid, objectp); // <FS/> Hash-indexed object lookup
 
 	mObjects.push_back(objectp);
 
@@ -2309,7 +2361,8 @@ LLViewerObject *LLViewerObjectList::createObjectFromCache(const LLPCode pcode, L
 	}
 
 	objectp->mLocalID = local_id;
-	mUUIDObjectMap[uuid] = objectp;
+	//mUUIDObjectMap[uuid] = objectp;
+	mUUIDObjectMap.insert(uuid, objectp); // <FS/> Hash-indexed object lookup
 	setUUIDAndLocal(uuid,
 					local_id,
 					regionp->getHost().getAddress(),
@@ -2362,7 +2415,8 @@ LLViewerObject *LLViewerObjectList::createObject(const LLPCode pcode, LLViewerRe
 		regionp->addToCreatedList(local_id); 
 	}
 
-	mUUIDObjectMap[fullid] = objectp;
+	//mUUIDObjectMap[fullid] = objectp;
+	mUUIDObjectMap.insert(fullid, objectp); // <FS/> Hash-indexed object lookup
 	setUUIDAndLocal(fullid,
 					local_id,
 					gMessageSystem->getSenderIP(),
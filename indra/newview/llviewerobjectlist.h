@@ -36,6 +36,7 @@
 
 // project includes
 #include "llviewerobject.h"
+#include "fsobjectlookup.h" // <FS/> Hash-indexed object lookup
 #include "lleventcoro.h"
 #include "llcoros.h"
 
@@ -228,7 +229,10 @@ protected:
     uuid_multiset_t   mDeadObjects;
 	// </FS:Beq>
 
-	std::map<LLUUID, LLPointer<LLViewerObject> > mUUIDObjectMap;
+	// <FS> Hash-indexed object lookup
+	//std::map<LLUUID, LLPointer<LLViewerObject> > mUUIDObjectMap;
+	FSFlatHashMap<LLUUID, LLPointer<LLViewerObject>, FSObjectUUIDHash> mUUIDObjectMap;
+	// </FS>
 
 	//set of objects that need to update their cost
     uuid_set_t   mStaleObjectCost;
@@ -243,9 +247,14 @@ protected:
 	S32 mCurLazyUpdateIndex;
 
 	static U32 sSimulatorMachineIndex;
-	static std::map<U64, U32> sIPAndPortToIndex;
+	// <FS> Hash-indexed object lookup
+	//static std::map<U64, U32> sIPAndPortToIndex;
+	//
+	//static std::map<U64, LLUUID> sIndexAndLocalIDToUUID;
+	static FSFlatHashMap<U64, U32, FSObjectIndexHash> sIPAndPortToIndex;
 
-	static std::map<U64, LLUUID> sIndexAndLocalIDToUUID;
+	static FSFlatHashMap<U64, LLUUID, FSObjectIndexHash> sIndexAndLocalIDToUUID;
+	// </FS>
 
 	std::set<LLViewerObject *> mSelectPickList;
 
@@ -298,15 +307,19 @@ extern LLViewerObjectList gObjectList;
  */
 inline LLViewerObject *LLViewerObjectList::findObject(const LLUUID &id)
 {
-	std::map<LLUUID, LLPointer<LLViewerObject> >::iterator iter = mUUIDObjectMap.find(id);
-	if(iter != mUUIDObjectMap.end())
-	{
-		return iter->second;
-	}
-	else
-	{
-		return NULL;
-	}
+	// <FS> Hash-indexed object lookup
+	//std::map<LLUUID, LLPointer<LLViewerObject> >::iterator iter = mUUIDObjectMap.find(id);
+	//if(iter != mUUIDObjectMap.end())
+	//{
+	//	return iter->second;
+	//}
+	//else
+	//{
+	//	return NULL;
+	//}
+	LLPointer<LLViewerObject>* objectp = mUUIDObjectMap.findValue(id);
+	return objectp ? objectp->get() : NULL;
+	// </FS>
 }
 
 inline LLViewerObject *LLViewerObjectList::getObject(const S32 index)
@@ -90,6 +90,7 @@
 #include "llviewermenu.h"
 #include "llviewernetwork.h"
 #include "llviewerparcelmgr.h"	//Aurora Sim
+#include "fsvocacheloader.h" // <FS/> Async object cache load
 
 #ifdef LL_WINDOWS
 	#pragma warning(disable:4355)
@@ -112,6 +113,7 @@ BOOL LLViewerRegion::sVOCacheCullingEnabled = FALSE;
 S32  LLViewerRegion::sLastCameraUpdated = 0;
 S32  LLViewerRegion::sNewObjectCreationThrottle = -1;
 LLViewerRegion::vocache_entry_map_t LLViewerRegion::sRegionCacheCleanup;
+std::vector<LLPointer<FSVOCacheLoad> > LLViewerRegion::sAbandonedCacheLoads; // <FS/> Async object cache load
 
 typedef std::map<std::string, std::string> CapabilityMap;
 
@@ -191,7 +193,11 @@ public:
         mLastCameraUpdate(0),
         mLastCameraOrigin(),
         mVOCachePartition(NULL),
-        mLandp(NULL)
+        mLandp(NULL),
+        // <FS> Async object cache load
+        mHandshakeReplyPending(false),
+        mCacheLoadPriority(0)
+        // </FS>
 	{}
 
 	void buildCapabilityNames(LLSD& capabilityNames);
@@ -232,6 +238,12 @@ public:
 	// etc.
 	LLUUID mCacheID;
 
+	// <FS> Async object cache load
+	LLPointer<FSVOCacheLoad> mCacheLoad; // the cache file being read for loadObjectCache()
+	bool mHandshakeReplyPending; // RegionHandshakeReply waits for mCacheLoad
+	U32 mCacheLoadPriority; // loader priority mCacheLoad was last given
+	// </FS>
+
 	CapabilityMap mCapabilities;
 	CapabilityMap mSecondCapabilitiesTracker; 
 
@@ -656,6 +668,16 @@ LLViewerRegion::LLViewerRegion(const U64 &handle,
 	setOriginGlobal(from_region_handle(handle));
 	calculateCenterGlobal();
 
+	// <FS> Async object cache load
+	// Start reading the object cache now, the region handshake needs it.
+	// Low priority until the handshake arrives, see updateObjectCacheLoadPriority().
+	if (LLVOCache::instanceExists() && gSavedSettings.getBOOL("FSObjectCacheAsyncLoad"))
+	{
+		mImpl->mCacheLoadPriority = LLQueuedThread::PRIORITY_LOW;
+		mImpl->mCacheLoad = LLVOCache::getInstance()->requestReadFromCache(mHandle, mImpl->mCacheLoadPriority);
+	}
+	// </FS>
+
 	// Create the object lists
 	initStats();
 // <FS:CR> FIRE-11593: Opensim "4096 Bug" Fix by Latif Khalifa
@@ -746,6 +768,17 @@ LLViewerRegion::~LLViewerRegion()
         saveObjectCache();
     }
 
+	// <FS> Async object cache load
+	// The loader may still be reading, keep the load so its entries are
+	// released here on the main thread by idleCleanup()
+	if (mImpl->mCacheLoad.notNull())
+	{
+		mImpl->mCacheLoad->cancel();
+		sAbandonedCacheLoads.push_back(mImpl->mCacheLoad);
+		mImpl->mCacheLoad = NULL;
+	}
+	// </FS>
+
 	delete mImpl;
 	mImpl = NULL;
 
@@ -783,6 +816,34 @@ void LLViewerRegion::loadObjectCache()
 		return;
 	}
 
+	// <FS> Async object cache load
+	if (mImpl->mCacheLoad.notNull())
+	{
+		if (!mImpl->mCacheLoad->isDone())
+		{
+			// Still reading, updateObjectCacheLoad() comes back
+			return;
+		}
+
+		mCacheLoaded = TRUE;
+		if (LLVOCache::instanceExists())
+		{
+			LLVOCache::getInstance()->finishReadFromCache(mImpl->mCacheLoad, mImpl->mCacheID, mImpl->mCacheMap);
+		}
+		// Whatever the cache did not take is released on idle, like a saved cache
+		LLVOCacheEntry::vocache_entry_map_t& discarded = mImpl->mCacheLoad->getEntries();
+		sRegionCacheCleanup.insert(discarded.begin(), discarded.end());
+		discarded.clear();
+		mImpl->mCacheLoad = NULL;
+
+		if (mImpl->mCacheMap.empty())
+		{
+			mCacheDirty = TRUE;
+		}
+		return;
+	}
+	// </FS>
+
 	// Presume success.  If it fails, we don't want to try again.
 	mCacheLoaded = TRUE;
 
@@ -1548,8 +1609,42 @@ void LLViewerRegion::clearCachedVisibleObjects()
 
 //perform some necessary but very light updates.
 //to replace the function idleUpdate(...) in case there is no enough time.
+// <FS> Async object cache load
+void LLViewerRegion::updateObjectCacheLoad()
+{
+	if (mImpl->mHandshakeReplyPending && mImpl->mCacheLoad.notNull())
+	{
+		if (mImpl->mCacheLoad->isDone())
+		{
+			loadObjectCache();
+			mImpl->mHandshakeReplyPending = false;
+			sendRegionHandshakeReply();
+		}
+		else
+		{
+			// The agent may have arrived here since the handshake
+			updateObjectCacheLoadPriority();
+		}
+	}
+}
+
+// A region waiting on its cache to answer the handshake goes ahead of
+// regions that were only prefetched, the agent's own region first
+void LLViewerRegion::updateObjectCacheLoadPriority()
+{
+	U32 priority = (gAgent.getRegion() == this) ? LLQueuedThread::PRIORITY_URGENT : LLQueuedThread::PRIORITY_HIGH;
+	if (priority != mImpl->mCacheLoadPriority && LLVOCache::instanceExists())
+	{
+		mImpl->mCacheLoadPriority = priority;
+		LLVOCache::getInstance()->setReadFromCachePriority(mImpl->mCacheLoad, priority);
+	}
+}
+// </FS>
+
 void LLViewerRegion::lightIdleUpdate()
 {
+	updateObjectCacheLoad(); // <FS/> Async object cache load
+
 	if(!sVOCacheCullingEnabled)
 	{
 		return;
@@ -1570,6 +1665,8 @@ void LLViewerRegion::idleUpdate(F32 max_update_time)
 
 	mLastUpdate = LLViewerOctreeEntryData::getCurrentFrame();
 
+	updateObjectCacheLoad(); // <FS/> Async object cache load
+
 	mImpl->mLandp->idleUpdate(max_update_time);
 	
 	if (mParcelOverlay)
@@ -1619,6 +1716,18 @@ void LLViewerRegion::idleUpdate(F32 max_update_time)
 void LLViewerRegion::idleCleanup(F32 max_update_time)
 {
     LLTimer update_timer;
+    // <FS> Async object cache load, loads of dead regions hand their entries over once done
+    for (S32 i = (S32)sAbandonedCacheLoads.size() - 1; i >= 0; --i)
+    {
+        if (sAbandonedCacheLoads[i]->isDone())
+        {
+            LLVOCacheEntry::vocache_entry_map_t& discarded = sAbandonedCacheLoads[i]->getEntries();
+            sRegionCacheCleanup.insert(discarded.begin(), discarded.end());
+            discarded.clear();
+            sAbandonedCacheLoads.erase(sAbandonedCacheLoads.begin() + i);
+        }
+    }
+    // </FS>
     while (!sRegionCacheCleanup.empty() && (max_update_time - update_timer.getElapsedTimeF32() > 0))
     {
         sRegionCacheCleanup.erase(sRegionCacheCleanup.begin());
@@ -3112,10 +3221,30 @@ void LLViewerRegion::unpackRegionHandshake()
 	// off disk.
 	loadObjectCache();
 
+	// <FS> Async object cache load
+	// The simulator starts sending objects on the reply, hold it until the
+	// cache is in. A repeated handshake while waiting changes nothing.
+	if (!mCacheLoaded)
+	{
+		mImpl->mHandshakeReplyPending = true;
+		updateObjectCacheLoadPriority();
+		return;
+	}
+	sendRegionHandshakeReply();
+}
+
+void LLViewerRegion::sendRegionHandshakeReply()
+{
+	LLMessageSystem* msg = gMessageSystem;
+	// </FS>
+
 	// After loading cache, signal that simulator can start
 	// sending data.
 	// TODO: Send all upstream viewer->sim handshake info here.
-	LLHost host = msg->getSender();
+	// <FS> Async object cache load, may be sent after the handshake is handled
+	//LLHost host = msg->getSender();
+	LLHost host = getHost();
+	// </FS>
 	msg->newMessage("RegionHandshakeReply");
 	msg->nextBlock("AgentData");
 	msg->addUUID("AgentID", gAgent.getID());
@@ -73,6 +73,7 @@ class LLViewerTexture;
 class LLViewerRegionImpl;
 class LLViewerOctreeGroup;
 class LLVOCachePartition;
+class FSVOCacheLoad; // <FS/> Async object cache load
 
 class LLViewerRegion: public LLCapabilityProvider // implements this interface
 {
@@ -253,6 +254,10 @@ public:
 
 	void idleUpdate(F32 max_update_time);
 	void lightIdleUpdate();
+	// <FS> Async object cache load
+	void updateObjectCacheLoad();
+	void updateObjectCacheLoadPriority();
+	// </FS>
 	bool addVisibleGroup(LLViewerOctreeGroup* group);
 	void addVisibleChildCacheEntry(LLVOCacheEntry* parent, LLVOCacheEntry* child);
 	void addActiveCacheEntry(LLVOCacheEntry* entry);
@@ -386,6 +391,7 @@ public:
 	void dumpCache();
 
 	void unpackRegionHandshake();
+	void sendRegionHandshakeReply(); // <FS/> Async object cache load
 
 	void calculateCenterGlobal();
 	void calculateCameraDistance();
@@ -601,6 +607,7 @@ private:
 
     typedef std::map<U32, LLPointer<LLVOCacheEntry> >	   vocache_entry_map_t;
     static vocache_entry_map_t sRegionCacheCleanup;
+    static std::vector<LLPointer<FSVOCacheLoad> > sAbandonedCacheLoads; // <FS/> Async object cache load, see idleCleanup()
 
 	// the materials capability throttle
 	LLFrameTimer mMaterialsCapThrottleTimer;
@@ -61,6 +61,8 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "llmimetypes.h"
+#include "fstexturepriority.h" // <FS> Batched decode priorities
+#include "fsimageglstaging.h" // <FS> Staged texture uploads
 
 // extern
 const S32Megabytes gMinVideoRam(32);
@@ -1683,7 +1685,18 @@ BOOL LLViewerFetchedTexture::createTexture(S32 usename/*= 0*/)
         }
     }
 
-	res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, TRUE, mBoostLevel);
+	// <FS> Staged texture uploads
+	//res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, TRUE, mBoostLevel);
+	if (mStaging.notNull())
+	{
+		res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, *mStaging, usename, mBoostLevel);
+		releaseStaging();
+	}
+	else
+	{
+		res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, TRUE, mBoostLevel);
+	}
+	// </FS>
 
 	notifyAboutCreatingTexture();
 
@@ -1700,6 +1713,55 @@ BOOL LLViewerFetchedTexture::createTexture(S32 usename/*= 0*/)
 	return res;
 }
 
+// <FS> Staged texture uploads
+bool LLViewerFetchedTexture::stageTexture()
+{
+	FSImageGLStagingThread* thread = LLAppViewer::getImageGLStagingThread();
+	if (!thread || mStaging.notNull() || !mNeedsCreateTexture || mRawImage.isNull() || mRawImage->isBufferInvalid()
+		|| mGLTexturep.isNull())
+	{
+		return false;
+	}
+	// createTexture() still rescales local images and checks explicit formats itself
+	if (mUrl.compare(0, 7, "file://") == 0 || mGLTexturep->getHasExplicitFormat())
+	{
+		return false;
+	}
+
+	FSImageGLStaging::Params params;
+	if (!mGLTexturep->getStagingParams(mRawDiscardLevel, mRawImage, params))
+	{
+		return false;
+	}
+	// Nothing to do but the upload itself
+	if (params.mLevels == 1 && params.mExpand == FSImageGLStaging::EXPAND_NONE && !params.mAnalyzeAlpha && !params.mPickMask)
+	{
+		return false;
+	}
+
+	mStaging = thread->stage(mRawImage, params);
+	return true;
+}
+
+bool LLViewerFetchedTexture::isStagingTexture() const
+{
+	return mStaging.notNull() && !mStaging->isDone();
+}
+
+void LLViewerFetchedTexture::releaseStaging()
+{
+	if (mStaging.notNull())
+	{
+		FSImageGLStagingThread* thread = LLAppViewer::getImageGLStagingThread();
+		if (thread)
+		{
+			thread->release(mStaging);
+		}
+		mStaging = NULL;
+	}
+}
+// </FS>
+
 // Call with 0,0 to turn this feature off.
 //virtual
 void LLViewerFetchedTexture::setKnownDrawSize(S32 width, S32 height)
@@ -1834,37 +1896,101 @@ F32 LLViewerFetchedTexture::calcDecodePriority()
 		return -1.0f; //alreay fetched
 	}
 
-	S32 cur_discard = getCurrentDiscardLevelForFetching();
-	bool have_all_data = (cur_discard >= 0 && (cur_discard <= mDesiredDiscardLevel));
-	F32 pixel_priority = (F32) sqrt(mMaxVirtualSize);
+	// <FS> Batched decode priorities: the formula is shared with FSTexturePriorityTable
+	FSTexturePriorityInput input;
+	getDecodePriorityInput(input);
+	return calcDecodePriority(input, (F32)sqrt(mMaxVirtualSize), mAdditionalDecodePriority);
+	// </FS>
+}
 
-	F32 priority = 0.f;
+// <FS> Batched decode priorities
+void LLViewerFetchedTexture::getDecodePriorityInput(FSTexturePriorityInput& input)
+{
+	input.mCurrentPriority = mDecodePriority;
+	input.mBoostLevel = mBoostLevel;
+	input.mCurrentDiscard = (S8)getCurrentDiscardLevelForFetching();
+	input.mDesiredDiscard = mDesiredDiscardLevel;
+	input.mCachedRawDiscard = (S8)mCachedRawDiscardLevel;
+	input.mMaxDiscard = (S8)getMaxDiscardLevel();
+	input.mMinDiscard = mMinDiscardLevel;
 
+	input.mFlags = 0;
+	if (mNeedsCreateTexture)
+	{
+		input.mFlags |= FSTexturePriorityInput::NEEDS_CREATE;
+	}
+	if (mFullyLoaded && !mForceToSaveRawImage)
+	{
+		input.mFlags |= FSTexturePriorityInput::FULLY_LOADED;
+	}
 	if (mIsMissingAsset)
+	{
+		input.mFlags |= FSTexturePriorityInput::MISSING_ASSET;
+	}
+	if (mCachedRawImageReady)
+	{
+		input.mFlags |= FSTexturePriorityInput::CACHED_RAW_READY;
+	}
+	if (isJustBound())
+	{
+		input.mFlags |= FSTexturePriorityInput::JUST_BOUND;
+	}
+	if ((S32)mTexelsPerImage > sMinLargeImageSize)
+	{
+		input.mFlags |= FSTexturePriorityInput::LARGE_IMAGE;
+	}
+}
+
+static inline void raise_additional_decode_priority(F32& additional_priority, F32 priority)
+{
+	additional_priority = llmax(additional_priority, llclamp(priority, 0.f, 1.f));
+}
+
+//static
+F32 LLViewerFetchedTexture::calcDecodePriority(const FSTexturePriorityInput& input, F32 pixel_priority, F32& additional_priority)
+{
+	if (input.mFlags & FSTexturePriorityInput::NEEDS_CREATE)
+	{
+		return llisnan(input.mCurrentPriority) ? 0.f : input.mCurrentPriority; // no change while waiting to create
+	}
+	if (input.mFlags & FSTexturePriorityInput::FULLY_LOADED)
+	{
+		return -1.0f; //alreay fetched
+	}
+
+	const S32 boost_level = input.mBoostLevel;
+	const bool cached_raw_image_ready = (input.mFlags & FSTexturePriorityInput::CACHED_RAW_READY) != 0;
+
+	S32 cur_discard = input.mCurrentDiscard;
+	bool have_all_data = (cur_discard >= 0 && (cur_discard <= input.mDesiredDiscard));
+
+	F32 priority = 0.f;
+
+	if (input.mFlags & FSTexturePriorityInput::MISSING_ASSET)
 	{
 		priority = 0.0f;
 	}
-	else if(mDesiredDiscardLevel >= cur_discard && cur_discard > -1)
+	else if(input.mDesiredDiscard >= cur_discard && cur_discard > -1)
 	{
 		priority = -2.0f;
 	}
-	else if(mCachedRawDiscardLevel > -1 && mDesiredDiscardLevel >= mCachedRawDiscardLevel)
+	else if(input.mCachedRawDiscard > -1 && input.mDesiredDiscard >= input.mCachedRawDiscard)
 	{
 		priority = -3.0f;
 	}
-	else if (mDesiredDiscardLevel > getMaxDiscardLevel())
+	else if (input.mDesiredDiscard > input.mMaxDiscard)
 	{
 		// Don't decode anything we don't need
 		priority = -4.0f;
 	}
-	else if ((mBoostLevel == LLGLTexture::BOOST_UI || mBoostLevel == LLGLTexture::BOOST_ICON) && !have_all_data)
+	else if ((boost_level == LLGLTexture::BOOST_UI || boost_level == LLGLTexture::BOOST_ICON) && !have_all_data)
 	{
 		priority = 1.f;
 	}
 	else if (pixel_priority < 0.001f && !have_all_data)
 	{
 		// Not on screen but we might want some data
-		if (mBoostLevel > BOOST_SELECTED)
+		if (boost_level > BOOST_SELECTED)
 		{
 			// Always want high boosted images
 			priority = 1.f;
@@ -1883,9 +2009,9 @@ F32 LLViewerFetchedTexture::calcDecodePriority()
 		S32 ddiscard = MAX_DISCARD_LEVEL - (S32)desired;
 		ddiscard = llclamp(ddiscard, 0, MAX_DELTA_DISCARD_LEVEL_FOR_PRIORITY);
 		priority = (ddiscard + 1) * PRIORITY_DELTA_DISCARD_LEVEL_FACTOR;
-		setAdditionalDecodePriority(0.1f);//boost the textures without any data so far.
+		raise_additional_decode_priority(additional_priority, 0.1f);//boost the textures without any data so far.
 	}
-	else if ((mMinDiscardLevel > 0) && (cur_discard <= mMinDiscardLevel))
+	else if ((input.mMinDiscard > 0) && (cur_discard <= input.mMinDiscard))
 	{
 		// larger mips are corrupted
 		priority = -6.0f;
@@ -1893,10 +2019,10 @@ F32 LLViewerFetchedTexture::calcDecodePriority()
 	else
 	{
 		// priority range = 100,000 - 500,000
-		S32 desired_discard = mDesiredDiscardLevel;
-		if (!isJustBound() && mCachedRawImageReady)
+		S32 desired_discard = input.mDesiredDiscard;
+		if (!(input.mFlags & FSTexturePriorityInput::JUST_BOUND) && cached_raw_image_ready)
 		{
-			if(mBoostLevel < BOOST_HIGH)
+			if(boost_level < BOOST_HIGH)
 			{
 				// We haven't rendered this in a while, de-prioritize it
 				desired_discard += 2;
@@ -1918,7 +2044,7 @@ F32 LLViewerFetchedTexture::calcDecodePriority()
 	// [10,000,000] + [1,000,000-9,000,000]  + [100,000-500,000]   + [1-20,000]  + [0-999]
 	if (priority > 0.0f)
 	{
-		bool large_enough = mCachedRawImageReady && ((S32)mTexelsPerImage > sMinLargeImageSize);
+		bool large_enough = cached_raw_image_ready && (input.mFlags & FSTexturePriorityInput::LARGE_IMAGE);
 		if(large_enough)
 		{
 			//Note: 
@@ -1929,21 +2055,21 @@ F32 LLViewerFetchedTexture::calcDecodePriority()
 
 		pixel_priority = llclamp(pixel_priority, 0.0f, MAX_PRIORITY_PIXEL); 
 
-		priority += pixel_priority + PRIORITY_BOOST_LEVEL_FACTOR * mBoostLevel;
+		priority += pixel_priority + PRIORITY_BOOST_LEVEL_FACTOR * boost_level;
 
-		if ( mBoostLevel > BOOST_HIGH)
+		if ( boost_level > BOOST_HIGH)
 		{
-			if(mBoostLevel > BOOST_SUPER_HIGH)
+			if(boost_level > BOOST_SUPER_HIGH)
 			{
 				//for very important textures, always grant the highest priority.
 				priority += PRIORITY_BOOST_HIGH_FACTOR;
 			}
-			else if(mCachedRawImageReady)
+			else if(cached_raw_image_ready)
 			{
 				//Note: 
 				//to give small, low-priority textures some chance to be fetched, 
 				//if high priority texture has a 64*64 ready, lower its fetching priority.
-				setAdditionalDecodePriority(0.5f);
+				raise_additional_decode_priority(additional_priority, 0.5f);
 			}
 			else
 			{
@@ -1951,10 +2077,10 @@ F32 LLViewerFetchedTexture::calcDecodePriority()
 			}
 		}		
 
-		if(mAdditionalDecodePriority > 0.0f)
+		if(additional_priority > 0.0f)
 		{
 			// priority range += 1,000,000.f-9,000,000.f
-			F32 additional = PRIORITY_ADDITIONAL_FACTOR * (1.0 + mAdditionalDecodePriority * MAX_ADDITIONAL_LEVEL_FOR_PRIORITY);
+			F32 additional = PRIORITY_ADDITIONAL_FACTOR * (1.0 + additional_priority * MAX_ADDITIONAL_LEVEL_FOR_PRIORITY);
 			if(large_enough)
 			{
 				//Note: 
@@ -1976,6 +2102,7 @@ F32 LLViewerFetchedTexture::calcDecodePriority()
 
 	return priority;
 }
+// </FS>
 
 //static
 F32 LLViewerFetchedTexture::maxDecodePriority()
@@ -3027,6 +3154,8 @@ void LLViewerFetchedTexture::destroyRawImage()
 		mAuxRawImage = NULL;
 	}
 
+	releaseStaging(); // <FS> Staged texture uploads
+
 	if (mRawImage.notNull()) 
 	{
 		sRawCount--;		
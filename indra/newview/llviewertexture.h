@@ -65,6 +65,8 @@ class LLMessageSystem;
 class LLViewerMediaImpl ;
 class LLVOVolume ;
 struct LLTextureKey;
+struct FSTexturePriorityInput; // <FS> Batched decode priorities
+class FSImageGLStaging; // <FS> Staged texture uploads
 
 class LLLoadedCallbackEntry
 {
@@ -364,9 +366,23 @@ public:
 	 // ONLY call from LLViewerTextureList
 	BOOL createTexture(S32 usename = 0);
 	void destroyTexture() ;
+	// <FS> Staged texture uploads
+	// ONLY call from LLViewerTextureList. Queues the CPU half of
+	// createTexture() on the staging thread; false if there is nothing to stage.
+	bool stageTexture();
+	bool isStagingTexture() const;
+	void releaseStaging();
+	// </FS>
 
 	virtual void processTextureStats() ;
 	F32  calcDecodePriority() ;
+	// <FS> Batched decode priorities
+	// Captures the state calcDecodePriority() reads, for FSTexturePriorityTable
+	void getDecodePriorityInput(FSTexturePriorityInput& input);
+	// The decode priority formula; pixel_priority is the square root of the
+	// max virtual size. Raises additional_priority like setAdditionalDecodePriority().
+	static F32 calcDecodePriority(const FSTexturePriorityInput& input, F32 pixel_priority, F32& additional_priority);
+	// </FS>
 
 	BOOL needsAux() const { return mNeedsAux; }
 
@@ -563,6 +579,7 @@ protected:
 
 	BOOL  mInImageList;				// TRUE if image is in list (in which case don't reset priority!)
 	BOOL  mNeedsCreateTexture;	
+	LLPointer<FSImageGLStaging> mStaging; // <FS> Staged texture uploads
 
 	BOOL   mForSculpt ; //a flag if the texture is used as sculpt data.
 	BOOL   mIsFetched ; //is loaded from remote or from cache, not generated locally.
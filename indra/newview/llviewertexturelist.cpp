@@ -987,6 +987,16 @@ void LLViewerTextureList::recalcImageDecodePriority(LLPointer<LLViewerFetchedTex
 
 void LLViewerTextureList::updateImagesDecodePriorities()
 {
+	// <FS> Batched decode priorities: every texture in use gets a new priority each frame,
+	// the loops below only do the lazy flush and deletion bookkeeping then
+	static LLCachedControl<bool> batch_decode_priorities(gSavedSettings, "FSBatchTextureDecodePriorities", true);
+	const bool update_priority = !batch_decode_priorities;
+	if (batch_decode_priorities)
+	{
+		updateBatchDecodePriorities();
+	}
+	// </FS>
+
 	// Update the decode priority for N images each frame
 	static const S32 MAX_PRIO_UPDATES = gSavedSettings.getS32("TextureFetchUpdatePriorities");         // default: 32
 	const size_t max_update_count = llmin((S32)(MAX_PRIO_UPDATES*MAX_PRIO_UPDATES*gFrameIntervalSeconds.value()) + 1, MAX_PRIO_UPDATES);
@@ -998,7 +1008,10 @@ void LLViewerTextureList::updateImagesDecodePriorities()
 	{
 		LLPointer<LLViewerFetchedTexture> imagep = *iter2;
 		iter2 = mImagesWithChangedPriorities.erase(iter2);
-		updateOneImageDecodePriority(imagep);
+		// <FS> Batched decode priorities
+		//updateOneImageDecodePriority(imagep);
+		updateOneImageDecodePriority(imagep, update_priority);
+		// </FS>
 	}
 
 	// Second, process all of the images
@@ -1012,11 +1025,17 @@ void LLViewerTextureList::updateImagesDecodePriorities()
 		mLastUpdateKey = iter->first;
 		LLPointer<LLViewerFetchedTexture> imagep = iter->second;
 		++iter; // safe to increment now
-		updateOneImageDecodePriority(imagep);
+		// <FS> Batched decode priorities
+		//updateOneImageDecodePriority(imagep);
+		updateOneImageDecodePriority(imagep, update_priority);
+		// </FS>
 	}
 }
 
-void LLViewerTextureList::updateOneImageDecodePriority(LLPointer<LLViewerFetchedTexture> imagep)
+// <FS> Batched decode priorities
+//void LLViewerTextureList::updateOneImageDecodePriority(LLPointer<LLViewerFetchedTexture> imagep)
+void LLViewerTextureList::updateOneImageDecodePriority(LLPointer<LLViewerFetchedTexture> imagep, bool update_priority)
+// </FS>
 {
 	const F32 lazy_flush_timeout = 30.f; // stop decoding
 	const F32 max_inactive_time = 20.f; // actually delete
@@ -1084,6 +1103,12 @@ void LLViewerTextureList::updateOneImageDecodePriority(LLPointer<LLViewerFetched
 			imagep->setInactive() ;
 		}
 	}
+	// <FS> Batched decode priorities
+	if (!update_priority)
+	{
+		return; // done by updateBatchDecodePriorities()
+	}
+	// </FS>
 	if (!imagep->isInImageList())
 	{
 		return;
@@ -1109,6 +1134,68 @@ void LLViewerTextureList::updateOneImageDecodePriority(LLPointer<LLViewerFetched
 }
 // </FS:Beq> FIRE-30559 
 
+// <FS> Batched decode priorities
+// Recomputes the decode priority of every texture updateOneImageDecodePriority()
+// would, in one pass: gather the inputs, evaluate them all, then apply the
+// changes to mImageList and hand them to the fetcher in a single call.
+void LLViewerTextureList::updateBatchDecodePriorities()
+{
+	const S32 list_refs = 2; // mImageList and mUUIDMap, nobody else uses the texture
+
+	mPriorityTable.clear();
+	FSTexturePriorityInput input;
+	for (image_priority_list_t::iterator iter = mImageList.begin(); iter != mImageList.end(); ++iter)
+	{
+		LLViewerFetchedTexture* imagep = *iter;
+		// Same filter as updateOneImageDecodePriority(); textures not bound since
+		// their last visit keep their priority until they are used again
+		if (imagep->isInDebug() || imagep->isUnremovable()
+			|| imagep->getNumRefs() == list_refs
+			|| imagep->isDeleted() || imagep->isDeletionCandidate() || imagep->isInactive()
+			|| imagep->isInFastCacheList())
+		{
+			continue;
+		}
+
+		imagep->processTextureStats();
+		imagep->getDecodePriorityInput(input);
+		mPriorityTable.add(imagep, imagep->getMaxVirtualSize(), imagep->getAdditionalDecodePriority(), input);
+	}
+
+	mPriorityTable.compute();
+
+	mFetchPriorityUpdates.clear();
+	for (size_t row = 0; row < mPriorityTable.size(); ++row)
+	{
+		LLPointer<LLViewerFetchedTexture> imagep = mPriorityTable.getTexture(row);
+		imagep->setAdditionalDecodePriority(mPriorityTable.getAdditional(row));
+
+		F32 old_priority_test = llmax(imagep->getDecodePriority(), 0.0f);
+		F32 decode_priority = mPriorityTable.getPriority(row);
+		F32 decode_priority_test = llmax(decode_priority, 0.0f);
+		// Ignore < 20% difference
+		if ((decode_priority_test < old_priority_test * .8f) ||
+			(decode_priority_test > old_priority_test * 1.25f))
+		{
+			mImageList.erase(imagep);
+			imagep->setDecodePriority(decode_priority);
+			mImageList.insert(imagep);
+
+			// updateFetch() still cancels requests that stay at 0 for a while
+			if (decode_priority > 0.0f && imagep->hasFetcher())
+			{
+				mFetchPriorityUpdates.push_back(std::make_pair(imagep->getID(), decode_priority));
+			}
+		}
+	}
+
+	if (!mFetchPriorityUpdates.empty())
+	{
+		LLAppViewer::getTextureFetch()->updateRequestPriorities(mFetchPriorityUpdates);
+	}
+}
+// </FS>
+
 void LLViewerTextureList::setDebugFetching(LLViewerFetchedTexture* tex, S32 debug_level)
 {
 	if(!tex->setDebugFetching(debug_level))
@@ -1167,6 +1254,39 @@ F32 LLViewerTextureList::updateImagesCreateTextures(F32 max_time)
 	//
 		
 	LLTimer create_timer;
+	// <FS> Staged texture uploads
+	// Mips, format expansion and alpha analysis of everything waiting are
+	// prepared on the staging thread; only the GL upload of finished
+	// stagings is left for here. Textures still being staged wait a frame.
+	static LLCachedControl<bool> stage_texture_uploads(gSavedSettings, "FSStageTextureUploads", true);
+	if (stage_texture_uploads)
+	{
+		for (image_list_t::iterator iter = mCreateTextureList.begin(); iter != mCreateTextureList.end(); ++iter)
+		{
+			LLViewerFetchedTexture *imagep = *iter;
+			imagep->stageTexture();
+		}
+
+		for (image_list_t::iterator iter = mCreateTextureList.begin(); iter != mCreateTextureList.end();)
+		{
+			LLViewerFetchedTexture *imagep = *iter;
+			if (imagep->isStagingTexture())
+			{
+				++iter;
+				continue;
+			}
+			// createTexture() may drop the last reference besides this list
+			LLPointer<LLViewerFetchedTexture> keep(imagep);
+			mCreateTextureList.erase(iter++);
+			imagep->createTexture();
+			if (create_timer.getElapsedTimeF32() > max_time)
+			{
+				break;
+			}
+		}
+		return create_timer.getElapsedTimeF32();
+	}
+	// </FS>
 	image_list_t::iterator enditer = mCreateTextureList.begin();
 	for (image_list_t::iterator iter = mCreateTextureList.begin();
 		 iter != mCreateTextureList.end();)
@@ -36,6 +36,7 @@
 #include <set>
 #include <deque>
 #include "lluiimage.h"
+#include "fstexturepriority.h" // <FS> Batched decode priorities
 
 const U32 LL_IMAGE_REZ_LOSSLESS_CUTOFF = 128;
 
@@ -149,7 +150,11 @@ public:
 private:
 	void updateImagesDecodePriorities();
 	// <FS:Beq/> FIRE-30559 texture fetch speedup for user previews (based on patches from Oren Hurvitz)
-	void updateOneImageDecodePriority(LLPointer<LLViewerFetchedTexture> imagep);
+	// <FS> Batched decode priorities
+	//void updateOneImageDecodePriority(LLPointer<LLViewerFetchedTexture> imagep);
+	void updateOneImageDecodePriority(LLPointer<LLViewerFetchedTexture> imagep, bool update_priority = true);
+	void updateBatchDecodePriorities();
+	// </FS>
 	F32  updateImagesCreateTextures(F32 max_time);
 	F32  updateImagesFetchTextures(F32 max_time);
 	void updateImagesUpdateStats();
@@ -240,6 +245,11 @@ private:
 	// Images that should be handled first in updateImagesDecodePriorities()
 	image_list_t mImagesWithChangedPriorities;
 	// </FS:Beq>
+
+	// <FS> Batched decode priorities
+	FSTexturePriorityTable mPriorityTable;
+	std::vector<std::pair<LLUUID, F32> > mFetchPriorityUpdates; // LLTextureFetch::request_priority_list_t
+	// </FS>
 	
 	// simply holds on to LLViewerFetchedTexture references to stop them from being purged too soon
 	std::set<LLPointer<LLViewerFetchedTexture> > mImagePreloads;
@@ -35,6 +35,7 @@
 #include "pipeline.h"
 #include "llagentcamera.h"
 #include "llmemory.h"
+#include "fsvocacheloader.h" // <FS/> Async object cache load
 
 //static variables
 U32 LLVOCacheEntry::sMinFrameRange = 0;
@@ -167,11 +168,91 @@ LLVOCacheEntry::LLVOCacheEntry(LLAPRFile* apr_file)
 	}
 }
 
+// <FS> Async object cache load
+// LLVOCacheEntry(LLAPRFile*) for a file already in memory. Reads the entry
+// at offset and moves offset past it; the body is used where it lies.
+LLVOCacheEntry::LLVOCacheEntry(FSVOCacheArena* arena, S32& offset)
+:	LLTrace::MemTrackable<LLVOCacheEntry, 16>("LLVOCacheEntry"),
+	LLViewerOctreeEntryData(LLViewerOctreeEntry::LLVOCACHEENTRY), 
+	mBuffer(NULL),
+	mUpdateFlags(-1),
+	mState(INACTIVE),
+	mSceneContrib(0.f),
+	mValid(FALSE),
+	mParentID(0),
+	mBSphereRadius(-1.0f)
+{
+	S32 size = -1;
+	BOOL success = offset + ENTRY_HEADER_SIZE <= arena->getSize();
+
+	mDP.assignBuffer(mBuffer, 0);
+
+	if (success)
+	{
+		const U8* data_buffer = arena->getData() + offset;
+		memcpy(&mLocalID, data_buffer, sizeof(U32));
+		memcpy(&mCRC, data_buffer + sizeof(U32), sizeof(U32));
+		memcpy(&mHitCount, data_buffer + (2 * sizeof(U32)), sizeof(S32));
+		memcpy(&mDupeCount, data_buffer + (3 * sizeof(U32)), sizeof(S32));
+		memcpy(&mCRCChangeCount, data_buffer + (4 * sizeof(U32)), sizeof(S32));
+		memcpy(&size, data_buffer + (5 * sizeof(U32)), sizeof(S32));
+		offset += ENTRY_HEADER_SIZE;
+
+		// Corruption in the cache entries
+		if ((size > MAX_ENTRY_BODY_SIZE) || (size < 1))
+		{
+			LL_WARNS() << "Bogus cache entry, size " << size << ", aborting!" << LL_ENDL;
+			success = FALSE;
+		}
+	}
+	if (success)
+	{
+		success = offset + size <= arena->getSize();
+	}
+
+	if (success)
+	{
+		mArena = arena;
+		mBuffer = arena->getData() + offset;
+		mDP.assignBuffer(mBuffer, size);
+		offset += size;
+	}
+	else
+	{
+		mLocalID = 0;
+		mCRC = 0;
+		mHitCount = 0;
+		mDupeCount = 0;
+		mCRCChangeCount = 0;
+		mEntry = NULL;
+		mState = INACTIVE;
+	}
+}
+// </FS>
+
 LLVOCacheEntry::~LLVOCacheEntry()
 {
-	mDP.freeBuffer();
+	// <FS> Async object cache load
+	//mDP.freeBuffer();
+	freeBuffer();
+	// </FS>
 }
 
+// <FS> Async object cache load
+void LLVOCacheEntry::freeBuffer()
+{
+	if (mArena.notNull())
+	{
+		mDP.releaseBuffer();
+		mArena = NULL;
+	}
+	else
+	{
+		mDP.freeBuffer();
+	}
+}
+// </FS>
+
 void LLVOCacheEntry::updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp)
 {
 	if(mCRC != crc)
@@ -180,7 +261,10 @@ void LLVOCacheEntry::updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp)
 		mCRCChangeCount++;
 	}
 
-	mDP.freeBuffer();
+	// <FS> Async object cache load
+	//mDP.freeBuffer();
+	freeBuffer();
+	// </FS>
 
 	llassert_always(dp.getBufferSize() > 0);
 	mBuffer = new U8[dp.getBufferSize()];
@@ -1040,6 +1124,10 @@ LLVOCache::LLVOCache(bool read_only) :
 {
 	mEnabled = gSavedSettings.getBOOL("ObjectCacheEnabled");
 	mLocalAPRFilePoolp = new LLVolatileAPRPool() ;
+	// <FS> Async object cache load
+	mLoader = NULL;
+	mCacheGeneration = 0;
+	// </FS>
 }
 
 LLVOCache::~LLVOCache()
@@ -1049,6 +1137,10 @@ LLVOCache::~LLVOCache()
 		writeCacheHeader();
 		clearCacheInMemory();
 	}
+	// <FS> Async object cache load
+	delete mLoader;
+	mLoader = NULL;
+	// </FS>
 	delete mLocalAPRFilePoolp;
 }
 
@@ -1090,6 +1182,13 @@ void LLVOCache::initCache(ELLPath location, U32 size, U32 cache_version)
 
 	readCacheHeader();	
 
+	// <FS> Async object cache load
+	if (!mLoader)
+	{
+		mLoader = new FSVOCacheLoader();
+	}
+	// </FS>
+
 	if( mMetaInfo.mVersion != cache_version
 		|| mMetaInfo.mAddressSize != expected_address) 
 	{
@@ -1127,6 +1226,7 @@ void LLVOCache::removeCache(ELLPath location, bool started)
 	LL_INFOS() << "Removing cache at " << cache_dir << LL_ENDL;
 	gDirUtilp->deleteFilesInDir(cache_dir, mask); //delete all files
 	LLFile::rmdir(cache_dir);
+	++mCacheGeneration; // <FS/> Async object cache load
 
 	clearCacheInMemory();
 	mInitialized = false;
@@ -1149,6 +1249,7 @@ void LLVOCache::removeCache()
 	std::string mask = "*";
 	LL_INFOS() << "Removing object cache at " << mObjectCacheDirName << LL_ENDL;
 	gDirUtilp->deleteFilesInDir(mObjectCacheDirName, mask); 
+	++mCacheGeneration; // <FS/> Async object cache load
 
 	clearCacheInMemory() ;
 	writeCacheHeader();
@@ -1225,6 +1326,7 @@ void LLVOCache::removeFromCache(HeaderEntryInfo* entry)
 
 	std::string filename;
 	getObjectCacheFilename(entry->mHandle, filename);
+	bumpFileGeneration(entry->mHandle); // <FS/> Async object cache load
 	LLAPRFile::remove(filename, mLocalAPRFilePoolp);
 	entry->mTime = INVALID_TIME ;
 	updateEntry(entry) ; //update the head file.
@@ -1441,6 +1543,99 @@ void LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
 
 	return ;
 }
+
+// <FS> Async object cache load
+LLPointer<FSVOCacheLoad> LLVOCache::requestReadFromCache(U64 handle, U32 priority)
+{
+	if (!mEnabled || !mLoader)
+	{
+		return NULL;
+	}
+	llassert_always(mInitialized);
+
+	if (mHandleEntryMap.find(handle) == mHandleEntryMap.end()) //no cache
+	{
+		LL_WARNS() << "No handle map entry for " << handle << LL_ENDL;
+		return NULL;
+	}
+
+	std::string filename;
+	getObjectCacheFilename(handle, filename);
+	return mLoader->load(handle, filename, getFileGeneration(handle), priority);
+}
+
+void LLVOCache::setReadFromCachePriority(FSVOCacheLoad* load, U32 priority)
+{
+	if (mLoader)
+	{
+		mLoader->setLoadPriority(load, priority);
+	}
+}
+
+U32 LLVOCache::getFileGeneration(U64 handle) const
+{
+	// Both parts only grow, so their sum changes with either
+	std::map<U64, U32>::const_iterator iter = mFileGenerations.find(handle);
+	return mCacheGeneration + (iter != mFileGenerations.end() ? iter->second : 0);
+}
+
+void LLVOCache::bumpFileGeneration(U64 handle)
+{
+	++mFileGenerations[handle];
+}
+
+void LLVOCache::finishReadFromCache(FSVOCacheLoad* load, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+{
+	if (load->getGeneration() != getFileGeneration(load->getHandle()))
+	{
+		// The file was written or removed while it was read. What was read
+		// may be torn, and the cache entry is not the one the load saw.
+		LL_INFOS() << "Object cache file " << load->getFilename() << " changed while loading, discarding" << LL_ENDL;
+		return;
+	}
+
+	bool success = load->getState() == FSVOCacheLoad::STATE_LOADED;
+	if (success)
+	{
+		if (load->getCacheID() != id)
+		{
+			LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
+			success = false;
+		}
+		else
+		{
+			LLVOCacheEntry::vocache_entry_map_t& entries = load->getEntries();
+			if (cache_entry_map.empty())
+			{
+				cache_entry_map.swap(entries);
+			}
+			else
+			{
+				for (LLVOCacheEntry::vocache_entry_map_t::iterator iter = entries.begin(); iter != entries.end(); ++iter)
+				{
+					cache_entry_map[iter->first] = iter->second;
+				}
+				entries.clear();
+			}
+			if (load->isCorrupt())
+			{
+				LL_WARNS() << "Aborting cache file load for " << load->getFilename() << ", cache file corruption!" << LL_ENDL;
+				success = false;
+			}
+		}
+	}
+
+	if (!success && cache_entry_map.empty())
+	{
+		// The cache may have dropped the region while the file was read
+		handle_entry_map_t::iterator iter = mHandleEntryMap.find(load->getHandle());
+		if (iter != mHandleEntryMap.end())
+		{
+			removeEntry(iter->second);
+		}
+	}
+}
+// </FS>
 	
 void LLVOCache::purgeEntries(U32 size)
 {
@@ -1517,6 +1712,7 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
 	{
 		std::string filename;
 		getObjectCacheFilename(handle, filename);
+		bumpFileGeneration(handle); // <FS/> Async object cache load
 		LLAPRFile apr_file(filename, APR_CREATE|APR_WRITE|APR_BINARY|APR_TRUNCATE, mLocalAPRFilePoolp);
 	
 		success = check_write(&apr_file, (void*)id.mData, UUID_BYTES);
@@ -36,6 +36,11 @@
 //---------------------------------------------------------------------------
 // Cache entries
 class LLCamera;
+// <FS> Async object cache load
+class FSVOCacheArena;
+class FSVOCacheLoad;
+class FSVOCacheLoader;
+// </FS>
 
 class LLVOCacheEntry 
 :	public LLViewerOctreeEntryData,
@@ -84,6 +89,7 @@ protected:
 public:
 	LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &dp);
 	LLVOCacheEntry(LLAPRFile* apr_file);
+	LLVOCacheEntry(FSVOCacheArena* arena, S32& offset); // <FS/> Async object cache load, body stays in the arena
 	LLVOCacheEntry();	
 
 	void updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp);
@@ -138,6 +144,7 @@ public:
 
 private:
 	void updateParentBoundingInfo(const LLVOCacheEntry* child);	
+	void freeBuffer(); // <FS/> Async object cache load
 
 public:
 	typedef std::map<U32, LLPointer<LLVOCacheEntry> >	   vocache_entry_map_t;
@@ -155,6 +162,7 @@ protected:
 	S32							mCRCChangeCount;
 	LLDataPackerBinaryBuffer	mDP;
 	U8							*mBuffer;
+	LLPointer<FSVOCacheArena>	mArena; // <FS/> Async object cache load, owns mBuffer when set
 
 	F32                         mSceneContrib; //projected scene contributuion of this object.
 	U32                         mState; //high 16 bits reserved for special use.
@@ -264,6 +272,13 @@ public:
 	void removeCache(ELLPath location, bool started = false) ;
 
 	void readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) ;
+	// <FS> Async object cache load
+	// Starts reading the cache file of a region on the loader thread; NULL if there is nothing to read
+	LLPointer<FSVOCacheLoad> requestReadFromCache(U64 handle, U32 priority);
+	void setReadFromCachePriority(FSVOCacheLoad* load, U32 priority);
+	// readFromCache() for a finished load. Entries left in the load were not taken.
+	void finishReadFromCache(FSVOCacheLoad* load, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map);
+	// </FS>
 	void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, BOOL dirty_cache, bool removal_enabled);
 	void removeEntry(U64 handle) ;
 
@@ -295,6 +310,16 @@ private:
 	LLVolatileAPRPool*   mLocalAPRFilePoolp ; 	
 	header_entry_queue_t mHeaderEntryQueue;
 	handle_entry_map_t   mHandleEntryMap;	
+	// <FS> Async object cache load
+	// Changes whenever a region's cache file is written or removed, so a
+	// load that raced with that is thrown away
+	U32 getFileGeneration(U64 handle) const;
+	void bumpFileGeneration(U64 handle);
+
+	FSVOCacheLoader*     mLoader;
+	std::map<U64, U32>   mFileGenerations;
+	U32                  mCacheGeneration; // bumped when the whole cache is removed
+	// </FS>
 };
 
 #endif
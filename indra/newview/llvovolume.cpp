@@ -4761,6 +4761,12 @@ BOOL LLVOVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a&
 	{
 		if ((pick_rigged) || (getAvatar() && (getAvatar()->isSelf()) && (LLFloater::isVisible(gFloaterTools))))
 		{
+			// <FS> Rigged bounds
+			if (!riggedBoundsIntersect(start, end, face))
+			{
+				return FALSE;
+			}
+			// </FS>
 			updateRiggedVolume(true);
 			volume = mRiggedVolume;
 			transform = false;
@@ -4996,6 +5002,53 @@ void LLVOVolume::updateRiggedVolume(bool force_update)
 	mRiggedVolume->update(skin, avatar, volume);
 }
 
+// <FS> Rigged bounds
+static LLTrace::BlockTimerStatHandle FTM_RIGGED_BOUNDS("Rigged Bounds");
+
+bool LLVOVolume::riggedBoundsIntersect(const LLVector4a& start, const LLVector4a& end, S32 face)
+{
+	static LLCachedControl<bool> pick_rigged_bounds(gSavedSettings, "FSPickRiggedBounds");
+	LLVolume* volume = getVolume();
+	const LLMeshSkinInfo* skin = getSkinInfo();
+	LLVOAvatar* avatar = getAvatar();
+	if (!pick_rigged_bounds || !volume || !skin || !avatar || mDrawable.isNull())
+	{
+		// nothing to rule out with, leave it to the exact test
+		return true;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_RIGGED_BOUNDS);
+
+	if (mRiggedBounds.isNull())
+	{
+		mRiggedBounds = new FSRiggedBounds();
+	}
+
+	bool rebuild = !mRiggedBounds->isSource(volume, skin) || mRiggedBounds->getNumFaces() != volume->getNumVolumeFaces();
+	for (S32 i = 0; i < volume->getNumVolumeFaces() && !rebuild; ++i)
+	{
+		const LLVolumeFace& vol_face = volume->getVolumeFace(i);
+		rebuild = !mRiggedBounds->matchesFace(i, vol_face.mNumVertices, vol_face.mNumIndices);
+	}
+
+	U32 count = LLSkinningUtil::getMeshJointCount(skin);
+	if (rebuild)
+	{
+		mRiggedBounds->clear();
+		for (S32 i = 0; i < volume->getNumVolumeFaces(); ++i)
+		{
+			const LLVolumeFace& vol_face = volume->getVolumeFace(i);
+			mRiggedBounds->addFace(skin->mBindShapeMatrix, vol_face.mPositions, vol_face.mWeights, vol_face.mNumVertices,
+								   vol_face.mIndices, vol_face.mNumIndices, count);
+		}
+		mRiggedBounds->setSource(volume, skin);
+	}
+
+	mRiggedBounds->update(LLDrawPoolAvatar::getCacheSkinningMats(mDrawable, skin, count, avatar));
+	return mRiggedBounds->lineSegmentIntersect(start, end, face);
+}
+// </FS>
+
 static LLTrace::BlockTimerStatHandle FTM_SKIN_RIGGED("Skin");
 static LLTrace::BlockTimerStatHandle FTM_RIGGED_OCTREE("Octree");
 
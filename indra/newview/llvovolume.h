@@ -34,6 +34,7 @@
 #include "lllocalbitmaps.h"
 #include "m3math.h"		// LLMatrix3
 #include "m4math.h"		// LLMatrix4
+#include "fsriggedbounds.h" // <FS/> Rigged bounds
 #include <map>
 #include <set>
 
@@ -378,6 +379,12 @@ public:
 	//clear out rigged volume and revert back to non-rigged state for picking/LOD/distance updates
 	void clearRiggedVolume();
 
+	// <FS> Rigged bounds
+	// False when the segment surely misses face (-1 for any) in the current pose,
+	// so picking can skip the full re-skin of updateRiggedVolume()
+	bool riggedBoundsIntersect(const LLVector4a& start, const LLVector4a& end, S32 face);
+	// </FS>
+
 protected:
 	S32	computeLODDetail(F32	distance, F32 radius, F32 lod_factor);
 	BOOL calcLOD();
@@ -436,6 +443,7 @@ private:
 	bool mResetDebugText;
 
 	LLPointer<LLRiggedVolume> mRiggedVolume;
+	LLPointer<FSRiggedBounds> mRiggedBounds; // <FS/> Rigged bounds
 
 	// statics
 public:
@@ -4575,6 +4575,7 @@ void LLPipeline::renderGeom(LLCamera& camera, bool forceVBOUpdate)
 			poolp->prerender();
 		}
 	}
+	LLDrawPoolAvatar::finishRiggedSkinning(); // <FS/> Parallel skinning
 
 	{
 		LL_RECORD_BLOCK_TIME(FTM_POOLS);
@@ -4767,6 +4768,7 @@ void LLPipeline::renderGeomDeferred(LLCamera& camera)
 			poolp->prerender();
 		}
 	}
+	LLDrawPoolAvatar::finishRiggedSkinning(); // <FS/> Parallel skinning
 
 	LLGLEnable multisample(RenderFSAASamples > 0 ? GL_MULTISAMPLE_ARB : 0);
 
@@ -4957,6 +4959,7 @@ void LLPipeline::renderGeomShadow(LLCamera& camera)
 		if (hasRenderType(poolp->getType()) && poolp->getNumShadowPasses() > 0)
 		{
 			poolp->prerender() ;
+			LLDrawPoolAvatar::finishRiggedSkinning(); // <FS/> Parallel skinning
 
 			gGLLastMatrix = NULL;
 			gGL.loadMatrix(gGLModelView);
@@ -0,0 +1,198 @@
+/**
+ * @file fsmeshheader_test.cpp
+ * @brief Tests for FSMeshHeader and FSMeshHeaderMap.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../fsmeshheader.h"
+
+#include "lldate.h"
+#include "llsd.h"
+#include "llsdserialize.h"
+
+#include <sstream>
+
+namespace
+{
+    LLSD make_block(S32 offset, S32 size)
+    {
+        LLSD block;
+        block["offset"] = offset;
+        block["size"] = size;
+        return block;
+    }
+
+    // A header as written by LLModel::writeModel()
+    LLSD make_header()
+    {
+        LLSD header;
+        header["version"] = 1;
+        header["creator"] = LLUUID("8c3e5bbc-3b3d-4d8e-a1b5-4d0c8b1c2a11");
+        header["date"] = LLDate::now();
+        header["lowest_lod"] = make_block(0, 1200);
+        header["low_lod"] = make_block(1200, 3400);
+        header["medium_lod"] = make_block(4600, 9100);
+        header["high_lod"] = make_block(13700, 40200);
+        header["skin"] = make_block(53900, 2100);
+        header["physics_convex"] = make_block(56000, 800);
+        header["physics_cost_data"]["hull"] = 1.5;
+        header["physics_cost_data"]["mesh_triangles"] = 12;
+        header["submodel_id"] = 0;
+        return header;
+    }
+
+    std::string to_binary(const LLSD& header)
+    {
+        std::ostringstream out;
+        LLSDSerialize::toBinary(header, out);
+        return out.str();
+    }
+
+    void ensure_same(const FSMeshHeader& lhs, const FSMeshHeader& rhs)
+    {
+        tut::ensure_equals("version", lhs.mVersion, rhs.mVersion);
+        tut::ensure_equals("has version", lhs.mHasVersion, rhs.mHasVersion);
+        tut::ensure_equals("404", lhs.m404, rhs.m404);
+        tut::ensure_equals("creator", lhs.mCreator, rhs.mCreator);
+        tut::ensure_equals("block mask", lhs.mBlockMask, rhs.mBlockMask);
+        for (S32 i = 0; i < FSMeshHeader::BLOCK_COUNT; ++i)
+        {
+            tut::ensure_equals("offset", lhs.mBlocks[i].mOffset, rhs.mBlocks[i].mOffset);
+            tut::ensure_equals("size", lhs.mBlocks[i].mSize, rhs.mBlocks[i].mSize);
+        }
+    }
+}
+
+namespace tut
+{
+    struct FSMeshHeaderFixture
+    {
+    };
+    typedef test_group<FSMeshHeaderFixture> FSMeshHeaderTest_factory;
+    typedef FSMeshHeaderTest_factory::object FSMeshHeaderTest_t;
+    FSMeshHeaderTest_factory tf("FSMeshHeader");
+
+    // The binary parser agrees with LLSDSerialize and reports the map length
+    template<> template<>
+    void FSMeshHeaderTest_t::test<1>()
+    {
+        LLSD llsd = make_header();
+        std::string data = to_binary(llsd);
+        // LOD data follows the header in a real asset
+        std::string asset = data + std::string(64, '\x5a');
+
+        FSMeshHeader parsed;
+        S32 used = 0;
+        ensure("parse", parsed.parse((const U8*)asset.data(), (S32)asset.size(), used));
+        ensure_equals("used", used, (S32)data.size());
+
+        FSMeshHeader converted;
+        converted.fromLLSD(llsd);
+        ensure_same(parsed, converted);
+
+        ensure("has high lod", parsed.hasBlock(FSMeshHeader::BLOCK_HIGH_LOD));
+        ensure("no physics mesh", !parsed.hasBlock(FSMeshHeader::BLOCK_PHYSICS_MESH));
+        ensure_equals("high lod size", parsed.getLOD(3).mSize, 40200);
+        ensure_equals("skin offset", parsed.getBlock(FSMeshHeader::BLOCK_SKIN).mOffset, 53900);
+    }
+
+    // Anything the parser does not understand is refused, not misread
+    template<> template<>
+    void FSMeshHeaderTest_t::test<2>()
+    {
+        FSMeshHeader header;
+        S32 used;
+        std::string data = to_binary(make_header());
+        for (size_t size = 0; size < data.size(); ++size)
+        {
+            ensure("truncated", !header.parse((const U8*)data.data(), (S32)size, used));
+        }
+
+        LLSD llsd = make_header();
+        llsd["version"] = "1";
+        data = to_binary(llsd);
+        ensure("string version", !header.parse((const U8*)data.data(), (S32)data.size(), used));
+
+        llsd = make_header();
+        llsd["high_lod"]["size"] = 40200.0;
+        data = to_binary(llsd);
+        ensure("real size", !header.parse((const U8*)data.data(), (S32)data.size(), used));
+
+        data = to_binary(LLSD::emptyArray());
+        ensure("array", !header.parse((const U8*)data.data(), (S32)data.size(), used));
+
+        // values the viewer does not read may be of any type
+        llsd = make_header();
+        llsd["creator"] = "nobody";
+        llsd["404"] = 1;
+        data = to_binary(llsd);
+        ensure("string creator", header.parse((const U8*)data.data(), (S32)data.size(), used));
+        ensure("null creator", header.mCreator.isNull());
+        ensure("404", header.m404);
+    }
+
+    // Lookups survive growth, replacing keeps the size, null ids work
+    template<> template<>
+    void FSMeshHeaderTest_t::test<3>()
+    {
+        FSMeshHeaderMap map;
+        ensure("empty", map.find(LLUUID::generateNewID()) == NULL);
+
+        std::vector<LLUUID> ids(5000);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            ids[i].generate();
+            FSMeshHeader header;
+            header.mVersion = (S32)i;
+            map.set(ids[i], header);
+        }
+        ensure_equals("size", map.size(), ids.size());
+        ensure("load", map.size() * 10 <= map.capacity() * 7);
+
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            FSMeshHeader header;
+            ensure("get", map.get(ids[i], header));
+            ensure_equals("value", header.mVersion, (S32)i);
+        }
+
+        FSMeshHeader replaced;
+        replaced.m404 = true;
+        map.set(ids[7], replaced);
+        ensure_equals("size after replace", map.size(), ids.size());
+        ensure("replaced", map.find(ids[7])->m404);
+
+        ensure("no null", map.find(LLUUID::null) == NULL);
+        map.set(LLUUID::null, replaced);
+        ensure("null", map.find(LLUUID::null) != NULL);
+        ensure_equals("null counted", map.size(), ids.size() + 1);
+
+        map.clear();
+        ensure("cleared", map.size() == 0 && !map.find(ids[0]) && !map.find(LLUUID::null));
+    }
+}
@@ -0,0 +1,326 @@
+/**
+ * @file fsobjectlookup_test.cpp
+ * @brief Tests and lookup benchmark for FSFlatHashMap.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../fsobjectlookup.h"
+
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "lltimer.h"
+
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+
+namespace
+{
+    class TestObject : public LLRefCount
+    {
+    public:
+        TestObject(const LLUUID& id) : mID(id) {}
+
+        LLUUID mID;
+    };
+
+    LLUUID random_id(std::mt19937& random)
+    {
+        LLUUID id;
+        for (S32 i = 0; i < UUID_BYTES; ++i)
+        {
+            id.mData[i] = (U8)random();
+        }
+        return id;
+    }
+
+    U64 index_key(U32 index, U32 local_id)
+    {
+        return ((U64)index << 32) | (U64)local_id;
+    }
+
+    // What processObjectUpdate() does to the tables, shaped like an arrival
+    // next to a few busy regions: creates, a long tail of updates biased to
+    // a hot set, and kills
+    struct UpdateEvent
+    {
+        enum EType
+        {
+            CREATE,
+            UPDATE,
+            KILL
+        };
+
+        EType   mType;
+        U64     mKey;
+        LLUUID  mID;
+    };
+
+    std::vector<UpdateEvent> make_update_stream(std::mt19937& random, U32 regions, U32 objects_per_region, U32 updates)
+    {
+        std::vector<UpdateEvent> stream;
+        std::vector<UpdateEvent> live;
+        for (U32 region = 1; region <= regions; ++region)
+        {
+            for (U32 local_id = 1; local_id <= objects_per_region; ++local_id)
+            {
+                UpdateEvent event = { UpdateEvent::CREATE, index_key(region, local_id * 7 + region), random_id(random) };
+                stream.push_back(event);
+                live.push_back(event);
+            }
+        }
+
+        U32 next_local_id = objects_per_region * 8;
+        for (U32 i = 0; i < updates; ++i)
+        {
+            U32 roll = random() % 100;
+            if (roll < 3 && !live.empty())
+            {
+                size_t victim = random() % live.size();
+                UpdateEvent event = live[victim];
+                event.mType = UpdateEvent::KILL;
+                stream.push_back(event);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+            else if (roll < 6)
+            {
+                UpdateEvent event = { UpdateEvent::CREATE, index_key(1 + random() % regions, ++next_local_id), random_id(random) };
+                stream.push_back(event);
+                live.push_back(event);
+            }
+            else if (!live.empty())
+            {
+                // a quarter of the objects get most of the updates
+                size_t pick = random() % live.size();
+                if (random() % 4)
+                {
+                    pick %= llmax((size_t)1, live.size() / 4);
+                }
+                UpdateEvent event = live[pick];
+                event.mType = UpdateEvent::UPDATE;
+                stream.push_back(event);
+            }
+        }
+        return stream;
+    }
+}
+
+namespace tut
+{
+    struct FSObjectLookupFixture
+    {
+        std::mt19937 mRandom;
+    };
+    typedef test_group<FSObjectLookupFixture> FSObjectLookupTest_factory;
+    typedef FSObjectLookupTest_factory::object FSObjectLookupTest_t;
+    FSObjectLookupTest_factory tf("FSObjectLookup");
+
+    // Behaves like the std::map it replaces through random inserts and erases
+    template<> template<>
+    void FSObjectLookupTest_t::test<1>()
+    {
+        FSFlatHashMap<U64, LLUUID, FSObjectIndexHash> flat;
+        std::map<U64, LLUUID> reference;
+
+        for (S32 i = 0; i < 200000; ++i)
+        {
+            // a small key space so replaces and erases of present keys are common
+            U64 key = index_key(1 + mRandom() % 4, mRandom() % 5000);
+            if (mRandom() % 3)
+            {
+                LLUUID id = random_id(mRandom);
+                flat.insert(key, id);
+                reference[key] = id;
+            }
+            else
+            {
+                ensure_equals("erase", flat.erase(key), reference.erase(key) > 0);
+            }
+        }
+
+        ensure_equals("size", flat.size(), reference.size());
+        for (U32 index = 1; index <= 4; ++index)
+        {
+            for (U32 local_id = 0; local_id < 5000; ++local_id)
+            {
+                U64 key = index_key(index, local_id);
+                const LLUUID* found = flat.findValue(key);
+                std::map<U64, LLUUID>::const_iterator iter = reference.find(key);
+                ensure_equals("present", found != NULL, iter != reference.end());
+                if (found)
+                {
+                    ensure("value", *found == iter->second);
+                }
+            }
+        }
+
+        flat.clear();
+        ensure("cleared", flat.empty());
+        ensure("nothing left", flat.findValue(reference.begin()->first) == NULL);
+    }
+
+    // Handles survive growth and other erases, and erasing releases the value
+    template<> template<>
+    void FSObjectLookupTest_t::test<2>()
+    {
+        typedef FSFlatHashMap<LLUUID, LLPointer<TestObject>, FSObjectUUIDHash> object_map_t;
+        object_map_t objects;
+
+        LLPointer<TestObject> first = new TestObject(random_id(mRandom));
+        object_map_t::handle_t handle = objects.insert(first->mID, first);
+        ensure_equals("held by the map", first->getNumRefs(), 2);
+
+        std::vector<LLUUID> others;
+        for (S32 i = 0; i < 10000; ++i)
+        {
+            others.push_back(random_id(mRandom));
+            objects.insert(others.back(), new TestObject(others.back()));
+        }
+        for (S32 i = 0; i < 10000; i += 2)
+        {
+            ensure("erase", objects.erase(others[i]));
+        }
+
+        ensure_equals("same handle", objects.find(first->mID), handle);
+        ensure("same object", objects.getValue(handle) == first);
+        ensure("key", objects.getKey(handle) == first->mID);
+        for (S32 i = 0; i < 10000; ++i)
+        {
+            LLPointer<TestObject>* found = objects.findValue(others[i]);
+            ensure_equals("other", found != NULL, (i & 1) == 1);
+        }
+
+        ensure("erase first", objects.erase(first->mID));
+        ensure_equals("released", first->getNumRefs(), 1);
+        ensure("gone", objects.find(first->mID) == object_map_t::INVALID_HANDLE);
+        ensure("erase twice", !objects.erase(first->mID));
+        ensure_equals("size", objects.size(), (size_t)5000);
+    }
+
+    // Replays a synthetic object update stream through the two lookups
+    // processObjectUpdate() makes per update: (region index, local id) to
+    // UUID, then UUID to object.
+    template<> template<>
+    void FSObjectLookupTest_t::test<3>()
+    {
+        skip_unless_benchmarks();
+
+        const U32 REGIONS = 9;
+        const U32 UPDATES = 1000000;
+
+        std::cout << std::endl << "FSObjectLookup, " << REGIONS << " regions, " << UPDATES << " updates" << std::endl;
+        std::cout << std::setw(10) << "objects" << std::setw(14) << "std::map ms" << std::setw(14) << "flat ms"
+                  << std::setw(10) << "speedup" << std::endl;
+
+        const U32 per_region[] = { 1000, 5000, 15000 };
+        for (U32 objects_per_region : per_region)
+        {
+            std::vector<UpdateEvent> stream = make_update_stream(mRandom, REGIONS, objects_per_region, UPDATES);
+            std::vector<LLPointer<TestObject> > pool;
+            for (const UpdateEvent& event : stream)
+            {
+                if (event.mType == UpdateEvent::CREATE)
+                {
+                    pool.push_back(new TestObject(event.mID));
+                }
+            }
+
+            U32 map_found = 0;
+            LLTimer timer;
+            {
+                std::map<U64, LLUUID> local_ids;
+                std::map<LLUUID, LLPointer<TestObject> > objects;
+                size_t next_object = 0;
+                for (const UpdateEvent& event : stream)
+                {
+                    if (event.mType == UpdateEvent::CREATE)
+                    {
+                        local_ids[event.mKey] = event.mID;
+                        objects[event.mID] = pool[next_object++];
+                        continue;
+                    }
+                    std::map<U64, LLUUID>::iterator id_iter = local_ids.find(event.mKey);
+                    if (id_iter == local_ids.end())
+                    {
+                        continue;
+                    }
+                    std::map<LLUUID, LLPointer<TestObject> >::iterator object_iter = objects.find(id_iter->second);
+                    if (object_iter != objects.end())
+                    {
+                        ++map_found;
+                        if (event.mType == UpdateEvent::KILL)
+                        {
+                            objects.erase(object_iter);
+                            local_ids.erase(id_iter);
+                        }
+                    }
+                }
+            }
+            F64 map_ms = timer.getElapsedTimeF64() * 1000.0;
+
+            U32 flat_found = 0;
+            timer.reset();
+            {
+                FSFlatHashMap<U64, LLUUID, FSObjectIndexHash> local_ids;
+                FSFlatHashMap<LLUUID, LLPointer<TestObject>, FSObjectUUIDHash> objects;
+                size_t next_object = 0;
+                for (const UpdateEvent& event : stream)
+                {
+                    if (event.mType == UpdateEvent::CREATE)
+                    {
+                        local_ids.insert(event.mKey, event.mID);
+                        objects.insert(event.mID, pool[next_object++]);
+                        continue;
+                    }
+                    const LLUUID* id = local_ids.findValue(event.mKey);
+                    if (!id)
+                    {
+                        continue;
+                    }
+                    if (objects.findValue(*id))
+                    {
+                        ++flat_found;
+                        if (event.mType == UpdateEvent::KILL)
+                        {
+                            objects.erase(*id);
+                            local_ids.erase(event.mKey);
+                        }
+                    }
+                }
+            }
+            F64 flat_ms = timer.getElapsedTimeF64() * 1000.0;
+
+            ensure_equals("same lookups", flat_found, map_found);
+            std::cout << std::setw(10) << REGIONS * objects_per_region << std::fixed << std::setprecision(2)
+                      << std::setw(14) << map_ms << std::setw(14) << flat_ms
+                      << std::setw(9) << map_ms / flat_ms << "x" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,366 @@
+/**
+ * @file fsriggedbounds_test.cpp
+ * @brief Tests and picking benchmark for FSRiggedBounds.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../fsriggedbounds.h"
+
+#include "llquaternion.h"
+#include "lltimer.h"
+#include "llvolume.h"
+#include "m4math.h"
+#include "v4math.h"
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "../test/lltut.h"
+
+namespace
+{
+    const U32 JOINTS = 32;
+
+    typedef std::vector<LLVector4a, boost::alignment::aligned_allocator<LLVector4a, 16> > vector4a_t;
+
+    // One rigged face: a wavy sheet of vertices weighted to up to four
+    // neighbouring joints, the way a body part is weighted along its bones.
+    // Some vertices have no weight at all, as some uploads do.
+    struct Face
+    {
+        vector4a_t          mPositions;
+        vector4a_t          mWeights;
+        std::vector<U16>    mIndices;
+    };
+
+    F32 unit(std::mt19937& random)
+    {
+        return (F32)(random() & 0xffff) / 65535.f;
+    }
+
+    Face make_face(std::mt19937& random, S32 size)
+    {
+        Face face;
+        for (S32 y = 0; y < size; ++y)
+        {
+            for (S32 x = 0; x < size; ++x)
+            {
+                LLVector4a pos((F32)x / size - 0.5f, (F32)y / size - 0.5f, 0.1f * sinf((F32)(x + y)), 1.f);
+                face.mPositions.push_back(pos);
+
+                // joints follow y; the fractional part is the weight
+                U32 base = llmin((U32)(y * (JOINTS - 3) / size), JOINTS - 4);
+                LLVector4a weights;
+                F32* w = weights.getF32ptr();
+                S32 used = 1 + (S32)(random() % 4);
+                for (S32 k = 0; k < 4; ++k)
+                {
+                    w[k] = k < used ? (F32)(base + k) + 0.05f + 0.9f * unit(random) : 0.f;
+                }
+                if ((y * size + x) % 7 == 3)
+                {
+                    weights.set((F32)base, 0.f, 0.f, 0.f);
+                }
+                face.mWeights.push_back(weights);
+            }
+        }
+        for (S32 y = 0; y + 1 < size; ++y)
+        {
+            for (S32 x = 0; x + 1 < size; ++x)
+            {
+                U16 i = (U16)(y * size + x);
+                U16 quad[] = { i, (U16)(i + 1), (U16)(i + size), (U16)(i + 1), (U16)(i + size + 1), (U16)(i + size) };
+                face.mIndices.insert(face.mIndices.end(), quad, quad + 6);
+            }
+        }
+        return face;
+    }
+
+    // A random pose: every joint rotated, scaled and moved
+    void make_palette(std::mt19937& random, LLMatrix4a* palette)
+    {
+        for (U32 joint = 0; joint < JOINTS; ++joint)
+        {
+            LLVector3 axis(unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f);
+            axis.normVec();
+            LLQuaternion rot(F_TWO_PI * unit(random), axis);
+            LLMatrix4 mat(rot, LLVector4(unit(random) - 0.5f, unit(random) - 0.5f, unit(random) - 0.5f, 1.f));
+            F32 scale = 0.5f + unit(random);
+            for (S32 row = 0; row < 3; ++row)
+            {
+                for (S32 col = 0; col < 3; ++col)
+                {
+                    mat.mMatrix[row][col] *= scale;
+                }
+            }
+            palette[joint].loadu(mat);
+        }
+    }
+
+    // Skins a vertex the way LLSkinningUtil::getPerVertexSkinMatrix() does,
+    // a vertex without weight following its first joint
+    void skin(const LLMatrix4a& bind_shape, const LLMatrix4a* palette, const LLVector4a& position, const LLVector4a& weights,
+              LLVector4a& out)
+    {
+        const F32* w = weights.getF32ptr();
+        F32 wght[4];
+        F32 scale = 0.f;
+        for (S32 k = 0; k < 4; ++k)
+        {
+            wght[k] = w[k] - (F32)(S32)w[k];
+            scale += wght[k];
+        }
+        for (S32 k = 0; k < 4; ++k)
+        {
+            wght[k] = scale > 0.f ? wght[k] / scale : (k == 0 ? 1.f : 0.f);
+        }
+
+        LLMatrix4a final_mat;
+        final_mat.clear();
+        for (S32 k = 0; k < 4; ++k)
+        {
+            S32 idx = llmin((S32)w[k], (S32)JOINTS - 1);
+            LLMatrix4a src;
+            src.setMul(palette[idx], wght[k]);
+            final_mat.add(src);
+        }
+
+        LLVector4a bound;
+        bind_shape.affineTransform(position, bound);
+        final_mat.affineTransform(bound, out);
+    }
+
+    bool inside(const LLVector4a* extents, const LLVector4a& pos)
+    {
+        const F32 EPSILON = 1.e-4f;
+        for (S32 i = 0; i < 3; ++i)
+        {
+            if (pos[i] < extents[0][i] - EPSILON || pos[i] > extents[1][i] + EPSILON)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace tut
+{
+    struct FSRiggedBoundsFixture
+    {
+        std::mt19937            mRandom;
+        std::vector<Face>       mFaces;
+        LLMatrix4               mBindShape;
+        LLMatrix4a              mBindShapeMatrix;
+        LLMatrix4a              mPalette[JOINTS];
+
+        FSRiggedBoundsFixture()
+        {
+            mBindShape.setTranslation(LLVector3(0.f, 0.f, 1.f));
+            mBindShapeMatrix.loadu(mBindShape);
+            for (S32 i = 0; i < 4; ++i)
+            {
+                mFaces.push_back(make_face(mRandom, 24));
+            }
+        }
+
+        void build(FSRiggedBounds& bounds)
+        {
+            bounds.clear();
+            for (const Face& face : mFaces)
+            {
+                bounds.addFace(mBindShape, &face.mPositions[0], &face.mWeights[0], (S32)face.mPositions.size(),
+                               &face.mIndices[0], (S32)face.mIndices.size(), JOINTS);
+            }
+        }
+    };
+    typedef test_group<FSRiggedBoundsFixture> FSRiggedBoundsTest_factory;
+    typedef FSRiggedBoundsTest_factory::object FSRiggedBoundsTest_t;
+    FSRiggedBoundsTest_factory tf("FSRiggedBounds");
+
+    // Every skinned vertex is inside its face, in any pose
+    template<> template<>
+    void FSRiggedBoundsTest_t::test<1>()
+    {
+        LLPointer<FSRiggedBounds> bounds = new FSRiggedBounds();
+        build(*bounds);
+        ensure_equals("faces", bounds->getNumFaces(), (S32)mFaces.size());
+        ensure("matches", bounds->matchesFace(1, 24 * 24, 23 * 23 * 6));
+        ensure("size changed", !bounds->matchesFace(1, 24 * 24, 6));
+        ensure("past the end", !bounds->matchesFace((S32)mFaces.size(), 24 * 24, 23 * 23 * 6));
+
+        for (S32 pose = 0; pose < 20; ++pose)
+        {
+            make_palette(mRandom, mPalette);
+            bounds->update(mPalette);
+            for (size_t f = 0; f < mFaces.size(); ++f)
+            {
+                const Face& face = mFaces[f];
+                for (size_t i = 0; i < face.mPositions.size(); ++i)
+                {
+                    LLVector4a pos;
+                    skin(mBindShapeMatrix, mPalette, face.mPositions[i], face.mWeights[i], pos);
+                    ensure("vertex inside face", inside(bounds->getFaceExtents(f), pos));
+                }
+            }
+        }
+    }
+
+    // A segment through any skinned triangle is never ruled out
+    template<> template<>
+    void FSRiggedBoundsTest_t::test<2>()
+    {
+        LLPointer<FSRiggedBounds> bounds = new FSRiggedBounds();
+        build(*bounds);
+
+        for (S32 pose = 0; pose < 20; ++pose)
+        {
+            make_palette(mRandom, mPalette);
+            bounds->update(mPalette);
+            for (S32 pick = 0; pick < 200; ++pick)
+            {
+                S32 f = mRandom() % mFaces.size();
+                const Face& face = mFaces[f];
+                S32 tri = (mRandom() % (face.mIndices.size() / 3)) * 3;
+                LLVector4a corner[3];
+                for (S32 v = 0; v < 3; ++v)
+                {
+                    U16 i = face.mIndices[tri + v];
+                    skin(mBindShapeMatrix, mPalette, face.mPositions[i], face.mWeights[i], corner[v]);
+                }
+
+                F32 a = unit(mRandom);
+                F32 b = unit(mRandom) * (1.f - a);
+                LLVector4a hit;
+                hit.setMul(corner[0], 1.f - a - b);
+                LLVector4a part;
+                part.setMul(corner[1], a);
+                hit.add(part);
+                part.setMul(corner[2], b);
+                hit.add(part);
+
+                LLVector4a dir(unit(mRandom) - 0.5f, unit(mRandom) - 0.5f, unit(mRandom) - 0.5f);
+                dir.normalize3fast();
+                dir.mul(10.f);
+                LLVector4a start;
+                LLVector4a end;
+                start.setSub(hit, dir);
+                end.setAdd(hit, dir);
+                ensure("face hit", bounds->lineSegmentIntersect(start, end, f));
+                ensure("any face hit", bounds->lineSegmentIntersect(start, end));
+            }
+
+            // well clear of everything
+            LLVector4a start(100.f, 100.f, 100.f);
+            LLVector4a end(100.f, 100.f, 200.f);
+            ensure("miss", !bounds->lineSegmentIntersect(start, end));
+        }
+
+        // faces it was not built for cannot be ruled out
+        LLVector4a start(100.f, 100.f, 100.f);
+        LLVector4a end(100.f, 100.f, 200.f);
+        ensure("unknown face", bounds->lineSegmentIntersect(start, end, (S32)mFaces.size()));
+        bounds->clear();
+        ensure_equals("cleared", bounds->getNumFaces(), 0);
+    }
+
+    // Per pick cost of ruling out an attachment: keeping the bounds in pose
+    // against re-skinning every vertex, which is what updateRiggedVolume()
+    // did before its octree rebuild.
+    template<> template<>
+    void FSRiggedBoundsTest_t::test<3>()
+    {
+        skip_unless_benchmarks();
+
+        const S32 PICKS = 200;
+
+        std::cout << std::endl << "FSRiggedBounds, " << PICKS << " picks that miss, " << JOINTS << " joints" << std::endl;
+        std::cout << std::setw(10) << "vertices" << std::setw(14) << "reskin ms" << std::setw(14) << "bounds ms"
+                  << std::setw(10) << "speedup" << std::endl;
+
+        const S32 sizes[] = { 16, 32, 64, 128 };
+        for (S32 size : sizes)
+        {
+            mFaces.clear();
+            for (S32 i = 0; i < 4; ++i)
+            {
+                mFaces.push_back(make_face(mRandom, size));
+            }
+            LLPointer<FSRiggedBounds> bounds = new FSRiggedBounds();
+            build(*bounds);
+            make_palette(mRandom, mPalette);
+
+            LLVector4a start(100.f, 100.f, 100.f);
+            LLVector4a end(100.f, 100.f, 200.f);
+
+            LLTimer timer;
+            vector4a_t skinned;
+            S32 misses = 0;
+            for (S32 pick = 0; pick < PICKS; ++pick)
+            {
+                LLVector4a min;
+                LLVector4a max;
+                min.splat(F32_MAX);
+                max.splat(-F32_MAX);
+                for (const Face& face : mFaces)
+                {
+                    skinned.resize(face.mPositions.size());
+                    for (size_t i = 0; i < face.mPositions.size(); ++i)
+                    {
+                        skin(mBindShapeMatrix, mPalette, face.mPositions[i], face.mWeights[i], skinned[i]);
+                        min.setMin(min, skinned[i]);
+                        max.setMax(max, skinned[i]);
+                    }
+                }
+                LLVector4a center;
+                LLVector4a half;
+                center.setAdd(min, max);
+                center.mul(0.5f);
+                half.setSub(max, min);
+                half.mul(0.5f);
+                misses += !LLLineSegmentBoxIntersect(start, end, center, half);
+            }
+            F64 reskin_ms = timer.getElapsedTimeF64() * 1000.0;
+            ensure_equals("reskin misses", misses, PICKS);
+
+            timer.reset();
+            misses = 0;
+            for (S32 pick = 0; pick < PICKS; ++pick)
+            {
+                bounds->update(mPalette);
+                misses += !bounds->lineSegmentIntersect(start, end);
+            }
+            F64 bounds_ms = timer.getElapsedTimeF64() * 1000.0;
+            ensure_equals("bounds misses", misses, PICKS);
+
+            std::cout << std::setw(10) << size * size * 4 << std::fixed << std::setprecision(2)
+                      << std::setw(14) << reskin_ms << std::setw(14) << bounds_ms
+                      << std::setw(10) << reskin_ms / llmax(bounds_ms, 0.001) << std::endl;
+        }
+    }
+}
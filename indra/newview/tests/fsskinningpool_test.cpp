@@ -0,0 +1,310 @@
+/**
+ * @file fsskinningpool_test.cpp
+ * @brief Tests and benchmark for FSSkinningPool.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../fsskinningpool.h"
+
+#include "llprocessor.h"
+#include "lltimer.h"
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace
+{
+    const U32 JOINTS = 110;
+
+    // Palette, weights and source vertices of one face, plus both outputs
+    struct TestFace
+    {
+        TestFace(std::mt19937& random, U32 vertices, bool normals)
+        :   mPalette(JOINTS),
+            mWeights(vertices),
+            mPositions(vertices),
+            mNormals(vertices),
+            mOutPositions(vertices),
+            mOutNormals(vertices),
+            mHasNormals(normals)
+        {
+            std::uniform_real_distribution<F32> unit(-1.f, 1.f);
+            for (LLMatrix4a& mat : mPalette)
+            {
+                for (S32 row = 0; row < 4; ++row)
+                {
+                    mat.mMatrix[row].set(unit(random), unit(random), unit(random), row == 3 ? 1.f : 0.f);
+                }
+            }
+            for (S32 row = 0; row < 4; ++row)
+            {
+                for (S32 col = 0; col < 4; ++col)
+                {
+                    mBindShape.mMatrix[row][col] = row == col ? 1.f + unit(random) * 0.1f : (col == 3 ? 0.f : unit(random) * 0.1f);
+                }
+            }
+            for (U32 i = 0; i < vertices; ++i)
+            {
+                // joint index in the integer part, weight in the fraction
+                F32 w[4];
+                for (S32 k = 0; k < 4; ++k)
+                {
+                    w[k] = (F32)(random() % JOINTS) + 0.05f + (unit(random) + 1.f) * 0.4f;
+                }
+                mWeights[i].set(w[0], w[1], w[2], w[3]);
+                mPositions[i].set(unit(random), unit(random), unit(random), 1.f);
+                mNormals[i].set(unit(random), unit(random), unit(random), 0.f);
+            }
+        }
+
+        FSSkinningJob makeJob()
+        {
+            FSSkinningJob job;
+            job.mPalette = &mPalette[0];
+            job.mBindShape = &mBindShape;
+            job.mWeights = &mWeights[0];
+            job.mPositions = &mPositions[0];
+            job.mNormals = mHasNormals ? &mNormals[0] : NULL;
+            job.mOutPositions = &mOutPositions[0];
+            job.mOutNormals = mHasNormals ? &mOutNormals[0] : NULL;
+            job.mMaxJoints = JOINTS;
+            job.mBegin = 0;
+            job.mEnd = (U32)mPositions.size();
+            return job;
+        }
+
+        void clearOutput()
+        {
+            memset((void*)&mOutPositions[0], 0, mOutPositions.size() * sizeof(LLVector4a));
+            memset((void*)&mOutNormals[0], 0, mOutNormals.size() * sizeof(LLVector4a));
+        }
+
+        typedef std::vector<LLVector4a, boost::alignment::aligned_allocator<LLVector4a, 16> > vector4a_t;
+        typedef std::vector<LLMatrix4a, boost::alignment::aligned_allocator<LLMatrix4a, 16> > matrix4a_t;
+
+        matrix4a_t  mPalette;
+        LLMatrix4   mBindShape;
+        vector4a_t  mWeights;
+        vector4a_t  mPositions;
+        vector4a_t  mNormals;
+        vector4a_t  mOutPositions;
+        vector4a_t  mOutNormals;
+        bool        mHasNormals;
+    };
+
+    bool same_bits(const TestFace::vector4a_t& a, const TestFace::vector4a_t& b)
+    {
+        return memcmp((const void*)&a[0], (const void*)&b[0], a.size() * sizeof(LLVector4a)) == 0;
+    }
+
+    bool has_avx()
+    {
+        return LLProcessorInfo().hasAVX();
+    }
+}
+
+namespace tut
+{
+    struct FSSkinningPoolFixture
+    {
+        std::mt19937 mRandom;
+    };
+    typedef test_group<FSSkinningPoolFixture> FSSkinningPoolTest_factory;
+    typedef FSSkinningPoolTest_factory::object FSSkinningPoolTest_t;
+    FSSkinningPoolTest_factory tf("FSSkinningPool");
+
+    // Skinning matches plain float math, and the AVX blend matches SSE2 to the bit
+    template<> template<>
+    void FSSkinningPoolTest_t::test<1>()
+    {
+        TestFace face(mRandom, 1000, true);
+        FSSkinningPool::skin(face.makeJob(), false);
+
+        for (U32 i = 0; i < 1000; ++i)
+        {
+            const F32* w = face.mWeights[i].getF32ptr();
+            S32 idx[4];
+            F32 frac[4];
+            F32 sum = 0.f;
+            for (S32 k = 0; k < 4; ++k)
+            {
+                idx[k] = (S32)w[k];
+                frac[k] = w[k] - (F32)idx[k];
+                sum += frac[k];
+            }
+
+            // v * bind_shape * sum(weight * joint)
+            const F32* v = face.mPositions[i].getF32ptr();
+            F32 t[3];
+            for (S32 c = 0; c < 3; ++c)
+            {
+                t[c] = v[0] * face.mBindShape.mMatrix[0][c] + v[1] * face.mBindShape.mMatrix[1][c]
+                     + v[2] * face.mBindShape.mMatrix[2][c] + face.mBindShape.mMatrix[3][c];
+            }
+            for (S32 c = 0; c < 3; ++c)
+            {
+                F32 expected = 0.f;
+                for (S32 k = 0; k < 4; ++k)
+                {
+                    const LLMatrix4a& mat = face.mPalette[idx[k]];
+                    expected += frac[k] / sum * (t[0] * mat.mMatrix[0][c] + t[1] * mat.mMatrix[1][c]
+                                                 + t[2] * mat.mMatrix[2][c] + mat.mMatrix[3][c]);
+                }
+                ensure_distance("position", face.mOutPositions[i][c], expected, 1e-3f);
+            }
+        }
+
+        if (!has_avx())
+        {
+            std::cout << std::endl << "FSSkinningPool: no AVX on this CPU, blend comparison skipped" << std::endl;
+            return;
+        }
+        TestFace::vector4a_t positions = face.mOutPositions;
+        TestFace::vector4a_t normals = face.mOutNormals;
+        face.clearOutput();
+        FSSkinningPool::skin(face.makeJob(), true);
+        ensure("avx positions", same_bits(positions, face.mOutPositions));
+        ensure("avx normals", same_bits(normals, face.mOutNormals));
+    }
+
+    // The pool writes what skinning each face on its own does, over
+    // several batches, with faces split across chunks and threads
+    template<> template<>
+    void FSSkinningPoolTest_t::test<2>()
+    {
+        std::vector<TestFace*> faces;
+        const U32 sizes[] = { 3, 2048, 2049, 9000, 500, 1 };
+        for (U32 size : sizes)
+        {
+            faces.push_back(new TestFace(mRandom, size, size % 2 == 0));
+        }
+
+        std::vector<TestFace::vector4a_t> expected;
+        for (TestFace* face : faces)
+        {
+            FSSkinningPool::skin(face->makeJob(), false);
+            expected.push_back(face->mOutPositions);
+            expected.push_back(face->mOutNormals);
+        }
+
+        FSSkinningPool pool(4, false);
+        ensure_equals("workers", pool.getThreadCount(), 3U);
+        pool.run();
+        for (S32 batch = 0; batch < 20; ++batch)
+        {
+            for (TestFace* face : faces)
+            {
+                face->clearOutput();
+                FSSkinningJob job = face->makeJob();
+                // a batch sometimes only covers part of a face
+                if (batch % 2)
+                {
+                    job.mEnd = job.mEnd / 2;
+                    FSSkinningPool::skin(face->makeJob(), false);
+                    memset((void*)&face->mOutPositions[0], 0, job.mEnd * sizeof(LLVector4a));
+                }
+                pool.add(job);
+            }
+            ensure("jobs", pool.hasJobs());
+            pool.run();
+            ensure("done", !pool.hasJobs());
+
+            for (size_t i = 0; i < faces.size(); ++i)
+            {
+                ensure("positions", same_bits(expected[i * 2], faces[i]->mOutPositions));
+                if (faces[i]->mHasNormals && !(batch % 2))
+                {
+                    ensure("normals", same_bits(expected[i * 2 + 1], faces[i]->mOutNormals));
+                }
+            }
+        }
+        pool.shutdown();
+
+        for (TestFace* face : faces)
+        {
+            delete face;
+        }
+    }
+
+    // A club's worth of rigged attachments, skinned with the pool against
+    // the old loop on one thread.
+    template<> template<>
+    void FSSkinningPoolTest_t::test<3>()
+    {
+        skip_unless_benchmarks();
+
+        const U32 AVATARS = 40;
+        const U32 FACES = 8;
+        const U32 VERTICES = 3000;
+        const S32 FRAMES = 10;
+
+        std::vector<TestFace*> faces;
+        for (U32 i = 0; i < AVATARS * FACES; ++i)
+        {
+            faces.push_back(new TestFace(mRandom, VERTICES, true));
+        }
+        const F64 mverts = (F64)AVATARS * FACES * VERTICES * FRAMES / 1000000.0;
+
+        std::cout << std::endl << "FSSkinningPool, " << AVATARS << " avatars, " << FACES << " faces of " << VERTICES
+                  << " vertices, " << FRAMES << " frames" << std::endl;
+        std::cout << std::setw(10) << "threads" << std::setw(8) << "blend" << std::setw(14) << "ms/frame"
+                  << std::setw(14) << "Mverts/s" << std::endl;
+
+        const U32 threads[] = { 1, 2, 4, 8 };
+        for (U32 count : threads)
+        {
+            for (S32 avx = 0; avx < (has_avx() ? 2 : 1); ++avx)
+            {
+                FSSkinningPool pool(count, avx != 0);
+                LLTimer timer;
+                for (S32 frame = 0; frame < FRAMES; ++frame)
+                {
+                    for (TestFace* face : faces)
+                    {
+                        pool.add(face->makeJob());
+                    }
+                    pool.run();
+                }
+                F64 ms = timer.getElapsedTimeF64() * 1000.0;
+                pool.shutdown();
+
+                std::cout << std::setw(10) << count << std::setw(8) << (avx ? "AVX" : "SSE2") << std::fixed << std::setprecision(2)
+                          << std::setw(14) << ms / FRAMES << std::setw(14) << mverts / (ms / 1000.0) << std::endl;
+            }
+        }
+
+        for (TestFace* face : faces)
+        {
+            delete face;
+        }
+    }
+}
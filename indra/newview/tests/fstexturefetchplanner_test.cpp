@@ -0,0 +1,176 @@
+/**
+ * @file fstexturefetchplanner_test.cpp
+ * @brief Tests for FSTextureFetchPlanner.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2026, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../fstexturefetchplanner.h"
+
+#include <cmath>
+
+namespace
+{
+    // Keeps every slot busy and completes one request every interval
+    // seconds, each rtt long and bytes big, until end; then drains the host
+    F64 run_host(FSTextureFetchPlanner& planner, S32 host, F64 start, F64 end, F64 interval, F64 rtt, S32 bytes)
+    {
+        F64 now = start;
+        for (; now < end; now += interval)
+        {
+            while (planner.acquire(host))
+            {
+            }
+            planner.onResponse(host, now, rtt, bytes);
+            planner.release(host);
+        }
+        while (planner.getActive(host))
+        {
+            planner.release(host);
+        }
+        return now;
+    }
+}
+
+namespace tut
+{
+    struct FSTextureFetchPlannerFixture
+    {
+    };
+    typedef test_group<FSTextureFetchPlannerFixture> FSTextureFetchPlannerTest_factory;
+    typedef FSTextureFetchPlannerTest_factory::object FSTextureFetchPlannerTest_t;
+    FSTextureFetchPlannerTest_factory tf("FSTextureFetchPlanner");
+
+    // Hosts are scheme and authority
+    template<> template<>
+    void FSTextureFetchPlannerTest_t::test<1>()
+    {
+        FSTextureFetchPlanner planner;
+        S32 cdn = planner.getHost("https://asset-cdn.example.com/?texture_id=1");
+        ensure("valid", cdn >= 0);
+        ensure_equals("same host", planner.getHost("https://asset-cdn.example.com/?texture_id=2"), cdn);
+        ensure_equals("no path", planner.getHost("https://asset-cdn.example.com"), cdn);
+        ensure("other port", planner.getHost("https://asset-cdn.example.com:8080/?texture_id=1") != cdn);
+        ensure("other scheme", planner.getHost("http://asset-cdn.example.com/?texture_id=1") != cdn);
+        ensure_equals("no authority", planner.getHost("texture_id=1"), -1);
+        ensure_equals("empty", planner.getHost(""), -1);
+
+        // unknown hosts are never limited here
+        planner.setMaxLimit(2);
+        ensure("no host", planner.acquire(-1) && planner.acquire(-1) && planner.acquire(-1));
+    }
+
+    // Before any measurement a host may use every slot the fetcher has
+    template<> template<>
+    void FSTextureFetchPlannerTest_t::test<2>()
+    {
+        FSTextureFetchPlanner planner;
+        planner.setMaxLimit(40);
+        S32 host = planner.getHost("http://sim.example.com:12046/cap/?texture_id=1");
+        for (S32 i = 0; i < 40; ++i)
+        {
+            ensure("slot", planner.acquire(host));
+        }
+        ensure("full", !planner.acquire(host));
+        ensure_equals("active", planner.getActive(host), 40);
+        planner.release(host);
+        ensure("freed", planner.acquire(host));
+        ensure_equals("limit", planner.getLimit(host), 40);
+    }
+
+    // The limit follows the bandwidth-delay product
+    template<> template<>
+    void FSTextureFetchPlannerTest_t::test<3>()
+    {
+        FSTextureFetchPlanner planner;
+        planner.setMaxLimit(100);
+        S32 fast = planner.getHost("https://fast.example.com/");
+        S32 slow = planner.getHost("https://slow.example.com/");
+
+        // 16 KB every 8 ms at 100 ms is 2 MB/s, 12.8 responses per round trip
+        run_host(planner, fast, 0.0, 5.0, 0.008, 0.1, 16384);
+        S32 limit = planner.getLimit(fast);
+        ensure("fast limit " + std::to_string(limit), limit >= 24 && limit <= 28);
+        ensure("rtt", fabs(planner.getMinRTT(fast) - 0.1) < 1e-9);
+
+        // 4 KB every 50 ms at 300 ms is 80 KB/s, 6 per round trip
+        run_host(planner, slow, 0.0, 5.0, 0.05, 0.3, 4096);
+        limit = planner.getLimit(slow);
+        ensure("slow limit " + std::to_string(limit), limit >= 11 && limit <= 13);
+
+        // never above the fetcher's ceiling, never below MIN_LIMIT
+        planner.setMaxLimit(16);
+        ensure_equals("ceiling", planner.getLimit(fast), 16);
+        run_host(planner, slow, 5.0, 20.0, 1.0, 0.3, 100);
+        ensure_equals("floor", planner.getLimit(slow), (S32)FSTextureFetchPlanner::MIN_LIMIT);
+    }
+
+    // An idle host keeps its limit
+    template<> template<>
+    void FSTextureFetchPlannerTest_t::test<4>()
+    {
+        FSTextureFetchPlanner planner;
+        planner.setMaxLimit(100);
+        S32 host = planner.getHost("https://asset-cdn.example.com/");
+        F64 now = run_host(planner, host, 0.0, 5.0, 0.008, 0.1, 16384);
+        S32 busy_limit = planner.getLimit(host);
+
+        // one request at a time, far slower than the link; the first
+        // interval still has the busy tail in it
+        S32 limit = 0;
+        for (S32 i = 0; i < 20; ++i, now += 1.0)
+        {
+            ensure("slot", planner.acquire(host));
+            planner.onResponse(host, now, 0.1, 16384);
+            planner.release(host);
+            if (i == 1)
+            {
+                limit = planner.getLimit(host);
+            }
+        }
+        ensure("tail " + std::to_string(limit), limit * 4 >= busy_limit * 3);
+        ensure_equals("kept", planner.getLimit(host), limit);
+    }
+
+    // The round trip is a windowed minimum
+    template<> template<>
+    void FSTextureFetchPlannerTest_t::test<5>()
+    {
+        FSTextureFetchPlanner planner;
+        S32 host = planner.getHost("https://asset-cdn.example.com/");
+        ensure_equals("no rtt yet", planner.getMinRTT(host), 0.0);
+
+        planner.onResponse(host, 1.0, 0.08, 1000);
+        planner.onResponse(host, 2.0, 0.05, 1000);
+        planner.onResponse(host, 3.0, 0.2, 1000);
+        ensure("min rtt", fabs(planner.getMinRTT(host) - 0.05) < 1e-9);
+
+        // the minimum ages out
+        planner.onResponse(host, 2.0 + FSTextureFetchPlanner::MIN_RTT_WINDOW + 1.0, 0.09, 1000);
+        ensure("aged", fabs(planner.getMinRTT(host) - 0.09) < 1e-9);
+    }
+}
@@ -31,6 +31,7 @@
 
 #include "is_approx_equal_fraction.h" // instead of llmath.h
 #include <cstring>
+#include <cstdlib> // <FS/> getenv() for skip_unless_benchmarks()
 
 class LLDate;
 class LLSD;
@@ -154,6 +155,18 @@ namespace tut
 	{
 		ensure_not_equals(NULL, actual, expected);
 	}
+
+	// <FS> Shared gate for benchmark tests
+	// Benchmarks are too slow for every build, they only run with
+	// LL_TEST_BENCHMARKS set in the environment.
+	inline void skip_unless_benchmarks()
+	{
+		if (! getenv("LL_TEST_BENCHMARKS"))
+		{
+			skip("LL_TEST_BENCHMARKS not set");
+		}
+	}
+	// </FS>
 }
 
 #endif // LL_LLTUT_H